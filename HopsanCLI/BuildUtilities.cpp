@@ -60,3 +60,16 @@ bool buildComponentLibrary(const std::string &rLibraryXML, std::string &rOutput)
     return false;
 #endif
 }
+
+bool buildCompiledModel(const std::string &rOutputPath, hopsan::ComponentSystem *pSystem)
+{
+#if defined(HOPSANCLI_USEGENERATOR)
+    const std::string hopsanRootPath = getCurrentExecPath()+"/..";
+    constexpr auto compilerPath = "";
+
+    return callCompiledModelGenerator(rOutputPath.c_str(), pSystem, hopsanRootPath.c_str(), compilerPath, &messageHandler, nullptr);
+#else
+    printErrorMessage("This HopsanCLI is not built with HopsanGenerator support");
+    return false;
+#endif
+}
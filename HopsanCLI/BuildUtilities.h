@@ -29,7 +29,12 @@
 
 #include <string>
 
+namespace hopsan {
+class ComponentSystem;
+}
+
 bool buildComponentLibrary(const std::string &rLibraryXML, std::string &rOutput);
+bool buildCompiledModel(const std::string &rOutputPath, hopsan::ComponentSystem *pSystem);
 
 
 
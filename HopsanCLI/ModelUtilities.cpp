@@ -30,6 +30,8 @@
 #include <iostream>
 #include <fstream>
 #include <algorithm>
+#include <cctype>
+#include <cstdlib>
 
 #include "ModelUtilities.h"
 #include "version_cli.h"
@@ -440,6 +442,184 @@ hopsan::Port* getPortWithFullName(hopsan::ComponentSystem *pRootSystem, const st
 }
 
 
+//! @brief Create a log sink for streaming results to file while simulating
+//! @details The format is selected by the file suffix: .csv for CSV, .h5 or .hdf5 for HDF5 and the binary log stream format otherwise
+//! @param [in] rFileName File name for output file
+//! @param [in] rModelFileName The model file name, stored as meta data in HDF5 files
+//! @returns A new log sink (owned by the caller), or nullptr if the format is not supported
+LogSink *createResultsStreamSink(const string &rFileName, const string &rModelFileName)
+{
+    string suffix;
+    const size_t dotPos = rFileName.rfind('.');
+    if (dotPos != string::npos) {
+        suffix = rFileName.substr(dotPos+1);
+        std::transform(suffix.begin(), suffix.end(), suffix.begin(), ::tolower);
+    }
+
+    if (suffix == "csv") {
+        return new CSVLogSink(rFileName.c_str());
+    }
+    else if (suffix == "h5" || suffix == "hdf5") {
+#ifdef USEHDF5
+        return new HopsanHDF5LogSink(rFileName.c_str(), rModelFileName.c_str(), std::string("HopsanCLI "+std::string(HOPSANCLIVERSION)).c_str());
+#else
+        HOPSAN_UNUSED(rModelFileName)
+        printErrorMessage("HopsanCLI was built without HDF5 support");
+        return nullptr;
+#endif
+    }
+    return new BinaryLogSink(rFileName.c_str());
+}
+
+//! @brief Write the simulation profile to file and print the components that took the most time
+//! @param [in] pProfiler Pointer to the profiler that measured the simulation
+//! @param [in] rFileName File name for the Chrome trace, the summary is written to the same file name with suffix .csv
+//! @param [in] silent Do not print anything
+void printProfilingResults(const SimulationProfiler *pProfiler, const string &rFileName, const bool silent)
+{
+    string csvFileName = rFileName;
+    const size_t dotPos = csvFileName.rfind('.');
+    if (dotPos != string::npos && csvFileName.find_first_of("/\\", dotPos) == string::npos) {
+        csvFileName.erase(dotPos);
+    }
+    csvFileName += ".csv";
+
+    if (!pProfiler->writeChromeTrace(rFileName.c_str())) {
+        printErrorMessage("Could not write simulation profile to file: "+rFileName, silent);
+    }
+    if (!pProfiler->writeSummaryCSV(csvFileName.c_str())) {
+        printErrorMessage("Could not write simulation profile summary to file: "+csvFileName, silent);
+    }
+
+    const vector<HString> names = pProfiler->getComponentNamesByTotalTime();
+    const size_t numToPrint = std::min(names.size(), size_t(10));
+    printMessage("Profiled "+to_string(pProfiler->getNumSteps())+" steps, the most time consuming components were:", silent);
+    for (size_t i=0; i<numToPrint; ++i) {
+        const DurationStatistics *pStats = pProfiler->getComponentStatistics(names[i]);
+        printMessage("  "+string(names[i].c_str())+": "+to_string(pStats->getTotal())+" s (mean "+to_string(pStats->getMean()*1e6)+" us)", silent);
+    }
+    printMessage("Wrote simulation profile to: "+rFileName+" and "+csvFileName, silent);
+
+    if (pProfiler->usesHardwareCounters()) {
+        bool haveCounters = false;
+        for (size_t c=0; c<HardwareCounters::NumCounters; ++c) {
+            haveCounters = haveCounters || pProfiler->isHardwareCounterAvailable(HardwareCounters::CounterT(c));
+        }
+        if (!haveCounters) {
+            printErrorMessage("No hardware counters were available: "+string(pProfiler->getHardwareCounterError().c_str()), silent);
+            return;
+        }
+
+        string countersFileName = csvFileName;
+        countersFileName.insert(countersFileName.size()-4, "_counters");
+        if (!pProfiler->writeHardwareCounterCSV(countersFileName.c_str())) {
+            printErrorMessage("Could not write hardware counters to file: "+countersFileName, silent);
+        }
+
+        // Counters that are not available are printed as zero
+        const vector<HString> typeNames = pProfiler->getComponentTypeNamesByTotalTime();
+        printMessage("Hardware counters per time step for the most time consuming component types (cycles, instructions per cycle, LLC misses, branch misses):", silent);
+        for (size_t i=0; i<std::min(typeNames.size(), size_t(10)); ++i) {
+            const HardwareCounterStatistics *pCounters = pProfiler->getComponentTypeCounters(typeNames[i]);
+            printMessage("  "+string(typeNames[i].c_str())+" ("+to_string(pProfiler->getNumComponentsOfType(typeNames[i]))+"): "+
+                         to_string(pCounters->getMean(HardwareCounters::Cycles))+", "+to_string(pCounters->getInstructionsPerCycle())+", "+
+                         to_string(pCounters->getMean(HardwareCounters::CacheMisses))+", "+to_string(pCounters->getMean(HardwareCounters::BranchMisses)), silent);
+        }
+        printMessage("Wrote hardware counters to: "+countersFileName, silent);
+    }
+}
+
+//! @brief Parse the real-time simulation options given on the command line
+//! @param [in] rArgument The option as [factor][:fifo[=priority]][:cpu=N][:mlock][:overrun=catchup|skip|abort]
+//! @param [out] rOptions The parsed options, fields that are not given keep their value
+//! @param [out] rError Description of the first invalid field
+//! @returns True if all fields could be parsed
+bool parseRealtimeOptions(const string &rArgument, RealtimeOptions &rOptions, string &rError)
+{
+    vector<string> fields;
+    splitStringOnDelimiter(rArgument, ':', fields);
+    for (size_t i=0; i<fields.size(); ++i) {
+        const string &rField = fields[i];
+        const size_t eqPos = rField.find('=');
+        const string name = rField.substr(0, eqPos);
+        const string value = (eqPos != string::npos) ? rField.substr(eqPos+1) : "";
+        char *pEnd = nullptr;
+        if (i == 0 && !rField.empty() && (isdigit(rField[0]) || rField[0] == '.')) {
+            rOptions.realTimeFactor = strtod(rField.c_str(), &pEnd);
+            if (*pEnd != '\0' || !(rOptions.realTimeFactor > 0)) {
+                rError = "Invalid real-time factor: "+rField;
+                return false;
+            }
+        }
+        else if (name == "fifo") {
+            rOptions.useFifoScheduling = true;
+            if (!value.empty()) {
+                rOptions.fifoPriority = int(strtol(value.c_str(), &pEnd, 10));
+                if (*pEnd != '\0' || rOptions.fifoPriority < 1 || rOptions.fifoPriority > 99) {
+                    rError = "Invalid SCHED_FIFO priority (1-99): "+value;
+                    return false;
+                }
+            }
+        }
+        else if (name == "cpu") {
+            rOptions.cpu = int(strtol(value.c_str(), &pEnd, 10));
+            if (value.empty() || *pEnd != '\0' || rOptions.cpu < 0) {
+                rError = "Invalid CPU number: "+value;
+                return false;
+            }
+        }
+        else if (name == "mlock" && value.empty()) {
+            rOptions.lockMemory = true;
+        }
+        else if (name == "overrun") {
+            if (value == "catchup") {
+                rOptions.overrunPolicy = CatchUpOverrunPolicy;
+            }
+            else if (value == "skip") {
+                rOptions.overrunPolicy = SkipOverrunPolicy;
+            }
+            else if (value == "abort") {
+                rOptions.overrunPolicy = AbortOverrunPolicy;
+            }
+            else {
+                rError = "Unknown overrun policy: "+value+", use catchup, skip or abort";
+                return false;
+            }
+        }
+        else if (!rField.empty()) {
+            rError = "Unknown real-time option: "+rField;
+            return false;
+        }
+    }
+    return true;
+}
+
+//! @brief Print the jitter, execution time and overrun statistics of a real-time simulation
+//! @param [in] rStatistics The statistics to print
+//! @param [in] timestep The simulation time step, to print the times relative to the period
+//! @param [in] silent Do not print anything
+void printRealtimeStatistics(const RealtimeStatistics &rStatistics, const double timestep, const bool silent)
+{
+    auto us = [](const double seconds) { return to_string(seconds*1e6)+" us"; };
+    // Prints the statistics and the non-empty buckets of the log2 histogram, bucket b holds durations shorter than 2^b ns
+    auto printDuration = [&](const string &rName, const DurationStatistics &rDuration) {
+        printMessage("  "+rName+": mean "+us(rDuration.getMean())+", 99% "+us(rDuration.getPercentile(0.99))+", max "+us(rDuration.getMax()), silent);
+        for (size_t b=0; b<DurationStatistics::NumHistogramBuckets; ++b) {
+            const size_t count = rDuration.getHistogramCount(b);
+            if (count > 0) {
+                printMessage("    < "+us(double(uint64_t(1) << std::min(b, size_t(62)))*1e-9)+": "+to_string(count), silent);
+            }
+        }
+    };
+    printMessage("Real-time simulated "+to_string(rStatistics.numSteps)+" steps with Ts: "+us(timestep)+", "+
+                 to_string(rStatistics.numOverruns)+" overruns, "+to_string(rStatistics.numSkippedPeriods)+" skipped periods", silent);
+    printDuration("Jitter", rStatistics.jitter);
+    printMessage("  Execution time: mean "+us(rStatistics.executionTime.getMean())+", max "+us(rStatistics.executionTime.getMax()), silent);
+    if (rStatistics.numOverruns > 0) {
+        printDuration("Overrun", rStatistics.overrun);
+    }
+}
+
 //! @brief Save results to HDF5 format
 //! @param [in] pRootSystem Pointer to component system
 //! @param [in] rFileName File name for output file
@@ -470,18 +650,16 @@ void saveResultsToHDF5(ComponentSystem *pRootSystem, const string &rFileName, co
     };
 
     auto addVariable = [&exporter, howMany](const ComponentSystem* pSystem, const Component* pComponent, const Port* pPort, size_t variableIndex) {
-        const vector< vector<double> > *pLogData = pPort->getLogDataVectorPtr();
-        const size_t numLoggedSamples = pSystem->getNumActuallyLoggedSamples();
-        if( (pLogData != nullptr) && !pLogData->empty() && (numLoggedSamples > 0)) {
+        const LogDataColumnView logData = pPort->getLogDataColumn(variableIndex);
+        const size_t numLoggedSamples = std::min(pSystem->getNumActuallyLoggedSamples(), logData.size());
+        if(numLoggedSamples > 0) {
             HVector<double> dataVector;
             if(howMany == Full) {
-                dataVector.reserve(numLoggedSamples);
-                for (size_t t=0; t < numLoggedSamples; ++t) {
-                    dataVector.append((*pLogData)[t][variableIndex]);
-                }
+                dataVector.resize(numLoggedSamples);
+                logData.copyTo(dataVector.data(), numLoggedSamples);
             }
             else {
-                dataVector.append((*pLogData)[numLoggedSamples-1][variableIndex]);
+                dataVector.append(logData[numLoggedSamples-1]);
             }
 
             HString parentSystemNames = generateFullSubSystemHierarchyName(pSystem,".", false);
@@ -536,8 +714,8 @@ void saveResultsToCSV(ComponentSystem *pRootSystem, const string &rFileName, con
 
             auto addVariable = [&outfile, howMany](const ComponentSystem* pSystem, const Component* pComponent, const Port* pPort, size_t variableIndex) {
                 const NodeDataDescription& variable = *pPort->getNodeDataDescription(variableIndex);
-                const vector< vector<double> > *pLogData = pPort->getLogDataVectorPtr();
-                if( (pLogData != nullptr) && !pLogData->empty()) {
+                const LogDataColumnView logData = pPort->getLogDataColumn(variableIndex);
+                if(!logData.empty()) {
                     const HString fullVarName = generateFullSubSystemHierarchyName(pSystem,"$") + pComponent->getName() + "#" + pPort->getName() + "#" + variable.name;
                     if (howMany == Final) {
                         outfile << fullVarName.c_str() << "," << pPort->getVariableAlias(variableIndex).c_str() << "," << variable.unit.c_str();
@@ -545,15 +723,12 @@ void saveResultsToCSV(ComponentSystem *pRootSystem, const string &rFileName, con
                     }
                     else if (howMany == Full)
                     {
-                        // Only write something if data has been logged (skip ports that are not logged)
-                        // We assume that the data vector has been cleared
-                        if (pPort->getLogDataVectorPtr()->size() > 0) {
-                            outfile << fullVarName.c_str() << "," << pPort->getVariableAlias(variableIndex).c_str() << "," << variable.unit.c_str();
-                            for (size_t t=0; t<pSystem->getNumActuallyLoggedSamples(); ++t) {
-                                outfile << "," << std::scientific << (*pLogData)[t][variableIndex];
-                            }
-                            outfile << endl;
+                        // Only write something if data has been logged (skip variables that are not logged)
+                        outfile << fullVarName.c_str() << "," << pPort->getVariableAlias(variableIndex).c_str() << "," << variable.unit.c_str();
+                        for (size_t t=0; t<pSystem->getNumActuallyLoggedSamples(); ++t) {
+                            outfile << "," << std::scientific << logData[t];
                         }
+                        outfile << endl;
                     }
                 }
             };
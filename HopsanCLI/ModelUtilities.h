@@ -35,6 +35,9 @@
 #include <vector>
 #include "core_cli.h"
 #include "HopsanEssentials.h"
+#include "CoreUtilities/LogStreaming.h"
+#include "CoreUtilities/SimulationProfiler.h"
+#include "CoreUtilities/RealtimeExecutor.h"
 
 void printTsInfo(const hopsan::ComponentSystem* pSystem);
 void printSystemParams(hopsan::ComponentSystem* pSystem);
@@ -48,6 +51,10 @@ void saveResultsToCSV(hopsan::ComponentSystem *pRootSystem, const std::string &r
 void saveResultsToHDF5(hopsan::ComponentSystem *pRootSystem, const std::string &rFileName, const std::vector<std::string>& includeFilter, const SaveResults howMany);
 
 void transposeCSVresults(const std::string &rFileName);
+hopsan::LogSink *createResultsStreamSink(const std::string &rFileName, const std::string &rModelFileName);
+void printProfilingResults(const hopsan::SimulationProfiler *pProfiler, const std::string &rFileName, const bool silent=false);
+bool parseRealtimeOptions(const std::string &rArgument, hopsan::RealtimeOptions &rOptions, std::string &rError);
+void printRealtimeStatistics(const hopsan::RealtimeStatistics &rStatistics, const double timestep, const bool silent=false);
 void exportParameterValuesToCSV(const std::string &rFileName, hopsan::ComponentSystem* pSystem, std::string prefix="", std::ofstream *pFile=0);
 
 // ===== Load Functions =====
@@ -123,8 +130,7 @@ void saveResultsTo(hopsan::ComponentSystem *pCurrentSystem, const std::vector<st
                     const hopsan::NodeDataDescription* pVariable = &pVariables->at(v);
 
                     // Create data vector
-                    const std::vector< std::vector<double> > *pLogData = pPort->getLogDataVectorPtr();
-                    if(pLogData == nullptr || pLogData->empty()) {
+                    if(pPort->getLogDataColumn(v).empty()) {
                         continue;
                     }
 
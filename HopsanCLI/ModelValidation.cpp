@@ -141,21 +141,16 @@ bool exportHVCData(const string modelpath, const string baseFilePath, const std:
             appendValueNode(pVariableNode, "tolerance", to_string(tol));
 
             // Write data line to csv
-            std::vector< std::vector<double> > *pLogData = rPorts[p]->getLogDataVectorPtr();
-            if (pLogData &&  pLogData->size() > 0)
+            const LogDataColumnView logData = rPorts[p]->getLogDataColumn(rDataIds[p]);
+            if (!logData.empty())
             {
-                size_t nRows = pLogData->size();
-                size_t nCols = pLogData->front().size();
-                const size_t c = rDataIds[p];
-                if (rDataIds[p] < nCols)
+                const size_t nRows = logData.size();
+                for (size_t r=0; r<nRows-1; ++r)
                 {
-                    for (size_t r=0; r<nRows-1; ++r)
-                    {
-                        csvFile << std::scientific << (*pLogData)[r][c] << ", ";
-                    }
-                    csvFile << std::scientific << (*pLogData)[nRows-1][c] << std::endl;
-                    ++csvRow;
+                    csvFile << std::scientific << logData[r] << ", ";
                 }
+                csvFile << std::scientific << logData[nRows-1] << std::endl;
+                ++csvRow;
             }
         }
 
@@ -305,12 +300,14 @@ bool extractTestData(ComponentSystem *pRootSystem, string fullVarName, std::vect
         printErrorMessage("No such varaiable name: " + varName + " in: " + pPort->getNodeType().c_str());
         return false;
     }
-    vector< vector<double> > *pLogData = pPort->getLogDataVectorPtr();
-    rvSim.reserve(rvTime.size());
-    for(size_t i=0; i<rvTime.size(); ++i)
+    const LogDataColumnView logData = pPort->getLogDataColumn(dataId);
+    if (logData.size() < rvTime.size())
     {
-        rvSim.push_back(pLogData->at(i).at(dataId));
+        printErrorMessage("Variable: " + varName + " has not been logged");
+        return false;
     }
+    rvSim.resize(rvTime.size());
+    logData.copyTo(rvSim.data(), rvTime.size());
     return true;
 }
 
@@ -491,10 +488,14 @@ bool performModelTest(const std::string hvcFilePath)
                                     return false;
                                 }
 
-                                for(size_t i=0; i<vTime.size(); ++i)
+                                LogDataColumnView logData = pPort->getLogDataColumn(dataId);
+                                if (logData.size() < vTime.size())
                                 {
-                                    vSim1.push_back(pRootSystem->getSubComponent(compName.c_str())->getPort(portName.c_str())->getLogDataVectorPtr()->at(i).at(dataId));
+                                    printErrorMessage("Variable: " + varname + " has not been logged");
+                                    return false;
                                 }
+                                vSim1.resize(vTime.size());
+                                logData.copyTo(vSim1.data(), vTime.size());
 
                                 //Second simulation
                                 if (pRootSystem->initialize(startTime, stopTime))
@@ -509,10 +510,14 @@ bool performModelTest(const std::string hvcFilePath)
                                 }
                                 pRootSystem->finalize();
 
-                                for(size_t i=0; i<vTime.size(); ++i)
+                                logData = pRootSystem->getSubComponent(compName.c_str())->getPort(portName.c_str())->getLogDataColumn(dataId);
+                                if (logData.size() < vTime.size())
                                 {
-                                    vSim2.push_back(pRootSystem->getSubComponent(compName.c_str())->getPort(portName.c_str())->getLogDataVectorPtr()->at(i).at(dataId));
+                                    printErrorMessage("Variable: " + varname + " has not been logged");
+                                    return false;
                                 }
+                                vSim2.resize(vTime.size());
+                                logData.copyTo(vSim2.data(), vTime.size());
 
                                 // Print the messages if there were any errors or warnings
                                 if ( (gHopsanCore.getNumErrorMessages() + gHopsanCore.getNumFatalMessages() + gHopsanCore.getNumWarningMessages()) != 0)
@@ -31,6 +31,9 @@
 #include <string>
 #include <vector>
 #include <fstream>
+#include <memory>
+#include <thread>
+#include <chrono>
 
 #include <tclap/CmdLine.h>
 
@@ -40,6 +43,10 @@
 #include "TicToc.hpp"
 #include "version_cli.h"
 #include "CoreUtilities/SaveRestoreSimulationPoint.h"
+#include "CoreUtilities/BinaryModelFile.h"
+#include "CoreUtilities/SimulationProfiler.h"
+#include "CoreUtilities/RealtimeExecutor.h"
+#include "CoreUtilities/MultiThreadingUtilities.h"
 
 #include "CliUtilities.h"
 #include "ModelValidation.h"
@@ -133,6 +140,16 @@ public:
         mEvaulationCounter = 0;
         mStartTime = startTime;
         mStopTime = stopTime;
+
+        // Resolve the (system) parameters once, so that candidates can be set without name lookup and string conversion
+        mParHandles.resize(mRootSystemPtrs.size());
+        for(size_t m=0; m<mRootSystemPtrs.size(); ++m)
+        {
+            for(size_t i=0; i<mParNames.size(); ++i)
+            {
+                mParHandles[m].push_back(mRootSystemPtrs[m]->getParameterHandle("", mParNames[i].c_str()));
+            }
+        }
     }
 
     //! @todo Make evaluateAll... work in parallel
@@ -143,13 +160,13 @@ public:
         for(size_t i=0; i<mpWorker->getNumberOfParameters(); ++i)
         {
             double par = mpWorker->getCandidateParameter(idx, i);
-            if(!mRootSystemPtrs.at(0)->setParameterValue(HString(mParNames[i].c_str()), HString(std::to_string(par).c_str())))
+            if(!setParameterValue(0, i, par))
             {
                 cout << "Error: Parameter " << mParNames[i] << " not found in model." << endl;
             }
         }
 
-        mRootSystemPtrs.at(0)->initialize(mStartTime,mStopTime);
+        mRootSystemPtrs.at(0)->reinitialize(mStartTime,mStopTime);
         mRootSystemPtrs.at(0)->simulate(mStopTime);
 
         double obj = 0.0;
@@ -173,7 +190,7 @@ public:
             for(size_t i=0; i<mpWorker->getNumberOfParameters(); ++i)
             {
                 double par = mpWorker->getCandidateParameter(c, i);
-                if(!mRootSystemPtrs.at(c)->setParameterValue(HString(mParNames[i].c_str()), HString(std::to_string(par).c_str())))
+                if(!setParameterValue(c, i, par))
                 {
                     cout << "Error: Parameter " << mParNames[i] << " not found in model." << endl;
                 }
@@ -186,7 +203,7 @@ public:
             threads = -1;
         }
 
-        gHopsanCore.getSimulationHandler()->initializeSystem(mStartTime,mStopTime,mRootSystemPtrs);
+        gHopsanCore.getSimulationHandler()->reinitializeSystem(mStartTime,mStopTime,mRootSystemPtrs);
         gHopsanCore.getSimulationHandler()->simulateSystem(mStartTime,mStopTime,threads,mRootSystemPtrs);
 
         for(size_t c=0; c<mpWorker->getNumberOfCandidates(); ++c)
@@ -209,8 +226,19 @@ public:
 
     //void evaluateAllCandidates();
 private:
+    bool setParameterValue(size_t m, size_t i, double value)
+    {
+        // The handle is no longer valid if parameters have been removed in the model, then it is resolved again
+        if(!mParHandles[m][i].isValid())
+        {
+            mParHandles[m][i] = mRootSystemPtrs[m]->getParameterHandle("", mParNames[i].c_str());
+        }
+        return mRootSystemPtrs[m]->setParameterValue(mParHandles[m][i], value);
+    }
+
     vector<ComponentSystem *> mRootSystemPtrs;
     vector<string> mParNames;
+    vector< vector<ParameterHandle> > mParHandles;
     vector<string> mObjComps;
     vector<string> mObjPorts;
     vector<double> mObjWeights;
@@ -236,6 +264,9 @@ int main(int argc, char *argv[])
         TCLAP::SwitchArg silentOption("", "silent", "Disable all output messages", cmd);
         TCLAP::SwitchArg createHvcTestOption("", "createValidationData","Create a model validation data set based on the variables connected to scopes in the model given by option -m", cmd);
         TCLAP::SwitchArg prefixRootLevelName("", "prefixRootSystemName", "Prefix the root-level system name to exported results and parameters", cmd);
+        TCLAP::SwitchArg nodeDataArenaOption("", "nodeDataArena", "Pack all node data into one contiguous memory arena during simulation (may improve performance for large models)", cmd);
+        TCLAP::SwitchArg profileCountersOption("", "profileCounters", "Also read hardware performance counters (cycles, instructions, cache and branch misses) for each component type when profiling with --profile (Linux only)", cmd);
+        TCLAP::SwitchArg flattenHierarchyOption("", "flattenHierarchy", "Simulate the components in subsystems directly from the top-level system (may improve performance for deeply nested models)", cmd);
 
         TCLAP::ValueArg<std::string> coreLogFileOption("", "log.corelogfile", "The simulation core log file destination", false, "", "Filepath", cmd);
         TCLAP::ValueArg<std::string> buildCompLibOption("", "buildComponentLibrary", "Build the specified component library (point to the library xml)", false, "", "string", cmd);
@@ -248,18 +279,25 @@ int main(int argc, char *argv[])
         TCLAP::ValueArg<std::string> resultsFullCSVOption("", "resultsFullCSV", "Export the results (all logged data) to CSV", false, "", "Path to file", cmd);
         TCLAP::ValueArg<std::string> resultsFinalHDF5Option("", "resultsFinalHDF5", "Exeport the results (only final values) to HDF5", false, "", "Path to file", cmd);
         TCLAP::ValueArg<std::string> resultsFullHDF5Option("", "resultsFullHDF5", "Exeport the results (all logged data) to HDF5", false, "", "Path to file", cmd);
+        TCLAP::ValueArg<std::string> resultsStreamOption("", "resultsStream", "Stream the results (all logged data) to file while simulating instead of storing them in memory. The format is given by the suffix: .csv, .h5/.hdf5 or binary", false, "", "Path to file", cmd);
         TCLAP::ValueArg<std::string> parameterExportOption("", "parameterExport", "CSV file with exported parameter values", false, "", "Path to file", cmd);
         TCLAP::ValueArg<std::string> parameterImportOption("", "parameterImport", "CSV file with parameter values to import", false, "", "Path to file", cmd);
         TCLAP::ValueArg<std::string> hvcTestOption("t","validate","Perform model validation based on HopsanValidationConfiguration",false,"","Path to .hvc file", cmd);
         TCLAP::ValueArg<std::string> nLogSamplesOption("l","numLogSamples","Set the number of log samples to store for the top-level system, (default: Use number in .hmf)",false,"","integer", cmd);
         TCLAP::ValueArg<std::string> logonlyOption("","logonly","If specified, log only given ports or variables. Can be a file (one full port/variable name per line) or coma separated list.",false,"","string", cmd);
         TCLAP::ValueArg<std::string> simulateOption("s","simulate","Specify simulation time as: [hmf] or [start,ts,stop] or [ts,stop] or [stop]",false,"","Comma separated string", cmd);
-        TCLAP::ValueArg<std::string> parallelOption("p","parallel","Enable parallel simulation with specified number of threads. 0 threads  means auto-detect number of procssors.",false,"0","integer", cmd);
+        TCLAP::ValueArg<std::string> parallelOption("p","parallel","Enable parallel simulation with specified number of threads. 0 threads  means auto-detect number of procssors. Optionally followed by how threads wait for each other and how components are scheduled: [threads]:[spin, block, backoff]:[offline, partition] (default: spin:offline)",false,"0","integer[:string[:string]]", cmd);
+        TCLAP::ValueArg<std::string> threadPlacementOption("", "threadPlacement", "Pin the threads of a parallel simulation (option -p) to processors: auto, none, compact (fill the cores of one NUMA node first), scatter (spread the threads over the NUMA nodes) or a list of processors such as 0-3,8 (Linux only) (default: auto)", false, "auto", "string", cmd);
         TCLAP::ValueArg<std::string> extLibsFileOption("","externalLibsFile","A text file containing the external libs to load",false,"","Path to file", cmd);
         TCLAP::MultiArg<std::string> extLibPathsOption("e","externalLib","Path to a .dll/.so/.dylib externalComponentLib. Can be given multiple times",false,"Path to file", cmd);
         TCLAP::MultiArg<std::string> optimizationOption("o","optScript","Optimization scripts",false,"Path to files", cmd);
         TCLAP::MultiArg<std::string> optimizationSettings("","optSettings","Optimization settings",false,"Settings", cmd);
         TCLAP::ValueArg<std::string> hmfPathOption("m","hmf","The Hopsan model file to load",false,"","Path to file", cmd);
+        TCLAP::ValueArg<std::string> compileModelOption("", "compileModel", "Compile the model given by option -m to a binary model file (.hmfb) that loads faster, it can be used instead of the .hmf file with option -m", false, "", "Path to file", cmd);
+        TCLAP::ValueArg<std::string> generateCompiledModelOption("", "generateCompiledModel", "Generate and compile the simulation schedule of the model given by option -m ahead of time, into a library in this directory", false, "", "Path to directory", cmd);
+        TCLAP::ValueArg<std::string> compiledModelOption("", "compiledModel", "Simulate with a compiled model library generated by --generateCompiledModel for the model given by option -m", false, "", "Path to file", cmd);
+        TCLAP::ValueArg<std::string> realtimeOption("", "realtime", "Simulate paced against the wall clock and print jitter and overrun statistics. Optionally with real-time factor, SCHED_FIFO scheduling, pinning to a CPU, locked memory and what to do when a step misses its deadline (Linux only except factor and overrun): [factor][:fifo[=priority]][:cpu=N][:mlock][:overrun=catchup|skip|abort] (default: 1:overrun=catchup)", false, "", "string", cmd);
+        TCLAP::ValueArg<std::string> profileOption("", "profile", "Measure the time spent in each component and barrier wait, and write a Chrome trace (chrome://tracing) to this file and a summary to the same file name with suffix .csv", false, "", "Path to file", cmd);
 
         // Parse the argv array.
         cmd.parse( argc, argv );
@@ -611,14 +649,22 @@ int main(int argc, char *argv[])
                 std::vector<ComponentSystem*> rootSystemPtrs;
                 for(size_t m=0; m<nModels; ++m)
                 {
-                    rootSystemPtrs.push_back(gHopsanCore.loadHMFModelFile(hmfPathOption.getValue().c_str(), startTime, stopTime));
-                    if(rootSystemPtrs.at(m))
+                    // Only the first model is loaded from file, the others are copies of it (much faster than parsing the file again)
+                    if (m == 0)
                     {
-                        if (parameterImportOption.isSet())
+                        rootSystemPtrs.push_back(gHopsanCore.loadHMFModelFile(hmfPathOption.getValue().c_str(), startTime, stopTime));
+                        if (rootSystemPtrs.at(m) && parameterImportOption.isSet())
                         {
                             cout << "Importing parameter values from file: " << parameterImportOption.getValue() << endl;
                             importParameterValuesFromCSV(parameterImportOption.getValue(), rootSystemPtrs.at(m));
                         }
+                    }
+                    else
+                    {
+                        rootSystemPtrs.push_back(gHopsanCore.cloneComponentSystem(rootSystemPtrs.front()));
+                    }
+                    if(rootSystemPtrs.at(m))
+                    {
                         rootSystemPtrs.at(m)->disableLog();
                     }
                     else
@@ -818,11 +864,39 @@ int main(int argc, char *argv[])
 
             cout << "Loading Hopsan Model File: " << hmfPathOption.getValue() << endl;
             double startTime=0, stopTime=2;
+            TicToc loadTimer("LoadTime");
             ComponentSystem* pRootSystem = gHopsanCore.loadHMFModelFile(hmfPathOption.getValue().c_str(), startTime, stopTime);
+            loadTimer.TocPrint();
             size_t nErrors = gHopsanCore.getNumErrorMessages() + gHopsanCore.getNumFatalMessages();
             printWaitingMessages(printDebugOption.getValue(), silentOption.getValue());
             if (nErrors < 1)
             {
+                if (compileModelOption.isSet())
+                {
+                    cout << "Compiling model to binary model file: " << compileModelOption.getValue() << endl;
+                    // A model loaded from a binary file has no source file to check against
+                    string sourceFilePath = hmfPathOption.getValue();
+                    if (isBinaryModelFilePath(sourceFilePath.c_str()))
+                    {
+                        sourceFilePath.clear();
+                    }
+                    if (!saveBinaryModelFile(compileModelOption.getValue().c_str(), pRootSystem, sourceFilePath.c_str(), startTime, stopTime))
+                    {
+                        printErrorMessage("Could not compile model to: "+compileModelOption.getValue(), silentOption.getValue());
+                    }
+                    printWaitingMessages(printDebugOption.getValue(), silentOption.getValue());
+                }
+
+                if (generateCompiledModelOption.isSet())
+                {
+                    cout << "Generating compiled model in: " << generateCompiledModelOption.getValue() << endl;
+                    if (!buildCompiledModel(generateCompiledModelOption.getValue(), pRootSystem))
+                    {
+                        printErrorMessage("Could not generate compiled model in: "+generateCompiledModelOption.getValue(), silentOption.getValue());
+                    }
+                    printWaitingMessages(printDebugOption.getValue(), silentOption.getValue());
+                }
+
                 if (parameterImportOption.isSet())
                 {
                     cout << "Importing parameter values from file: " << parameterImportOption.getValue() << endl;
@@ -911,13 +985,42 @@ int main(int argc, char *argv[])
                         }
 
                         // Now disable all nodes and then enable the requested ones
+                        // If a variable name is given, only that variable will be logged (unless the entire port is also requested)
                         forEachPort(pRootSystem, [](hopsan::Port& port){port.setEnableLogging(false);});
                         for (const auto& port_name : logOnlyPortsOrVariables)
                         {
                             hopsan::Port* pPort = getPortWithFullName(pRootSystem, port_name);
                             if (pPort)
                             {
-                                pPort->setEnableLogging(true);
+                                std::vector<std::string> nameParts;
+                                splitStringOnDelimiter(port_name, '#', nameParts);
+                                const size_t numVariables = pPort->getNodeDataDescriptions() ? pPort->getNodeDataDescriptions()->size() : 0;
+                                if (nameParts.size() == 3)
+                                {
+                                    const int dataId = pPort->getNodeDataIdFromName(nameParts[2].c_str());
+                                    if (dataId < 0)
+                                    {
+                                        printWarningMessage("Could not find variable: '"+port_name+"' when processing logonly input");
+                                        continue;
+                                    }
+                                    if (!pPort->isLoggingEnabled())
+                                    {
+                                        pPort->setEnableLogging(true);
+                                        for (size_t v=0; v<numVariables; ++v)
+                                        {
+                                            pPort->setEnableVariableLogging(v, false);
+                                        }
+                                    }
+                                    pPort->setEnableVariableLogging(size_t(dataId), true);
+                                }
+                                else
+                                {
+                                    pPort->setEnableLogging(true);
+                                    for (size_t v=0; v<numVariables; ++v)
+                                    {
+                                        pPort->setEnableVariableLogging(v, true);
+                                    }
+                                }
                             }
                             else
                             {
@@ -942,6 +1045,41 @@ int main(int argc, char *argv[])
                         pRootSystem->setKeepValuesAsStartValues(true);
                     }
 
+                    pRootSystem->setUseNodeDataArena(nodeDataArenaOption.getValue());
+                    pRootSystem->setUseHierarchyFlattening(flattenHierarchyOption.getValue());
+                    if (compiledModelOption.isSet())
+                    {
+                        CompiledModel *pCompiledModel = gHopsanCore.loadCompiledModel(compiledModelOption.getValue().c_str());
+                        if (pCompiledModel)
+                        {
+                            pRootSystem->setCompiledModel(pCompiledModel);
+                        }
+                        printWaitingMessages(printDebugOption.getValue(), silentOption.getValue());
+                    }
+
+                    std::unique_ptr<SimulationProfiler> pProfiler;
+                    if (profileOption.isSet())
+                    {
+                        pProfiler.reset(new SimulationProfiler());
+                        pProfiler->setUseHardwareCounters(profileCountersOption.getValue());
+                        pRootSystem->setProfiler(pProfiler.get());
+                    }
+
+                    std::unique_ptr<hopsan::LogSink> pResultsStreamSink;
+                    if (resultsStreamOption.isSet())
+                    {
+                        pResultsStreamSink.reset(createResultsStreamSink(destinationPath+resultsStreamOption.getValue(), hmfPathOption.getValue()));
+                        if (pResultsStreamSink)
+                        {
+                            cout << "Streaming results to file: " << destinationPath+resultsStreamOption.getValue() << endl;
+                            pRootSystem->setLogSink(pResultsStreamSink.get());
+                        }
+                        else
+                        {
+                            doSimulate = false;
+                        }
+                    }
+
                     //! @todo maybe use simulation handler object instead
                     TicToc isoktimer("IsOkTime");
                     doSimulate = doSimulate && pRootSystem->checkModelBeforeSimulation();
@@ -962,13 +1100,76 @@ int main(int argc, char *argv[])
                     {
                         cout << "Simulating: " << startTime << " to " << stopTime << " with Ts: " << stepTime << "     Please Wait!" << endl;
                         TicToc simuTimer("SimulationTime");
-                        if(parallelOption.isSet()) {
-                            int nThreads = atoi(parallelOption.getValue().c_str());
+                        if(realtimeOption.isSet()) {
+                            if(parallelOption.isSet() || profileOption.isSet()) {
+                                printErrorMessage("Real-time simulation can not be combined with parallel simulation or profiling.");
+                                return -1;
+                            }
+                            RealtimeOptions realtimeOptions;
+                            string realtimeError;
+                            if(!parseRealtimeOptions(realtimeOption.getValue(), realtimeOptions, realtimeError)) {
+                                printErrorMessage(realtimeError);
+                                return -1;
+                            }
+                            realtimeOptions.stopTime = stopTime;
+                            if(pRootSystem->startRealtimeSimulation(realtimeOptions)) {
+                                printWaitingMessages(printDebugOption.getValue(), silentOption.getValue());
+                                // Print the progress every second while the simulation thread is running
+                                size_t numPolls = 0;
+                                while(pRootSystem->isRealtimeSimulationRunning()) {
+                                    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+                                    if(++numPolls % 10 == 0 && pRootSystem->isRealtimeSimulationRunning()) {
+                                        const RealtimeStatistics statistics = pRootSystem->getRealtimeStatistics();
+                                        printMessage("t: "+to_string(startTime+double(statistics.numSteps)*pRootSystem->getTimestep())+" overruns: "+to_string(statistics.numOverruns)+
+                                                     " max jitter: "+to_string(statistics.jitter.getMax()*1e6)+" us", silentOption.getValue());
+                                    }
+                                }
+                                pRootSystem->stopRealtimeSimulation();
+                                printRealtimeStatistics(pRootSystem->getRealtimeStatistics(), pRootSystem->getTimestep(), silentOption.getValue());
+                            }
+                            else {
+                                pRootSystem->stopSimulation("Could not start real-time simulation");
+                            }
+                        }
+                        else if(parallelOption.isSet()) {
+                            vector<string> parallelArgs;
+                            splitStringOnDelimiter(parallelOption.getValue(), ':', parallelArgs);
+                            int nThreads = parallelArgs.empty() ? 0 : atoi(parallelArgs[0].c_str());
                             if(nThreads < 0) {
                                 printErrorMessage("Number of threads cannot be negative.");
                                 return -1;
                             }
-                            pRootSystem->simulateMultiThreaded(startTime, stopTime, nThreads);
+                            BarrierPolicyT barrierPolicy = SpinBarrierPolicy;
+                            if(parallelArgs.size() > 1) {
+                                if(parallelArgs[1] == "block") {
+                                    barrierPolicy = SpinThenBlockBarrierPolicy;
+                                }
+                                else if(parallelArgs[1] == "backoff") {
+                                    barrierPolicy = BackoffBarrierPolicy;
+                                }
+                                else if(parallelArgs[1] != "spin") {
+                                    printErrorMessage("Unknown barrier policy: "+parallelArgs[1]+", use spin, block or backoff");
+                                    return -1;
+                                }
+                            }
+                            ParallelAlgorithmT algorithm = OfflineSchedulingAlgorithm;
+                            if(parallelArgs.size() > 2) {
+                                if(parallelArgs[2] == "partition") {
+                                    algorithm = GraphPartitioningAlgorithm;
+                                }
+                                else if(parallelArgs[2] != "offline") {
+                                    printErrorMessage("Unknown scheduling algorithm: "+parallelArgs[2]+", use offline or partition");
+                                    return -1;
+                                }
+                            }
+                            ThreadPlacementT threadPlacement;
+                            vector<int> threadPlacementCpus;
+                            if(!parseThreadPlacement(threadPlacementOption.getValue(), threadPlacement, threadPlacementCpus)) {
+                                printErrorMessage("Unknown thread placement: "+threadPlacementOption.getValue()+", use auto, none, compact, scatter or a list of processors");
+                                return -1;
+                            }
+                            pRootSystem->setThreadPlacement(threadPlacement, threadPlacementCpus);
+                            pRootSystem->simulateMultiThreaded(startTime, stopTime, nThreads, false, algorithm, barrierPolicy);
                         }
                         else {
                             pRootSystem->simulate(stopTime);
@@ -986,6 +1187,18 @@ int main(int argc, char *argv[])
                     }
 
                     pRootSystem->finalize();
+
+                    if (pProfiler)
+                    {
+                        pRootSystem->setProfiler(nullptr);
+                        printProfilingResults(pProfiler.get(), destinationPath+profileOption.getValue(), silentOption.getValue());
+                    }
+
+                    if (pResultsStreamSink)
+                    {
+                        cout << "Streamed " << pRootSystem->getNumStreamedLogSamples() << " log samples to file: " << destinationPath+resultsStreamOption.getValue() << endl;
+                        pRootSystem->setLogSink(nullptr);
+                    }
                 }
 
                 printWaitingMessages(printDebugOption.getValue(), silentOption.getValue());
@@ -151,6 +151,7 @@ SOURCES += \
     src/CoreUtilities/HopsanCoreMessageHandler.cpp \
     src/CoreUtilities/HmfLoader.cpp \
     src/ComponentUtilities/WhiteGaussianNoise.cpp \
+    src/ComponentUtilities/StateArchive.cpp \
     src/ComponentUtilities/SecondOrderTransferFunction.cpp \
     src/ComponentUtilities/matrix.cpp \
     src/ComponentUtilities/ludcmp.cpp \
@@ -175,7 +176,15 @@ SOURCES += \
     src/CoreUtilities/SimulationHandler.cpp \
     src/CoreUtilities/MultiThreadingUtilities.cpp \
     src/CoreUtilities/StringUtilities.cpp \
-    src/CoreUtilities/SaveRestoreSimulationPoint.cpp
+    src/CoreUtilities/SaveRestoreSimulationPoint.cpp \
+    src/CoreUtilities/LogStreaming.cpp \
+    src/CoreUtilities/GraphPartitioner.cpp \
+    src/CoreUtilities/EnsembleSimulation.cpp \
+    src/CoreUtilities/BinaryModelFile.cpp \
+    src/CoreUtilities/CompiledModel.cpp \
+    src/CoreUtilities/SimulationProfiler.cpp \
+    src/CoreUtilities/HardwareCounters.cpp \
+    src/CoreUtilities/RealtimeExecutor.cpp
 HEADERS += \
     include/win32dll.h \
     include/Port.h \
@@ -195,6 +204,7 @@ HEADERS += \
     include/CoreUtilities/ClassFactoryStatusCheck.hpp \
     include/CoreUtilities/ClassFactory.hpp \
     include/ComponentUtilities/WhiteGaussianNoise.h \
+    include/ComponentUtilities/StateArchive.h \
     include/ComponentUtilities/ValveHysteresis.h \
     include/ComponentUtilities/TurbulentFlowFunction.h \
     include/ComponentUtilities/SecondOrderTransferFunction.h \
@@ -211,6 +221,7 @@ HEADERS += \
     include/ComponentUtilities/AuxiliarySimulationFunctions.h \
     include/ComponentUtilities/AuxiliaryMathematicaWrapperFunctions.h \
     include/ComponentUtilities/TempDirectoryHandle.h \
+    include/ComponentUtilities/EnsembleBlock.h \
     include/Parameters.h \
     include/Components/DummyComponent.hpp \
     include/ComponentUtilities/EquationSystemSolver.h \
@@ -232,4 +243,12 @@ HEADERS += \
     include/CoreUtilities/ConnectionAssistant.h \
     include/CoreUtilities/AliasHandler.h \
     include/CoreUtilities/SimulationHandler.h \
-    include/CoreUtilities/SaveRestoreSimulationPoint.h
+    include/CoreUtilities/SaveRestoreSimulationPoint.h \
+    include/CoreUtilities/LogStreaming.h \
+    include/CoreUtilities/GraphPartitioner.h \
+    include/CoreUtilities/EnsembleSimulation.h \
+    include/CoreUtilities/BinaryModelFile.h \
+    include/CoreUtilities/CompiledModel.h \
+    include/CoreUtilities/SimulationProfiler.h \
+    include/CoreUtilities/HardwareCounters.h \
+    include/CoreUtilities/RealtimeExecutor.h
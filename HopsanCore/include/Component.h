@@ -58,6 +58,7 @@ class ComponentSystem;
 class HopsanEssentials;
 class HopsanCoreMessageHandler;
 class NumericalIntegrationSolver;
+class StateArchive;
 
 enum VariameterTypeEnumT {InputVariable, OutputVariable, OtherVariable};
 
@@ -85,6 +86,7 @@ class HOPSANCORE_DLLAPI Component
     friend class ConditionalComponentSystem;
     friend class HopsanEssentials; //Need to be able to set typename
     friend class NumericalIntegrationSolver;
+    template<typename ComponentT> friend void simulateCompiledComponent(ComponentT *pComponent);
 
 public:
     //! @brief Enum type for all CQS types
@@ -100,6 +102,10 @@ public:
     virtual bool initialize(const double startT, const double stopT);
     virtual void simulate(const double stopT);
 
+    // Ensemble simulation
+    virtual bool hasEnsembleSimulation() const;
+    void simulateEnsemble(Component *const *ppLanes, const size_t nLanes, const double stopT);
+
     //Enabled or disabled?
     void setDisabled(bool value);
     bool isDisabled() const;
@@ -179,6 +185,9 @@ public:
     virtual void loadStartValues();
     virtual void loadStartValuesFromSimulation();
 
+    // Internal simulation state
+    virtual void serializeState(StateArchive &rArchive);
+
     // Ports
     std::vector<Port*> getPortPtrVector() const;
     Port *getPort(const HString &rPortname) const;
@@ -244,6 +253,7 @@ protected:
     // Virtual functions
     virtual void initialize(); //!< @todo Maybe we should be able to return success true or false from components
     virtual void simulateOneTimestep();
+    virtual void simulateOneTimestepEnsemble(Component *const *ppLanes, const size_t nLanes);
     virtual void finalize();
     virtual void setTimestep(const double timestep);
     virtual size_t calcNumSimSteps(const double startT, const double stopT) const;
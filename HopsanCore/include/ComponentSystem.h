@@ -47,11 +47,22 @@
 namespace hopsan {
     class NumHopHelper;
     class ComponentSystemMultiThreadPrivates;
+    class CompiledModel;
+    class SimulationProfiler;
+    class SimulationThreadPool;
+    class RealtimeExecutor;
+    class RealtimeOptions;
+    class RealtimeStatistics;
+    class LogSink;
+    class LogStreamer;
+    class LogStreamVariable;
 
     class HOPSANCORE_DLLAPI ComponentSystem :public Component
     {
         friend class ConnectionAssistant;
         friend class AliasHandler;
+        friend class EnsembleSimulation;
+        friend class BinaryModelFileWriter;
 
     public:
         enum UniqeNameEnumT {UniqueComponentNameType, UniqueSysportNameTyp, UniqueSysparamNameType, UniqueAliasNameType, UniqueReservedNameType};
@@ -82,6 +93,10 @@ namespace hopsan {
         HString reserveUniqueName(const HString &rDesiredName, const UniqeNameEnumT type=UniqueReservedNameType);
         void unReserveUniqueName(const HString &rName);
 
+        // Copying
+        ComponentSystem *clone();
+        std::vector<ComponentSystem*> fork(const size_t numForks);
+
         // System Parameter functions
         bool renameParameter(const HString &rOldName, const HString &rNewName);
         virtual std::list<HString> getModelAssets() const;
@@ -129,18 +144,58 @@ namespace hopsan {
         bool checkModelBeforeSimulation();
         virtual bool preInitialize();
         bool initialize(const double startT, const double stopT);
+        bool reinitialize(const double startT, const double stopT);
+        void invalidateWarmRestart();
+        void setSimulationPointToRestore(const std::vector<char> &rData);
         void simulate(const double stopT);
         bool startRealtimeSimulation(double realTimeFactor=1);
-        virtual void simulateMultiThreaded(const double startT, const double stopT, const size_t nDesiredThreads = 0, const bool noChanges=false, ParallelAlgorithmT algorithm=OfflineSchedulingAlgorithm);
+        bool startRealtimeSimulation(const RealtimeOptions &rOptions);
+        void stopRealtimeSimulation();
+        bool isRealtimeSimulationRunning() const;
+        RealtimeStatistics getRealtimeStatistics() const;
+        virtual void simulateMultiThreaded(const double startT, const double stopT, const size_t nDesiredThreads = 0, const bool noChanges=false, ParallelAlgorithmT algorithm=OfflineSchedulingAlgorithm, BarrierPolicyT barrierPolicy=SpinBarrierPolicy);
         void finalize();
 
+        // Node data storage
+        void setUseNodeDataArena(const bool useArena);
+        bool usesNodeDataArena() const;
+
+        // Hierarchy flattening
+        void setUseHierarchyFlattening(const bool useFlattening);
+        bool usesHierarchyFlattening() const;
+
+        // Ahead-of-time compiled simulation schedule
+        void setCompiledModel(CompiledModel *pCompiledModel);
+        CompiledModel *getCompiledModel() const;
+        bool usesCompiledModel() const;
+        void getSimulationSchedule(std::vector<Component*> &rSignalComponents, std::vector<Component*> &rCComponents, std::vector<Component*> &rQComponents) const;
+
+        // Profiling
+        void setProfiler(SimulationProfiler *pProfiler);
+        SimulationProfiler *getProfiler() const;
+
+        // Multi-threaded load balancing
+        void setUseLoadRebalancing(const bool useRebalancing);
+        bool usesLoadRebalancing() const;
+        void setUseSignalLevelScheduling(const bool useLevelScheduling);
+        bool usesSignalLevelScheduling() const;
+
+        // Multi-threaded thread placement
+        void setThreadPlacement(const ThreadPlacementT placement, const std::vector<int> &rCpus=std::vector<int>());
+        ThreadPlacementT getThreadPlacement() const;
+        const std::vector<int> &getThreadPlacementCpus() const;
+
         bool simulateAndMeasureTime(const size_t nSteps);
         double getTotalMeasuredTime();
         void sortComponentVectorsByMeasuredTime();
         void distributeCcomponents(std::vector< std::vector<Component*> > &rSplitCVector, size_t nThreads);
         void distributeQcomponents(std::vector< std::vector<Component*> > &rSplitQVector, size_t nThreads);
         void distributeSignalcomponents(std::vector< std::vector<Component*> > &rSplitSignalVector, size_t nThreads);
+        void distributeSignalcomponentsByLevel(std::vector< std::vector<Component*> > &rSplitSignalVector, size_t nThreads);
+        void getSignalComponentDependencies(const std::vector<Component*> &rComponents, std::vector< std::vector<size_t> > &rDependencies) const;
         void distributeNodePointers(std::vector< std::vector<Node*> > &rSplitNodeVector, size_t nThreads);
+        void distributeComponentsByGraphPartitioning(std::vector< std::vector<Component*> > &rSplitCVector, std::vector< std::vector<Component*> > &rSplitQVector,
+                                                     std::vector< std::vector<Node*> > &rSplitNodeVector, size_t nThreads);
         void reschedule(size_t nThreads);
 
         // Set and get desired timestep
@@ -159,6 +214,9 @@ namespace hopsan {
         void setLogStartTime(const double logStartTime);
         size_t getNumLogSamples() const;
         size_t getNumActuallyLoggedSamples() const;
+        void setLogSink(LogSink *pSink, const size_t ringBufferSize=4096);
+        LogSink *getLogSink() const;
+        size_t getNumStreamedLogSamples() const;
 
         // Stop a running initialization or simulation
         void stopSimulation(const HString &rReason);
@@ -171,6 +229,13 @@ namespace hopsan {
         void unRegisterParameter(const HString &name);
         void addSearchPath(HString searchPath);
 
+        // Fast numeric parameter updates
+        ParameterHandle getParameterHandle(const HString &rComponentName, const HString &rParameterName);
+        using Component::setParameterValue;
+        bool setParameterValue(const ParameterHandle &rHandle, const double value);
+        void invalidateParameterHandles();
+        size_t getParameterSetGeneration() const;
+
         // Add and Remove sub-nodes
         void addSubNode(Node* pNode);
         void removeSubNode(Node* pNode);
@@ -206,6 +271,30 @@ namespace hopsan {
 //        void setLogSettingsSkipFactor(double factor, double start, double stop, double sampletime);
         void setupLogSlotsAndTs(const double simStartT, const double simStopT, const double simTs);
         void preAllocateLogSpace();
+        bool startLogStream();
+        void finishLogStream();
+        void collectLogStreamVariables(ComponentSystem *pSystem, std::vector<LogStreamVariable> &rVariables);
+        void streamLogSample();
+
+        // Node data arena specific functions
+        void packNodeDataArena();
+        void unpackNodeDataArena();
+
+        // Thread placement specific functions
+        void placeStorageInThreads(SimulationThreadPool *pThreadPool, const std::vector<int> &rThreadCpus);
+        void reallocateLogStorage();
+        void reallocateStorageRecursively();
+
+        // Hierarchy flattening
+        bool isFlattenableSubsystem(const Component *pComponent) const;
+        void collectFlattenedComponents(ComponentSystem *pSystem, std::vector<Component*> &rSignalComponents, std::vector<Component*> &rCComponents,
+                                        std::vector<Component*> &rQComponents);
+        void flattenHierarchy();
+        void unflattenHierarchy();
+
+        // Profiling
+        void simulateAndProfile(const size_t numSimulationSteps);
+        void endProfiledSimulation(const size_t numSimulationSteps);
 
         // Add and Remove subcomponent ptrs from storage vectors
         void addSubComponentPtrToStorage(Component* pComponent);
@@ -214,8 +303,19 @@ namespace hopsan {
         // Clear all contents of the system (use in destructor)
         void clear();
 
+        // Copy settings, sub components and connections into an empty system
+        bool copyContentsTo(ComponentSystem *pTarget);
+
         bool sortComponentVector(std::vector<Component*> &rOldSignalVector);
 
+        // Warm restart specific functions
+        bool evaluateChangedParametersRecursively(std::vector<HString> changedNames);
+        void clearChangedParametersRecursively();
+
+        // Simulation point restore specific functions
+        bool isRestoringSimulationPoint() const;
+        void logStartValuesRecursively();
+
         // UniqueName specific functions
         HString determineUniquePortName(const HString &rPortname);
         HString determineUniqueComponentName(const HString &rName) const;
@@ -265,6 +365,54 @@ namespace hopsan {
         double mRequestedLogStartTime, mLogTimeDt;
         bool mEnableLogData;
         std::vector<double> mTimeStorage;
+
+        // Log streaming variables
+        LogSink *mpLogSink;
+        size_t mLogSinkRingBufferSize;
+        LogStreamer *mpLogStreamer;
+        std::vector<std::pair<Node*, size_t> > mLogStreamNodeData;
+        size_t mnStreamedLogSamples, mNextLogStreamStep;
+        double mLogStreamLogT, mLogStreamSimT;
+        bool mIsLogStreamedByParent;
+
+        // Node data arena variables
+        bool mUseNodeDataArena;
+        std::vector<double> mNodeDataArena;
+
+        // Hierarchy flattening variables
+        bool mUseHierarchyFlattening;
+        std::vector<ComponentSystem*> mFlattenedSubsystems;
+        std::vector<Component*> mUnflattenedSignalptrs;
+        std::vector<Component*> mUnflattenedCptrs;
+        std::vector<Component*> mUnflattenedQptrs;
+
+        // Compiled model variables
+        CompiledModel *mpCompiledModel;
+        bool mIsCompiledModelBound;
+
+        // Profiling variables
+        SimulationProfiler *mpProfiler;
+
+        // Real-time simulation variables
+        RealtimeExecutor *mpRealtimeExecutor;
+
+        // Multi-threaded load balancing variables
+        bool mUseLoadRebalancing;
+        bool mUseSignalLevelScheduling;
+
+        // Thread placement variables
+        ThreadPlacementT mThreadPlacement;
+        std::vector<int> mThreadPlacementCpus;
+
+        // Parameter handle variables
+        size_t mParameterSetGeneration;
+
+        // Warm restart variables
+        bool mCanWarmRestart;
+        bool mIsWarmRestarting;
+
+        // Simulation point restore variables
+        std::vector<char> mSimulationPointToRestore;
     };
 
 
@@ -274,7 +422,7 @@ namespace hopsan {
         static Component* Creator(){ return new ConditionalComponentSystem(); }
         void configure();
         void simulate(const double stopT);
-        void simulateMultiThreaded(const double startT, const double stopT, const size_t nDesiredThreads, const bool noChanges, ParallelAlgorithmT algorithm);
+        void simulateMultiThreaded(const double startT, const double stopT, const size_t nDesiredThreads, const bool noChanges, ParallelAlgorithmT algorithm, BarrierPolicyT barrierPolicy);
     private:
         double *mpCondition;
         bool mAsleep;
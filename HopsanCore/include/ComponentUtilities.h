@@ -48,4 +48,6 @@
 #include "ComponentUtilities/EquationSystemSolver.h"
 #include "ComponentUtilities/LookupTable.h"
 #include "ComponentUtilities/TempDirectoryHandle.h"
+#include "ComponentUtilities/EnsembleBlock.h"
+#include "ComponentUtilities/StateArchive.h"
 #endif // COMPONENTUTILITIES_H_INCLUDED
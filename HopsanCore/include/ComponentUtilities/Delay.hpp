@@ -35,6 +35,7 @@
 #define DELAY_HPP_INCLUDED
 
 #include "stddef.h"
+#include "StateArchive.h"
 
 namespace hopsan {
 
@@ -172,6 +173,24 @@ public:
         return mSize;
     }
 
+    //! @brief Save or restore the delay buffer contents, the buffer is reallocated if the restored size differs
+    //! @param [in,out] rArchive The state archive
+    void serializeState(StateArchive &rArchive)
+    {
+        size_t size = mSize;
+        rArchive.serialize(size);
+        if (rArchive.isRestoring() && rArchive.isOK() && (size != mSize))
+        {
+            initialize(int(size), T());
+        }
+        rArchive.serialize(mNewest);
+        rArchive.serialize(mOldest);
+        if (mpArray != 0)
+        {
+            rArchive.serializeBytes(mpArray, mSize*sizeof(T));
+        }
+    }
+
     //! @brief Clear the delay buffer, deleting all data
     void clear()
     {
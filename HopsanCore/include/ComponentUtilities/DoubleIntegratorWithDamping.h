@@ -35,6 +35,7 @@
 #define DOUBLEINTEGRATORWITHDAMPING_H_INCLUDED
 
 #include "win32dll.h"
+#include "StateArchive.h"
 
 namespace hopsan {
 
@@ -50,6 +51,7 @@ namespace hopsan {
         void redoIntegrate(double u);
         double valueFirst();
         double valueSecond();
+        void serializeState(StateArchive &rArchive);
 
     private:
         double mDelayU, mDelayY, mDelaySY;
@@ -35,6 +35,7 @@
 #define DOUBLEINTEGRATORWITHDAMPINGANDCOULUMBFRICTION_H_INCLUDED
 
 #include "win32dll.h"
+#include "StateArchive.h"
 
 namespace hopsan {
 
@@ -51,6 +52,7 @@ namespace hopsan {
         void redoIntegrate(double u);
         double valueFirst();
         double valueSecond();
+        void serializeState(StateArchive &rArchive);
 
     private:
         double mDelayU, mDelayY, mDelaySY;
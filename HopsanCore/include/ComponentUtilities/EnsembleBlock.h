@@ -0,0 +1,146 @@
+/*-----------------------------------------------------------------------------
+
+ Copyright 2017 Hopsan Group
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+
+
+ The full license is available in the file LICENSE.
+ For details about the 'Hopsan Group' or information about Authors and
+ Contributors see the HOPSANGROUP and AUTHORS files that are located in
+ the Hopsan source code root directory.
+
+-----------------------------------------------------------------------------*/
+
+//!
+//! @file   EnsembleBlock.h
+//!
+//! @brief Contains the Component Utility EnsembleBlock class, used to write vectorised ensemble simulation kernels
+//!
+//$Id$
+
+#ifndef ENSEMBLEBLOCK_H_INCLUDED
+#define ENSEMBLEBLOCK_H_INCLUDED
+
+#include <cstddef>
+
+//! @brief The number of ensemble lanes that are processed together in one EnsembleBlock
+//! @details Matches the number of doubles in one vector register for the instruction set the library is built for
+#ifndef HOPSAN_ENSEMBLE_LANE_WIDTH
+#if defined(__AVX512F__)
+#define HOPSAN_ENSEMBLE_LANE_WIDTH 8
+#elif defined(__AVX__)
+#define HOPSAN_ENSEMBLE_LANE_WIDTH 4
+#else
+#define HOPSAN_ENSEMBLE_LANE_WIDTH 2
+#endif
+#endif
+
+namespace hopsan {
+
+class Component;
+
+//! @brief Iterates over the lanes of an ensemble in blocks of fixed width
+//! @details Values are loaded from each lane component into small fixed size arrays that the compiler can keep in vector registers.
+//! The last block may be partial, then the last lane is repeated in the unused slots so that no special treatment is needed
+//! in the kernel, only the used slots are stored back.
+//! @ingroup ComponentUtilityClasses
+template<typename ComponentT, size_t Width=HOPSAN_ENSEMBLE_LANE_WIDTH>
+class EnsembleBlock
+{
+public:
+    static const size_t width = Width;
+
+    EnsembleBlock(Component *const *ppLanes, const size_t nLanes)
+    {
+        mppLanes = ppLanes;
+        mnLanes = nLanes;
+        mBegin = 0;
+    }
+
+    //! @brief Check if the block refers to any lanes, use together with next() to loop over all blocks
+    inline bool isValid() const
+    {
+        return mBegin < mnLanes;
+    }
+
+    //! @brief Move on to the next block of lanes
+    inline void next()
+    {
+        mBegin += Width;
+    }
+
+    //! @brief Returns the number of lanes in the current block, only the last block can be smaller than the width
+    inline size_t size() const
+    {
+        return (mnLanes-mBegin < Width) ? (mnLanes-mBegin) : Width;
+    }
+
+    //! @brief Returns the component of a lane in the current block, unused slots refer to the last lane
+    inline ComponentT *lane(const size_t i) const
+    {
+        const size_t l = (mBegin+i < mnLanes) ? (mBegin+i) : (mnLanes-1);
+        return static_cast<ComponentT*>(mppLanes[l]);
+    }
+
+    //! @brief Load the values pointed to by a data pointer member (usually a node data pointer) in each lane
+    //! @param [in] pDataPtr The data pointer member, like &MyComponent::mpND_in
+    //! @param [out] pValues Array with room for width values
+    inline void load(double *ComponentT::*pDataPtr, double *pValues) const
+    {
+        for (size_t i=0; i<Width; ++i)
+        {
+            pValues[i] = *(lane(i)->*pDataPtr);
+        }
+    }
+
+    //! @brief Store values through a data pointer member (usually a node data pointer) in each used lane
+    //! @param [in] pDataPtr The data pointer member, like &MyComponent::mpND_out
+    //! @param [in] pValues Array with width values
+    inline void store(double *ComponentT::*pDataPtr, const double *pValues) const
+    {
+        const size_t n = size();
+        for (size_t i=0; i<n; ++i)
+        {
+            *(static_cast<ComponentT*>(mppLanes[mBegin+i])->*pDataPtr) = pValues[i];
+        }
+    }
+
+    //! @brief Load a plain double member variable from each lane
+    inline void loadMember(double ComponentT::*pMember, double *pValues) const
+    {
+        for (size_t i=0; i<Width; ++i)
+        {
+            pValues[i] = lane(i)->*pMember;
+        }
+    }
+
+    //! @brief Store a plain double member variable in each used lane
+    inline void storeMember(double ComponentT::*pMember, const double *pValues) const
+    {
+        const size_t n = size();
+        for (size_t i=0; i<n; ++i)
+        {
+            static_cast<ComponentT*>(mppLanes[mBegin+i])->*pMember = pValues[i];
+        }
+    }
+
+private:
+    Component *const *mppLanes;
+    size_t mnLanes;
+    size_t mBegin;
+};
+
+}
+
+#endif // ENSEMBLEBLOCK_H_INCLUDED
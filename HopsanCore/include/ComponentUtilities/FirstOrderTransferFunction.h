@@ -57,6 +57,7 @@ namespace hopsan {
         double delayedU() const;
         double delayedY() const;
         bool isSaturated() const;
+        void serializeState(StateArchive &rArchive);
 
     protected:
         double mValue;
@@ -89,6 +90,7 @@ namespace hopsan {
         void recalculateCoefficients();
         double update(double u);
         double value();
+        void serializeState(StateArchive &rArchive);
 
     private:
         double mValue;
@@ -74,6 +74,14 @@ public:
         return mDelayY;
     }
 
+    //! @brief Saves or restores the integrator state
+    //! @param[in,out] rArchive The archive to save to or restore from
+    inline void serializeState(StateArchive &rArchive)
+    {
+        rArchive.serialize(mDelayU);
+        rArchive.serialize(mDelayY);
+    }
+
 protected:
     double mDelayU, mDelayY;
     double mTimeStep;
@@ -129,6 +137,15 @@ public:
         return update(u);
     }
 
+    //! @brief Saves or restores the integrator state, including the backup buffers
+    //! @param[in,out] rArchive The archive to save to or restore from
+    inline void serializeState(StateArchive &rArchive)
+    {
+        Integrator::serializeState(rArchive);
+        mBackupU.serializeState(rArchive);
+        mBackupY.serializeState(rArchive);
+    }
+
 protected:
     Delay mBackupU, mBackupY;
 
@@ -48,6 +48,7 @@ namespace hopsan {
         void setMinMax(double min, double max);
         double update(double u);
 	double value();
+        void serializeState(StateArchive &rArchive);
 
     private:
         double mDelayU, mDelayY;
@@ -59,6 +59,7 @@ namespace hopsan {
         double delayedY() const;
         double delayed2Y() const;
         bool isSaturated() const;
+        void serializeState(StateArchive &rArchive);
 
     private:
         double mValue;
@@ -83,6 +84,7 @@ namespace hopsan {
         double update(double u);
         double value();
         void recalculateCoefficients();
+        void serializeState(StateArchive &rArchive);
 
     private:
         double mValue;
@@ -0,0 +1,75 @@
+/*-----------------------------------------------------------------------------
+
+ Copyright 2017 Hopsan Group
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+
+
+ The full license is available in the file LICENSE.
+ For details about the 'Hopsan Group' or information about Authors and
+ Contributors see the HOPSANGROUP and AUTHORS files that are located in
+ the Hopsan source code root directory.
+
+-----------------------------------------------------------------------------*/
+
+//!
+//! @file   StateArchive.h
+//!
+//! @brief Contains the Component Utility StateArchive class, used to save and restore the internal simulation state of components
+//!
+//$Id$
+
+#ifndef STATEARCHIVE_H_INCLUDED
+#define STATEARCHIVE_H_INCLUDED
+
+#include "win32dll.h"
+#include <cstddef>
+#include <vector>
+
+namespace hopsan {
+
+//! @brief A binary archive for the internal simulation state of a component, such as delay buffers and integrator states
+//! @details The same serialize functions are used both when saving and when restoring, so a component only needs one
+//! Component::serializeState() function that passes all of its state variables to the archive in a fixed order.
+//! When saving, the values are appended to the archive. When restoring, the values are overwritten with the archived ones.
+//! If a restoring archive runs out of data (the component state layout has changed) isOK() will return false.
+//! @ingroup ComponentUtilityClasses
+class HOPSANCORE_DLLAPI StateArchive
+{
+public:
+    StateArchive();
+    StateArchive(const char *pData, const size_t size);
+
+    bool isRestoring() const;
+    bool isOK() const;
+
+    void serialize(double &rValue);
+    void serialize(int &rValue);
+    void serialize(size_t &rValue);
+    void serialize(bool &rValue);
+    void serialize(double *pValues, const size_t numValues);
+    void serialize(std::vector<double> &rValues);
+    void serializeBytes(void *pData, const size_t numBytes);
+
+    const std::vector<char> &getData() const;
+
+private:
+    std::vector<char> mData;
+    const char *mpRestoreData;
+    size_t mRestoreSize, mRestorePosition;
+    bool mIsOK;
+};
+
+}
+
+#endif // STATEARCHIVE_H_INCLUDED
@@ -35,14 +35,27 @@
 #define WHITEGAUSSIANNOISE_H_INCLUDED
 
 #include "win32dll.h"
+#include "StateArchive.h"
+#include <cstdint>
 
 namespace hopsan {
 
+    //! @brief Generates white Gaussian noise with zero mean and unit standard deviation
+    //! @details The static getValue() uses the global rand() generator. Instances also have their own generator,
+    //! used by getNextValue(), whose state can be saved and restored with serializeState().
     //! @ingroup ComponentUtilityClasses
     class HOPSANCORE_DLLAPI WhiteGaussianNoise
     {
     public:
+        WhiteGaussianNoise();
         static double getValue();
+        double getNextValue();
+        void setSeed(uint64_t seed);
+        void serializeState(StateArchive &rArchive);
+
+    private:
+        double nextUniform();
+        uint64_t mState;
     };
 }
 
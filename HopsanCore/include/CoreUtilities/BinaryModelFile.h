@@ -0,0 +1,50 @@
+/*-----------------------------------------------------------------------------
+
+ Copyright 2017 Hopsan Group
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+
+
+ The full license is available in the file LICENSE.
+ For details about the 'Hopsan Group' or information about Authors and
+ Contributors see the HOPSANGROUP and AUTHORS files that are located in
+ the Hopsan source code root directory.
+
+-----------------------------------------------------------------------------*/
+
+//!
+//! @file   BinaryModelFile.h
+//!
+//! @brief Contains functions for saving and loading precompiled binary model files (.hmfb)
+//!
+//$Id$
+
+#ifndef BINARYMODELFILE_H_INCLUDED
+#define BINARYMODELFILE_H_INCLUDED
+
+#include "win32dll.h"
+#include "HopsanTypes.h"
+
+namespace hopsan {
+
+//Forward declaration
+class ComponentSystem;
+class HopsanEssentials;
+
+bool HOPSANCORE_DLLAPI isBinaryModelFilePath(const HString &rFilePath);
+bool HOPSANCORE_DLLAPI saveBinaryModelFile(const HString &rFilePath, ComponentSystem *pRootSystem, const HString &rSourceFilePath, const double startTime, const double stopTime);
+ComponentSystem* loadBinaryModelFile(const HString &rFilePath, HopsanEssentials *pHopsanEssentials, double &rStartTime, double &rStopTime);
+
+}
+
+#endif // BINARYMODELFILE_H_INCLUDED
@@ -0,0 +1,85 @@
+/*-----------------------------------------------------------------------------
+
+ Copyright 2017 Hopsan Group
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+
+
+ The full license is available in the file LICENSE.
+ For details about the 'Hopsan Group' or information about Authors and
+ Contributors see the HOPSANGROUP and AUTHORS files that are located in
+ the Hopsan source code root directory.
+
+-----------------------------------------------------------------------------*/
+
+//!
+//! @file   CompiledModel.h
+//!
+//! @brief Contains the CompiledModel class, for model specific simulation schedules that are generated and compiled ahead of time
+//!
+//$Id$
+
+#ifndef COMPILEDMODEL_H_INCLUDED
+#define COMPILEDMODEL_H_INCLUDED
+
+#include "win32dll.h"
+#include "HString.h"
+#include <vector>
+
+namespace hopsan {
+
+//Forward declaration
+class Component;
+
+//! @brief Base class for a simulation schedule that is generated from one model and compiled ahead of time
+//! @details The generated code holds a pointer of the actual type to each component, in the (flattened) execution order of the model.
+//! This makes it possible to call simulateOneTimestep() of each component without virtual dispatch, and for the compiler to inline it.
+//! The model is still loaded, connected, initialized and logged by the top-level system, the compiled model only replaces its simulation loop.
+//! A compiled model is created by the create_compiled_model() function in a compiled model library, see HopsanEssentials::loadCompiledModel()
+class HOPSANCORE_DLLAPI CompiledModel
+{
+public:
+    virtual ~CompiledModel();
+
+    //! @brief Returns the name of the model that the schedule was generated from
+    virtual const char *getModelName() const = 0;
+
+    //! @brief Look up the components of the schedule in the (flattened) component vectors of an initialized top-level system
+    //! @param[in] rSignalComponents The signal components, in execution order
+    //! @param[in] rCComponents The C components, in execution order
+    //! @param[in] rQComponents The Q components, in execution order
+    //! @returns true if the components are the same as when the schedule was generated, else false
+    virtual bool bind(const std::vector<Component*> &rSignalComponents, const std::vector<Component*> &rCComponents,
+                      const std::vector<Component*> &rQComponents) = 0;
+
+    //! @brief Simulate all components one timestep
+    //! @param[in] time The new simulation time of the top-level system
+    virtual void simulateOneTimestep(const double time) = 0;
+};
+
+HString HOPSANCORE_DLLAPI getCompiledModelComponentPath(const Component *pComponent);
+bool HOPSANCORE_DLLAPI isCompiledModelComponent(const Component *pComponent, const char *path, const char *typeName);
+
+//! @brief Simulate one timestep of a component with a type that is known at compile time
+//! @details This is what Component::simulate() does for one step, but simulateOneTimestep() is not called through the virtual table
+//! @param[in] pComponent The component, it must be of type ComponentT exactly
+template<typename ComponentT>
+inline void simulateCompiledComponent(ComponentT *pComponent)
+{
+    pComponent->mTime += pComponent->mTimestep;
+    pComponent->ComponentT::simulateOneTimestep();
+}
+
+}
+
+#endif // COMPILEDMODEL_H_INCLUDED
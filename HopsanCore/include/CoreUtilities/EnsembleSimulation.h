@@ -0,0 +1,96 @@
+/*-----------------------------------------------------------------------------
+
+ Copyright 2017 Hopsan Group
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+
+
+ The full license is available in the file LICENSE.
+ For details about the 'Hopsan Group' or information about Authors and
+ Contributors see the HOPSANGROUP and AUTHORS files that are located in
+ the Hopsan source code root directory.
+
+-----------------------------------------------------------------------------*/
+
+//!
+//! @file   EnsembleSimulation.h
+//!
+//! @brief Contains the EnsembleSimulation class, for lockstep simulation of several variants of the same model
+//!
+//$Id$
+
+#ifndef ENSEMBLESIMULATION_H
+#define ENSEMBLESIMULATION_H
+
+#include <cstddef>
+#include <vector>
+#include "win32dll.h"
+
+namespace hopsan {
+
+// Forward declaration
+class Component;
+class ComponentSystem;
+class Node;
+
+//! @brief Simulates several structurally identical models (lanes), typically with different parameter values, in lockstep
+//! @details The node data of all lanes is placed in one shared arena, with the lanes of each node next to each other.
+//! Each time step, every component is simulated in all lanes of a lane group before moving on to the next component. Components that
+//! implement Component::simulateOneTimestepEnsemble() process all lanes in one call, the others are simulated one lane at a time.
+//! The lanes must not be modified, initialized or simulated by anyone else between initialize() and finalize(),
+//! and they must outlive the ensemble.
+class HOPSANCORE_DLLAPI EnsembleSimulation
+{
+public:
+    EnsembleSimulation(const std::vector<ComponentSystem*> &rLanes);
+    ~EnsembleSimulation();
+
+    bool initialize(const double startT, const double stopT);
+    bool simulate(const double stopT);
+    void finalize();
+
+    void setLaneGroupSize(const size_t lanesPerGroup);
+    size_t getLaneGroupSize() const;
+
+    size_t getNumLanes() const;
+    size_t getNumEnsembleComponents() const;
+    size_t getNumFallbackComponents() const;
+
+private:
+    // The ensemble refers to the lanes and must not be copied
+    EnsembleSimulation(const EnsembleSimulation &);
+    EnsembleSimulation &operator=(const EnsembleSimulation &);
+
+    bool matchNodes();
+    bool matchComponents();
+    void restoreNodeData();
+
+    std::vector<ComponentSystem*> mLanes;
+    std::vector<bool> mLanesUsedNodeDataArena;
+    std::vector<bool> mLanesUsedHierarchyFlattening;
+    size_t mLaneGroupSize;
+
+    // The node in each lane, lane index is the fastest changing
+    std::vector<Node*> mLaneNodes;
+    std::vector<double> mNodeDataArena;
+
+    // The component in each lane in execution order, lane index is the fastest changing
+    std::vector<Component*> mLaneComponents;
+    std::vector<bool> mUseEnsembleSimulation;
+    bool mHasMovedNodeData;
+    bool mIsInitialized;
+};
+
+}
+
+#endif // ENSEMBLESIMULATION_H
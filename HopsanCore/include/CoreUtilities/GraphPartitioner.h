@@ -0,0 +1,69 @@
+/*-----------------------------------------------------------------------------
+
+ Copyright 2017 Hopsan Group
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+
+
+ The full license is available in the file LICENSE.
+ For details about the 'Hopsan Group' or information about Authors and
+ Contributors see the HOPSANGROUP and AUTHORS files that are located in
+ the Hopsan source code root directory.
+
+-----------------------------------------------------------------------------*/
+
+//$Id$
+
+#ifndef GRAPHPARTITIONER_H
+#define GRAPHPARTITIONER_H
+
+#include <cstddef>
+#include <vector>
+#include "win32dll.h"
+
+namespace hopsan {
+
+//! @brief Multilevel partitioner for undirected graphs with weighted vertices and edges
+//! @details The graph is partitioned into a given number of parts so that the total weight of the cut edges is minimized,
+//! while the vertex weight of each part is kept within a tolerance from an equal share.
+//! Each vertex can have several weights (constraints) that are balanced individually, this is used for C and Q components
+//! since they are simulated in separate phases. The parts are created by recursive bisection, where each bisection
+//! coarsens the graph by heavy-edge matching, bisects the coarsest graph by greedy graph growing and then refines
+//! the bisection with Fiduccia-Mattheyses passes while projecting it back to the original graph.
+class HOPSANCORE_DLLAPI GraphPartitioner
+{
+public:
+    GraphPartitioner(const size_t nVertices, const size_t nConstraints=1);
+
+    void setVertexWeight(const size_t vertex, const size_t constraint, const double weight);
+    void addEdge(const size_t vertexA, const size_t vertexB, const double weight=1.0);
+    void setImbalanceTolerance(const double tolerance);
+
+    void partition(const size_t nParts, std::vector<size_t> &rPartOfVertex) const;
+
+    double getCutWeight(const std::vector<size_t> &rPartOfVertex) const;
+    double getImbalance(const std::vector<size_t> &rPartOfVertex, const size_t nParts) const;
+
+private:
+    size_t mnVertices;
+    size_t mnConstraints;
+    double mImbalanceTolerance;
+    std::vector<double> mVertexWeights;
+    std::vector<size_t> mEdgeVerticesA;
+    std::vector<size_t> mEdgeVerticesB;
+    std::vector<double> mEdgeWeights;
+};
+
+}
+
+#endif // GRAPHPARTITIONER_H
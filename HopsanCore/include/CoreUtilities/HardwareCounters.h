@@ -0,0 +1,69 @@
+/*-----------------------------------------------------------------------------
+
+ Copyright 2017 Hopsan Group
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+
+
+ The full license is available in the file LICENSE.
+ For details about the 'Hopsan Group' or information about Authors and
+ Contributors see the HOPSANGROUP and AUTHORS files that are located in
+ the Hopsan source code root directory.
+
+-----------------------------------------------------------------------------*/
+
+//$Id$
+
+#ifndef HARDWARECOUNTERS_H
+#define HARDWARECOUNTERS_H
+
+#include <stdint.h>
+#include "win32dll.h"
+#include "HopsanTypes.h"
+
+namespace hopsan {
+
+//! @brief Hardware performance counters of the calling thread
+//! @details Uses perf_event_open on Linux, where the counters are read as one group so that they cover the same interval. Only user
+//! space events of the thread that opened the counters are counted. Counters that the CPU, the kernel or the permissions
+//! (/proc/sys/kernel/perf_event_paranoid) do not allow are unavailable, on other platforms no counters are available.
+class HOPSANCORE_DLLAPI HardwareCounters
+{
+public:
+    enum CounterT {Cycles, Instructions, CacheMisses, BranchMisses, NumCounters};
+
+    HardwareCounters();
+    ~HardwareCounters();
+    bool open();
+    void close();
+    bool isOpen() const;
+    bool isAvailable(const CounterT counter) const;
+    bool read(uint64_t *pValues) const;
+    const HString &getErrorMessage() const;
+
+    static const char *getCounterName(const CounterT counter);
+
+private:
+    HardwareCounters(const HardwareCounters &);
+    HardwareCounters &operator=(const HardwareCounters &);
+
+    int mGroupFd;
+    int mFds[NumCounters];
+    size_t mReadIndex[NumCounters];
+    size_t mnOpen;
+    HString mErrorMessage;
+};
+
+}
+
+#endif // HARDWARECOUNTERS_H
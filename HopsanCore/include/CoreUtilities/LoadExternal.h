@@ -41,6 +41,7 @@ namespace hopsan {
 
 //Forward Declaration
 class HopsanCoreMessageHandler;
+class CompiledModel;
 
 class LoadedLibInfo
 {
@@ -61,11 +62,13 @@ private:
 
     typedef std::map<HString, LoadedLibInfo> LoadedExtLibsMapT;
     LoadedExtLibsMapT mLoadedExtLibsMap;
+    std::vector<void*> mLoadedCompiledModelLibs;
 
 public:
     LoadExternal(ComponentFactory* pComponentFactory, NodeFactory* pNodefactory, HopsanCoreMessageHandler *pMessenger);
     bool load(const HString &rLibpath);
     bool unLoad(const HString &rLibpath);
+    CompiledModel *loadCompiledModel(const HString &rLibpath);
     void setFactory();
     void getLoadedLibNames(std::vector<HString> &rLibNames);
     void getLibContents(const HString &rLibpath, std::vector<HString> &rComponents, std::vector<HString> &rNodes);
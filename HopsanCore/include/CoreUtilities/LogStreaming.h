@@ -0,0 +1,219 @@
+/*-----------------------------------------------------------------------------
+
+ Copyright 2017 Hopsan Group
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+
+
+ The full license is available in the file LICENSE.
+ For details about the 'Hopsan Group' or information about Authors and
+ Contributors see the HOPSANGROUP and AUTHORS files that are located in
+ the Hopsan source code root directory.
+
+-----------------------------------------------------------------------------*/
+
+//$Id$
+
+#ifndef LOGSTREAMING_H
+#define LOGSTREAMING_H
+
+#include <vector>
+#include <fstream>
+#include <atomic>
+#include "win32dll.h"
+#include "HopsanTypes.h"
+#include "CoreUtilities/MultiThreadingUtilities.h"
+
+#if defined(HOPSANCORE_USEMULTITHREADING)
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#endif
+
+namespace hopsan {
+
+//! @brief Description of one variable (column) in a log stream
+class LogStreamVariable
+{
+public:
+    HString name;
+    HString unit;
+    HString quantity;
+};
+
+//! @brief Base class for log sinks, a log sink receives logged samples in chunks while a simulation is running
+//! @details Each sample is one row with the log time followed by the value of each streamed variable.
+//! The first variable given to open() is always the time.
+class HOPSANCORE_DLLAPI LogSink
+{
+public:
+    virtual ~LogSink();
+
+    //! @brief Open the sink, called once before the first sample is written
+    //! @param [in] rVariables The variables (columns) in each sample, starting with time
+    //! @returns True if the sink could be opened
+    virtual bool open(const std::vector<LogStreamVariable> &rVariables) = 0;
+
+    //! @brief Write a chunk of samples
+    //! @param [in] pSamples Pointer to nSamples consecutive samples (rows)
+    //! @param [in] nSamples The number of samples to write
+    //! @returns True if the samples could be written
+    virtual bool write(const double *pSamples, const size_t nSamples) = 0;
+
+    //! @brief Close the sink, called once after the last sample has been written
+    virtual void close() = 0;
+
+    const HString &getLastError() const;
+
+protected:
+    HString mLastError;
+};
+
+//! @brief Log sink that writes samples as rows in a CSV file
+//! @details The first line contains the variable names and the second line the units
+class HOPSANCORE_DLLAPI CSVLogSink : public LogSink
+{
+public:
+    CSVLogSink(const HString &rFilePath);
+    bool open(const std::vector<LogStreamVariable> &rVariables);
+    bool write(const double *pSamples, const size_t nSamples);
+    void close();
+
+private:
+    HString mFilePath;
+    std::ofstream mFile;
+    size_t mSampleSize;
+};
+
+//! @brief Log sink that writes samples as raw doubles in a binary file
+//! @details The file starts with a header: the 8 character identifier HOPLOGS1, the number of columns (uint32)
+//! and then for each column the name and the unit (uint32 length followed by the characters).
+//! After the header the samples follow as native doubles, one row of all columns per sample.
+class HOPSANCORE_DLLAPI BinaryLogSink : public LogSink
+{
+public:
+    BinaryLogSink(const HString &rFilePath);
+    bool open(const std::vector<LogStreamVariable> &rVariables);
+    bool write(const double *pSamples, const size_t nSamples);
+    void close();
+
+private:
+    HString mFilePath;
+    std::ofstream mFile;
+    size_t mSampleSize;
+};
+
+//! @brief Lock-free ring buffer for log samples, with one producer and one consumer thread
+class HOPSANCORE_DLLAPI LogRingBuffer
+{
+public:
+    LogRingBuffer();
+    void setup(const size_t nSlots, const size_t sampleSize);
+
+    //! @brief Returns a pointer to the next free sample slot, or 0 if the buffer is full (producer only)
+    inline double *beginWrite()
+    {
+        const size_t writeCount = mWriteCount.load(std::memory_order_relaxed);
+        if (writeCount - mReadCount.load(std::memory_order_acquire) >= mnSlots)
+        {
+            return 0;
+        }
+        return &mBuffer[(writeCount % mnSlots)*mSampleSize];
+    }
+
+    //! @brief Publish the sample slot returned by beginWrite() (producer only)
+    inline void endWrite()
+    {
+        mWriteCount.store(mWriteCount.load(std::memory_order_relaxed)+1, std::memory_order_release);
+    }
+
+    size_t beginRead(const double **ppSamples) const;
+    void endRead(const size_t nSamples);
+    size_t getNumUsedSlots() const;
+    size_t getNumSlots() const;
+
+private:
+    std::vector<double> mBuffer;
+    size_t mnSlots;
+    size_t mSampleSize;
+    // The counters only increase, they are padded to separate cache lines to avoid false sharing between the threads
+    char mPadding1[64];
+    std::atomic<size_t> mWriteCount;
+    char mPadding2[64];
+    std::atomic<size_t> mReadCount;
+    char mPadding3[64];
+};
+
+//! @brief Streams log samples through a ring buffer to a log sink
+//! @details When multi-threading is available a background writer thread drains the ring buffer while the simulation is running,
+//! otherwise the buffer is drained by the simulation thread whenever it becomes full
+class HOPSANCORE_DLLAPI LogStreamer
+{
+public:
+    LogStreamer(LogSink *pSink, const size_t ringBufferSize);
+    ~LogStreamer();
+
+    bool start(const std::vector<LogStreamVariable> &rVariables);
+    bool finish();
+
+    //! @brief Returns a pointer to where the next sample should be written, waits for the writer if the ring buffer is full
+    inline double *beginSample()
+    {
+        double *pSample = mRingBuffer.beginWrite();
+        if (!pSample)
+        {
+            pSample = waitForFreeSlot();
+        }
+        return pSample;
+    }
+
+    //! @brief Publish the sample written to the pointer returned by beginSample()
+    inline void endSample()
+    {
+        mRingBuffer.endWrite();
+#if defined(HOPSANCORE_USEMULTITHREADING)
+        if (mRingBuffer.getNumUsedSlots() >= mWakeWriterThreshold)
+        {
+            mWakeWriter.notify_one();
+        }
+#endif
+    }
+
+    bool hasFailed() const;
+    const HString &getLastError() const;
+
+private:
+    double *waitForFreeSlot();
+    void drain();
+#if defined(HOPSANCORE_USEMULTITHREADING)
+    void writerLoop();
+#endif
+
+    LogSink *mpSink;
+    LogRingBuffer mRingBuffer;
+    size_t mRingBufferSize;
+    size_t mWakeWriterThreshold;
+    bool mIsStarted;
+    std::atomic<bool> mFailed;
+    HString mLastError;
+#if defined(HOPSANCORE_USEMULTITHREADING)
+    std::thread mWriterThread;
+    std::mutex mWakeMutex;
+    std::condition_variable mWakeWriter;
+    std::atomic<bool> mStopWriter;
+#endif
+};
+
+}
+
+#endif // LOGSTREAMING_H
@@ -34,9 +34,11 @@
 #include <cstdlib>
 #include <iostream>
 #include <vector>
+#include <string>
 #include <cstddef>
 #include <algorithm>
 #include "win32dll.h"
+#include "CoreUtilities/SimulationHandler.h"
 
 #if (__cplusplus >= 201103L) && !defined(HOPSANCORE_NOMULTITHREADING)
 #define HOPSANCORE_USEMULTITHREADING
@@ -46,6 +48,10 @@
 namespace hopsan {
 
 size_t HOPSANCORE_DLLAPI determineActualNumberOfThreads(const size_t nDesiredThreads);
+std::vector<int> HOPSANCORE_DLLAPI getAllowedCpus();
+std::vector<int> HOPSANCORE_DLLAPI determineThreadCpus(const size_t nThreads, const ThreadPlacementT placement, const std::vector<int> &rCpus=std::vector<int>());
+bool HOPSANCORE_DLLAPI parseCpuList(const std::string &rList, std::vector<int> &rCpus);
+bool HOPSANCORE_DLLAPI parseThreadPlacement(const std::string &rString, ThreadPlacementT &rPlacement, std::vector<int> &rCpus);
 
 }
 
@@ -53,6 +59,9 @@ size_t HOPSANCORE_DLLAPI determineActualNumberOfThreads(const size_t nDesiredThr
 
 #include <atomic>
 #include <mutex>
+#include <condition_variable>
+#include <thread>
+#include <functional>
 
 namespace hopsan {
 
@@ -60,6 +69,139 @@ namespace hopsan {
 class Component;
 class ComponentSystem;
 class Node;
+class SimulationProfiler;
+
+//! @brief Makes a thread wait for a condition that is set by other threads, the waiting is done according to a BarrierPolicyT
+//! @details The threads that change the condition must call notify() afterwards, so that blocked threads are woken up.
+//! With SpinThenBlockBarrierPolicy the number of spin iterations adapts to how long the waits usually are.
+class HOPSANCORE_DLLAPI ThreadWaiter
+{
+public:
+    ThreadWaiter(BarrierPolicyT policy=SpinBarrierPolicy);
+
+    //! @brief Wait until the predicate returns true
+    //! @param [in] predicate Function object that returns true when the wait is over, it must be safe to call from any thread
+    template<typename PredicateT>
+    inline void waitUntil(PredicateT predicate)
+    {
+        if (mPolicy == SpinBarrierPolicy)
+        {
+            while(!predicate()) {}
+        }
+        else if (!predicate())
+        {
+            if (mPolicy == BackoffBarrierPolicy)
+            {
+                for (size_t i=0; !predicate(); ++i)
+                {
+                    backoff(i);
+                }
+            }
+            else
+            {
+                const int spinLimit = mSpinLimit.load(std::memory_order_relaxed);
+                for (int i=0; i<spinLimit; ++i)
+                {
+                    pauseCpu();
+                    if (predicate())
+                    {
+                        spinSucceeded(i);
+                        return;
+                    }
+                }
+
+                std::unique_lock<std::mutex> lock(mMutex);
+                ++mnBlocked;
+                while (!predicate())
+                {
+                    // Wake up now and then, in case the predicate depends on something that is not followed by notify()
+                    mCondition.wait_for(lock, std::chrono::milliseconds(10));
+                }
+                --mnBlocked;
+                spinFailed();
+            }
+        }
+    }
+
+    //! @brief Wake up blocked threads so that they can check their predicate, call this after changing the condition
+    inline void notify()
+    {
+        if (mnBlocked > 0)
+        {
+            notifyBlocked();
+        }
+    }
+
+    BarrierPolicyT getPolicy() const;
+
+private:
+    static void pauseCpu();
+    static void backoff(const size_t iteration);
+    void spinSucceeded(const int nIterations);
+    void spinFailed();
+    void notifyBlocked();
+
+    BarrierPolicyT mPolicy;
+    std::atomic<int> mSpinLimit;
+    std::atomic<int> mnBlocked;
+    std::mutex mMutex;
+    std::condition_variable mCondition;
+};
+
+//! @brief Pins the calling thread to one processor for as long as the object exists (only supported on Linux)
+//! @details The processors that the thread was allowed to run on before are restored by the destructor
+class HOPSANCORE_DLLAPI ScopedThreadAffinity
+{
+public:
+    ScopedThreadAffinity(const int cpu);
+    ~ScopedThreadAffinity();
+
+private:
+    // The object must not be copied
+    ScopedThreadAffinity(const ScopedThreadAffinity &);
+    ScopedThreadAffinity &operator=(const ScopedThreadAffinity &);
+
+    std::vector<int> mPreviousCpus;
+};
+
+//! @brief A pool of long-lived worker threads that execute simulation tasks
+//! @details The worker threads are created when they are first needed and then kept until the pool is destroyed,
+//! so that repeated multi-threaded simulations do not have to pay for thread creation. On Linux each worker is
+//! pinned to one of the processors that the process is allowed to run on, unless other processors are given to run().
+class HOPSANCORE_DLLAPI SimulationThreadPool
+{
+public:
+    SimulationThreadPool();
+    ~SimulationThreadPool();
+
+    void run(std::vector< std::function<void()> > &rTasks, const std::vector<int> &rThreadCpus=std::vector<int>());
+
+    size_t getNumWorkers() const;
+    void setPinWorkers(const bool pinWorkers);
+
+private:
+    // The pool must not be copied
+    SimulationThreadPool(const SimulationThreadPool &);
+    SimulationThreadPool &operator=(const SimulationThreadPool &);
+
+    class Worker;
+
+    void addWorkers(const size_t nWorkers);
+    void setThreadCpus(const std::vector<int> &rThreadCpus);
+    int getTaskCpu(const size_t taskIdx) const;
+    void workerLoop(Worker *pWorker);
+    void runInNewThreads(std::vector< std::function<void()> > &rTasks, const std::vector<int> &rThreadCpus);
+
+    std::vector<Worker*> mWorkers;
+    std::mutex mRunMutex;
+    size_t mGeneration;
+    std::atomic<size_t> mnPendingTasks;
+    std::atomic<bool> mStop;
+    bool mPinWorkers;
+    std::vector<int> mAllowedCpus;
+    std::vector<int> mThreadCpus;
+    ThreadWaiter mDoneWaiter;
+};
 
 //! @brief Class for barrier locks in multi-threaded simulations.
 class BarrierLock
@@ -68,7 +210,8 @@ public:
     //! @brief Constructor.
     //! @note Number of threads must be correct! Wrong value will result in either deadlocks or threads or non-synchronized threads.
     //! @param nThreads Number of threads to by synchronized.
-    BarrierLock(size_t nThreads)
+    //! @param policy How threads should wait at the barrier
+    BarrierLock(size_t nThreads, BarrierPolicyT policy=SpinBarrierPolicy) : mWaiter(policy)
     {
         mnThreads=nThreads;
         mCounter = 0;
@@ -79,35 +222,170 @@ public:
     inline void lock() { mCounter=0; mLock=true; }
 
     //! @brief Unlocks the barrier.
-    inline void unlock() { mLock=false; }
+    inline void unlock() { mLock=false; mWaiter.notify(); }
 
     //! @brief Returns whether or not the barrier is locked.
     inline bool isLocked() { return mLock; }
 
     //! @brief Increments barrier counter by one.
-    inline void increment() { ++mCounter; }
+    inline void increment()
+    {
+        if (++mCounter == (mnThreads-1))
+        {
+            mWaiter.notify();
+        }
+    }
 
     //! @brief Returns whether or not all threads have incremented the barrier.
     inline bool allArrived() { return (mCounter == (mnThreads-1)); }      //One less due to master thread
 
+    //! @brief Wait (in a slave thread) until the barrier is unlocked.
+    inline void waitWhileLocked() { mWaiter.waitUntil([this](){ return !mLock; }); }
+
+    bool waitForAllArrived(ComponentSystem *pSystem=0);
+
 private:
     int mnThreads;
     std::atomic<int> mCounter;
     std::atomic<bool> mLock;
+    ThreadWaiter mWaiter;
+};
+
+
+//! @brief Measures the load of each thread during barrier synchronized simulation and moves components between the threads when the load becomes unbalanced
+//! @details Every sampleInterval steps each thread measures the time spent on each of its components and the time spent waiting at the S, C and Q barriers.
+//! After nSamplesPerRebalance samples, the master thread compares the busy time of the threads in the C and Q phases while all threads are waiting
+//! at the barrier after the step. If the busiest thread exceeds the average by more than the threshold, C or Q components are moved from the busiest
+//! to the least busy thread. Signal components are never moved, since they must be simulated in order.
+class HOPSANCORE_DLLAPI LoadRebalancer
+{
+public:
+    enum PhaseT {SignalPhase, CPhase, QPhase, NumPhases};
+
+    LoadRebalancer(std::vector< std::vector<Component*> > &rSplitSignalVector, std::vector< std::vector<Component*> > &rSplitCVector,
+                   std::vector< std::vector<Component*> > &rSplitQVector, const size_t sampleInterval=32, const size_t nSamplesPerRebalance=32,
+                   const double imbalanceThreshold=1.15);
+
+    //! @brief Returns true if the load should be measured in this step
+    inline bool isSampleStep(const size_t step) const { return (step % mSampleInterval) == 0; }
+
+    static double getCurrentTime();
+    void simulateAndMeasure(const size_t thread, const PhaseT phase, std::vector<Component*> &rComponents, const double time);
+    void addWaitTime(const size_t thread, const PhaseT phase, const double waitTime);
+    bool endSampleStep();
+
+    size_t getNumSamples() const;
+    size_t getNumRebalances() const;
+    size_t getNumMovedComponents() const;
+    double getOverheadTime() const;
+    double getFirstImbalance(const PhaseT phase) const;
+    double getLastImbalance(const PhaseT phase) const;
+    double getWaitFraction() const;
+
+private:
+    //! @brief Time measured by one thread, padded so that threads do not write to the same cache line
+    class ThreadLoad
+    {
+    public:
+        double mBusyTime[NumPhases];
+        double mWaitTime[NumPhases];
+        char mPadding[64];
+    };
+
+    double calcImbalance(const PhaseT phase) const;
+    size_t rebalancePhase(std::vector< std::vector<Component*> > &rSplitVector);
+    void resetWindow();
+
+    std::vector< std::vector<Component*> > *mpSplitVectors[NumPhases];
+    std::vector<ThreadLoad> mThreadLoads;
+    size_t mSampleInterval, mnSamplesPerRebalance;
+    double mImbalanceThreshold;
+    size_t mnSamples, mnSamplesInWindow, mnRebalances, mnMovedComponents;
+    double mOverheadTime, mTotalBusyTime, mTotalWaitTime;
+    double mFirstImbalance[NumPhases], mLastImbalance[NumPhases];
+};
+
+
+//! @brief Schedule that lets dependent signal components run in parallel in the signal phase of barrier synchronized simulation
+//! @details The signal components are sorted into dependency levels, where each component only depends on components in lower levels.
+//! The components are assigned to threads level by level, each to the thread where it is estimated to finish first. Depending on a component
+//! in another thread adds a synchronization cost to the estimate, so chains of components tend to stay in one thread. During the simulation each
+//! thread simulates its components in level order and only waits for the components in other threads that they depend on, so no barriers are
+//! needed between the levels.
+class HOPSANCORE_DLLAPI SignalComponentSchedule
+{
+public:
+    SignalComponentSchedule(const std::vector<Component*> &rSortedComponents, const std::vector< std::vector<size_t> > &rDependencies,
+                            const size_t nThreads, const double syncCostFactor=10);
+    ~SignalComponentSchedule();
+
+    bool isValid() const;
+    void getSplitVector(std::vector< std::vector<Component*> > &rSplitSignalVector) const;
+    double estimateTime(const std::vector< std::vector<Component*> > &rSplitSignalVector) const;
+
+    void reset(const BarrierPolicyT policy);
+    bool simulate(const size_t thread, const double time, ComponentSystem *pSystem=0);
+
+    size_t getNumLevels() const;
+    size_t getMaxLevelWidth() const;
+    size_t getNumCrossThreadDependencies() const;
+    double getEstimatedTime() const;
+    double getEstimatedSpeedup() const;
+
+private:
+    // The schedule must not be copied
+    SignalComponentSchedule(const SignalComponentSchedule &);
+    SignalComponentSchedule &operator=(const SignalComponentSchedule &);
+
+    //! @brief A component to simulate and the components in other threads that must be simulated first
+    class Task
+    {
+    public:
+        Component *mpComponent;
+        size_t mIndex;
+        std::vector<size_t> mWaitFor;
+        std::vector<size_t> mNotifyThreads;
+    };
+
+    //! @brief The number of steps that a component has been simulated, padded so that threads do not write to the same cache line
+    class DoneCounter
+    {
+    public:
+        std::atomic<size_t> mnSteps;
+        char mPadding[64];
+    };
+
+    //! @brief The tasks of one thread
+    class ThreadSchedule
+    {
+    public:
+        std::vector<Task> mTasks;
+        size_t mnSteps;
+        ThreadWaiter *mpWaiter;
+    };
+
+    std::vector<Component*> mComponents;
+    std::vector<double> mWeights;
+    std::vector<ThreadSchedule> mThreads;
+    DoneCounter *mpDoneCounters;
+    bool mIsValid;
+    size_t mnLevels, mMaxLevelWidth, mnCrossThreadDependencies;
+    double mEstimatedTime, mSerialTime;
 };
 
 
 HOPSANCORE_DLLAPI void simMaster(ComponentSystem *pSystem, std::vector<Component *> &sVector, std::vector<Component *> &cVector,
                                  std::vector<Component *> &qVector, std::vector<Node *> &nVector, std::vector<double *> &pSimTimes,
                                  double startTime, double timeStep, size_t numSimSteps, BarrierLock *pBarrier_S,
-                                 BarrierLock *pBarrier_C, BarrierLock *pBarrier_Q, BarrierLock *pBarrier_N);
+                                 BarrierLock *pBarrier_C, BarrierLock *pBarrier_Q, BarrierLock *pBarrier_N,
+                                 LoadRebalancer *pRebalancer=0, SignalComponentSchedule *pSignalSchedule=0, SimulationProfiler *pProfiler=0);
 
 HOPSANCORE_DLLAPI void simSlave(ComponentSystem *pSystem, std::vector<Component*> &sVector, std::vector<Component*> &cVector,
                                 std::vector<Component*> &qVector, std::vector<Node*> &nVector, double startTime,
                                 double timeStep, size_t numSimSteps, BarrierLock *pBarrier_S,
-                                BarrierLock *pBarrier_C, BarrierLock *pBarrier_Q, BarrierLock *pBarrier_N);
-
-HOPSANCORE_DLLAPI void simWholeSystemInRealtime(double realTimeFactor, volatile bool *pStopSimulation, double *pTime, double timeStep, std::vector<Component *> signalComponentPtrs, std::vector<Component *> cComponentPtrs, std::vector<Component *> qComponentPtrs);
+                                BarrierLock *pBarrier_C, BarrierLock *pBarrier_Q, BarrierLock *pBarrier_N,
+                                LoadRebalancer *pRebalancer=0, size_t threadIdx=0, SignalComponentSchedule *pSignalSchedule=0,
+                                SimulationProfiler *pProfiler=0);
 
 HOPSANCORE_DLLAPI void simWholeSystems(std::vector<ComponentSystem *> systemPtrs, double stopTime);
 
@@ -120,7 +398,7 @@ HOPSANCORE_DLLAPI void simWholeSystems(std::vector<ComponentSystem *> systemPtrs
 class TaskPool
 {
 public:
-    TaskPool(std::vector<Component*> componentPtrs)
+    TaskPool(std::vector<Component*> componentPtrs, BarrierPolicyT policy=SpinBarrierPolicy) : mWaiter(policy)
     {
         mComponentPtrs = componentPtrs;
         mSize = componentPtrs.size();
@@ -140,7 +418,10 @@ public:
 
     void reportDone()
     {
-        atomic_fetch_add(&mnDone,size_t(1));
+        if (atomic_fetch_add(&mnDone,size_t(1))+1 >= mSize)
+        {
+            mWaiter.notify();
+        }
     }
 
     bool isReady()
@@ -153,11 +434,13 @@ public:
         mCurrentIdx.store(0);
         mnDone.store(0);
         mOpen.store(true);
+        mWaiter.notify();
     }
 
     void close()
     {
         std::atomic_store(&mOpen,false);
+        mWaiter.notify();
     }
 
     bool isOpen()
@@ -165,18 +448,40 @@ public:
         return mOpen;
     }
 
+    //! @brief Wait until all components have been simulated
+    void waitUntilReady()
+    {
+        mWaiter.waitUntil([this](){ return isReady(); });
+    }
+
+    //! @brief Wait until the pool is opened or until the stop flag is set
+    void waitUntilOpen(std::atomic<bool> *pStop)
+    {
+        mWaiter.waitUntil([this, pStop](){ return isOpen() || *pStop; });
+    }
+
+    //! @brief Wait until the pool is closed
+    void waitWhileOpen()
+    {
+        mWaiter.waitUntil([this](){ return !isOpen(); });
+    }
+
 private:
     std::vector<Component*> mComponentPtrs;
     size_t mSize;
     std::atomic<size_t> mCurrentIdx;
     std::atomic<size_t> mnDone;
     std::atomic<bool> mOpen;
+    ThreadWaiter mWaiter;
 };
 
 
 
 
 
+HOPSANCORE_DLLAPI void simPoolMaster(ComponentSystem *pSystem, TaskPool *pTaskPoolS, TaskPool *pTaskPoolC, TaskPool *pTaskPoolQ, std::vector<double *> &pSimTimes,
+                                     std::atomic<double> *pTime, std::atomic<bool> *pStop, double timeStep, size_t numSimSteps);
+
 HOPSANCORE_DLLAPI void simPoolSlave(TaskPool *pTaskPoolC, TaskPool *pTaskPoolQ, std::atomic<double> *pTime, std::atomic<bool> *pStop);
 
 
@@ -186,6 +491,8 @@ HOPSANCORE_DLLAPI void simPoolSlave(TaskPool *pTaskPoolC, TaskPool *pTaskPoolQ,
 /////////////////////////////
 
 
+//! @brief Mutex protected vector of components that can be taken from both ends
+//! @note No longer used by the task-stealing algorithm, kept as a reference for the benchmarks of WorkStealingDeque
 class ThreadSafeVector
 {
 public:
@@ -291,10 +598,118 @@ private:
 };
 
 
+//! @brief Lock-free work-stealing deque (Chase-Lev) holding the components that one thread has left to simulate in a phase
+//! @details Only the owning thread may push and pop at the bottom, other threads steal from the top. Push and pop only use plain loads and
+//! stores (and a fence in pop), a compare-and-swap is only needed when the owner and a thief compete for the last component.
+//! The capacity is fixed, since a deque can never hold more than all the components in the system. The top and bottom indices are
+//! padded to separate cache lines so that thieves reading the top do not invalidate the line written by the owner.
+class WorkStealingDeque
+{
+public:
+    WorkStealingDeque(const std::vector<Component*> &rData, const size_t maxSize)
+    {
+        size_t capacity = 1;
+        while(capacity < std::max(maxSize, rData.size()))
+        {
+            capacity *= 2;
+        }
+        mMask = capacity-1;
+        mpBuffer = new std::atomic<Component*>[capacity];
+        mTop.store(0);
+        mBottom.store(0);
+        for(size_t i=0; i<rData.size(); ++i)
+        {
+            push(rData[i]);
+        }
+    }
+
+    ~WorkStealingDeque()
+    {
+        delete[] mpBuffer;
+    }
+
+    //! @brief Adds a component at the bottom, may only be called by the owning thread
+    void push(Component *pComp)
+    {
+        const long long b = mBottom.load(std::memory_order_relaxed);
+        assert(b - mTop.load(std::memory_order_relaxed) <= (long long)mMask);
+        mpBuffer[b & mMask].store(pComp, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        mBottom.store(b+1, std::memory_order_relaxed);
+    }
+
+    //! @brief Removes a component from the bottom, may only be called by the owning thread
+    //! @returns The component, or 0 if the deque is empty
+    Component *pop()
+    {
+        const long long b = mBottom.load(std::memory_order_relaxed)-1;
+        mBottom.store(b, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        long long t = mTop.load(std::memory_order_relaxed);
+        Component *pComp = 0;
+        if(t <= b)
+        {
+            pComp = mpBuffer[b & mMask].load(std::memory_order_relaxed);
+            if(t == b)
+            {
+                // Last component, race against thieves
+                if(!mTop.compare_exchange_strong(t, t+1, std::memory_order_seq_cst, std::memory_order_relaxed))
+                {
+                    pComp = 0;
+                }
+                mBottom.store(b+1, std::memory_order_relaxed);
+            }
+        }
+        else
+        {
+            mBottom.store(b+1, std::memory_order_relaxed);
+        }
+        return pComp;
+    }
+
+    //! @brief Removes a component from the top, may be called by any thread
+    //! @returns The component, or 0 if the deque is empty or if another thread took it first
+    Component *steal()
+    {
+        long long t = mTop.load(std::memory_order_acquire);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        const long long b = mBottom.load(std::memory_order_acquire);
+        if(t < b)
+        {
+            Component *pComp = mpBuffer[t & mMask].load(std::memory_order_relaxed);
+            if(mTop.compare_exchange_strong(t, t+1, std::memory_order_seq_cst, std::memory_order_relaxed))
+            {
+                return pComp;
+            }
+        }
+        return 0;
+    }
+
+    //! @brief Returns true if there are no components left
+    //! @note The result may be outdated directly if other threads are stealing
+    bool isEmpty() const
+    {
+        return mTop.load(std::memory_order_acquire) >= mBottom.load(std::memory_order_acquire);
+    }
+
+private:
+    WorkStealingDeque(const WorkStealingDeque &);
+    WorkStealingDeque &operator=(const WorkStealingDeque &);
+
+    std::atomic<long long> mTop;
+    char mPadding0[64];
+    std::atomic<long long> mBottom;
+    char mPadding1[64];
+    std::atomic<Component*> *mpBuffer;
+    size_t mMask;
+    char mPadding2[64];
+};
+
+
 HOPSANCORE_DLLAPI void simStealingMaster(ComponentSystem *pSystem,
                                          std::vector<Component*> &sVector,
-                                         std::vector<ThreadSafeVector*> *cVectors,
-                                         std::vector<ThreadSafeVector*> *qVectors,
+                                         std::vector<WorkStealingDeque*> *cVectors,
+                                         std::vector<WorkStealingDeque*> *qVectors,
                                          std::vector<double *> &pSimTimes,
                                          double startTime,
                                          double timeStep,
@@ -311,8 +726,8 @@ HOPSANCORE_DLLAPI void simStealingMaster(ComponentSystem *pSystem,
 
 
 HOPSANCORE_DLLAPI void simStealingSlave(ComponentSystem *pSystem,
-                                        std::vector<ThreadSafeVector*> *cVectors,
-                                        std::vector<ThreadSafeVector*> *qVectors,
+                                        std::vector<WorkStealingDeque*> *cVectors,
+                                        std::vector<WorkStealingDeque*> *qVectors,
                                         double startTime,
                                         double timeStep,
                                         size_t numSimSteps,
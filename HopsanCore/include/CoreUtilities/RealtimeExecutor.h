@@ -0,0 +1,121 @@
+/*-----------------------------------------------------------------------------
+
+ Copyright 2017 Hopsan Group
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+
+
+ The full license is available in the file LICENSE.
+ For details about the 'Hopsan Group' or information about Authors and
+ Contributors see the HOPSANGROUP and AUTHORS files that are located in
+ the Hopsan source code root directory.
+
+-----------------------------------------------------------------------------*/
+
+//$Id$
+
+#ifndef REALTIMEEXECUTOR_H
+#define REALTIMEEXECUTOR_H
+
+#include <atomic>
+#include <mutex>
+#include <thread>
+#include "win32dll.h"
+#include "HopsanTypes.h"
+#include "CoreUtilities/SimulationProfiler.h"
+
+namespace hopsan {
+
+// Forward declaration
+class ComponentSystem;
+
+//! @brief What the real-time executor does when a time step finishes after its deadline
+//! @details SkipOverrunPolicy drops the periods that were missed, the next step is released at the next period boundary and the
+//! simulation time falls behind the wall clock. CatchUpOverrunPolicy releases the missed steps immediately, one after the other,
+//! until the simulation has caught up with the wall clock. AbortOverrunPolicy stops the simulation at the first overrun.
+enum RealtimeOverrunPolicyT {SkipOverrunPolicy,
+                             CatchUpOverrunPolicy,
+                             AbortOverrunPolicy};
+
+//! @brief Settings for real-time simulation
+class HOPSANCORE_DLLAPI RealtimeOptions
+{
+public:
+    RealtimeOptions();
+
+    //! @brief Simulation time per wall clock time, 2 simulates twice as fast as real time
+    double realTimeFactor;
+    //! @brief Simulation time to stop at, the simulation runs until it is stopped if this is infinite
+    double stopTime;
+    //! @brief Run the simulation thread with the SCHED_FIFO real-time scheduling policy (Linux only, requires privileges)
+    bool useFifoScheduling;
+    //! @brief The SCHED_FIFO priority, 1 to 99
+    int fifoPriority;
+    //! @brief The CPU to pin the simulation thread to, or -1 to let it run on any CPU (Linux only)
+    int cpu;
+    //! @brief Lock all current and future memory pages of the process in RAM to avoid page faults (Linux only, requires privileges)
+    bool lockMemory;
+    RealtimeOverrunPolicyT overrunPolicy;
+};
+
+//! @brief Timing statistics of a real-time simulation
+//! @details Jitter is the delay from the release time of a step until it starts executing. Overrun is how long after its
+//! deadline (the release time of the next period) a step finished.
+class HOPSANCORE_DLLAPI RealtimeStatistics
+{
+public:
+    RealtimeStatistics();
+
+    size_t numSteps;
+    size_t numOverruns;
+    size_t numSkippedPeriods;
+    DurationStatistics jitter;
+    DurationStatistics executionTime;
+    DurationStatistics overrun;
+};
+
+//! @brief Simulates a system paced against the wall clock in a thread of its own
+//! @details The steps are released at absolute times (clock_nanosleep on Linux), so the pacing does not drift. The statistics are
+//! published by the simulation thread without ever waiting for a reader, and can be read at any time with getStatistics().
+class HOPSANCORE_DLLAPI RealtimeExecutor
+{
+public:
+    RealtimeExecutor();
+    ~RealtimeExecutor();
+
+    bool start(ComponentSystem *pSystem, const RealtimeOptions &rOptions);
+    void stop();
+    bool isRunning() const;
+    bool wasAborted() const;
+    RealtimeStatistics getStatistics() const;
+
+private:
+    RealtimeExecutor(const RealtimeExecutor &);
+    RealtimeExecutor &operator=(const RealtimeExecutor &);
+
+    void run();
+
+    ComponentSystem *mpSystem;
+    RealtimeOptions mOptions;
+    std::thread mThread;
+    std::atomic<bool> mStopRequested;
+    std::atomic<bool> mIsRunning;
+    std::atomic<bool> mWasAborted;
+    bool mHasLockedMemory;
+    mutable std::mutex mStatisticsMutex;
+    RealtimeStatistics mStatistics;
+};
+
+}
+
+#endif // REALTIMEEXECUTOR_H
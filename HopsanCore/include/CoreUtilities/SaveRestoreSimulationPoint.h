@@ -29,13 +29,16 @@
 
 #include "win32dll.h"
 #include "HopsanTypes.h"
+#include <vector>
 
 namespace hopsan {
 
 class ComponentSystem;
 
 void HOPSANCORE_DLLAPI saveSimulationPoint(HString fileName, ComponentSystem* pRootSystem);
+void HOPSANCORE_DLLAPI saveSimulationPointData(ComponentSystem* pRootSystem, std::vector<char> &rData);
 void HOPSANCORE_DLLAPI restoreSimulationPoint(HString fileName, ComponentSystem* pRootSystem, double &rTimeOffset);
+bool HOPSANCORE_DLLAPI restoreSimulationPointData(const std::vector<char> &rData, ComponentSystem* pRootSystem, const bool restoreComponentStates=true);
 
 }
 
@@ -40,35 +40,77 @@
 
 namespace hopsan {
 
+//! @brief How components are scheduled on the threads in multi-threaded simulations
+//! @details GraphPartitioningAlgorithm assigns connected C- and Q-components to the same thread to minimize the number of
+//! nodes shared between threads, while balancing the measured time of each thread. It is executed like OfflineSchedulingAlgorithm.
 enum ParallelAlgorithmT {OfflineSchedulingAlgorithm,
                          TaskPoolAlgorithm,
                          TaskStealingAlgorithm,
                          ParallelForAlgorithm,
-                         GroupedParallelForAlgorithm};
+                         GroupedParallelForAlgorithm,
+                         GraphPartitioningAlgorithm};
+
+//! @brief How threads wait for each other at the synchronization points in multi-threaded simulations
+//! @details SpinBarrierPolicy busy-waits and gives the lowest latency when every thread has its own core.
+//! SpinThenBlockBarrierPolicy spins for an adaptive number of iterations and then blocks the thread until it is woken up.
+//! BackoffBarrierPolicy spins with an exponentially increasing number of pause instructions and then yields the thread.
+enum BarrierPolicyT {SpinBarrierPolicy,
+                     SpinThenBlockBarrierPolicy,
+                     BackoffBarrierPolicy};
+
+//! @brief Which processors the threads are pinned to in multi-threaded simulations (only supported on Linux)
+//! @details AutomaticThreadPlacement pins the worker threads round-robin over the allowed processors and lets the calling thread float.
+//! CompactThreadPlacement fills the physical cores of one NUMA node before moving on to the next, ScatterThreadPlacement spreads the threads
+//! evenly over the NUMA nodes. Hyper-threads sharing a core are only used when every core already has a thread. ExplicitThreadPlacement
+//! uses a given list of processors. NoThreadPlacement lets all threads float.
+enum ThreadPlacementT {AutomaticThreadPlacement,
+                       CompactThreadPlacement,
+                       ScatterThreadPlacement,
+                       ExplicitThreadPlacement,
+                       NoThreadPlacement};
 
 // Forward declaration
 class ComponentSystem;
+class RealtimeOptions;
+class RealtimeStatistics;
+class SimulationThreadPool;
 
 class HOPSANCORE_DLLAPI SimulationHandler
 {
 public:
     enum SimulationErrorTypesT {NotRedy, InitFailed, SimuFailed, FiniFailed};
 
+    SimulationHandler();
+    ~SimulationHandler();
+
     //! @todo a doitall function
     //! @todo use the error enums
     bool initializeSystem(const double startT, const double stopT, ComponentSystem* pSystem);
     bool initializeSystem(const double startT, const double stopT, std::vector<ComponentSystem*> &rSystemVector);
+    bool reinitializeSystem(const double startT, const double stopT, ComponentSystem* pSystem);
+    bool reinitializeSystem(const double startT, const double stopT, std::vector<ComponentSystem*> &rSystemVector);
+
+    bool simulateSystem(const double startT, const double stopT, const int nDesiredThreads, ComponentSystem* pSystem, bool noChanges=false, ParallelAlgorithmT algorithm=OfflineSchedulingAlgorithm, BarrierPolicyT barrierPolicy=SpinBarrierPolicy);
+    bool simulateSystem(const double startT, const double stopT, const int nDesiredThreads, std::vector<ComponentSystem*> &rSystemVector, bool noChanges=false, ParallelAlgorithmT algorithm=OfflineSchedulingAlgorithm, BarrierPolicyT barrierPolicy=SpinBarrierPolicy);
 
-    bool simulateSystem(const double startT, const double stopT, const int nDesiredThreads, ComponentSystem* pSystem, bool noChanges=false, ParallelAlgorithmT algorithm=OfflineSchedulingAlgorithm);
-    bool simulateSystem(const double startT, const double stopT, const int nDesiredThreads, std::vector<ComponentSystem*> &rSystemVector, bool noChanges=false, ParallelAlgorithmT algorithm=OfflineSchedulingAlgorithm);
+    bool simulateSystemEnsemble(const double startT, const double stopT, std::vector<ComponentSystem*> &rSystemVector);
 
     bool startRealtimeSimulation(ComponentSystem *pSystem, double realtimeFactor=1);
+    bool startRealtimeSimulation(ComponentSystem *pSystem, const RealtimeOptions &rOptions);
     void stopRealtimeSimulation(ComponentSystem *pSystem);
+    bool isRealtimeSimulationRunning(const ComponentSystem *pSystem) const;
+    RealtimeStatistics getRealtimeStatistics(const ComponentSystem *pSystem) const;
 
     void finalizeSystem(ComponentSystem* pSystem);
     void finalizeSystem(std::vector<ComponentSystem*> &rSystemVector);
 
+    SimulationThreadPool *getThreadPool();
+
 private:
+    // The simulation handler owns the thread pool and must not be copied
+    SimulationHandler(const SimulationHandler &);
+    SimulationHandler &operator=(const SimulationHandler &);
+
     bool simulateMultipleSystemsMultiThreaded(const double startT, const double stopT, const size_t nDesiredThreads, const std::vector<ComponentSystem*> &rSystemVector, bool noChanges=false);
     bool simulateMultipleSystems(const double stopT, const std::vector<ComponentSystem *> &rSystemVector);
 
@@ -76,6 +118,7 @@ private:
     void sortSystemsByTotalMeasuredTime(std::vector<ComponentSystem*> &rSystemVector);
 
     std::vector< std::vector<ComponentSystem*> > mSplitSystemVector;
+    SimulationThreadPool *mpThreadPool;
 };
 
 }
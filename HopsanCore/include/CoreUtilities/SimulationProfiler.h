@@ -0,0 +1,212 @@
+/*-----------------------------------------------------------------------------
+
+ Copyright 2017 Hopsan Group
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+
+
+ The full license is available in the file LICENSE.
+ For details about the 'Hopsan Group' or information about Authors and
+ Contributors see the HOPSANGROUP and AUTHORS files that are located in
+ the Hopsan source code root directory.
+
+-----------------------------------------------------------------------------*/
+
+//$Id$
+
+#ifndef SIMULATIONPROFILER_H
+#define SIMULATIONPROFILER_H
+
+#include <vector>
+#include <map>
+#include <unordered_map>
+#include <chrono>
+#include <stdint.h>
+#include "win32dll.h"
+#include "HopsanTypes.h"
+#include "CoreUtilities/HardwareCounters.h"
+
+namespace hopsan {
+
+// Forward declaration
+class Component;
+
+//! @brief Count, total, min, max and a log2 histogram of measured durations
+class HOPSANCORE_DLLAPI DurationStatistics
+{
+public:
+    //! @brief Bucket b counts durations of at least 2^(b-1) and less than 2^b ns, bucket 0 counts zero durations
+    enum {NumHistogramBuckets=64};
+
+    DurationStatistics();
+    void add(const int64_t duration);
+    void merge(const DurationStatistics &rOther);
+
+    size_t getCount() const;
+    double getTotal() const;
+    double getMean() const;
+    double getMin() const;
+    double getMax() const;
+    double getPercentile(const double fraction) const;
+    size_t getHistogramCount(const size_t bucket) const;
+
+private:
+    size_t mCount;
+    int64_t mTotal, mMin, mMax;
+    size_t mHistogram[NumHistogramBuckets];
+};
+
+//! @brief Totals of hardware counter values measured over a number of samples
+class HOPSANCORE_DLLAPI HardwareCounterStatistics
+{
+public:
+    HardwareCounterStatistics();
+    void add(const uint64_t *pValues);
+    void merge(const HardwareCounterStatistics &rOther);
+
+    size_t getCount() const;
+    uint64_t getTotal(const HardwareCounters::CounterT counter) const;
+    double getMean(const HardwareCounters::CounterT counter) const;
+    double getInstructionsPerCycle() const;
+
+private:
+    size_t mCount;
+    uint64_t mTotals[HardwareCounters::NumCounters];
+};
+
+
+//! @brief Records the time spent on each component, on each simulation phase and waiting at each barrier during a simulation
+//! @details Set the profiler in a top-level system with ComponentSystem::setProfiler(). Durations are aggregated per component and per
+//! thread and phase for the whole simulation. For the first steps each duration is also kept as a trace event, that can be written
+//! as a Chrome trace (open it in chrome://tracing or Perfetto) to see the schedule of each thread. Subsystems that are not flattened
+//! are measured as one component. Each thread only writes to its own records, the results are merged when a simulation ends.
+//! Optionally, hardware counters are also read around each component and the results are summed for each component type.
+class HOPSANCORE_DLLAPI SimulationProfiler
+{
+public:
+    enum PhaseT {SignalPhase, CPhase, QPhase, LogPhase, NumPhases};
+    typedef int64_t TicksT;
+
+    SimulationProfiler(const size_t nTraceSteps=100);
+    ~SimulationProfiler();
+    void clear();
+    void setUseHardwareCounters(const bool useHardwareCounters);
+    bool usesHardwareCounters() const;
+
+    //! @brief Returns a time stamp in ns from a monotonic clock
+    static inline TicksT getTicks()
+    {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+
+    // Recording, called by the simulation
+    void beginSimulation(const size_t nThreads);
+    void simulatePhase(const size_t thread, const PhaseT phase, const std::vector<Component*> &rComponents, const double time, const size_t step);
+    void addPhaseTime(const size_t thread, const PhaseT phase, const TicksT start, const TicksT end, const size_t step);
+    void addWaitTime(const size_t thread, const PhaseT phase, const TicksT start, const TicksT end, const size_t step);
+    void endSimulation(const size_t nSteps);
+
+    // Results
+    size_t getNumSteps() const;
+    size_t getNumThreads() const;
+    std::vector<HString> getComponentNamesByTotalTime() const;
+    const DurationStatistics *getComponentStatistics(const HString &rName) const;
+    const DurationStatistics *getPhaseStatistics(const size_t thread, const PhaseT phase) const;
+    const DurationStatistics *getWaitStatistics(const size_t thread, const PhaseT phase) const;
+    size_t getNumTraceEvents() const;
+
+    // Hardware counter results
+    bool isHardwareCounterAvailable(const HardwareCounters::CounterT counter) const;
+    const HString &getHardwareCounterError() const;
+    const HardwareCounterStatistics *getComponentCounters(const HString &rName) const;
+    std::vector<HString> getComponentTypeNamesByTotalTime() const;
+    size_t getNumComponentsOfType(const HString &rTypeName) const;
+    const DurationStatistics *getComponentTypeStatistics(const HString &rTypeName) const;
+    const HardwareCounterStatistics *getComponentTypeCounters(const HString &rTypeName) const;
+
+    bool writeChromeTrace(const HString &rFilePath) const;
+    bool writeSummaryCSV(const HString &rFilePath) const;
+    bool writeHardwareCounterCSV(const HString &rFilePath) const;
+
+private:
+    enum EventKindT {ComponentEvent, PhaseEvent, WaitEvent};
+
+    //! @brief An event recorded by a thread, the component name is looked up when the simulation ends
+    class RawTraceEvent
+    {
+    public:
+        const Component *mpComponent;
+        EventKindT mKind;
+        PhaseT mPhase;
+        TicksT mStart, mEnd;
+    };
+
+    class TraceEvent
+    {
+    public:
+        HString mName;
+        EventKindT mKind;
+        PhaseT mPhase;
+        size_t mThread;
+        TicksT mStart, mEnd;
+    };
+
+    class ComponentRecord
+    {
+    public:
+        PhaseT mPhase;
+        HString mTypeName;
+        DurationStatistics mStatistics;
+        HardwareCounterStatistics mCounters;
+    };
+
+    class TypeRecord
+    {
+    public:
+        DurationStatistics mStatistics;
+        HardwareCounterStatistics mCounters;
+    };
+
+    //! @brief The records of one thread, only written by that thread during a simulation
+    class ThreadProfile
+    {
+    public:
+        ThreadProfile() { mHaveOpenedCounters = false; }
+
+        std::unordered_map<const Component*, ComponentRecord> mComponents;
+        DurationStatistics mPhases[NumPhases];
+        DurationStatistics mWaits[NumPhases];
+        std::vector<RawTraceEvent> mTraceEvents;
+        HardwareCounters mCounters;
+        bool mHaveOpenedCounters;
+    };
+
+    //! @brief Returns true if trace events should be kept for this step of the current simulation
+    inline bool isTraceStep(const size_t step) const { return mnSteps+step < mnTraceSteps; }
+    void addTraceEvent(const size_t thread, const EventKindT kind, const PhaseT phase, const Component *pComponent, const TicksT start, const TicksT end);
+
+    size_t mnTraceSteps, mnSteps;
+    TicksT mStartTicks;
+    bool mUseHardwareCounters;
+    bool mHardwareCountersAvailable[HardwareCounters::NumCounters];
+    HString mHardwareCounterError;
+    std::vector<ThreadProfile*> mThreadProfiles;
+    std::map<HString, ComponentRecord> mComponentRecords;
+    std::map<HString, TypeRecord> mTypeRecords;
+    std::vector<DurationStatistics> mPhaseStatistics, mWaitStatistics;
+    std::vector<TraceEvent> mTraceEvents;
+};
+
+}
+
+#endif // SIMULATIONPROFILER_H
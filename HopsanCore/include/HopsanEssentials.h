@@ -48,6 +48,7 @@ namespace hopsan {
 class LoadExternal;
 class HopsanCoreMessageHandler;
 class QuantityRegister;
+class CompiledModel;
 
 //! @brief This class gives access to HopsanCore for model and externalLib loading as well as component creation and simulation.
 class HOPSANCORE_DLLAPI HopsanEssentials
@@ -107,12 +108,16 @@ public:
     void getExternalComponentLibNames(std::vector<HString> &rLibNames);
     void getExternalLibraryContents(const char* libPath, std::vector<HString> &rComponents, std::vector<HString> &rNodes);
     void getLibPathForComponentType(const HString &rTypeName, HString &rLibPath);
+    CompiledModel* loadCompiledModel(const char* path);
 
     // Loading HMF models
     ComponentSystem* loadHMFModelFile(const char* filePath, double &rStartTime, double &rStopTime);
     ComponentSystem* loadHMFModel(const std::vector<unsigned char> xmlVector);
     ComponentSystem* loadHMFModel(const char* xmlString, double &rStartTime, double &rStopTime);
 
+    // Copying loaded models
+    ComponentSystem* cloneComponentSystem(ComponentSystem *pSystem);
+
     // Running simulation
     SimulationHandler *getSimulationHandler();
 };
@@ -33,6 +33,7 @@
 #define NODE_H_INCLUDED
 
 #include <vector>
+#include <cstring>
 #include "HopsanTypes.h"
 #include "CoreUtilities/ClassFactory.hpp"
 #include "win32dll.h"
@@ -62,6 +63,51 @@ public:
     size_t id;
 };
 
+//! @brief A read-only (strided) view of the logged samples of one node data variable
+//! @details The view does not own the data, it is valid until the log data is reallocated or cleared (next initialize)
+class LogDataColumnView
+{
+public:
+    LogDataColumnView() : mpData(0), mSize(0), mStride(1) {}
+    LogDataColumnView(const double *pData, const size_t size, const size_t stride=1) : mpData(pData), mSize(size), mStride(stride) {}
+
+    //! @brief Returns the number of samples in the view
+    inline size_t size() const { return mSize; }
+    //! @brief Returns true if the view contains no samples (the variable is not logged)
+    inline bool empty() const { return (mSize == 0); }
+    //! @brief Returns the distance (in number of doubles) between two consecutive samples
+    inline size_t stride() const { return mStride; }
+    //! @brief Returns true if samples are stored consecutively in memory, then data() can be read directly
+    inline bool isContiguous() const { return (mStride == 1); }
+    //! @brief Returns a pointer to the first sample
+    inline const double *data() const { return mpData; }
+    //! @brief Returns sample i (no bounds check is performed)
+    inline double operator[](const size_t i) const { return mpData[i*mStride]; }
+
+    //! @brief Copy the first nSamples samples into a buffer
+    //! @param [in] pDestination The buffer to copy to, it must have room for nSamples values
+    //! @param [in] nSamples The number of samples to copy, (must not be larger then size())
+    inline void copyTo(double *pDestination, const size_t nSamples) const
+    {
+        if (isContiguous())
+        {
+            std::memcpy(pDestination, mpData, nSamples*sizeof(double));
+        }
+        else
+        {
+            for (size_t i=0; i<nSamples; ++i)
+            {
+                pDestination[i] = mpData[i*mStride];
+            }
+        }
+    }
+
+private:
+    const double *mpData;
+    size_t mSize;
+    size_t mStride;
+};
+
 class HOPSANCORE_DLLAPI Node
 {
     friend class Port;
@@ -71,6 +117,7 @@ class HOPSANCORE_DLLAPI Node
     friend class Component;
     friend class ComponentSystem;
     friend class ConnectionAssistant;
+    friend class EnsembleSimulation;
     friend class HopsanEssentials;
 
 public:
@@ -89,14 +136,14 @@ public:
     //! @return The data value
     inline double getDataValue(const size_t dataId) const
     {
-        return mDataValues[dataId];
+        return mpDataValues[dataId];
     }
     //! @brief set data in node
     //! @param [in] dataId Identifier for the type of node data to set, (no bounds check is performed)
     //! @param [in] data The data value
     inline void setDataValue(const size_t dataId, const double data)
     {
-        mDataValues[dataId] = data;
+        mpDataValues[dataId] = data;
     }
 
     const std::vector<NodeDataDescription>* getDataDescriptions() const;
@@ -108,6 +155,8 @@ public:
     virtual bool getSignalQuantityModifyable(const size_t dataId=0) const;
 
     void logData(const size_t logSlot);
+    LogDataColumnView getLogDataColumn(const size_t dataId) const;
+    bool haveLogData() const;
 
     int getNumberOfPortsByType(const int type) const;
     size_t getNumConnectedPorts() const;
@@ -131,10 +180,18 @@ protected:
 
     double *getDataPtr(const size_t data_type);
 
+    void moveDataValuesTo(double *pStorage);
+    void restoreDataValuesStorage();
+    bool hasExternalDataValuesStorage() const;
+    void reallocateDataValues();
+    void reallocateLogData();
+
     // Protected member variables
     HString mNiceName;
     std::vector<NodeDataDescription> mDataDescriptions;
     std::vector<double> mDataValues;
+    //! @brief Points to the data values actually used during simulation, either mDataValues or a slot in the owner system node data arena
+    double *mpDataValues;
 
 private:
     // Private member functions
@@ -142,6 +199,7 @@ private:
     void removeConnectedPort(const Port *pPort);
 
     void setDoLogIfEnabled(bool doLog=true);
+    void getDataIdsToLog(std::vector<size_t> &rDataIds) const;
 
     // Private member variables
     HString mNodeType;
@@ -149,7 +207,8 @@ private:
     ComponentSystem *mpOwnerSystem;
 
     // Log specific variables
-    std::vector<std::vector<double> > mDataStorage;
+    std::vector<std::vector<double> > mLogDataColumns; //!< One column (of log slots) per data variable, empty if the variable is not logged
+    std::vector<size_t> mLoggedDataIds;
     bool mDoLog;
 };
 
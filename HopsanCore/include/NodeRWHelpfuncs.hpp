@@ -218,34 +218,34 @@ public:
 
 inline void readHydraulicPort_pq(Port *pPort, double &p, double &q)
 {
-    const std::vector<double> &rData = pPort->getNodeDataVector();
-    q = rData[NodeHydraulic::Flow];
-    p = rData[NodeHydraulic::Pressure];
+    const double *pData = pPort->getNodeDataValues();
+    q = pData[NodeHydraulic::Flow];
+    p = pData[NodeHydraulic::Pressure];
 }
 
 inline void readHydraulicPort_cZc(Port *pPort, double &c, double &Zc)
 {
-    const std::vector<double> &rData = pPort->getNodeDataVector();
-    c = rData[NodeHydraulic::WaveVariable];
-    Zc = rData[NodeHydraulic::CharImpedance];
+    const double *pData = pPort->getNodeDataValues();
+    c = pData[NodeHydraulic::WaveVariable];
+    Zc = pData[NodeHydraulic::CharImpedance];
 }
 
 inline void readHydraulicPort_all(Port *pPort, double &p, double &q, double &c, double &Zc)
 {
-    const std::vector<double> &rData = pPort->getNodeDataVector();
-    q = rData[NodeHydraulic::Flow];
-    p = rData[NodeHydraulic::Pressure];
-    c = rData[NodeHydraulic::WaveVariable];
-    Zc = rData[NodeHydraulic::CharImpedance];
+    const double *pData = pPort->getNodeDataValues();
+    q = pData[NodeHydraulic::Flow];
+    p = pData[NodeHydraulic::Pressure];
+    c = pData[NodeHydraulic::WaveVariable];
+    Zc = pData[NodeHydraulic::CharImpedance];
 }
 
 inline void readHydraulicPort_all(Port *pPort, HydraulicNodeDataValueStructT &rValues)
 {
-    const std::vector<double> &rData = pPort->getNodeDataVector();
-    rValues.q = rData[NodeHydraulic::Flow];
-    rValues.p = rData[NodeHydraulic::Pressure];
-    rValues.c = rData[NodeHydraulic::WaveVariable];
-    rValues.Zc = rData[NodeHydraulic::CharImpedance];
+    const double *pData = pPort->getNodeDataValues();
+    rValues.q = pData[NodeHydraulic::Flow];
+    rValues.p = pData[NodeHydraulic::Pressure];
+    rValues.c = pData[NodeHydraulic::WaveVariable];
+    rValues.Zc = pData[NodeHydraulic::CharImpedance];
 }
 
 inline void getHydraulicPortNodeDataPointers(Port *pPort, HydraulicNodeDataPointerStructT &rPointers)
@@ -258,40 +258,40 @@ inline void getHydraulicPortNodeDataPointers(Port *pPort, HydraulicNodeDataPoint
 
 inline void getHydraulicMultiPortValues_pq(Port *pMainPort, const size_t subPortIdx, std::vector<HydraulicNodeDataValueStructT> &rValues)
 {
-    const std::vector<double> &rData = pMainPort->getNodeDataVector(subPortIdx);
-    rValues[subPortIdx].q = rData[NodeHydraulic::Flow];
-    rValues[subPortIdx].p = rData[NodeHydraulic::Pressure];
-//    rValues[subPortIdx].c = rData[NodeHydraulic::WaveVariable];
-//    rValues[subPortIdx].Zc = rData[NodeHydraulic::CharImpedance];
+    const double *pData = pMainPort->getNodeDataValues(subPortIdx);
+    rValues[subPortIdx].q = pData[NodeHydraulic::Flow];
+    rValues[subPortIdx].p = pData[NodeHydraulic::Pressure];
+//    rValues[subPortIdx].c = pData[NodeHydraulic::WaveVariable];
+//    rValues[subPortIdx].Zc = pData[NodeHydraulic::CharImpedance];
 }
 
 inline void getHydraulicMultiPortValues_cZc(Port *pMainPort, const size_t subPortIdx, std::vector<HydraulicNodeDataValueStructT> &rValues)
 {
-    const std::vector<double> &rData = pMainPort->getNodeDataVector(subPortIdx);
-//    rValues[subPortIdx].q = rData[NodeHydraulic::Flow];
-//    rValues[subPortIdx].p = rData[NodeHydraulic::Pressure];
-    rValues[subPortIdx].c = rData[NodeHydraulic::WaveVariable];
-    rValues[subPortIdx].Zc = rData[NodeHydraulic::CharImpedance];
+    const double *pData = pMainPort->getNodeDataValues(subPortIdx);
+//    rValues[subPortIdx].q = pData[NodeHydraulic::Flow];
+//    rValues[subPortIdx].p = pData[NodeHydraulic::Pressure];
+    rValues[subPortIdx].c = pData[NodeHydraulic::WaveVariable];
+    rValues[subPortIdx].Zc = pData[NodeHydraulic::CharImpedance];
 }
 
 inline void readHydraulicMultiPortValues_all(Port *pMainPort, const size_t subPortIdx, std::vector<HydraulicNodeDataValueStructT> &rValues)
 {
-    const std::vector<double> &rData = pMainPort->getNodeDataVector(subPortIdx);
-    rValues[subPortIdx].q = rData[NodeHydraulic::Flow];
-    rValues[subPortIdx].p = rData[NodeHydraulic::Pressure];
-    rValues[subPortIdx].c = rData[NodeHydraulic::WaveVariable];
-    rValues[subPortIdx].Zc = rData[NodeHydraulic::CharImpedance];
+    const double *pData = pMainPort->getNodeDataValues(subPortIdx);
+    rValues[subPortIdx].q = pData[NodeHydraulic::Flow];
+    rValues[subPortIdx].p = pData[NodeHydraulic::Pressure];
+    rValues[subPortIdx].c = pData[NodeHydraulic::WaveVariable];
+    rValues[subPortIdx].Zc = pData[NodeHydraulic::CharImpedance];
 }
 
 inline void readHydraulicMultiPortValues_all(Port *pMainPort, std::vector<HydraulicNodeDataValueStructT> &rValues)
 {
     for (size_t i=0; i<pMainPort->getNumPorts(); ++i)
     {
-        const std::vector<double> &rData = pMainPort->getNodeDataVector(i);
-        rValues[i].q = rData[NodeHydraulic::Flow];
-        rValues[i].p = rData[NodeHydraulic::Pressure];
-        rValues[i].c = rData[NodeHydraulic::WaveVariable];
-        rValues[i].Zc = rData[NodeHydraulic::CharImpedance];
+        const double *pData = pMainPort->getNodeDataValues(i);
+        rValues[i].q = pData[NodeHydraulic::Flow];
+        rValues[i].p = pData[NodeHydraulic::Pressure];
+        rValues[i].c = pData[NodeHydraulic::WaveVariable];
+        rValues[i].Zc = pData[NodeHydraulic::CharImpedance];
     }
 }
 
@@ -317,48 +317,48 @@ inline void getHydraulicMultiPortNodeDataPointers(Port *pMainPort, std::vector<H
 
 inline void writeHydraulicPort_pq(Port *pPort, const double p, const double q)
 {
-    std::vector<double> &rData = pPort->getNodeDataVector();
-    rData[NodeHydraulic::Flow] = q;
-    rData[NodeHydraulic::Pressure] = p;
+    double *pData = pPort->getNodeDataValues();
+    pData[NodeHydraulic::Flow] = q;
+    pData[NodeHydraulic::Pressure] = p;
 }
 
 inline void writeHydraulicMultiPort_pq(Port *pPort, const size_t subPortIdx, const double p, const double q)
 {
-    std::vector<double> &rData = pPort->getNodeDataVector(subPortIdx);
-    rData[NodeHydraulic::Flow] = q;
-    rData[NodeHydraulic::Pressure] = p;
+    double *pData = pPort->getNodeDataValues(subPortIdx);
+    pData[NodeHydraulic::Flow] = q;
+    pData[NodeHydraulic::Pressure] = p;
 }
 
 inline void writeHydraulicPort_cZc(Port *pPort, const double c, const double Zc)
 {
-    std::vector<double> &rData = pPort->getNodeDataVector();
-    rData[NodeHydraulic::WaveVariable] = c;
-    rData[NodeHydraulic::CharImpedance] = Zc;
+    double *pData = pPort->getNodeDataValues();
+    pData[NodeHydraulic::WaveVariable] = c;
+    pData[NodeHydraulic::CharImpedance] = Zc;
 }
 
 inline void writeHydraulicMultiPort_cZc(Port *pPort, const size_t subPortIdx, const double c, const double Zc)
 {
-    std::vector<double> &rData = pPort->getNodeDataVector(subPortIdx);
-    rData[NodeHydraulic::WaveVariable] = c;
-    rData[NodeHydraulic::CharImpedance] = Zc;
+    double *pData = pPort->getNodeDataValues(subPortIdx);
+    pData[NodeHydraulic::WaveVariable] = c;
+    pData[NodeHydraulic::CharImpedance] = Zc;
 }
 
 inline void writeHydraulicPort_all(Port *pPort, const double p, const double q, const double c, const double Zc)
 {
-    std::vector<double> &rData = pPort->getNodeDataVector();
-    rData[NodeHydraulic::Flow] = q;
-    rData[NodeHydraulic::Pressure] = p;
-    rData[NodeHydraulic::WaveVariable] = c;
-    rData[NodeHydraulic::CharImpedance] = Zc;
+    double *pData = pPort->getNodeDataValues();
+    pData[NodeHydraulic::Flow] = q;
+    pData[NodeHydraulic::Pressure] = p;
+    pData[NodeHydraulic::WaveVariable] = c;
+    pData[NodeHydraulic::CharImpedance] = Zc;
 }
 
 inline void writeHydraulicPort_all(Port *pPort, const HydraulicNodeDataValueStructT &rValues)
 {
-    std::vector<double> &rData = pPort->getNodeDataVector();
-    rData[NodeHydraulic::Flow] = rValues.q;
-    rData[NodeHydraulic::Pressure] = rValues.p;
-    rData[NodeHydraulic::WaveVariable] = rValues.c;
-    rData[NodeHydraulic::CharImpedance] = rValues.Zc;
+    double *pData = pPort->getNodeDataValues();
+    pData[NodeHydraulic::Flow] = rValues.q;
+    pData[NodeHydraulic::Pressure] = rValues.p;
+    pData[NodeHydraulic::WaveVariable] = rValues.c;
+    pData[NodeHydraulic::CharImpedance] = rValues.Zc;
 }
 
 
@@ -450,76 +450,76 @@ public:
 
 inline void readMechanicPort_vfx(Port *pPort, double &v, double &f, double &x)
 {
-    const std::vector<double> &rData = pPort->getNodeDataVector();
-    v = rData[NodeMechanic::Velocity];
-    f = rData[NodeMechanic::Force];
-    x = rData[NodeMechanic::Position];
+    const double *pData = pPort->getNodeDataValues();
+    v = pData[NodeMechanic::Velocity];
+    f = pData[NodeMechanic::Force];
+    x = pData[NodeMechanic::Position];
 }
 
 inline void readMechanicPort_cZc(Port *pPort, double &c, double &Zc)
 {
-    const std::vector<double> &rData = pPort->getNodeDataVector();
-    c = rData[NodeMechanic::WaveVariable];
-    Zc = rData[NodeMechanic::CharImpedance];
+    const double *pData = pPort->getNodeDataValues();
+    c = pData[NodeMechanic::WaveVariable];
+    Zc = pData[NodeMechanic::CharImpedance];
 }
 
 inline void readMechanicPort_all(Port *pPort, double &v, double &f, double &x, double &c, double &Zc, double &me)
 {
-    const std::vector<double> &rData = pPort->getNodeDataVector();
-    v = rData[NodeMechanic::Velocity];
-    f = rData[NodeMechanic::Force];
-    x = rData[NodeMechanic::Position];
-    c = rData[NodeMechanic::WaveVariable];
-    Zc = rData[NodeMechanic::CharImpedance];
-    me = rData[NodeMechanic::EquivalentMass];
+    const double *pData = pPort->getNodeDataValues();
+    v = pData[NodeMechanic::Velocity];
+    f = pData[NodeMechanic::Force];
+    x = pData[NodeMechanic::Position];
+    c = pData[NodeMechanic::WaveVariable];
+    Zc = pData[NodeMechanic::CharImpedance];
+    me = pData[NodeMechanic::EquivalentMass];
 }
 
 inline void readMechanicPort_all(Port *pPort, MechanicNodeDataValueStructT &rValues)
 {
-    const std::vector<double> &rData = pPort->getNodeDataVector();
-    rValues.v = rData[NodeMechanic::Velocity];
-    rValues.f = rData[NodeMechanic::Force];
-    rValues.x = rData[NodeMechanic::Position];
-    rValues.c = rData[NodeMechanic::WaveVariable];
-    rValues.Zc = rData[NodeMechanic::CharImpedance];
-    rValues.me = rData[NodeMechanic::EquivalentMass];
+    const double *pData = pPort->getNodeDataValues();
+    rValues.v = pData[NodeMechanic::Velocity];
+    rValues.f = pData[NodeMechanic::Force];
+    rValues.x = pData[NodeMechanic::Position];
+    rValues.c = pData[NodeMechanic::WaveVariable];
+    rValues.Zc = pData[NodeMechanic::CharImpedance];
+    rValues.me = pData[NodeMechanic::EquivalentMass];
 }
 
 inline void writeMechanicPort_vfx(Port *pPort, const double v, const double f, const double x)
 {
-    std::vector<double> &rData = pPort->getNodeDataVector();
-    rData[NodeMechanic::Velocity] = v;
-    rData[NodeMechanic::Force] = f;
-    rData[NodeMechanic::Position] = x;
+    double *pData = pPort->getNodeDataValues();
+    pData[NodeMechanic::Velocity] = v;
+    pData[NodeMechanic::Force] = f;
+    pData[NodeMechanic::Position] = x;
 }
 
 inline void writeMechanicPort_cZc(Port *pPort, const double c, const double Zc)
 {
-    std::vector<double> &rData = pPort->getNodeDataVector();
-    rData[NodeMechanic::WaveVariable] = c;
-    rData[NodeMechanic::CharImpedance] = Zc;
+    double *pData = pPort->getNodeDataValues();
+    pData[NodeMechanic::WaveVariable] = c;
+    pData[NodeMechanic::CharImpedance] = Zc;
 }
 
 inline void writeMechanicPort_all(Port *pPort, const double v, const double f, const double x, const double c, const double Zc, const double me)
 {
-    std::vector<double> &rData = pPort->getNodeDataVector();
-    rData[NodeMechanic::Velocity] = v;
-    rData[NodeMechanic::Force] = f;
-    rData[NodeMechanic::Position] = x;
-    rData[NodeMechanic::WaveVariable] = c;
-    rData[NodeMechanic::CharImpedance] = Zc;
-    rData[NodeMechanic::EquivalentMass] = me;
+    double *pData = pPort->getNodeDataValues();
+    pData[NodeMechanic::Velocity] = v;
+    pData[NodeMechanic::Force] = f;
+    pData[NodeMechanic::Position] = x;
+    pData[NodeMechanic::WaveVariable] = c;
+    pData[NodeMechanic::CharImpedance] = Zc;
+    pData[NodeMechanic::EquivalentMass] = me;
 }
 
 inline void writeMechanicPort_all(Port *pPort, const MechanicNodeDataValueStructT &rValues)
 {
-    std::vector<double> &rData = pPort->getNodeDataVector();
-    rData[NodeMechanic::Velocity] = rValues.v;
-    rData[NodeMechanic::Force] = rValues.f;
-    rData[NodeMechanic::Position] = rValues.x;
-    rData[NodeMechanic::WaveVariable] = rValues.c;
-    rData[NodeMechanic::CharImpedance] = rValues.Zc;
-    rData[NodeMechanic::EquivalentMass] = rValues.me;
+    double *pData = pPort->getNodeDataValues();
+    pData[NodeMechanic::Velocity] = rValues.v;
+    pData[NodeMechanic::Force] = rValues.f;
+    pData[NodeMechanic::Position] = rValues.x;
+    pData[NodeMechanic::WaveVariable] = rValues.c;
+    pData[NodeMechanic::CharImpedance] = rValues.Zc;
+    pData[NodeMechanic::EquivalentMass] = rValues.me;
 }
 
 inline void getMechanicPortNodeDataPointers(Port *pPort, MechanicNodeDataPointerStructT &rPointers)
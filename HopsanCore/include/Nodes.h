@@ -205,7 +205,7 @@ private:
 
     virtual void setTLMNodeDataValuesTo(Node *pOtherNode) const
     {
-        pOtherNode->setDataValue(WaveVariable, mDataValues[Pressure]);
+        pOtherNode->setDataValue(WaveVariable, getDataValue(Pressure));
         //! todo Maybe also write CHARIMP?
     }
 };
@@ -271,7 +271,7 @@ private:
 
     virtual void setTLMNodeDataValuesTo(Node *pOtherNode) const
     {
-        pOtherNode->setDataValue(WaveVariable, mDataValues[Pressure]);
+        pOtherNode->setDataValue(WaveVariable, getDataValue(Pressure));
         //! todo Maybe also write CHARIMP?
     }
 };
@@ -311,7 +311,7 @@ private:
 
     virtual void setTLMNodeDataValuesTo(Node *pOtherNode) const
     {
-        pOtherNode->setDataValue(WaveVariable, mDataValues[Pressure]);
+        pOtherNode->setDataValue(WaveVariable, getDataValue(Pressure));
         //! todo Maybe also write CharImpedance?
     }
 };
@@ -343,7 +343,7 @@ private:
 
     virtual void setTLMNodeDataValuesTo(Node *pOtherNode) const
     {
-        pOtherNode->setDataValue(WaveVariable, mDataValues[Force]);
+        pOtherNode->setDataValue(WaveVariable, getDataValue(Force));
         //! todo Maybe also write CharImpedance?
     }
 };
@@ -373,7 +373,7 @@ private:
 
     virtual void setTLMNodeDataValuesTo(Node *pOtherNode) const
     {
-        pOtherNode->setDataValue(WaveVariable, mDataValues[Torque]);
+        pOtherNode->setDataValue(WaveVariable, getDataValue(Torque));
         //! todo Maybe also write CharImpedance?
     }
 };
@@ -403,7 +403,7 @@ private:
 
     virtual void setTLMNodeDataValuesTo(Node *pOtherNode) const
     {
-        pOtherNode->setDataValue(WaveVariable, mDataValues[Voltage]);
+        pOtherNode->setDataValue(WaveVariable, getDataValue(Voltage));
         //! todo Maybe also write CharImpedance?
     }
 };
@@ -452,9 +452,9 @@ private:
 
     virtual void setTLMNodeDataValuesTo(Node *pOtherNode) const
     {
-        pOtherNode->setDataValue(WaveVariableR, mDataValues[TorqueR]);
-        pOtherNode->setDataValue(WaveVariableX, mDataValues[ForceX]);
-        pOtherNode->setDataValue(WaveVariableY, mDataValues[ForceY]);
+        pOtherNode->setDataValue(WaveVariableR, getDataValue(TorqueR));
+        pOtherNode->setDataValue(WaveVariableX, getDataValue(ForceX));
+        pOtherNode->setDataValue(WaveVariableY, getDataValue(ForceY));
         //! todo Maybe also write CharImpedance?
     }
 };
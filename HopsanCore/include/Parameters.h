@@ -41,6 +41,7 @@ namespace hopsan {
 
 //Forward declaration
 class Component;
+class ComponentSystem;
 class ParameterEvaluatorHandler;
 
 class HOPSANCORE_DLLAPI ParameterEvaluator
@@ -51,12 +52,14 @@ public:
                        const HString &rType, void* pDataPtr=0, ParameterEvaluatorHandler* pParameterEvalHandler=0);
 
     bool setParameterValue(const HString &rValue, ParameterEvaluator **ppNeedEvaluation=0, bool force=false);
+    bool setParameterValue(const double value);
     bool setParameter(const HString &rValue, const HString &rDescription, const HString &rQuantity, const HString &rUnit,
                       const HString &rType, ParameterEvaluator **pNeedEvaluation=0, bool force=false);
 
     bool evaluate(HString &rResult);
     bool evaluate();
     bool refreshParameterValueText();
+    bool referencesAnyOf(const std::vector<HString> &rNames) const;
 
     void* getDataPtr();
 
@@ -72,11 +75,13 @@ public:
     bool triggersReconfiguration();
 
 protected:
+    void writeNumericValue();
+    void updateNumericValueText() const;
     void resolveSignPrefix(HString &rSignPrefix) const;
     void splitSignPrefix(const HString &rString, HString &rPrefix, HString &rValue);
 
     HString mParameterName;
-    HString mParameterValue;
+    mutable HString mParameterValue;
     HString mDescription;
     HString mUnit;
     HString mQuantity;
@@ -86,6 +91,9 @@ protected:
     ParameterEvaluatorHandler* mpParameterEvaluatorHandler;
     std::vector<HString> mConditions;
     bool mTriggersReconfiguration;
+    bool mHasNumericValue;
+    mutable bool mNumericValueTextOutdated;
+    double mNumericValue;
 };
 
 
@@ -109,6 +117,7 @@ public:
 
     void getParameterValue(const HString &rName, HString &rValue);
     bool setParameterValue(const HString &rName, const HString &rValue, bool force=false);
+    bool setParameterValue(ParameterEvaluator *pParameter, const double value);
     void* getParameterDataPtr(const HString &rName);
 
     bool refreshParameterValueText(const HString &rParameterName);
@@ -124,12 +133,41 @@ public:
     void setParameterTriggersReconfiguration(const HString &rParameterName);
     bool parameterTriggersReconfiguration(const HString &rParameterName);
 
+    const std::vector<ParameterEvaluator*> &getChangedParameters() const;
+    bool haveParametersBeenAddedOrRemoved() const;
+    void clearChangedParameters();
+
     Component *getComponent() const;
 
 protected:
+    void markParameterChanged(ParameterEvaluator *pParameter);
+
     Component* mComponent;
     std::vector<ParameterEvaluator*> mParameters;
     std::vector<ParameterEvaluator*> mParametersNeedEvaluation; //! @todo Use this vector to ensure parameters are valid at simulation time e.g. if a used system parameter is deleted before simulation
+    std::vector<ParameterEvaluator*> mChangedParameters;
+    bool mParametersAddedOrRemoved;
+};
+
+
+//! @brief A pre-resolved reference to a parameter in a component or system, used for fast repeated numeric parameter updates
+//! @details Obtain a handle with ComponentSystem::getParameterHandle() and set values with ComponentSystem::setParameterValue().
+//! The handle becomes invalid when a parameter or port is removed in the system that created it, e.g. when a component is removed
+//! or reconfigured, since the parameter it refers to may have been deleted. Check isValid() and get a new handle when needed.
+class HOPSANCORE_DLLAPI ParameterHandle
+{
+    friend class ComponentSystem;
+public:
+    ParameterHandle();
+    bool isValid() const;
+    Component *getComponent() const;
+    ParameterEvaluator *getParameter() const;
+
+private:
+    const ComponentSystem *mpSystem;
+    Component *mpComponent;
+    ParameterEvaluator *mpParameter;
+    size_t mParameterSetGeneration;
 };
 
 }
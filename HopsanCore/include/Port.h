@@ -74,7 +74,7 @@ namespace hopsan {
         //! @return The data value
         inline double readNode(const size_t idx) const
         {
-            return mpNode->mDataValues[idx];
+            return mpNode->mpDataValues[idx];
         }
 
         //! @brief Reads a value from the connected node
@@ -85,7 +85,7 @@ namespace hopsan {
         virtual inline double readNode(const size_t idx, const size_t subPortIdx) const
         {
             HOPSAN_UNUSED(subPortIdx)
-            return mpNode->mDataValues[idx];
+            return mpNode->mpDataValues[idx];
         }
 
         //! @brief Writes a value to the connected node
@@ -94,7 +94,7 @@ namespace hopsan {
         //! @param [in] value The value to write
         inline void writeNode(const size_t idx, const double value)
         {
-            mpNode->mDataValues[idx] = value;
+            mpNode->mpDataValues[idx] = value;
         }
 
         //! @brief Writes a value to the connected node
@@ -105,11 +105,12 @@ namespace hopsan {
         virtual inline void writeNode(const size_t idx, const double value, const size_t subPortIdx)
         {
             HOPSAN_UNUSED(subPortIdx)
-            mpNode->mDataValues[idx] = value;
+            mpNode->mpDataValues[idx] = value;
         }
 
         ///@{
         //! @brief Returns a reference to the Node data in the port
+        //! @note If the owner system uses a node data arena, the vector is only up to date before initialize and after finalize, use readNode() and writeNode() during simulation
         //! @returns A reference to the node data vector
         inline std::vector<double> &getNodeDataVector()
         {
@@ -139,6 +140,38 @@ namespace hopsan {
         }
         ///@}
 
+        ///@{
+        //! @brief Returns a pointer to the first Node data value in the port
+        //! @details Unlike getNodeDataVector() this is always valid, also when the node data is stored in a node data arena
+        //! @returns A pointer to the node data values
+        inline double *getNodeDataValues()
+        {
+            return mpNode->mpDataValues;
+        }
+
+        inline const double *getNodeDataValues() const
+        {
+            return mpNode->mpDataValues;
+        }
+        ///@}
+
+        ///@{
+        //! @brief Returns a pointer to the first Node data value in the port
+        //! @param[in] subPortIdx The index of a multiport subport to access
+        //! @returns A pointer to the node data values
+        virtual inline double *getNodeDataValues(const size_t subPortIdx)
+        {
+            HOPSAN_UNUSED(subPortIdx);
+            return getNodeDataValues();
+        }
+
+        virtual inline const double *getNodeDataValues(const size_t subPortIdx) const
+        {
+            HOPSAN_UNUSED(subPortIdx);
+            return getNodeDataValues();
+        }
+        ///@}
+
         virtual double readNodeSafe(const size_t idx, const size_t subPortIdx=0) const;
         virtual void writeNodeSafe(const size_t idx, const double value, const size_t subPortIdx=0);
 
@@ -162,10 +195,11 @@ namespace hopsan {
 
         virtual bool haveLogData(const size_t subPortIdx=0);
         virtual std::vector<double> *getLogTimeVectorPtr(const size_t subPortIdx=0);
-        virtual std::vector<std::vector<double> > *getLogDataVectorPtr(size_t subPortIdx=0);
-        virtual const std::vector<std::vector<double> > *getLogDataVectorPtr(size_t subPortIdx=0) const;
+        virtual LogDataColumnView getLogDataColumn(const size_t dataId, const size_t subPortIdx=0) const;
         virtual void setEnableLogging(const bool enableLog);
         bool isLoggingEnabled() const;
+        virtual void setEnableVariableLogging(const size_t dataId, const bool enableLog);
+        bool isVariableLoggingEnabled(const size_t dataId) const;
 
         virtual bool isConnected() const;
         virtual bool isConnectedTo(Port *pOtherPort);
@@ -203,6 +237,7 @@ namespace hopsan {
         Component* mpComponent;
         Port* mpParentPort;
         bool mEnableLogging;
+        std::vector<bool> mDisabledLogVariables;
 
         std::vector<Port*> mConnectedPorts;
 
@@ -305,6 +340,21 @@ namespace hopsan {
         }
         ///@}
 
+        ///@{
+        //! @brief Returns a pointer to the first Node data value in the port
+        //! @param[in] subPortIdx The index of a multiport subport to access
+        //! @returns A pointer to the node data values
+        inline double *getNodeDataValues(const size_t subPortIdx)
+        {
+            return mSubPortsVector[subPortIdx]->getNodeDataValues();
+        }
+
+        inline const double *getNodeDataValues(const size_t subPortIdx) const
+        {
+            return mSubPortsVector[subPortIdx]->getNodeDataValues();
+        }
+        ///@}
+
         const Node *getNodePtr(const size_t subPortIdx=0) const;
         double *getNodeDataPtr(const size_t idx, const size_t subPortIdx) const;
         std::vector<double> *getDataVectorPtr(const size_t subPortIdx=0);
@@ -315,9 +365,9 @@ namespace hopsan {
 
         bool haveLogData(const size_t subPortIdx=0);
         std::vector<double> *getLogTimeVectorPtr(const size_t subPortIdx=0);
-        std::vector<std::vector<double> > *getLogDataVectorPtr(const size_t subPortIdx=0);
-        const std::vector<std::vector<double> > *getLogDataVectorPtr(size_t subPortIdx=0) const;
+        LogDataColumnView getLogDataColumn(const size_t dataId, const size_t subPortIdx=0) const;
         virtual void setEnableLogging(const bool enableLog);
+        virtual void setEnableVariableLogging(const size_t dataId, const bool enableLog);
 
         double getStartValue(const size_t idx, const size_t subPortIdx=0);
 
@@ -66,6 +66,26 @@ using namespace hopsan;
 // This is a dummy variable
 double dummyDouble=0;
 
+//! @brief Make sure that the next ComponentSystem::reinitialize() performs a full initialization, since the model structure has changed
+static void invalidateWarmRestart(Component *pComponent)
+{
+    ComponentSystem *pSystem = pComponent->isComponentSystem() ? static_cast<ComponentSystem*>(pComponent) : pComponent->getSystemParent();
+    if (pSystem)
+    {
+        pSystem->invalidateWarmRestart();
+    }
+}
+
+//! @brief Make sure that parameter handles are not used after a port, and the start value parameters that belong to it, has been removed
+static void invalidateParameterHandles(Component *pComponent)
+{
+    ComponentSystem *pSystem = pComponent->isComponentSystem() ? static_cast<ComponentSystem*>(pComponent) : pComponent->getSystemParent();
+    if (pSystem)
+    {
+        pSystem->invalidateParameterHandles();
+    }
+}
+
 //! @brief Component base class Constructor
 Component::Component()
 {
@@ -137,6 +157,7 @@ bool Component::setParameterValue(const HString &rName, const HString &rValue, b
     bool success = mpParameters->setParameterValue(rName, rValue, force);
     if(success && mpParameters->parameterTriggersReconfiguration(rName)) {
         this->reconfigure();
+        invalidateWarmRestart(this);
     }
     return success;
 }
@@ -297,8 +318,38 @@ void Component::simulate(const double stopT)
     //END DEBUG
 }
 
+//! @brief Check if the component has a vectorised simulateOneTimestepEnsemble() implementation
+//! @details Components that return false are simulated one lane at a time in ensemble simulations
+//! @returns true if the component overloads simulateOneTimestepEnsemble(), else false
+bool Component::hasEnsembleSimulation() const
+{
+    return false;
+}
+
+//! @brief Simulates the same component in several structurally identical models (lanes) in lockstep
+//! @details This component must be the first lane. All lanes must be of the same type and use the same timestep
+//! @param [in] ppLanes Array with the component in each lane
+//! @param [in] nLanes The number of lanes
+//! @param [in] stopT Stop time
+void Component::simulateEnsemble(Component *const *ppLanes, const size_t nLanes, const double stopT)
+{
+    const size_t nSteps = calcNumSimSteps(mTime, stopT);
+    for (size_t i=0; i<nSteps; ++i)
+    {
+        for (size_t l=0; l<nLanes; ++l)
+        {
+            ppLanes[l]->mTime += ppLanes[l]->mTimestep;
+        }
+        simulateOneTimestepEnsemble(ppLanes, nLanes);
+    }
+}
+
 void Component::setDisabled(bool value)
 {
+    if (value != mIsDisabled)
+    {
+        invalidateWarmRestart(this);
+    }
     mIsDisabled = value;
 }
 
@@ -328,6 +379,20 @@ void Component::simulateOneTimestep()
     stopSimulation();
 }
 
+//! @brief Simulates one time step in each lane of an ensemble, see simulateEnsemble()
+//! @details Overload this together with hasEnsembleSimulation() to process all lanes at once, preferably using EnsembleBlock.
+//! The default implementation simulates one lane at a time
+//! @param [in] ppLanes Array with the component in each lane, the first lane is this component
+//! @param [in] nLanes The number of lanes
+//! @ingroup ComponentSimulationFunctions
+void Component::simulateOneTimestepEnsemble(Component *const *ppLanes, const size_t nLanes)
+{
+    for (size_t l=0; l<nLanes; ++l)
+    {
+        ppLanes[l]->simulateOneTimestep();
+    }
+}
+
 //! @brief Optional function that is called after every simulation, can be used to clean up memory allocation made in initialize
 //! @ingroup ComponentSimulationFunctions
 void Component::finalize()
@@ -848,6 +913,8 @@ Port *Component::addPort(const HString &rPortName, const PortTypesEnumT portType
             pNewPort->mConnectionRequired = false;
         }
 
+        invalidateWarmRestart(this);
+
         // Store the port in the port map, for faster port by name lookup
         mPortPtrMap.insert(PortPtrPairT(newname, pNewPort));
         // Store the port in the vector, to remember the order of added ports (useful when retrieving variameters)
@@ -883,6 +950,7 @@ void Component::removePort(const HString &rPortName)
 
     // Unregister all startvalue parameters connected to this port
     pPort->unRegisterStartValueParameters();
+    invalidateParameterHandles(this);
 //    if(pPort->getStartNodePtr())
 //    {
 //        for(size_t i=0; i<pPort->getStartNodePtr()->getNumDataVariables(); ++i)
@@ -1002,6 +1070,7 @@ void Component::deletePort(const HString &rName)
     if (it != mPortPtrMap.end())
     {
         Port *pPort = it->second;
+        invalidateWarmRestart(this);
 
         // Remove in port vector first
         std::vector<Port*>::iterator pvit;
@@ -1019,6 +1088,7 @@ void Component::deletePort(const HString &rName)
 
         // Unregister any start value parameters connected to this port
         pPort->unRegisterStartValueParameters();
+        invalidateParameterHandles(this);
 
         // delete the port
         delete pPort;
@@ -1762,6 +1832,18 @@ void Component::loadStartValuesFromSimulation()
 }
 
 
+//! @brief Saves or restores the internal simulation state of the component, such as delay buffers and integrator states
+//! @details Components with internal state should overload this function and pass all state variables to the archive,
+//! in the same order every time. The same function is used both when saving and when restoring a simulation point.
+//! Node data in ports is saved separately and should not be included. The default implementation has no state.
+//! @ingroup ComponentSimulationFunctions
+//! @param[in,out] rArchive The archive to save the state to or restore it from
+void Component::serializeState(StateArchive &/*rArchive*/)
+{
+    // Default has no internal state
+}
+
+
 //! @brief Find and return the full file path name of fileName within the system search path, parent systems included (path to HMF file is always in here)
 //! @details With this function you can find external files based on a path relative to the model file path
 //! This makes it possible to avoid absolute paths for external file resources
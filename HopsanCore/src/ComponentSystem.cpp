@@ -34,10 +34,14 @@
 #include <limits>
 #include <cmath>
 #include <cstdlib>
+#include <cstring>
 #include <iostream>
 #include <algorithm>
 #include <map>
+#include <set>
+#include <unordered_map>
 #include <time.h>
+#include <stdint.h>
 
 #include "ComponentSystem.h"
 #include "HopsanEssentials.h"
@@ -48,6 +52,12 @@
 #include "CoreUtilities/HmfLoader.h"
 #include "CoreUtilities/NumHopHelper.h"
 #include "CoreUtilities/ConnectionAssistant.h"
+#include "CoreUtilities/LogStreaming.h"
+#include "CoreUtilities/GraphPartitioner.h"
+#include "CoreUtilities/SaveRestoreSimulationPoint.h"
+#include "CoreUtilities/CompiledModel.h"
+#include "CoreUtilities/SimulationProfiler.h"
+#include "CoreUtilities/RealtimeExecutor.h"
 #include "ComponentUtilities/num2string.hpp"
 
 using namespace std;
@@ -105,19 +115,97 @@ bool vectorContains(const std::vector<T> &rVector, const T &rObj)
     }
     return false;
 }
+
+//! @brief The alignment (and cache line size) in bytes used for the node data arena
+const size_t gNodeDataArenaAlignment = 64;
+
+#if defined(HOPSANCORE_USEMULTITHREADING)
+//! @brief Mix the bits of a value, used when combining hash values
+size_t mixHash(const size_t value)
+{
+    uint64_t x = uint64_t(value) + 0x9e3779b97f4a7c15ULL;
+    x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    x = (x ^ (x >> 27)) * 0x94d049bb133111ebULL;
+    return size_t(x ^ (x >> 31));
+}
+
+//! @brief Calculate a key that identifies a set of components, their time steps and the nodes that they are connected to
+//! @details The key does not depend on the order of the components, since the simulation order may be changed by sorting.
+//! Structural changes also discard the schedule explicitly, see ComponentSystem::invalidateWarmRestart()
+size_t calculateTopologyKey(const std::vector<hopsan::Component*> &rComponents)
+{
+    size_t key = 0;
+    for (size_t c=0; c<rComponents.size(); ++c)
+    {
+        const double timestep = rComponents[c]->getTimestep();
+        uint64_t timestepBits;
+        memcpy(&timestepBits, &timestep, sizeof(timestepBits));
+        size_t componentKey = mixHash(size_t(rComponents[c]));
+        componentKey = mixHash(componentKey ^ size_t(timestepBits));
+        std::vector<hopsan::Port*> ports = rComponents[c]->getPortPtrVector();
+        for (size_t p=0; p<ports.size(); ++p)
+        {
+            for (size_t s=0; s<ports[p]->getNumPorts(); ++s)
+            {
+                componentKey = mixHash(componentKey ^ size_t(ports[p]->getNodePtr(s)));
+            }
+        }
+        key += componentKey;
+    }
+    return key;
+}
+
+//! @brief Calculate a key that identifies a multi-threaded schedule, the schedule can be reused as long as the key is the same
+size_t calculateScheduleKey(const std::vector<hopsan::Component*> &rSignalComponents, const std::vector<hopsan::Component*> &rCComponents,
+                            const std::vector<hopsan::Component*> &rQComponents, const size_t nThreads, const hopsan::ParallelAlgorithmT algorithm)
+{
+    size_t key = mixHash(nThreads);
+    key = mixHash(key ^ size_t(algorithm));
+    key = mixHash(key ^ calculateTopologyKey(rSignalComponents));
+    key = mixHash(key ^ calculateTopologyKey(rCComponents));
+    key = mixHash(key ^ calculateTopologyKey(rQComponents));
+    return key;
+}
+#endif
+
+//! @brief Check if a node only belongs to a single unconnected read port
+//! @details Logging such a node does not make sense as it will only contain the start value
+bool isUnconnectedReadPortNode(const hopsan::Node *pNode)
+{
+    return ( (pNode->getNumConnectedPorts() < 2) && (pNode->getNumberOfPortsByType(hopsan::ReadPortType) == 1) );
+}
 } // anon namespace
 
 namespace hopsan {
 
 class ComponentSystemMultiThreadPrivates {
 public:
+    ComponentSystemMultiThreadPrivates() : mScheduleKey(0), mHaveSchedule(false)
+    {
+#if defined(HOPSANCORE_USEMULTITHREADING)
+        mpSignalSchedule = 0;
+#endif
+    }
+
+    ~ComponentSystemMultiThreadPrivates()
+    {
+#if defined(HOPSANCORE_USEMULTITHREADING)
+        delete mpSignalSchedule;
+#endif
+    }
+
     std::vector<double *> mvTimePtrs;
     std::vector< std::vector<Component*> > mSplitCVector;
     std::vector< std::vector<Component*> > mSplitQVector;
     std::vector< std::vector<Component*> > mSplitSignalVector;
     std::vector< std::vector<Node*> > mSplitNodeVector;
+    // Identifies the components, connections and settings that the split vectors were created for
+    size_t mScheduleKey;
+    bool mHaveSchedule;
 #if defined(HOPSANCORE_USEMULTITHREADING)
     std::mutex mStopMutex;
+    // Schedule for running dependent signal components in parallel, 0 if each thread simulates its signal components without waiting
+    SignalComponentSchedule *mpSignalSchedule;
 #endif
 
 };
@@ -133,6 +221,23 @@ ComponentSystem::ComponentSystem() : Component(), mAliasHandler(this)
     mDesiredTimestep = 0.001;
     mInheritTimestep = true;
     mKeepValuesAsStartValues = false;
+    mUseNodeDataArena = false;
+    mUseHierarchyFlattening = false;
+    mpCompiledModel = 0;
+    mIsCompiledModelBound = false;
+    mpProfiler = 0;
+    mpRealtimeExecutor = 0;
+    mUseLoadRebalancing = true;
+    mUseSignalLevelScheduling = true;
+    mThreadPlacement = AutomaticThreadPlacement;
+    mParameterSetGeneration = 0;
+    mCanWarmRestart = false;
+    mIsWarmRestarting = false;
+    mpLogSink = 0;
+    mLogSinkRingBufferSize = 4096;
+    mpLogStreamer = 0;
+    mnStreamedLogSamples = 0;
+    mIsLogStreamedByParent = false;
     mRequestedNumLogSamples = 0; //This has to be 0 since we want logging to be disabled by default
     mRequestedLogStartTime = 0;
     mpMultiThreadPrivates = new ComponentSystemMultiThreadPrivates;
@@ -156,9 +261,16 @@ ComponentSystem::ComponentSystem() : Component(), mAliasHandler(this)
 
 ComponentSystem::~ComponentSystem()
 {
+    // Stop any ongoing real-time simulation, before the components are removed
+    delete mpRealtimeExecutor;
+
+    // Stop any ongoing log stream, before the nodes are removed
+    finishLogStream();
+
     // Clear the contents of the system
     clear();
     delete mpMultiThreadPrivates;
+    delete mpCompiledModel;
 }
 
 void ComponentSystem::configure()
@@ -206,6 +318,30 @@ size_t ComponentSystem::getNumActuallyLoggedSamples() const
     return mLogCtr;
 }
 
+//! @brief Stream logged samples to a log sink instead of storing them in memory
+//! @details When a sink is set, the log data of this system and all its subsystems is passed to the sink while simulating,
+//! memory use is then bounded by the ring buffer size instead of the number of log samples. No log data will be available
+//! in the nodes. The stream is started by initialize() and ended by finalize().
+//! @param [in] pSink The log sink, set 0 to store log data in memory again. The sink is not owned by the system and must outlive finalize()
+//! @param [in] ringBufferSize The number of samples that can be buffered before the simulation has to wait for the sink
+void ComponentSystem::setLogSink(LogSink *pSink, const size_t ringBufferSize)
+{
+    mpLogSink = pSink;
+    mLogSinkRingBufferSize = ringBufferSize;
+}
+
+//! @brief Returns the log sink, or 0 if log data is stored in memory
+LogSink *ComponentSystem::getLogSink() const
+{
+    return mpLogSink;
+}
+
+//! @brief Returns the number of samples passed on to the log sink during the last simulation
+size_t ComponentSystem::getNumStreamedLogSamples() const
+{
+    return mnStreamedLogSamples;
+}
+
 
 //! @brief Set the stop simulation flag to abort the initialization or simulation loops
 //! @param[in] rReason An optional HString describing the reason for the stop
@@ -332,6 +468,84 @@ bool ComponentSystem::setSystemParameter(const HString &rName, const HString &rV
     return false;
 }
 
+//! @brief Resolve a parameter once, so that it can be set repeatedly without name lookup and parsing
+//! @param[in] rComponentName The name of a sub component, or an empty string for a parameter in this system
+//! @param[in] rParameterName The name of the parameter, or start value e.g. P1#Pressure
+//! @returns A handle to the parameter, check isValid() to see if the parameter was found
+ParameterHandle ComponentSystem::getParameterHandle(const HString &rComponentName, const HString &rParameterName)
+{
+    ParameterHandle handle;
+    Component *pComponent = rComponentName.empty() ? this : getSubComponent(rComponentName);
+    if (!pComponent)
+    {
+        addErrorMessage("No such component: "+rComponentName+" in system: "+getName());
+        return handle;
+    }
+
+    const vector<ParameterEvaluator*> *pParameters = pComponent->mpParameters->getParametersVectorPtr();
+    for (size_t i=0; i<pParameters->size(); ++i)
+    {
+        if (pParameters->at(i)->getName() == rParameterName)
+        {
+            handle.mpSystem = this;
+            handle.mpComponent = pComponent;
+            handle.mpParameter = pParameters->at(i);
+            handle.mParameterSetGeneration = mParameterSetGeneration;
+            return handle;
+        }
+    }
+    pComponent->addErrorMessage("No such parameter: "+rParameterName);
+    return handle;
+}
+
+//! @brief Set a numeric value for a double or integer parameter using a handle from getParameterHandle()
+//! @details The value is written directly to the parameter data variable, without string conversion or expression evaluation.
+//! Parameters that depend on this one (expressions or references to system parameters) are re-evaluated on the next initialize,
+//! just as when the value is set with the string value version. If the parameter triggers a reconfiguration that removes parameters
+//! or ports, this handle and all other handles from the system become invalid.
+//! @param[in] rHandle The parameter handle
+//! @param[in] value The new value
+//! @returns true if the value could be set, false if the handle is invalid or the parameter is not numeric
+bool ComponentSystem::setParameterValue(const ParameterHandle &rHandle, const double value)
+{
+    if (!rHandle.isValid())
+    {
+        addErrorMessage("Trying to set a parameter value using an invalid parameter handle");
+        return false;
+    }
+
+    Component *pComponent = rHandle.mpComponent;
+    if (!pComponent->mpParameters->setParameterValue(rHandle.mpParameter, value))
+    {
+        pComponent->addErrorMessage("Could not set numeric value for parameter: "+rHandle.mpParameter->getName()+" of type: "+rHandle.mpParameter->getType());
+        return false;
+    }
+    if (rHandle.mpParameter->triggersReconfiguration())
+    {
+        pComponent->reconfigure();
+        invalidateWarmRestart();
+    }
+    return true;
+}
+
+//! @brief Invalidate all parameter handles created by this system or any of its parent systems
+//! @details This is done automatically when parameters, ports or components are removed, since handles may refer to deleted parameters
+void ComponentSystem::invalidateParameterHandles()
+{
+    ComponentSystem *pSystem = this;
+    while (pSystem)
+    {
+        ++pSystem->mParameterSetGeneration;
+        pSystem = pSystem->getSystemParent();
+    }
+}
+
+//! @brief Returns the parameter set generation, it changes every time parameter handles are invalidated
+size_t ComponentSystem::getParameterSetGeneration() const
+{
+    return mParameterSetGeneration;
+}
+
 void ComponentSystem::unRegisterParameter(const HString &rName)
 {
     Component::unRegisterParameter(rName);
@@ -397,6 +611,290 @@ void ComponentSystem::addComponent(Component *pComponent)
 }
 
 
+//! @brief Creates a deep copy of the system, including sub components, parameters, start values, connections and aliases
+//! @details The copy is made directly from the loaded model, without going through the model file. It is equivalent to loading the
+//! model again, but much faster for large models. Simulation results and log data are not copied.
+//! The copy is a top-level system, it is not added to any parent system.
+//! @returns A pointer to the new system, or 0 if the copy failed
+ComponentSystem *ComponentSystem::clone()
+{
+    ComponentSystem *pClone = static_cast<ComponentSystem*>(getHopsanEssentials()->createComponent(getTypeName()));
+    if (!pClone)
+    {
+        addErrorMessage("Could not create a system of type: "+getTypeName()+" when cloning "+getName());
+        return 0;
+    }
+
+    pClone->setName(getName());
+    if (!copyContentsTo(pClone))
+    {
+        addErrorMessage("Failed to clone system: "+getName());
+        getHopsanEssentials()->removeComponent(pClone);
+        return 0;
+    }
+    return pClone;
+}
+
+
+//! @brief Creates independent copies of the system that continue from the current simulation state
+//! @details The node data and the internal state of all components are captured once into one contiguous buffer, that is
+//! copied to each fork. Each fork is a clone of this system that restores the state at the end of its next initialization.
+//! Parameters in the forks can be changed before they are initialized. To continue from the current state, initialize
+//! each fork with the current simulation time of this system as start time. The forks can be simulated in parallel
+//! using the SimulationHandler.
+//! @param[in] numForks The number of forks to create
+//! @returns The forks, they are top-level systems that must be removed by the caller. Empty if forking failed
+std::vector<ComponentSystem*> ComponentSystem::fork(const size_t numForks)
+{
+    std::vector<ComponentSystem*> forks;
+    std::vector<char> state;
+    saveSimulationPointData(this, state);
+
+    forks.reserve(numForks);
+    for (size_t f=0; f<numForks; ++f)
+    {
+        ComponentSystem *pFork = clone();
+        if (!pFork)
+        {
+            addErrorMessage("Failed to fork system: "+getName());
+            for (size_t i=0; i<forks.size(); ++i)
+            {
+                getHopsanEssentials()->removeComponent(forks[i]);
+            }
+            forks.clear();
+            return forks;
+        }
+        // Node data is restored directly so that it can be used as start values, component states are restored on initialization
+        restoreSimulationPointData(state, pFork, false);
+        pFork->setSimulationPointToRestore(state);
+        forks.push_back(pFork);
+    }
+    return forks;
+}
+
+
+//! @brief Find the port in a cloned system that corresponds to a port in this system
+//! @param[in] pPort The port in this system (a sub component port or a system port), sub ports in multiports give the multiport
+//! @param[in] pSystem The system that owns the port
+//! @param[in] pTarget The cloned system
+//! @returns The corresponding port, or 0 if it does not exist
+static Port *findClonedPort(Port *pPort, ComponentSystem *pSystem, ComponentSystem *pTarget)
+{
+    if (pPort->getParentPort())
+    {
+        pPort = pPort->getParentPort();
+    }
+    Component *pComponent = (pPort->getComponent() == pSystem) ? pTarget : pTarget->getSubComponent(pPort->getComponentName());
+    if (pComponent)
+    {
+        return pComponent->getPort(pPort->getName());
+    }
+    return 0;
+}
+
+
+//! @brief Copies settings, system parameters, sub components (recursively), system ports, connections and aliases to an empty system
+//! @details The copy is made in the same order as when a model file is loaded, see loadSystemContents() in HmfLoader.cpp
+//! @param[in] pTarget The (newly created) system to copy to, it must already have its name and be added to its parent system
+//! @returns true if everything could be copied, else false
+bool ComponentSystem::copyContentsTo(ComponentSystem *pTarget)
+{
+    // Settings
+    pTarget->setSubTypeName(getSubTypeName());
+    pTarget->setDisabled(isDisabled());
+    pTarget->setDesiredTimestep(mDesiredTimestep);
+    pTarget->setInheritTimestep(mInheritTimestep);
+    pTarget->setLogStartTime(mRequestedLogStartTime);
+    pTarget->setNumLogSamples(mRequestedNumLogSamples);
+    pTarget->mEnableLogData = mEnableLogData;
+    pTarget->setKeepValuesAsStartValues(mKeepValuesAsStartValues);
+    pTarget->setUseNodeDataArena(mUseNodeDataArena);
+    pTarget->setUseHierarchyFlattening(mUseHierarchyFlattening);
+    pTarget->setUseLoadRebalancing(mUseLoadRebalancing);
+    pTarget->setUseSignalLevelScheduling(mUseSignalLevelScheduling);
+    pTarget->setThreadPlacement(mThreadPlacement, mThreadPlacementCpus);
+    pTarget->setExternalModelFilePath(mExternalModelFilePath);
+    for (size_t i=0; i<mSearchPaths.size(); ++i)
+    {
+        pTarget->addSearchPath(mSearchPaths[i]);
+    }
+
+    // System parameters (needed before sub components are copied as they may be using them)
+    const vector<ParameterEvaluator*> *pSystemParameters = getParametersVectorPtr();
+    for (size_t i=0; i<pSystemParameters->size(); ++i)
+    {
+        const ParameterEvaluator *pParameter = pSystemParameters->at(i);
+        const HString &rQuantityOrUnit = pParameter->getQuantity().empty() ? pParameter->getUnit() : pParameter->getQuantity();
+        // Use force=true, just like when loading, since parameters may refer to things that do not exist yet
+        pTarget->setOrAddSystemParameter(pParameter->getName(), pParameter->getValue(), pParameter->getType(), pParameter->getDescription(), rQuantityOrUnit, true);
+    }
+
+    pTarget->setNumHopScript(mNumHopScript);
+
+    // Sub components, in the original order in each CQS vector
+    const vector<Component*> *componentVectors[4] = {&mComponentSignalptrs, &mComponentCptrs, &mComponentQptrs, &mComponentUndefinedptrs};
+    vector<Component*> subComponents;
+    for (size_t v=0; v<4; ++v)
+    {
+        subComponents.insert(subComponents.end(), componentVectors[v]->begin(), componentVectors[v]->end());
+    }
+    for (size_t c=0; c<subComponents.size(); ++c)
+    {
+        Component *pComponent = subComponents[c];
+        Component *pNewComponent = getHopsanEssentials()->createComponent(pComponent->getTypeName());
+        if (!pNewComponent)
+        {
+            addErrorMessage("Could not create component: "+pComponent->getName()+" of type: "+pComponent->getTypeName()+" when cloning");
+            return false;
+        }
+        pNewComponent->setName(pComponent->getName());
+        pTarget->addComponent(pNewComponent);
+
+        if (pComponent->isComponentSystem())
+        {
+            if (!static_cast<ComponentSystem*>(pComponent)->copyContentsTo(static_cast<ComponentSystem*>(pNewComponent)))
+            {
+                return false;
+            }
+            continue;
+        }
+
+        pNewComponent->setSubTypeName(pComponent->getSubTypeName());
+        pNewComponent->setDisabled(pComponent->isDisabled());
+
+        // Parameters, including start values
+        const vector<ParameterEvaluator*> *pParameters = pComponent->getParametersVectorPtr();
+        for (size_t i=0; i<pParameters->size(); ++i)
+        {
+            if (!pNewComponent->setParameterValue(pParameters->at(i)->getName(), pParameters->at(i)->getValue(), true))
+            {
+                pNewComponent->addWarningMessage("Failed to set parameter: "+pParameters->at(i)->getName()+"="+pParameters->at(i)->getValue());
+            }
+        }
+
+        // Modifiable signal quantities
+        vector<Port*> ports = pComponent->getPortPtrVector();
+        for (size_t p=0; p<ports.size(); ++p)
+        {
+            if (ports[p]->getSignalNodeQuantityModifyable())
+            {
+                Port *pNewPort = pNewComponent->getPort(ports[p]->getName());
+                if (pNewPort)
+                {
+                    pNewPort->setSignalNodeQuantityOrUnit(ports[p]->getSignalNodeQuantity());
+                }
+            }
+        }
+    }
+
+    // System ports
+    vector<Port*> systemPorts = getPortPtrVector();
+    for (size_t p=0; p<systemPorts.size(); ++p)
+    {
+        if (systemPorts[p]->getPortType() == SystemPortType)
+        {
+            pTarget->addSystemPort(systemPorts[p]->getName(), systemPorts[p]->getDescription());
+        }
+    }
+
+    // Connections, each connection between two ports in this system is made once. Multiports are connected first so that their sub ports
+    // are created in the same order as in this system, the sub port index may matter to the component
+    vector<Component*> portOwners(1, this);
+    portOwners.insert(portOwners.end(), subComponents.begin(), subComponents.end());
+    std::set< pair<Port*, Port*> > copiedConnections;
+    for (int multiPortPass=1; multiPortPass>=0; --multiPortPass)
+    {
+        for (size_t o=0; o<portOwners.size(); ++o)
+        {
+            vector<Port*> ports = portOwners[o]->getPortPtrVector();
+            for (size_t p=0; p<ports.size(); ++p)
+            {
+                if (ports[p]->isMultiPort() != (multiPortPass == 1))
+                {
+                    continue;
+                }
+                for (size_t sp=0; sp<ports[p]->getNumPorts(); ++sp)
+                {
+                    // Connected ports of system ports include ports on both sides of the system border, only connections inside this system are copied
+                    vector<Port*> connectedPorts = ports[p]->getConnectedPorts(ports[p]->isMultiPort() ? int(sp) : -1);
+                    for (size_t cp=0; cp<connectedPorts.size(); ++cp)
+                    {
+                        Component *pOtherComponent = connectedPorts[cp]->getComponent();
+                        if ((pOtherComponent != this) && (pOtherComponent->getSystemParent() != this))
+                        {
+                            continue;
+                        }
+
+                        Port *pPort1 = ports[p];
+                        Port *pPort2 = connectedPorts[cp]->getParentPort() ? connectedPorts[cp]->getParentPort() : connectedPorts[cp];
+                        pair<Port*, Port*> connection = (pPort1 < pPort2) ? make_pair(pPort1, pPort2) : make_pair(pPort2, pPort1);
+                        if (!copiedConnections.insert(connection).second)
+                        {
+                            continue;
+                        }
+
+                        Port *pNewPort1 = findClonedPort(pPort1, this, pTarget);
+                        Port *pNewPort2 = findClonedPort(pPort2, this, pTarget);
+                        if (!pNewPort1 || !pNewPort2 || !pTarget->connect(pNewPort1, pNewPort2))
+                        {
+                            addErrorMessage("Could not copy connection: "+pPort1->getComponentName()+"::"+pPort1->getName()+" <-> "+
+                                            pPort2->getComponentName()+"::"+pPort2->getName());
+                            return false;
+                        }
+                    }
+                }
+            }
+        }
+    }
+
+    // Set system parameters again after connecting, just like when loading, in case of C-type subsystems with start values
+    for (size_t i=0; i<pSystemParameters->size(); ++i)
+    {
+        const ParameterEvaluator *pParameter = pSystemParameters->at(i);
+        const HString &rQuantityOrUnit = pParameter->getQuantity().empty() ? pParameter->getUnit() : pParameter->getQuantity();
+        pTarget->setOrAddSystemParameter(pParameter->getName(), pParameter->getValue(), pParameter->getType(), pParameter->getDescription(), rQuantityOrUnit, true);
+    }
+
+    // Aliases
+    const vector<HString> aliases = mAliasHandler.getAliases();
+    for (size_t a=0; a<aliases.size(); ++a)
+    {
+        HString compName, portName;
+        int varId;
+        mAliasHandler.getVariableFromAlias(aliases[a], compName, portName, varId);
+        if (varId >= 0)
+        {
+            pTarget->getAliasHandler().setVariableAlias(aliases[a], compName, portName, varId);
+        }
+    }
+
+    // Logging settings of the ports, now that the nodes are final
+    for (size_t c=0; c<subComponents.size(); ++c)
+    {
+        if (subComponents[c]->isComponentSystem())
+        {
+            continue;
+        }
+        Component *pNewComponent = pTarget->getSubComponent(subComponents[c]->getName());
+        vector<Port*> ports = subComponents[c]->getPortPtrVector();
+        for (size_t p=0; p<ports.size(); ++p)
+        {
+            Port *pNewPort = pNewComponent->getPort(ports[p]->getName());
+            if (pNewPort && !ports[p]->isMultiPort())
+            {
+                pNewPort->setEnableLogging(ports[p]->isLoggingEnabled());
+                for (size_t v=0; v<ports[p]->getNumDataVariables(); ++v)
+                {
+                    pNewPort->setEnableVariableLogging(v, ports[p]->isVariableLoggingEnabled(v));
+                }
+            }
+        }
+    }
+
+    return true;
+}
+
+
 //! @brief Rename a sub component and automatically fix unique names
 void ComponentSystem::renameSubComponent(const HString &rOldName, const HString &rNewName)
 {
@@ -460,6 +958,9 @@ void ComponentSystem::removeSubComponent(Component* pComponent, bool doDelete)
     // Remove any component aliases
     mAliasHandler.componentRemoved(pComponent->getName());
 
+    // Handles to parameters in the component must not be used any more
+    invalidateParameterHandles();
+
     // Remove from storage
     removeSubComponentPtrFromStorage(pComponent);
 
@@ -510,6 +1011,7 @@ void ComponentSystem::unReserveUniqueName(const HString &rName)
 
 void ComponentSystem::addSubComponentPtrToStorage(Component* pComponent)
 {
+    invalidateWarmRestart();
     switch (pComponent->getTypeCQS())
     {
     case Component::CType :
@@ -534,6 +1036,7 @@ void ComponentSystem::addSubComponentPtrToStorage(Component* pComponent)
 
 void ComponentSystem::removeSubComponentPtrFromStorage(Component* pComponent)
 {
+    invalidateWarmRestart();
     SubComponentMapT::iterator it = mSubComponentMap.find(pComponent->getName());
     if (it != mSubComponentMap.end())
     {
@@ -594,6 +1097,9 @@ void ComponentSystem::removeSubComponentPtrFromStorage(Component* pComponent)
 //! @brief Clear all the contents of a system (deleting any remaining components and connections)
 void ComponentSystem::clear()
 {
+    // Move node data back from the arena before nodes start to disappear
+    unpackNodeDataArena();
+
     // Remove and delete every subcomponent, one by one
     while (!mSubComponentMap.empty())
     {
@@ -608,6 +1114,63 @@ void ComponentSystem::clear()
     }
 }
 
+//! @brief Find the components that each component must be simulated after in each step
+//! @details Components in subsystems are represented by the closest enclosing subsystem in rComponents. A component that depends on itself is part of an algebraic loop
+//! @param[in] rComponents The components
+//! @param[out] rDependencies For each component, the indices in rComponents of the components it depends on
+void ComponentSystem::getSignalComponentDependencies(const std::vector<Component*> &rComponents, std::vector< std::vector<size_t> > &rDependencies) const
+{
+    std::unordered_map<const Component*, size_t> indexMap;
+    indexMap.reserve(rComponents.size());
+    for(size_t c=0; c<rComponents.size(); ++c)
+    {
+        indexMap.insert(std::pair<const Component*, size_t>(rComponents[c], c));
+    }
+
+    rDependencies.assign(rComponents.size(), std::vector<size_t>());
+    for(size_t c=0; c<rComponents.size(); ++c)
+    {
+        Component *pComp = rComponents[c];
+        std::vector<Port*> portVector = pComp->getPortPtrVector();
+        for(size_t p=0; p<portVector.size(); ++p)
+        {
+            Port *pPort = portVector[p];
+            SortHintEnumT sortHint = pPort->getSortHint();
+            if ((pComp->getTypeName() == HOPSAN_BUILTIN_TYPENAME_SUBSYSTEM) ||
+                (pComp->getTypeName() == HOPSAN_BUILTIN_TYPENAME_CONDITIONALSUBSYSTEM))
+            {
+                sortHint = pPort->getInternalSortHint();
+            }
+            if((sortHint != Destination) || !pPort->isConnected())
+            {
+                continue;
+            }
+
+            for(size_t s=0; s<pPort->getNumPorts(); ++s)
+            {
+                Port *pSourcePort = pPort->getNodePtr(s)->getSortOrderSourcePort();
+                if(!pSourcePort || !pSourcePort->getComponent())
+                {
+                    continue;
+                }
+                // Use the closest enclosing system of the source component that is in the vector
+                Component *pRequiredComponent = pSourcePort->getComponent();
+                std::unordered_map<const Component*, size_t>::const_iterator it = indexMap.find(pRequiredComponent);
+                while((it == indexMap.end()) && pRequiredComponent->mpSystemParent && (pRequiredComponent->mpSystemParent != this))
+                {
+                    pRequiredComponent = pRequiredComponent->mpSystemParent;
+                    it = indexMap.find(pRequiredComponent);
+                }
+                if((it != indexMap.end()) && !vectorContains(rDependencies[c], it->second))
+                {
+                    rDependencies[c].push_back(it->second);
+                }
+            }
+        }
+    }
+}
+
+
 #define USENEWSORTCODE
 //! @brief Sorts a component vector
 //! Components are sorted so that they are always simulated after the components they receive signals from. Algebraic loops can be detected, in that case this function does nothing.
@@ -703,74 +1266,51 @@ bool ComponentSystem::sortComponentVector(std::vector<Component*> &rComponentVec
         return false;
     }
 #else
-    bool didSomething = true;
-    while(didSomething) {
-        didSomething = false;
-
-        // Loop through the unsorted component vector
-        for(size_t c=0; c<rComponentVector.size(); ++c) {
-            // A pointer to an unsorted component
-            Component* pUnsrtComp = rComponentVector[c];
-            //Ignore components that are already added to the new vector
-            if(!vectorContains<Component*>(newComponentVector, pUnsrtComp)) {
-                bool readyToAdd=true;
-                std::vector<Port*> portVector = pUnsrtComp->getPortPtrVector();
-                // Ask each read port for its node, then ask the node for its write port component
-                for(size_t p=0; p<portVector.size(); ++p) {
-                    // Take the port pointer (To make code easier to read)
-                    Port *pPort = portVector[p];
-                    std::vector<Component*> pRequiredComponents;
-
-                    SortHintEnumT sortHint = pPort->getSortHint();
-                    if ((pUnsrtComp->getTypeName() == HOPSAN_BUILTIN_TYPENAME_SUBSYSTEM) ||
-                        (pUnsrtComp->getTypeName() == HOPSAN_BUILTIN_TYPENAME_CONDITIONALSUBSYSTEM)) {
-                        sortHint = pPort->getInternalSortHint();
-                    }
+    // Kahn's algorithm, a component is added when all components it depends on have been added
+    // Components that are ready at the same time keep their original order
+    std::vector< std::vector<size_t> > dependencies;
+    getSignalComponentDependencies(rComponentVector, dependencies);
+    const size_t nComponents = rComponentVector.size();
+    std::vector<size_t> numRemainingDependencies(nComponents, 0);
+    std::vector< std::vector<size_t> > dependents(nComponents);
+    for(size_t c=0; c<nComponents; ++c)
+    {
+        numRemainingDependencies[c] = dependencies[c].size();
+        for(size_t d=0; d<dependencies[c].size(); ++d)
+        {
+            dependents[dependencies[c][d]].push_back(c);
+        }
+    }
 
-                    if ( (sortHint == Destination) && pPort->isConnected() ) {
-                        std::vector<Port *> sourcePorts;
-                        for(int s=0; s<pPort->getNumPorts(); ++s) {
-                            sourcePorts.push_back(pPort->getNodePtr(s)->getSortOrderSourcePort());
-                        }
-                        for(size_t p=0; p<sourcePorts.size(); ++p) {
-                            if (sourcePorts[p] && sourcePorts[p]->getComponent()) {
-                                pRequiredComponents.push_back(sourcePorts[p]->getComponent());
-                            }
-                        }
-                    }
-                    if(!pRequiredComponents.empty()) {
-                        for(size_t r=0; r<pRequiredComponents.size(); ++r) {
-                            Component *pRequiredComponent = pRequiredComponents[r];
-                            if(pRequiredComponent->mpSystemParent == this) {
-                                if(!vectorContains<Component*>(newComponentVector, pRequiredComponent) &&
-                                        vectorContains<Component*>(rComponentVector,pRequiredComponent)) {
-                                    readyToAdd = false;     //Depending on normal component which has not yet been added
-                                    break;
-                                }
-                            }
-                            else {
-                                if(!vectorContains<Component*>(newComponentVector, pRequiredComponent->mpSystemParent) &&
-                                        (pRequiredComponent->mpSystemParent->getTypeCQS() == pPort->getComponent()->getTypeCQS()) &&
-                                        vectorContains<Component*>(rComponentVector,pRequiredComponent->mpSystemParent)) {
-                                    readyToAdd = false;     //Depending on subsystem component which has not yet been added
-                                    break;
-                                }
-                            }
-                        }
-                    }
-                }
-                // Add the component if all required write port components was already added
-                if(readyToAdd) {
-                    newComponentVector.push_back(pUnsrtComp);
-                    didSomething = true;
-                }
+    std::vector<size_t> order;
+    order.reserve(nComponents);
+    for(size_t c=0; c<nComponents; ++c)
+    {
+        if(numRemainingDependencies[c] == 0)
+        {
+            order.push_back(c);
+        }
+    }
+    for(size_t i=0; i<order.size(); ++i)
+    {
+        const std::vector<size_t> &rDependents = dependents[order[i]];
+        for(size_t d=0; d<rDependents.size(); ++d)
+        {
+            if(--numRemainingDependencies[rDependents[d]] == 0)
+            {
+                order.push_back(rDependents[d]);
             }
         }
     }
 
-    if(newComponentVector.size() == rComponentVector.size())   //All components moved to new vector = success!
+    if(order.size() == nComponents)   //All components sorted = success!
     {
-        if(newComponentVector.size() > 0 && newComponentVector[0]->getTypeCQS() == SType)
+        newComponentVector.resize(nComponents);
+        for(size_t i=0; i<nComponents; ++i)
+        {
+            newComponentVector[i] = rComponentVector[order[i]];
+        }
+        if(nComponents > 0 && newComponentVector[0]->getTypeCQS() == SType)
         {
             HString names;
             for(size_t c=0; c<newComponentVector.size(); ++c)
@@ -781,13 +1321,39 @@ bool ComponentSystem::sortComponentVector(std::vector<Component*> &rComponentVec
         }
         rComponentVector.swap(newComponentVector);
     }
-    else    //Something went wrong, all components were not moved. This is likely due to an algebraic loop.
+    else    //Some components could not be sorted, there must be at least one algebraic loop
     {
-        addErrorMessage("Initialize: Algebraic loops was found, signal components could not be sorted.");
-        if(!newComponentVector.empty())
+        // Every component that could not be sorted depends on at least one other such component,
+        // follow those dependencies from any of them until a component is visited twice to find a loop
+        std::vector<size_t> visitOrder(nComponents, 0);
+        std::vector<size_t> path;
+        size_t c = 0;
+        while(numRemainingDependencies[c] == 0)
         {
-            addInfoMessage("Last component that was successfully sorted: " + newComponentVector.back()->getName());
+            ++c;
+        }
+        while(visitOrder[c] == 0)
+        {
+            path.push_back(c);
+            visitOrder[c] = path.size();
+            for(size_t d=0; d<dependencies[c].size(); ++d)
+            {
+                if(numRemainingDependencies[dependencies[c][d]] > 0)
+                {
+                    c = dependencies[c][d];
+                    break;
+                }
+            }
         }
+        // The loop starts at the component that was visited twice, print it in signal flow order
+        HString loop = rComponentVector[c]->getName();
+        for(size_t i=path.size(); i>visitOrder[c]-1; --i)
+        {
+            loop += " -> "+rComponentVector[path[i-1]]->getName();
+        }
+
+        addErrorMessage("Initialize: Algebraic loops was found, signal components could not be sorted.");
+        addInfoMessage("Initialize: "+to_hstring(nComponents-order.size())+" components could not be sorted. Algebraic loop: "+loop);
         addInfoMessage("Initialize: Hint: Use unit delay components to resolve loops.");
         return false;
     }
@@ -930,6 +1496,7 @@ void ComponentSystem::removeSubNode(Node* pNode)
     {
         if (*it == pNode)
         {
+            pNode->restoreDataValuesStorage();
             pNode->mpOwnerSystem = 0;
             mSubNodePtrs.erase(it);
             break;
@@ -938,6 +1505,251 @@ void ComponentSystem::removeSubNode(Node* pNode)
 }
 
 
+//! @brief Packs the data values of all sub nodes into one contiguous, cache line aligned, node data arena
+//! @details Nodes are placed in the order they are first reached from the (sorted) signal, C and Q components, the remaining nodes are appended at the end.
+//! A node that fits in one cache line is never split over two lines. The arena is kept until unpackNodeDataArena() is called.
+void ComponentSystem::packNodeDataArena()
+{
+    unpackNodeDataArena();
+
+    // Determine the node order from the component execution order
+    vector<Node*> nodeOrder;
+    nodeOrder.reserve(mSubNodePtrs.size());
+    std::set<Node*> placedNodes;
+    const vector<Component*> *componentVectors[3] = {&mComponentSignalptrs, &mComponentCptrs, &mComponentQptrs};
+    for (size_t v=0; v<3; ++v)
+    {
+        for (size_t c=0; c<componentVectors[v]->size(); ++c)
+        {
+            vector<Port*> ports = componentVectors[v]->at(c)->getPortPtrVector();
+            for (size_t p=0; p<ports.size(); ++p)
+            {
+                // Normal ports have one "sub port", multiports have one per connection
+                for (size_t sp=0; sp<ports[p]->getNumPorts(); ++sp)
+                {
+                    Node *pNode = ports[p]->getNodePtr(sp);
+                    if (pNode && (pNode->getOwnerSystem() == this) && placedNodes.insert(pNode).second)
+                    {
+                        nodeOrder.push_back(pNode);
+                    }
+                }
+            }
+        }
+    }
+    for (size_t n=0; n<mSubNodePtrs.size(); ++n)
+    {
+        if (placedNodes.insert(mSubNodePtrs[n]).second)
+        {
+            nodeOrder.push_back(mSubNodePtrs[n]);
+        }
+    }
+
+    // Determine node offsets in the arena
+    const size_t valuesPerLine = gNodeDataArenaAlignment/sizeof(double);
+    vector<size_t> offsets(nodeOrder.size());
+    size_t arenaSize=0;
+    for (size_t n=0; n<nodeOrder.size(); ++n)
+    {
+        const size_t nValues = nodeOrder[n]->getNumDataVariables();
+        if ((nValues <= valuesPerLine) && ((arenaSize % valuesPerLine) + nValues > valuesPerLine))
+        {
+            arenaSize += valuesPerLine - (arenaSize % valuesPerLine);
+        }
+        offsets[n] = arenaSize;
+        arenaSize += nValues;
+    }
+
+    // Allocate the arena, with some extra space so that the first node can be aligned to a cache line
+    try
+    {
+        mNodeDataArena.assign(arenaSize+valuesPerLine, 0.0);
+    }
+    catch (exception &e)
+    {
+        addWarningMessage("Failed to allocate node data arena, node data will not be packed");
+        vector<double>().swap(mNodeDataArena);
+        return;
+    }
+    double *pArenaBegin = mNodeDataArena.data();
+    const size_t misalignment = reinterpret_cast<size_t>(pArenaBegin) % gNodeDataArenaAlignment;
+    if (misalignment != 0)
+    {
+        pArenaBegin += (gNodeDataArenaAlignment-misalignment)/sizeof(double);
+    }
+
+    // Move node data into the arena
+    for (size_t n=0; n<nodeOrder.size(); ++n)
+    {
+        nodeOrder[n]->moveDataValuesTo(pArenaBegin+offsets[n]);
+    }
+}
+
+
+//! @brief Moves node data values back from the node data arena into each node and releases the arena
+void ComponentSystem::unpackNodeDataArena()
+{
+    if (!mNodeDataArena.empty())
+    {
+        for (size_t n=0; n<mSubNodePtrs.size(); ++n)
+        {
+            mSubNodePtrs[n]->restoreDataValuesStorage();
+        }
+        vector<double>().swap(mNodeDataArena);
+    }
+}
+
+
+//! @brief Reallocate the log data of all sub nodes and the log time storage, so that the memory is first touched by the calling thread
+void ComponentSystem::reallocateLogStorage()
+{
+    for (size_t n=0; n<mSubNodePtrs.size(); ++n)
+    {
+        mSubNodePtrs[n]->reallocateLogData();
+    }
+    vector<double>(mTimeStorage).swap(mTimeStorage);
+}
+
+
+//! @brief Reallocate the node data and log data of this system and all subsystems, so that the memory is first touched by the calling thread
+//! @note Pointers to node data are invalidated, so the system must be initialized again before it is simulated
+void ComponentSystem::reallocateStorageRecursively()
+{
+    for (size_t n=0; n<mSubNodePtrs.size(); ++n)
+    {
+        mSubNodePtrs[n]->reallocateDataValues();
+    }
+    reallocateLogStorage();
+
+    SubComponentMapT::iterator scmit;
+    for (scmit=mSubComponentMap.begin(); scmit!=mSubComponentMap.end(); ++scmit)
+    {
+        if (scmit->second->isComponentSystem())
+        {
+            static_cast<ComponentSystem*>(scmit->second)->reallocateStorageRecursively();
+        }
+    }
+}
+
+
+//! @brief Check if a sub component is a subsystem that can be simulated as part of this system's schedule
+//! @details Only ordinary enabled subsystems that are simulated in the signal, C or Q phase with the same timestep as the top-level system,
+//! and where the flattened schedule gives exactly the same results as the hierarchical one, can be flattened. That is S-type subsystems
+//! that only contain signal components, and C- or Q-type subsystems without signal components. The contents of a C- or Q-type subsystem
+//! must also be of the same type as the subsystem, unless no signals pass the subsystem border.
+//! Other subsystems are simulated as one component, which keeps their contents in the phase of the subsystem.
+//! @param[in] pComponent The sub component to check
+bool ComponentSystem::isFlattenableSubsystem(const Component *pComponent) const
+{
+    if ((pComponent->getTypeName() != HOPSAN_BUILTIN_TYPENAME_SUBSYSTEM) || pComponent->isDisabled() ||
+        (pComponent->getTypeCQS() == UndefinedCQSType) || (pComponent->getTimestep() != mTimestep))
+    {
+        return false;
+    }
+
+    const ComponentSystem *pSubsystem = static_cast<const ComponentSystem*>(pComponent);
+    if (pSubsystem->getTypeCQS() == SType)
+    {
+        return pSubsystem->mComponentCptrs.empty() && pSubsystem->mComponentQptrs.empty();
+    }
+
+    if (!pSubsystem->mComponentSignalptrs.empty())
+    {
+        return false;
+    }
+
+    // Components of the other type are simulated in the other phase when flattened, that is only the same if they do not exchange signals with the outside
+    const bool isCType = (pSubsystem->getTypeCQS() == CType);
+    if ((isCType && pSubsystem->mComponentQptrs.empty()) || (!isCType && pSubsystem->mComponentCptrs.empty()))
+    {
+        return true;
+    }
+    const vector<Port*> ports = pSubsystem->getPortPtrVector();
+    for (size_t p=0; p<ports.size(); ++p)
+    {
+        const Node *pNode = ports[p]->getNodePtr();
+        if (pNode && (pNode->getNodeType() == "NodeSignal"))
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+
+//! @brief Collect the components to simulate from a system, with the contents of flattenable subsystems in place of the subsystems
+//! @details The contents of a flattened subsystem take its place in the schedule, so the order of the hierarchical schedule is kept.
+//! Components of the other type in a flattened C- or Q-type subsystem are appended to the schedule of their own phase.
+//! @param[in] pSystem The system to collect components from
+//! @param[out] rSignalComponents Signal components are appended here
+//! @param[out] rCComponents C components are appended here
+//! @param[out] rQComponents Q components are appended here
+void ComponentSystem::collectFlattenedComponents(ComponentSystem *pSystem, std::vector<Component*> &rSignalComponents, std::vector<Component*> &rCComponents,
+                                                 std::vector<Component*> &rQComponents)
+{
+    std::vector<Component*> *componentVectors[3] = {&pSystem->mComponentSignalptrs, &pSystem->mComponentCptrs, &pSystem->mComponentQptrs};
+    std::vector<Component*> *targetVectors[3] = {&rSignalComponents, &rCComponents, &rQComponents};
+    for (size_t v=0; v<3; ++v)
+    {
+        for (size_t i=0; i<componentVectors[v]->size(); ++i)
+        {
+            Component *pComponent = componentVectors[v]->at(i);
+            if (isFlattenableSubsystem(pComponent))
+            {
+                ComponentSystem *pSubsystem = static_cast<ComponentSystem*>(pComponent);
+                mFlattenedSubsystems.push_back(pSubsystem);
+                collectFlattenedComponents(pSubsystem, rSignalComponents, rCComponents, rQComponents);
+            }
+            else
+            {
+                targetVectors[v]->push_back(pComponent);
+            }
+        }
+    }
+}
+
+
+//! @brief Replace subsystems with the components they contain in the simulation schedule of this system
+//! @details All subsystems (recursively) that use the same timestep as this system and where the flattened schedule is exactly
+//! equivalent to the hierarchical one are flattened, see isFlattenableSubsystem(). The subsystems are kept in the model,
+//! but they are no longer simulated by themselves, instead their time is updated and their nodes are logged by this system.
+//! Subsystems using a different timestep, conditional subsystems and subsystems with mixed contents are still simulated as one component.
+void ComponentSystem::flattenHierarchy()
+{
+    std::vector<Component*> signalComponents, cComponents, qComponents;
+    mFlattenedSubsystems.clear();
+    collectFlattenedComponents(this, signalComponents, cComponents, qComponents);
+    if (mFlattenedSubsystems.empty())
+    {
+        return;
+    }
+
+    mUnflattenedSignalptrs.swap(mComponentSignalptrs);
+    mUnflattenedCptrs.swap(mComponentCptrs);
+    mUnflattenedQptrs.swap(mComponentQptrs);
+    mComponentSignalptrs.swap(signalComponents);
+    mComponentCptrs.swap(cComponents);
+    mComponentQptrs.swap(qComponents);
+    addDebugMessage("Flattened "+to_hstring(mFlattenedSubsystems.size())+" subsystems into "+
+                    to_hstring(mComponentSignalptrs.size()+mComponentCptrs.size()+mComponentQptrs.size())+" scheduled components");
+}
+
+
+//! @brief Restore the hierarchical simulation schedule after flattenHierarchy()
+void ComponentSystem::unflattenHierarchy()
+{
+    if (!mFlattenedSubsystems.empty())
+    {
+        mComponentSignalptrs.swap(mUnflattenedSignalptrs);
+        mComponentCptrs.swap(mUnflattenedCptrs);
+        mComponentQptrs.swap(mUnflattenedQptrs);
+        mUnflattenedSignalptrs.clear();
+        mUnflattenedCptrs.clear();
+        mUnflattenedQptrs.clear();
+        mFlattenedSubsystems.clear();
+    }
+}
+
+
 //! @brief preAllocates log space (to speed up later access for log writing)
 void ComponentSystem::preAllocateLogSpace()
 {
@@ -946,7 +1758,14 @@ void ComponentSystem::preAllocateLogSpace()
     //    this->setLogSettingsNSamples(nSamples, startT, stopT, mTimestep);
     //! @todo Fix /Peter
     mLogCtr = 0;
-    if (mEnableLogData)
+    mnStreamedLogSamples = 0;
+    if (mEnableLogData && mpLogSink)
+    {
+        // When streaming, log data is passed on to the log sink instead of being stored
+        mTimeStorage.clear();
+        success = startLogStream();
+    }
+    else if (mEnableLogData)
     {
         try
         {
@@ -969,7 +1788,7 @@ void ComponentSystem::preAllocateLogSpace()
                 {
                     // If the node is in a read port and if that port is not connected (node only have one connected port)
                     // Then we should disable logging for that node as logging the start value does not make sense
-                    if ( ((*it)->getNumConnectedPorts() < 2) && ((*it)->getNumberOfPortsByType(ReadPortType) == 1) )
+                    if (isUnconnectedReadPortNode(*it))
                     {
                         (*it)->setDoLogIfEnabled(false);
                     }
@@ -989,27 +1808,169 @@ void ComponentSystem::preAllocateLogSpace()
                 }
             }
         }
-        catch (exception &e)
+        catch (exception &e)
+        {
+            addErrorMessage("Failed to allocate log data memory, try reducing the amount of log data", "FailedMemoryAllocation");
+            disableLog();
+            success = false;
+        }
+    }
+
+    // If we failed to allocate log memory then stop simulation
+    if (!success)
+    {
+        stopSimulation("Failed to allocate log memory");
+    }
+}
+
+
+//! @brief Open the log sink and start streaming the log data of this system and its subsystems
+//! @returns False if the log sink could not be opened
+bool ComponentSystem::startLogStream()
+{
+    finishLogStream();
+
+    std::vector<LogStreamVariable> variables(1);
+    variables[0].name = "Time";
+    variables[0].unit = "s";
+    variables[0].quantity = "Time";
+    collectLogStreamVariables(this, variables);
+
+    mpLogStreamer = new LogStreamer(mpLogSink, mLogSinkRingBufferSize);
+    if (!mpLogStreamer->start(variables))
+    {
+        addErrorMessage("Failed to open log stream: "+mpLogStreamer->getLastError());
+        finishLogStream();
+        return false;
+    }
+    return true;
+}
+
+//! @brief Write any remaining log samples to the log sink and close it
+void ComponentSystem::finishLogStream()
+{
+    if (mpLogStreamer)
+    {
+        if (!mpLogStreamer->finish())
+        {
+            addErrorMessage("Failed to write log stream: "+mpLogStreamer->getLastError());
+        }
+        delete mpLogStreamer;
+        mpLogStreamer = 0;
+    }
+    mLogStreamNodeData.clear();
+}
+
+//! @brief Find the node data variables to stream in a system and its subsystems
+//! @details Variables are named by the first connected port that wants to log them, any previously stored log data in the nodes is freed
+//! @param [in] pSystem The system to search in
+//! @param [in,out] rVariables The variables to stream, new variables are appended
+void ComponentSystem::collectLogStreamVariables(ComponentSystem *pSystem, std::vector<LogStreamVariable> &rVariables)
+{
+    std::vector<size_t> dataIds;
+    for (size_t n=0; n<pSystem->mSubNodePtrs.size(); ++n)
+    {
+        Node *pNode = pSystem->mSubNodePtrs[n];
+        pNode->setDoLogIfEnabled(false);
+        if (isUnconnectedReadPortNode(pNode))
+        {
+            continue;
+        }
+
+        pNode->getDataIdsToLog(dataIds);
+        for (size_t i=0; i<dataIds.size(); ++i)
+        {
+            const size_t dataId = dataIds[i];
+            Port *pPort = 0;
+            for (size_t p=0; p<pNode->mConnectedPorts.size(); ++p)
+            {
+                if (pNode->mConnectedPorts[p]->isVariableLoggingEnabled(dataId))
+                {
+                    pPort = pNode->mConnectedPorts[p];
+                    break;
+                }
+            }
+            if (pPort->getParentPort())
+            {
+                pPort = pPort->getParentPort();
+            }
+
+            // Use the same full name format as when exporting results, the name of this system is not included
+            HString prefix;
+            ComponentSystem *pParentSystem = (pPort->getComponent() == this) ? 0 : pPort->getComponent()->getSystemParent();
+            while (pParentSystem && (pParentSystem != this))
+            {
+                prefix = pParentSystem->getName()+"$"+prefix;
+                pParentSystem = pParentSystem->getSystemParent();
+            }
+
+            const NodeDataDescription *pDescription = pNode->getDataDescription(dataId);
+            LogStreamVariable variable;
+            variable.name = prefix+pPort->getComponentName()+"#"+pPort->getName()+"#"+pDescription->name;
+            variable.unit = pDescription->unit;
+            variable.quantity = pDescription->quantity;
+            rVariables.push_back(variable);
+            mLogStreamNodeData.push_back(std::pair<Node*, size_t>(pNode, dataId));
+        }
+    }
+
+    // Recurse into subsystems
+    for (SubComponentMapT::iterator it=pSystem->mSubComponentMap.begin(); it!=pSystem->mSubComponentMap.end(); ++it)
+    {
+        if (it->second->isComponentSystem())
         {
-            addErrorMessage("Failed to allocate log data memory, try reducing the amount of log data", "FailedMemoryAllocation");
-            disableLog();
-            success = false;
+            collectLogStreamVariables(static_cast<ComponentSystem*>(it->second), rVariables);
         }
     }
+}
 
-    // If we failed to allocate log memory then stop simulation
-    if (!success)
+//! @brief Pass the current time and the values of all streamed variables on to the log streamer
+void ComponentSystem::streamLogSample()
+{
+    double *pSample = mpLogStreamer->beginSample();
+    pSample[0] = mTime;
+    for (size_t i=0; i<mLogStreamNodeData.size(); ++i)
     {
-        stopSimulation("Failed to allocate log memory");
+        pSample[i+1] = mLogStreamNodeData[i].first->mpDataValues[mLogStreamNodeData[i].second];
+    }
+    mpLogStreamer->endSample();
+    ++mnStreamedLogSamples;
+
+    // Calculate the next simulation step to log, the same way as in setupLogSlotsAndTs()
+    mLogStreamLogT += mLogTimeDt;
+    const size_t n = size_t((mLogStreamLogT-mLogStreamSimT)/mTimestep+0.5);
+    mLogStreamSimT += double(n)*mTimestep;
+    mNextLogStreamStep += n;
+
+    if (mpLogStreamer->hasFailed())
+    {
+        stopSimulation("Failed to write log stream");
     }
 }
 
 
 void ComponentSystem::logTimeAndNodes(const size_t simStep)
 {
+    // Flattened subsystems are not simulated by themselves, so their time is updated and their nodes are logged from here
+    for (size_t i=0; i<mFlattenedSubsystems.size(); ++i)
+    {
+        ComponentSystem *pSubsystem = mFlattenedSubsystems[i];
+        pSubsystem->mTime = mTime;
+        pSubsystem->mTotalTakenSimulationSteps = simStep;
+        pSubsystem->logTimeAndNodes(simStep);
+    }
+
     if (mEnableLogData)
     {
-        if (mLogTheseTimeSteps[mLogCtr] ==  simStep)
+        if (mpLogStreamer)
+        {
+            if ((simStep == mNextLogStreamStep) && (mnStreamedLogSamples < mnLogSlots))
+            {
+                streamLogSample();
+            }
+        }
+        // Real-time simulations can run past the stop time that the log steps were computed for
+        else if ((mLogCtr < mLogTheseTimeSteps.size()) && (mLogTheseTimeSteps[mLogCtr] == simStep))
         {
             mTimeStorage[mLogCtr] = mTime;   //We log the "real"  simulation time for the sample
 
@@ -1335,6 +2296,9 @@ bool ComponentSystem::connect(Port *pPort1, Port *pPort2)
         return false;
     }
 
+    // Connections change the component sort order, so a warm restart is no longer possible
+    invalidateWarmRestart();
+
     // Prevent connection with self
     if (pPort1 == pPort2)
     {
@@ -1493,6 +2457,7 @@ bool ComponentSystem::disconnect(Port *pPort1, Port *pPort2)
     // First check if ports not null
     if (pPort1 && pPort2)
     {
+        invalidateWarmRestart();
         HString msgName1 = pPort1->getComponent()->getName()+"::"+pPort1->getName();
         HString msgName2 = pPort2->getComponent()->getName()+"::"+pPort2->getName();
 
@@ -1700,6 +2665,13 @@ size_t limitNumLogSlotsToLogOrSimTimeInterval(const double simStartT, const doub
 
 void ComponentSystem::setupLogSlotsAndTs(const double simStartT, const double simStopT, const double simTs)
 {
+    if (mIsLogStreamedByParent)
+    {
+        // The log data of this system is streamed by a parent system, nothing should be logged here
+        disableLog();
+        return;
+    }
+
     mnLogSlots = limitNumLogSlotsToLogOrSimTimeInterval(simStartT, simStopT, simTs, mRequestedLogStartTime, mRequestedNumLogSamples);
     if (mnLogSlots != mRequestedNumLogSamples)
     {
@@ -1720,11 +2692,21 @@ void ComponentSystem::setupLogSlotsAndTs(const double simStartT, const double si
         double logT=logStartT;
         double simT=simStartT;
 
-        mLogTheseTimeSteps.clear();
-        mLogTheseTimeSteps.reserve(mnLogSlots);
-
         // Figure out the first simulation step to log (the one where simT >= logT)
         size_t n = size_t((logT-simT)/simTs+0.5);
+
+        // When streaming, the steps to log are calculated while simulating instead, to avoid storing one entry per log sample
+        if (mpLogSink)
+        {
+            vector<size_t>().swap(mLogTheseTimeSteps);
+            mLogStreamLogT = logT;
+            mLogStreamSimT = simT + double(n)*simTs;
+            mNextLogStreamStep = n;
+            return;
+        }
+
+        mLogTheseTimeSteps.clear();
+        mLogTheseTimeSteps.reserve(mnLogSlots);
         mLogTheseTimeSteps.push_back(n);
         // Fast forward simT
         simT += double(n)*simTs;
@@ -1779,6 +2761,176 @@ void ComponentSystem::setKeepValuesAsStartValues(bool tf)
 }
 
 
+//! @brief Set if the data values of all sub nodes should be packed into one contiguous node data arena during simulation
+//! @details The arena is cache line aligned and nodes are placed in component execution order, this improves cache locality in large models.
+//! The arena is created in initialize() and released in finalize(). The setting is also applied to subsystems.
+//! @note While packed, Port::getNodeDataVector() will not be up to date, use readNode(), writeNode() or node data pointers instead
+//! @param[in] useArena true or false, whether to use the node data arena
+void ComponentSystem::setUseNodeDataArena(const bool useArena)
+{
+    mUseNodeDataArena = useArena;
+}
+
+
+//! @brief Returns whether or not sub node data values are packed into a node data arena during simulation
+bool ComponentSystem::usesNodeDataArena() const
+{
+    return mUseNodeDataArena;
+}
+
+
+//! @brief Set if subsystems should be flattened into the simulation schedule of this top-level system
+//! @details Subsystems using the same timestep as the top-level system are not simulated by themselves, instead the components they contain
+//! are simulated directly by the top-level system. This removes the overhead of each subsystem in every timestep, and lets the multi-threaded
+//! scheduler distribute all components. The hierarchy is kept for names and logging. The schedule is flattened in initialize() and restored in finalize().
+//! Only subsystems where this gives exactly the same results are flattened, others are still simulated as one component
+//! @param[in] useFlattening true or false, whether to flatten the hierarchy
+void ComponentSystem::setUseHierarchyFlattening(const bool useFlattening)
+{
+    mUseHierarchyFlattening = useFlattening;
+}
+
+
+//! @brief Returns whether or not subsystems are flattened into the simulation schedule of this top-level system
+bool ComponentSystem::usesHierarchyFlattening() const
+{
+    return mUseHierarchyFlattening;
+}
+
+
+//! @brief Set an ahead-of-time compiled simulation schedule for this top-level system
+//! @details The system takes ownership of the compiled model, any previously set model is deleted. The compiled model is bound to
+//! the flattened schedule in initialize() and then replaces the interpreted component loops in simulate(). If it does not match the
+//! schedule, a warning is given and the system is simulated as usual. Multi-threaded simulations do not use the compiled model.
+//! @param[in] pCompiledModel The compiled model, or 0 to remove it
+void ComponentSystem::setCompiledModel(CompiledModel *pCompiledModel)
+{
+    if (pCompiledModel != mpCompiledModel)
+    {
+        delete mpCompiledModel;
+        mpCompiledModel = pCompiledModel;
+    }
+    mIsCompiledModelBound = false;
+}
+
+
+//! @brief Returns the compiled model set for this system, or 0 if none is set
+CompiledModel *ComponentSystem::getCompiledModel() const
+{
+    return mpCompiledModel;
+}
+
+
+//! @brief Returns whether the compiled model is bound and used by the current simulation
+bool ComponentSystem::usesCompiledModel() const
+{
+    return mIsCompiledModelBound;
+}
+
+
+//! @brief Get the components in the order they are simulated in each timestep
+//! @details Only valid between initialize() and finalize(). Used when generating compiled models from the (flattened) schedule
+//! @param[out] rSignalComponents The signal components in simulation order
+//! @param[out] rCComponents The C-type components in simulation order
+//! @param[out] rQComponents The Q-type components in simulation order
+void ComponentSystem::getSimulationSchedule(std::vector<Component*> &rSignalComponents, std::vector<Component*> &rCComponents, std::vector<Component*> &rQComponents) const
+{
+    rSignalComponents = mComponentSignalptrs;
+    rCComponents = mComponentCptrs;
+    rQComponents = mComponentQptrs;
+}
+
+
+//! @brief Record the time spent on each component, phase and barrier wait in the following simulations of this top-level system
+//! @details Profiled simulations are somewhat slower, since the time is measured around each component. A compiled model is not used
+//! while profiling, and load rebalancing is disabled in multi-threaded simulations, so that the profile shows the scheduled components.
+//! Only the offline and graph partitioning multi-threaded algorithms are profiled.
+//! @param[in] pProfiler The profiler, set 0 to stop profiling. The profiler is not owned by the system.
+void ComponentSystem::setProfiler(SimulationProfiler *pProfiler)
+{
+    mpProfiler = pProfiler;
+}
+
+
+//! @brief Returns the profiler, or 0 if simulations are not profiled
+SimulationProfiler *ComponentSystem::getProfiler() const
+{
+    return mpProfiler;
+}
+
+
+//! @brief Set if components should be moved between threads during multi-threaded simulation when the load becomes unbalanced
+//! @details This applies to the offline scheduling and graph partitioning algorithms. The load of each thread is measured now and then
+//! during the simulation, and C- and Q-components are moved from the busiest thread if it is much busier than the others.
+//! This helps when the cost of components changes during the simulation. Rebalancing is enabled by default.
+//! @param[in] useRebalancing true or false, whether to rebalance the load
+void ComponentSystem::setUseLoadRebalancing(const bool useRebalancing)
+{
+    mUseLoadRebalancing = useRebalancing;
+}
+
+
+//! @brief Returns whether or not components are moved between threads during multi-threaded simulation when the load becomes unbalanced
+bool ComponentSystem::usesLoadRebalancing() const
+{
+    return mUseLoadRebalancing;
+}
+
+
+//! @brief Set if dependent signal components may be simulated in parallel during multi-threaded simulation
+//! @details This applies to the offline scheduling and graph partitioning algorithms. The signal components are sorted into dependency levels,
+//! and components in the same level may be simulated by different threads, which then wait for each other only where needed. This is only
+//! used when it is estimated to be faster than keeping each group of connected signal components in one thread. It is enabled by default.
+//! @param[in] useLevelScheduling true or false, whether to allow level scheduling of signal components
+void ComponentSystem::setUseSignalLevelScheduling(const bool useLevelScheduling)
+{
+    if(useLevelScheduling != mUseSignalLevelScheduling)
+    {
+        mUseSignalLevelScheduling = useLevelScheduling;
+        mpMultiThreadPrivates->mHaveSchedule = false;
+    }
+}
+
+
+//! @brief Returns whether or not dependent signal components may be simulated in parallel during multi-threaded simulation
+bool ComponentSystem::usesSignalLevelScheduling() const
+{
+    return mUseSignalLevelScheduling;
+}
+
+
+//! @brief Set which processors the threads are pinned to in multi-threaded simulation (only supported on Linux)
+//! @details Unless the placement is automatic or none, the calling thread is pinned to the first processor during the simulation. With the
+//! offline scheduling and graph partitioning algorithms, each thread also reallocates the node data and log data of its components when the
+//! schedule is created, so that the memory is placed on the NUMA node of the thread that uses it.
+//! @param[in] placement How to place the threads
+//! @param[in] rCpus The processors to use, in thread order, with ExplicitThreadPlacement. If no number of threads is given to
+//! simulateMultiThreaded(), one thread per processor in the list is used.
+void ComponentSystem::setThreadPlacement(const ThreadPlacementT placement, const std::vector<int> &rCpus)
+{
+    if((placement != mThreadPlacement) || (rCpus != mThreadPlacementCpus))
+    {
+        mThreadPlacement = placement;
+        mThreadPlacementCpus = rCpus;
+        mpMultiThreadPrivates->mHaveSchedule = false;
+    }
+}
+
+
+//! @brief Returns how the threads are placed in multi-threaded simulation
+ThreadPlacementT ComponentSystem::getThreadPlacement() const
+{
+    return mThreadPlacement;
+}
+
+
+//! @brief Returns the processors used with ExplicitThreadPlacement
+const std::vector<int> &ComponentSystem::getThreadPlacementCpus() const
+{
+    return mThreadPlacementCpus;
+}
+
+
 //! @brief Checks that everything is OK before simulation
 //! @returns true if everything is OK, else false (simulation not permitted)
 bool ComponentSystem::checkModelBeforeSimulation()
@@ -2187,6 +3339,10 @@ bool ComponentSystem::initialize(const double startT, const double stopT)
     //cout << "Initializing SubSystem: " << this->mName << endl;
     addCoreLogMessage("ComponentSystem::initialize() in "+getName());
 
+    // The system may be initialized again without being finalized, subsystems must then be initialized by themselves
+    mIsCompiledModelBound = false;
+    unflattenHierarchy();
+
     //Move all disabled components to temporary vectors
     for(size_t i=0; i<mComponentCptrs.size();)
     {
@@ -2230,6 +3386,9 @@ bool ComponentSystem::initialize(const double startT, const double stopT)
         preInitialize();
     }
 
+    // Only allow a warm restart if this initialization succeeds
+    mCanWarmRestart = false;
+
     mStopSimulation = false; //This variable cannot be written on below, then problem might occur with thread safety, it's a bit ugly to write on it on this row.
 
     // Set initial time
@@ -2263,14 +3422,29 @@ bool ComponentSystem::initialize(const double startT, const double stopT)
     adjustTimestep(mComponentCptrs);
     adjustTimestep(mComponentQptrs);
 
-    // Sort signal components, if they can not be sorted (algebraic loop), return with failure
-    if(!sortComponentVector(mComponentSignalptrs))
+    // On warm restart, components and connections are unchanged so the previous sort order is still valid
+    if (!mIsWarmRestarting)
     {
-        return false;
+        // Sort signal components, if they can not be sorted (algebraic loop), return with failure
+        if(!sortComponentVector(mComponentSignalptrs))
+        {
+            return false;
+        }
+        // Sort C and Q components
+        sortComponentVector(mComponentCptrs);
+        sortComponentVector(mComponentQptrs);
+    }
+
+    // Pack node data in execution order, connections are final and components are sorted at this point
+    // This must be done before any component asks for node data pointers in initialize
+    if (mUseNodeDataArena)
+    {
+        packNodeDataArena();
+    }
+    else
+    {
+        unpackNodeDataArena();
     }
-    // Sort C and Q components
-    sortComponentVector(mComponentCptrs);
-    sortComponentVector(mComponentQptrs);
 
     // run top-level system initialization functions
     if (this->isTopLevelSystem())
@@ -2283,7 +3457,19 @@ bool ComponentSystem::initialize(const double startT, const double stopT)
 
         // If the numhop scripts have changed the values, we need to make sure that the parameters are reevaluated
         // This is also necessary because preInitialize may have done some changes
-        evaluateParametersRecursively();
+        // On warm restart, only changed parameters and parameters depending on them are evaluated
+        if (mIsWarmRestarting)
+        {
+            if (!evaluateChangedParametersRecursively(std::vector<HString>()))
+            {
+                return false;
+            }
+        }
+        else
+        {
+            evaluateParametersRecursively();
+        }
+        clearChangedParametersRecursively();
 
         // Now we set the actual node data variables to the values from the start nodes (copy node values)
         // thereby initializing the system hierarchy with the start values
@@ -2313,6 +3499,9 @@ bool ComponentSystem::initialize(const double startT, const double stopT)
             //! @todo should we use our own nSamples or the subsystems own ?
             static_cast<ComponentSystem*>(mComponentSignalptrs[s])->setNumLogSamples(mRequestedNumLogSamples);
             static_cast<ComponentSystem*>(mComponentSignalptrs[s])->setLogStartTime(mRequestedLogStartTime);
+            static_cast<ComponentSystem*>(mComponentSignalptrs[s])->setUseNodeDataArena(mUseNodeDataArena);
+            static_cast<ComponentSystem*>(mComponentSignalptrs[s])->mIsLogStreamedByParent = (mpLogStreamer != 0) || mIsLogStreamedByParent;
+            static_cast<ComponentSystem*>(mComponentSignalptrs[s])->mIsWarmRestarting = mIsWarmRestarting;
         }
 
         addCoreLogMessage("ComponentSystem::initialize() Initializing component: "+mComponentSignalptrs[s]->getName());
@@ -2338,6 +3527,9 @@ bool ComponentSystem::initialize(const double startT, const double stopT)
             //! @todo should we use our own nSamples ore the subsystems own ?
             static_cast<ComponentSystem*>(mComponentCptrs[c])->setNumLogSamples(mRequestedNumLogSamples);
             static_cast<ComponentSystem*>(mComponentCptrs[c])->setLogStartTime(mRequestedLogStartTime);
+            static_cast<ComponentSystem*>(mComponentCptrs[c])->setUseNodeDataArena(mUseNodeDataArena);
+            static_cast<ComponentSystem*>(mComponentCptrs[c])->mIsLogStreamedByParent = (mpLogStreamer != 0) || mIsLogStreamedByParent;
+            static_cast<ComponentSystem*>(mComponentCptrs[c])->mIsWarmRestarting = mIsWarmRestarting;
         }
 
         addCoreLogMessage("ComponentSystem::initialize() Initializing component: "+mComponentCptrs[c]->getName());
@@ -2363,6 +3555,9 @@ bool ComponentSystem::initialize(const double startT, const double stopT)
             //! @todo should we use our own nSamples ore the subsystems own ?
             static_cast<ComponentSystem*>(mComponentQptrs[q])->setNumLogSamples(mRequestedNumLogSamples);
             static_cast<ComponentSystem*>(mComponentQptrs[q])->setLogStartTime(mRequestedLogStartTime);
+            static_cast<ComponentSystem*>(mComponentQptrs[q])->setUseNodeDataArena(mUseNodeDataArena);
+            static_cast<ComponentSystem*>(mComponentQptrs[q])->mIsLogStreamedByParent = (mpLogStreamer != 0) || mIsLogStreamedByParent;
+            static_cast<ComponentSystem*>(mComponentQptrs[q])->mIsWarmRestarting = mIsWarmRestarting;
         }
 
         addCoreLogMessage("ComponentSystem::initialize() Initializing component: "+mComponentQptrs[q]->getName());
@@ -2378,25 +3573,282 @@ bool ComponentSystem::initialize(const double startT, const double stopT)
         return false;
     }
 
-    // Log the start values
-    logTimeAndNodes(mTotalTakenSimulationSteps);
+    // Restore a loaded simulation point now that all components have been initialized, since initialization resets their internal state
+    // It is kept until finalize, since the system may be initialized again before the simulation starts (after measuring simulation time)
+    if (!mSimulationPointToRestore.empty())
+    {
+        const bool restored = restoreSimulationPointData(mSimulationPointToRestore, this);
+        if (!restored)
+        {
+            addErrorMessage("Could not restore the simulation point");
+            mSimulationPointToRestore.clear();
+            return false;
+        }
+        logStartValuesRecursively();
+    }
+    // Log the start values, unless a parent system will log them after restoring a simulation point
+    else if (!isRestoringSimulationPoint())
+    {
+        logTimeAndNodes(mTotalTakenSimulationSteps);
+    }
+
+    // Subsystems have initialized and logged start values by themselves, now their components can be moved into this schedule
+    // A compiled model is always generated from the flattened schedule
+    if ((mUseHierarchyFlattening || mpCompiledModel) && this->isTopLevelSystem())
+    {
+        flattenHierarchy();
+    }
+
+    // Bind the compiled model to the components in the schedule, if it does not match the model the interpreted schedule is used
+    if (mpCompiledModel && this->isTopLevelSystem())
+    {
+        mIsCompiledModelBound = mpCompiledModel->bind(mComponentSignalptrs, mComponentCptrs, mComponentQptrs);
+        if (mIsCompiledModelBound)
+        {
+            addDebugMessage(HString("Using compiled model: ")+mpCompiledModel->getModelName());
+        }
+        else
+        {
+            addWarningMessage(HString("The compiled model ")+mpCompiledModel->getModelName()+" does not match the simulation schedule of "+getName()+", it will not be used");
+        }
+    }
+
+    // We seems to have initialized successfully, the next initialization can be a warm restart unless the model is changed
+    mCanWarmRestart = this->isTopLevelSystem();
+    return true;
+}
+
+
+//! @brief Initializes the system again before a new simulation, reusing as much as possible from the previous initialization
+//! @details If only parameter values have been changed since the last successful initialization, the model check and component sorting
+//! are skipped, log buffers are reused and only changed parameters, and parameters depending on them through expressions or system parameters,
+//! are evaluated again. All components are still initialized and all start values loaded, since the previous simulation has changed their state.
+//! If components, ports or connections have been changed, a full model check and initialization is performed instead.
+//! @param[in] startT Start time of simulation
+//! @param[in] stopT Stop time of simulation
+//! @returns true if initialization succeeded, otherwise false
+bool ComponentSystem::reinitialize(const double startT, const double stopT)
+{
+    if (!mCanWarmRestart || !this->isTopLevelSystem())
+    {
+        return checkModelBeforeSimulation() && initialize(startT, stopT);
+    }
+
+    addCoreLogMessage("ComponentSystem::reinitialize() in "+getName());
+    mIsWarmRestarting = true;
+    const bool success = initialize(startT, stopT);
+    mIsWarmRestarting = false;
+    return success;
+}
+
+
+//! @brief Tell the system that the model structure has changed, so that the next call to reinitialize() performs a full initialization
+//! @details This is done automatically when components, ports or connections are changed, or when components are disabled.
+//! Any multi-threaded schedule is also discarded, since a removed component may be replaced by a new one at the same address.
+void ComponentSystem::invalidateWarmRestart()
+{
+    ComponentSystem *pSystem = this;
+    while (pSystem)
+    {
+        pSystem->mCanWarmRestart = false;
+        pSystem->mpMultiThreadPrivates->mHaveSchedule = false;
+        pSystem = pSystem->getSystemParent();
+    }
+}
+
+
+//! @brief Check if any parameter in a parameter handler has changed or refers to any of the given names, and in that case evaluate all of them
+//! @details All parameters are evaluated since unchanged parameters may refer to changed ones using self.
+//! @param[in] pParameters The parameter handler
+//! @param[in] rChangedNames The names of changed system parameters
+//! @param[out] rErrParName The name of the parameter that failed to evaluate
+//! @returns false if a parameter could not be evaluated, otherwise true
+static bool evaluateChangedComponentParameters(ParameterEvaluatorHandler *pParameters, const std::vector<HString> &rChangedNames, HString &rErrParName)
+{
+    const std::vector<ParameterEvaluator*> *pParameterVector = pParameters->getParametersVectorPtr();
+    bool needEvaluation = pParameters->haveParametersBeenAddedOrRemoved() || !pParameters->getChangedParameters().empty();
+    for (size_t p=0; (p<pParameterVector->size()) && !needEvaluation; ++p)
+    {
+        needEvaluation = pParameterVector->at(p)->referencesAnyOf(rChangedNames);
+    }
+
+    if (needEvaluation)
+    {
+        for (size_t p=0; p<pParameterVector->size(); ++p)
+        {
+            if (!pParameterVector->at(p)->evaluate())
+            {
+                rErrParName = pParameterVector->at(p)->getName();
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+
+//! @brief Recurse through the model system hierarchy and evaluate the parameters that have changed since the last initialization
+//! @details Parameters depending on changed system parameters in this or any parent system are also evaluated
+//! @param[in] changedNames The names of changed system parameters in the parent systems
+//! @returns true if all evaluated component parameters could be evaluated, otherwise false
+bool ComponentSystem::evaluateChangedParametersRecursively(std::vector<HString> changedNames)
+{
+    // First evaluate our own changed system parameters, and system parameters depending on them
+    // Repeat until no more system parameters depend on changed ones, since they may refer to each other in any order
+    const std::vector<ParameterEvaluator*> *pSysParameters = mpParameters->getParametersVectorPtr();
+    const std::vector<ParameterEvaluator*> &rChangedSysParameters = mpParameters->getChangedParameters();
+    const bool allChanged = mpParameters->haveParametersBeenAddedOrRemoved();
+    std::vector<bool> isEvaluated(pSysParameters->size(), false);
+    bool didSomething = true;
+    while (didSomething)
+    {
+        didSomething = false;
+        for (size_t p=0; p<pSysParameters->size(); ++p)
+        {
+            ParameterEvaluator *pParameter = pSysParameters->at(p);
+            if (!isEvaluated[p] && (allChanged || pParameter->referencesAnyOf(changedNames) ||
+                                    (find(rChangedSysParameters.begin(), rChangedSysParameters.end(), pParameter) != rChangedSysParameters.end())))
+            {
+                // Just as in evaluateParametersRecursively() system parameter evaluation failures are ignored here
+                pParameter->evaluate();
+                changedNames.push_back(pParameter->getName());
+                isEvaluated[p] = true;
+                didSomething = true;
+            }
+        }
+    }
 
-    // We seems to have initialized successfully
+    // Now evaluate any affected sub component parameters, and recurse into subsystems
+    std::vector<Component*> *componentVectors[3] = {&mComponentSignalptrs, &mComponentCptrs, &mComponentQptrs};
+    for (size_t v=0; v<3; ++v)
+    {
+        std::vector<Component*>::iterator cit;
+        for(cit = componentVectors[v]->begin(); cit != componentVectors[v]->end(); ++cit)
+        {
+            Component *pComp = *cit;
+            if (pComp->isComponentSystem())
+            {
+                if (!static_cast<ComponentSystem*>(pComp)->evaluateChangedParametersRecursively(changedNames))
+                {
+                    return false;
+                }
+            }
+            else
+            {
+                HString errParName;
+                if (!evaluateChangedComponentParameters(pComp->mpParameters, changedNames, errParName))
+                {
+                    HString val;
+                    pComp->getParameterValue(errParName, val);
+                    addErrorMessage("The parameter:  "+errParName+"  in System:  "+getName()+"  and Component:  "+pComp->getName()+" with value:  "+val+"  could not be evaluated!");
+                    return false;
+                }
+            }
+        }
+    }
     return true;
 }
 
 
+//! @brief Recurse through the model system hierarchy and forget all parameter changes, called when parameters have been evaluated
+void ComponentSystem::clearChangedParametersRecursively()
+{
+    mpParameters->clearChangedParameters();
+    SubComponentMapT::iterator scmit;
+    for (scmit=mSubComponentMap.begin(); scmit!=mSubComponentMap.end(); ++scmit)
+    {
+        if (scmit->second->isComponentSystem())
+        {
+            static_cast<ComponentSystem*>(scmit->second)->clearChangedParametersRecursively();
+        }
+        else
+        {
+            scmit->second->mpParameters->clearChangedParameters();
+        }
+    }
+}
+
+
+//! @brief Set simulation point data to restore at the end of initialization
+//! @details Used by restoreSimulationPoint() and fork(), the internal state of components can only be restored after they have been initialized.
+//! The data is restored by each initialization until the system is finalized
+//! @param[in] rData The contents of a simulation point file
+void ComponentSystem::setSimulationPointToRestore(const std::vector<char> &rData)
+{
+    mSimulationPointToRestore = rData;
+}
+
+
+//! @brief Check if this system or any parent system will restore a simulation point at the end of the initialization
+bool ComponentSystem::isRestoringSimulationPoint() const
+{
+    const ComponentSystem *pSystem = this;
+    while (pSystem)
+    {
+        if (!pSystem->mSimulationPointToRestore.empty())
+        {
+            return true;
+        }
+        pSystem = pSystem->getSystemParent();
+    }
+    return false;
+}
+
+
+//! @brief Log the start values in this system and all subsystems
+void ComponentSystem::logStartValuesRecursively()
+{
+    SubComponentMapT::iterator scmit;
+    for (scmit=mSubComponentMap.begin(); scmit!=mSubComponentMap.end(); ++scmit)
+    {
+        if (scmit->second->isComponentSystem())
+        {
+            static_cast<ComponentSystem*>(scmit->second)->logStartValuesRecursively();
+        }
+    }
+    logTimeAndNodes(mTotalTakenSimulationSteps);
+}
+
+
 #if defined(HOPSANCORE_USEMULTITHREADING)
-void ComponentSystem::simulateMultiThreaded(const double startT, const double stopT, const size_t nDesiredThreads, const bool noChanges, const ParallelAlgorithmT algorithm)
+void ComponentSystem::simulateMultiThreaded(const double startT, const double stopT, const size_t nDesiredThreads, const bool noChanges, const ParallelAlgorithmT algorithm, const BarrierPolicyT barrierPolicy)
 {
-    size_t nThreads = determineActualNumberOfThreads(nDesiredThreads);      //Calculate how many threads to actually use
+    // With an explicit list of processors and no desired number of threads, use one thread per processor
+    const bool useCpuList = (nDesiredThreads == 0) && (mThreadPlacement == ExplicitThreadPlacement) && !mThreadPlacementCpus.empty();
+    size_t nThreads = determineActualNumberOfThreads(useCpuList ? mThreadPlacementCpus.size() : nDesiredThreads);      //Calculate how many threads to actually use
+
+    // Reuse the worker threads owned by the simulation handler, a temporary pool is used if the system was not created by HopsanEssentials
+    SimulationThreadPool localThreadPool;
+    SimulationThreadPool *pThreadPool = &localThreadPool;
+    if(getHopsanEssentials())
+    {
+        pThreadPool = getHopsanEssentials()->getSimulationHandler()->getThreadPool();
+    }
+
+    // Decide where to place the threads, the calling thread executes the first task so it is pinned here (until the end of this function)
+    const std::vector<int> threadCpus = determineThreadCpus(nThreads, mThreadPlacement, mThreadPlacementCpus);
+    if(threadCpus.empty() && (mThreadPlacement != AutomaticThreadPlacement))
+    {
+        addWarningMessage("The requested thread placement is not supported or contains no usable processors, using the default placement.");
+    }
+    ScopedThreadAffinity callingThreadAffinity(threadCpus.empty() ? -1 : threadCpus[0]);
+    const bool placeStorage = !threadCpus.empty() && (threadCpus[0] >= 0);
 
     std::stringstream ss;
     ss << nThreads;
     HString threadStr = ss.str().c_str();
 
-    if(!noChanges)
+    // A schedule from a previous simulation can be reused if the components and their connections are the same
+    const size_t scheduleKey = calculateScheduleKey(mComponentSignalptrs, mComponentCptrs, mComponentQptrs, nThreads, algorithm);
+    if(!noChanges && mpMultiThreadPrivates->mHaveSchedule && (mpMultiThreadPrivates->mScheduleKey == scheduleKey))
+    {
+        addDebugMessage("Reusing the multi-threaded schedule from the previous simulation");
+    }
+    else if(!noChanges)
     {
+        mpMultiThreadPrivates->mHaveSchedule = true;
+        mpMultiThreadPrivates->mScheduleKey = scheduleKey;
+
         if(algorithm != TaskStealingAlgorithm)
         {
             mpMultiThreadPrivates->mSplitCVector.clear();
@@ -2420,10 +3872,33 @@ void ComponentSystem::simulateMultiThreaded(const double startT, const double st
                 addDebugMessage("Time for "+mComponentSignalptrs.at(s)->getName()+": "+to_hstring(mComponentSignalptrs.at(s)->getMeasuredTime()));
             }
 
-            distributeCcomponents(mpMultiThreadPrivates->mSplitCVector, nThreads);              //Distribute components and nodes
-            distributeQcomponents(mpMultiThreadPrivates->mSplitQVector, nThreads);
+            if(algorithm == GraphPartitioningAlgorithm)
+            {
+                distributeComponentsByGraphPartitioning(mpMultiThreadPrivates->mSplitCVector, mpMultiThreadPrivates->mSplitQVector,
+                                                        mpMultiThreadPrivates->mSplitNodeVector, nThreads);
+            }
+            else
+            {
+                distributeCcomponents(mpMultiThreadPrivates->mSplitCVector, nThreads);          //Distribute components and nodes
+                distributeQcomponents(mpMultiThreadPrivates->mSplitQVector, nThreads);
+                distributeNodePointers(mpMultiThreadPrivates->mSplitNodeVector, nThreads);
+            }
             distributeSignalcomponents(mpMultiThreadPrivates->mSplitSignalVector, nThreads);
-            distributeNodePointers(mpMultiThreadPrivates->mSplitNodeVector, nThreads);
+            if(mUseSignalLevelScheduling && (algorithm == OfflineSchedulingAlgorithm || algorithm == GraphPartitioningAlgorithm))
+            {
+                distributeSignalcomponentsByLevel(mpMultiThreadPrivates->mSplitSignalVector, nThreads);
+            }
+            else
+            {
+                delete mpMultiThreadPrivates->mpSignalSchedule;
+                mpMultiThreadPrivates->mpSignalSchedule = 0;
+            }
+
+            // Let each thread first touch the node data and log data it will use, this must be done before the components are initialized again
+            if(placeStorage && (algorithm == OfflineSchedulingAlgorithm || algorithm == GraphPartitioningAlgorithm))
+            {
+                placeStorageInThreads(pThreadPool, threadCpus);
+            }
 
             // Re-initialize the system to reset values and timers
             //! @note This only work for top level systems where the simulateMultiThreaded will not be called more than once
@@ -2438,6 +3913,8 @@ void ComponentSystem::simulateMultiThreaded(const double startT, const double st
             mpMultiThreadPrivates->mSplitCVector.resize(nThreads);
             mpMultiThreadPrivates->mSplitQVector.resize(nThreads);
             mpMultiThreadPrivates->mSplitSignalVector.resize(nThreads);
+            delete mpMultiThreadPrivates->mpSignalSchedule;
+            mpMultiThreadPrivates->mpSignalSchedule = 0;
 
             for(size_t c=0; c<mComponentCptrs.size();)
             {
@@ -2468,57 +3945,120 @@ void ComponentSystem::simulateMultiThreaded(const double startT, const double st
 
     size_t nSteps = calcNumSimSteps(startT, stopT);
 
+    if(mpProfiler && algorithm != OfflineSchedulingAlgorithm && algorithm != GraphPartitioningAlgorithm)
+    {
+        addWarningMessage("Profiling is only supported with the offline and graph partitioning scheduling algorithms, this simulation is not profiled.");
+    }
+
     //Execute simulation
-    if(algorithm == OfflineSchedulingAlgorithm)
-    {
-        addInfoMessage("Using offline scheduling algorithm with "+threadStr+" threads.");
-
-        mpMultiThreadPrivates->mvTimePtrs.push_back(&mTime);
-        BarrierLock *pBarrierLock_S = new BarrierLock(nThreads);    //Create synchronization barriers
-        BarrierLock *pBarrierLock_C = new BarrierLock(nThreads);
-        BarrierLock *pBarrierLock_Q = new BarrierLock(nThreads);
-        BarrierLock *pBarrierLock_N = new BarrierLock(nThreads);
-
-        std::thread *tt = new std::thread[nThreads];
-
-        tt[0] = std::thread(simMaster,
-                            this,
-                            std::ref(mpMultiThreadPrivates->mSplitSignalVector[0]),
-                            std::ref(mpMultiThreadPrivates->mSplitCVector[0]),
-                            std::ref(mpMultiThreadPrivates->mSplitQVector[0]),             //Create master thread
-                            std::ref(mpMultiThreadPrivates->mSplitNodeVector[0]),
-                            std::ref(mpMultiThreadPrivates->mvTimePtrs),
-                            mTime,
-                            mTimestep,
-                            nSteps,
-                            pBarrierLock_S,
-                            pBarrierLock_C,
-                            pBarrierLock_Q,
-                            pBarrierLock_N);
+    if(algorithm == OfflineSchedulingAlgorithm || algorithm == GraphPartitioningAlgorithm)
+    {
+        if(algorithm == GraphPartitioningAlgorithm)
+        {
+            addInfoMessage("Using graph partitioning scheduling algorithm with "+threadStr+" threads.");
+        }
+        else
+        {
+            addInfoMessage("Using offline scheduling algorithm with "+threadStr+" threads.");
+        }
+
+        if(!vectorContains(mpMultiThreadPrivates->mvTimePtrs, &mTime))
+        {
+            mpMultiThreadPrivates->mvTimePtrs.push_back(&mTime);
+        }
+        BarrierLock *pBarrierLock_S = new BarrierLock(nThreads, barrierPolicy);    //Create synchronization barriers
+        BarrierLock *pBarrierLock_C = new BarrierLock(nThreads, barrierPolicy);
+        BarrierLock *pBarrierLock_Q = new BarrierLock(nThreads, barrierPolicy);
+        BarrierLock *pBarrierLock_N = new BarrierLock(nThreads, barrierPolicy);
+
+        // Measure the load during the simulation and move components between the threads if it becomes unbalanced
+        // When profiling, the components are kept in the threads they were scheduled to
+        LoadRebalancer *pRebalancer = 0;
+        if(mUseLoadRebalancing && nThreads > 1 && !mpProfiler)
+        {
+            pRebalancer = new LoadRebalancer(mpMultiThreadPrivates->mSplitSignalVector, mpMultiThreadPrivates->mSplitCVector, mpMultiThreadPrivates->mSplitQVector);
+        }
+
+        // Let dependent signal components run in parallel, if a schedule was created for them
+        SignalComponentSchedule *pSignalSchedule = mpMultiThreadPrivates->mpSignalSchedule;
+        if(pSignalSchedule)
+        {
+            pSignalSchedule->reset(barrierPolicy);
+        }
+
+        if(mpProfiler)
+        {
+            mpProfiler->beginSimulation(nThreads);
+        }
+
+        std::vector< std::function<void()> > tasks(nThreads);
+
+        tasks[0] = std::bind(simMaster,
+                             this,
+                             std::ref(mpMultiThreadPrivates->mSplitSignalVector[0]),
+                             std::ref(mpMultiThreadPrivates->mSplitCVector[0]),
+                             std::ref(mpMultiThreadPrivates->mSplitQVector[0]),             //Create master thread
+                             std::ref(mpMultiThreadPrivates->mSplitNodeVector[0]),
+                             std::ref(mpMultiThreadPrivates->mvTimePtrs),
+                             mTime,
+                             mTimestep,
+                             nSteps,
+                             pBarrierLock_S,
+                             pBarrierLock_C,
+                             pBarrierLock_Q,
+                             pBarrierLock_N,
+                             pRebalancer,
+                             pSignalSchedule,
+                             mpProfiler);
 
         for (size_t t=1; t<nThreads; ++t)
         {
-            tt[t] = std::thread(simSlave,
-                                this,
-                                std::ref(mpMultiThreadPrivates->mSplitSignalVector[t]),
-                                std::ref(mpMultiThreadPrivates->mSplitCVector[t]),
-                                std::ref(mpMultiThreadPrivates->mSplitQVector[t]),          //Create slave threads
-                                std::ref(mpMultiThreadPrivates->mSplitNodeVector[t]),
-                                mTime,
-                                mTimestep,
-                                nSteps,
-                                pBarrierLock_S,
-                                pBarrierLock_C,
-                                pBarrierLock_Q,
-                                pBarrierLock_N);
+            tasks[t] = std::bind(simSlave,
+                                 this,
+                                 std::ref(mpMultiThreadPrivates->mSplitSignalVector[t]),
+                                 std::ref(mpMultiThreadPrivates->mSplitCVector[t]),
+                                 std::ref(mpMultiThreadPrivates->mSplitQVector[t]),          //Create slave threads
+                                 std::ref(mpMultiThreadPrivates->mSplitNodeVector[t]),
+                                 mTime,
+                                 mTimestep,
+                                 nSteps,
+                                 pBarrierLock_S,
+                                 pBarrierLock_C,
+                                 pBarrierLock_Q,
+                                 pBarrierLock_N,
+                                 pRebalancer,
+                                 t,
+                                 pSignalSchedule,
+                                 mpProfiler);
         }
 
-        for (size_t i = 0; i<nThreads; ++i)                 //Wait for all tasks to finish
+        pThreadPool->run(tasks, threadCpus);                //Execute the tasks and wait for all of them to finish
+
+        if(mpProfiler)
+        {
+            endProfiledSimulation(nSteps);
+        }
+
+        if(pRebalancer)
         {
-            tt[i].join();
+            HString message = "Load rebalancing: Moved "+to_hstring(pRebalancer->getNumMovedComponents())+" components between threads "+
+                              to_hstring(pRebalancer->getNumRebalances())+" times, overhead "+to_hstring(pRebalancer->getOverheadTime()*1000, 3)+" ms. "+
+                              "Imbalance (busiest thread / average) C: "+to_hstring(pRebalancer->getFirstImbalance(LoadRebalancer::CPhase), 3)+
+                              " -> "+to_hstring(pRebalancer->getLastImbalance(LoadRebalancer::CPhase), 3)+
+                              ", Q: "+to_hstring(pRebalancer->getFirstImbalance(LoadRebalancer::QPhase), 3)+
+                              " -> "+to_hstring(pRebalancer->getLastImbalance(LoadRebalancer::QPhase), 3)+
+                              ". Barrier wait "+to_hstring(pRebalancer->getWaitFraction()*100, 3)+" % of measured time.";
+            if(pRebalancer->getNumRebalances() > 0)
+            {
+                addInfoMessage(message, "rebalancing");
+            }
+            else
+            {
+                addDebugMessage(message, "rebalancing");
+            }
+            delete(pRebalancer);
         }
 
-        delete[] tt;
         delete(pBarrierLock_S);
         delete(pBarrierLock_C);
         delete(pBarrierLock_Q);
@@ -2529,11 +4069,11 @@ void ComponentSystem::simulateMultiThreaded(const double startT, const double st
 
         addInfoMessage("Using task pool algorithm with "+threadStr+" threads.");
 
-        TaskPool *pTaskPoolS = new TaskPool(mComponentSignalptrs);
-        TaskPool *pTaskPoolC = new TaskPool(mComponentCptrs);
-        TaskPool *pTaskPoolQ = new TaskPool(mComponentQptrs);
+        TaskPool *pTaskPoolS = new TaskPool(mComponentSignalptrs, barrierPolicy);
+        TaskPool *pTaskPoolC = new TaskPool(mComponentCptrs, barrierPolicy);
+        TaskPool *pTaskPoolQ = new TaskPool(mComponentQptrs, barrierPolicy);
 
-        std::thread *tt = new std::thread[nThreads];
+        std::vector< std::function<void()> > tasks(nThreads);
 
         std::atomic<double> *pTime = new std::atomic<double>;
         *pTime = mTime;
@@ -2541,145 +4081,118 @@ void ComponentSystem::simulateMultiThreaded(const double startT, const double st
         *pStop = false;
 
 
-        for (size_t t=0; t<nThreads-1; ++t)
+        if(!vectorContains(mpMultiThreadPrivates->mvTimePtrs, &mTime))
         {
-            tt[t] = std::thread(simPoolSlave,
-                                pTaskPoolC,
-                                pTaskPoolQ,
-                                pTime,
-                                pStop);
-        }
-
-        Component *pComp;
-        for(size_t i=0; i<nSteps; ++i)
-        {
-            *pTime = *pTime+mTimestep;
-
-            //S-pool
-            pTaskPoolS->open();
-            pComp = pTaskPoolS->getComponent();
-            while(pComp)
-            {
-                pComp->simulate(*pTime);
-                pTaskPoolS->reportDone();
-                pComp = pTaskPoolS->getComponent();
-            }
-            while(!pTaskPoolS->isReady()) {}
-            pTaskPoolS->close();
-
-            //C-pool
-            pTaskPoolC->open();
-            pComp = pTaskPoolC->getComponent();
-            while(pComp)
-            {
-                pComp->simulate(*pTime);
-                pTaskPoolC->reportDone();
-                pComp = pTaskPoolC->getComponent();
-            }
-            while(!pTaskPoolC->isReady()) {}
-            pTaskPoolC->close();
-
-            //Q-pool
-            pTaskPoolQ->open();
-            pComp = pTaskPoolQ->getComponent();
-            while(pComp)
-            {
-                pComp->simulate(*pTime);
-                pTaskPoolQ->reportDone();
-                pComp = pTaskPoolQ->getComponent();
-            }
-            while(!pTaskPoolQ->isReady()) {}
-            pTaskPoolQ->close();
-
-            mTime =  *pTime;
-            logTimeAndNodes(i+1);            //Log all nodes
+            mpMultiThreadPrivates->mvTimePtrs.push_back(&mTime);
         }
-        *pStop=true;
 
+        tasks[0] = std::bind(simPoolMaster,                 //The master task is executed in this thread
+                             this,
+                             pTaskPoolS,
+                             pTaskPoolC,
+                             pTaskPoolQ,
+                             std::ref(mpMultiThreadPrivates->mvTimePtrs),
+                             pTime,
+                             pStop,
+                             mTimestep,
+                             nSteps);
 
-        for (size_t i = 0; i<nThreads-1; ++i)                 //Wait for all tasks to finish
+        for (size_t t=1; t<nThreads; ++t)
         {
-            tt[i].join();
+            tasks[t] = std::bind(simPoolSlave,
+                                 pTaskPoolC,
+                                 pTaskPoolQ,
+                                 pTime,
+                                 pStop);
         }
 
-        delete[] tt;
+        pThreadPool->run(tasks, threadCpus);                //Execute the tasks and wait for all of them to finish
+
         delete(pTaskPoolS);
         delete(pTaskPoolC);
         delete(pTaskPoolQ);
+        delete(pTime);
         delete(pStop);
     }
     else if(algorithm == TaskStealingAlgorithm)
     {
         addInfoMessage("Using task stealing algorithm with "+threadStr+" threads.");
 
-        mpMultiThreadPrivates->mvTimePtrs.push_back(&mTime);
-        BarrierLock *pBarrierLock_S = new BarrierLock(nThreads);    //Create synchronization barriers
-        BarrierLock *pBarrierLock_C = new BarrierLock(nThreads);
-        BarrierLock *pBarrierLock_Q = new BarrierLock(nThreads);
-        BarrierLock *pBarrierLock_N = new BarrierLock(nThreads);
+        if(!vectorContains(mpMultiThreadPrivates->mvTimePtrs, &mTime))
+        {
+            mpMultiThreadPrivates->mvTimePtrs.push_back(&mTime);
+        }
+        BarrierLock *pBarrierLock_S = new BarrierLock(nThreads, barrierPolicy);    //Create synchronization barriers
+        BarrierLock *pBarrierLock_C = new BarrierLock(nThreads, barrierPolicy);
+        BarrierLock *pBarrierLock_Q = new BarrierLock(nThreads, barrierPolicy);
+        BarrierLock *pBarrierLock_N = new BarrierLock(nThreads, barrierPolicy);
 
         size_t maxSize = mComponentCptrs.size()+mComponentQptrs.size()+mComponentSignalptrs.size();
 
-        std::vector<ThreadSafeVector *> *pVectorsC = new std::vector<ThreadSafeVector *>();
+        std::vector<WorkStealingDeque *> *pVectorsC = new std::vector<WorkStealingDeque *>();
         for(size_t i=0; i<mpMultiThreadPrivates->mSplitCVector.size(); ++i)
         {
-            pVectorsC->push_back(new ThreadSafeVector(mpMultiThreadPrivates->mSplitCVector[i], maxSize));
+            pVectorsC->push_back(new WorkStealingDeque(mpMultiThreadPrivates->mSplitCVector[i], maxSize));
         }
 
-        std::vector<ThreadSafeVector *> *pVectorsQ = new std::vector<ThreadSafeVector *>();
+        std::vector<WorkStealingDeque *> *pVectorsQ = new std::vector<WorkStealingDeque *>();
         for(size_t i=0; i<mpMultiThreadPrivates->mSplitQVector.size(); ++i)
         {
-            pVectorsQ->push_back(new ThreadSafeVector(mpMultiThreadPrivates->mSplitQVector[i], maxSize));
+            pVectorsQ->push_back(new WorkStealingDeque(mpMultiThreadPrivates->mSplitQVector[i], maxSize));
         }
 
-        std::thread *tt = new std::thread[nThreads];
-
-        tt[0] = std::thread(simStealingMaster,
-                            this,
-                            std::ref(mComponentSignalptrs),
-                            pVectorsC,
-                            pVectorsQ,             //Create master thread
-                            std::ref(mpMultiThreadPrivates->mvTimePtrs),
-                            mTime,
-                            mTimestep,
-                            nSteps,
-                            nThreads,
-                            0,
-                            pBarrierLock_S,
-                            pBarrierLock_C,
-                            pBarrierLock_Q,
-                            pBarrierLock_N,
-                            maxSize);
+        std::vector< std::function<void()> > tasks(nThreads);
+
+        tasks[0] = std::bind(simStealingMaster,
+                             this,
+                             std::ref(mComponentSignalptrs),
+                             pVectorsC,
+                             pVectorsQ,             //Create master thread
+                             std::ref(mpMultiThreadPrivates->mvTimePtrs),
+                             mTime,
+                             mTimestep,
+                             nSteps,
+                             nThreads,
+                             0,
+                             pBarrierLock_S,
+                             pBarrierLock_C,
+                             pBarrierLock_Q,
+                             pBarrierLock_N,
+                             maxSize);
 
 
         for (size_t t=1; t<nThreads; ++t)
         {
-            tt[t] = std::thread(simStealingSlave,
-                                this,
-                                pVectorsC,
-                                pVectorsQ,
-                                mTime,
-                                mTimestep,
-                                nSteps,
-                                nThreads,
-                                t,
-                                pBarrierLock_S,
-                                pBarrierLock_C,
-                                pBarrierLock_Q,
-                                pBarrierLock_N,
-                                maxSize);
+            tasks[t] = std::bind(simStealingSlave,
+                                 this,
+                                 pVectorsC,
+                                 pVectorsQ,
+                                 mTime,
+                                 mTimestep,
+                                 nSteps,
+                                 nThreads,
+                                 t,
+                                 pBarrierLock_S,
+                                 pBarrierLock_C,
+                                 pBarrierLock_Q,
+                                 pBarrierLock_N,
+                                 maxSize);
         }
 
-        for (size_t i = 0; i<nThreads; ++i)                 //Wait for all tasks to finish
-        {
-            tt[i].join();
-        }
+        pThreadPool->run(tasks, threadCpus);                //Execute the tasks and wait for all of them to finish
 
-        delete[] tt;                                           //Clean up
-        delete(pBarrierLock_S);
+        delete(pBarrierLock_S);                                //Clean up
         delete(pBarrierLock_C);
         delete(pBarrierLock_Q);
         delete(pBarrierLock_N);
+        for(size_t i=0; i<pVectorsC->size(); ++i)
+        {
+            delete(pVectorsC->at(i));
+        }
+        for(size_t i=0; i<pVectorsQ->size(); ++i)
+        {
+            delete(pVectorsQ->at(i));
+        }
         delete(pVectorsC);
         delete(pVectorsQ);
     }
@@ -2690,7 +4203,18 @@ void ComponentSystem::simulateMultiThreaded(const double startT, const double st
         // Round to nearest, we may not get exactly the stop time that we want
         size_t numSimulationSteps = calcNumSimSteps(mTime, stopT); //Here mTime is the last time step since it is not updated yet
 
-        std::thread *tt;
+        // One task per component, the tasks read the current time when they are executed
+        std::vector< std::function<void()> > cTasks, qTasks;
+        for (size_t c=0; c < mComponentCptrs.size(); ++c)
+        {
+            Component *pComp = mComponentCptrs[c];
+            cTasks.push_back([this, pComp](){ simOneComponentOneStep(pComp, mTime); });
+        }
+        for (size_t q=0; q < mComponentQptrs.size(); ++q)
+        {
+            Component *pComp = mComponentQptrs[q];
+            qTasks.push_back([this, pComp](){ simOneComponentOneStep(pComp, mTime); });
+        }
 
         //Simulate
         for (size_t i=0; i<numSimulationSteps; ++i)
@@ -2710,32 +4234,10 @@ void ComponentSystem::simulateMultiThreaded(const double startT, const double st
             }
 
             //C components
-            tt = new std::thread[mComponentCptrs.size()];
-            for (size_t c=0; c < mComponentCptrs.size(); ++c)
-            {
-                tt[c] = std::thread(simOneComponentOneStep,
-                                    mComponentCptrs[c],
-                                    mTime);
-            }
-            for(size_t c=0; c<mComponentCptrs.size(); ++c)
-            {
-                tt[c].join();
-            }
-            delete[] tt;
+            pThreadPool->run(cTasks, threadCpus);
 
             //Q components
-            tt = new std::thread[mComponentQptrs.size()];
-            for (size_t q=0; q < mComponentQptrs.size(); ++q)
-            {
-                tt[q] = std::thread(simOneComponentOneStep,
-                                    mComponentQptrs[q],
-                                    mTime);
-            }
-            for(size_t q=0; q<mComponentQptrs.size(); ++q)
-            {
-                tt[q].join();
-            }
-            delete[] tt;
+            pThreadPool->run(qTasks, threadCpus);
 
             ++mTotalTakenSimulationSteps;
 
@@ -2749,7 +4251,18 @@ void ComponentSystem::simulateMultiThreaded(const double startT, const double st
         // Round to nearest, we may not get exactly the stop time that we want
         size_t numSimulationSteps = calcNumSimSteps(mTime, stopT); //Here mTime is the last time step since it is not updated yet
 
-        std::thread *tt;
+        // One task per group of components, the tasks read the current time when they are executed
+        std::vector< std::function<void()> > cTasks, qTasks;
+        for (size_t c=0; c < mpMultiThreadPrivates->mSplitCVector.size(); ++c)
+        {
+            std::vector<Component*> *pComponents = &mpMultiThreadPrivates->mSplitCVector[c];
+            cTasks.push_back([this, pComponents](){ simOneStep(pComponents, mTime); });
+        }
+        for (size_t q=0; q < mpMultiThreadPrivates->mSplitQVector.size(); ++q)
+        {
+            std::vector<Component*> *pComponents = &mpMultiThreadPrivates->mSplitQVector[q];
+            qTasks.push_back([this, pComponents](){ simOneStep(pComponents, mTime); });
+        }
 
         //Simulate
         for (size_t i=0; i<numSimulationSteps; ++i)
@@ -2769,32 +4282,10 @@ void ComponentSystem::simulateMultiThreaded(const double startT, const double st
             }
 
             //C components
-            tt = new std::thread[mComponentCptrs.size()];
-            for (size_t c=0; c < mComponentCptrs.size(); ++c)
-            {
-                tt[c] = std::thread(simOneStep,
-                                    &mpMultiThreadPrivates->mSplitCVector[c],
-                                    mTime);
-            }
-            for(size_t c=0; c<mComponentCptrs.size(); ++c)
-            {
-                tt[c].join();
-            }
-            delete[] tt;
+            pThreadPool->run(cTasks, threadCpus);
 
             //Q components
-            tt = new std::thread[mComponentQptrs.size()];
-            for (size_t q=0; q < mComponentQptrs.size(); ++q)
-            {
-                tt[q] = std::thread(simOneStep,
-                                    &mpMultiThreadPrivates->mSplitQVector[q],
-                                    mTime);
-            }
-            for(size_t q=0; q<mComponentQptrs.size(); ++q)
-            {
-                tt[q].join();
-            }
-            delete[] tt;
+            pThreadPool->run(qTasks, threadCpus);
 
             ++mTotalTakenSimulationSteps;
 
@@ -3066,6 +4557,45 @@ void ComponentSystem::distributeSignalcomponents(vector< vector<Component*> > &r
 }
 
 
+//! @brief Helper function that lets dependent signal components be simulated in parallel, if that is estimated to be faster
+//! @details A SignalComponentSchedule is created from the dependency levels of the signal components. It is only used if it is estimated to
+//! be at least 10 % faster than rSplitSignalVector, where each group of connected signal components is kept in one thread. Otherwise no
+//! schedule is used and rSplitSignalVector is left unchanged.
+//! @param rSplitSignalVector Reference to vector with signal components for each thread, as created by distributeSignalcomponents()
+//! @param nThreads Number of simulation threads
+void ComponentSystem::distributeSignalcomponentsByLevel(vector< vector<Component*> > &rSplitSignalVector, size_t nThreads)
+{
+    delete mpMultiThreadPrivates->mpSignalSchedule;
+    mpMultiThreadPrivates->mpSignalSchedule = 0;
+
+    std::vector< std::vector<size_t> > dependencies;
+    getSignalComponentDependencies(mComponentSignalptrs, dependencies);
+    SignalComponentSchedule *pSchedule = new SignalComponentSchedule(mComponentSignalptrs, dependencies, nThreads);
+    if(!pSchedule->isValid())
+    {
+        addDebugMessage("Signal components are not sorted in dependency order, they can not be scheduled by level", "signalschedule");
+        delete pSchedule;
+        return;
+    }
+
+    const double groupedTime = pSchedule->estimateTime(rSplitSignalVector);
+    HString message = "Signal components: "+to_hstring(pSchedule->getNumLevels())+" dependency levels, at most "+to_hstring(pSchedule->getMaxLevelWidth())+
+                      " components in one level, "+to_hstring(pSchedule->getNumCrossThreadDependencies())+" dependencies between threads. "+
+                      "Estimated speedup "+to_hstring(pSchedule->getEstimatedSpeedup(), 3)+" by level, "+
+                      to_hstring((groupedTime > 0) ? pSchedule->getEstimatedSpeedup()*pSchedule->getEstimatedTime()/groupedTime : 1.0, 3)+" by connected groups.";
+    if((pSchedule->getNumCrossThreadDependencies() > 0) && (pSchedule->getEstimatedTime() < 0.9*groupedTime))
+    {
+        pSchedule->getSplitVector(rSplitSignalVector);
+        mpMultiThreadPrivates->mpSignalSchedule = pSchedule;
+        addDebugMessage(message+" Using level scheduling.", "signalschedule");
+    }
+    else
+    {
+        addDebugMessage(message+" Using connected groups.", "signalschedule");
+        delete pSchedule;
+    }
+}
+
 //! @brief Helper function that distributes node pointers equally over one vector per thread
 //! @param rSplitNodeVector Reference to vector with vectors of node pointers (one vector per thread)
 //! @param nThreads Number of simulation threads
@@ -3086,8 +4616,196 @@ void ComponentSystem::distributeNodePointers(vector< vector<Node*> > &rSplitNode
     }
 }
 
+//! @brief Let each simulation thread reallocate the node data and log data that it uses, so that it is placed on the NUMA node of the thread
+//! @details Memory is placed on the NUMA node of the thread that first touches it. The data of each node is reallocated by the thread of the
+//! first C-, Q- or signal component that is connected to it, and subsystems are reallocated by the thread that simulates them. The first thread
+//! logs all nodes in this system, so it reallocates their log data. Node data in a node data arena is not moved. Components keep pointers to
+//! the node data, so this must be followed by initialize(). The load rebalancer may later move components away from their data.
+//! @param pThreadPool The thread pool to execute the reallocation in
+//! @param rThreadCpus The processor that each thread is pinned to
+void ComponentSystem::placeStorageInThreads(SimulationThreadPool *pThreadPool, const std::vector<int> &rThreadCpus)
+{
+    const size_t nThreads = mpMultiThreadPrivates->mSplitCVector.size();
+    vector< vector<Node*> > threadNodes(nThreads);
+    vector< vector<ComponentSystem*> > threadSubsystems(nThreads);
+    std::set<Node*> placedNodes;
+    const vector< vector<Component*> > *splitVectors[3] = {&mpMultiThreadPrivates->mSplitCVector, &mpMultiThreadPrivates->mSplitQVector,
+                                                           &mpMultiThreadPrivates->mSplitSignalVector};
+    for(size_t v=0; v<3; ++v)
+    {
+        for(size_t t=0; t<std::min(nThreads, splitVectors[v]->size()); ++t)
+        {
+            const vector<Component*> &rComponents = splitVectors[v]->at(t);
+            for(size_t c=0; c<rComponents.size(); ++c)
+            {
+                if(rComponents[c]->isComponentSystem())
+                {
+                    threadSubsystems[t].push_back(static_cast<ComponentSystem*>(rComponents[c]));
+                }
+                vector<Port*> ports = rComponents[c]->getPortPtrVector();
+                for(size_t p=0; p<ports.size(); ++p)
+                {
+                    for(size_t sp=0; sp<ports[p]->getNumPorts(); ++sp)
+                    {
+                        Node *pNode = ports[p]->getNodePtr(sp);
+                        if(pNode && placedNodes.insert(pNode).second)
+                        {
+                            threadNodes[t].push_back(pNode);
+                        }
+                    }
+                }
+            }
+        }
+    }
+
+    std::vector< std::function<void()> > tasks(nThreads);
+    for(size_t t=0; t<nThreads; ++t)
+    {
+        tasks[t] = [this, t, &threadNodes, &threadSubsystems]()
+        {
+            for(size_t n=0; n<threadNodes[t].size(); ++n)
+            {
+                threadNodes[t][n]->reallocateDataValues();
+            }
+            for(size_t s=0; s<threadSubsystems[t].size(); ++s)
+            {
+                threadSubsystems[t][s]->reallocateStorageRecursively();
+            }
+            if(t == 0)
+            {
+                reallocateLogStorage();
+                for(size_t f=0; f<mFlattenedSubsystems.size(); ++f)
+                {
+                    mFlattenedSubsystems[f]->reallocateLogStorage();
+                }
+            }
+        };
+    }
+    pThreadPool->run(tasks, rThreadCpus);
+}
+
+//! @brief Helper function that distributes C and Q components over one vector per thread by partitioning the connection graph
+//! @details Components that share a node are kept in the same thread when possible, so that few nodes are written by one thread
+//! and read by another. The measured time of the C- and Q-components in each thread is balanced separately, since they are
+//! simulated in separate phases. Each node is assigned to the thread of one of its components.
+//! @param rSplitCVector Reference to vector with vectors of C components (one vector per thread)
+//! @param rSplitQVector Reference to vector with vectors of Q components (one vector per thread)
+//! @param rSplitNodeVector Reference to vector with vectors of node pointers (one vector per thread)
+//! @param nThreads Number of simulation threads
+void ComponentSystem::distributeComponentsByGraphPartitioning(vector< vector<Component*> > &rSplitCVector, vector< vector<Component*> > &rSplitQVector,
+                                                              vector< vector<Node*> > &rSplitNodeVector, size_t nThreads)
+{
+    // Each C and Q component is a vertex in the graph, C components first
+    vector<Component*> vertexComponents(mComponentCptrs.begin(), mComponentCptrs.end());
+    vertexComponents.insert(vertexComponents.end(), mComponentQptrs.begin(), mComponentQptrs.end());
+    const size_t nCVertices = mComponentCptrs.size();
+    const size_t nVertices = vertexComponents.size();
+
+    // The measured time is used as weight, constraint 0 is the C-phase and constraint 1 the Q-phase
+    // A small minimum weight makes sure that components with (too) short measured time are spread out as well
+    double totalTime = 0;
+    for(size_t v=0; v<nVertices; ++v)
+    {
+        totalTime += std::max(vertexComponents[v]->getMeasuredTime(), 0.0);
+    }
+    const double minWeight = (totalTime > 0) ? 0.01*totalTime/double(nVertices) : 1.0;
+    GraphPartitioner partitioner(nVertices, 2);
+    for(size_t v=0; v<nVertices; ++v)
+    {
+        const size_t phase = (v < nCVertices) ? 0 : 1;
+        partitioner.setVertexWeight(v, phase, std::max(vertexComponents[v]->getMeasuredTime(), 0.0)+minWeight);
+        partitioner.setVertexWeight(v, 1-phase, 0.0);
+    }
+
+    // Components that share a node are connected by an edge
+    std::map<Node*, vector<size_t> > nodeVertices;
+    for(size_t v=0; v<nVertices; ++v)
+    {
+        vector<Port*> ports = vertexComponents[v]->getPortPtrVector();
+        for(size_t p=0; p<ports.size(); ++p)
+        {
+            for(size_t s=0; s<ports[p]->getNumPorts(); ++s)
+            {
+                Node *pNode = ports[p]->getNodePtr(s);
+                if(pNode)
+                {
+                    nodeVertices[pNode].push_back(v);
+                }
+            }
+        }
+    }
+    std::map<Node*, vector<size_t> >::iterator it;
+    for(it=nodeVertices.begin(); it!=nodeVertices.end(); ++it)
+    {
+        for(size_t i=0; i<it->second.size(); ++i)
+        {
+            for(size_t j=i+1; j<it->second.size(); ++j)
+            {
+                partitioner.addEdge(it->second[i], it->second[j]);
+            }
+        }
+    }
+
+    vector<size_t> threadOfVertex;
+    partitioner.partition(nThreads, threadOfVertex);
+
+    rSplitCVector.resize(nThreads);
+    rSplitQVector.resize(nThreads);
+    rSplitNodeVector.resize(nThreads);
+    vector<double> cTimes(nThreads, 0.0), qTimes(nThreads, 0.0);
+    for(size_t v=0; v<nVertices; ++v)
+    {
+        if(v < nCVertices)
+        {
+            rSplitCVector[threadOfVertex[v]].push_back(vertexComponents[v]);
+            cTimes[threadOfVertex[v]] += vertexComponents[v]->getMeasuredTime();
+        }
+        else
+        {
+            rSplitQVector[threadOfVertex[v]].push_back(vertexComponents[v]);
+            qTimes[threadOfVertex[v]] += vertexComponents[v]->getMeasuredTime();
+        }
+    }
+
+    // Nodes that are only connected to signal components are spread evenly
+    size_t nSharedNodes = 0;
+    size_t thread = 0;
+    for(size_t n=0; n<mSubNodePtrs.size(); ++n)
+    {
+        it = nodeVertices.find(mSubNodePtrs[n]);
+        if(it != nodeVertices.end())
+        {
+            const size_t nodeThread = threadOfVertex[it->second.front()];
+            rSplitNodeVector[nodeThread].push_back(mSubNodePtrs[n]);
+            for(size_t i=1; i<it->second.size(); ++i)
+            {
+                if(threadOfVertex[it->second[i]] != nodeThread)
+                {
+                    ++nSharedNodes;
+                    break;
+                }
+            }
+        }
+        else
+        {
+            rSplitNodeVector[thread].push_back(mSubNodePtrs[n]);
+            thread = (thread+1) % nThreads;
+        }
+    }
+
+    addDebugMessage("Graph partitioning: "+to_hstring(nSharedNodes)+" of "+to_hstring(nodeVertices.size())+" nodes are shared between threads", "partitioning");
+    for(size_t i=0; i<nThreads; ++i)
+    {
+        addDebugMessage("Creating partitioned thread vector, measured C time = " + to_hstring(cTimes[i]*1000) + " ms, Q time = " + to_hstring(qTimes[i]*1000) + " ms", "partitioning");
+        sortComponentVector(rSplitCVector[i]);
+        sortComponentVector(rSplitQVector[i]);
+    }
+}
+
 void ComponentSystem::reschedule(size_t nThreads)
 {
+    delete mpMultiThreadPrivates->mpSignalSchedule;
+    mpMultiThreadPrivates->mpSignalSchedule = 0;
     mpMultiThreadPrivates->mSplitCVector.clear();
     mpMultiThreadPrivates->mSplitQVector.clear();
     mpMultiThreadPrivates->mSplitSignalVector.clear();
@@ -3268,7 +4986,7 @@ void ComponentSystem::sortComponentVectorsByMeasuredTime()
 //This overrides the multi-threaded simulation call with a single-threaded simulation if multi-threading is not available.
 //! @brief Simulate function that overrides multi-threaded simulation call with a single-threaded call
 //! In case multi-threaded support is not available
-void ComponentSystem::simulateMultiThreaded(const double /*startT*/, const double stopT, const size_t /*nThreads*/, const bool /*noChanges*/, ParallelAlgorithmT /*algorithm*/)
+void ComponentSystem::simulateMultiThreaded(const double /*startT*/, const double stopT, const size_t /*nThreads*/, const bool /*noChanges*/, ParallelAlgorithmT /*algorithm*/, BarrierPolicyT /*barrierPolicy*/)
 {
     this->addErrorMessage("Multi-threaded simulation not available (compiled without C++11 support). Simulating single-threaded.");
     this->simulate(stopT);
@@ -3293,11 +5011,30 @@ void ComponentSystem::distributeSignalcomponents(vector< vector<Component*> > &/
 }
 
 
+void ComponentSystem::distributeSignalcomponentsByLevel(vector< vector<Component*> > &/*rSplitSignalVector*/, size_t /*nThreads*/)
+{
+    addWarningMessage("Called distributeSignalcomponentsByLevel(), but multi-threading is not avaialble.");
+}
+
+
 void ComponentSystem::distributeNodePointers(vector< vector<Node*> > &/*rSplitNodeVector*/, size_t /*nThreads*/)
 {
     addWarningMessage("Called distributeNodePointers(), but multi-threading is not avaialble.");
 }
 
+
+void ComponentSystem::placeStorageInThreads(SimulationThreadPool */*pThreadPool*/, const std::vector<int> &/*rThreadCpus*/)
+{
+    addWarningMessage("Called placeStorageInThreads(), but multi-threading is not avaialble.");
+}
+
+
+void ComponentSystem::distributeComponentsByGraphPartitioning(vector< vector<Component*> > &/*rSplitCVector*/, vector< vector<Component*> > &/*rSplitQVector*/,
+                                                              vector< vector<Node*> > &/*rSplitNodeVector*/, size_t /*nThreads*/)
+{
+    addWarningMessage("Called distributeComponentsByGraphPartitioning(), but multi-threading is not avaialble.");
+}
+
 #endif
 
 
@@ -3345,6 +5082,12 @@ void ComponentSystem::simulate(const double stopT)
     // Round to nearest, we may not get exactly the stop time that we want
     size_t numSimulationSteps = calcNumSimSteps(mTime, stopT); //Here mTime is the last time step since it is not updated yet
 
+    if (mpProfiler)
+    {
+        simulateAndProfile(numSimulationSteps);
+        return;
+    }
+
     //Simulate
     for (size_t i=0; i<numSimulationSteps; ++i)
     {
@@ -3355,6 +5098,14 @@ void ComponentSystem::simulate(const double stopT)
         mTime += mTimestep; //mTime is updated here before the simulation,
         //mTime is the current time during the simulateOneTimestep
 
+        if (mIsCompiledModelBound)
+        {
+            mpCompiledModel->simulateOneTimestep(mTime);
+            ++mTotalTakenSimulationSteps;
+            logTimeAndNodes(mTotalTakenSimulationSteps);
+            continue;
+        }
+
         //! @todo maybe use iterators instead
         //Signal components
         for (size_t s=0; s < mComponentSignalptrs.size(); ++s)
@@ -3380,22 +5131,106 @@ void ComponentSystem::simulate(const double stopT)
     }
 }
 
+//! @brief Simulate like simulate(), but record the time of each component and phase in the profiler
+//! @param[in] numSimulationSteps The number of steps to simulate
+void ComponentSystem::simulateAndProfile(const size_t numSimulationSteps)
+{
+    mpProfiler->beginSimulation(1);
+    size_t i=0;
+    for (; i<numSimulationSteps; ++i)
+    {
+        if (mStopSimulation) {
+            break;
+        }
+
+        mTime += mTimestep;
+
+        mpProfiler->simulatePhase(0, SimulationProfiler::SignalPhase, mComponentSignalptrs, mTime, i);
+        mpProfiler->simulatePhase(0, SimulationProfiler::CPhase, mComponentCptrs, mTime, i);
+        mpProfiler->simulatePhase(0, SimulationProfiler::QPhase, mComponentQptrs, mTime, i);
+
+        const SimulationProfiler::TicksT logStart = SimulationProfiler::getTicks();
+        ++mTotalTakenSimulationSteps;
+        logTimeAndNodes(mTotalTakenSimulationSteps);
+        mpProfiler->addPhaseTime(0, SimulationProfiler::LogPhase, logStart, SimulationProfiler::getTicks(), i);
+    }
+    endProfiledSimulation(i);
+}
+
+//! @brief Merge the results in the profiler after a simulation, and warn if hardware counters were requested but could not be read
+//! @param[in] numSimulationSteps The number of simulated steps
+void ComponentSystem::endProfiledSimulation(const size_t numSimulationSteps)
+{
+    mpProfiler->endSimulation(numSimulationSteps);
+    if (mpProfiler->usesHardwareCounters() && !mpProfiler->getHardwareCounterError().empty())
+    {
+        addWarningMessage("Not all hardware counters are available for profiling: "+mpProfiler->getHardwareCounterError());
+    }
+}
+
+//! @brief Start simulating the system paced against the wall clock, until it is stopped
+//! @param[in] realTimeFactor Simulation time per wall clock time
+//! @returns True if the real-time simulation was started
 bool ComponentSystem::startRealtimeSimulation(double realTimeFactor)
+{
+    RealtimeOptions options;
+    options.realTimeFactor = realTimeFactor;
+    return startRealtimeSimulation(options);
+}
+
+//! @brief Start simulating the system paced against the wall clock in a separate thread
+//! @details The system must be initialized. The simulation runs until the stop time in the options is reached, until
+//! stopRealtimeSimulation() or stopSimulation() is called, or until a deadline is missed with AbortOverrunPolicy.
+//! @param[in] rOptions The real-time settings
+//! @returns True if the real-time simulation was started
+bool ComponentSystem::startRealtimeSimulation(const RealtimeOptions &rOptions)
 {
 #if defined(HOPSANCORE_USEMULTITHREADING)
-    std::thread rtThread(simWholeSystemInRealtime, realTimeFactor, &mStopSimulation, &mTime, mTimestep, mComponentSignalptrs, mComponentCptrs, mComponentQptrs);
-    rtThread.detach();
-    return true;
+    if (!mpRealtimeExecutor)
+    {
+        mpRealtimeExecutor = new RealtimeExecutor();
+    }
+    return mpRealtimeExecutor->start(this, rOptions);
 #else
+    HOPSAN_UNUSED(rOptions)
     stopSimulation("Real-time simulation requires C++11 or above.");
     return false;
 #endif
 }
 
+//! @brief Stop a real-time simulation and wait for its thread to finish
+void ComponentSystem::stopRealtimeSimulation()
+{
+    if (mpRealtimeExecutor)
+    {
+        mpRealtimeExecutor->stop();
+    }
+}
+
+//! @brief Check if a real-time simulation is running
+//! @returns False if no real-time simulation was started, or if it has stopped or reached its stop time
+bool ComponentSystem::isRealtimeSimulationRunning() const
+{
+    return mpRealtimeExecutor && mpRealtimeExecutor->isRunning();
+}
+
+//! @brief Returns the timing statistics of the current or last real-time simulation, it can be called while the simulation is running
+RealtimeStatistics ComponentSystem::getRealtimeStatistics() const
+{
+    return mpRealtimeExecutor ? mpRealtimeExecutor->getStatistics() : RealtimeStatistics();
+}
+
 
 //! @brief Finalizes a system component and all its contained components after a simulation.
 void ComponentSystem::finalize()
 {
+    // A real-time simulation must not simulate while the components are finalized
+    stopRealtimeSimulation();
+
+    // Let flattened subsystems finalize their own components
+    mIsCompiledModelBound = false;
+    unflattenHierarchy();
+
     //Finalize
     //Signal components
     for (size_t s=0; s < mComponentSignalptrs.size(); ++s)
@@ -3433,6 +5268,15 @@ void ComponentSystem::finalize()
         mComponentSignalptrs.push_back(mDisabledSptrs.at(i));
     }
     mDisabledSptrs.clear();
+
+    // Move node data back into the nodes
+    unpackNodeDataArena();
+
+    // Write the remaining log samples and close the log sink
+    finishLogStream();
+
+    // A restored simulation point only applies to the simulation that has now finished
+    mSimulationPointToRestore.clear();
 }
 
 ////! @brief This function will set the number of log data slots for preallocation and logDt based on a skip factor to the sample time
@@ -3546,9 +5390,9 @@ void ConditionalComponentSystem::simulate(const double stopT)
     }
 }
 
-void ConditionalComponentSystem::simulateMultiThreaded(const double startT, const double stopT, const size_t nDesiredThreads, const bool noChanges, ParallelAlgorithmT algorithm)
+void ConditionalComponentSystem::simulateMultiThreaded(const double startT, const double stopT, const size_t nDesiredThreads, const bool noChanges, ParallelAlgorithmT algorithm, BarrierPolicyT barrierPolicy)
 {
-    ComponentSystem::simulateMultiThreaded(startT,  stopT, nDesiredThreads, noChanges, algorithm);
+    ComponentSystem::simulateMultiThreaded(startT,  stopT, nDesiredThreads, noChanges, algorithm, barrierPolicy);
 }
 
 } // namespace hopsan
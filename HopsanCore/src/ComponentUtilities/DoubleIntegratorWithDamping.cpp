@@ -104,3 +104,15 @@ double DoubleIntegratorWithDamping::valueSecond()
 {
     return mDelayY;
 }
+
+
+//! Saves or restores the integrator state, including the undo backup
+void DoubleIntegratorWithDamping::serializeState(StateArchive &rArchive)
+{
+    rArchive.serialize(mDelayU);
+    rArchive.serialize(mDelayY);
+    rArchive.serialize(mDelaySY);
+    rArchive.serialize(mDelayUbackup);
+    rArchive.serialize(mDelayYbackup);
+    rArchive.serialize(mDelaySYbackup);
+}
@@ -171,3 +171,16 @@ double DoubleIntegratorWithDampingAndCoulombFriction::valueSecond()
 {
     return mDelayY;
 }
+
+
+//! Saves or restores the integrator state, including the undo backup and the movement state
+void DoubleIntegratorWithDampingAndCoulombFriction::serializeState(StateArchive &rArchive)
+{
+    rArchive.serialize(mDelayU);
+    rArchive.serialize(mDelayY);
+    rArchive.serialize(mDelaySY);
+    rArchive.serialize(mDelayUbackup);
+    rArchive.serialize(mDelayYbackup);
+    rArchive.serialize(mDelaySYbackup);
+    rArchive.serialize(movement);
+}
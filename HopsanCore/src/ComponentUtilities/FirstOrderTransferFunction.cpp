@@ -221,6 +221,18 @@ bool FirstOrderTransferFunction::isSaturated() const
     return mIsSaturated;
 }
 
+//! @brief Saves or restores the transfer function state, including the backup buffers
+//! @param[in,out] rArchive The archive to save to or restore from
+void FirstOrderTransferFunction::serializeState(StateArchive &rArchive)
+{
+    rArchive.serialize(mValue);
+    rArchive.serialize(mDelayedU);
+    rArchive.serialize(mDelayedY);
+    rArchive.serialize(mIsSaturated);
+    mBackupU.serializeState(rArchive);
+    mBackupY.serializeState(rArchive);
+}
+
 
 
 
@@ -338,6 +350,15 @@ double FirstOrderTransferFunctionVariable::value()
     return mValue;
 }
 
+//! @brief Saves or restores the transfer function state
+//! @param[in,out] rArchive The archive to save to or restore from
+void FirstOrderTransferFunctionVariable::serializeState(StateArchive &rArchive)
+{
+    rArchive.serialize(mValue);
+    rArchive.serialize(mDelayU);
+    rArchive.serialize(mDelayY);
+}
+
 
 //! @class hopsan::FirstOrderLowPassFilter
 //! @ingroup ComponentUtilityClasses
@@ -126,3 +126,11 @@ double IntegratorLimited::value()
 {
     return mDelayY;
 }
+
+//! @brief Saves or restores the integrator state
+//! @param[in,out] rArchive The archive to save to or restore from
+void IntegratorLimited::serializeState(StateArchive &rArchive)
+{
+    rArchive.serialize(mDelayU);
+    rArchive.serialize(mDelayY);
+}
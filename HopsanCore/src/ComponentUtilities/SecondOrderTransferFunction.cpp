@@ -244,6 +244,20 @@ bool SecondOrderTransferFunction::isSaturated() const
     return mIsSaturated;
 }
 
+//! @brief Saves or restores the transfer function state, including the backup buffers
+//! @param[in,out] rArchive The archive to save to or restore from
+void SecondOrderTransferFunction::serializeState(StateArchive &rArchive)
+{
+    rArchive.serialize(mValue);
+    rArchive.serialize(mDelayedU);
+    rArchive.serialize(mDelayed2U);
+    rArchive.serialize(mDelayedY);
+    rArchive.serialize(mDelayed2Y);
+    rArchive.serialize(mIsSaturated);
+    mBackupU.serializeState(rArchive);
+    mBackupY.serializeState(rArchive);
+}
+
 
 
 
@@ -364,3 +378,12 @@ void SecondOrderTransferFunctionVariable::recalculateCoefficients()
     mCoeffY[1] = 2.0*mDen[0]*(*mpTimeStep)*(*mpTimeStep) - 8.0*mDen[2];
     mCoeffY[2] = mDen[0]*(*mpTimeStep)*(*mpTimeStep) - 2.0*mDen[1]*(*mpTimeStep) + 4.0*mDen[2];
 }
+
+//! @brief Saves or restores the transfer function state
+//! @param[in,out] rArchive The archive to save to or restore from
+void SecondOrderTransferFunctionVariable::serializeState(StateArchive &rArchive)
+{
+    rArchive.serialize(mValue);
+    rArchive.serialize(mDelayU, 2);
+    rArchive.serialize(mDelayY, 2);
+}
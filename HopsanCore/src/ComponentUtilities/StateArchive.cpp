@@ -0,0 +1,151 @@
+/*-----------------------------------------------------------------------------
+
+ Copyright 2017 Hopsan Group
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+
+
+ The full license is available in the file LICENSE.
+ For details about the 'Hopsan Group' or information about Authors and
+ Contributors see the HOPSANGROUP and AUTHORS files that are located in
+ the Hopsan source code root directory.
+
+-----------------------------------------------------------------------------*/
+
+//!
+//! @file   StateArchive.cpp
+//!
+//! @brief Contains the Component Utility StateArchive class, used to save and restore the internal simulation state of components
+//!
+//$Id$
+
+#include "ComponentUtilities/StateArchive.h"
+#include <cstring>
+#include <stdint.h>
+
+using namespace hopsan;
+
+//! @brief Constructor for an archive used to save state
+StateArchive::StateArchive()
+{
+    mpRestoreData = 0;
+    mRestoreSize = 0;
+    mRestorePosition = 0;
+    mIsOK = true;
+}
+
+//! @brief Constructor for an archive used to restore state
+//! @param[in] pData The archived data, it must remain valid during the lifetime of the archive
+//! @param[in] size The size of the archived data in bytes
+StateArchive::StateArchive(const char *pData, const size_t size)
+{
+    mpRestoreData = pData;
+    mRestoreSize = size;
+    mRestorePosition = 0;
+    mIsOK = true;
+}
+
+//! @brief Check if the archive is used to restore state (or to save state)
+bool StateArchive::isRestoring() const
+{
+    return (mpRestoreData != 0);
+}
+
+//! @brief Check if all values could be restored
+//! @returns false if a restoring archive ran out of data, otherwise true
+bool StateArchive::isOK() const
+{
+    return mIsOK;
+}
+
+void StateArchive::serialize(double &rValue)
+{
+    serializeBytes(&rValue, sizeof(double));
+}
+
+void StateArchive::serialize(int &rValue)
+{
+    int64_t value = rValue;
+    serializeBytes(&value, sizeof(int64_t));
+    rValue = int(value);
+}
+
+void StateArchive::serialize(size_t &rValue)
+{
+    // Always use 64 bits so that the archive does not depend on the platform size_t
+    uint64_t value = rValue;
+    serializeBytes(&value, sizeof(uint64_t));
+    rValue = size_t(value);
+}
+
+void StateArchive::serialize(bool &rValue)
+{
+    char value = rValue ? 1 : 0;
+    serializeBytes(&value, 1);
+    rValue = (value != 0);
+}
+
+//! @brief Serialize a fixed size array of values
+void StateArchive::serialize(double *pValues, const size_t numValues)
+{
+    serializeBytes(pValues, numValues*sizeof(double));
+}
+
+//! @brief Serialize a vector of values, the vector is resized to the archived size when restoring
+void StateArchive::serialize(std::vector<double> &rValues)
+{
+    size_t size = rValues.size();
+    serialize(size);
+    if (isRestoring() && mIsOK)
+    {
+        // Make sure that a corrupt size can not make us allocate more than the remaining data
+        if (size > (mRestoreSize-mRestorePosition)/sizeof(double))
+        {
+            mIsOK = false;
+            return;
+        }
+        rValues.resize(size);
+    }
+    if (!rValues.empty())
+    {
+        serialize(&rValues[0], rValues.size());
+    }
+}
+
+//! @brief Serialize raw bytes, use this only for plain data
+//! @param[in,out] pData Pointer to the data
+//! @param[in] numBytes The number of bytes
+void StateArchive::serializeBytes(void *pData, const size_t numBytes)
+{
+    if (isRestoring())
+    {
+        if (!mIsOK || (numBytes > mRestoreSize-mRestorePosition))
+        {
+            mIsOK = false;
+            return;
+        }
+        memcpy(pData, mpRestoreData+mRestorePosition, numBytes);
+        mRestorePosition += numBytes;
+    }
+    else
+    {
+        const char *pBytes = static_cast<const char*>(pData);
+        mData.insert(mData.end(), pBytes, pBytes+numBytes);
+    }
+}
+
+//! @brief Returns the saved data
+const std::vector<char> &StateArchive::getData() const
+{
+    return mData;
+}
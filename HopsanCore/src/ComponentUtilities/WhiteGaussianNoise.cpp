@@ -40,6 +40,27 @@
 
 using namespace hopsan;
 
+namespace {
+
+//! @brief Scrambles a 64-bit value (the splitmix64 finalizer), used to turn seeds into well distributed generator states
+uint64_t mixSeed(uint64_t x)
+{
+    x += 0x9E3779B97F4A7C15ULL;
+    x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    x = (x ^ (x >> 27)) * 0x94D049BB133111EBULL;
+    return x ^ (x >> 31);
+}
+
+uint64_t gInstanceCounter = 0;
+
+}
+
+//! @brief Constructor, each instance gets its own generator seed
+WhiteGaussianNoise::WhiteGaussianNoise()
+{
+    setSeed(++gInstanceCounter);
+}
+
 double WhiteGaussianNoise::getValue()
 {
     // Calc Gaussian random value
@@ -51,3 +72,42 @@ double WhiteGaussianNoise::getValue()
      double random2 = (double)rand() / (double)RAND_MAX;
      return sqrt((-2.0)*log(random1))*cos(2.0*M_PI*random2);
 }
+
+//! @brief Returns the next Gaussian random value from the generator of this instance
+double WhiteGaussianNoise::getNextValue()
+{
+    double random1 = 0;
+    while(random1 == 0)
+    {
+        random1 = nextUniform();
+    }
+    double random2 = nextUniform();
+    return sqrt((-2.0)*log(random1))*cos(2.0*M_PI*random2);
+}
+
+//! @brief Sets the seed of the generator of this instance
+//! @param[in] seed The new seed
+void WhiteGaussianNoise::setSeed(uint64_t seed)
+{
+    mState = mixSeed(seed);
+    if (mState == 0)
+    {
+        mState = 1;
+    }
+}
+
+//! @brief Saves or restores the generator state
+//! @param[in,out] rArchive The archive to save to or restore from
+void WhiteGaussianNoise::serializeState(StateArchive &rArchive)
+{
+    rArchive.serializeBytes(&mState, sizeof(mState));
+}
+
+//! @brief Returns a uniform random value in [0,1) using a xorshift64* generator
+double WhiteGaussianNoise::nextUniform()
+{
+    mState ^= mState >> 12;
+    mState ^= mState << 25;
+    mState ^= mState >> 27;
+    return double((mState * 0x2545F4914F6CDD1DULL) >> 11) * (1.0/9007199254740992.0);
+}
@@ -0,0 +1,967 @@
+/*-----------------------------------------------------------------------------
+
+ Copyright 2017 Hopsan Group
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+
+
+ The full license is available in the file LICENSE.
+ For details about the 'Hopsan Group' or information about Authors and
+ Contributors see the HOPSANGROUP and AUTHORS files that are located in
+ the Hopsan source code root directory.
+
+-----------------------------------------------------------------------------*/
+
+//!
+//! @file   BinaryModelFile.cpp
+//!
+//! @brief Contains functions for saving and loading precompiled binary model files (.hmfb)
+//!
+//$Id$
+
+#include "CoreUtilities/BinaryModelFile.h"
+#include "CoreUtilities/HmfLoader.h"
+#include "CoreUtilities/HopsanCoreMessageHandler.h"
+#include "CoreUtilities/AliasHandler.h"
+#include "ComponentSystem.h"
+#include "HopsanEssentials.h"
+#include "HopsanCoreVersion.h"
+#include "Parameters.h"
+#include "Port.h"
+
+#include <vector>
+#include <map>
+#include <set>
+#include <string>
+#include <fstream>
+#include <cstring>
+#include <cstdint>
+#include <sys/stat.h>
+#include <sys/types.h>
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+using namespace std;
+using namespace hopsan;
+
+/*
+ * Binary model file format (version 1)
+ *
+ * The file contains an already loaded (and version upgraded) model as a set of flat tables. It is created from a model
+ * that has been loaded from a .hmf file, and it is loaded by memory mapping the file and creating the components directly
+ * from the tables, without any XML parsing.
+ *
+ * Header
+ *   Magic       Version   StartTime   StopTime   SourceFileSize   SourceFileModified   SourceFilePath   CoreVersion
+ *   "HMFB"      uint32    double      double     int64            int64                uint32 (string)  uint32 (string)
+ *
+ *   Followed by the offset (from the beginning of the file) and the number of records for each table, as two uint64
+ *
+ * Tables (each table starts on an 8-byte boundary)
+ *   Strings            Offset and length of each interned string in the string data
+ *   Systems            Settings of each system and the ranges of its records in the other tables, system 0 is the root system
+ *   Components         The sub components of all systems, in the order they shall be created, subsystems refer to their system
+ *   Parameters         Component parameter name and value
+ *   SystemParameters   System parameter name, value, type, description and quantity or unit
+ *   Quantities         Port name and quantity for modifiable signal quantities
+ *   SystemPorts        System port name and description
+ *   Connections        Component index (relative to the first component of the system, or NoIndex for the system itself) and port name of both ends
+ *   Aliases            Alias name, component name, port name and variable index
+ *   SearchPaths        The search paths of each system
+ *   StringData         The characters of all strings (not null terminated)
+ *
+ * All strings are stored as an index into the string table, each unique string is only stored once.
+ * The file is considered to be out of date if the size or the modification time of the source .hmf file has changed,
+ * or if it was created with a different HopsanCore version. Then the source file is loaded instead.
+ * Note! Only the source file of the root system is checked, not the files of externally referenced subsystems.
+ *
+ * */
+
+namespace {
+
+const char gMagic[4] = {'H','M','F','B'};
+const uint32_t gFormatVersion = 1;
+const uint32_t gNoIndex = 0xFFFFFFFF;
+const uint32_t gDisabledFlag = 0x1;
+const uint32_t gInheritTimestepFlag = 0x2;
+
+enum TableT {StringTable, SystemTable, ComponentTable, ParameterTable, SystemParameterTable, QuantityTable, SystemPortTable,
+             ConnectionTable, AliasTable, SearchPathTable, StringDataTable, NumTables};
+
+struct TableInfo
+{
+    uint64_t offset;
+    uint64_t count;
+};
+
+struct FileHeader
+{
+    char magic[4];
+    uint32_t version;
+    double startTime;
+    double stopTime;
+    int64_t sourceFileSize;
+    int64_t sourceFileModified;
+    uint32_t sourceFilePath;
+    uint32_t coreVersion;
+    TableInfo tables[NumTables];
+};
+
+struct Range
+{
+    uint32_t first;
+    uint32_t count;
+};
+
+struct StringRecord
+{
+    uint32_t offset;
+    uint32_t length;
+};
+
+struct SystemRecord
+{
+    uint32_t name;
+    uint32_t subTypeName;
+    uint32_t externalModelFilePath;
+    uint32_t numHopScript;
+    uint32_t flags;
+    uint32_t reserved;
+    double timestep;
+    double logStartTime;
+    uint64_t numLogSamples;
+    Range components;
+    Range systemParameters;
+    Range systemPorts;
+    Range connections;
+    Range aliases;
+    Range searchPaths;
+};
+
+struct ComponentRecord
+{
+    uint32_t name;
+    uint32_t typeName;
+    uint32_t subTypeName;
+    uint32_t flags;
+    uint32_t subSystem;
+    uint32_t reserved;
+    Range parameters;
+    Range quantities;
+};
+
+struct ParameterRecord
+{
+    uint32_t name;
+    uint32_t value;
+};
+
+struct SystemParameterRecord
+{
+    uint32_t name;
+    uint32_t value;
+    uint32_t type;
+    uint32_t description;
+    uint32_t quantityOrUnit;
+};
+
+struct QuantityRecord
+{
+    uint32_t port;
+    uint32_t quantity;
+};
+
+struct SystemPortRecord
+{
+    uint32_t name;
+    uint32_t description;
+};
+
+struct ConnectionRecord
+{
+    uint32_t component1;
+    uint32_t port1;
+    uint32_t component2;
+    uint32_t port2;
+};
+
+struct AliasRecord
+{
+    uint32_t alias;
+    uint32_t component;
+    uint32_t port;
+    int32_t variable;
+};
+
+//! @brief Returns the directory part of a file path, including the trailing separator
+HString getDirectoryOfPath(const HString &rFilePath)
+{
+    size_t pos = rFilePath.rfind('/');
+#ifdef _WIN32
+    size_t pos_bs = rFilePath.rfind('\\');
+    if ((pos_bs != HString::npos) && ((pos == HString::npos) || (pos_bs > pos)))
+    {
+        pos = pos_bs;
+    }
+#endif
+    if (pos == HString::npos)
+    {
+        return HString();
+    }
+    return rFilePath.substr(0, pos+1);
+}
+
+//! @brief Get the size and modification time of a file
+//! @returns false if the file does not exist
+bool getFileInfo(const HString &rFilePath, int64_t &rSize, int64_t &rModified)
+{
+    struct stat info;
+    if (rFilePath.empty() || (stat(rFilePath.c_str(), &info) != 0))
+    {
+        return false;
+    }
+    rSize = static_cast<int64_t>(info.st_size);
+    rModified = static_cast<int64_t>(info.st_mtime);
+    return true;
+}
+
+//! @brief A read-only memory mapping of an entire file
+class MappedFile
+{
+public:
+    MappedFile(const HString &rFilePath) : mpData(0), mSize(0)
+    {
+#ifdef _WIN32
+        mMapping = 0;
+        mFile = CreateFileA(rFilePath.c_str(), GENERIC_READ, FILE_SHARE_READ, 0, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, 0);
+        LARGE_INTEGER size;
+        if ((mFile != INVALID_HANDLE_VALUE) && GetFileSizeEx(mFile, &size) && (size.QuadPart > 0))
+        {
+            mMapping = CreateFileMappingA(mFile, 0, PAGE_READONLY, 0, 0, 0);
+            if (mMapping)
+            {
+                mpData = static_cast<const char*>(MapViewOfFile(mMapping, FILE_MAP_READ, 0, 0, 0));
+                mSize = mpData ? static_cast<size_t>(size.QuadPart) : 0;
+            }
+        }
+#else
+        mFd = open(rFilePath.c_str(), O_RDONLY);
+        struct stat info;
+        if ((mFd >= 0) && (fstat(mFd, &info) == 0) && (info.st_size > 0))
+        {
+            void *pData = mmap(0, static_cast<size_t>(info.st_size), PROT_READ, MAP_PRIVATE, mFd, 0);
+            if (pData != MAP_FAILED)
+            {
+                mpData = static_cast<const char*>(pData);
+                mSize = static_cast<size_t>(info.st_size);
+            }
+        }
+#endif
+    }
+
+    ~MappedFile()
+    {
+#ifdef _WIN32
+        if (mpData)
+        {
+            UnmapViewOfFile(mpData);
+        }
+        if (mMapping)
+        {
+            CloseHandle(mMapping);
+        }
+        if (mFile != INVALID_HANDLE_VALUE)
+        {
+            CloseHandle(mFile);
+        }
+#else
+        if (mpData)
+        {
+            munmap(const_cast<char*>(mpData), mSize);
+        }
+        if (mFd >= 0)
+        {
+            close(mFd);
+        }
+#endif
+    }
+
+    const char *data() const
+    {
+        return mpData;
+    }
+
+    size_t size() const
+    {
+        return mSize;
+    }
+
+private:
+    MappedFile(const MappedFile &);
+    MappedFile &operator=(const MappedFile &);
+
+    const char *mpData;
+    size_t mSize;
+#ifdef _WIN32
+    HANDLE mFile;
+    HANDLE mMapping;
+#else
+    int mFd;
+#endif
+};
+
+//! @brief Reads a binary model file from memory and creates the model
+class BinaryModelFileReader
+{
+public:
+    BinaryModelFileReader(const char *pData, const size_t size) : mpData(pData), mSize(size), mpHeader(0), mOK(true) {}
+
+    //! @brief Checks the header and the table locations
+    bool readHeader()
+    {
+        if (!mpData || (mSize < sizeof(FileHeader)))
+        {
+            return false;
+        }
+        mpHeader = reinterpret_cast<const FileHeader*>(mpData);
+        if ((memcmp(mpHeader->magic, gMagic, sizeof(gMagic)) != 0) || (mpHeader->version != gFormatVersion))
+        {
+            return false;
+        }
+        const size_t recordSizes[NumTables] = {sizeof(StringRecord), sizeof(SystemRecord), sizeof(ComponentRecord), sizeof(ParameterRecord),
+                                               sizeof(SystemParameterRecord), sizeof(QuantityRecord), sizeof(SystemPortRecord),
+                                               sizeof(ConnectionRecord), sizeof(AliasRecord), sizeof(uint32_t), sizeof(char)};
+        for (size_t t=0; t<NumTables; ++t)
+        {
+            const TableInfo &rTable = mpHeader->tables[t];
+            if ((rTable.offset % 8 != 0) || (rTable.offset > mSize) || (rTable.count > (mSize - rTable.offset) / recordSizes[t]))
+            {
+                return false;
+            }
+        }
+        const StringRecord *pStrings = table<StringRecord>(StringTable);
+        for (size_t s=0; s<count(StringTable); ++s)
+        {
+            if (uint64_t(pStrings[s].offset) + pStrings[s].length > count(StringDataTable))
+            {
+                return false;
+            }
+        }
+        return (count(SystemTable) > 0);
+    }
+
+    const FileHeader &header() const
+    {
+        return *mpHeader;
+    }
+
+    HString rootSystemName()
+    {
+        return string(table<SystemRecord>(SystemTable)[0].name);
+    }
+
+    HString string(const uint32_t id)
+    {
+        if (id >= count(StringTable))
+        {
+            mOK = false;
+            return HString();
+        }
+        const StringRecord &rString = table<StringRecord>(StringTable)[id];
+        return HString(table<char>(StringDataTable) + rString.offset, rString.length);
+    }
+
+    //! @brief Creates the contents of a system, in the same order as ComponentSystem::copyContentsTo()
+    //! @param[in] systemIndex The index of the system record
+    //! @param[in] pSystem The (newly created) system, it must already have its name and be added to its parent system
+    //! @param[in] pHopsanEssentials The HopsanEssentials instance used to create the components
+    //! @returns true if the system could be loaded, else false
+    bool loadSystem(const uint32_t systemIndex, ComponentSystem *pSystem, HopsanEssentials *pHopsanEssentials)
+    {
+        if (systemIndex >= count(SystemTable))
+        {
+            return false;
+        }
+        const SystemRecord &rRecord = table<SystemRecord>(SystemTable)[systemIndex];
+        if (!isValid(rRecord.components, ComponentTable) || !isValid(rRecord.systemParameters, SystemParameterTable) ||
+            !isValid(rRecord.systemPorts, SystemPortTable) || !isValid(rRecord.connections, ConnectionTable) ||
+            !isValid(rRecord.aliases, AliasTable) || !isValid(rRecord.searchPaths, SearchPathTable))
+        {
+            return false;
+        }
+
+        // Settings
+        pSystem->setSubTypeName(string(rRecord.subTypeName));
+        pSystem->setDisabled(rRecord.flags & gDisabledFlag);
+        pSystem->setDesiredTimestep(rRecord.timestep);
+        pSystem->setInheritTimestep(rRecord.flags & gInheritTimestepFlag);
+        pSystem->setLogStartTime(rRecord.logStartTime);
+        pSystem->setNumLogSamples(static_cast<size_t>(rRecord.numLogSamples));
+        pSystem->setExternalModelFilePath(string(rRecord.externalModelFilePath));
+        const uint32_t *pSearchPaths = table<uint32_t>(SearchPathTable) + rRecord.searchPaths.first;
+        for (size_t i=0; i<rRecord.searchPaths.count; ++i)
+        {
+            pSystem->addSearchPath(string(pSearchPaths[i]));
+        }
+
+        // System parameters (needed before sub components are created as they may be using them)
+        loadSystemParameters(rRecord.systemParameters, pSystem);
+        pSystem->setNumHopScript(string(rRecord.numHopScript));
+
+        // Sub components
+        const ComponentRecord *pComponents = table<ComponentRecord>(ComponentTable) + rRecord.components.first;
+        vector<Component*> subComponents(rRecord.components.count, 0);
+        for (size_t c=0; c<rRecord.components.count; ++c)
+        {
+            const ComponentRecord &rComponent = pComponents[c];
+            const HString typeName = string(rComponent.typeName);
+            Component *pComponent = pHopsanEssentials->createComponent(typeName);
+            if (!pComponent)
+            {
+                pSystem->addErrorMessage("Could not create component: "+string(rComponent.name)+" of type: "+typeName);
+                return false;
+            }
+            pComponent->setName(string(rComponent.name));
+            pSystem->addComponent(pComponent);
+            subComponents[c] = pComponent;
+
+            if (rComponent.subSystem != gNoIndex)
+            {
+                if (!pComponent->isComponentSystem() || (rComponent.subSystem <= systemIndex) ||
+                    !loadSystem(rComponent.subSystem, static_cast<ComponentSystem*>(pComponent), pHopsanEssentials))
+                {
+                    return false;
+                }
+                continue;
+            }
+
+            pComponent->setSubTypeName(string(rComponent.subTypeName));
+            pComponent->setDisabled(rComponent.flags & gDisabledFlag);
+
+            // Parameters, including start values
+            if (!isValid(rComponent.parameters, ParameterTable) || !isValid(rComponent.quantities, QuantityTable))
+            {
+                return false;
+            }
+            const ParameterRecord *pParameters = table<ParameterRecord>(ParameterTable) + rComponent.parameters.first;
+            for (size_t i=0; i<rComponent.parameters.count; ++i)
+            {
+                const HString name = string(pParameters[i].name);
+                const HString value = string(pParameters[i].value);
+                if (!pComponent->setParameterValue(name, value, true))
+                {
+                    pComponent->addWarningMessage("Failed to set parameter: "+name+"="+value);
+                }
+            }
+
+            // Modifiable signal quantities
+            const QuantityRecord *pQuantities = table<QuantityRecord>(QuantityTable) + rComponent.quantities.first;
+            for (size_t i=0; i<rComponent.quantities.count; ++i)
+            {
+                Port *pPort = pComponent->getPort(string(pQuantities[i].port));
+                if (pPort)
+                {
+                    pPort->setSignalNodeQuantityOrUnit(string(pQuantities[i].quantity));
+                }
+            }
+        }
+
+        // System ports
+        const SystemPortRecord *pSystemPorts = table<SystemPortRecord>(SystemPortTable) + rRecord.systemPorts.first;
+        for (size_t i=0; i<rRecord.systemPorts.count; ++i)
+        {
+            pSystem->addSystemPort(string(pSystemPorts[i].name), string(pSystemPorts[i].description));
+        }
+
+        // Connections
+        const ConnectionRecord *pConnections = table<ConnectionRecord>(ConnectionTable) + rRecord.connections.first;
+        for (size_t i=0; i<rRecord.connections.count; ++i)
+        {
+            Port *pPort1 = findPort(pConnections[i].component1, pConnections[i].port1, pSystem, subComponents);
+            Port *pPort2 = findPort(pConnections[i].component2, pConnections[i].port2, pSystem, subComponents);
+            if (!pPort1 || !pPort2 || !pSystem->connect(pPort1, pPort2))
+            {
+                pSystem->addErrorMessage("Could not load connection: "+string(pConnections[i].port1)+" <-> "+string(pConnections[i].port2));
+                return false;
+            }
+        }
+
+        // Set system parameters again after connecting, just like when loading, in case of C-type subsystems with start values
+        loadSystemParameters(rRecord.systemParameters, pSystem);
+
+        // Aliases
+        const AliasRecord *pAliases = table<AliasRecord>(AliasTable) + rRecord.aliases.first;
+        for (size_t i=0; i<rRecord.aliases.count; ++i)
+        {
+            pSystem->getAliasHandler().setVariableAlias(string(pAliases[i].alias), string(pAliases[i].component), string(pAliases[i].port), pAliases[i].variable);
+        }
+
+        return mOK;
+    }
+
+private:
+    template<typename T>
+    const T *table(const TableT t) const
+    {
+        return reinterpret_cast<const T*>(mpData + mpHeader->tables[t].offset);
+    }
+
+    size_t count(const TableT t) const
+    {
+        return static_cast<size_t>(mpHeader->tables[t].count);
+    }
+
+    bool isValid(const Range &rRange, const TableT t) const
+    {
+        return (uint64_t(rRange.first) + rRange.count <= count(t));
+    }
+
+    void loadSystemParameters(const Range &rRange, ComponentSystem *pSystem)
+    {
+        const SystemParameterRecord *pParameters = table<SystemParameterRecord>(SystemParameterTable) + rRange.first;
+        for (size_t i=0; i<rRange.count; ++i)
+        {
+            const SystemParameterRecord &rParameter = pParameters[i];
+            pSystem->setOrAddSystemParameter(string(rParameter.name), string(rParameter.value), string(rParameter.type),
+                                             string(rParameter.description), string(rParameter.quantityOrUnit), true);
+        }
+    }
+
+    Port *findPort(const uint32_t component, const uint32_t port, ComponentSystem *pSystem, const vector<Component*> &rSubComponents)
+    {
+        if (component == gNoIndex)
+        {
+            return pSystem->getPort(string(port));
+        }
+        else if (component < rSubComponents.size())
+        {
+            return rSubComponents[component]->getPort(string(port));
+        }
+        return 0;
+    }
+
+    const char *mpData;
+    size_t mSize;
+    const FileHeader *mpHeader;
+    bool mOK;
+};
+
+}
+
+namespace hopsan {
+
+//! @brief Collects the contents of a loaded model into the binary model file tables
+//! @details This class is a friend of ComponentSystem, to be able to traverse the sub components in their simulation order
+class BinaryModelFileWriter
+{
+public:
+    //! @brief Adds a string to the string table, unless it is already there
+    //! @returns The index of the string
+    uint32_t addString(const HString &rString)
+    {
+        const std::string key(rString.c_str(), rString.size());
+        map<std::string, uint32_t>::iterator it = mStringIds.find(key);
+        if (it != mStringIds.end())
+        {
+            return it->second;
+        }
+        StringRecord record;
+        record.offset = static_cast<uint32_t>(mStringData.size());
+        record.length = static_cast<uint32_t>(rString.size());
+        mStringData.insert(mStringData.end(), rString.c_str(), rString.c_str()+rString.size());
+        mStrings.push_back(record);
+        mStringIds.insert(make_pair(key, uint32_t(mStrings.size()-1)));
+        return uint32_t(mStrings.size()-1);
+    }
+
+    //! @brief Adds a system with all its contents, in the same order as ComponentSystem::copyContentsTo()
+    //! @param[in] pSystem The system to add
+    //! @returns The index of the system record, or gNoIndex if the system could not be added
+    uint32_t addSystem(ComponentSystem *pSystem)
+    {
+        const uint32_t systemIndex = uint32_t(mSystems.size());
+        mSystems.push_back(SystemRecord());
+        SystemRecord record;
+        memset(&record, 0, sizeof(record));
+
+        // Settings
+        record.name = addString(pSystem->getName());
+        record.subTypeName = addString(pSystem->getSubTypeName());
+        record.externalModelFilePath = addString(pSystem->getExternalModelFilePath());
+        record.numHopScript = addString(pSystem->getNumHopScript());
+        record.flags = (pSystem->isDisabled() ? gDisabledFlag : 0) | (pSystem->doesInheritTimestep() ? gInheritTimestepFlag : 0);
+        record.timestep = pSystem->getDesiredTimeStep();
+        record.logStartTime = pSystem->getLogStartTime();
+        record.numLogSamples = pSystem->getNumLogSamples();
+        const vector<HString> searchPaths = pSystem->getSearchPaths();
+        record.searchPaths.first = uint32_t(mSearchPaths.size());
+        record.searchPaths.count = uint32_t(searchPaths.size());
+        for (size_t i=0; i<searchPaths.size(); ++i)
+        {
+            mSearchPaths.push_back(addString(searchPaths[i]));
+        }
+
+        // System parameters
+        const vector<ParameterEvaluator*> *pSystemParameters = pSystem->getParametersVectorPtr();
+        record.systemParameters.first = uint32_t(mSystemParameters.size());
+        record.systemParameters.count = uint32_t(pSystemParameters->size());
+        for (size_t i=0; i<pSystemParameters->size(); ++i)
+        {
+            const ParameterEvaluator *pParameter = pSystemParameters->at(i);
+            SystemParameterRecord parameter;
+            parameter.name = addString(pParameter->getName());
+            parameter.value = addString(pParameter->getValue());
+            parameter.type = addString(pParameter->getType());
+            parameter.description = addString(pParameter->getDescription());
+            parameter.quantityOrUnit = addString(pParameter->getQuantity().empty() ? pParameter->getUnit() : pParameter->getQuantity());
+            mSystemParameters.push_back(parameter);
+        }
+
+        // Sub components, in the original order in each CQS vector
+        const vector<Component*> *componentVectors[4] = {&pSystem->mComponentSignalptrs, &pSystem->mComponentCptrs,
+                                                          &pSystem->mComponentQptrs, &pSystem->mComponentUndefinedptrs};
+        vector<Component*> subComponents;
+        for (size_t v=0; v<4; ++v)
+        {
+            subComponents.insert(subComponents.end(), componentVectors[v]->begin(), componentVectors[v]->end());
+        }
+        map<Component*, uint32_t> componentIndices;
+        record.components.first = uint32_t(mComponents.size());
+        record.components.count = uint32_t(subComponents.size());
+        for (size_t c=0; c<subComponents.size(); ++c)
+        {
+            Component *pComponent = subComponents[c];
+            componentIndices.insert(make_pair(pComponent, uint32_t(c)));
+
+            ComponentRecord component;
+            memset(&component, 0, sizeof(component));
+            component.name = addString(pComponent->getName());
+            component.typeName = addString(pComponent->getTypeName());
+            component.subTypeName = addString(pComponent->getSubTypeName());
+            component.flags = pComponent->isDisabled() ? gDisabledFlag : 0;
+            // The sub system contents are added after the contents of this system, to keep the ranges of this system contiguous
+            component.subSystem = pComponent->isComponentSystem() ? 0 : gNoIndex;
+
+            if (!pComponent->isComponentSystem())
+            {
+                const vector<ParameterEvaluator*> *pParameters = pComponent->getParametersVectorPtr();
+                component.parameters.first = uint32_t(mParameters.size());
+                component.parameters.count = uint32_t(pParameters->size());
+                for (size_t i=0; i<pParameters->size(); ++i)
+                {
+                    ParameterRecord parameter;
+                    parameter.name = addString(pParameters->at(i)->getName());
+                    parameter.value = addString(pParameters->at(i)->getValue());
+                    mParameters.push_back(parameter);
+                }
+
+                vector<Port*> ports = pComponent->getPortPtrVector();
+                component.quantities.first = uint32_t(mQuantities.size());
+                for (size_t p=0; p<ports.size(); ++p)
+                {
+                    if (ports[p]->getSignalNodeQuantityModifyable())
+                    {
+                        QuantityRecord quantity;
+                        quantity.port = addString(ports[p]->getName());
+                        quantity.quantity = addString(ports[p]->getSignalNodeQuantity());
+                        mQuantities.push_back(quantity);
+                    }
+                }
+                component.quantities.count = uint32_t(mQuantities.size()) - component.quantities.first;
+            }
+            mComponents.push_back(component);
+        }
+
+        // System ports
+        vector<Port*> systemPorts = pSystem->getPortPtrVector();
+        record.systemPorts.first = uint32_t(mSystemPorts.size());
+        for (size_t p=0; p<systemPorts.size(); ++p)
+        {
+            if (systemPorts[p]->getPortType() == SystemPortType)
+            {
+                SystemPortRecord systemPort;
+                systemPort.name = addString(systemPorts[p]->getName());
+                systemPort.description = addString(systemPorts[p]->getDescription());
+                mSystemPorts.push_back(systemPort);
+            }
+        }
+        record.systemPorts.count = uint32_t(mSystemPorts.size()) - record.systemPorts.first;
+
+        // Connections, each connection between two ports in this system is stored once, multiports first so that their sub ports
+        // are created in the same order as in the loaded system
+        record.connections.first = uint32_t(mConnections.size());
+        vector<Component*> portOwners(1, pSystem);
+        portOwners.insert(portOwners.end(), subComponents.begin(), subComponents.end());
+        std::set< pair<Port*, Port*> > addedConnections;
+        for (int multiPortPass=1; multiPortPass>=0; --multiPortPass)
+        {
+            for (size_t o=0; o<portOwners.size(); ++o)
+            {
+                vector<Port*> ports = portOwners[o]->getPortPtrVector();
+                for (size_t p=0; p<ports.size(); ++p)
+                {
+                    if (ports[p]->isMultiPort() != (multiPortPass == 1))
+                    {
+                        continue;
+                    }
+                    for (size_t sp=0; sp<ports[p]->getNumPorts(); ++sp)
+                    {
+                        vector<Port*> connectedPorts = ports[p]->getConnectedPorts(ports[p]->isMultiPort() ? int(sp) : -1);
+                        for (size_t cp=0; cp<connectedPorts.size(); ++cp)
+                        {
+                            Component *pOtherComponent = connectedPorts[cp]->getComponent();
+                            if ((pOtherComponent != pSystem) && (pOtherComponent->getSystemParent() != pSystem))
+                            {
+                                continue;
+                            }
+
+                            Port *pPort1 = ports[p];
+                            Port *pPort2 = connectedPorts[cp]->getParentPort() ? connectedPorts[cp]->getParentPort() : connectedPorts[cp];
+                            pair<Port*, Port*> connection = (pPort1 < pPort2) ? make_pair(pPort1, pPort2) : make_pair(pPort2, pPort1);
+                            if (!addedConnections.insert(connection).second)
+                            {
+                                continue;
+                            }
+
+                            ConnectionRecord connectionRecord;
+                            connectionRecord.component1 = (pPort1->getComponent() == pSystem) ? gNoIndex : componentIndices[pPort1->getComponent()];
+                            connectionRecord.port1 = addString(pPort1->getName());
+                            connectionRecord.component2 = (pPort2->getComponent() == pSystem) ? gNoIndex : componentIndices[pPort2->getComponent()];
+                            connectionRecord.port2 = addString(pPort2->getName());
+                            mConnections.push_back(connectionRecord);
+                        }
+                    }
+                }
+            }
+        }
+        record.connections.count = uint32_t(mConnections.size()) - record.connections.first;
+
+        // Aliases
+        const vector<HString> aliases = pSystem->getAliasHandler().getAliases();
+        record.aliases.first = uint32_t(mAliases.size());
+        for (size_t a=0; a<aliases.size(); ++a)
+        {
+            HString compName, portName;
+            int varId;
+            pSystem->getAliasHandler().getVariableFromAlias(aliases[a], compName, portName, varId);
+            if (varId >= 0)
+            {
+                AliasRecord alias;
+                alias.alias = addString(aliases[a]);
+                alias.component = addString(compName);
+                alias.port = addString(portName);
+                alias.variable = varId;
+                mAliases.push_back(alias);
+            }
+        }
+        record.aliases.count = uint32_t(mAliases.size()) - record.aliases.first;
+        mSystems[systemIndex] = record;
+
+        // Now add the sub systems
+        for (size_t c=0; c<subComponents.size(); ++c)
+        {
+            if (subComponents[c]->isComponentSystem())
+            {
+                const uint32_t subSystemIndex = addSystem(static_cast<ComponentSystem*>(subComponents[c]));
+                if (subSystemIndex == gNoIndex)
+                {
+                    return gNoIndex;
+                }
+                mComponents[record.components.first+c].subSystem = subSystemIndex;
+            }
+        }
+        return systemIndex;
+    }
+
+    //! @brief Writes the header and all tables to a file
+    bool write(const HString &rFilePath, FileHeader &rHeader)
+    {
+        vector<char> data(sizeof(FileHeader), 0);
+        appendTable(data, rHeader, StringTable, mStrings);
+        appendTable(data, rHeader, SystemTable, mSystems);
+        appendTable(data, rHeader, ComponentTable, mComponents);
+        appendTable(data, rHeader, ParameterTable, mParameters);
+        appendTable(data, rHeader, SystemParameterTable, mSystemParameters);
+        appendTable(data, rHeader, QuantityTable, mQuantities);
+        appendTable(data, rHeader, SystemPortTable, mSystemPorts);
+        appendTable(data, rHeader, ConnectionTable, mConnections);
+        appendTable(data, rHeader, AliasTable, mAliases);
+        appendTable(data, rHeader, SearchPathTable, mSearchPaths);
+        appendTable(data, rHeader, StringDataTable, mStringData);
+        memcpy(&data[0], &rHeader, sizeof(FileHeader));
+
+        ofstream file(rFilePath.c_str(), ios::out | ios::binary | ios::trunc);
+        if (!file.good())
+        {
+            return false;
+        }
+        file.write(&data[0], data.size());
+        file.close();
+        return !file.fail();
+    }
+
+private:
+    template<typename T>
+    void appendTable(vector<char> &rData, FileHeader &rHeader, const TableT t, const vector<T> &rRecords)
+    {
+        rData.resize((rData.size()+7)/8*8, 0);
+        rHeader.tables[t].offset = rData.size();
+        rHeader.tables[t].count = rRecords.size();
+        if (!rRecords.empty())
+        {
+            const char *pRecords = reinterpret_cast<const char*>(&rRecords[0]);
+            rData.insert(rData.end(), pRecords, pRecords+rRecords.size()*sizeof(T));
+        }
+    }
+
+    map<std::string, uint32_t> mStringIds;
+    vector<StringRecord> mStrings;
+    vector<char> mStringData;
+    vector<SystemRecord> mSystems;
+    vector<ComponentRecord> mComponents;
+    vector<ParameterRecord> mParameters;
+    vector<SystemParameterRecord> mSystemParameters;
+    vector<QuantityRecord> mQuantities;
+    vector<SystemPortRecord> mSystemPorts;
+    vector<ConnectionRecord> mConnections;
+    vector<AliasRecord> mAliases;
+    vector<uint32_t> mSearchPaths;
+};
+
+}
+
+
+//! @brief Check if a file path refers to a binary model file (has the .hmfb suffix)
+bool hopsan::isBinaryModelFilePath(const HString &rFilePath)
+{
+    const HString suffix = ".hmfb";
+    return (rFilePath.size() > suffix.size()) && (rFilePath.substr(rFilePath.size()-suffix.size()) == suffix);
+}
+
+
+//! @brief Saves a loaded model as a binary model file
+//! @details The model should have been loaded from a model file and not have been changed, the binary file is a snapshot of the
+//! loaded model and will replace the source file when loaded
+//! @param[in] rFilePath The binary model file to write
+//! @param[in] pRootSystem The loaded root system
+//! @param[in] rSourceFilePath The .hmf file the model was loaded from, used to detect when the binary file is out of date, may be empty
+//! @param[in] startTime The simulation start time from the model file
+//! @param[in] stopTime The simulation stop time from the model file
+//! @returns true if the file was written, else false
+bool hopsan::saveBinaryModelFile(const HString &rFilePath, ComponentSystem *pRootSystem, const HString &rSourceFilePath, const double startTime, const double stopTime)
+{
+    if (!pRootSystem)
+    {
+        return false;
+    }
+
+    BinaryModelFileWriter writer;
+    FileHeader header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, gMagic, sizeof(gMagic));
+    header.version = gFormatVersion;
+    header.startTime = startTime;
+    header.stopTime = stopTime;
+    header.sourceFilePath = writer.addString(rSourceFilePath);
+    header.coreVersion = writer.addString(HOPSANCOREVERSION);
+    if (!rSourceFilePath.empty() && !getFileInfo(rSourceFilePath, header.sourceFileSize, header.sourceFileModified))
+    {
+        pRootSystem->addWarningMessage("Could not find the source model file: "+rSourceFilePath+", the binary model file will never be considered out of date");
+    }
+
+    if (writer.addSystem(pRootSystem) == gNoIndex)
+    {
+        pRootSystem->addErrorMessage("Could not compile the model to a binary model file");
+        return false;
+    }
+    if (!writer.write(rFilePath, header))
+    {
+        pRootSystem->addErrorMessage("Could not write binary model file: "+rFilePath);
+        return false;
+    }
+    return true;
+}
+
+
+//! @brief Loads a binary model file
+//! @details The file is memory mapped and the components are created directly from its tables. If the binary file is out of date
+//! or could not be loaded, and the source .hmf file is available, the source file is loaded instead.
+//! @param[in] rFilePath The binary model file to load
+//! @param[in] pHopsanEssentials The HopsanEssentials instance used to create the components
+//! @param[out] rStartTime A reference to the starttime variable
+//! @param[out] rStopTime A reference to the stoptime variable
+//! @returns A pointer to the rootsystem of the loaded model, or 0 if loading failed
+ComponentSystem* hopsan::loadBinaryModelFile(const HString &rFilePath, HopsanEssentials *pHopsanEssentials, double &rStartTime, double &rStopTime)
+{
+    HopsanCoreMessageHandler *pMessageHandler = pHopsanEssentials->getCoreMessageHandler();
+    MappedFile file(rFilePath);
+    if (!file.data())
+    {
+        pMessageHandler->addErrorMessage("Could not open file: "+rFilePath);
+        return 0;
+    }
+    BinaryModelFileReader reader(file.data(), file.size());
+    if (!reader.readHeader())
+    {
+        pMessageHandler->addErrorMessage(rFilePath+" is not a valid binary model file, recompile the model");
+        return 0;
+    }
+
+    // Find the source file, either at its original location or next to the binary file
+    HString sourceFilePath = reader.string(reader.header().sourceFilePath);
+    int64_t sourceFileSize=0, sourceFileModified=0;
+    bool haveSourceFile = getFileInfo(sourceFilePath, sourceFileSize, sourceFileModified);
+    if (!haveSourceFile && !sourceFilePath.empty())
+    {
+        sourceFilePath = getDirectoryOfPath(rFilePath) + sourceFilePath.substr(getDirectoryOfPath(sourceFilePath).size());
+        haveSourceFile = getFileInfo(sourceFilePath, sourceFileSize, sourceFileModified);
+    }
+
+    bool isOutOfDate = (reader.string(reader.header().coreVersion) != HOPSANCOREVERSION);
+    if (haveSourceFile)
+    {
+        isOutOfDate = isOutOfDate || (sourceFileSize != reader.header().sourceFileSize) || (sourceFileModified != reader.header().sourceFileModified);
+    }
+    if (isOutOfDate && haveSourceFile)
+    {
+        pMessageHandler->addInfoMessage("The binary model file: "+rFilePath+" is out of date, loading: "+sourceFilePath+" instead");
+        return loadHopsanModelFile(sourceFilePath, pHopsanEssentials, rStartTime, rStopTime);
+    }
+    else if (isOutOfDate)
+    {
+        pMessageHandler->addWarningMessage("The binary model file: "+rFilePath+" was compiled with a different HopsanCore version");
+    }
+
+    ComponentSystem *pSystem = pHopsanEssentials->createComponentSystem();
+    pSystem->setName(reader.rootSystemName());
+    if (!reader.loadSystem(0, pSystem, pHopsanEssentials))
+    {
+        pHopsanEssentials->removeComponent(pSystem);
+        if (haveSourceFile)
+        {
+            pMessageHandler->addInfoMessage("Could not load the binary model file: "+rFilePath+", loading: "+sourceFilePath+" instead");
+            return loadHopsanModelFile(sourceFilePath, pHopsanEssentials, rStartTime, rStopTime);
+        }
+        pMessageHandler->addErrorMessage("Could not load the binary model file: "+rFilePath);
+        return 0;
+    }
+
+    rStartTime = reader.header().startTime;
+    rStopTime = reader.header().stopTime;
+    return pSystem;
+}
@@ -0,0 +1,69 @@
+/*-----------------------------------------------------------------------------
+
+ Copyright 2017 Hopsan Group
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+
+
+ The full license is available in the file LICENSE.
+ For details about the 'Hopsan Group' or information about Authors and
+ Contributors see the HOPSANGROUP and AUTHORS files that are located in
+ the Hopsan source code root directory.
+
+-----------------------------------------------------------------------------*/
+
+//!
+//! @file   CompiledModel.cpp
+//!
+//! @brief Contains the CompiledModel class, for model specific simulation schedules that are generated and compiled ahead of time
+//!
+//$Id$
+
+#include "CoreUtilities/CompiledModel.h"
+#include "ComponentSystem.h"
+
+using namespace hopsan;
+
+CompiledModel::~CompiledModel()
+{
+    // Nothing to do
+}
+
+
+//! @brief Returns the path that identifies a component in a compiled model
+//! @param[in] pComponent The component
+//! @returns The names of the subsystems from the top-level system down to the component, and the name of the component, separated by '/'
+HString hopsan::getCompiledModelComponentPath(const Component *pComponent)
+{
+    HString componentPath = pComponent->getName();
+    for (const ComponentSystem *pParent = pComponent->getSystemParent(); pParent && !pParent->isTopLevelSystem(); pParent = pParent->getSystemParent())
+    {
+        componentPath = pParent->getName()+"/"+componentPath;
+    }
+    return componentPath;
+}
+
+
+//! @brief Check if a component has the path and type name that a compiled model was generated for
+//! @param[in] pComponent The component to check
+//! @param[in] path The path of the component, see getCompiledModelComponentPath()
+//! @param[in] typeName The type name of the component
+//! @returns true if the component matches, else false
+bool hopsan::isCompiledModelComponent(const Component *pComponent, const char *path, const char *typeName)
+{
+    if (!pComponent || (pComponent->getTypeName() != typeName))
+    {
+        return false;
+    }
+    return getCompiledModelComponentPath(pComponent) == path;
+}
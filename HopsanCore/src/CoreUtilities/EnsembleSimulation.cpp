@@ -0,0 +1,446 @@
+/*-----------------------------------------------------------------------------
+
+ Copyright 2017 Hopsan Group
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+
+
+ The full license is available in the file LICENSE.
+ For details about the 'Hopsan Group' or information about Authors and
+ Contributors see the HOPSANGROUP and AUTHORS files that are located in
+ the Hopsan source code root directory.
+
+-----------------------------------------------------------------------------*/
+
+//!
+//! @file   EnsembleSimulation.cpp
+//!
+//! @brief Contains the EnsembleSimulation class, for lockstep simulation of several variants of the same model
+//!
+//$Id$
+
+#include "CoreUtilities/EnsembleSimulation.h"
+#include "ComponentSystem.h"
+#include "Port.h"
+#include "Node.h"
+#include <map>
+#include <algorithm>
+
+using namespace hopsan;
+using namespace std;
+
+//! @brief Constructor
+//! @param [in] rLanes The top-level systems to simulate together, they must be structurally identical
+EnsembleSimulation::EnsembleSimulation(const std::vector<ComponentSystem*> &rLanes)
+{
+    mLanes = rLanes;
+    mLaneGroupSize = 8;
+    mHasMovedNodeData = false;
+    mIsInitialized = false;
+}
+
+EnsembleSimulation::~EnsembleSimulation()
+{
+    restoreNodeData();
+}
+
+//! @brief Moves the node data of all lanes into the ensemble arena and initializes the lanes
+//! @details The lanes must be loaded and ready for simulation, but not initialized
+//! @param [in] startT Start time
+//! @param [in] stopT Stop time
+//! @returns true if the lanes are identical and could be initialized, else false
+bool EnsembleSimulation::initialize(const double startT, const double stopT)
+{
+    restoreNodeData();
+    if (mLanes.empty())
+    {
+        return false;
+    }
+
+    for (size_t l=0; l<mLanes.size(); ++l)
+    {
+        if (!mLanes[l]->checkModelBeforeSimulation())
+        {
+            return false;
+        }
+    }
+
+    if (!matchNodes())
+    {
+        return false;
+    }
+
+    // Node data is moved into the ensemble arena before the lanes are initialized, so that the components
+    // fetch node data pointers into the arena. The lanes must not pack their own arena on top of it.
+    // The data of each lane group is kept together, since groups are simulated one at a time
+    const size_t nLanes = mLanes.size();
+    const size_t nSlots = mLaneNodes.size()/nLanes;
+    const size_t groupSize = getLaneGroupSize();
+    vector<size_t> offsets(mLaneNodes.size());
+    size_t arenaSize=0;
+    for (size_t g=0; g<nLanes; g+=groupSize)
+    {
+        for (size_t n=0; n<nSlots; ++n)
+        {
+            for (size_t l=g; l<min(g+groupSize, nLanes); ++l)
+            {
+                offsets[n*nLanes+l] = arenaSize;
+                arenaSize += mLaneNodes[n*nLanes+l]->getNumDataVariables();
+            }
+        }
+    }
+    try
+    {
+        mNodeDataArena.assign(arenaSize, 0.0);
+    }
+    catch (exception &e)
+    {
+        mLanes[0]->addErrorMessage("Failed to allocate the ensemble node data arena");
+        mLaneNodes.clear();
+        return false;
+    }
+    mLanesUsedNodeDataArena.resize(nLanes);
+    mLanesUsedHierarchyFlattening.resize(nLanes);
+    for (size_t l=0; l<nLanes; ++l)
+    {
+        mLanesUsedNodeDataArena[l] = mLanes[l]->mUseNodeDataArena;
+        mLanes[l]->mUseNodeDataArena = false;
+        // Components are matched between the lanes by name, so the lanes must keep their hierarchical schedule
+        mLanesUsedHierarchyFlattening[l] = mLanes[l]->mUseHierarchyFlattening;
+        mLanes[l]->mUseHierarchyFlattening = false;
+    }
+    for (size_t n=0; n<mLaneNodes.size(); ++n)
+    {
+        mLaneNodes[n]->moveDataValuesTo(mNodeDataArena.data()+offsets[n]);
+    }
+    mHasMovedNodeData = true;
+
+    for (size_t l=0; l<nLanes; ++l)
+    {
+        if (!mLanes[l]->initialize(startT, stopT))
+        {
+            return false;
+        }
+        // Initialization must not add nodes, they would not be part of the arena
+        for (size_t n=0; n<mLanes[l]->mSubNodePtrs.size(); ++n)
+        {
+            if (!mLanes[l]->mSubNodePtrs[n]->hasExternalDataValuesStorage())
+            {
+                mLanes[l]->addErrorMessage("Nodes were added during initialization, ensemble simulation is not possible");
+                return false;
+            }
+        }
+    }
+
+    // The ensemble may only be simulated if every lane could be initialized and the components match
+    mIsInitialized = matchComponents();
+    return mIsInitialized;
+}
+
+//! @brief Simulates all lanes from the current time to stopT
+//! @param [in] stopT Stop time
+//! @returns false if the ensemble is not initialized or if the simulation was aborted in any lane, else true
+bool EnsembleSimulation::simulate(const double stopT)
+{
+    if (!mIsInitialized)
+    {
+        return false;
+    }
+
+    const size_t nLanes = mLanes.size();
+    const size_t nSlots = mUseEnsembleSimulation.size();
+    const size_t groupSize = getLaneGroupSize();
+
+    // Each group of lanes is simulated all the way to the stop time before moving on to the next group,
+    // this keeps the data of the group in cache
+    bool aborted = false;
+    for (size_t g=0; (g<nLanes) && !aborted; g+=groupSize)
+    {
+        const size_t nGroupLanes = min(groupSize, nLanes-g);
+        ComponentSystem *const *ppGroupLanes = &mLanes[g];
+        const size_t numSimulationSteps = ppGroupLanes[0]->calcNumSimSteps(ppGroupLanes[0]->mTime, stopT);
+        for (size_t i=0; i<numSimulationSteps; ++i)
+        {
+            for (size_t l=0; l<nGroupLanes; ++l)
+            {
+                aborted = aborted || ppGroupLanes[l]->mStopSimulation;
+            }
+            if (aborted)
+            {
+                break;
+            }
+
+            for (size_t l=0; l<nGroupLanes; ++l)
+            {
+                ppGroupLanes[l]->mTime += ppGroupLanes[l]->mTimestep;
+            }
+
+            for (size_t s=0; s<nSlots; ++s)
+            {
+                Component *const *ppLanes = &mLaneComponents[s*nLanes+g];
+                if (mUseEnsembleSimulation[s])
+                {
+                    ppLanes[0]->simulateEnsemble(ppLanes, nGroupLanes, ppGroupLanes[0]->mTime);
+                }
+                else
+                {
+                    for (size_t l=0; l<nGroupLanes; ++l)
+                    {
+                        ppLanes[l]->simulate(ppGroupLanes[l]->mTime);
+                    }
+                }
+            }
+
+            for (size_t l=0; l<nGroupLanes; ++l)
+            {
+                ++ppGroupLanes[l]->mTotalTakenSimulationSteps;
+                ppGroupLanes[l]->logTimeAndNodes(ppGroupLanes[l]->mTotalTakenSimulationSteps);
+            }
+        }
+    }
+
+    return !aborted;
+}
+
+//! @brief Finalizes the lanes and moves the node data back into each node
+void EnsembleSimulation::finalize()
+{
+    // The lanes are finalized even if initialization failed part way, as some of them may have been initialized
+    if (mHasMovedNodeData)
+    {
+        for (size_t l=0; l<mLanes.size(); ++l)
+        {
+            mLanes[l]->finalize();
+        }
+    }
+    restoreNodeData();
+}
+
+//! @brief Set how many lanes are simulated together in lockstep
+//! @details Lanes are simulated in groups, where each group is simulated from the current time to the stop time before the next group.
+//! Large groups do not fit in cache, which costs more than what is gained from processing many lanes at once.
+//! Must be set before initialize()
+//! @param [in] lanesPerGroup The number of lanes in each group, 0 simulates all lanes together
+void EnsembleSimulation::setLaneGroupSize(const size_t lanesPerGroup)
+{
+    mLaneGroupSize = lanesPerGroup;
+}
+
+//! @brief Returns the number of lanes that are simulated together in lockstep, see setLaneGroupSize()
+size_t EnsembleSimulation::getLaneGroupSize() const
+{
+    if ((mLaneGroupSize == 0) || (mLaneGroupSize > mLanes.size()))
+    {
+        return mLanes.size();
+    }
+    return mLaneGroupSize;
+}
+
+//! @brief Returns the number of lanes (models) in the ensemble
+size_t EnsembleSimulation::getNumLanes() const
+{
+    return mLanes.size();
+}
+
+//! @brief Returns the number of components (per lane) that are simulated with simulateOneTimestepEnsemble()
+size_t EnsembleSimulation::getNumEnsembleComponents() const
+{
+    size_t n=0;
+    for (size_t s=0; s<mUseEnsembleSimulation.size(); ++s)
+    {
+        if (mUseEnsembleSimulation[s])
+        {
+            ++n;
+        }
+    }
+    return n;
+}
+
+//! @brief Returns the number of components (per lane) that are simulated one lane at a time
+size_t EnsembleSimulation::getNumFallbackComponents() const
+{
+    return mUseEnsembleSimulation.size() - getNumEnsembleComponents();
+}
+
+//! @brief Finds the corresponding top-level node in each lane, by the component, port and sub port it is connected to
+//! @returns true if every node in the first lane has a unique counterpart in all other lanes, else false
+bool EnsembleSimulation::matchNodes()
+{
+    const size_t nLanes = mLanes.size();
+    ComponentSystem *pFirstLane = mLanes[0];
+    mLaneNodes.clear();
+
+    // The node in each lane, mLaneNodes is only set if all lanes match
+    vector<Node*> allLaneNodes;
+    map<Node*, size_t> nodeSlots;
+    vector<Node*> firstLaneNodes;
+    const vector<Component*> *componentVectors[3] = {&pFirstLane->mComponentSignalptrs, &pFirstLane->mComponentCptrs, &pFirstLane->mComponentQptrs};
+
+    // First pass numbers the nodes of the first lane, in component order for locality, the following passes pick the counterparts
+    vector<Node*> laneNodes;
+    for (size_t l=0; l<nLanes; ++l)
+    {
+        if (l > 0)
+        {
+            laneNodes.assign(firstLaneNodes.size(), 0);
+        }
+        if (mLanes[l]->mSubNodePtrs.size() != pFirstLane->mSubNodePtrs.size())
+        {
+            mLanes[l]->addErrorMessage("The number of nodes differs between the ensemble lanes");
+            return false;
+        }
+
+        for (size_t v=0; v<3; ++v)
+        {
+            for (size_t c=0; c<componentVectors[v]->size(); ++c)
+            {
+                Component *pFirstComponent = componentVectors[v]->at(c);
+                Component *pComponent = mLanes[l]->getSubComponent(pFirstComponent->getName());
+                if (!pComponent || (pComponent->getTypeName() != pFirstComponent->getTypeName()))
+                {
+                    mLanes[l]->addErrorMessage("Component "+pFirstComponent->getName()+" differs between the ensemble lanes");
+                    return false;
+                }
+
+                vector<Port*> firstPorts = pFirstComponent->getPortPtrVector();
+                for (size_t p=0; p<firstPorts.size(); ++p)
+                {
+                    Port *pPort = pComponent->getPort(firstPorts[p]->getName());
+                    if (!pPort || (pPort->getNumPorts() != firstPorts[p]->getNumPorts()))
+                    {
+                        mLanes[l]->addErrorMessage("Port "+pFirstComponent->getName()+"::"+firstPorts[p]->getName()+" differs between the ensemble lanes");
+                        return false;
+                    }
+                    for (size_t sp=0; sp<firstPorts[p]->getNumPorts(); ++sp)
+                    {
+                        Node *pFirstNode = firstPorts[p]->getNodePtr(sp);
+                        if (!pFirstNode || (pFirstNode->getOwnerSystem() != pFirstLane))
+                        {
+                            continue;
+                        }
+                        if (l == 0)
+                        {
+                            if (nodeSlots.insert(pair<Node*, size_t>(pFirstNode, firstLaneNodes.size())).second)
+                            {
+                                firstLaneNodes.push_back(pFirstNode);
+                            }
+                            continue;
+                        }
+
+                        Node *pNode = pPort->getNodePtr(sp);
+                        Node *&rSlotNode = laneNodes[nodeSlots[pFirstNode]];
+                        if (!pNode || (pNode->getOwnerSystem() != mLanes[l]) || (pNode->getNodeType() != pFirstNode->getNodeType()) ||
+                            (rSlotNode && (rSlotNode != pNode)))
+                        {
+                            mLanes[l]->addErrorMessage("Connections of "+pFirstComponent->getName()+"::"+firstPorts[p]->getName()+" differ between the ensemble lanes");
+                            return false;
+                        }
+                        rSlotNode = pNode;
+                    }
+                }
+            }
+        }
+
+        if (l == 0)
+        {
+            allLaneNodes.resize(firstLaneNodes.size()*nLanes);
+            laneNodes = firstLaneNodes;
+        }
+        for (size_t n=0; n<laneNodes.size(); ++n)
+        {
+            allLaneNodes[n*nLanes+l] = laneNodes[n];
+        }
+    }
+
+    // Nodes that are not connected to any component (only system ports) can not be matched
+    if (firstLaneNodes.size() != pFirstLane->mSubNodePtrs.size())
+    {
+        pFirstLane->addErrorMessage("Ensemble simulation requires that all nodes are connected to components");
+        return false;
+    }
+    mLaneNodes.swap(allLaneNodes);
+    return true;
+}
+
+//! @brief Collects the corresponding (initialized and sorted) component in each lane, in the execution order of the first lane
+//! @returns true if all lanes have the same components, else false
+bool EnsembleSimulation::matchComponents()
+{
+    const size_t nLanes = mLanes.size();
+    ComponentSystem *pFirstLane = mLanes[0];
+    mLaneComponents.clear();
+    mUseEnsembleSimulation.clear();
+
+    const vector<Component*> *componentVectors[3] = {&pFirstLane->mComponentSignalptrs, &pFirstLane->mComponentCptrs, &pFirstLane->mComponentQptrs};
+    for (size_t v=0; v<3; ++v)
+    {
+        for (size_t c=0; c<componentVectors[v]->size(); ++c)
+        {
+            Component *pFirstComponent = componentVectors[v]->at(c);
+            bool sameTimestep = true;
+            for (size_t l=0; l<nLanes; ++l)
+            {
+                Component *pComponent = mLanes[l]->getSubComponent(pFirstComponent->getName());
+                if (!pComponent || pComponent->isDisabled() || (pComponent->getTypeCQS() != pFirstComponent->getTypeCQS()))
+                {
+                    mLanes[l]->addErrorMessage("Component "+pFirstComponent->getName()+" differs between the ensemble lanes");
+                    mLaneComponents.clear();
+                    mUseEnsembleSimulation.clear();
+                    return false;
+                }
+                sameTimestep = sameTimestep && (pComponent->getTimestep() == pFirstComponent->getTimestep());
+                mLaneComponents.push_back(pComponent);
+            }
+            mUseEnsembleSimulation.push_back(pFirstComponent->hasEnsembleSimulation() && sameTimestep);
+        }
+    }
+
+    size_t nLaneComponents = 0;
+    for (size_t l=0; l<nLanes; ++l)
+    {
+        nLaneComponents += mLanes[l]->mComponentSignalptrs.size() + mLanes[l]->mComponentCptrs.size() + mLanes[l]->mComponentQptrs.size();
+    }
+    if (nLaneComponents != mLaneComponents.size())
+    {
+        pFirstLane->addErrorMessage("The number of components differs between the ensemble lanes");
+        mLaneComponents.clear();
+        mUseEnsembleSimulation.clear();
+        return false;
+    }
+    return true;
+}
+
+//! @brief Moves the node data back into each node and releases the arena
+void EnsembleSimulation::restoreNodeData()
+{
+    for (size_t n=0; n<mLaneNodes.size(); ++n)
+    {
+        mLaneNodes[n]->restoreDataValuesStorage();
+    }
+    for (size_t l=0; l<mLanesUsedNodeDataArena.size(); ++l)
+    {
+        mLanes[l]->mUseNodeDataArena = mLanesUsedNodeDataArena[l];
+    }
+    for (size_t l=0; l<mLanesUsedHierarchyFlattening.size(); ++l)
+    {
+        mLanes[l]->mUseHierarchyFlattening = mLanesUsedHierarchyFlattening[l];
+    }
+    mLanesUsedNodeDataArena.clear();
+    mLanesUsedHierarchyFlattening.clear();
+    mLaneNodes.clear();
+    vector<double>().swap(mNodeDataArena);
+    mLaneComponents.clear();
+    mUseEnsembleSimulation.clear();
+    mHasMovedNodeData = false;
+    mIsInitialized = false;
+}
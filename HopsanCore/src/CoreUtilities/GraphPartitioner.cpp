@@ -0,0 +1,806 @@
+/*-----------------------------------------------------------------------------
+
+ Copyright 2017 Hopsan Group
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+
+
+ The full license is available in the file LICENSE.
+ For details about the 'Hopsan Group' or information about Authors and
+ Contributors see the HOPSANGROUP and AUTHORS files that are located in
+ the Hopsan source code root directory.
+
+-----------------------------------------------------------------------------*/
+
+//$Id$
+
+#include "CoreUtilities/GraphPartitioner.h"
+
+#include <algorithm>
+#include <cmath>
+#include <deque>
+#include <limits>
+#include <queue>
+#include <utility>
+
+using namespace std;
+using namespace hopsan;
+
+namespace {
+
+const size_t npos = std::numeric_limits<size_t>::max();
+
+// Graphs with at most this many vertices are bisected directly, larger graphs are coarsened first
+const size_t coarsenToVertices = 64;
+// Coarsening stops if a level does not remove at least this fraction of the vertices
+const double minCoarseningReduction = 0.05;
+// The number of seed vertices tried by the initial bisection
+const size_t numInitialBisectionTries = 6;
+// The maximum number of refinement passes on each level
+const size_t maxRefinementPasses = 8;
+// A refinement pass is aborted after this many moves without finding a better bisection
+const size_t maxMovesWithoutImprovement = 100;
+
+//! @brief Undirected graph in compressed form, the neighbours of vertex v are mAdjacency[mAdjacencyStart[v]] to mAdjacency[mAdjacencyStart[v+1]-1]
+class CompressedGraph
+{
+public:
+    size_t getNumVertices() const
+    {
+        return mAdjacencyStart.empty() ? 0 : mAdjacencyStart.size()-1;
+    }
+
+    const double *getVertexWeights(const size_t v) const
+    {
+        return &mVertexWeights[v*mnConstraints];
+    }
+
+    size_t mnConstraints;
+    std::vector<size_t> mAdjacencyStart;
+    std::vector<size_t> mAdjacency;
+    std::vector<double> mEdgeWeights;
+    std::vector<double> mVertexWeights;
+};
+
+//! @brief Simple deterministic pseudo random number generator, so that the same graph always gives the same partitioning
+size_t nextRandom(unsigned long long &rSeed, const size_t range)
+{
+    rSeed = rSeed*6364136223846793005ULL + 1442695040888963407ULL;
+    return size_t((rSeed >> 33) % range);
+}
+
+void randomPermutation(const size_t n, unsigned long long &rSeed, std::vector<size_t> &rOrder)
+{
+    rOrder.resize(n);
+    for (size_t i=0; i<n; ++i)
+    {
+        rOrder[i] = i;
+    }
+    for (size_t i=n; i>1; --i)
+    {
+        std::swap(rOrder[i-1], rOrder[nextRandom(rSeed, i)]);
+    }
+}
+
+//! @brief The absolute target weight of each constraint in each side of a bisection, and the allowed load factor
+class BisectionTargets
+{
+public:
+    BisectionTargets(const CompressedGraph &rGraph, const double fractionInFirst, const double maxLoad)
+    {
+        mnConstraints = rGraph.mnConstraints;
+        mMaxLoad = maxLoad;
+        std::vector<double> totals(mnConstraints, 0.0);
+        for (size_t v=0; v<rGraph.getNumVertices(); ++v)
+        {
+            for (size_t c=0; c<mnConstraints; ++c)
+            {
+                totals[c] += rGraph.getVertexWeights(v)[c];
+            }
+        }
+        mTargets.resize(2*mnConstraints);
+        for (size_t c=0; c<mnConstraints; ++c)
+        {
+            mTargets[c] = totals[c]*fractionInFirst;
+            mTargets[mnConstraints+c] = totals[c]*(1.0-fractionInFirst);
+        }
+    }
+
+    //! @brief Returns the largest ratio between the weight and the target weight for any side and constraint
+    double calcLoad(const std::vector<double> &rSideWeights) const
+    {
+        double load = 0;
+        for (size_t i=0; i<mTargets.size(); ++i)
+        {
+            if (mTargets[i] > 0)
+            {
+                load = std::max(load, rSideWeights[i]/mTargets[i]);
+            }
+            else if (rSideWeights[i] > 0)
+            {
+                load = std::max(load, std::numeric_limits<double>::max());
+            }
+        }
+        return load;
+    }
+
+    //! @brief Returns true if a bisection with the first load and cut is better than one with the second load and cut
+    //! @details Any load below the allowed maximum is considered equally good, then the cut decides
+    bool isBetter(const double loadA, const double cutA, const double loadB, const double cutB) const
+    {
+        const double effectiveLoadA = std::max(loadA, mMaxLoad);
+        const double effectiveLoadB = std::max(loadB, mMaxLoad);
+        if (effectiveLoadA < effectiveLoadB*(1.0-1e-12))
+        {
+            return true;
+        }
+        if (effectiveLoadA > effectiveLoadB*(1.0+1e-12))
+        {
+            return false;
+        }
+        return cutA < cutB-1e-12;
+    }
+
+    size_t mnConstraints;
+    double mMaxLoad;
+    std::vector<double> mTargets;
+};
+
+void calcSideWeights(const CompressedGraph &rGraph, const std::vector<unsigned char> &rSide, std::vector<double> &rSideWeights)
+{
+    const size_t nCon = rGraph.mnConstraints;
+    rSideWeights.assign(2*nCon, 0.0);
+    for (size_t v=0; v<rGraph.getNumVertices(); ++v)
+    {
+        for (size_t c=0; c<nCon; ++c)
+        {
+            rSideWeights[rSide[v]*nCon+c] += rGraph.getVertexWeights(v)[c];
+        }
+    }
+}
+
+double calcCut(const CompressedGraph &rGraph, const std::vector<unsigned char> &rSide)
+{
+    double cut = 0;
+    for (size_t v=0; v<rGraph.getNumVertices(); ++v)
+    {
+        for (size_t e=rGraph.mAdjacencyStart[v]; e<rGraph.mAdjacencyStart[v+1]; ++e)
+        {
+            if (rSide[v] != rSide[rGraph.mAdjacency[e]])
+            {
+                cut += rGraph.mEdgeWeights[e];
+            }
+        }
+    }
+    return cut/2.0;
+}
+
+void moveVertexWeights(const CompressedGraph &rGraph, const size_t v, const unsigned char fromSide, std::vector<double> &rSideWeights)
+{
+    const size_t nCon = rGraph.mnConstraints;
+    const unsigned char toSide = 1-fromSide;
+    for (size_t c=0; c<nCon; ++c)
+    {
+        rSideWeights[fromSide*nCon+c] -= rGraph.getVertexWeights(v)[c];
+        rSideWeights[toSide*nCon+c] += rGraph.getVertexWeights(v)[c];
+    }
+}
+
+//! @brief Improve a bisection with Fiduccia-Mattheyses passes
+//! @details In each pass vertices are moved one at a time to the other side, choosing the move that decreases the cut
+//! the most without violating the balance, even if the cut increases. The best bisection seen during the pass is kept.
+void refineBisection(const CompressedGraph &rGraph, const BisectionTargets &rTargets, std::vector<unsigned char> &rSide)
+{
+    typedef std::pair<double, size_t> GainEntryT;
+
+    const size_t n = rGraph.getNumVertices();
+    std::vector<double> gains(n);
+    std::vector<unsigned char> locked(n);
+    std::vector<size_t> moves;
+    std::vector<double> sideWeights, movedSideWeights;
+
+    for (size_t pass=0; pass<maxRefinementPasses; ++pass)
+    {
+        calcSideWeights(rGraph, rSide, sideWeights);
+        double load = rTargets.calcLoad(sideWeights);
+        double cut = calcCut(rGraph, rSide);
+
+        std::priority_queue<GainEntryT> queues[2];
+        for (size_t v=0; v<n; ++v)
+        {
+            double gain = 0;
+            for (size_t e=rGraph.mAdjacencyStart[v]; e<rGraph.mAdjacencyStart[v+1]; ++e)
+            {
+                gain += (rSide[v] != rSide[rGraph.mAdjacency[e]]) ? rGraph.mEdgeWeights[e] : -rGraph.mEdgeWeights[e];
+            }
+            gains[v] = gain;
+            locked[v] = 0;
+            queues[rSide[v]].push(GainEntryT(gain, v));
+        }
+
+        moves.clear();
+        double bestLoad = load;
+        double bestCut = cut;
+        size_t nBestMoves = 0;
+
+        while (moves.size() < nBestMoves+maxMovesWithoutImprovement)
+        {
+            // Find the best move from each side that does not violate (or reduces the violation of) the balance
+            size_t candidates[2] = {npos, npos};
+            double candidateLoads[2] = {0, 0};
+            for (unsigned char s=0; s<2; ++s)
+            {
+                while (!queues[s].empty())
+                {
+                    const GainEntryT top = queues[s].top();
+                    const size_t v = top.second;
+                    if (locked[v] || rSide[v] != s || top.first != gains[v])
+                    {
+                        queues[s].pop();    // Outdated entry
+                        continue;
+                    }
+                    movedSideWeights = sideWeights;
+                    moveVertexWeights(rGraph, v, s, movedSideWeights);
+                    const double movedLoad = rTargets.calcLoad(movedSideWeights);
+                    if (movedLoad <= rTargets.mMaxLoad || movedLoad < load)
+                    {
+                        candidates[s] = v;
+                        candidateLoads[s] = movedLoad;
+                        break;
+                    }
+                    queues[s].pop();        // The move is not allowed in this pass
+                }
+            }
+            if (candidates[0] == npos && candidates[1] == npos)
+            {
+                break;
+            }
+            unsigned char s = (candidates[0] == npos) ? 1 : 0;
+            if (candidates[0] != npos && candidates[1] != npos)
+            {
+                if ( (gains[candidates[1]] > gains[candidates[0]]) ||
+                     ((gains[candidates[1]] == gains[candidates[0]]) && (candidateLoads[1] < candidateLoads[0])) )
+                {
+                    s = 1;
+                }
+            }
+
+            // Move the vertex and update the gains of its neighbours
+            const size_t v = candidates[s];
+            queues[s].pop();
+            moveVertexWeights(rGraph, v, s, sideWeights);
+            load = candidateLoads[s];
+            cut -= gains[v];
+            gains[v] = -gains[v];
+            rSide[v] = 1-s;
+            locked[v] = 1;
+            moves.push_back(v);
+            for (size_t e=rGraph.mAdjacencyStart[v]; e<rGraph.mAdjacencyStart[v+1]; ++e)
+            {
+                const size_t w = rGraph.mAdjacency[e];
+                if (!locked[w])
+                {
+                    gains[w] += (rSide[w] == rSide[v]) ? -2.0*rGraph.mEdgeWeights[e] : 2.0*rGraph.mEdgeWeights[e];
+                    queues[rSide[w]].push(GainEntryT(gains[w], w));
+                }
+            }
+
+            if (rTargets.isBetter(load, cut, bestLoad, bestCut))
+            {
+                bestLoad = load;
+                bestCut = cut;
+                nBestMoves = moves.size();
+            }
+        }
+
+        // Undo the moves made after the best bisection
+        for (size_t m=moves.size(); m>nBestMoves; --m)
+        {
+            rSide[moves[m-1]] = 1-rSide[moves[m-1]];
+        }
+        if (nBestMoves == 0)
+        {
+            break;
+        }
+    }
+}
+
+//! @brief Create a bisection by growing the first side from a seed vertex, adding the vertex with most connections to it first
+void growBisection(const CompressedGraph &rGraph, const BisectionTargets &rTargets, const size_t seedVertex, std::vector<unsigned char> &rSide)
+{
+    typedef std::pair<double, size_t> GainEntryT;
+
+    const size_t n = rGraph.getNumVertices();
+    const size_t nCon = rGraph.mnConstraints;
+    rSide.assign(n, 1);
+
+    // The fraction of all weight that the first side should get, using the average over the constraints
+    std::vector<double> normalization(nCon, 0.0);
+    double targetFraction = 0;
+    size_t nActiveConstraints = 0;
+    for (size_t c=0; c<nCon; ++c)
+    {
+        const double total = rTargets.mTargets[c]+rTargets.mTargets[nCon+c];
+        if (total > 0)
+        {
+            normalization[c] = 1.0/total;
+            targetFraction += rTargets.mTargets[c]/total;
+            ++nActiveConstraints;
+        }
+    }
+    if (nActiveConstraints == 0)
+    {
+        return;
+    }
+    targetFraction /= double(nActiveConstraints);
+
+    std::vector<double> gains(n);
+    for (size_t v=0; v<n; ++v)
+    {
+        gains[v] = 0;
+        for (size_t e=rGraph.mAdjacencyStart[v]; e<rGraph.mAdjacencyStart[v+1]; ++e)
+        {
+            gains[v] -= rGraph.mEdgeWeights[e];
+        }
+    }
+
+    std::priority_queue<GainEntryT> queue;
+    queue.push(GainEntryT(gains[seedVertex], seedVertex));
+    size_t nextUnconnected = 0;
+    double fraction = 0;
+    while (fraction < targetFraction)
+    {
+        // Take the best connected vertex, or any remaining vertex if the graph is not connected
+        size_t v = npos;
+        while (!queue.empty() && v == npos)
+        {
+            if (rSide[queue.top().second] == 1 && queue.top().first == gains[queue.top().second])
+            {
+                v = queue.top().second;
+            }
+            queue.pop();
+        }
+        while (v == npos && nextUnconnected < n)
+        {
+            if (rSide[nextUnconnected] == 1)
+            {
+                v = nextUnconnected;
+            }
+            ++nextUnconnected;
+        }
+        if (v == npos)
+        {
+            break;
+        }
+
+        double vertexFraction = 0;
+        for (size_t c=0; c<nCon; ++c)
+        {
+            vertexFraction += rGraph.getVertexWeights(v)[c]*normalization[c];
+        }
+        vertexFraction /= double(nActiveConstraints);
+        if ((fraction > 0) && (fraction+vertexFraction-targetFraction > targetFraction-fraction))
+        {
+            // Adding this vertex would overshoot the target more than stopping here
+            break;
+        }
+
+        rSide[v] = 0;
+        fraction += vertexFraction;
+        for (size_t e=rGraph.mAdjacencyStart[v]; e<rGraph.mAdjacencyStart[v+1]; ++e)
+        {
+            const size_t w = rGraph.mAdjacency[e];
+            if (rSide[w] == 1)
+            {
+                gains[w] += 2.0*rGraph.mEdgeWeights[e];
+                queue.push(GainEntryT(gains[w], w));
+            }
+        }
+    }
+}
+
+//! @brief Bisect a small graph by growing from a few different seed vertices and keeping the best refined result
+void initialBisection(const CompressedGraph &rGraph, const BisectionTargets &rTargets, unsigned long long &rSeed, std::vector<unsigned char> &rSide)
+{
+    const size_t n = rGraph.getNumVertices();
+    std::vector<unsigned char> side;
+    std::vector<double> sideWeights;
+    double bestLoad = std::numeric_limits<double>::max();
+    double bestCut = std::numeric_limits<double>::max();
+    const size_t nTries = std::min(n, numInitialBisectionTries);
+    for (size_t t=0; t<nTries; ++t)
+    {
+        growBisection(rGraph, rTargets, nextRandom(rSeed, n), side);
+        refineBisection(rGraph, rTargets, side);
+        calcSideWeights(rGraph, side, sideWeights);
+        const double load = rTargets.calcLoad(sideWeights);
+        const double cut = calcCut(rGraph, side);
+        if ((t == 0) || rTargets.isBetter(load, cut, bestLoad, bestCut))
+        {
+            bestLoad = load;
+            bestCut = cut;
+            rSide = side;
+        }
+    }
+}
+
+//! @brief Coarsen a graph by merging pairs of vertices connected by heavy edges
+//! @param[in] rFine The graph to coarsen
+//! @param[in] rMaxVertexWeights The maximum weight of each constraint for a merged vertex
+//! @param[in,out] rSeed The random seed used to decide the order that vertices are visited
+//! @param[out] rCoarse The coarsened graph
+//! @param[out] rCoarseVertex The vertex in the coarse graph that each vertex in the fine graph was merged into
+void coarsenGraph(const CompressedGraph &rFine, const std::vector<double> &rMaxVertexWeights, unsigned long long &rSeed, CompressedGraph &rCoarse, std::vector<size_t> &rCoarseVertex)
+{
+    const size_t n = rFine.getNumVertices();
+    const size_t nCon = rFine.mnConstraints;
+
+    std::vector<size_t> order;
+    randomPermutation(n, rSeed, order);
+    std::vector<size_t> match(n, npos);
+    for (size_t i=0; i<n; ++i)
+    {
+        const size_t u = order[i];
+        if (match[u] != npos)
+        {
+            continue;
+        }
+        size_t best = u;
+        double bestWeight = -1;
+        for (size_t e=rFine.mAdjacencyStart[u]; e<rFine.mAdjacencyStart[u+1]; ++e)
+        {
+            const size_t v = rFine.mAdjacency[e];
+            if (match[v] != npos || rFine.mEdgeWeights[e] <= bestWeight)
+            {
+                continue;
+            }
+            bool fits = true;
+            for (size_t c=0; c<nCon; ++c)
+            {
+                fits = fits && (rFine.getVertexWeights(u)[c]+rFine.getVertexWeights(v)[c] <= rMaxVertexWeights[c]);
+            }
+            if (fits)
+            {
+                best = v;
+                bestWeight = rFine.mEdgeWeights[e];
+            }
+        }
+        match[u] = best;
+        match[best] = u;
+    }
+
+    // Number the coarse vertices
+    rCoarseVertex.assign(n, npos);
+    std::vector<size_t> representatives;
+    for (size_t u=0; u<n; ++u)
+    {
+        if (rCoarseVertex[u] == npos)
+        {
+            rCoarseVertex[u] = representatives.size();
+            rCoarseVertex[match[u]] = representatives.size();
+            representatives.push_back(u);
+        }
+    }
+
+    // Merge the vertex weights and the edges of each pair
+    const size_t nCoarse = representatives.size();
+    rCoarse.mnConstraints = nCon;
+    rCoarse.mVertexWeights.assign(nCoarse*nCon, 0.0);
+    rCoarse.mAdjacencyStart.assign(1, 0);
+    rCoarse.mAdjacency.clear();
+    rCoarse.mEdgeWeights.clear();
+    std::vector<size_t> edgeSlot(nCoarse, npos);
+    for (size_t cu=0; cu<nCoarse; ++cu)
+    {
+        const size_t members[2] = {representatives[cu], match[representatives[cu]]};
+        const size_t nMembers = (members[0] == members[1]) ? 1 : 2;
+        for (size_t m=0; m<nMembers; ++m)
+        {
+            const size_t u = members[m];
+            for (size_t c=0; c<nCon; ++c)
+            {
+                rCoarse.mVertexWeights[cu*nCon+c] += rFine.getVertexWeights(u)[c];
+            }
+            for (size_t e=rFine.mAdjacencyStart[u]; e<rFine.mAdjacencyStart[u+1]; ++e)
+            {
+                const size_t cv = rCoarseVertex[rFine.mAdjacency[e]];
+                if (cv == cu)
+                {
+                    continue;
+                }
+                if (edgeSlot[cv] == npos)
+                {
+                    edgeSlot[cv] = rCoarse.mAdjacency.size();
+                    rCoarse.mAdjacency.push_back(cv);
+                    rCoarse.mEdgeWeights.push_back(rFine.mEdgeWeights[e]);
+                }
+                else
+                {
+                    rCoarse.mEdgeWeights[edgeSlot[cv]] += rFine.mEdgeWeights[e];
+                }
+            }
+        }
+        for (size_t e=rCoarse.mAdjacencyStart[cu]; e<rCoarse.mAdjacency.size(); ++e)
+        {
+            edgeSlot[rCoarse.mAdjacency[e]] = npos;
+        }
+        rCoarse.mAdjacencyStart.push_back(rCoarse.mAdjacency.size());
+    }
+}
+
+//! @brief Bisect a graph with the multilevel method: coarsen, bisect the coarsest graph and refine while uncoarsening
+void multilevelBisection(const CompressedGraph &rGraph, const double fractionInFirst, const double maxLoad, unsigned long long &rSeed, std::vector<unsigned char> &rSide)
+{
+    const size_t nCon = rGraph.mnConstraints;
+    std::vector<double> totals(nCon, 0.0);
+    for (size_t v=0; v<rGraph.getNumVertices(); ++v)
+    {
+        for (size_t c=0; c<nCon; ++c)
+        {
+            totals[c] += rGraph.getVertexWeights(v)[c];
+        }
+    }
+    // Merged vertices may not get so heavy that the coarsest graph can not be balanced
+    std::vector<double> maxVertexWeights(nCon);
+    for (size_t c=0; c<nCon; ++c)
+    {
+        maxVertexWeights[c] = 1.5*totals[c]/double(coarsenToVertices);
+    }
+
+    // A deque is used since references to its elements stay valid when adding levels
+    std::deque<CompressedGraph> levels;
+    std::deque< std::vector<size_t> > coarseVertices;
+    const CompressedGraph *pCurrent = &rGraph;
+    while (pCurrent->getNumVertices() > coarsenToVertices)
+    {
+        levels.push_back(CompressedGraph());
+        coarseVertices.push_back(std::vector<size_t>());
+        coarsenGraph(*pCurrent, maxVertexWeights, rSeed, levels.back(), coarseVertices.back());
+        if (double(levels.back().getNumVertices()) > (1.0-minCoarseningReduction)*double(pCurrent->getNumVertices()))
+        {
+            levels.pop_back();
+            coarseVertices.pop_back();
+            break;
+        }
+        pCurrent = &levels.back();
+    }
+
+    initialBisection(*pCurrent, BisectionTargets(*pCurrent, fractionInFirst, maxLoad), rSeed, rSide);
+
+    // Project the bisection back to each finer level and refine it there
+    std::vector<unsigned char> fineSide;
+    for (size_t l=levels.size(); l>0; --l)
+    {
+        const CompressedGraph &rFine = (l > 1) ? levels[l-2] : rGraph;
+        const std::vector<size_t> &rCoarseVertex = coarseVertices[l-1];
+        fineSide.resize(rFine.getNumVertices());
+        for (size_t v=0; v<rFine.getNumVertices(); ++v)
+        {
+            fineSide[v] = rSide[rCoarseVertex[v]];
+        }
+        rSide.swap(fineSide);
+        refineBisection(rFine, BisectionTargets(rFine, fractionInFirst, maxLoad), rSide);
+    }
+}
+
+//! @brief Extract the subgraph induced by the vertices on one side of a bisection
+void extractSubGraph(const CompressedGraph &rGraph, const std::vector<unsigned char> &rSide, const unsigned char side, CompressedGraph &rSubGraph, std::vector<size_t> &rSubVertices)
+{
+    const size_t n = rGraph.getNumVertices();
+    const size_t nCon = rGraph.mnConstraints;
+    std::vector<size_t> newIndex(n, npos);
+    rSubVertices.clear();
+    for (size_t v=0; v<n; ++v)
+    {
+        if (rSide[v] == side)
+        {
+            newIndex[v] = rSubVertices.size();
+            rSubVertices.push_back(v);
+        }
+    }
+
+    rSubGraph.mnConstraints = nCon;
+    rSubGraph.mAdjacencyStart.assign(1, 0);
+    rSubGraph.mAdjacency.clear();
+    rSubGraph.mEdgeWeights.clear();
+    rSubGraph.mVertexWeights.resize(rSubVertices.size()*nCon);
+    for (size_t i=0; i<rSubVertices.size(); ++i)
+    {
+        const size_t v = rSubVertices[i];
+        for (size_t c=0; c<nCon; ++c)
+        {
+            rSubGraph.mVertexWeights[i*nCon+c] = rGraph.getVertexWeights(v)[c];
+        }
+        for (size_t e=rGraph.mAdjacencyStart[v]; e<rGraph.mAdjacencyStart[v+1]; ++e)
+        {
+            if (newIndex[rGraph.mAdjacency[e]] != npos)
+            {
+                rSubGraph.mAdjacency.push_back(newIndex[rGraph.mAdjacency[e]]);
+                rSubGraph.mEdgeWeights.push_back(rGraph.mEdgeWeights[e]);
+            }
+        }
+        rSubGraph.mAdjacencyStart.push_back(rSubGraph.mAdjacency.size());
+    }
+}
+
+//! @brief Partition a graph into parts firstPart to firstPart+nParts-1 by recursive bisection
+void recursivePartition(const CompressedGraph &rGraph, const std::vector<size_t> &rVertexIds, const size_t nParts, const size_t firstPart,
+                        const double maxLoad, unsigned long long &rSeed, std::vector<size_t> &rPartOfVertex)
+{
+    const size_t n = rGraph.getNumVertices();
+    if (nParts < 2 || n == 0)
+    {
+        for (size_t v=0; v<n; ++v)
+        {
+            rPartOfVertex[rVertexIds[v]] = firstPart;
+        }
+        return;
+    }
+
+    const size_t nPartsInFirst = nParts/2;
+    std::vector<unsigned char> side;
+    multilevelBisection(rGraph, double(nPartsInFirst)/double(nParts), maxLoad, rSeed, side);
+
+    for (unsigned char s=0; s<2; ++s)
+    {
+        CompressedGraph subGraph;
+        std::vector<size_t> subVertices;
+        extractSubGraph(rGraph, side, s, subGraph, subVertices);
+        for (size_t i=0; i<subVertices.size(); ++i)
+        {
+            subVertices[i] = rVertexIds[subVertices[i]];
+        }
+        if (s == 0)
+        {
+            recursivePartition(subGraph, subVertices, nPartsInFirst, firstPart, maxLoad, rSeed, rPartOfVertex);
+        }
+        else
+        {
+            recursivePartition(subGraph, subVertices, nParts-nPartsInFirst, firstPart+nPartsInFirst, maxLoad, rSeed, rPartOfVertex);
+        }
+    }
+}
+
+}
+
+
+//! @brief Constructor
+//! @param[in] nVertices The number of vertices in the graph
+//! @param[in] nConstraints The number of weights for each vertex, each one is balanced individually
+GraphPartitioner::GraphPartitioner(const size_t nVertices, const size_t nConstraints) :
+    mnVertices(nVertices),
+    mnConstraints(std::max(nConstraints, size_t(1))),
+    mImbalanceTolerance(0.05)
+{
+    mVertexWeights.assign(mnVertices*mnConstraints, 1.0);
+}
+
+//! @brief Set one of the weights of a vertex, all weights are 1 by default
+void GraphPartitioner::setVertexWeight(const size_t vertex, const size_t constraint, const double weight)
+{
+    mVertexWeights[vertex*mnConstraints+constraint] = std::max(weight, 0.0);
+}
+
+//! @brief Add an edge between two vertices, if the edge is added more than once the weights are added together
+void GraphPartitioner::addEdge(const size_t vertexA, const size_t vertexB, const double weight)
+{
+    if (vertexA != vertexB)
+    {
+        mEdgeVerticesA.push_back(vertexA);
+        mEdgeVerticesB.push_back(vertexB);
+        mEdgeWeights.push_back(weight);
+    }
+}
+
+//! @brief Set how much heavier than an equal share a part may become, 0.05 means five percent (default)
+void GraphPartitioner::setImbalanceTolerance(const double tolerance)
+{
+    mImbalanceTolerance = std::max(tolerance, 0.0);
+}
+
+//! @brief Partition the graph
+//! @details If the balance constraint can not be met, the most balanced partitioning found is used
+//! @param[in] nParts The number of parts
+//! @param[out] rPartOfVertex The part (0 to nParts-1) of each vertex
+void GraphPartitioner::partition(const size_t nParts, std::vector<size_t> &rPartOfVertex) const
+{
+    rPartOfVertex.assign(mnVertices, 0);
+    if (nParts < 2 || mnVertices == 0)
+    {
+        return;
+    }
+
+    // Build the compressed graph, with duplicate edges merged
+    std::vector< std::vector< std::pair<size_t, double> > > neighbours(mnVertices);
+    for (size_t e=0; e<mEdgeWeights.size(); ++e)
+    {
+        neighbours[mEdgeVerticesA[e]].push_back(std::pair<size_t, double>(mEdgeVerticesB[e], mEdgeWeights[e]));
+        neighbours[mEdgeVerticesB[e]].push_back(std::pair<size_t, double>(mEdgeVerticesA[e], mEdgeWeights[e]));
+    }
+    CompressedGraph graph;
+    graph.mnConstraints = mnConstraints;
+    graph.mVertexWeights = mVertexWeights;
+    graph.mAdjacencyStart.push_back(0);
+    for (size_t v=0; v<mnVertices; ++v)
+    {
+        std::sort(neighbours[v].begin(), neighbours[v].end());
+        for (size_t i=0; i<neighbours[v].size(); ++i)
+        {
+            if (i > 0 && neighbours[v][i].first == neighbours[v][i-1].first)
+            {
+                graph.mEdgeWeights.back() += neighbours[v][i].second;
+            }
+            else
+            {
+                graph.mAdjacency.push_back(neighbours[v][i].first);
+                graph.mEdgeWeights.push_back(neighbours[v][i].second);
+            }
+        }
+        graph.mAdjacencyStart.push_back(graph.mAdjacency.size());
+    }
+
+    std::vector<size_t> vertexIds(mnVertices);
+    for (size_t v=0; v<mnVertices; ++v)
+    {
+        vertexIds[v] = v;
+    }
+
+    // Split the tolerance over the bisection levels, since the imbalance of each level is multiplied
+    const double nLevels = std::ceil(std::log(double(nParts))/std::log(2.0));
+    const double maxLoadPerLevel = std::pow(1.0+mImbalanceTolerance, 1.0/std::max(nLevels, 1.0));
+
+    unsigned long long seed = 4711;
+    recursivePartition(graph, vertexIds, nParts, 0, maxLoadPerLevel, seed, rPartOfVertex);
+}
+
+//! @brief Returns the total weight of the edges between vertices in different parts
+double GraphPartitioner::getCutWeight(const std::vector<size_t> &rPartOfVertex) const
+{
+    double cut = 0;
+    for (size_t e=0; e<mEdgeWeights.size(); ++e)
+    {
+        if (rPartOfVertex[mEdgeVerticesA[e]] != rPartOfVertex[mEdgeVerticesB[e]])
+        {
+            cut += mEdgeWeights[e];
+        }
+    }
+    return cut;
+}
+
+//! @brief Returns the largest ratio between the weight of a part and an equal share of the total weight, for any constraint
+//! @details A perfectly balanced partitioning gives 1.0
+double GraphPartitioner::getImbalance(const std::vector<size_t> &rPartOfVertex, const size_t nParts) const
+{
+    std::vector<double> totals(mnConstraints, 0.0);
+    std::vector<double> partWeights(nParts*mnConstraints, 0.0);
+    for (size_t v=0; v<mnVertices; ++v)
+    {
+        for (size_t c=0; c<mnConstraints; ++c)
+        {
+            totals[c] += mVertexWeights[v*mnConstraints+c];
+            partWeights[rPartOfVertex[v]*mnConstraints+c] += mVertexWeights[v*mnConstraints+c];
+        }
+    }
+    double imbalance = 1.0;
+    for (size_t p=0; p<nParts; ++p)
+    {
+        for (size_t c=0; c<mnConstraints; ++c)
+        {
+            if (totals[c] > 0)
+            {
+                imbalance = std::max(imbalance, partWeights[p*mnConstraints+c]*double(nParts)/totals[c]);
+            }
+        }
+    }
+    return imbalance;
+}
@@ -0,0 +1,196 @@
+/*-----------------------------------------------------------------------------
+
+ Copyright 2017 Hopsan Group
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+
+
+ The full license is available in the file LICENSE.
+ For details about the 'Hopsan Group' or information about Authors and
+ Contributors see the HOPSANGROUP and AUTHORS files that are located in
+ the Hopsan source code root directory.
+
+-----------------------------------------------------------------------------*/
+
+//$Id$
+
+#include "CoreUtilities/HardwareCounters.h"
+
+#if defined(__linux__)
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include <cerrno>
+#include <cstring>
+#endif
+
+using namespace hopsan;
+
+namespace {
+
+const char *counterNames[HardwareCounters::NumCounters] = {"Cycles", "Instructions", "LLC misses", "Branch misses"};
+
+#if defined(__linux__)
+const uint64_t counterConfigs[HardwareCounters::NumCounters] = {PERF_COUNT_HW_CPU_CYCLES, PERF_COUNT_HW_INSTRUCTIONS,
+                                                                PERF_COUNT_HW_CACHE_MISSES, PERF_COUNT_HW_BRANCH_MISSES};
+#endif
+
+}
+
+HardwareCounters::HardwareCounters()
+{
+    mGroupFd = -1;
+    mnOpen = 0;
+    for (size_t c=0; c<NumCounters; ++c)
+    {
+        mFds[c] = -1;
+        mReadIndex[c] = 0;
+    }
+}
+
+HardwareCounters::~HardwareCounters()
+{
+    close();
+}
+
+//! @brief Open and start the counters for the calling thread
+//! @details Counters that can not be opened are skipped, the reason for the first one is kept as error message
+//! @returns True if at least one counter could be opened
+bool HardwareCounters::open()
+{
+    close();
+#if defined(__linux__)
+    for (size_t c=0; c<NumCounters; ++c)
+    {
+        perf_event_attr attr;
+        memset(&attr, 0, sizeof(attr));
+        attr.type = PERF_TYPE_HARDWARE;
+        attr.size = sizeof(attr);
+        attr.config = counterConfigs[c];
+        attr.disabled = (mGroupFd < 0) ? 1 : 0;    // The group leader starts disabled, the others follow the leader
+        attr.exclude_kernel = 1;
+        attr.exclude_hv = 1;
+        attr.read_format = PERF_FORMAT_GROUP | PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+
+        // Count the calling thread on any CPU
+        const int fd = int(syscall(__NR_perf_event_open, &attr, 0, -1, mGroupFd, 0));
+        if (fd < 0)
+        {
+            if (mErrorMessage.empty())
+            {
+                mErrorMessage = HString("Could not open hardware counter ")+counterNames[c]+": "+strerror(errno);
+            }
+            continue;
+        }
+        if (mGroupFd < 0)
+        {
+            mGroupFd = fd;
+        }
+        mFds[c] = fd;
+        mReadIndex[c] = mnOpen++;
+    }
+
+    if (mGroupFd >= 0)
+    {
+        ioctl(mGroupFd, PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+        ioctl(mGroupFd, PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+    }
+#else
+    mErrorMessage = "Hardware counters are only supported on Linux";
+#endif
+    return isOpen();
+}
+
+//! @brief Stop and close all counters
+void HardwareCounters::close()
+{
+#if defined(__linux__)
+    for (size_t c=0; c<NumCounters; ++c)
+    {
+        if (mFds[c] >= 0 && mFds[c] != mGroupFd)
+        {
+            ::close(mFds[c]);
+        }
+    }
+    if (mGroupFd >= 0)
+    {
+        ::close(mGroupFd);
+    }
+#endif
+    mGroupFd = -1;
+    mnOpen = 0;
+    for (size_t c=0; c<NumCounters; ++c)
+    {
+        mFds[c] = -1;
+        mReadIndex[c] = 0;
+    }
+    mErrorMessage.clear();
+}
+
+//! @brief Returns true if at least one counter is open
+bool HardwareCounters::isOpen() const
+{
+    return mnOpen > 0;
+}
+
+//! @brief Returns true if the given counter is open
+bool HardwareCounters::isAvailable(const CounterT counter) const
+{
+    return mFds[counter] >= 0;
+}
+
+//! @brief Read the current value of all counters
+//! @details If there are more counters than the CPU can count at once, the kernel multiplexes them. The values are then
+//! scaled by the time that the group was enabled divided by the time that it was actually counting.
+//! @param[out] pValues Array of NumCounters values, unavailable counters are set to zero
+//! @returns True if the counters could be read, false if they have not been counting at all
+bool HardwareCounters::read(uint64_t *pValues) const
+{
+#if defined(__linux__)
+    // With PERF_FORMAT_GROUP the number of counters and the enabled and running times are followed by the value of each counter
+    // in the order they were opened
+    uint64_t buffer[3+NumCounters];
+    if (mGroupFd < 0 || ::read(mGroupFd, buffer, sizeof(buffer)) < ssize_t((3+mnOpen)*sizeof(uint64_t)))
+    {
+        return false;
+    }
+    const uint64_t timeEnabled = buffer[1];
+    const uint64_t timeRunning = buffer[2];
+    if (timeRunning == 0)
+    {
+        return false;
+    }
+    const double scale = (timeEnabled > timeRunning) ? double(timeEnabled)/double(timeRunning) : 1.0;
+    for (size_t c=0; c<NumCounters; ++c)
+    {
+        pValues[c] = (mFds[c] >= 0) ? uint64_t(double(buffer[3+mReadIndex[c]])*scale) : 0;
+    }
+    return true;
+#else
+    (void)pValues;
+    return false;
+#endif
+}
+
+//! @brief Returns the reason that the first unavailable counter could not be opened
+const HString &HardwareCounters::getErrorMessage() const
+{
+    return mErrorMessage;
+}
+
+//! @brief Returns the display name of a counter
+const char *HardwareCounters::getCounterName(const CounterT counter)
+{
+    return counterNames[counter];
+}
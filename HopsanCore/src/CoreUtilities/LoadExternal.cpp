@@ -35,6 +35,7 @@
 #include "Component.h"
 #include "Node.h"
 #include "CoreUtilities/ClassFactoryStatusCheck.hpp"
+#include "CoreUtilities/CompiledModel.h"
 #include "HopsanCoreVersion.h"
 
 #include <sstream>
@@ -314,6 +315,77 @@ bool LoadExternal::unLoad(const HString &rLibpath)
     return true;
 }
 
+//! @brief Loads a compiled model library and creates the compiled model in it
+//! @details The library is kept loaded until the program exits, since the compiled model code may be used by any system it is set in
+//! @param [in] rLibpath The path to the compiled model library DLL or SO file
+//! @returns A new compiled model, or 0 if the library could not be loaded
+CompiledModel *LoadExternal::loadCompiledModel(const HString &rLibpath)
+{
+    typedef CompiledModel* (*create_compiled_model_t)();
+    typedef void (*get_hopsan_info_t)(HopsanExternalLibInfoT *pHopsanExternalLibInfo);
+
+#ifdef _WIN32
+    HINSTANCE lib_ptr = LoadLibrary(rLibpath.c_str());
+    if (!lib_ptr)
+    {
+        stringstream ss;
+        ss << "Opening compiled model library: " << rLibpath.c_str() << " GetLastError(): " << GetLastError();
+        mpMessageHandler->addErrorMessage(ss.str().c_str());
+        return 0;
+    }
+    get_hopsan_info_t get_hopsan_info = (get_hopsan_info_t)GetProcAddress(lib_ptr, "get_hopsan_info");
+    create_compiled_model_t create_compiled_model = (create_compiled_model_t)GetProcAddress(lib_ptr, "create_compiled_model");
+#else
+    void *lib_ptr = dlopen(rLibpath.c_str(), RTLD_NOW);
+    if (!lib_ptr)
+    {
+        mpMessageHandler->addErrorMessage("Opening compiled model library: "+rLibpath+" dlerror(): "+dlerror());
+        return 0;
+    }
+    get_hopsan_info_t get_hopsan_info = (get_hopsan_info_t)dlsym(lib_ptr, "get_hopsan_info");
+    create_compiled_model_t create_compiled_model = (create_compiled_model_t)dlsym(lib_ptr, "create_compiled_model");
+#endif
+
+    bool isCorrectLib = true;
+    if (!get_hopsan_info || !create_compiled_model)
+    {
+        mpMessageHandler->addErrorMessage("Library: "+rLibpath+" is not a compiled model library");
+        isCorrectLib = false;
+    }
+    else
+    {
+        HopsanExternalLibInfoT externalLibInfo;
+        externalLibInfo.libName = (char*)"";
+        get_hopsan_info(&externalLibInfo);
+
+        // The compiled model uses the component classes directly, so it must be compiled against exactly this version and build type
+        if ( (strcmp(externalLibInfo.hopsanCoreVersion, HOPSANCOREVERSION) != 0) ||
+             (strcmp(externalLibInfo.libCompiledDebugRelease, HOPSAN_BUILD_TYPE_STR) != 0) )
+        {
+            stringstream ss;
+            ss << "Compiled model: " << rLibpath.c_str() << " compiled as: " << externalLibInfo.libCompiledDebugRelease << " against HopsanCore: " << externalLibInfo.hopsanCoreVersion
+               << ", current HopsanCore is: " << HOPSANCOREVERSION << " compiled as: " << HOPSAN_BUILD_TYPE_STR;
+            mpMessageHandler->addErrorMessage(ss.str().c_str());
+            isCorrectLib = false;
+        }
+    }
+
+    if (!isCorrectLib)
+    {
+#ifdef _WIN32
+        FreeLibrary(lib_ptr);
+#else
+        dlclose(lib_ptr);
+#endif
+        return 0;
+    }
+
+    mLoadedCompiledModelLibs.push_back(static_cast<void*>(lib_ptr));
+    CompiledModel *pCompiledModel = create_compiled_model();
+    mpMessageHandler->addInfoMessage(HString("Loaded compiled model: ")+pCompiledModel->getModelName()+" from: "+rLibpath);
+    return pCompiledModel;
+}
+
 void LoadExternal::getLoadedLibNames(std::vector<HString> &rLibNames)
 {
     rLibNames.clear();
@@ -0,0 +1,343 @@
+/*-----------------------------------------------------------------------------
+
+ Copyright 2017 Hopsan Group
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+
+
+ The full license is available in the file LICENSE.
+ For details about the 'Hopsan Group' or information about Authors and
+ Contributors see the HOPSANGROUP and AUTHORS files that are located in
+ the Hopsan source code root directory.
+
+-----------------------------------------------------------------------------*/
+
+//$Id$
+
+#include "CoreUtilities/LogStreaming.h"
+
+#include <algorithm>
+#include <cstring>
+#include <chrono>
+#include <stdint.h>
+
+using namespace std;
+using namespace hopsan;
+
+namespace {
+
+void writeBinaryString(ofstream &rFile, const HString &rString)
+{
+    const uint32_t length = uint32_t(rString.size());
+    rFile.write(reinterpret_cast<const char*>(&length), sizeof(length));
+    rFile.write(rString.c_str(), length);
+}
+
+}
+
+
+LogSink::~LogSink()
+{
+    // Nothing to do here, but a virtual destructor is needed
+}
+
+//! @brief Returns the last error message from the sink
+const HString &LogSink::getLastError() const
+{
+    return mLastError;
+}
+
+
+CSVLogSink::CSVLogSink(const HString &rFilePath) :
+    mFilePath(rFilePath),
+    mSampleSize(0)
+{
+    // Nothing else
+}
+
+bool CSVLogSink::open(const std::vector<LogStreamVariable> &rVariables)
+{
+    mFile.open(mFilePath.c_str());
+    if (!mFile.good())
+    {
+        mLastError = "Could not open: "+mFilePath+" for writing";
+        return false;
+    }
+    mSampleSize = rVariables.size();
+
+    for (size_t i=0; i<rVariables.size(); ++i)
+    {
+        mFile << (i>0 ? "," : "") << rVariables[i].name.c_str();
+    }
+    mFile << "\n";
+    for (size_t i=0; i<rVariables.size(); ++i)
+    {
+        mFile << (i>0 ? "," : "") << rVariables[i].unit.c_str();
+    }
+    mFile << "\n";
+    mFile << std::scientific;
+    return mFile.good();
+}
+
+bool CSVLogSink::write(const double *pSamples, const size_t nSamples)
+{
+    for (size_t s=0; s<nSamples; ++s)
+    {
+        const double *pSample = pSamples+s*mSampleSize;
+        mFile << pSample[0];
+        for (size_t i=1; i<mSampleSize; ++i)
+        {
+            mFile << ',' << pSample[i];
+        }
+        mFile << '\n';
+    }
+    if (!mFile.good())
+    {
+        mLastError = "Failed to write to: "+mFilePath;
+        return false;
+    }
+    return true;
+}
+
+void CSVLogSink::close()
+{
+    mFile.close();
+}
+
+
+BinaryLogSink::BinaryLogSink(const HString &rFilePath) :
+    mFilePath(rFilePath),
+    mSampleSize(0)
+{
+    // Nothing else
+}
+
+bool BinaryLogSink::open(const std::vector<LogStreamVariable> &rVariables)
+{
+    mFile.open(mFilePath.c_str(), ios::out | ios::binary | ios::trunc);
+    if (!mFile.good())
+    {
+        mLastError = "Could not open: "+mFilePath+" for writing";
+        return false;
+    }
+    mSampleSize = rVariables.size();
+
+    mFile.write("HOPLOGS1", 8);
+    const uint32_t nColumns = uint32_t(rVariables.size());
+    mFile.write(reinterpret_cast<const char*>(&nColumns), sizeof(nColumns));
+    for (size_t i=0; i<rVariables.size(); ++i)
+    {
+        writeBinaryString(mFile, rVariables[i].name);
+        writeBinaryString(mFile, rVariables[i].unit);
+    }
+    return mFile.good();
+}
+
+bool BinaryLogSink::write(const double *pSamples, const size_t nSamples)
+{
+    mFile.write(reinterpret_cast<const char*>(pSamples), streamsize(nSamples*mSampleSize*sizeof(double)));
+    if (!mFile.good())
+    {
+        mLastError = "Failed to write to: "+mFilePath;
+        return false;
+    }
+    return true;
+}
+
+void BinaryLogSink::close()
+{
+    mFile.close();
+}
+
+
+LogRingBuffer::LogRingBuffer() :
+    mnSlots(0),
+    mSampleSize(0)
+{
+    mWriteCount.store(0);
+    mReadCount.store(0);
+}
+
+//! @brief Allocate the ring buffer and reset it to empty
+//! @param [in] nSlots The number of samples that the buffer can hold
+//! @param [in] sampleSize The number of doubles in each sample
+void LogRingBuffer::setup(const size_t nSlots, const size_t sampleSize)
+{
+    mnSlots = std::max(nSlots, size_t(1));
+    mSampleSize = sampleSize;
+    mBuffer.assign(mnSlots*mSampleSize, 0.0);
+    mWriteCount.store(0);
+    mReadCount.store(0);
+}
+
+//! @brief Get the samples that are ready to be read (consumer only)
+//! @details Only the samples up to the end of the buffer are returned, call again after endRead() to get the wrapped around part
+//! @param [out] ppSamples Set to point to the first sample to read
+//! @returns The number of consecutive samples that can be read
+size_t LogRingBuffer::beginRead(const double **ppSamples) const
+{
+    const size_t readCount = mReadCount.load(std::memory_order_relaxed);
+    const size_t nAvailable = mWriteCount.load(std::memory_order_acquire) - readCount;
+    const size_t readIdx = readCount % mnSlots;
+    *ppSamples = &mBuffer[readIdx*mSampleSize];
+    return std::min(nAvailable, mnSlots-readIdx);
+}
+
+//! @brief Release samples that have been read so that the slots can be reused (consumer only)
+//! @param [in] nSamples The number of samples to release
+void LogRingBuffer::endRead(const size_t nSamples)
+{
+    mReadCount.store(mReadCount.load(std::memory_order_relaxed)+nSamples, std::memory_order_release);
+}
+
+//! @brief Returns the number of samples that have been written but not yet read
+size_t LogRingBuffer::getNumUsedSlots() const
+{
+    return mWriteCount.load(std::memory_order_acquire) - mReadCount.load(std::memory_order_acquire);
+}
+
+size_t LogRingBuffer::getNumSlots() const
+{
+    return mnSlots;
+}
+
+
+//! @brief Constructor
+//! @param [in] pSink The sink to write to, it is not owned by the streamer and must outlive it
+//! @param [in] ringBufferSize The number of samples that can be buffered before the simulation has to wait for the writer
+LogStreamer::LogStreamer(LogSink *pSink, const size_t ringBufferSize) :
+    mpSink(pSink),
+    mRingBufferSize(std::max(ringBufferSize, size_t(2))),
+    mWakeWriterThreshold(0),
+    mIsStarted(false)
+{
+    mFailed.store(false);
+#if defined(HOPSANCORE_USEMULTITHREADING)
+    mStopWriter.store(false);
+#endif
+}
+
+LogStreamer::~LogStreamer()
+{
+    finish();
+}
+
+//! @brief Open the sink and start the writer
+//! @param [in] rVariables The variables in each sample, the first one must be the time
+//! @returns True if the sink could be opened
+bool LogStreamer::start(const std::vector<LogStreamVariable> &rVariables)
+{
+    finish();
+    mFailed.store(false);
+    mLastError.clear();
+
+    if (!mpSink->open(rVariables))
+    {
+        mLastError = mpSink->getLastError();
+        mFailed.store(true);
+        return false;
+    }
+
+    mRingBuffer.setup(mRingBufferSize, rVariables.size());
+    mWakeWriterThreshold = mRingBufferSize/4;
+    mIsStarted = true;
+#if defined(HOPSANCORE_USEMULTITHREADING)
+    mStopWriter.store(false);
+    mWriterThread = std::thread(&LogStreamer::writerLoop, this);
+#endif
+    return true;
+}
+
+//! @brief Write all remaining samples, stop the writer and close the sink
+//! @returns False if writing to the sink has failed
+bool LogStreamer::finish()
+{
+    if (mIsStarted)
+    {
+#if defined(HOPSANCORE_USEMULTITHREADING)
+        {
+            std::lock_guard<std::mutex> lock(mWakeMutex);
+            mStopWriter.store(true);
+        }
+        mWakeWriter.notify_one();
+        mWriterThread.join();
+#endif
+        drain();
+        mpSink->close();
+        mIsStarted = false;
+    }
+    return !mFailed.load();
+}
+
+//! @brief Returns true if writing to the sink has failed
+bool LogStreamer::hasFailed() const
+{
+    return mFailed.load(std::memory_order_relaxed);
+}
+
+//! @brief Returns the last error message
+//! @note Only call this when the writer is not running (after finish())
+const HString &LogStreamer::getLastError() const
+{
+    return mLastError;
+}
+
+//! @brief Wait until the writer has made room in the ring buffer
+double *LogStreamer::waitForFreeSlot()
+{
+    double *pSample = mRingBuffer.beginWrite();
+    while (!pSample)
+    {
+#if defined(HOPSANCORE_USEMULTITHREADING)
+        mWakeWriter.notify_one();
+        std::this_thread::yield();
+#else
+        drain();
+#endif
+        pSample = mRingBuffer.beginWrite();
+    }
+    return pSample;
+}
+
+//! @brief Write all samples currently in the ring buffer to the sink
+//! @details If the sink has failed, the samples are discarded so that the simulation is never blocked
+void LogStreamer::drain()
+{
+    const double *pSamples;
+    size_t nSamples = mRingBuffer.beginRead(&pSamples);
+    while (nSamples > 0)
+    {
+        if (!mFailed.load(std::memory_order_relaxed) && !mpSink->write(pSamples, nSamples))
+        {
+            mLastError = mpSink->getLastError();
+            mFailed.store(true);
+        }
+        mRingBuffer.endRead(nSamples);
+        nSamples = mRingBuffer.beginRead(&pSamples);
+    }
+}
+
+#if defined(HOPSANCORE_USEMULTITHREADING)
+//! @brief The writer thread main loop, drains the ring buffer whenever it is woken up or periodically
+void LogStreamer::writerLoop()
+{
+    while (!mStopWriter.load())
+    {
+        {
+            std::unique_lock<std::mutex> lock(mWakeMutex);
+            mWakeWriter.wait_for(lock, std::chrono::milliseconds(10));
+        }
+        drain();
+    }
+}
+#endif
@@ -31,11 +31,18 @@
 #include <cstdlib>
 #include <iostream>
 #include <string>
+#include <fstream>
+#include <map>
 
 #ifndef _WIN32
 #include <unistd.h>
 #endif
 
+#if defined(__linux__)
+#include <pthread.h>
+#include <sched.h>
+#endif
+
 #if __cplusplus >= 201103L
 #include <mutex>
 #include <chrono>
@@ -43,48 +50,1194 @@
 #include <thread>
 #endif
 
-#include "CoreUtilities/MultiThreadingUtilities.h"
-#include "ComponentSystem.h"
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+#include <intrin.h>
+#endif
+
+#include "CoreUtilities/MultiThreadingUtilities.h"
+#include "ComponentSystem.h"
+#include "CoreUtilities/SimulationProfiler.h"
+
+namespace hopsan {
+
+//! @brief Helper function that decides how many thread to use.
+//! User specifies desired amount, but it is limited by how many cores the processor has.
+//! @param [in] nDesiredThreads How many threads the user wants
+//! @todo maybe this should be a core utility
+size_t determineActualNumberOfThreads(const size_t nDesiredThreads)
+{
+    // Obtain number of processor cores from environment variable, or use user specified value if not zero
+    size_t nThreads, nCores;
+#ifdef _WIN32
+    if(getenv("NUMBER_OF_PROCESSORS") != 0)
+    {
+        std::string temp = getenv("NUMBER_OF_PROCESSORS");
+        nCores = atoi(temp.c_str());
+    }
+    else
+    {
+        nCores = 1;               //If non-Windows system, make sure there is at least one thread
+    }
+#else
+    nCores = std::max((long)1, sysconf(_SC_NPROCESSORS_ONLN));
+#endif
+    if(nDesiredThreads != 0)
+    {
+        // If user specifies a number of threads, attempt to use this number
+        // But limit number of threads to the number of system cores
+        nThreads = std::min(nCores, nDesiredThreads);
+    }
+    else
+    {
+        //User specified nothing, (use auto), so use one thread per core
+        nThreads = nCores;
+    }
+    return nThreads;
+}
+
+
+//! @brief Location of a processor in the machine, used to decide which processors the simulation threads are placed on
+struct CpuLocation
+{
+    int cpu;
+    int numaNode;
+    int coreRank;   //!< Index of the physical core among the cores of its NUMA node
+    int sibling;    //!< Index of the hyper-thread among the hyper-threads of its core
+};
+
+#if defined(__linux__)
+//! @brief Read an integer from a (sysfs) file
+//! @param [in] rPath The file to read
+//! @param [in] defaultValue The value to return if the file can not be read
+static int readIntegerFromFile(const std::string &rPath, const int defaultValue)
+{
+    std::ifstream file(rPath.c_str());
+    int value;
+    if (file >> value)
+    {
+        return value;
+    }
+    return defaultValue;
+}
+#endif
+
+//! @brief Find the NUMA node, core and hyper-thread of processors
+//! @details The topology is read from sysfs on Linux, if it is not available every processor is assumed to be a core of its own in one NUMA node
+//! @param [in] rCpus The processors to locate, in increasing order
+static std::vector<CpuLocation> locateCpus(const std::vector<int> &rCpus)
+{
+    std::map<int, int> cpuNumaNodes;
+    std::vector< std::pair<int, int> > cpuCores(rCpus.size());
+#if defined(__linux__)
+    std::ifstream possibleNodesFile("/sys/devices/system/node/possible");
+    std::string line;
+    std::vector<int> numaNodes;
+    if (std::getline(possibleNodesFile, line) && parseCpuList(line, numaNodes))
+    {
+        for (size_t n=0; n<numaNodes.size(); ++n)
+        {
+            std::stringstream path;
+            path << "/sys/devices/system/node/node" << numaNodes[n] << "/cpulist";
+            std::ifstream nodeCpusFile(path.str().c_str());
+            std::vector<int> nodeCpus;
+            if (std::getline(nodeCpusFile, line) && parseCpuList(line, nodeCpus))
+            {
+                for (size_t c=0; c<nodeCpus.size(); ++c)
+                {
+                    cpuNumaNodes[nodeCpus[c]] = numaNodes[n];
+                }
+            }
+        }
+    }
+    for (size_t i=0; i<rCpus.size(); ++i)
+    {
+        std::stringstream path;
+        path << "/sys/devices/system/cpu/cpu" << rCpus[i] << "/topology/";
+        cpuCores[i].first = readIntegerFromFile(path.str()+"physical_package_id", 0);
+        cpuCores[i].second = readIntegerFromFile(path.str()+"core_id", rCpus[i]);
+    }
+#else
+    for (size_t i=0; i<rCpus.size(); ++i)
+    {
+        cpuCores[i] = std::make_pair(0, rCpus[i]);
+    }
+#endif
+
+    // Number the hyper-threads of each core, and the cores of each NUMA node, in the order they are found
+    std::map<std::pair<int, int>, int> numSiblings;
+    std::map<int, std::map<std::pair<int, int>, int> > numaNodeCores;
+    std::vector<CpuLocation> locations(rCpus.size());
+    for (size_t i=0; i<rCpus.size(); ++i)
+    {
+        locations[i].cpu = rCpus[i];
+        locations[i].numaNode = (cpuNumaNodes.count(rCpus[i]) != 0) ? cpuNumaNodes[rCpus[i]] : 0;
+        locations[i].sibling = numSiblings[cpuCores[i]]++;
+        std::map<std::pair<int, int>, int> &rCores = numaNodeCores[locations[i].numaNode];
+        if (rCores.count(cpuCores[i]) == 0)
+        {
+            const int rank = int(rCores.size());
+            rCores[cpuCores[i]] = rank;
+        }
+        locations[i].coreRank = rCores[cpuCores[i]];
+    }
+    return locations;
+}
+
+//! @brief Order for compact thread placement, the cores of one NUMA node are filled before the next node is used
+static bool isCompactOrder(const CpuLocation &rA, const CpuLocation &rB)
+{
+    if (rA.sibling != rB.sibling) return rA.sibling < rB.sibling;
+    if (rA.numaNode != rB.numaNode) return rA.numaNode < rB.numaNode;
+    if (rA.coreRank != rB.coreRank) return rA.coreRank < rB.coreRank;
+    return rA.cpu < rB.cpu;
+}
+
+//! @brief Order for scatter thread placement, one core is taken from each NUMA node in turn
+static bool isScatterOrder(const CpuLocation &rA, const CpuLocation &rB)
+{
+    if (rA.sibling != rB.sibling) return rA.sibling < rB.sibling;
+    if (rA.coreRank != rB.coreRank) return rA.coreRank < rB.coreRank;
+    if (rA.numaNode != rB.numaNode) return rA.numaNode < rB.numaNode;
+    return rA.cpu < rB.cpu;
+}
+
+//! @brief Returns the processors that the calling thread is allowed to run on, in increasing order
+//! @details The list is empty if it can not be determined, thread placement is then not supported
+std::vector<int> getAllowedCpus()
+{
+    std::vector<int> cpus;
+#if defined(__linux__)
+    cpu_set_t allowedCpus;
+    CPU_ZERO(&allowedCpus);
+    if (sched_getaffinity(0, sizeof(allowedCpus), &allowedCpus) == 0)
+    {
+        for (int c=0; c<CPU_SETSIZE; ++c)
+        {
+            if (CPU_ISSET(c, &allowedCpus))
+            {
+                cpus.push_back(c);
+            }
+        }
+    }
+#endif
+    return cpus;
+}
+
+//! @brief Decide which processor each simulation thread should be pinned to
+//! @details Processors that the calling thread is not allowed to run on are ignored. If there are more threads than processors,
+//! the processors are reused from the beginning.
+//! @param [in] nThreads The number of simulation threads, the first thread is the calling thread
+//! @param [in] placement How to place the threads
+//! @param [in] rCpus The processors to use with ExplicitThreadPlacement
+//! @returns One processor per thread, -1 if the thread should not be pinned, or an empty vector for the default placement
+std::vector<int> determineThreadCpus(const size_t nThreads, const ThreadPlacementT placement, const std::vector<int> &rCpus)
+{
+    std::vector<int> threadCpus;
+    if (placement == NoThreadPlacement)
+    {
+        threadCpus.assign(nThreads, -1);
+        return threadCpus;
+    }
+
+    const std::vector<int> allowedCpus = getAllowedCpus();
+    if ((placement == AutomaticThreadPlacement) || allowedCpus.empty())
+    {
+        return threadCpus;
+    }
+
+    std::vector<int> cpus;
+    if (placement == ExplicitThreadPlacement)
+    {
+        for (size_t i=0; i<rCpus.size(); ++i)
+        {
+            if (std::binary_search(allowedCpus.begin(), allowedCpus.end(), rCpus[i]))
+            {
+                cpus.push_back(rCpus[i]);
+            }
+        }
+    }
+    else
+    {
+        std::vector<CpuLocation> locations = locateCpus(allowedCpus);
+        std::sort(locations.begin(), locations.end(), (placement == CompactThreadPlacement) ? isCompactOrder : isScatterOrder);
+        for (size_t i=0; i<locations.size(); ++i)
+        {
+            cpus.push_back(locations[i].cpu);
+        }
+    }
+
+    for (size_t t=0; (t<nThreads) && !cpus.empty(); ++t)
+    {
+        threadCpus.push_back(cpus[t % cpus.size()]);
+    }
+    return threadCpus;
+}
+
+//! @brief Parse a list of processors, such as "0-3,8,10-11"
+//! @param [in] rList The list, comma separated processor numbers or ranges
+//! @param [out] rCpus The processors in the list
+//! @returns true if the list could be parsed and was not empty, else false (rCpus is then empty)
+bool parseCpuList(const std::string &rList, std::vector<int> &rCpus)
+{
+    rCpus.clear();
+    std::stringstream listStream(rList);
+    std::string range;
+    while (std::getline(listStream, range, ','))
+    {
+        std::stringstream rangeStream(range);
+        int first, last;
+        char separator, extra;
+        if (!(rangeStream >> first) || (first < 0))
+        {
+            rCpus.clear();
+            return false;
+        }
+        last = first;
+        if ((rangeStream >> separator) && ((separator != '-') || !(rangeStream >> last) || (last < first) || (rangeStream >> extra)))
+        {
+            rCpus.clear();
+            return false;
+        }
+        for (int c=first; c<=last; ++c)
+        {
+            rCpus.push_back(c);
+        }
+    }
+    return !rCpus.empty();
+}
+
+//! @brief Parse a thread placement: auto, none, compact, scatter or a list of processors
+//! @param [in] rString The thread placement to parse
+//! @param [out] rPlacement The thread placement
+//! @param [out] rCpus The processors in the list, only set for ExplicitThreadPlacement
+//! @returns true if the thread placement could be parsed, else false
+bool parseThreadPlacement(const std::string &rString, ThreadPlacementT &rPlacement, std::vector<int> &rCpus)
+{
+    rCpus.clear();
+    if (rString == "auto")
+    {
+        rPlacement = AutomaticThreadPlacement;
+    }
+    else if (rString == "none")
+    {
+        rPlacement = NoThreadPlacement;
+    }
+    else if (rString == "compact")
+    {
+        rPlacement = CompactThreadPlacement;
+    }
+    else if (rString == "scatter")
+    {
+        rPlacement = ScatterThreadPlacement;
+    }
+    else if (parseCpuList(rString, rCpus))
+    {
+        rPlacement = ExplicitThreadPlacement;
+    }
+    else
+    {
+        return false;
+    }
+    return true;
+}
+
+
+#if defined(HOPSANCORE_USEMULTITHREADING)
+
+// Limits for the adaptive number of spin iterations before a thread blocks
+static const int minSpinLimit = 16;
+static const int maxSpinLimit = 1<<16;
+static const int initialSpinLimit = 1<<11;
+// The number of back-off rounds with pause instructions before the thread starts to yield
+static const size_t maxBackoffRounds = 10;
+
+//! @brief Constructor
+//! @param [in] policy How the thread should wait
+ThreadWaiter::ThreadWaiter(BarrierPolicyT policy)
+{
+    mPolicy = policy;
+    mSpinLimit.store(initialSpinLimit);
+    mnBlocked.store(0);
+}
+
+BarrierPolicyT ThreadWaiter::getPolicy() const
+{
+    return mPolicy;
+}
+
+//! @brief Tell the processor that the thread is spinning, this saves power and resources for hyper-threads
+void ThreadWaiter::pauseCpu()
+{
+#if defined(__i386__) || defined(__x86_64__)
+    __builtin_ia32_pause();
+#elif defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+    _mm_pause();
+#elif defined(__aarch64__) || defined(__arm__)
+    __asm__ __volatile__("yield");
+#endif
+}
+
+//! @brief Exponential back-off, pause the processor for an increasing time and then yield the thread
+//! @param [in] iteration The number of times the thread has already waited
+void ThreadWaiter::backoff(const size_t iteration)
+{
+    if (iteration < maxBackoffRounds)
+    {
+        const size_t nPauses = size_t(1) << iteration;
+        for (size_t i=0; i<nPauses; ++i)
+        {
+            pauseCpu();
+        }
+    }
+    else
+    {
+        std::this_thread::yield();
+    }
+}
+
+//! @brief Adapt the spin limit after a wait that ended while spinning, aim for twice the number of iterations that were needed
+void ThreadWaiter::spinSucceeded(const int nIterations)
+{
+    int spinLimit = mSpinLimit.load(std::memory_order_relaxed);
+    spinLimit += (2*nIterations - spinLimit)/8;
+    mSpinLimit.store(std::min(std::max(spinLimit, minSpinLimit), maxSpinLimit), std::memory_order_relaxed);
+}
+
+//! @brief Adapt the spin limit after a wait that had to block, spinning was wasted so spin less next time
+void ThreadWaiter::spinFailed()
+{
+    int spinLimit = mSpinLimit.load(std::memory_order_relaxed);
+    spinLimit -= spinLimit/8;
+    mSpinLimit.store(std::min(std::max(spinLimit, minSpinLimit), maxSpinLimit), std::memory_order_relaxed);
+}
+
+void ThreadWaiter::notifyBlocked()
+{
+    // Take the mutex so that a thread that is about to block can not miss the notification
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+    }
+    mCondition.notify_all();
+}
+
+//! @brief Wait (in the master thread) until all other threads have arrived at the barrier
+//! @param [in] pSystem The system to check for aborted simulation while waiting, if 0 the wait can not be aborted
+//! @returns False if the simulation was aborted while waiting
+bool BarrierLock::waitForAllArrived(ComponentSystem *pSystem)
+{
+    if (pSystem)
+    {
+        mWaiter.waitUntil([this, pSystem](){ return allArrived() || pSystem->wasSimulationAborted(); });
+        return allArrived();
+    }
+    mWaiter.waitUntil([this](){ return allArrived(); });
+    return true;
+}
+
+
+// Phases where the mean busy time per thread during a measurement window is shorter than this (in seconds) are not rebalanced, the measurement is too uncertain
+static const double minRebalanceWindowTime = 20e-6;
+
+//! @brief Constructor
+//! @param [in] rSplitSignalVector The signal components of each thread, only used to measure the load
+//! @param [in] rSplitCVector The C-type components of each thread, components may be moved between the threads
+//! @param [in] rSplitQVector The Q-type components of each thread, components may be moved between the threads
+//! @param [in] sampleInterval The number of steps between each measurement
+//! @param [in] nSamplesPerRebalance The number of measurements between each attempt to rebalance
+//! @param [in] imbalanceThreshold Rebalance a phase if the busiest thread exceeds the average busy time by this factor
+LoadRebalancer::LoadRebalancer(std::vector< std::vector<Component*> > &rSplitSignalVector, std::vector< std::vector<Component*> > &rSplitCVector,
+                               std::vector< std::vector<Component*> > &rSplitQVector, const size_t sampleInterval, const size_t nSamplesPerRebalance,
+                               const double imbalanceThreshold)
+{
+    mpSplitVectors[SignalPhase] = &rSplitSignalVector;
+    mpSplitVectors[CPhase] = &rSplitCVector;
+    mpSplitVectors[QPhase] = &rSplitQVector;
+    mThreadLoads.resize(rSplitCVector.size());
+    mSampleInterval = std::max(sampleInterval, size_t(1));
+    mnSamplesPerRebalance = std::max(nSamplesPerRebalance, size_t(1));
+    mImbalanceThreshold = imbalanceThreshold;
+    mnSamples = 0;
+    mnRebalances = 0;
+    mnMovedComponents = 0;
+    mOverheadTime = 0;
+    mTotalBusyTime = 0;
+    mTotalWaitTime = 0;
+    for (size_t p=0; p<NumPhases; ++p)
+    {
+        mFirstImbalance[p] = 0;
+        mLastImbalance[p] = 0;
+    }
+    resetWindow();
+}
+
+//! @brief Returns a time stamp in seconds, to be used for measuring time differences
+double LoadRebalancer::getCurrentTime()
+{
+    return std::chrono::duration<double>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+//! @brief Simulate components and measure the time spent on each one, the time is accumulated in the measured time of the component
+//! @param [in] thread The index of the calling thread
+//! @param [in] phase The phase that the components belong to
+//! @param [in] rComponents The components to simulate
+//! @param [in] time The time to simulate to
+void LoadRebalancer::simulateAndMeasure(const size_t thread, const PhaseT phase, std::vector<Component*> &rComponents, const double time)
+{
+    double t0 = getCurrentTime();
+    const double phaseStart = t0;
+    for (size_t i=0; i<rComponents.size(); ++i)
+    {
+        rComponents[i]->simulate(time);
+        const double t1 = getCurrentTime();
+        rComponents[i]->setMeasuredTime(rComponents[i]->getMeasuredTime()+(t1-t0));
+        t0 = t1;
+    }
+    mThreadLoads[thread].mBusyTime[phase] += t0-phaseStart;
+}
+
+//! @brief Add time that a thread has been waiting at a barrier
+void LoadRebalancer::addWaitTime(const size_t thread, const PhaseT phase, const double waitTime)
+{
+    mThreadLoads[thread].mWaitTime[phase] += waitTime;
+}
+
+//! @brief Finish a measured step, rebalance if the measurement window is complete and the load is unbalanced
+//! @note Must only be called from the master thread, while all other threads are waiting at a barrier
+//! @returns True if components were moved
+bool LoadRebalancer::endSampleStep()
+{
+    ++mnSamples;
+    if (++mnSamplesInWindow < mnSamplesPerRebalance)
+    {
+        return false;
+    }
+
+    const double t0 = getCurrentTime();
+    size_t nMoved = 0;
+    for (size_t p=0; p<NumPhases; ++p)
+    {
+        mLastImbalance[p] = calcImbalance(PhaseT(p));
+        if (mFirstImbalance[p] == 0)
+        {
+            mFirstImbalance[p] = mLastImbalance[p];
+        }
+    }
+    for (size_t t=0; t<mThreadLoads.size(); ++t)
+    {
+        for (size_t p=0; p<NumPhases; ++p)
+        {
+            mTotalBusyTime += mThreadLoads[t].mBusyTime[p];
+            mTotalWaitTime += mThreadLoads[t].mWaitTime[p];
+        }
+    }
+    if (mLastImbalance[CPhase] > mImbalanceThreshold)
+    {
+        nMoved += rebalancePhase(*mpSplitVectors[CPhase]);
+    }
+    if (mLastImbalance[QPhase] > mImbalanceThreshold)
+    {
+        nMoved += rebalancePhase(*mpSplitVectors[QPhase]);
+    }
+    resetWindow();
+
+    if (nMoved > 0)
+    {
+        ++mnRebalances;
+        mnMovedComponents += nMoved;
+    }
+    mOverheadTime += getCurrentTime()-t0;
+    return (nMoved > 0);
+}
+
+//! @brief Returns the number of measured steps
+size_t LoadRebalancer::getNumSamples() const
+{
+    return mnSamples;
+}
+
+//! @brief Returns the number of times that components have been moved between threads
+size_t LoadRebalancer::getNumRebalances() const
+{
+    return mnRebalances;
+}
+
+//! @brief Returns the total number of component moves
+size_t LoadRebalancer::getNumMovedComponents() const
+{
+    return mnMovedComponents;
+}
+
+//! @brief Returns the time in seconds that the master thread has spent on evaluating the load and moving components
+double LoadRebalancer::getOverheadTime() const
+{
+    return mOverheadTime;
+}
+
+//! @brief Returns the imbalance (busiest thread divided by average) of a phase in the first measurement window, or 0 if no window is complete
+double LoadRebalancer::getFirstImbalance(const PhaseT phase) const
+{
+    return mFirstImbalance[phase];
+}
+
+//! @brief Returns the imbalance (busiest thread divided by average) of a phase in the last measurement window, or 0 if no window is complete
+double LoadRebalancer::getLastImbalance(const PhaseT phase) const
+{
+    return mLastImbalance[phase];
+}
+
+//! @brief Returns the fraction of the measured time that the threads have spent waiting at the S, C and Q barriers
+double LoadRebalancer::getWaitFraction() const
+{
+    const double total = mTotalBusyTime+mTotalWaitTime;
+    return (total > 0) ? mTotalWaitTime/total : 0;
+}
+
+double LoadRebalancer::calcImbalance(const PhaseT phase) const
+{
+    double maxTime = 0;
+    double sumTime = 0;
+    for (size_t t=0; t<mThreadLoads.size(); ++t)
+    {
+        maxTime = std::max(maxTime, mThreadLoads[t].mBusyTime[phase]);
+        sumTime += mThreadLoads[t].mBusyTime[phase];
+    }
+    const double meanTime = sumTime/double(mThreadLoads.size());
+    if (meanTime < minRebalanceWindowTime)
+    {
+        return 1.0;
+    }
+    return maxTime/meanTime;
+}
+
+//! @brief Move components from the busiest to the least busy thread, based on the measured time of each component
+//! @returns The number of moved components
+size_t LoadRebalancer::rebalancePhase(std::vector< std::vector<Component*> > &rSplitVector)
+{
+    const size_t nThreads = rSplitVector.size();
+    std::vector<double> loads(nThreads, 0.0);
+    size_t nComponents = 0;
+    for (size_t t=0; t<nThreads; ++t)
+    {
+        for (size_t i=0; i<rSplitVector[t].size(); ++i)
+        {
+            loads[t] += rSplitVector[t][i]->getMeasuredTime();
+        }
+        nComponents += rSplitVector[t].size();
+    }
+
+    // Each move reduces the difference between two threads, so this ends long before every component has been moved
+    size_t nMoved = 0;
+    for (size_t m=0; m<nComponents; ++m)
+    {
+        const size_t maxThread = size_t(std::max_element(loads.begin(), loads.end())-loads.begin());
+        const size_t minThread = size_t(std::min_element(loads.begin(), loads.end())-loads.begin());
+        const double difference = loads[maxThread]-loads[minThread];
+
+        // Moving a component reduces the difference if it is cheaper than the difference, the best one costs half the difference
+        size_t bestIdx = rSplitVector[maxThread].size();
+        double bestDistance = difference/2.0;
+        for (size_t i=0; i<rSplitVector[maxThread].size(); ++i)
+        {
+            const double cost = rSplitVector[maxThread][i]->getMeasuredTime();
+            if (cost > 0 && std::fabs(cost-difference/2.0) < bestDistance)
+            {
+                bestIdx = i;
+                bestDistance = std::fabs(cost-difference/2.0);
+            }
+        }
+        if (bestIdx == rSplitVector[maxThread].size())
+        {
+            break;
+        }
+
+        Component *pComponent = rSplitVector[maxThread][bestIdx];
+        rSplitVector[maxThread].erase(rSplitVector[maxThread].begin()+bestIdx);
+        rSplitVector[minThread].push_back(pComponent);
+        loads[maxThread] -= pComponent->getMeasuredTime();
+        loads[minThread] += pComponent->getMeasuredTime();
+        ++nMoved;
+    }
+    return nMoved;
+}
+
+//! @brief Start a new measurement window
+void LoadRebalancer::resetWindow()
+{
+    mnSamplesInWindow = 0;
+    for (size_t t=0; t<mThreadLoads.size(); ++t)
+    {
+        for (size_t p=0; p<NumPhases; ++p)
+        {
+            mThreadLoads[t].mBusyTime[p] = 0;
+            mThreadLoads[t].mWaitTime[p] = 0;
+            for (size_t i=0; i<(*mpSplitVectors[p])[t].size(); ++i)
+            {
+                (*mpSplitVectors[p])[t][i]->setMeasuredTime(0);
+            }
+        }
+    }
+}
+
+
+
+//! @brief Constructor, creates the schedule
+//! @param [in] rSortedComponents The signal components, sorted so that each component comes after the components it depends on
+//! @param [in] rDependencies For each component, the indices of the components that must be simulated before it in each step
+//! @param [in] nThreads The number of threads
+//! @param [in] syncCostFactor The estimated cost of depending on a component in another thread, relative to the mean measured time of the components
+SignalComponentSchedule::SignalComponentSchedule(const std::vector<Component*> &rSortedComponents, const std::vector< std::vector<size_t> > &rDependencies,
+                                                 const size_t nThreads, const double syncCostFactor)
+{
+    const size_t nComponents = rSortedComponents.size();
+    mComponents = rSortedComponents;
+    mThreads.resize(std::max(nThreads, size_t(1)));
+    for (size_t t=0; t<mThreads.size(); ++t)
+    {
+        mThreads[t].mnSteps = 0;
+        mThreads[t].mpWaiter = 0;
+    }
+    mpDoneCounters = new DoneCounter[std::max(nComponents, size_t(1))];
+    mIsValid = (rDependencies.size() == nComponents);
+    mnLevels = 0;
+    mMaxLevelWidth = 0;
+    mnCrossThreadDependencies = 0;
+    mEstimatedTime = 0;
+    mSerialTime = 0;
+
+    // Use the measured times as weights, components that were too fast to measure get a small weight
+    double meanTime = 0;
+    for (size_t i=0; i<nComponents; ++i)
+    {
+        meanTime += std::max(rSortedComponents[i]->getMeasuredTime(), 0.0);
+    }
+    meanTime = (nComponents > 0) ? meanTime/double(nComponents) : 0;
+    mWeights.resize(nComponents, 1.0);
+    if (meanTime > 0)
+    {
+        for (size_t i=0; i<nComponents; ++i)
+        {
+            mWeights[i] = std::max(rSortedComponents[i]->getMeasuredTime(), 0.01*meanTime);
+        }
+    }
+    const double meanWeight = (meanTime > 0) ? meanTime : 1.0;
+    const double syncCost = syncCostFactor*meanWeight;
+
+    // Each component is one level above the highest of the components it depends on
+    std::vector<size_t> levels(nComponents, 0);
+    for (size_t i=0; i<nComponents && mIsValid; ++i)
+    {
+        for (size_t d=0; d<rDependencies[i].size(); ++d)
+        {
+            if (rDependencies[i][d] >= i)
+            {
+                // Not sorted in dependency order, most likely an algebraic loop
+                mIsValid = false;
+                break;
+            }
+            levels[i] = std::max(levels[i], levels[rDependencies[i][d]]+1);
+        }
+        mnLevels = std::max(mnLevels, levels[i]+1);
+        mSerialTime += mWeights[i];
+    }
+    if (!mIsValid)
+    {
+        mnLevels = 0;
+        return;
+    }
+    std::vector< std::vector<size_t> > componentsInLevel(mnLevels);
+    for (size_t i=0; i<nComponents; ++i)
+    {
+        componentsInLevel[levels[i]].push_back(i);
+    }
+
+    // Assign the components level by level, the heaviest first, to the thread where they are estimated to finish first
+    std::vector<size_t> threadOfComponent(nComponents, 0);
+    std::vector<double> finishTime(nComponents, 0);
+    std::vector<double> threadTime(mThreads.size(), 0);
+    for (size_t l=0; l<mnLevels; ++l)
+    {
+        std::vector<size_t> &rLevel = componentsInLevel[l];
+        mMaxLevelWidth = std::max(mMaxLevelWidth, rLevel.size());
+        std::stable_sort(rLevel.begin(), rLevel.end(), [this](const size_t a, const size_t b){ return mWeights[a] > mWeights[b]; });
+        for (size_t i=0; i<rLevel.size(); ++i)
+        {
+            const size_t c = rLevel[i];
+            size_t bestThread = 0;
+            double bestFinishTime = std::numeric_limits<double>::max();
+            for (size_t t=0; t<mThreads.size(); ++t)
+            {
+                double startTime = threadTime[t];
+                for (size_t d=0; d<rDependencies[c].size(); ++d)
+                {
+                    const size_t dep = rDependencies[c][d];
+                    startTime = std::max(startTime, finishTime[dep] + ((threadOfComponent[dep] != t) ? syncCost : 0));
+                }
+                if (startTime+mWeights[c] < bestFinishTime)
+                {
+                    bestFinishTime = startTime+mWeights[c];
+                    bestThread = t;
+                }
+            }
+            threadOfComponent[c] = bestThread;
+            finishTime[c] = bestFinishTime;
+            threadTime[bestThread] = bestFinishTime;
+            mEstimatedTime = std::max(mEstimatedTime, bestFinishTime);
+
+            Task task;
+            task.mpComponent = rSortedComponents[c];
+            task.mIndex = c;
+            for (size_t d=0; d<rDependencies[c].size(); ++d)
+            {
+                const size_t dep = rDependencies[c][d];
+                if (threadOfComponent[dep] != bestThread && (std::find(task.mWaitFor.begin(), task.mWaitFor.end(), dep) == task.mWaitFor.end()))
+                {
+                    task.mWaitFor.push_back(dep);
+                }
+            }
+            mThreads[bestThread].mTasks.push_back(task);
+        }
+    }
+
+    // Let each component know which threads wait for it, so that they can be notified
+    std::vector<Task*> taskOfComponent(nComponents, 0);
+    for (size_t t=0; t<mThreads.size(); ++t)
+    {
+        for (size_t i=0; i<mThreads[t].mTasks.size(); ++i)
+        {
+            taskOfComponent[mThreads[t].mTasks[i].mIndex] = &mThreads[t].mTasks[i];
+        }
+    }
+    for (size_t t=0; t<mThreads.size(); ++t)
+    {
+        for (size_t i=0; i<mThreads[t].mTasks.size(); ++i)
+        {
+            const std::vector<size_t> &rWaitFor = mThreads[t].mTasks[i].mWaitFor;
+            for (size_t w=0; w<rWaitFor.size(); ++w)
+            {
+                Task *pRequired = taskOfComponent[rWaitFor[w]];
+                if ((std::find(pRequired->mNotifyThreads.begin(), pRequired->mNotifyThreads.end(), t) == pRequired->mNotifyThreads.end()))
+                {
+                    pRequired->mNotifyThreads.push_back(t);
+                }
+                ++mnCrossThreadDependencies;
+            }
+        }
+    }
+}
+
+SignalComponentSchedule::~SignalComponentSchedule()
+{
+    for (size_t t=0; t<mThreads.size(); ++t)
+    {
+        delete mThreads[t].mpWaiter;
+    }
+    delete[] mpDoneCounters;
+}
+
+//! @brief Returns false if the components could not be scheduled, because they were not sorted in dependency order
+bool SignalComponentSchedule::isValid() const
+{
+    return mIsValid;
+}
+
+//! @brief Get the components of each thread, in the order they are simulated
+//! @param [out] rSplitSignalVector The components of each thread
+void SignalComponentSchedule::getSplitVector(std::vector< std::vector<Component*> > &rSplitSignalVector) const
+{
+    rSplitSignalVector.assign(mThreads.size(), std::vector<Component*>());
+    for (size_t t=0; t<mThreads.size(); ++t)
+    {
+        for (size_t i=0; i<mThreads[t].mTasks.size(); ++i)
+        {
+            rSplitSignalVector[t].push_back(mThreads[t].mTasks[i].mpComponent);
+        }
+    }
+}
+
+//! @brief Estimate the time for the signal phase when each thread simulates the given components without waiting for the other threads
+//! @details Used to compare the schedule with distributing independent groups of components, the estimate uses the same weights as the schedule
+//! @param [in] rSplitSignalVector The components of each thread
+//! @returns The estimated time for the busiest thread
+double SignalComponentSchedule::estimateTime(const std::vector< std::vector<Component*> > &rSplitSignalVector) const
+{
+    double maxTime = 0;
+    for (size_t t=0; t<rSplitSignalVector.size(); ++t)
+    {
+        double threadTime = 0;
+        for (size_t i=0; i<rSplitSignalVector[t].size(); ++i)
+        {
+            const std::vector<Component*>::const_iterator it = std::find(mComponents.begin(), mComponents.end(), rSplitSignalVector[t][i]);
+            threadTime += (it != mComponents.end()) ? mWeights[it-mComponents.begin()] : 0;
+        }
+        maxTime = std::max(maxTime, threadTime);
+    }
+    return maxTime;
+}
+
+//! @brief Prepare for a new simulation, must be called before the threads start simulating
+//! @param [in] policy How threads should wait for components in other threads
+void SignalComponentSchedule::reset(const BarrierPolicyT policy)
+{
+    for (size_t t=0; t<mThreads.size(); ++t)
+    {
+        mThreads[t].mnSteps = 0;
+        if (!mThreads[t].mpWaiter || (mThreads[t].mpWaiter->getPolicy() != policy))
+        {
+            delete mThreads[t].mpWaiter;
+            mThreads[t].mpWaiter = new ThreadWaiter(policy);
+        }
+    }
+    for (size_t i=0; i<mComponents.size(); ++i)
+    {
+        mpDoneCounters[i].mnSteps.store(0);
+    }
+}
+
+//! @brief Simulate the signal components of one thread one step, waiting for the components in other threads that they depend on
+//! @param [in] thread The index of the calling thread
+//! @param [in] time The time to simulate to
+//! @param [in] pSystem The system to check for aborted simulation while waiting, if 0 the wait can not be aborted
+//! @returns False if the simulation was aborted while waiting
+bool SignalComponentSchedule::simulate(const size_t thread, const double time, ComponentSystem *pSystem)
+{
+    ThreadSchedule &rThread = mThreads[thread];
+    const size_t step = ++rThread.mnSteps;
+    for (size_t i=0; i<rThread.mTasks.size(); ++i)
+    {
+        const Task &rTask = rThread.mTasks[i];
+        for (size_t w=0; w<rTask.mWaitFor.size(); ++w)
+        {
+            const std::atomic<size_t> &rRequiredSteps = mpDoneCounters[rTask.mWaitFor[w]].mnSteps;
+            if (rRequiredSteps.load(std::memory_order_acquire) < step)
+            {
+                rThread.mpWaiter->waitUntil([&rRequiredSteps, step, pSystem](){
+                    return (rRequiredSteps.load(std::memory_order_acquire) >= step) || (pSystem && pSystem->wasSimulationAborted()); });
+                if (rRequiredSteps.load(std::memory_order_acquire) < step)
+                {
+                    return false;
+                }
+            }
+        }
+
+        rTask.mpComponent->simulate(time);
+
+        if (!rTask.mNotifyThreads.empty())
+        {
+            mpDoneCounters[rTask.mIndex].mnSteps.store(step, std::memory_order_release);
+            for (size_t n=0; n<rTask.mNotifyThreads.size(); ++n)
+            {
+                mThreads[rTask.mNotifyThreads[n]].mpWaiter->notify();
+            }
+        }
+    }
+    return true;
+}
+
+//! @brief Returns the number of dependency levels
+size_t SignalComponentSchedule::getNumLevels() const
+{
+    return mnLevels;
+}
+
+//! @brief Returns the largest number of components in one level
+size_t SignalComponentSchedule::getMaxLevelWidth() const
+{
+    return mMaxLevelWidth;
+}
+
+//! @brief Returns the number of times a component must wait for a component in another thread in each step
+size_t SignalComponentSchedule::getNumCrossThreadDependencies() const
+{
+    return mnCrossThreadDependencies;
+}
+
+//! @brief Returns the estimated time for the signal phase with this schedule, in the unit of the measured times
+double SignalComponentSchedule::getEstimatedTime() const
+{
+    return mEstimatedTime;
+}
+
+//! @brief Returns the estimated speedup compared to simulating all signal components in one thread
+double SignalComponentSchedule::getEstimatedSpeedup() const
+{
+    return (mEstimatedTime > 0) ? mSerialTime/mEstimatedTime : 1.0;
+}
+
+#if defined(__linux__)
+//! @brief Set which processors a thread may run on
+//! @returns true if the affinity could be set, else false
+static bool setAffinity(const pthread_t thread, const std::vector<int> &rCpus)
+{
+    cpu_set_t cpuSet;
+    CPU_ZERO(&cpuSet);
+    for (size_t i=0; i<rCpus.size(); ++i)
+    {
+        CPU_SET(rCpus[i], &cpuSet);
+    }
+    return !rCpus.empty() && (pthread_setaffinity_np(thread, sizeof(cpuSet), &cpuSet) == 0);
+}
+#endif
+
+//! @brief Pin a thread to one processor
+//! @param [in] rThread The thread to pin
+//! @param [in] cpu The processor, or -1 to let the thread run on any of the allowed processors
+//! @param [in] rAllowedCpus The processors that the process is allowed to run on
+static void pinThread(std::thread &rThread, const int cpu, const std::vector<int> &rAllowedCpus)
+{
+#if defined(__linux__)
+    setAffinity(rThread.native_handle(), (cpu >= 0) ? std::vector<int>(1, cpu) : rAllowedCpus);
+#else
+    (void)rThread;
+    (void)cpu;
+    (void)rAllowedCpus;
+#endif
+}
+
+//! @brief Constructor, pins the calling thread
+//! @param [in] cpu The processor to pin the calling thread to, the thread is not pinned if it is negative
+ScopedThreadAffinity::ScopedThreadAffinity(const int cpu)
+{
+#if defined(__linux__)
+    if (cpu >= 0)
+    {
+        mPreviousCpus = getAllowedCpus();
+        if (!setAffinity(pthread_self(), std::vector<int>(1, cpu)))
+        {
+            mPreviousCpus.clear();
+        }
+    }
+#else
+    (void)cpu;
+#endif
+}
+
+//! @brief Destructor, restores the processors that the calling thread was allowed to run on
+ScopedThreadAffinity::~ScopedThreadAffinity()
+{
+#if defined(__linux__)
+    if (!mPreviousCpus.empty())
+    {
+        setAffinity(pthread_self(), mPreviousCpus);
+    }
+#endif
+}
+
+//! @brief A worker thread in the simulation thread pool
+class SimulationThreadPool::Worker
+{
+public:
+    Worker() : mWaiter(SpinThenBlockBarrierPolicy), mpTask(0)
+    {
+        mGeneration.store(0);
+    }
 
-namespace hopsan {
+    std::thread mThread;
+    ThreadWaiter mWaiter;
+    std::function<void()> *mpTask;
+    // Increased by the pool each time the worker is given a new task
+    std::atomic<size_t> mGeneration;
+};
 
-//! @brief Helper function that decides how many thread to use.
-//! User specifies desired amount, but it is limited by how many cores the processor has.
-//! @param [in] nDesiredThreads How many threads the user wants
-//! @todo maybe this should be a core utility
-size_t determineActualNumberOfThreads(const size_t nDesiredThreads)
+//! @brief Constructor, no threads are created until they are needed
+SimulationThreadPool::SimulationThreadPool() : mDoneWaiter(SpinThenBlockBarrierPolicy)
 {
-    // Obtain number of processor cores from environment variable, or use user specified value if not zero
-    size_t nThreads, nCores;
-#ifdef _WIN32
-    if(getenv("NUMBER_OF_PROCESSORS") != 0)
+    mGeneration = 0;
+    mnPendingTasks.store(0);
+    mStop.store(false);
+    mPinWorkers = true;
+    mAllowedCpus = getAllowedCpus();
+}
+
+//! @brief Destructor, stops and joins all worker threads
+SimulationThreadPool::~SimulationThreadPool()
+{
+    mStop.store(true);
+    for (size_t i=0; i<mWorkers.size(); ++i)
     {
-        std::string temp = getenv("NUMBER_OF_PROCESSORS");
-        nCores = atoi(temp.c_str());
+        mWorkers[i]->mWaiter.notify();
     }
-    else
+    for (size_t i=0; i<mWorkers.size(); ++i)
     {
-        nCores = 1;               //If non-Windows system, make sure there is at least one thread
+        mWorkers[i]->mThread.join();
+        delete mWorkers[i];
     }
-#else
-    nCores = std::max((long)1, sysconf(_SC_NPROCESSORS_ONLN));
-#endif
-    if(nDesiredThreads != 0)
+}
+
+//! @brief Execute tasks in parallel and wait until all of them have finished
+//! @details The first task is executed in the calling thread and the others in the worker threads, new workers are added if needed.
+//! If the pool is already busy, (when called from several threads at the same time) new threads are created for this call instead.
+//! @param [in] rTasks The tasks to execute, they must be able to run concurrently
+//! @param [in] rThreadCpus The processor to pin the thread of each task to (see determineThreadCpus()), or empty for the default placement.
+//! The calling thread is never pinned by the pool.
+void SimulationThreadPool::run(std::vector< std::function<void()> > &rTasks, const std::vector<int> &rThreadCpus)
+{
+    if (rTasks.empty())
     {
-        // If user specifies a number of threads, attempt to use this number
-        // But limit number of threads to the number of system cores
-        nThreads = std::min(nCores, nDesiredThreads);
+        return;
     }
-    else
+
+    std::unique_lock<std::mutex> lock(mRunMutex, std::try_to_lock);
+    if (!lock.owns_lock())
     {
-        //User specified nothing, (use auto), so use one thread per core
-        nThreads = nCores;
+        runInNewThreads(rTasks, rThreadCpus);
+        return;
     }
-    return nThreads;
+
+    setThreadCpus(rThreadCpus);
+    const size_t nWorkerTasks = rTasks.size()-1;
+    if (mWorkers.size() < nWorkerTasks)
+    {
+        addWorkers(nWorkerTasks-mWorkers.size());
+    }
+
+    ++mGeneration;
+    mnPendingTasks.store(nWorkerTasks);
+    for (size_t i=0; i<nWorkerTasks; ++i)
+    {
+        mWorkers[i]->mpTask = &rTasks[i+1];
+        mWorkers[i]->mGeneration.store(mGeneration);
+        mWorkers[i]->mWaiter.notify();
+    }
+
+    rTasks[0]();
+
+    mDoneWaiter.waitUntil([this](){ return mnPendingTasks.load() == 0; });
 }
 
+//! @brief Returns the number of worker threads that have been created
+size_t SimulationThreadPool::getNumWorkers() const
+{
+    return mWorkers.size();
+}
+
+//! @brief Set whether new worker threads should be pinned to one processor each (only supported on Linux)
+void SimulationThreadPool::setPinWorkers(const bool pinWorkers)
+{
+    mPinWorkers = pinWorkers;
+}
+
+void SimulationThreadPool::addWorkers(const size_t nWorkers)
+{
+    for (size_t i=0; i<nWorkers; ++i)
+    {
+        Worker *pWorker = new Worker();
+        pWorker->mThread = std::thread(&SimulationThreadPool::workerLoop, this, pWorker);
+        // The calling thread runs the first task, so worker n runs task n+1
+        pinThread(pWorker->mThread, getTaskCpu(mWorkers.size()+1), mAllowedCpus);
+        mWorkers.push_back(pWorker);
+    }
+}
+
+//! @brief Change the processors that the worker threads are pinned to, existing workers are moved if needed
+//! @param [in] rThreadCpus The processor for each task, or empty for the default placement
+void SimulationThreadPool::setThreadCpus(const std::vector<int> &rThreadCpus)
+{
+    if (rThreadCpus != mThreadCpus)
+    {
+        mThreadCpus = rThreadCpus;
+        for (size_t i=0; i<mWorkers.size(); ++i)
+        {
+            pinThread(mWorkers[i]->mThread, getTaskCpu(i+1), mAllowedCpus);
+        }
+    }
+}
+
+//! @brief Returns the processor that the thread executing a task should be pinned to, or -1 if it should not be pinned
+int SimulationThreadPool::getTaskCpu(const size_t taskIdx) const
+{
+    if (!mThreadCpus.empty())
+    {
+        return mThreadCpus[taskIdx % mThreadCpus.size()];
+    }
+    if (mPinWorkers && !mAllowedCpus.empty())
+    {
+        return mAllowedCpus[taskIdx % mAllowedCpus.size()];
+    }
+    return -1;
+}
+
+void SimulationThreadPool::workerLoop(Worker *pWorker)
+{
+    size_t generation = 0;
+    while (true)
+    {
+        pWorker->mWaiter.waitUntil([this, pWorker, generation](){ return (pWorker->mGeneration.load() != generation) || mStop.load(); });
+        if (mStop.load())
+        {
+            break;
+        }
+        generation = pWorker->mGeneration.load();
+        (*pWorker->mpTask)();
+        if (--mnPendingTasks == 0)
+        {
+            mDoneWaiter.notify();
+        }
+    }
+}
+
+//! @brief Execute tasks in temporary threads, the first task is executed in the calling thread
+void SimulationThreadPool::runInNewThreads(std::vector< std::function<void()> > &rTasks, const std::vector<int> &rThreadCpus)
+{
+    std::vector<std::thread> threads;
+    for (size_t i=1; i<rTasks.size(); ++i)
+    {
+        threads.push_back(std::thread(rTasks[i]));
+        if (!rThreadCpus.empty())
+        {
+            pinThread(threads.back(), rThreadCpus[i % rThreadCpus.size()], mAllowedCpus);
+        }
+    }
+    rTasks[0]();
+    for (size_t i=0; i<threads.size(); ++i)
+    {
+        threads[i].join();
+    }
+}
+
+
+//! @brief Returns the profiler phase corresponding to a load rebalancer phase
+static inline SimulationProfiler::PhaseT toProfilerPhase(const LoadRebalancer::PhaseT phase)
+{
+    switch(phase)
+    {
+    case LoadRebalancer::CPhase :
+        return SimulationProfiler::CPhase;
+    case LoadRebalancer::QPhase :
+        return SimulationProfiler::QPhase;
+    default :
+        return SimulationProfiler::SignalPhase;
+    }
+}
+
+
+//! @brief Simulate the components of one phase in a simulation thread
+//! @param rComponents The components to simulate
+//! @param time The time to simulate to
+//! @param pRebalancer Pointer to the load rebalancer if the time should be measured in this step, else 0
+//! @param threadIdx The index of the simulation thread
+//! @param phase The phase that the components belong to
+//! @param pProfiler Pointer to the simulation profiler, or 0 if the simulation is not profiled
+//! @param step The step index, used by the profiler
+static inline void simulatePhase(std::vector<Component*> &rComponents, const double time, LoadRebalancer *pRebalancer,
+                                 const size_t threadIdx, const LoadRebalancer::PhaseT phase, SimulationProfiler *pProfiler, const size_t step)
+{
+    if(pProfiler)
+    {
+        pProfiler->simulatePhase(threadIdx, toProfilerPhase(phase), rComponents, time, step);
+    }
+    else if(pRebalancer)
+    {
+        pRebalancer->simulateAndMeasure(threadIdx, phase, rComponents, time);
+    }
+    else
+    {
+        for(size_t i=0; i<rComponents.size(); ++i)
+        {
+            rComponents[i]->simulate(time);
+        }
+    }
+}
 
-#if defined(HOPSANCORE_USEMULTITHREADING)
 
 //! @brief Constructor for slave simulation thread function.
 //! @param pSystem Pointer to top level component system
@@ -99,6 +1252,10 @@ size_t determineActualNumberOfThreads(const size_t nDesiredThreads)
 //! @param *pBarrier_C Pointer to barrier before C-type components
 //! @param *pBarrier_Q Pointer to barrier before Q-type components
 //! @param *pBarrier_N Pointer to barrier before node logging
+//! @param *pRebalancer Pointer to the load rebalancer that measures the load, or 0 if the load should not be measured
+//! @param threadIdx The index of this thread, used by the load rebalancer and the signal component schedule
+//! @param *pSignalSchedule Pointer to the schedule for the signal components, or 0 to simulate sVector without waiting for other threads
+//! @param *pProfiler Pointer to the simulation profiler, or 0 if the simulation is not profiled
 void simSlave(ComponentSystem *pSystem,
               std::vector<Component*> &sVector,
               std::vector<Component*> &cVector,
@@ -110,7 +1267,11 @@ void simSlave(ComponentSystem *pSystem,
               BarrierLock *pBarrier_S,
               BarrierLock *pBarrier_C,
               BarrierLock *pBarrier_Q,
-              BarrierLock *pBarrier_N)
+              BarrierLock *pBarrier_N,
+              LoadRebalancer *pRebalancer,
+              size_t threadIdx,
+              SignalComponentSchedule *pSignalSchedule,
+              SimulationProfiler *pProfiler)
 {
     (void)nVector;
 
@@ -119,47 +1280,64 @@ void simSlave(ComponentSystem *pSystem,
     for(size_t i=0; i<numSimSteps; ++i)
     {
         time += timeStep;
+        const bool measure = pRebalancer && pRebalancer->isSampleStep(i);
+        double waitStart;
+        SimulationProfiler::TicksT profileStart;
 
         //! Signal Components !//
 
+        waitStart = measure ? LoadRebalancer::getCurrentTime() : 0;
+        profileStart = pProfiler ? SimulationProfiler::getTicks() : 0;
         pBarrier_S->increment();
-        while(pBarrier_S->isLocked()){}                         //Wait at S barrier
+        pBarrier_S->waitWhileLocked();                          //Wait at S barrier
         if(pSystem->wasSimulationAborted()) break;
+        if(measure) pRebalancer->addWaitTime(threadIdx, LoadRebalancer::SignalPhase, LoadRebalancer::getCurrentTime()-waitStart);
+        if(pProfiler) pProfiler->addWaitTime(threadIdx, SimulationProfiler::SignalPhase, profileStart, SimulationProfiler::getTicks(), i);
 
-        for(size_t i=0; i<sVector.size(); ++i)
+        if(pSignalSchedule)
         {
-            sVector[i]->simulate(time);
+            profileStart = pProfiler ? SimulationProfiler::getTicks() : 0;
+            pSignalSchedule->simulate(threadIdx, time, pSystem);
+            if(pProfiler) pProfiler->addPhaseTime(threadIdx, SimulationProfiler::SignalPhase, profileStart, SimulationProfiler::getTicks(), i);
+        }
+        else
+        {
+            simulatePhase(sVector, time, measure ? pRebalancer : 0, threadIdx, LoadRebalancer::SignalPhase, pProfiler, i);
         }
 
 
         //! C Components !//
 
+        waitStart = measure ? LoadRebalancer::getCurrentTime() : 0;
+        profileStart = pProfiler ? SimulationProfiler::getTicks() : 0;
         pBarrier_C->increment();
-        while(pBarrier_C->isLocked()){}                         //Wait at C barrier
+        pBarrier_C->waitWhileLocked();                          //Wait at C barrier
         if(pSystem->wasSimulationAborted()) break;
+        if(measure) pRebalancer->addWaitTime(threadIdx, LoadRebalancer::CPhase, LoadRebalancer::getCurrentTime()-waitStart);
+        if(pProfiler) pProfiler->addWaitTime(threadIdx, SimulationProfiler::CPhase, profileStart, SimulationProfiler::getTicks(), i);
 
-        for(size_t i=0; i<cVector.size(); ++i)
-        {
-            cVector[i]->simulate(time);
-        }
+        simulatePhase(cVector, time, measure ? pRebalancer : 0, threadIdx, LoadRebalancer::CPhase, pProfiler, i);
 
 
         //! Q Components !//
 
+        waitStart = measure ? LoadRebalancer::getCurrentTime() : 0;
+        profileStart = pProfiler ? SimulationProfiler::getTicks() : 0;
         pBarrier_Q->increment();
-        while(pBarrier_Q->isLocked()){}                         //Wait at Q barrier
+        pBarrier_Q->waitWhileLocked();                          //Wait at Q barrier
         if(pSystem->wasSimulationAborted()) break;
+        if(measure) pRebalancer->addWaitTime(threadIdx, LoadRebalancer::QPhase, LoadRebalancer::getCurrentTime()-waitStart);
+        if(pProfiler) pProfiler->addWaitTime(threadIdx, SimulationProfiler::QPhase, profileStart, SimulationProfiler::getTicks(), i);
 
-        for(size_t i=0; i<qVector.size(); ++i)
-        {
-            qVector[i]->simulate(time);
-        }
+        simulatePhase(qVector, time, measure ? pRebalancer : 0, threadIdx, LoadRebalancer::QPhase, pProfiler, i);
 
         //! Log Nodes !//
 
+        profileStart = pProfiler ? SimulationProfiler::getTicks() : 0;
         pBarrier_N->increment();
-        while(pBarrier_N->isLocked()){}                         //Wait at N barrier
+        pBarrier_N->waitWhileLocked();                          //Wait at N barrier
         if(pSystem->wasSimulationAborted()) break;
+        if(pProfiler) pProfiler->addWaitTime(threadIdx, SimulationProfiler::LogPhase, profileStart, SimulationProfiler::getTicks(), i);
         //! @todo Temporary hack by Peter, after rewriting how node data and time is logged this no longer works, now master thread loags all nodes, need to come up with something smart
         //            for(size_t i=0; i<mVectorN.size(); ++i)
         //            {
@@ -184,10 +1362,14 @@ void simSlave(ComponentSystem *pSystem,
 //! @param *pBarrier_C Pointer to barrier before C-type components
 //! @param *pBarrier_Q Pointer to barrier before Q-type components
 //! @param *pBarrier_N Pointer to barrier before node logging
+//! @param *pRebalancer Pointer to the load rebalancer that measures the load and moves components between the threads, or 0 to disable
+//! @param *pSignalSchedule Pointer to the schedule for the signal components, or 0 to simulate sVector without waiting for other threads
+//! @param *pProfiler Pointer to the simulation profiler, or 0 if the simulation is not profiled
 void simMaster(ComponentSystem *pSystem, std::vector<Component *> &sVector, std::vector<Component *> &cVector,
                std::vector<Component *> &qVector, std::vector<Node *> &nVector, std::vector<double *> &pSimTimes, double startTime, double timeStep,
                size_t numSimSteps, BarrierLock *pBarrier_S, BarrierLock *pBarrier_C,
-               BarrierLock *pBarrier_Q, BarrierLock *pBarrier_N)
+               BarrierLock *pBarrier_Q, BarrierLock *pBarrier_N, LoadRebalancer *pRebalancer, SignalComponentSchedule *pSignalSchedule,
+               SimulationProfiler *pProfiler)
 {
     (void)nVector;
 
@@ -196,19 +1378,14 @@ void simMaster(ComponentSystem *pSystem, std::vector<Component *> &sVector, std:
     for(size_t s=0; s<numSimSteps; ++s)
     {
         time += timeStep;
+        const bool measure = pRebalancer && pRebalancer->isSampleStep(s);
+        double waitStart;
+        SimulationProfiler::TicksT profileStart;
 
         //! Signal Components !//
-        bool stop=false;
-        while(!pBarrier_S->allArrived())   //Wait for all other threads to arrive at signal barrier
-        {
-            if(pSystem->wasSimulationAborted())
-            {
-                stop=true;
-                break;
-            }
-
-        }
-        if(stop)
+        waitStart = measure ? LoadRebalancer::getCurrentTime() : 0;
+        profileStart = pProfiler ? SimulationProfiler::getTicks() : 0;
+        if(!pBarrier_S->waitForAllArrived(pSystem))   //Wait for all other threads to arrive at signal barrier
         {
             pBarrier_S->unlock();
             pBarrier_C->unlock();
@@ -216,25 +1393,26 @@ void simMaster(ComponentSystem *pSystem, std::vector<Component *> &sVector, std:
             pBarrier_N->unlock();
             break;
         }
+        if(measure) pRebalancer->addWaitTime(0, LoadRebalancer::SignalPhase, LoadRebalancer::getCurrentTime()-waitStart);
+        if(pProfiler) pProfiler->addWaitTime(0, SimulationProfiler::SignalPhase, profileStart, SimulationProfiler::getTicks(), s);
         pBarrier_C->lock();                    //Lock next barrier (must be done before unlocking this one, to prevent deadlocks)
         pBarrier_S->unlock();                  //Unlock signal barrier
 
-        for(size_t i=0; i<sVector.size(); ++i)
+        if(pSignalSchedule)
         {
-            sVector[i]->simulate(time);
+            profileStart = pProfiler ? SimulationProfiler::getTicks() : 0;
+            pSignalSchedule->simulate(0, time, pSystem);
+            if(pProfiler) pProfiler->addPhaseTime(0, SimulationProfiler::SignalPhase, profileStart, SimulationProfiler::getTicks(), s);
         }
-
-        //! C Components !//
-        stop=false;
-        while(!pBarrier_C->allArrived())   //C barrier
+        else
         {
-            if(pSystem->wasSimulationAborted())
-            {
-                stop=true;
-                break;
-            }
+            simulatePhase(sVector, time, measure ? pRebalancer : 0, 0, LoadRebalancer::SignalPhase, pProfiler, s);
         }
-        if(stop)
+
+        //! C Components !//
+        waitStart = measure ? LoadRebalancer::getCurrentTime() : 0;
+        profileStart = pProfiler ? SimulationProfiler::getTicks() : 0;
+        if(!pBarrier_C->waitForAllArrived(pSystem))   //C barrier
         {
             pBarrier_S->unlock();
             pBarrier_C->unlock();
@@ -242,25 +1420,17 @@ void simMaster(ComponentSystem *pSystem, std::vector<Component *> &sVector, std:
             pBarrier_N->unlock();
             break;
         }
+        if(measure) pRebalancer->addWaitTime(0, LoadRebalancer::CPhase, LoadRebalancer::getCurrentTime()-waitStart);
+        if(pProfiler) pProfiler->addWaitTime(0, SimulationProfiler::CPhase, profileStart, SimulationProfiler::getTicks(), s);
         pBarrier_Q->lock();
         pBarrier_C->unlock();
 
-        for(size_t i=0; i<cVector.size(); ++i)
-        {
-            cVector[i]->simulate(time);
-        }
+        simulatePhase(cVector, time, measure ? pRebalancer : 0, 0, LoadRebalancer::CPhase, pProfiler, s);
 
         //! Q Components !//
-        stop=false;
-        while(!pBarrier_Q->allArrived()) //Q barrier
-        {
-            if(pSystem->wasSimulationAborted())
-            {
-                stop=true;
-                break;
-            }
-        }
-        if(stop)
+        waitStart = measure ? LoadRebalancer::getCurrentTime() : 0;
+        profileStart = pProfiler ? SimulationProfiler::getTicks() : 0;
+        if(!pBarrier_Q->waitForAllArrived(pSystem)) //Q barrier
         {
             pBarrier_S->unlock();
             pBarrier_C->unlock();
@@ -268,28 +1438,19 @@ void simMaster(ComponentSystem *pSystem, std::vector<Component *> &sVector, std:
             pBarrier_N->unlock();
             break;
         }
+        if(measure) pRebalancer->addWaitTime(0, LoadRebalancer::QPhase, LoadRebalancer::getCurrentTime()-waitStart);
+        if(pProfiler) pProfiler->addWaitTime(0, SimulationProfiler::QPhase, profileStart, SimulationProfiler::getTicks(), s);
         pBarrier_N->lock();
         pBarrier_Q->unlock();
-        for(size_t i=0; i<qVector.size(); ++i)
-        {
-            qVector[i]->simulate(time);
-        }
+
+        simulatePhase(qVector, time, measure ? pRebalancer : 0, 0, LoadRebalancer::QPhase, pProfiler, s);
 
         for(size_t i=0; i<pSimTimes.size(); ++i)
             *pSimTimes[i] = time;     //Update time in component system, so that progress bar can use it
 
         //! Log Nodes !//
-        stop=false;
-        while(!pBarrier_N->allArrived()) //N barrier
-        {
-            if(pSystem->wasSimulationAborted())
-            {
-                stop=true;
-                break;
-            }
-
-        }
-        if(stop)
+        profileStart = pProfiler ? SimulationProfiler::getTicks() : 0;
+        if(!pBarrier_N->waitForAllArrived(pSystem)) //N barrier
         {
             pBarrier_S->unlock();
             pBarrier_C->unlock();
@@ -297,6 +1458,11 @@ void simMaster(ComponentSystem *pSystem, std::vector<Component *> &sVector, std:
             pBarrier_N->unlock();
             break;
         }
+        if(measure)
+        {
+            pRebalancer->endSampleStep();      //All other threads are waiting, so components can be moved between them
+        }
+        if(pProfiler) pProfiler->addWaitTime(0, SimulationProfiler::LogPhase, profileStart, SimulationProfiler::getTicks(), s);
         pBarrier_S->lock();
         pBarrier_N->unlock();
 
@@ -305,8 +1471,77 @@ void simMaster(ComponentSystem *pSystem, std::vector<Component *> &sVector, std:
         //            {
         //                mVectorN[i]->logData(time);
         //            }
+        profileStart = pProfiler ? SimulationProfiler::getTicks() : 0;
         pSystem->logTimeAndNodes(s+1); //s+1 since at s=0 one simulation has been performed /Björn
+        if(pProfiler) pProfiler->addPhaseTime(0, SimulationProfiler::LogPhase, profileStart, SimulationProfiler::getTicks(), s);
+    }
+}
+
+
+//! @brief Function for the master simulation thread using a task pool
+//! @details The master thread opens each pool in turn and simulates components from it together with the slave threads
+//! @param pSystem Pointer to the top level component system
+//! @param pTaskPoolS Task pool with signal components, only simulated by the master thread
+//! @param pTaskPoolC Task pool with C-type components
+//! @param pTaskPoolQ Task pool with Q-type components
+//! @param pSimTimes Pointers to the simulation time variables in the component systems
+//! @param pTime Pointer to the current simulation time, shared with the slave threads
+//! @param pStop Pointer to the stop flag for the slave threads, set when the simulation is finished
+//! @param timeStep Step time of simulation
+//! @param numSimSteps Number of steps to simulate
+void simPoolMaster(ComponentSystem *pSystem, TaskPool *pTaskPoolS, TaskPool *pTaskPoolC, TaskPool *pTaskPoolQ, std::vector<double *> &pSimTimes,
+                   std::atomic<double> *pTime, std::atomic<bool> *pStop, double timeStep, size_t numSimSteps)
+{
+    Component *pComp;
+    for(size_t i=0; i<numSimSteps; ++i)
+    {
+        *pTime = *pTime+timeStep;
+
+        //S-pool
+        pTaskPoolS->open();
+        pComp = pTaskPoolS->getComponent();
+        while(pComp)
+        {
+            pComp->simulate(*pTime);
+            pTaskPoolS->reportDone();
+            pComp = pTaskPoolS->getComponent();
+        }
+        pTaskPoolS->waitUntilReady();
+        pTaskPoolS->close();
+
+        //C-pool
+        pTaskPoolC->open();
+        pComp = pTaskPoolC->getComponent();
+        while(pComp)
+        {
+            pComp->simulate(*pTime);
+            pTaskPoolC->reportDone();
+            pComp = pTaskPoolC->getComponent();
+        }
+        pTaskPoolC->waitUntilReady();
+        pTaskPoolC->close();
+
+        //Q-pool
+        pTaskPoolQ->open();
+        pComp = pTaskPoolQ->getComponent();
+        while(pComp)
+        {
+            pComp->simulate(*pTime);
+            pTaskPoolQ->reportDone();
+            pComp = pTaskPoolQ->getComponent();
+        }
+        pTaskPoolQ->waitUntilReady();
+        pTaskPoolQ->close();
+
+        for(size_t t=0; t<pSimTimes.size(); ++t)
+            *pSimTimes[t] = *pTime;
+
+        pSystem->logTimeAndNodes(i+1);            //Log all nodes
     }
+    *pStop=true;
+    // Wake up slave threads that are waiting for a pool to open
+    pTaskPoolC->close();
+    pTaskPoolQ->close();
 }
 
 
@@ -317,6 +1552,7 @@ void simPoolSlave(TaskPool *pTaskPoolC, TaskPool *pTaskPoolQ, std::atomic<double
     while(!(*pStop))
     {
         //C-pool
+        pTaskPoolC->waitUntilOpen(pStop);
         if(pTaskPoolC->isOpen())
         {
             pComp = pTaskPoolC->getComponent();
@@ -326,10 +1562,11 @@ void simPoolSlave(TaskPool *pTaskPoolC, TaskPool *pTaskPoolQ, std::atomic<double
                 pTaskPoolC->reportDone();
                 pComp = pTaskPoolC->getComponent();
             }
-            while(pTaskPoolC->isOpen()) {}
+            pTaskPoolC->waitWhileOpen();
         }
 
         //Q-pool
+        pTaskPoolQ->waitUntilOpen(pStop);
         if(pTaskPoolQ->isOpen())
         {
             pComp = pTaskPoolQ->getComponent();
@@ -339,17 +1576,62 @@ void simPoolSlave(TaskPool *pTaskPoolC, TaskPool *pTaskPoolQ, std::atomic<double
                 pTaskPoolQ->reportDone();
                 pComp = pTaskPoolQ->getComponent();
             }
-            while(pTaskPoolQ->isOpen()) {}
+            pTaskPoolQ->waitWhileOpen();
+        }
+    }
+}
+
+
+//! @brief Simulates the components left in the own deque of a thread, and then steals components from the other threads until all deques are empty
+//! @param pUnFinishedDeques Deques with components that have not yet been simulated in this phase, one per thread
+//! @param pFinishedDeque Deque owned by this thread where simulated components are put, it becomes the unfinished deque of the thread in the next step
+//! @param nThreads Number of threads
+//! @param threadID Index of this thread
+//! @param time Time to simulate to
+static inline void simulateOwnAndStolen(std::vector<WorkStealingDeque*> *pUnFinishedDeques, WorkStealingDeque *pFinishedDeque,
+                                        const size_t nThreads, const size_t threadID, const double time)
+{
+    //Simulate own components
+    WorkStealingDeque *pOwnDeque = pUnFinishedDeques->at(threadID);
+    Component *pComp = pOwnDeque->pop();
+    while(pComp)
+    {
+        pComp->simulate(time);
+        pFinishedDeque->push(pComp);
+        pComp = pOwnDeque->pop();
+    }
+
+    //Steal components, a failed steal on a non-empty deque means that another thread took the component first, so try again
+    bool haveVictims = (nThreads > 1);
+    while(haveVictims)
+    {
+        haveVictims = false;
+        for(size_t i=0; i<nThreads-1; ++i)
+        {
+            WorkStealingDeque *pVictim = pUnFinishedDeques->at((threadID+1+i)%nThreads);
+            pComp = pVictim->steal();
+            if(pComp)
+            {
+                pComp->simulate(time);
+                pFinishedDeque->push(pComp);
+                haveVictims = true;
+            }
+            else if(!pVictim->isEmpty())
+            {
+                haveVictims = true;
+            }
         }
     }
 }
 
 
 //! @brief Function for master simulation thread, that is responsible for synchronizing the simulation
+//! @details Each thread owns one deque with unfinished and one with finished C- and Q-components. When a thread has simulated its own components
+//! it steals from the other threads. Stolen components are put in the finished deque of the thief, so they belong to the thief in the next step.
 void simStealingMaster(ComponentSystem *pSystem,
                        std::vector<Component *> &sVector,
-                       std::vector<ThreadSafeVector *> *cVectors,
-                       std::vector<ThreadSafeVector *> *qVectors,
+                       std::vector<WorkStealingDeque *> *cVectors,
+                       std::vector<WorkStealingDeque *> *qVectors,
                        std::vector<double *> &pSimTimes,
                        double startTime,
                        double timeStep,
@@ -362,14 +1644,13 @@ void simStealingMaster(ComponentSystem *pSystem,
                        BarrierLock *pBarrier_N,
                        size_t maxSize)
 {
-    ThreadSafeVector *pTemp;
-    Component *pComp;
+    WorkStealingDeque *pTemp;
 
     double time = startTime;
-    std::vector<ThreadSafeVector*> *pUnFinishedVectorsC = cVectors;
-    std::vector<ThreadSafeVector*> *pUnFinishedVectorsQ = qVectors;
-    ThreadSafeVector *pFinishedVectorC = new ThreadSafeVector(std::vector<Component*>(), maxSize);
-    ThreadSafeVector *pFinishedVectorQ = new ThreadSafeVector(std::vector<Component*>(), maxSize);
+    std::vector<WorkStealingDeque*> *pUnFinishedVectorsC = cVectors;
+    std::vector<WorkStealingDeque*> *pUnFinishedVectorsQ = qVectors;
+    WorkStealingDeque *pFinishedVectorC = new WorkStealingDeque(std::vector<Component*>(), maxSize);
+    WorkStealingDeque *pFinishedVectorQ = new WorkStealingDeque(std::vector<Component*>(), maxSize);
 
     for(size_t s=0; s<numSimSteps; ++s)
     {
@@ -379,7 +1660,7 @@ void simStealingMaster(ComponentSystem *pSystem,
 
         //! Signal Components !//
 
-        while(!pBarrier_S->allArrived()) {}
+        pBarrier_S->waitForAllArrived();
         pBarrier_C->lock();
         pBarrier_S->unlock();
 
@@ -391,7 +1672,7 @@ void simStealingMaster(ComponentSystem *pSystem,
 
         //! C Components !//
 
-        while(!pBarrier_C->allArrived()) {}    //C barrier
+        pBarrier_C->waitForAllArrived();       //C barrier
         pBarrier_Q->lock();
         pBarrier_C->unlock();
 
@@ -402,34 +1683,11 @@ void simStealingMaster(ComponentSystem *pSystem,
         pUnFinishedVectorsQ->at(threadID) = pFinishedVectorQ;
         pFinishedVectorQ = pTemp;
 
-        //Simulate own components
-        pComp = pUnFinishedVectorsC->at(threadID)->tryAndTakeFirst();
-        while(pComp)
-        {
-            pComp->simulate(time);
-            pFinishedVectorC->insertFirst(pComp);
-            pComp = pUnFinishedVectorsC->at(threadID)->tryAndTakeFirst();
-        }
-
-        //Steal components
-        //if(int(time/timeStep/5+threadID)%nThreads == 0)
-        {
-            for(size_t i=0; i<nThreads-1; ++i)
-            {
-                int j = (threadID+1+i)%nThreads;
-                pComp = pUnFinishedVectorsC->at(j)->tryAndTakeLast();
-                if(pComp)
-                {
-                    pComp->simulate(time);
-                    pFinishedVectorC->insertLast(pComp);
-                    break;
-                }
-            }
-        }
+        simulateOwnAndStolen(pUnFinishedVectorsC, pFinishedVectorC, nThreads, threadID, time);
 
         //! Q Components !//
 
-        while(!pBarrier_Q->allArrived()) {}    //Q barrier
+        pBarrier_Q->waitForAllArrived();       //Q barrier
         pBarrier_N->lock();
         pBarrier_Q->unlock();
 
@@ -440,47 +1698,28 @@ void simStealingMaster(ComponentSystem *pSystem,
         pUnFinishedVectorsC->at(threadID) = pFinishedVectorC;
         pFinishedVectorC = pTemp;
 
-        //Simulate own components
-        pComp = pUnFinishedVectorsQ->at(threadID)->tryAndTakeFirst();
-        while(pComp)
-        {
-            pComp->simulate(time);
-            pFinishedVectorQ->insertFirst(pComp);
-            pComp = pUnFinishedVectorsQ->at(threadID)->tryAndTakeFirst();
-        }
-
-        //Steal components
-        //if(int(time/timeStep/5+mThreadID)%nThreads == 0)
-        {
-            for(size_t i=0; i<nThreads-1; ++i)
-            {
-                int j = (threadID+1+i)%nThreads;
-                pComp = pUnFinishedVectorsQ->at(j)->tryAndTakeLast();
-                if(pComp)
-                {
-                    pComp->simulate(time);
-                    pFinishedVectorQ->insertLast(pComp);
-                    break;
-                }
-            }
-        }
+        simulateOwnAndStolen(pUnFinishedVectorsQ, pFinishedVectorQ, nThreads, threadID, time);
 
         for(size_t i=0; i<pSimTimes.size(); ++i)
             *pSimTimes[i] = time;
 
         //! Log Nodes !//
 
-        while(!pBarrier_N->allArrived()) {}    //N barrier
+        pBarrier_N->waitForAllArrived();       //N barrier
         pBarrier_S->lock();
         pBarrier_N->unlock();
 
         pSystem->logTimeAndNodes(s+1);
     }
+
+    // The deques only refer to the components, so they can be deleted regardless of what they contain
+    delete pFinishedVectorC;
+    delete pFinishedVectorQ;
 }
 
 void simStealingSlave(ComponentSystem *pSystem,
-                      std::vector<ThreadSafeVector *> *cVectors,
-                      std::vector<ThreadSafeVector *> *qVectors,
+                      std::vector<WorkStealingDeque *> *cVectors,
+                      std::vector<WorkStealingDeque *> *qVectors,
                       double startTime,
                       double timeStep,
                       size_t numSimSteps,
@@ -493,16 +1732,13 @@ void simStealingSlave(ComponentSystem *pSystem,
                       size_t maxSize)
 
 {
-    double time = startTime;;
-    std::vector<ThreadSafeVector*> *pUnFinishedVectorsC = cVectors;
-    std::vector<ThreadSafeVector*> *pUnFinishedVectorsQ = qVectors;
-    //! @todo memory leak, never deleted, however, dont delete in destructor, that will cause double free corruption since this object is copied when new tasks are created
-    ThreadSafeVector *pFinishedVectorC = new ThreadSafeVector(std::vector<Component*>(), maxSize);
-    ThreadSafeVector *pFinishedVectorQ = new ThreadSafeVector(std::vector<Component*>(), maxSize);
-
+    double time = startTime;
+    std::vector<WorkStealingDeque*> *pUnFinishedVectorsC = cVectors;
+    std::vector<WorkStealingDeque*> *pUnFinishedVectorsQ = qVectors;
+    WorkStealingDeque *pFinishedVectorC = new WorkStealingDeque(std::vector<Component*>(), maxSize);
+    WorkStealingDeque *pFinishedVectorQ = new WorkStealingDeque(std::vector<Component*>(), maxSize);
 
-    ThreadSafeVector *pTemp;
-    Component *pComp;
+    WorkStealingDeque *pTemp;
 
     for(size_t i=0; i<numSimSteps; ++i)
     {
@@ -513,12 +1749,12 @@ void simStealingSlave(ComponentSystem *pSystem,
         //! Signal Components !//
 
         pBarrier_S->increment();
-        while(pBarrier_S->isLocked()){}                         //Wait at S barrier
+        pBarrier_S->waitWhileLocked();                          //Wait at S barrier
 
         //! C Components !//
 
         pBarrier_C->increment();
-        while(pBarrier_C->isLocked()){}                         //Wait at C barrier
+        pBarrier_C->waitWhileLocked();                          //Wait at C barrier
 
         //C-COMPONENTS
 
@@ -527,35 +1763,12 @@ void simStealingSlave(ComponentSystem *pSystem,
         pUnFinishedVectorsQ->at(threadID) = pFinishedVectorQ;
         pFinishedVectorQ = pTemp;
 
-        //Simulate own components
-        pComp = pUnFinishedVectorsC->at(threadID)->tryAndTakeFirst();
-        while(pComp)
-        {
-            pComp->simulate(time);
-            pFinishedVectorC->insertFirst(pComp);
-            pComp = pUnFinishedVectorsC->at(threadID)->tryAndTakeFirst();
-        }
-
-        //Steal components
-        //if(int(time/timeStep/5+mThreadID)%mnThreads == 0)
-        {
-            for(size_t i=0; i<nThreads-1; ++i)
-            {
-                int j = (threadID+1+i)%nThreads;
-                pComp = pUnFinishedVectorsC->at(j)->tryAndTakeLast();
-                if(pComp)
-                {
-                    pComp->simulate(time);
-                    pFinishedVectorC->insertLast(pComp);
-                    break;
-                }
-            }
-        }
+        simulateOwnAndStolen(pUnFinishedVectorsC, pFinishedVectorC, nThreads, threadID, time);
 
         //! Q Components !//
 
         pBarrier_Q->increment();
-        while(pBarrier_Q->isLocked()){}                         //Wait at Q barrier
+        pBarrier_Q->waitWhileLocked();                          //Wait at Q barrier
 
         //Q-COMPONENTS
 
@@ -564,36 +1777,16 @@ void simStealingSlave(ComponentSystem *pSystem,
         pUnFinishedVectorsC->at(threadID) = pFinishedVectorC;
         pFinishedVectorC = pTemp;
 
-        //Simulate own components
-        pComp = pUnFinishedVectorsQ->at(threadID)->tryAndTakeFirst();
-        while(pComp)
-        {
-            pComp->simulate(time);
-            pFinishedVectorQ->insertFirst(pComp);
-            pComp = pUnFinishedVectorsQ->at(threadID)->tryAndTakeFirst();
-        }
-
-        //Steal components
-        //if(int(time/timeStep/5+mThreadID)%mnThreads == 0)
-        {
-            for(size_t i=0; i<nThreads-1; ++i)
-            {
-                int j = (threadID+1+i)%nThreads;
-                pComp = pUnFinishedVectorsQ->at(j)->tryAndTakeLast();
-                if(pComp)
-                {
-                    pComp->simulate(time);
-                    pFinishedVectorQ->insertLast(pComp);
-                    break;
-                }
-            }
-        }
+        simulateOwnAndStolen(pUnFinishedVectorsQ, pFinishedVectorQ, nThreads, threadID, time);
 
         //! Log Nodes !//
 
         pBarrier_N->increment();
-        while(pBarrier_N->isLocked()){}                         //Wait at N barrier
+        pBarrier_N->waitWhileLocked();                          //Wait at N barrier
     }
+
+    delete pFinishedVectorC;
+    delete pFinishedVectorQ;
 }
 
 void simOneComponentOneStep(Component *pComp, double stopTime)
@@ -624,41 +1817,6 @@ void simWholeSystems(std::vector<ComponentSystem *> systemPtrs, double stopTime)
     }
 }
 
-//! @brief Function for simulating whole systems multi-threaded
-//! @param systemPtrs Vector with pointers to the systems to simulate
-//! @param stopTime Stop time of simulation
-void simWholeSystemInRealtime(double realTimeFactor, volatile bool *pStopSimulation, double *pTime, double timeStep, std::vector<Component*> signalComponentPtrs, std::vector<Component*> cComponentPtrs, std::vector<Component*> qComponentPtrs)
-{
-#if (__cplusplus >= 201103L)
-    auto wallTime = std::chrono::steady_clock::now();
-
-    while(!(*pStopSimulation)) {
-        *pTime += timeStep; //mTime is updated here before the simulation,
-        //mTime is the current time during the simulateOneTimestep
-
-        //Signal components
-        for(const auto &sComponent : signalComponentPtrs) {
-            sComponent->simulate(*pTime);
-        }
-
-        //C components
-        for(const auto &cComponent : cComponentPtrs) {
-            cComponent->simulate(*pTime);
-        }
-
-        //Q components
-        for(const auto &qComponent : qComponentPtrs) {
-            qComponent->simulate(*pTime);
-        }
-
-        wallTime += std::chrono::microseconds(int(1000000*timeStep/realTimeFactor));
-        std::this_thread::sleep_until(wallTime);
-    }
-#else
-    return;
-#endif
-}
-
 #endif //Multithreading
 
 }
@@ -0,0 +1,283 @@
+/*-----------------------------------------------------------------------------
+
+ Copyright 2017 Hopsan Group
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+
+
+ The full license is available in the file LICENSE.
+ For details about the 'Hopsan Group' or information about Authors and
+ Contributors see the HOPSANGROUP and AUTHORS files that are located in
+ the Hopsan source code root directory.
+
+-----------------------------------------------------------------------------*/
+
+//$Id$
+
+#include "CoreUtilities/RealtimeExecutor.h"
+#include "ComponentSystem.h"
+#include "ComponentUtilities/num2string.hpp"
+
+#include <cerrno>
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <chrono>
+
+#if defined(__linux__)
+#include <pthread.h>
+#include <sched.h>
+#include <sys/mman.h>
+#include <time.h>
+#endif
+
+using namespace std;
+using namespace hopsan;
+
+namespace {
+
+//! @brief Returns the time of the monotonic clock in ns
+int64_t monotonicTime()
+{
+#if defined(__linux__)
+    timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return int64_t(ts.tv_sec)*1000000000 + int64_t(ts.tv_nsec);
+#else
+    return chrono::duration_cast<chrono::nanoseconds>(chrono::steady_clock::now().time_since_epoch()).count();
+#endif
+}
+
+//! @brief Sleep until an absolute time of the monotonic clock
+//! @param[in] time The time to wake up at in ns, returns immediately if it has already passed
+void sleepUntil(const int64_t time)
+{
+#if defined(__linux__)
+    timespec ts;
+    ts.tv_sec = time_t(time/1000000000);
+    ts.tv_nsec = long(time%1000000000);
+    while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, 0) == EINTR) {}
+#else
+    this_thread::sleep_until(chrono::steady_clock::time_point(chrono::duration_cast<chrono::steady_clock::duration>(chrono::nanoseconds(time))));
+#endif
+}
+
+}
+
+RealtimeOptions::RealtimeOptions()
+{
+    realTimeFactor = 1;
+    stopTime = numeric_limits<double>::infinity();
+    useFifoScheduling = false;
+    fifoPriority = 80;
+    cpu = -1;
+    lockMemory = false;
+    overrunPolicy = CatchUpOverrunPolicy;
+}
+
+RealtimeStatistics::RealtimeStatistics()
+{
+    numSteps = 0;
+    numOverruns = 0;
+    numSkippedPeriods = 0;
+}
+
+RealtimeExecutor::RealtimeExecutor()
+{
+    mpSystem = 0;
+    mStopRequested = false;
+    mIsRunning = false;
+    mWasAborted = false;
+    mHasLockedMemory = false;
+}
+
+RealtimeExecutor::~RealtimeExecutor()
+{
+    stop();
+}
+
+//! @brief Start simulating a system in real time
+//! @details The system must be initialized. Failing to apply the scheduling, pinning or memory locking options gives a warning,
+//! the simulation is started anyway.
+//! @param[in] pSystem The system to simulate, it must not be simulated by anything else until the executor is stopped
+//! @param[in] rOptions The real-time settings
+//! @returns True if the simulation thread was started
+bool RealtimeExecutor::start(ComponentSystem *pSystem, const RealtimeOptions &rOptions)
+{
+    stop();
+    if (!(rOptions.realTimeFactor > 0))
+    {
+        pSystem->addErrorMessage("The real-time factor must be larger than zero");
+        return false;
+    }
+
+    mpSystem = pSystem;
+    mOptions = rOptions;
+    mStopRequested = false;
+    mWasAborted = false;
+
+    if (mOptions.lockMemory)
+    {
+#if defined(__linux__)
+        if (mlockall(MCL_CURRENT | MCL_FUTURE) == 0)
+        {
+            mHasLockedMemory = true;
+        }
+        else
+        {
+            mpSystem->addWarningMessage(HString("Could not lock the memory for real-time simulation: ")+strerror(errno));
+        }
+#else
+        mpSystem->addWarningMessage("Locking the memory for real-time simulation is only supported on Linux");
+#endif
+    }
+
+    // The simulation thread waits for the statistics mutex before its first step, so it is configured before it starts simulating
+    lock_guard<mutex> lock(mStatisticsMutex);
+    mStatistics = RealtimeStatistics();
+    mIsRunning = true;
+    mThread = thread(&RealtimeExecutor::run, this);
+
+#if defined(__linux__)
+    if (mOptions.cpu >= 0)
+    {
+        cpu_set_t cpu;
+        CPU_ZERO(&cpu);
+        int rc = EINVAL;
+        if (mOptions.cpu < CPU_SETSIZE)
+        {
+            CPU_SET(mOptions.cpu, &cpu);
+            rc = pthread_setaffinity_np(mThread.native_handle(), sizeof(cpu), &cpu);
+        }
+        if (rc != 0)
+        {
+            mpSystem->addWarningMessage("Could not pin the real-time simulation thread to CPU "+to_hstring(mOptions.cpu)+": "+strerror(rc));
+        }
+    }
+    if (mOptions.useFifoScheduling)
+    {
+        sched_param param;
+        memset(&param, 0, sizeof(param));
+        param.sched_priority = max(sched_get_priority_min(SCHED_FIFO), min(mOptions.fifoPriority, sched_get_priority_max(SCHED_FIFO)));
+        const int rc = pthread_setschedparam(mThread.native_handle(), SCHED_FIFO, &param);
+        if (rc != 0)
+        {
+            mpSystem->addWarningMessage(HString("Could not use SCHED_FIFO scheduling for the real-time simulation thread: ")+strerror(rc));
+        }
+    }
+#else
+    if (mOptions.cpu >= 0 || mOptions.useFifoScheduling)
+    {
+        mpSystem->addWarningMessage("CPU pinning and SCHED_FIFO scheduling of the real-time simulation thread are only supported on Linux");
+    }
+#endif
+    return true;
+}
+
+//! @brief Stop the simulation and wait for the simulation thread to finish
+//! @details The statistics are kept until the executor is started again
+void RealtimeExecutor::stop()
+{
+    mStopRequested = true;
+    if (mThread.joinable())
+    {
+        mThread.join();
+    }
+#if defined(__linux__)
+    if (mHasLockedMemory)
+    {
+        munlockall();
+    }
+#endif
+    mHasLockedMemory = false;
+}
+
+//! @brief Returns true while the simulation thread is simulating
+//! @details It stops running when it is stopped, when it reaches the stop time, or when the simulation is aborted
+bool RealtimeExecutor::isRunning() const
+{
+    return mIsRunning;
+}
+
+//! @brief Returns true if the simulation was aborted because of a missed deadline with AbortOverrunPolicy
+bool RealtimeExecutor::wasAborted() const
+{
+    return mWasAborted;
+}
+
+//! @brief Returns a copy of the statistics, it can be called while the simulation is running
+//! @details The simulation thread publishes the statistics after each step, unless a reader is copying them at the same time
+RealtimeStatistics RealtimeExecutor::getStatistics() const
+{
+    lock_guard<mutex> lock(mStatisticsMutex);
+    return mStatistics;
+}
+
+void RealtimeExecutor::run()
+{
+    // Wait until start() has configured this thread
+    mStatisticsMutex.lock();
+    mStatisticsMutex.unlock();
+
+    const double timestep = mpSystem->getTimestep();
+    const int64_t period = max(int64_t(1), int64_t(1e9*timestep/mOptions.realTimeFactor+0.5));
+    const double stopTime = mOptions.stopTime-0.5*timestep;
+
+    RealtimeStatistics statistics;
+    int64_t releaseTime = monotonicTime();
+    while (!mStopRequested && (mpSystem->getTime() < stopTime))
+    {
+        sleepUntil(releaseTime);
+        const int64_t stepStart = monotonicTime();
+        mpSystem->simulate(mpSystem->getTime()+timestep);
+        const int64_t stepEnd = monotonicTime();
+        if (mpSystem->wasSimulationAborted())
+        {
+            break;
+        }
+
+        ++statistics.numSteps;
+        statistics.jitter.add(stepStart-releaseTime);
+        statistics.executionTime.add(stepEnd-stepStart);
+        int64_t deadline = releaseTime+period;
+        if (stepEnd > deadline)
+        {
+            ++statistics.numOverruns;
+            statistics.overrun.add(stepEnd-deadline);
+            if (mOptions.overrunPolicy == AbortOverrunPolicy)
+            {
+                mWasAborted = true;
+                mpSystem->stopSimulation("Real-time deadline missed by "+to_hstring(double(stepEnd-deadline)*1e-6, 6)+" ms");
+                break;
+            }
+            else if (mOptions.overrunPolicy == SkipOverrunPolicy)
+            {
+                const int64_t numMissedPeriods = (stepEnd-deadline)/period+1;
+                statistics.numSkippedPeriods += size_t(numMissedPeriods);
+                deadline += numMissedPeriods*period;
+            }
+            // With CatchUpOverrunPolicy the next step is released at its deadline, that has already passed
+        }
+        releaseTime = deadline;
+
+        if (mStatisticsMutex.try_lock())
+        {
+            mStatistics = statistics;
+            mStatisticsMutex.unlock();
+        }
+    }
+
+    lock_guard<mutex> lock(mStatisticsMutex);
+    mStatistics = statistics;
+    mIsRunning = false;
+}
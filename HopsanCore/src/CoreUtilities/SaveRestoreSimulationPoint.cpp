@@ -25,54 +25,279 @@
 //$Id$
 
 #include "CoreUtilities/SaveRestoreSimulationPoint.h"
+#include "ComponentUtilities/StateArchive.h"
 #include "ComponentSystem.h"
 #include "Component.h"
+#include "Port.h"
+#include "Node.h"
+#include "ComponentUtilities/num2string.hpp"
 
 #include <vector>
 #include <fstream>
 #include <cstring>
+#include <algorithm>
+#include <cstdint>
 
 using namespace hopsan;
 
 /*
- * Port head
+ * Simulation point file format (version 2)
  *
- * DataIdentifier   FullNameLength  NumDataElements (double)
- * 2-byte           2-byte          2-byte
+ * Header
+ *   Magic            Version          Time        NumEntries
+ *   4-byte "HSPT"    uint32           double      uint64
+ *
+ * Index (NumEntries records, sorted by PathHash and then by Type)
+ *   PathHash         Type             Offset      Size
+ *   uint64           uint32           uint64      uint64
+ *
+ * Data
+ *   The entry data, Offset is counted from the beginning of the data section
+ *
+ * PathHash is the 64-bit FNV-1a hash of the full path of the port or component, such as "/Subsystem/Component/Port".
+ * Subports in multiports get the suffix "#<subport index>". Port entries contain the node data values (double) and
+ * component entries contain the data from Component::serializeState().
  *
+ * The legacy format (version 1) is a sequence of packages with a 2-byte identifier.
  *
+ * Legacy port head
+ *
+ * DataIdentifier   FullNameLength  NumDataElements (double)
+ * 2-byte           2-byte          2-byte
  *
  * */
 
 #define TIMEIDENTIFIER 0x02
 #define PORTIDENTIFIER 0x03
 
-void writePortData(Port *pPort, const HString &namePrefix, std::ofstream &rFile)
+namespace {
+
+const char gMagic[4] = {'H','S','P','T'};
+const uint32_t gFormatVersion = 2;
+const uint32_t gPortEntryType = 1;
+const uint32_t gComponentStateEntryType = 2;
+
+struct FileHeader
+{
+    char magic[4];
+    uint32_t version;
+    double time;
+    uint64_t numEntries;
+};
+
+struct IndexRecord
+{
+    uint64_t hash;
+    uint32_t type;
+    uint32_t reserved;
+    uint64_t offset;
+    uint64_t size;
+
+    bool operator<(const IndexRecord &rOther) const
+    {
+        return (hash < rOther.hash) || ((hash == rOther.hash) && (type < rOther.type));
+    }
+};
+
+struct Entry
+{
+    IndexRecord record;
+    std::vector<char> data;
+};
+
+//! @brief Computes the 64-bit FNV-1a hash of a path
+uint64_t hashPath(const HString &rPath)
 {
-    // Generate full name
-    HString fullName = namePrefix+pPort->getName();
-    std::vector<double> *pDataVector = pPort->getDataVectorPtr();
-    // OK great, if we have a data vector, lets dump it to file
-    if (pDataVector)
+    uint64_t hash = 14695981039346656037ULL;
+    for (size_t i=0; i<rPath.size(); ++i)
     {
-        // Write port identifier
-        size_t identifier = PORTIDENTIFIER;
-        rFile.write(reinterpret_cast<char*>(&identifier), 2);
-        size_t namelen = fullName.size();
-        rFile.write(reinterpret_cast<char*>(&namelen), 2);
-        size_t datalen = pDataVector->size();
-        rFile.write(reinterpret_cast<char*>(&datalen), 2);
-        rFile.write(fullName.c_str(), namelen);
-        rFile.write(reinterpret_cast<char*>(pDataVector->data()), datalen*sizeof(double));
+        hash ^= static_cast<unsigned char>(rPath[i]);
+        hash *= 1099511628211ULL;
     }
+    return hash;
 }
 
-void writeTimeData(double time, std::ofstream &rFile)
+//! @brief Returns the path for each node in a port, one for each subport in multiports
+std::vector<HString> getPortNodePaths(Port *pPort, const HString &rPortPath, std::vector<Node*> &rNodes)
 {
-    // Write port identifier
-    size_t identifier = TIMEIDENTIFIER;
-    rFile.write(reinterpret_cast<char*>(&identifier), 2);
-    rFile.write(reinterpret_cast<char*>(&time), sizeof(double));
+    std::vector<HString> paths;
+    rNodes.clear();
+    if (pPort->isMultiPort())
+    {
+        for (size_t i=0; i<pPort->getNumPorts(); ++i)
+        {
+            paths.push_back(rPortPath+"#"+to_hstring(i));
+            rNodes.push_back(pPort->getNodePtr(i));
+        }
+    }
+    else
+    {
+        paths.push_back(rPortPath);
+        rNodes.push_back(pPort->getNodePtr());
+    }
+    return paths;
+}
+
+void collectEntries(ComponentSystem *pSystem, const HString &rPathPrefix, std::vector<Entry> &rEntries)
+{
+    std::vector<Component*> subcomps = pSystem->getSubComponents();
+    for (size_t c=0; c<subcomps.size(); ++c)
+    {
+        Component *pComp = subcomps[c];
+        const HString compPath = rPathPrefix+pComp->getName();
+
+        std::vector<Port*> ports = pComp->getPortPtrVector();
+        for (size_t p=0; p<ports.size(); ++p)
+        {
+            std::vector<Node*> nodes;
+            std::vector<HString> paths = getPortNodePaths(ports[p], compPath+"/"+ports[p]->getName(), nodes);
+            for (size_t n=0; n<nodes.size(); ++n)
+            {
+                if (nodes[n])
+                {
+                    Entry entry;
+                    entry.record.hash = hashPath(paths[n]);
+                    entry.record.type = gPortEntryType;
+                    entry.data.resize(nodes[n]->getNumDataVariables()*sizeof(double));
+                    for (size_t d=0; d<nodes[n]->getNumDataVariables(); ++d)
+                    {
+                        const double value = nodes[n]->getDataValue(d);
+                        memcpy(entry.data.data()+d*sizeof(double), &value, sizeof(double));
+                    }
+                    rEntries.push_back(entry);
+                }
+            }
+        }
+
+        if (pComp->isComponentSystem())
+        {
+            collectEntries(static_cast<ComponentSystem*>(pComp), compPath+"/", rEntries);
+        }
+        else
+        {
+            StateArchive archive;
+            pComp->serializeState(archive);
+            if (!archive.getData().empty())
+            {
+                Entry entry;
+                entry.record.hash = hashPath(compPath);
+                entry.record.type = gComponentStateEntryType;
+                entry.data = archive.getData();
+                rEntries.push_back(entry);
+            }
+        }
+    }
+}
+
+//! @brief Helper class for looking up entries in a loaded simulation point
+class SimulationPointReader
+{
+public:
+    SimulationPointReader(const std::vector<char> &rData) : mrData(rData), mpIndex(0), mNumEntries(0), mDataOffset(0), mTime(0)
+    {
+        FileHeader header;
+        if (mrData.size() < sizeof(FileHeader))
+        {
+            return;
+        }
+        memcpy(&header, mrData.data(), sizeof(FileHeader));
+        if ((memcmp(header.magic, gMagic, 4) != 0) || (header.version != gFormatVersion))
+        {
+            return;
+        }
+        const size_t indexSize = size_t(header.numEntries)*sizeof(IndexRecord);
+        if (header.numEntries > mrData.size() || (mrData.size()-sizeof(FileHeader) < indexSize))
+        {
+            return;
+        }
+        mTime = header.time;
+        mNumEntries = size_t(header.numEntries);
+        mpIndex = reinterpret_cast<const IndexRecord*>(mrData.data()+sizeof(FileHeader));
+        mDataOffset = sizeof(FileHeader)+indexSize;
+    }
+
+    bool isValid() const
+    {
+        return mpIndex != 0;
+    }
+
+    double getTime() const
+    {
+        return mTime;
+    }
+
+    //! @brief Finds the data of an entry, returns false if the entry does not exist
+    bool find(const HString &rPath, const uint32_t type, const char *&rpData, size_t &rSize) const
+    {
+        IndexRecord key;
+        key.hash = hashPath(rPath);
+        key.type = type;
+        const IndexRecord *pEnd = mpIndex+mNumEntries;
+        const IndexRecord *pRecord = std::lower_bound(mpIndex, pEnd, key);
+        if ((pRecord == pEnd) || (pRecord->hash != key.hash) || (pRecord->type != key.type) ||
+            (pRecord->offset > mrData.size()-mDataOffset) || (pRecord->size > mrData.size()-mDataOffset-pRecord->offset))
+        {
+            return false;
+        }
+        rpData = mrData.data()+mDataOffset+pRecord->offset;
+        rSize = size_t(pRecord->size);
+        return true;
+    }
+
+private:
+    const std::vector<char> &mrData;
+    const IndexRecord *mpIndex;
+    size_t mNumEntries, mDataOffset;
+    double mTime;
+};
+
+bool restoreEntries(const SimulationPointReader &rReader, ComponentSystem *pSystem, const HString &rPathPrefix, const bool restoreComponentStates)
+{
+    bool success = true;
+    std::vector<Component*> subcomps = pSystem->getSubComponents();
+    for (size_t c=0; c<subcomps.size(); ++c)
+    {
+        Component *pComp = subcomps[c];
+        const HString compPath = rPathPrefix+pComp->getName();
+        const char *pData;
+        size_t size;
+
+        std::vector<Port*> ports = pComp->getPortPtrVector();
+        for (size_t p=0; p<ports.size(); ++p)
+        {
+            std::vector<Node*> nodes;
+            std::vector<HString> paths = getPortNodePaths(ports[p], compPath+"/"+ports[p]->getName(), nodes);
+            for (size_t n=0; n<nodes.size(); ++n)
+            {
+                if (nodes[n] && rReader.find(paths[n], gPortEntryType, pData, size))
+                {
+                    const size_t numValues = std::min(size/sizeof(double), nodes[n]->getNumDataVariables());
+                    for (size_t d=0; d<numValues; ++d)
+                    {
+                        double value;
+                        memcpy(&value, pData+d*sizeof(double), sizeof(double));
+                        nodes[n]->setDataValue(d, value);
+                    }
+                }
+            }
+        }
+
+        if (pComp->isComponentSystem())
+        {
+            success = restoreEntries(rReader, static_cast<ComponentSystem*>(pComp), compPath+"/", restoreComponentStates) && success;
+        }
+        else if (restoreComponentStates && rReader.find(compPath, gComponentStateEntryType, pData, size))
+        {
+            StateArchive archive(pData, size);
+            pComp->serializeState(archive);
+            if (!archive.isOK())
+            {
+                pComp->addErrorMessage("Could not restore the internal state of component: "+compPath+", the state in the simulation point does not match");
+                success = false;
+            }
+        }
+    }
+    return success;
 }
 
 size_t readIdentifier(std::ifstream &rFile)
@@ -82,7 +307,7 @@ size_t readIdentifier(std::ifstream &rFile)
     return identifier;
 }
 
-void readPortData(std::ifstream &rFile, ComponentSystem *pRootSystem)
+void readLegacyPortData(std::ifstream &rFile, ComponentSystem *pRootSystem)
 {
     // Read rest of header
     size_t namelength=0, datalength=0;
@@ -157,62 +382,144 @@ double readTimeData(std::ifstream &rFile)
 }
 
 
-void saveSimulationPointInternal(ComponentSystem *pRootSystem, const HString &namePrefix, std::ofstream &rFile)
+
+bool readLegacySimulationPoint(std::ifstream &rFile, ComponentSystem *pRootSystem, double &rTimeOffset)
 {
-    //! @todo not sure if we should actually save/load the simulation time
-    writeTimeData(pRootSystem->getTime(), rFile);
-    std::vector<Component*> subcomps = pRootSystem->getSubComponents();
-    for (size_t c=0; c<subcomps.size(); ++c)
+    while (!rFile.eof())
     {
-        Component *pComp = subcomps[c];
-
-        std::vector<Port*> ports = pComp->getPortPtrVector();
-        for (size_t p=0; p<ports.size(); ++p)
+        // Read identifier from next package
+        size_t id = readIdentifier(rFile);
+        switch (id)
         {
-            writePortData(ports[p], namePrefix+pComp->getName()+'/', rFile);
+        case TIMEIDENTIFIER:
+            rTimeOffset = readTimeData(rFile);
+            break;
+        case PORTIDENTIFIER:
+            readLegacyPortData(rFile, pRootSystem);
+            break;
+        default:
+            break;
         }
+    }
+    return true;
+}
 
-        if (pComp->isComponentSystem())
+}
+
+
+//! @brief Saves the node data and the internal state of all components in a system to memory, in the simulation point file format
+//! @param[in] pRootSystem The system to save
+//! @param[out] rData The simulation point data
+void hopsan::saveSimulationPointData(ComponentSystem *pRootSystem, std::vector<char> &rData)
+{
+    std::vector<Entry> entries;
+    collectEntries(pRootSystem, "/", entries);
+    std::sort(entries.begin(), entries.end(), [](const Entry &rA, const Entry &rB) { return rA.record < rB.record; });
+
+    FileHeader header;
+    memcpy(header.magic, gMagic, 4);
+    header.version = gFormatVersion;
+    //! @todo not sure if we should actually save/load the simulation time
+    header.time = pRootSystem->getTime();
+    header.numEntries = entries.size();
+
+    uint64_t offset = 0;
+    for (size_t e=0; e<entries.size(); ++e)
+    {
+        entries[e].record.reserved = 0;
+        entries[e].record.offset = offset;
+        entries[e].record.size = entries[e].data.size();
+        offset += entries[e].data.size();
+    }
+
+    const size_t dataOffset = sizeof(FileHeader)+entries.size()*sizeof(IndexRecord);
+    rData.resize(dataOffset+size_t(offset));
+    memcpy(rData.data(), &header, sizeof(FileHeader));
+    for (size_t e=0; e<entries.size(); ++e)
+    {
+        memcpy(rData.data()+sizeof(FileHeader)+e*sizeof(IndexRecord), &entries[e].record, sizeof(IndexRecord));
+        if (!entries[e].data.empty())
         {
-            saveSimulationPointInternal(dynamic_cast<ComponentSystem*>(pComp), namePrefix+pComp->getName()+'/', rFile);
+            memcpy(rData.data()+dataOffset+entries[e].record.offset, entries[e].data.data(), entries[e].data.size());
         }
     }
 }
 
-
+//! @brief Saves the node data and the internal state of all components in a system to a simulation point file
+//! @param[in] fileName The file to save to
+//! @param[in] pRootSystem The system to save
 void hopsan::saveSimulationPoint(HString fileName, ComponentSystem *pRootSystem)
 {
+    std::vector<char> data;
+    saveSimulationPointData(pRootSystem, data);
+
     std::ofstream file;
-    file.open(fileName.c_str());
-    if (file.is_open())
+    file.open(fileName.c_str(), std::ios::out | std::ios::binary);
+    if (!file.is_open())
     {
-        saveSimulationPointInternal(pRootSystem, "/", file);
+        pRootSystem->addErrorMessage("Could not open simulation point file for writing: "+fileName);
+        return;
     }
+    file.write(data.data(), data.size());
     file.close();
 }
 
+//! @brief Restores a simulation point from file
+//! @details The node data is restored directly. The internal component states are restored by the system at the end of
+//! the next initialization, since initializing components resets their internal state.
+//! @param[in] fileName The file to restore from
+//! @param[in] pRootSystem The system to restore to, the same system that the simulation point was saved from
+//! @param[out] rTimeOffset The simulation time when the simulation point was saved
 void hopsan::restoreSimulationPoint(HString fileName, ComponentSystem *pRootSystem, double &rTimeOffset)
 {
     std::ifstream file;
-    file.open(fileName.c_str());
-    if (file.is_open())
+    file.open(fileName.c_str(), std::ios::in | std::ios::binary);
+    if (!file.is_open())
     {
-        while (!file.eof())
-        {
-            // Read identifier from next package
-            size_t id = readIdentifier(file);
-            switch (id)
-            {
-            case TIMEIDENTIFIER:
-                rTimeOffset = readTimeData(file);
-                break;
-            case PORTIDENTIFIER:
-                readPortData(file, pRootSystem);
-                break;
-            default:
-                break;
-            }
-        }
+        pRootSystem->addErrorMessage("Could not open simulation point file: "+fileName);
+        return;
     }
+
+    char magic[4] = {0,0,0,0};
+    file.read(magic, 4);
+    if (memcmp(magic, gMagic, 4) != 0)
+    {
+        // Not a versioned simulation point, read as the legacy format
+        file.clear();
+        file.seekg(0);
+        readLegacySimulationPoint(file, pRootSystem, rTimeOffset);
+        file.close();
+        return;
+    }
+
+    file.seekg(0, std::ios::end);
+    std::vector<char> data(size_t(file.tellg()));
+    file.seekg(0);
+    file.read(data.data(), data.size());
     file.close();
+
+    SimulationPointReader reader(data);
+    if (!reader.isValid())
+    {
+        pRootSystem->addErrorMessage("Unsupported or corrupt simulation point file: "+fileName);
+        return;
+    }
+    rTimeOffset = reader.getTime();
+    restoreEntries(reader, pRootSystem, "/", false);
+    pRootSystem->setSimulationPointToRestore(data);
+}
+
+//! @brief Restores node data and internal component states from simulation point data
+//! @param[in] rData The contents of a simulation point file
+//! @param[in] pRootSystem The system to restore to, the same system that the simulation point was saved from
+//! @param[in] restoreComponentStates If the internal component states should be restored, or only the node data
+//! @returns true if the data could be restored, false if it is invalid or does not match the components
+bool hopsan::restoreSimulationPointData(const std::vector<char> &rData, ComponentSystem *pRootSystem, const bool restoreComponentStates)
+{
+    SimulationPointReader reader(rData);
+    if (!reader.isValid())
+    {
+        return false;
+    }
+    return restoreEntries(reader, pRootSystem, "/", restoreComponentStates);
 }
@@ -33,6 +33,8 @@
 
 #include "CoreUtilities/SimulationHandler.h"
 #include "CoreUtilities/MultiThreadingUtilities.h"
+#include "CoreUtilities/EnsembleSimulation.h"
+#include "CoreUtilities/RealtimeExecutor.h"
 #include "ComponentSystem.h"
 
 #if defined(HOPSANCORE_USEMULTITHREADING)
@@ -42,6 +44,30 @@
 using namespace hopsan;
 using namespace std;
 
+SimulationHandler::SimulationHandler()
+{
+#if defined(HOPSANCORE_USEMULTITHREADING)
+    mpThreadPool = new SimulationThreadPool();
+#else
+    mpThreadPool = 0;
+#endif
+}
+
+SimulationHandler::~SimulationHandler()
+{
+#if defined(HOPSANCORE_USEMULTITHREADING)
+    delete mpThreadPool;
+#endif
+}
+
+//! @brief Returns the thread pool that is used for multi-threaded simulations
+//! @details The worker threads are kept between simulations, so that repeated simulations do not have to create new threads
+//! @returns Pointer to the thread pool, or 0 if multi-threading is not supported
+SimulationThreadPool *SimulationHandler::getThreadPool()
+{
+    return mpThreadPool;
+}
+
 bool SimulationHandler::initializeSystem(const double startT, const double stopT, ComponentSystem* pSystem)
 {
     if (pSystem->checkModelBeforeSimulation())
@@ -66,7 +92,28 @@ bool SimulationHandler::initializeSystem(const double startT, const double stopT
     return isOk;
 }
 
-bool SimulationHandler::simulateSystem(const double startT, const double stopT, const int nDesiredThreads, ComponentSystem* pSystem, bool noChanges, ParallelAlgorithmT algorithm)
+//! @brief Initializes a system again after it has been simulated, only doing the work needed for what has changed since the last initialization
+//! @see ComponentSystem::reinitialize()
+bool SimulationHandler::reinitializeSystem(const double startT, const double stopT, ComponentSystem* pSystem)
+{
+    return pSystem->reinitialize(startT, stopT);
+}
+
+bool SimulationHandler::reinitializeSystem(const double startT, const double stopT, std::vector<ComponentSystem*> &rSystemVector)
+{
+    bool isOk = true;
+    for (size_t i=0; i<rSystemVector.size(); ++i)
+    {
+        isOk = isOk && reinitializeSystem(startT, stopT, rSystemVector[i]);
+        if (!isOk)
+        {
+            break;
+        }
+    }
+    return isOk;
+}
+
+bool SimulationHandler::simulateSystem(const double startT, const double stopT, const int nDesiredThreads, ComponentSystem* pSystem, bool noChanges, ParallelAlgorithmT algorithm, BarrierPolicyT barrierPolicy)
 {
     if (nDesiredThreads < 0)
     {
@@ -75,13 +122,13 @@ bool SimulationHandler::simulateSystem(const double startT, const double stopT,
     }
     else
     {
-        pSystem->simulateMultiThreaded(startT, stopT, nDesiredThreads, noChanges, algorithm);
+        pSystem->simulateMultiThreaded(startT, stopT, nDesiredThreads, noChanges, algorithm, barrierPolicy);
     }
 
     return !pSystem->wasSimulationAborted();
 }
 
-bool SimulationHandler::simulateSystem(const double startT, const double stopT, const int nDesiredThreads, std::vector<ComponentSystem*> &rSystemVector, bool noChanges, ParallelAlgorithmT algorithm)
+bool SimulationHandler::simulateSystem(const double startT, const double stopT, const int nDesiredThreads, std::vector<ComponentSystem*> &rSystemVector, bool noChanges, ParallelAlgorithmT algorithm, BarrierPolicyT barrierPolicy)
 {
     if (rSystemVector.size() > 1)
     {
@@ -96,20 +143,54 @@ bool SimulationHandler::simulateSystem(const double startT, const double stopT,
     }
     else if (rSystemVector.size() == 1)
     {
-        return simulateSystem(startT, stopT, nDesiredThreads, rSystemVector[0], noChanges, algorithm);
+        return simulateSystem(startT, stopT, nDesiredThreads, rSystemVector[0], noChanges, algorithm, barrierPolicy);
     }
 
     return false;
 }
 
+//! @brief Initializes, simulates and finalizes several variants of the same model in lockstep, see EnsembleSimulation
+//! @details The systems must be structurally identical (typically loaded from the same model file), only parameter values may differ.
+//! They must not be initialized in advance.
+//! @param[in] startT Start time for all systems
+//! @param[in] stopT Stop time for all systems
+//! @param[in] rSystemVector Vector of pointers to the systems to simulate
+//! @returns true if successful else false if initialization failed or simulation was aborted
+bool SimulationHandler::simulateSystemEnsemble(const double startT, const double stopT, std::vector<ComponentSystem*> &rSystemVector)
+{
+    EnsembleSimulation ensemble(rSystemVector);
+    bool isOk = ensemble.initialize(startT, stopT);
+    if (isOk)
+    {
+        isOk = ensemble.simulate(stopT);
+    }
+    ensemble.finalize();
+    return isOk;
+}
+
 bool SimulationHandler::startRealtimeSimulation(ComponentSystem *pSystem, double realtimeFactor)
 {
     return pSystem->startRealtimeSimulation(realtimeFactor);
 }
 
+bool SimulationHandler::startRealtimeSimulation(ComponentSystem *pSystem, const RealtimeOptions &rOptions)
+{
+    return pSystem->startRealtimeSimulation(rOptions);
+}
+
 void SimulationHandler::stopRealtimeSimulation(ComponentSystem *pSystem)
 {
-    pSystem->stopSimulation();
+    pSystem->stopRealtimeSimulation();
+}
+
+bool SimulationHandler::isRealtimeSimulationRunning(const ComponentSystem *pSystem) const
+{
+    return pSystem->isRealtimeSimulationRunning();
+}
+
+RealtimeStatistics SimulationHandler::getRealtimeStatistics(const ComponentSystem *pSystem) const
+{
+    return pSystem->getRealtimeStatistics();
 }
 
 void SimulationHandler::finalizeSystem(ComponentSystem* pSystem)
@@ -197,18 +278,14 @@ bool SimulationHandler::simulateMultipleSystemsMultiThreaded(const double startT
     }
 
 
-    std::thread *tt = new std::thread[nThreads];  //Create simulation threads
-    for (size_t t=0; t<nThreads; ++t)             //Execute simulation
-    {
-        tt[t] = std::thread(simWholeSystems,
-                            mSplitSystemVector[t],
-                            stopT);
-    }
-    for(size_t c=0; c<nThreads; ++c)              //Wait for all tasks to finish
+    std::vector< std::function<void()> > tasks;   //Create simulation tasks, one per thread
+    for (size_t t=0; t<mSplitSystemVector.size(); ++t)
     {
-        tt[c].join();
+        tasks.push_back(std::bind(simWholeSystems,
+                                  mSplitSystemVector[t],
+                                  stopT));
     }
-    delete[] tt;                                                 //Clean up
+    mpThreadPool->run(tasks);                     //Execute simulation and wait for all tasks to finish
 
     bool aborted=false;
     for(size_t i=0; i<tempSystemVector.size(); ++i)
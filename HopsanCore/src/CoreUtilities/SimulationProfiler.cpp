@@ -0,0 +1,682 @@
+/*-----------------------------------------------------------------------------
+
+ Copyright 2017 Hopsan Group
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+
+
+ The full license is available in the file LICENSE.
+ For details about the 'Hopsan Group' or information about Authors and
+ Contributors see the HOPSANGROUP and AUTHORS files that are located in
+ the Hopsan source code root directory.
+
+-----------------------------------------------------------------------------*/
+
+//$Id$
+
+#include "CoreUtilities/SimulationProfiler.h"
+#include "ComponentSystem.h"
+#include "ComponentUtilities/num2string.hpp"
+
+#include <algorithm>
+#include <fstream>
+#include <iomanip>
+#include <limits>
+
+using namespace std;
+using namespace hopsan;
+
+namespace {
+
+const char *phaseShortNames[SimulationProfiler::NumPhases] = {"S", "C", "Q", "Log"};
+const char *phaseEventNames[SimulationProfiler::NumPhases] = {"Signal phase", "C phase", "Q phase", "Logging"};
+const char *waitEventNames[SimulationProfiler::NumPhases] = {"Wait (S barrier)", "Wait (C barrier)", "Wait (Q barrier)", "Wait (log barrier)"};
+
+//! @brief Returns the names of the subsystems below the top-level system and the name of the component, separated by '/'
+HString getComponentPath(const Component *pComponent)
+{
+    HString path = pComponent->getName();
+    for (const ComponentSystem *pParent = pComponent->getSystemParent(); pParent && !pParent->isTopLevelSystem(); pParent = pParent->getSystemParent())
+    {
+        path = pParent->getName()+"/"+path;
+    }
+    return path;
+}
+
+//! @brief Writes a string as a quoted JSON string
+void writeJsonString(ofstream &rFile, const HString &rString)
+{
+    rFile << '"';
+    for (size_t i=0; i<rString.size(); ++i)
+    {
+        const char c = rString[i];
+        if (c == '"' || c == '\\')
+        {
+            rFile << '\\';
+        }
+        rFile << c;
+    }
+    rFile << '"';
+}
+
+//! @brief Writes one row of statistics to a summary CSV file, times in s and us
+void writeStatisticsRow(ofstream &rFile, const char *kind, const HString &rName, const char *phase, const HString &rThread, const DurationStatistics &rStatistics)
+{
+    rFile << kind << "," << rName.c_str() << "," << phase << "," << rThread.c_str() << "," << rStatistics.getCount() << ","
+          << rStatistics.getTotal() << "," << rStatistics.getMean()*1e6 << "," << rStatistics.getMin()*1e6 << ","
+          << rStatistics.getMax()*1e6 << "," << rStatistics.getPercentile(0.5)*1e6 << "," << rStatistics.getPercentile(0.99)*1e6 << "\n";
+}
+
+}
+
+
+DurationStatistics::DurationStatistics()
+{
+    mCount = 0;
+    mTotal = 0;
+    mMin = numeric_limits<int64_t>::max();
+    mMax = 0;
+    fill(mHistogram, mHistogram+NumHistogramBuckets, size_t(0));
+}
+
+//! @brief Add one measured duration
+//! @param[in] duration The duration in ns
+void DurationStatistics::add(const int64_t duration)
+{
+    ++mCount;
+    mTotal += duration;
+    mMin = min(mMin, duration);
+    mMax = max(mMax, duration);
+    size_t bucket = 0;
+    for (uint64_t d = uint64_t(max(duration, int64_t(0))); d > 0; d >>= 1)
+    {
+        ++bucket;
+    }
+    ++mHistogram[min(bucket, size_t(NumHistogramBuckets-1))];
+}
+
+//! @brief Add all durations of other statistics to these
+void DurationStatistics::merge(const DurationStatistics &rOther)
+{
+    mCount += rOther.mCount;
+    mTotal += rOther.mTotal;
+    mMin = min(mMin, rOther.mMin);
+    mMax = max(mMax, rOther.mMax);
+    for (size_t b=0; b<NumHistogramBuckets; ++b)
+    {
+        mHistogram[b] += rOther.mHistogram[b];
+    }
+}
+
+//! @brief Returns the number of measured durations
+size_t DurationStatistics::getCount() const
+{
+    return mCount;
+}
+
+//! @brief Returns the sum of all durations in s
+double DurationStatistics::getTotal() const
+{
+    return double(mTotal)*1e-9;
+}
+
+//! @brief Returns the mean duration in s
+double DurationStatistics::getMean() const
+{
+    return (mCount > 0) ? getTotal()/double(mCount) : 0;
+}
+
+//! @brief Returns the shortest duration in s
+double DurationStatistics::getMin() const
+{
+    return (mCount > 0) ? double(mMin)*1e-9 : 0;
+}
+
+//! @brief Returns the longest duration in s
+double DurationStatistics::getMax() const
+{
+    return double(mMax)*1e-9;
+}
+
+//! @brief Estimate a percentile from the histogram
+//! @param[in] fraction The fraction of durations that are shorter than the returned duration, for example 0.5 for the median
+//! @returns The upper limit of the histogram bucket containing the percentile in s, at most the longest duration
+double DurationStatistics::getPercentile(const double fraction) const
+{
+    const double limit = fraction*double(mCount);
+    size_t count = 0;
+    for (size_t b=0; b<NumHistogramBuckets; ++b)
+    {
+        count += mHistogram[b];
+        if (count > 0 && double(count) >= limit)
+        {
+            const double bucketMax = (b == 0) ? 0 : double(uint64_t(1) << min(b, size_t(62)))*1e-9;
+            return min(bucketMax, getMax());
+        }
+    }
+    return getMax();
+}
+
+//! @brief Returns the number of durations in a histogram bucket
+size_t DurationStatistics::getHistogramCount(const size_t bucket) const
+{
+    return (bucket < NumHistogramBuckets) ? mHistogram[bucket] : 0;
+}
+
+
+HardwareCounterStatistics::HardwareCounterStatistics()
+{
+    mCount = 0;
+    fill(mTotals, mTotals+HardwareCounters::NumCounters, uint64_t(0));
+}
+
+//! @brief Add one sample
+//! @param[in] pValues Array with the increase of each counter during the sample
+void HardwareCounterStatistics::add(const uint64_t *pValues)
+{
+    ++mCount;
+    for (size_t c=0; c<HardwareCounters::NumCounters; ++c)
+    {
+        mTotals[c] += pValues[c];
+    }
+}
+
+//! @brief Add all samples of other statistics to these
+void HardwareCounterStatistics::merge(const HardwareCounterStatistics &rOther)
+{
+    mCount += rOther.mCount;
+    for (size_t c=0; c<HardwareCounters::NumCounters; ++c)
+    {
+        mTotals[c] += rOther.mTotals[c];
+    }
+}
+
+//! @brief Returns the number of samples
+size_t HardwareCounterStatistics::getCount() const
+{
+    return mCount;
+}
+
+//! @brief Returns the sum of a counter over all samples
+uint64_t HardwareCounterStatistics::getTotal(const HardwareCounters::CounterT counter) const
+{
+    return mTotals[counter];
+}
+
+//! @brief Returns the mean value of a counter per sample
+double HardwareCounterStatistics::getMean(const HardwareCounters::CounterT counter) const
+{
+    return (mCount > 0) ? double(mTotals[counter])/double(mCount) : 0;
+}
+
+//! @brief Returns the number of instructions per cycle, or 0 if no cycles were counted
+double HardwareCounterStatistics::getInstructionsPerCycle() const
+{
+    return (mTotals[HardwareCounters::Cycles] > 0) ? double(mTotals[HardwareCounters::Instructions])/double(mTotals[HardwareCounters::Cycles]) : 0;
+}
+
+
+//! @brief Constructor
+//! @param[in] nTraceSteps The number of steps from the start of the first simulation that trace events are kept for
+SimulationProfiler::SimulationProfiler(const size_t nTraceSteps)
+{
+    mnTraceSteps = nTraceSteps;
+    mnSteps = 0;
+    mStartTicks = getTicks();
+    mUseHardwareCounters = false;
+    fill(mHardwareCountersAvailable, mHardwareCountersAvailable+HardwareCounters::NumCounters, false);
+}
+
+SimulationProfiler::~SimulationProfiler()
+{
+    clear();
+}
+
+//! @brief Remove all recorded results
+void SimulationProfiler::clear()
+{
+    for (size_t t=0; t<mThreadProfiles.size(); ++t)
+    {
+        delete mThreadProfiles[t];
+    }
+    mThreadProfiles.clear();
+    mComponentRecords.clear();
+    mTypeRecords.clear();
+    mPhaseStatistics.clear();
+    mWaitStatistics.clear();
+    mTraceEvents.clear();
+    mnSteps = 0;
+    mStartTicks = getTicks();
+    fill(mHardwareCountersAvailable, mHardwareCountersAvailable+HardwareCounters::NumCounters, false);
+    mHardwareCounterError.clear();
+}
+
+//! @brief Set if hardware counters should be read around each component in the following simulations
+//! @details The counters are opened by each simulation thread. If they are not available the simulation is profiled without them,
+//! use isHardwareCounterAvailable() and getHardwareCounterError() afterwards. Reading the counters is a system call, so the
+//! duration of each phase includes this overhead, but the durations of the components do not.
+void SimulationProfiler::setUseHardwareCounters(const bool useHardwareCounters)
+{
+    mUseHardwareCounters = useHardwareCounters;
+}
+
+//! @brief Returns true if hardware counters should be read in the following simulations
+bool SimulationProfiler::usesHardwareCounters() const
+{
+    return mUseHardwareCounters;
+}
+
+//! @brief Prepare the records of each thread before a simulation
+//! @param[in] nThreads The number of simulation threads
+void SimulationProfiler::beginSimulation(const size_t nThreads)
+{
+    for (size_t t=0; t<mThreadProfiles.size(); ++t)
+    {
+        delete mThreadProfiles[t];
+    }
+    mThreadProfiles.resize(nThreads);
+    for (size_t t=0; t<nThreads; ++t)
+    {
+        mThreadProfiles[t] = new ThreadProfile;
+    }
+    if (mPhaseStatistics.size() < nThreads*NumPhases)
+    {
+        mPhaseStatistics.resize(nThreads*NumPhases);
+        mWaitStatistics.resize(nThreads*NumPhases);
+    }
+}
+
+//! @brief Simulate components and record the time spent on each one and on the whole phase
+//! @param[in] thread The index of the calling thread
+//! @param[in] phase The phase that the components belong to
+//! @param[in] rComponents The components to simulate
+//! @param[in] time The time to simulate to
+//! @param[in] step The step index in the current simulation
+void SimulationProfiler::simulatePhase(const size_t thread, const PhaseT phase, const std::vector<Component*> &rComponents, const double time, const size_t step)
+{
+    ThreadProfile *pProfile = mThreadProfiles[thread];
+    const bool trace = isTraceStep(step);
+
+    // The counters count the thread that opened them, so they must be opened from the simulation thread
+    if (mUseHardwareCounters && !pProfile->mHaveOpenedCounters)
+    {
+        pProfile->mCounters.open();
+        pProfile->mHaveOpenedCounters = true;
+    }
+    uint64_t counters0[HardwareCounters::NumCounters], counters1[HardwareCounters::NumCounters];
+    const bool readCounters = pProfile->mCounters.isOpen() && pProfile->mCounters.read(counters0);
+
+    TicksT t0 = getTicks();
+    const TicksT phaseStart = t0;
+    for (size_t i=0; i<rComponents.size(); ++i)
+    {
+        rComponents[i]->simulate(time);
+        TicksT t1 = getTicks();
+        ComponentRecord &rRecord = pProfile->mComponents[rComponents[i]];
+        rRecord.mPhase = phase;
+        rRecord.mStatistics.add(t1-t0);
+        if (trace)
+        {
+            addTraceEvent(thread, ComponentEvent, phase, rComponents[i], t0, t1);
+        }
+        if (readCounters && pProfile->mCounters.read(counters1))
+        {
+            for (size_t c=0; c<HardwareCounters::NumCounters; ++c)
+            {
+                // Scaled values of multiplexed counters may decrease slightly between two reads
+                const uint64_t value = counters1[c];
+                counters1[c] = (value > counters0[c]) ? value-counters0[c] : 0;
+                counters0[c] = value;
+            }
+            rRecord.mCounters.add(counters1);
+            // Do not count the time it took to read the counters in the next component
+            t1 = getTicks();
+        }
+        t0 = t1;
+    }
+    addPhaseTime(thread, phase, phaseStart, t0, step);
+}
+
+//! @brief Record the time that a thread has spent in a phase
+void SimulationProfiler::addPhaseTime(const size_t thread, const PhaseT phase, const TicksT start, const TicksT end, const size_t step)
+{
+    mThreadProfiles[thread]->mPhases[phase].add(end-start);
+    if (isTraceStep(step))
+    {
+        addTraceEvent(thread, PhaseEvent, phase, 0, start, end);
+    }
+}
+
+//! @brief Record the time that a thread has been waiting at the barrier before a phase
+void SimulationProfiler::addWaitTime(const size_t thread, const PhaseT phase, const TicksT start, const TicksT end, const size_t step)
+{
+    mThreadProfiles[thread]->mWaits[phase].add(end-start);
+    if (isTraceStep(step))
+    {
+        addTraceEvent(thread, WaitEvent, phase, 0, start, end);
+    }
+}
+
+void SimulationProfiler::addTraceEvent(const size_t thread, const EventKindT kind, const PhaseT phase, const Component *pComponent, const TicksT start, const TicksT end)
+{
+    RawTraceEvent event;
+    event.mpComponent = pComponent;
+    event.mKind = kind;
+    event.mPhase = phase;
+    event.mStart = start;
+    event.mEnd = end;
+    mThreadProfiles[thread]->mTraceEvents.push_back(event);
+}
+
+//! @brief Merge the records of all threads after a simulation
+//! @details Must be called while the simulated components still exist, since their names are looked up here
+//! @param[in] nSteps The number of simulated steps
+void SimulationProfiler::endSimulation(const size_t nSteps)
+{
+    for (size_t t=0; t<mThreadProfiles.size(); ++t)
+    {
+        ThreadProfile *pProfile = mThreadProfiles[t];
+        std::unordered_map<const Component*, ComponentRecord>::const_iterator it;
+        for (it=pProfile->mComponents.begin(); it!=pProfile->mComponents.end(); ++it)
+        {
+            ComponentRecord &rRecord = mComponentRecords[getComponentPath(it->first)];
+            rRecord.mPhase = it->second.mPhase;
+            rRecord.mTypeName = it->first->getTypeName();
+            rRecord.mStatistics.merge(it->second.mStatistics);
+            rRecord.mCounters.merge(it->second.mCounters);
+            TypeRecord &rTypeRecord = mTypeRecords[rRecord.mTypeName];
+            rTypeRecord.mStatistics.merge(it->second.mStatistics);
+            rTypeRecord.mCounters.merge(it->second.mCounters);
+        }
+        if (pProfile->mHaveOpenedCounters)
+        {
+            for (size_t c=0; c<HardwareCounters::NumCounters; ++c)
+            {
+                mHardwareCountersAvailable[c] = mHardwareCountersAvailable[c] || pProfile->mCounters.isAvailable(HardwareCounters::CounterT(c));
+            }
+            if (mHardwareCounterError.empty())
+            {
+                mHardwareCounterError = pProfile->mCounters.getErrorMessage();
+            }
+        }
+        for (size_t p=0; p<NumPhases; ++p)
+        {
+            mPhaseStatistics[t*NumPhases+p].merge(pProfile->mPhases[p]);
+            mWaitStatistics[t*NumPhases+p].merge(pProfile->mWaits[p]);
+        }
+        for (size_t e=0; e<pProfile->mTraceEvents.size(); ++e)
+        {
+            const RawTraceEvent &rRawEvent = pProfile->mTraceEvents[e];
+            TraceEvent event;
+            if (rRawEvent.mKind == ComponentEvent)
+            {
+                event.mName = getComponentPath(rRawEvent.mpComponent);
+            }
+            else if (rRawEvent.mKind == PhaseEvent)
+            {
+                event.mName = phaseEventNames[rRawEvent.mPhase];
+            }
+            else
+            {
+                event.mName = waitEventNames[rRawEvent.mPhase];
+            }
+            event.mKind = rRawEvent.mKind;
+            event.mPhase = rRawEvent.mPhase;
+            event.mThread = t;
+            event.mStart = rRawEvent.mStart;
+            event.mEnd = rRawEvent.mEnd;
+            mTraceEvents.push_back(event);
+        }
+        delete pProfile;
+    }
+    mThreadProfiles.clear();
+    mnSteps += nSteps;
+}
+
+//! @brief Returns the total number of profiled steps
+size_t SimulationProfiler::getNumSteps() const
+{
+    return mnSteps;
+}
+
+//! @brief Returns the largest number of threads used in a profiled simulation
+size_t SimulationProfiler::getNumThreads() const
+{
+    return mPhaseStatistics.size()/NumPhases;
+}
+
+//! @brief Returns the names of all profiled components, the one with the largest total time first
+std::vector<HString> SimulationProfiler::getComponentNamesByTotalTime() const
+{
+    std::vector< std::pair<double, HString> > times;
+    std::map<HString, ComponentRecord>::const_iterator it;
+    for (it=mComponentRecords.begin(); it!=mComponentRecords.end(); ++it)
+    {
+        times.push_back(std::pair<double, HString>(-it->second.mStatistics.getTotal(), it->first));
+    }
+    sort(times.begin(), times.end());
+    std::vector<HString> names;
+    for (size_t i=0; i<times.size(); ++i)
+    {
+        names.push_back(times[i].second);
+    }
+    return names;
+}
+
+//! @brief Returns the statistics of a component
+//! @param[in] rName The names of the subsystems below the top-level system and the name of the component, separated by '/'
+//! @returns Pointer to the statistics, or 0 if the component has not been profiled
+const DurationStatistics *SimulationProfiler::getComponentStatistics(const HString &rName) const
+{
+    std::map<HString, ComponentRecord>::const_iterator it = mComponentRecords.find(rName);
+    return (it != mComponentRecords.end()) ? &it->second.mStatistics : 0;
+}
+
+//! @brief Returns the statistics of the time that a thread has spent in a phase, or 0 if the thread has not been used
+const DurationStatistics *SimulationProfiler::getPhaseStatistics(const size_t thread, const PhaseT phase) const
+{
+    return (thread*NumPhases+phase < mPhaseStatistics.size()) ? &mPhaseStatistics[thread*NumPhases+phase] : 0;
+}
+
+//! @brief Returns the statistics of the time that a thread has waited at the barrier before a phase, or 0 if the thread has not been used
+const DurationStatistics *SimulationProfiler::getWaitStatistics(const size_t thread, const PhaseT phase) const
+{
+    return (thread*NumPhases+phase < mWaitStatistics.size()) ? &mWaitStatistics[thread*NumPhases+phase] : 0;
+}
+
+//! @brief Returns the number of kept trace events
+size_t SimulationProfiler::getNumTraceEvents() const
+{
+    return mTraceEvents.size();
+}
+
+//! @brief Returns true if a hardware counter has been read in any of the profiled simulations
+bool SimulationProfiler::isHardwareCounterAvailable(const HardwareCounters::CounterT counter) const
+{
+    return mHardwareCountersAvailable[counter];
+}
+
+//! @brief Returns the reason that a hardware counter could not be opened, or an empty string if all counters were available
+const HString &SimulationProfiler::getHardwareCounterError() const
+{
+    return mHardwareCounterError;
+}
+
+//! @brief Returns the hardware counters of a component
+//! @param[in] rName The names of the subsystems below the top-level system and the name of the component, separated by '/'
+//! @returns Pointer to the counters, or 0 if the component has not been profiled
+const HardwareCounterStatistics *SimulationProfiler::getComponentCounters(const HString &rName) const
+{
+    std::map<HString, ComponentRecord>::const_iterator it = mComponentRecords.find(rName);
+    return (it != mComponentRecords.end()) ? &it->second.mCounters : 0;
+}
+
+//! @brief Returns the type names of all profiled components, the type with the largest total time first
+std::vector<HString> SimulationProfiler::getComponentTypeNamesByTotalTime() const
+{
+    std::vector< std::pair<double, HString> > times;
+    std::map<HString, TypeRecord>::const_iterator it;
+    for (it=mTypeRecords.begin(); it!=mTypeRecords.end(); ++it)
+    {
+        times.push_back(std::pair<double, HString>(-it->second.mStatistics.getTotal(), it->first));
+    }
+    sort(times.begin(), times.end());
+    std::vector<HString> typeNames;
+    for (size_t i=0; i<times.size(); ++i)
+    {
+        typeNames.push_back(times[i].second);
+    }
+    return typeNames;
+}
+
+//! @brief Returns the number of profiled components of a type
+size_t SimulationProfiler::getNumComponentsOfType(const HString &rTypeName) const
+{
+    size_t n = 0;
+    std::map<HString, ComponentRecord>::const_iterator it;
+    for (it=mComponentRecords.begin(); it!=mComponentRecords.end(); ++it)
+    {
+        if (it->second.mTypeName == rTypeName)
+        {
+            ++n;
+        }
+    }
+    return n;
+}
+
+//! @brief Returns the statistics of all components of a type, or 0 if no component of the type has been profiled
+const DurationStatistics *SimulationProfiler::getComponentTypeStatistics(const HString &rTypeName) const
+{
+    std::map<HString, TypeRecord>::const_iterator it = mTypeRecords.find(rTypeName);
+    return (it != mTypeRecords.end()) ? &it->second.mStatistics : 0;
+}
+
+//! @brief Returns the hardware counters of all components of a type, or 0 if no component of the type has been profiled
+const HardwareCounterStatistics *SimulationProfiler::getComponentTypeCounters(const HString &rTypeName) const
+{
+    std::map<HString, TypeRecord>::const_iterator it = mTypeRecords.find(rTypeName);
+    return (it != mTypeRecords.end()) ? &it->second.mCounters : 0;
+}
+
+//! @brief Write the trace events in the Chrome trace event format (JSON)
+//! @param[in] rFilePath The file to write
+//! @returns true if the file was written, else false
+bool SimulationProfiler::writeChromeTrace(const HString &rFilePath) const
+{
+    ofstream file(rFilePath.c_str());
+    if (!file.is_open())
+    {
+        return false;
+    }
+    file << "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[\n";
+    for (size_t t=0; t<getNumThreads(); ++t)
+    {
+        file << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << t << ",\"args\":{\"name\":\"Simulation thread " << t << "\"}},\n";
+    }
+    file << fixed << setprecision(3);
+    for (size_t e=0; e<mTraceEvents.size(); ++e)
+    {
+        const TraceEvent &rEvent = mTraceEvents[e];
+        const char *category = (rEvent.mKind == ComponentEvent) ? "component" : ((rEvent.mKind == PhaseEvent) ? "phase" : "wait");
+        file << "{\"name\":";
+        writeJsonString(file, rEvent.mName);
+        file << ",\"cat\":\"" << category << "\",\"ph\":\"X\",\"pid\":1,\"tid\":" << rEvent.mThread
+             << ",\"ts\":" << double(rEvent.mStart-mStartTicks)*1e-3 << ",\"dur\":" << double(rEvent.mEnd-rEvent.mStart)*1e-3
+             << ",\"args\":{\"phase\":\"" << phaseShortNames[rEvent.mPhase] << "\"}}" << ((e+1 < mTraceEvents.size()) ? ",\n" : "\n");
+    }
+    file << "]}\n";
+    return file.good();
+}
+
+//! @brief Write the statistics of all components, phases and barrier waits as CSV
+//! @details Components are written with the largest total time first, followed by the phase and wait time of each thread.
+//! Total times are in s, the other times in us. Median and 99th percentile are estimated from the log2 histograms.
+//! @param[in] rFilePath The file to write
+//! @returns true if the file was written, else false
+bool SimulationProfiler::writeSummaryCSV(const HString &rFilePath) const
+{
+    ofstream file(rFilePath.c_str());
+    if (!file.is_open())
+    {
+        return false;
+    }
+    file << "Kind,Name,Phase,Thread,Count,Total [s],Mean [us],Min [us],Max [us],Median [us],P99 [us]\n";
+    file << setprecision(6);
+    const std::vector<HString> names = getComponentNamesByTotalTime();
+    for (size_t i=0; i<names.size(); ++i)
+    {
+        const ComponentRecord &rRecord = mComponentRecords.find(names[i])->second;
+        writeStatisticsRow(file, "component", names[i], phaseShortNames[rRecord.mPhase], "", rRecord.mStatistics);
+    }
+    for (size_t t=0; t<getNumThreads(); ++t)
+    {
+        for (size_t p=0; p<NumPhases; ++p)
+        {
+            if (mPhaseStatistics[t*NumPhases+p].getCount() > 0)
+            {
+                writeStatisticsRow(file, "phase", "", phaseShortNames[p], to_hstring(t), mPhaseStatistics[t*NumPhases+p]);
+            }
+        }
+        for (size_t p=0; p<NumPhases; ++p)
+        {
+            if (mWaitStatistics[t*NumPhases+p].getCount() > 0)
+            {
+                writeStatisticsRow(file, "wait", "", phaseShortNames[p], to_hstring(t), mWaitStatistics[t*NumPhases+p]);
+            }
+        }
+    }
+    return file.good();
+}
+
+//! @brief Write the time and hardware counters of each component type as CSV
+//! @details Types are written with the largest total time first. Counters are given per time step of one component and are left
+//! empty if they were not available.
+//! @param[in] rFilePath The file to write
+//! @returns true if the file was written, else false
+bool SimulationProfiler::writeHardwareCounterCSV(const HString &rFilePath) const
+{
+    ofstream file(rFilePath.c_str());
+    if (!file.is_open())
+    {
+        return false;
+    }
+    file << "Type,Components,Count,Total [s],Mean [us]";
+    for (size_t c=0; c<HardwareCounters::NumCounters; ++c)
+    {
+        file << "," << HardwareCounters::getCounterName(HardwareCounters::CounterT(c)) << " per step";
+    }
+    file << ",Instructions per cycle\n";
+    file << setprecision(6);
+    const std::vector<HString> typeNames = getComponentTypeNamesByTotalTime();
+    for (size_t i=0; i<typeNames.size(); ++i)
+    {
+        const TypeRecord &rRecord = mTypeRecords.find(typeNames[i])->second;
+        file << typeNames[i].c_str() << "," << getNumComponentsOfType(typeNames[i]) << "," << rRecord.mStatistics.getCount() << ","
+             << rRecord.mStatistics.getTotal() << "," << rRecord.mStatistics.getMean()*1e6;
+        for (size_t c=0; c<HardwareCounters::NumCounters; ++c)
+        {
+            file << ",";
+            if (mHardwareCountersAvailable[c])
+            {
+                file << rRecord.mCounters.getMean(HardwareCounters::CounterT(c));
+            }
+        }
+        file << ",";
+        if (mHardwareCountersAvailable[HardwareCounters::Cycles] && mHardwareCountersAvailable[HardwareCounters::Instructions])
+        {
+            file << rRecord.mCounters.getInstructionsPerCycle();
+        }
+        file << "\n";
+    }
+    return file.good();
+}
@@ -129,7 +129,8 @@ void HString::setString(const char *str, const size_t len)
     if (len>0)
     {
         mpDataBuffer = static_cast<char*>(realloc(mpDataBuffer,len+1));
-        strcpy(mpDataBuffer, str);
+        memcpy(mpDataBuffer, str, len);
+        mpDataBuffer[len] = '\0';
         mSize = len;
     }
     else
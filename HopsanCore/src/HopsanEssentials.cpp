@@ -35,6 +35,7 @@
 #include "CoreUtilities/ClassFactoryStatusCheck.hpp"
 #include "Components/DummyComponent.hpp"
 #include "CoreUtilities/HmfLoader.h"
+#include "CoreUtilities/BinaryModelFile.h"
 #include "CoreUtilities/LoadExternal.h"
 #include "CoreUtilities/HopsanCoreMessageHandler.h"
 #include "Quantities.h"
@@ -327,12 +328,17 @@ HopsanCoreMessageHandler *HopsanEssentials::getCoreMessageHandler()
 }
 
 //! @brief This function is used to load a HMF file.
+//! @details Binary model files (.hmfb) compiled from a HMF file are also accepted, if they are out of date the HMF file is loaded instead
 //! @param [in] filePath The name (path) of the HMF file
 //! @param [out] rStartTime A reference to the starttime variable
 //! @param [out] rStopTime A reference to the stoptime variable
 //! @returns A pointer to the root system of the loaded model
 ComponentSystem* HopsanEssentials::loadHMFModelFile(const char *filePath, double &rStartTime, double &rStopTime)
 {
+    if (isBinaryModelFilePath(filePath))
+    {
+        return loadBinaryModelFile(filePath, this, rStartTime, rStopTime);
+    }
     return loadHopsanModelFile(filePath, this, rStartTime, rStopTime);
 }
 
@@ -351,6 +357,18 @@ ComponentSystem* HopsanEssentials::loadHMFModel(const char *xmlString, double &r
     return loadHopsanModel(xmlString, this, rStartTime, rStopTime);
 }
 
+//! @brief Creates a deep copy of an already loaded system, this is much faster than loading the same model file again
+//! @param [in] pSystem The system to copy
+//! @returns A pointer to the new root system, or 0 if the copy failed
+ComponentSystem* HopsanEssentials::cloneComponentSystem(ComponentSystem *pSystem)
+{
+    if (!pSystem)
+    {
+        return 0;
+    }
+    return pSystem->clone();
+}
+
 SimulationHandler *HopsanEssentials::getSimulationHandler()
 {
     return &mSimulationHandler;
@@ -410,6 +428,15 @@ bool HopsanEssentials::loadExternalComponentLib(const char *path)
     return mpExternalLoader->load(path);
 }
 
+//! @brief Loads a compiled model library generated for a specific model
+//! @details Set the returned model in the top-level system of the same model with ComponentSystem::setCompiledModel()
+//! @param [in] path The path to the library DLL or SO file
+//! @returns A new compiled model, or 0 if the library could not be loaded
+CompiledModel* HopsanEssentials::loadCompiledModel(const char *path)
+{
+    return mpExternalLoader->loadCompiledModel(path);
+}
+
 //! @brief Unloads an external component library
 //! @param [in] path The path to the library DLL or SO file to unload
 //! @returns True if unloaded successfully, otherwise false
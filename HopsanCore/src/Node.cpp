@@ -36,6 +36,7 @@
 //! @ingroup Nodes
 
 #include <fstream>
+#include <algorithm>
 #include <cassert>
 #include <iostream>
 #include <sstream>
@@ -46,11 +47,11 @@
 #include "Quantities.h"
 
 namespace {
-bool anyPortWantsLogging(std::vector<hopsan::Port*>& ports)
+bool anyPortWantsLogging(const std::vector<hopsan::Port*>& ports, const size_t dataId)
 {
     for (size_t p=0; p<ports.size(); ++p)
     {
-        if (ports[p]->isLoggingEnabled())
+        if (ports[p]->isVariableLoggingEnabled(dataId))
         {
             return true;
         }
@@ -68,7 +69,7 @@ Node::Node(const size_t datalength)
 {
     // Make sure clear (should not really be needed)
     mDataValues.clear();
-    mDataStorage.clear();
+    mLogDataColumns.clear();
     mConnectedPorts.clear();
 
     // Init pointer
@@ -80,6 +81,7 @@ Node::Node(const size_t datalength)
     // Resize
     mDataDescriptions.resize(datalength);
     mDataValues.resize(datalength,0.0);
+    mpDataValues = mDataValues.data();
 
     // Default disabled logging
     setDoLogIfEnabled(false);
@@ -114,7 +116,7 @@ size_t Node::getNumDataVariables() const
 
 double *Node::getDataPtr(const size_t data_type)
 {
-    return &mDataValues[data_type];
+    return &mpDataValues[data_type];
 }
 
 
@@ -234,7 +236,7 @@ void Node::copyNodeDataValuesTo(Node *pOtherNode) const
         for(size_t i=0; i<pOtherNode->getNumDataVariables(); ++i)
         {
             //! @todo look over if all vector positions should be set or not.
-            pOtherNode->mDataValues[i] = mDataValues[i];
+            pOtherNode->mpDataValues[i] = mpDataValues[i];
         }
         setTLMNodeDataValuesTo(pOtherNode); //Handles Wave, imp variables and similar
     }
@@ -259,23 +261,119 @@ void Node::setTLMNodeDataValuesTo(Node* /*pOtherNode*/) const
 
 
 //! @brief Pre allocate memory for the needed amount of log data
+//! @details One contiguous column is allocated for each variable that should be logged
 void Node::preAllocateLogSpace(const size_t nLogSlots)
 {
     // Don't try to allocate if we are not going to log
     if (mDoLog)
     {
-        mDataStorage.resize(nLogSlots, vector<double>(mDataValues.size()));
+        mLogDataColumns.resize(mDataValues.size());
+        size_t nextLogged=0;
+        for (size_t i=0; i<mLogDataColumns.size(); ++i)
+        {
+            if ((nextLogged < mLoggedDataIds.size()) && (mLoggedDataIds[nextLogged] == i))
+            {
+                mLogDataColumns[i].resize(nLogSlots);
+                ++nextLogged;
+            }
+            else
+            {
+                vector<double>().swap(mLogDataColumns[i]);
+            }
+        }
     }
 }
 
 
-//! @brief Copy current data vector into log storage at given logslot
+//! @brief Copy the current value of each logged variable into log storage at given logslot
 //! @warning No bounds check is done
 void Node::logData(const size_t logSlot)
 {
     if (mDoLog)
     {
-        mDataStorage[logSlot] = mDataValues;
+        for (size_t i=0; i<mLoggedDataIds.size(); ++i)
+        {
+            const size_t id = mLoggedDataIds[i];
+            mLogDataColumns[id][logSlot] = mpDataValues[id];
+        }
+    }
+}
+
+
+//! @brief Get a view of the logged samples of one data variable
+//! @param [in] dataId The data variable id
+//! @returns A view of the log data column, it is empty if the variable is not logged
+LogDataColumnView Node::getLogDataColumn(const size_t dataId) const
+{
+    if (dataId < mLogDataColumns.size())
+    {
+        const vector<double> &rColumn = mLogDataColumns[dataId];
+        return LogDataColumnView(rColumn.data(), rColumn.size());
+    }
+    return LogDataColumnView();
+}
+
+
+//! @brief Check if any log data has been allocated in the node
+bool Node::haveLogData() const
+{
+    for (size_t i=0; i<mLogDataColumns.size(); ++i)
+    {
+        if (!mLogDataColumns[i].empty())
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+
+//! @brief Move the data values into external storage (such as a node data arena), the current values are copied
+//! @param [in] pStorage Pointer to external storage, it must have room for getNumDataVariables() values and outlive its use by this node
+//! @details The internal data vector will not be kept up to date until restoreDataValuesStorage() is called
+void Node::moveDataValuesTo(double *pStorage)
+{
+    std::copy(mpDataValues, mpDataValues+mDataValues.size(), pStorage);
+    mpDataValues = pStorage;
+}
+
+
+//! @brief Copy the data values back from external storage and use the internal data vector again
+void Node::restoreDataValuesStorage()
+{
+    if (hasExternalDataValuesStorage())
+    {
+        std::copy(mpDataValues, mpDataValues+mDataValues.size(), mDataValues.begin());
+        mpDataValues = mDataValues.data();
+    }
+}
+
+
+//! @brief Check if the data values currently live in external storage
+bool Node::hasExternalDataValuesStorage() const
+{
+    return (mpDataValues != mDataValues.data());
+}
+
+
+//! @brief Reallocate the data values, so that the memory is first touched (and placed on the NUMA node of) the calling thread
+//! @details Data values in external storage are not moved. Pointers to the data values are invalidated.
+void Node::reallocateDataValues()
+{
+    if (!hasExternalDataValuesStorage())
+    {
+        std::vector<double>(mDataValues).swap(mDataValues);
+        mpDataValues = mDataValues.data();
+    }
+}
+
+
+//! @brief Reallocate the log data storage, so that the memory is first touched (and placed on the NUMA node of) the calling thread
+void Node::reallocateLogData()
+{
+    for (size_t i=0; i<mLogDataColumns.size(); ++i)
+    {
+        std::vector<double>(mLogDataColumns[i]).swap(mLogDataColumns[i]);
     }
 }
 
@@ -366,18 +464,40 @@ Port *Node::getSortOrderSourcePort() const
 }
 
 
+//! @brief Get the data ids of the variables that any of the connected ports wants to log
+//! @param[out] rDataIds The data ids, in ascending order
+void Node::getDataIdsToLog(std::vector<size_t> &rDataIds) const
+{
+    rDataIds.clear();
+    for (size_t i=0; i<mDataValues.size(); ++i)
+    {
+        if (anyPortWantsLogging(mConnectedPorts, i))
+        {
+            rDataIds.push_back(i);
+        }
+    }
+}
+
+
 //! @brief Tag this node for logging
+//! @details A variable is logged if any of the connected ports has logging enabled for it
 //! @param[in] doLog Flag that tags the node for logging or not
 void Node::setDoLogIfEnabled(bool doLog)
 {
-    if(doLog && anyPortWantsLogging(mConnectedPorts))
+    mLoggedDataIds.clear();
+    if (doLog)
+    {
+        getDataIdsToLog(mLoggedDataIds);
+    }
+
+    if (!mLoggedDataIds.empty())
     {
         mDoLog = true;
     }
     else
     {
         mDoLog = false;
-        mDataStorage.clear();
+        mLogDataColumns.clear();
     }
 }
 
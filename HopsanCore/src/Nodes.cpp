@@ -92,8 +92,10 @@ void hopsan::register_default_nodes(NodeFactory* pNodeFactory)
 void NodeSignalND::setSignalNumDimensions(size_t numDims)
 {
     // Resize
+    restoreDataValuesStorage();
     mDataDescriptions.resize(numDims);
     mDataValues.resize(numDims,0.0);
+    mpDataValues = mDataValues.data();
 
     // Set name
     HString nicename = "signal"+to_hstring(numDims)+"d";
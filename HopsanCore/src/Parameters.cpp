@@ -39,6 +39,7 @@
 #include "ComponentUtilities/num2string.hpp"
 //#include "Quantities.h"
 #include <cassert>
+#include <cctype>
 #include <sstream>
 #include <algorithm>
 #include <iostream>
@@ -73,6 +74,9 @@ ParameterEvaluator::ParameterEvaluator(const HString &rName, const HString &rVal
     mQuantity = rQuantity;
     mUnit = rUnit;
     mTriggersReconfiguration = false;
+    mHasNumericValue = false;
+    mNumericValueTextOutdated = false;
+    mNumericValue = 0;
 
     mpData = pDataPtr;
     mpParameterEvaluatorHandler = pParameterEvalHandler;
@@ -90,6 +94,7 @@ void* ParameterEvaluator::getDataPtr()
 bool ParameterEvaluator::setParameter(const HString &rValue, const HString &rDescription, const HString &rQuantity, const HString &rUnit, const HString &rType, ParameterEvaluator **pNeedEvaluation, bool force)
 {
     bool success;
+    updateNumericValueText();
     HString oldValue = mParameterValue;
     HString oldDescription = mDescription;
     HString oldUnit = mUnit;
@@ -138,8 +143,10 @@ bool ParameterEvaluator::setParameterValue(const HString &rValue, ParameterEvalu
 {
     bool success=false;
 
+    updateNumericValueText();
     HString oldValue = mParameterValue;
     mParameterValue = rValue;
+    mHasNumericValue = false;
     HString evalResult = rValue;
     success = evaluate(evalResult);
     if(!success && !force)
@@ -160,6 +167,66 @@ bool ParameterEvaluator::setParameterValue(const HString &rValue, ParameterEvalu
 }
 
 
+//! @brief Set a numeric value for a double or integer parameter, without parsing or expression evaluation
+//! @param [in] value The new value, it is rounded for integer parameters
+//! @return true if success, false if the parameter is not of type double or integer
+//!
+//! The value is written directly to the data variable, and it is remembered so that later evaluations do not need to parse the value text.
+//! The value text is only regenerated when it is needed, e.g. by getValue() or when other parameters that depend on this one are evaluated.
+bool ParameterEvaluator::setParameterValue(const double value)
+{
+    if (mType=="double")
+    {
+        mNumericValue = value;
+    }
+    else if (mType=="integer")
+    {
+        mNumericValue = double(int(value >= 0 ? value+0.5 : value-0.5));
+    }
+    else
+    {
+        return false;
+    }
+    mHasNumericValue = true;
+    mNumericValueTextOutdated = true;
+    writeNumericValue();
+    return true;
+}
+
+//! @brief Write the numeric value set by setParameterValue(const double) to the data variable (if any)
+void ParameterEvaluator::writeNumericValue()
+{
+    if (mpData)
+    {
+        if (mType=="double")
+        {
+            *static_cast<double*>(mpData) = mNumericValue;
+        }
+        else
+        {
+            *static_cast<int*>(mpData) = int(mNumericValue);
+        }
+    }
+}
+
+//! @brief Regenerate the value text after a numeric value has been set by setParameterValue(const double)
+void ParameterEvaluator::updateNumericValueText() const
+{
+    if (mNumericValueTextOutdated)
+    {
+        if (mType=="integer")
+        {
+            mParameterValue = to_hstring(int(mNumericValue));
+        }
+        else
+        {
+            mParameterValue = to_hstring(mNumericValue);
+        }
+        mNumericValueTextOutdated = false;
+    }
+}
+
+
 //! @brief Returns the type of the parameter
 //! @return The type of the parameter
 const HString &ParameterEvaluator::getType() const
@@ -176,10 +243,49 @@ const HString &ParameterEvaluator::getType() const
 //! @see evaluate(HString &result)
 bool ParameterEvaluator::evaluate()
 {
+    // Fast path for numeric values set directly, the value text is not needed here
+    if (mHasNumericValue)
+    {
+        writeNumericValue();
+        return true;
+    }
     HString dummy;
     return evaluate(dummy);
 }
 
+//! @brief Check if the parameter value text refers to any of the given names, e.g. system parameters
+//! @details A name is only considered referenced if it appears as a whole word, so "V" will not match "Vmax" or "self.V"
+//! @param [in] rNames The names to look for
+//! @return true if any of the names is referenced, otherwise false
+bool ParameterEvaluator::referencesAnyOf(const std::vector<HString> &rNames) const
+{
+    // A numeric value set directly can not refer to anything
+    if (mHasNumericValue || rNames.empty())
+    {
+        return false;
+    }
+
+    for (size_t n=0; n<rNames.size(); ++n)
+    {
+        const HString &rName = rNames[n];
+        size_t pos = mParameterValue.find(rName);
+        while ((pos != HString::npos) && !rName.empty())
+        {
+            const size_t end = pos+rName.size();
+            const char before = (pos > 0) ? mParameterValue[pos-1] : ' ';
+            const char after = (end < mParameterValue.size()) ? mParameterValue[end] : ' ';
+            const bool wordBefore = isalnum(static_cast<unsigned char>(before)) || (before == '_') || (before == '.') || (before == '#');
+            const bool wordAfter = isalnum(static_cast<unsigned char>(after)) || (after == '_') || (after == '#');
+            if (!wordBefore && !wordAfter)
+            {
+                return true;
+            }
+            pos = mParameterValue.find(rName, pos+1);
+        }
+    }
+    return false;
+}
+
 bool ParameterEvaluator::refreshParameterValueText()
 {
     if (mpData)
@@ -217,6 +323,8 @@ bool ParameterEvaluator::refreshParameterValueText()
             return false;
         }
         mParameterValue = ss.str().c_str();
+        mHasNumericValue = false;
+        mNumericValueTextOutdated = false;
         return true;
     }
     return false;
@@ -231,6 +339,14 @@ bool ParameterEvaluator::refreshParameterValueText()
 //! @see evaluate()
 bool ParameterEvaluator::evaluate(HString &rResult)
 {
+    // Fast path for numeric values set directly, see setParameterValue(const double)
+    if (mHasNumericValue)
+    {
+        writeNumericValue();
+        updateNumericValueText();
+        rResult = mParameterValue;
+        return true;
+    }
 
 // These values are arejust a guess, there is no easy way of kowing how long it will take until the stack overflow
 // MSVC is lower them MinGW, GCC, Clang
@@ -438,6 +554,7 @@ const HString &ParameterEvaluator::getName() const
 
 const HString &ParameterEvaluator::getValue() const
 {
+    updateNumericValueText();
     return mParameterValue;
 }
 
@@ -524,6 +641,7 @@ void ParameterEvaluator::splitSignPrefix(const HString &rString, HString &rPrefi
 ParameterEvaluatorHandler::ParameterEvaluatorHandler(Component* pComponent)
 {
     mComponent = pComponent;
+    mParametersAddedOrRemoved = false;
 }
 
 //! @brief Destructor
@@ -565,6 +683,7 @@ bool ParameterEvaluatorHandler::addParameter(const HString &rName, const HString
             if(success || force)
             {
                 mParameters.push_back(newParameter);
+                mParametersAddedOrRemoved = true;
                 success = true;
             }
             else
@@ -577,6 +696,18 @@ bool ParameterEvaluatorHandler::addParameter(const HString &rName, const HString
 }
 
 
+//! @brief Invalidate parameter handles that may refer to a deleted parameter in a component
+//! @details Handles are created by the component itself if it is a system, or by its parent system
+//! @param[in] pComponent The component that the parameter belonged to
+static void invalidateParameterHandles(Component *pComponent)
+{
+    ComponentSystem *pSystem = pComponent->isComponentSystem() ? static_cast<ComponentSystem*>(pComponent) : pComponent->getSystemParent();
+    if (pSystem)
+    {
+        pSystem->invalidateParameterHandles();
+    }
+}
+
 //! @brief Deletes a parameter
 //! @param[in] rName The name of the parameter to delete
 void ParameterEvaluatorHandler::deleteParameter(const HString &rName)
@@ -599,8 +730,17 @@ void ParameterEvaluatorHandler::deleteParameter(const HString &rName)
                 }
             }
 
+            // Also forget that it has changed
+            needevalIt = find(mChangedParameters.begin(), mChangedParameters.end(), *parIt);
+            if (needevalIt != mChangedParameters.end())
+            {
+                mChangedParameters.erase(needevalIt);
+            }
+
             delete *parIt;
             mParameters.erase(parIt);
+            mParametersAddedOrRemoved = true;
+            invalidateParameterHandles(mComponent);
 
             // We can return now, since there should never be multiple parameters with same name
             return;
@@ -620,6 +760,7 @@ bool ParameterEvaluatorHandler::renameParameter(const HString &rOldName, const H
             if( rOldName == (*parIt)->getName() )
             {
                 (*parIt)->mParameterName = rNewName;
+                mParametersAddedOrRemoved = true;
                 return true;
             }
         }
@@ -700,6 +841,10 @@ bool ParameterEvaluatorHandler::setParameter(const HString &rName, const HString
         {
             ParameterEvaluator *needEvaluation=0;
             success = mParameters[i]->setParameter(rValue, rDescription, rQuantity, rUnit, rType, &needEvaluation, force); //Sets the new value, if the parameter is of the type to need evaluation e.g. if it is a system parameter needEvaluation points to the parameter
+            if(success)
+            {
+                markParameterChanged(mParameters[i]);
+            }
             if(needEvaluation)
             {
                 if(mParametersNeedEvaluation.end() == find(mParametersNeedEvaluation.begin(), mParametersNeedEvaluation.end(), needEvaluation))
@@ -739,6 +884,55 @@ bool ParameterEvaluatorHandler::setParameterValue(const HString &rName, const HS
 }
 
 
+//! @brief Set a numeric value for an existing double or integer parameter, without name lookup, parsing or expression evaluation
+//! @param [in] pParameter The parameter, it must belong to this parameter handler
+//! @param [in] value The new value for the parameter
+//! @return true if success, otherwise false
+bool ParameterEvaluatorHandler::setParameterValue(ParameterEvaluator *pParameter, const double value)
+{
+    if (!pParameter->setParameterValue(value))
+    {
+        return false;
+    }
+    // A numeric value never needs to be evaluated again (it may previously have been an expression)
+    std::vector<ParameterEvaluator*>::iterator parIt = find(mParametersNeedEvaluation.begin(), mParametersNeedEvaluation.end(), pParameter);
+    if (parIt != mParametersNeedEvaluation.end())
+    {
+        mParametersNeedEvaluation.erase(parIt);
+    }
+    markParameterChanged(pParameter);
+    return true;
+}
+
+
+//! @brief Returns the parameters that have been set since the last call to clearChangedParameters()
+const std::vector<ParameterEvaluator*> &ParameterEvaluatorHandler::getChangedParameters() const
+{
+    return mChangedParameters;
+}
+
+//! @brief Check if parameters have been added, removed or renamed since the last call to clearChangedParameters()
+bool ParameterEvaluatorHandler::haveParametersBeenAddedOrRemoved() const
+{
+    return mParametersAddedOrRemoved;
+}
+
+//! @brief Forget all parameter changes, called when the parameters have been evaluated for simulation
+void ParameterEvaluatorHandler::clearChangedParameters()
+{
+    mChangedParameters.clear();
+    mParametersAddedOrRemoved = false;
+}
+
+void ParameterEvaluatorHandler::markParameterChanged(ParameterEvaluator *pParameter)
+{
+    if (mChangedParameters.end() == find(mChangedParameters.begin(), mChangedParameters.end(), pParameter))
+    {
+        mChangedParameters.push_back(pParameter);
+    }
+}
+
+
 //! @brief Evaluate a specific parameter
 //! @param [in] rName The name of the parameter to be evaluated
 //! @param [out] rEvaluatedParameterValue The result of the evaluation
@@ -880,3 +1074,36 @@ Component *ParameterEvaluatorHandler::getComponent() const
     return mComponent;
 }
 
+
+
+//! @class hopsan::ParameterHandle
+//! @brief A pre-resolved reference to a parameter, for fast repeated numeric parameter updates
+
+//! @brief Constructor, creates an invalid handle
+ParameterHandle::ParameterHandle()
+{
+    mpSystem = 0;
+    mpComponent = 0;
+    mpParameter = 0;
+    mParameterSetGeneration = 0;
+}
+
+//! @brief Check if the handle refers to a parameter
+//! @details The handle is no longer valid if any parameter or port has been removed in the system that created it
+bool ParameterHandle::isValid() const
+{
+    return (mpSystem != 0) && (mpComponent != 0) && (mpParameter != 0) &&
+           (mParameterSetGeneration == mpSystem->getParameterSetGeneration());
+}
+
+//! @brief Returns the component (or system) that owns the parameter
+Component *ParameterHandle::getComponent() const
+{
+    return mpComponent;
+}
+
+//! @brief Returns the parameter that the handle refers to
+ParameterEvaluator *ParameterHandle::getParameter() const
+{
+    return mpParameter;
+}
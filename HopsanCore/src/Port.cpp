@@ -199,7 +199,7 @@ double Port::readNodeSafe(const size_t idx, const size_t subPortIdx) const
 
     if (idx < mpNode->getNumDataVariables())
     {
-        return mpNode->mDataValues[idx];
+        return mpNode->mpDataValues[idx];
     }
     getComponent()->addErrorMessage("data idx out of range in Port::readNodeSafe()");
     return -1;
@@ -217,7 +217,7 @@ void Port::writeNodeSafe(const size_t idx, const double value, const size_t subP
     HOPSAN_UNUSED(subPortIdx)
     if (idx < mpNode->getNumDataVariables())
     {
-        mpNode->mDataValues[idx] = value;
+        mpNode->mpDataValues[idx] = value;
     }
     else
     {
@@ -424,7 +424,7 @@ bool Port::haveLogData(const size_t subPortIdx)
     if (mpNode)
     {
         // Here we assume that timevector DOES exist. If simulation code is correct it should exist
-        return !mpNode->mDataStorage.empty();
+        return mpNode->haveLogData();
     }
     return false;
 }
@@ -439,6 +439,35 @@ bool Port::isLoggingEnabled() const
     return mEnableLogging;
 }
 
+//! @brief Enable or disable logging of a single node data variable in this port
+//! @details This has no effect if logging is disabled for the entire port
+//! @param[in] dataId The data id of the variable
+//! @param[in] enableLog Whether the variable should be logged or not
+void Port::setEnableVariableLogging(const size_t dataId, const bool enableLog)
+{
+    if (dataId >= mDisabledLogVariables.size())
+    {
+        if (enableLog)
+        {
+            return;
+        }
+        mDisabledLogVariables.resize(dataId+1, false);
+    }
+    mDisabledLogVariables[dataId] = !enableLog;
+}
+
+//! @brief Check if a node data variable will be logged by this port
+//! @param[in] dataId The data id of the variable
+//! @returns True if logging is enabled for both the port and the variable
+bool Port::isVariableLoggingEnabled(const size_t dataId) const
+{
+    if (dataId < mDisabledLogVariables.size())
+    {
+        return mEnableLogging && !mDisabledLogVariables[dataId];
+    }
+    return mEnableLogging;
+}
+
 //! @brief Get all node data descriptions
 //! @param [in] subPortIdx Ignored on non multi ports
 //! @returns A const pointer to the internal node vector with node data descriptions
@@ -569,27 +598,19 @@ vector<double> *Port::getLogTimeVectorPtr(const size_t subPortIdx)
     return 0; //Nothing found return 0
 }
 
+//! @brief Get a view of the logged samples of one node data variable
+//! @details Samples are stored contiguously per variable, so the entire column can be copied at once with LogDataColumnView::copyTo()
+//! @param [in] dataId The data id of the variable
 //! @param [in] subPortIdx Ignored on non multi ports
-vector<vector<double> > *Port::getLogDataVectorPtr(size_t subPortIdx)
+//! @returns A view of the log data column, it is empty if the variable is not logged
+LogDataColumnView Port::getLogDataColumn(const size_t dataId, const size_t subPortIdx) const
 {
-    // TODO use const cast maybe
     HOPSAN_UNUSED(subPortIdx)
     if (mpNode != 0) {
-        return &(mpNode->mDataStorage);
+        return mpNode->getLogDataColumn(dataId);
     }
     else {
-        return 0;
-    }
-}
-
-const std::vector<std::vector<double> > *Port::getLogDataVectorPtr(size_t subPortIdx) const
-{
-    HOPSAN_UNUSED(subPortIdx)
-    if (mpNode != 0) {
-        return &(mpNode->mDataStorage);
-    }
-    else {
-        return 0;
+        return LogDataColumnView();
     }
 }
 
@@ -1139,25 +1160,23 @@ std::vector<double> *MultiPort::getLogTimeVectorPtr(const size_t subPortIdx)
     return 0;
 }
 
-std::vector<std::vector<double> > *MultiPort::getLogDataVectorPtr(const size_t subPortIdx)
+LogDataColumnView MultiPort::getLogDataColumn(const size_t dataId, const size_t subPortIdx) const
 {
-    if (isConnected())
-    {
-        return mSubPortsVector[subPortIdx]->getLogDataVectorPtr();
+    if (isConnected()) {
+        return mSubPortsVector[subPortIdx]->getLogDataColumn(dataId);
     }
-    return 0;
+    return LogDataColumnView();
 }
 
-const std::vector<std::vector<double> > *MultiPort::getLogDataVectorPtr(size_t subPortIdx) const
+void MultiPort::setEnableLogging(const bool enableLog)
 {
-    if (isConnected()) {
-        return mSubPortsVector[subPortIdx]->getLogDataVectorPtr();
-    }
-    return 0;
+    HOPSAN_UNUSED(enableLog);
+    // Do nothing since multiports can not be logged
 }
 
-void MultiPort::setEnableLogging(const bool enableLog)
+void MultiPort::setEnableVariableLogging(const size_t dataId, const bool enableLog)
 {
+    HOPSAN_UNUSED(dataId);
     HOPSAN_UNUSED(enableLog);
     // Do nothing since multiports can not be logged
 }
@@ -899,7 +899,7 @@ void CoreSystemAccess::getPlotData(const QString compname, const QString portnam
         dataId = pPort->getNodeDataIdFromName(dataname.toStdString().c_str());
         if (dataId > -1)
         {
-            std::vector< std::vector<double> > *pData = pPort->getLogDataVectorPtr();
+            const hopsan::LogDataColumnView data = pPort->getLogDataColumn(dataId);
             rpTimeVector = pPort->getLogTimeVectorPtr();
 
             // Instead of pData.size() lets ask for latest logsample, this way we can avoid coping log slots that have not bee written and contains junk
@@ -907,22 +907,19 @@ void CoreSystemAccess::getPlotData(const QString compname, const QString portnam
             size_t nElements;
             if (pPort->getNodePtr())
             {
-                nElements = qMin(pPort->getNodePtr()->getOwnerSystem()->getNumActuallyLoggedSamples(), pData->size());
+                nElements = qMin(pPort->getNodePtr()->getOwnerSystem()->getNumActuallyLoggedSamples(), data.size());
             }
             else
             {
                 // this should never happen i think
-                nElements = qMin(pData->size(), rpTimeVector->size());
+                nElements = qMin(data.size(), rpTimeVector->size());
             }
             //size_t nElements = min(pPort->getNodegetComponent()->getSystemParent()->getNumActuallyLoggedSamples(), pData->size());
             //qDebug() << "pData.size(): " << pData->size() << " nElements: " << nElements;
 
             //Ok lets copy all of the data to a Qt vector
             rData.resize(nElements); //Allocate memory for data
-            for (size_t i=0; i<nElements; ++i)
-            {
-                rData[i] = pData->at(i).at(dataId);
-            }
+            data.copyTo(rData.data(), nElements);
         }
     }
 }
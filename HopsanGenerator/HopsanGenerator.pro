@@ -70,7 +70,8 @@ SOURCES += \
     src/generators/HopsanLabViewGenerator.cpp \
     src/GeneratorTypes.cpp \
     src/generators/HopsanGeneratorBase.cpp \
-    src/generators/HopsanExeGenerator.cpp
+    src/generators/HopsanExeGenerator.cpp \
+    src/generators/HopsanCompiledModelGenerator.cpp
 
 HEADERS += \
     include/hopsangenerator_win32dll.h \
@@ -82,7 +83,8 @@ HEADERS += \
     include/GeneratorTypes.h \
     include/generators/HopsanGeneratorBase.h \
     include/hopsangenerator.h \
-    include/generators/HopsanExeGenerator.h
+    include/generators/HopsanExeGenerator.h \
+    include/generators/HopsanCompiledModelGenerator.h
 
 RESOURCES += \
     templates.qrc
@@ -29,6 +29,8 @@ extern "C" {
 
     HOPSANGENERATOR_DLLAPI bool callExeExportGenerator(const char* outputPath, void* pHopsanSystem,  const char* const externalLibraries[], const int numLibraries, const char* hopsanInstallPath, const char* compilerPath, int architecture=64, messagehandler_t messageHandler=0, void* pMessageObject=0);
 
+    HOPSANGENERATOR_DLLAPI bool callCompiledModelGenerator(const char* outputPath, void* pHopsanSystem, const char* hopsanInstallPath, const char* compilerPath, messagehandler_t messageHandler=0, void* pMessageObject=0);
+
     HOPSANGENERATOR_DLLAPI bool callAddComponentToLibrary(const char* libraryXMLPath, const char *targetPath, const char* typeName, const char* displayName, const char* cqsType, const char *transform, const char * const constantNames[], const int numConstantNames, const char * const constantDisplayNames[], const int numConstantDisplayNames, const char * const constantUnits[], const int numConstantUnits, const char * const constantInits[], const int numConstantInits, const char * const inputNames[], const int numInputNames, const char * const inputDescriptions[], const int numInputDescriptions, const char * const inputUnits[], const int numInputUnits, const char * const inputInits[], const int numInputInits, const char * const outputNames[], const int numOutputNames, const char * const outputDescriptions[], const int numOutputDescriptions, const char * const outputUnits[], const int numOutputUnits, const char * const outputInits[], const int numOutputInits, const char * const portNames[], const int numPortNames, const char * const portDescriptions[], const int numPortDescriptions, const char * const portTypes[], const int numPortTypes, const int portsRequired[], const int numPortsRequired, bool modelica, messagehandler_t messageHandler=nullptr, void* pMessageObject=0);
 
     HOPSANGENERATOR_DLLAPI bool callAddExistingComponentToLibrary(const char* libraryXMLPath, const char* cafPath, messagehandler_t messageHandler=0, void* pMessageObject=0);
@@ -36,6 +36,7 @@
 #include "generators/HopsanLabViewGenerator.h"
 #include "generators/HopsanFMIGenerator.h"
 #include "generators/HopsanExeGenerator.h"
+#include "generators/HopsanCompiledModelGenerator.h"
 #include "GeneratorUtilities.h"
 #include "GeneratorTypes.h"
 
@@ -364,6 +365,21 @@ bool callExeExportGenerator(const char* outputPath, void* pHopsanSystem, const c
 }
 
 
+//! @brief Calls the compiled model generator, that compiles the simulation schedule of a model ahead of time
+//! @param[in] outputPath Path to generate the source code and library in
+//! @param[in] pHopsanSystem Pointer to the top-level system of the model
+//! @param[in] hopsanInstallPath Path to the Hopsan installation where HopsanCore/include exists
+//! @param[in] compilerPath Path to the compiler binaries
+//! @param[in] messageHandler Callback for generator messages
+//! @param[in] pMessageObject Object passed to the message handler
+bool callCompiledModelGenerator(const char* outputPath, void* pHopsanSystem, const char* hopsanInstallPath, const char* compilerPath, messagehandler_t messageHandler, void* pMessageObject)
+{
+    auto pGenerator = std::unique_ptr<HopsanCompiledModelGenerator>(new HopsanCompiledModelGenerator(hopsanInstallPath, compilerPath));
+    pGenerator->setMessageHandler(messageHandler, pMessageObject);
+    return pGenerator->generateToCompiledModel(outputPath, static_cast<hopsan::ComponentSystem*>(pHopsanSystem));
+}
+
+
 //! @brief Adds a component to an existing library
 //! @param[in] libraryXmlPath Absolute path to library XML file
 //! @param[in] librarySourcePath Path to library CPP file relative to path for library XML file
@@ -0,0 +1,275 @@
+/*-----------------------------------------------------------------------------
+
+ Copyright 2017 Hopsan Group
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+
+
+ The full license is available in the file LICENSE.
+ For details about the 'Hopsan Group' or information about Authors and
+ Contributors see the HOPSANGROUP and AUTHORS files that are located in
+ the Hopsan source code root directory.
+
+-----------------------------------------------------------------------------*/
+
+#include "generators/HopsanCompiledModelGenerator.h"
+#include "GeneratorUtilities.h"
+#include "HopsanEssentials.h"
+#include "ComponentSystem.h"
+#include "CoreUtilities/CompiledModel.h"
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QTextStream>
+#include <QRegExp>
+
+using namespace hopsan;
+
+HopsanCompiledModelGenerator::HopsanCompiledModelGenerator(const QString &hopsanInstallPath, const QString &compilerPath, const QString &tempPath)
+    : HopsanGeneratorBase(hopsanInstallPath, compilerPath, tempPath)
+{
+}
+
+
+//! @brief Generates and compiles a library with the simulation schedule of a model, to be used with ComponentSystem::setCompiledModel()
+//! @details The schedule is taken from an initialized copy of the model with a flattened hierarchy. Components from the default library
+//! are simulated through pointers of their actual type, so that their simulateOneTimestep() can be inlined. Other components are
+//! simulated through the Component interface.
+//! @param[in] savePath The directory where the source code and the library is generated
+//! @param[in] pSystem The top-level system of the model
+//! @returns true if the library was generated and compiled, else false
+bool HopsanCompiledModelGenerator::generateToCompiledModel(QString savePath, ComponentSystem *pSystem)
+{
+    HopsanEssentials *pHopsanEssentials = pSystem->getHopsanEssentials();
+    if (!pHopsanEssentials)
+    {
+        printErrorMessage("The system does not belong to a HopsanCore instance.");
+        return false;
+    }
+
+    const QString modelName = toValidHopsanVarName(pSystem->getName().c_str());
+    QDir().mkpath(savePath);
+
+    //------------------------------------------------------------------//
+    // Initialize a copy of the model to get its flattened schedule
+    //------------------------------------------------------------------//
+
+    printMessage("Initializing a copy of the model to get the simulation schedule...");
+    ComponentSystem *pCopy = pHopsanEssentials->cloneComponentSystem(pSystem);
+    if (!pCopy)
+    {
+        printErrorMessage("Could not copy the model.");
+        return false;
+    }
+    pCopy->setUseHierarchyFlattening(true);
+    pCopy->setNumLogSamples(0);
+    if (!pCopy->checkModelBeforeSimulation() || !pCopy->initialize(0, pCopy->getTimestep()))
+    {
+        printErrorMessage("Could not initialize the model, the simulation schedule is unknown.");
+        pHopsanEssentials->removeComponent(pCopy);
+        return false;
+    }
+
+    std::vector<Component*> schedule[3];
+    pCopy->getSimulationSchedule(schedule[0], schedule[1], schedule[2]);
+    const QString sourceFile = modelName+"_compiled.cpp";
+    const bool genOK = generateCompiledModelSourceFile(savePath+"/"+sourceFile, pSystem->getName().c_str(), schedule);
+    pCopy->finalize();
+    pHopsanEssentials->removeComponent(pCopy);
+    if (!genOK)
+    {
+        return false;
+    }
+
+    //------------------------------------------------------------------//
+    // Compiling and linking
+    //------------------------------------------------------------------//
+
+    if (!compileCompiledModel(savePath, sourceFile, modelName))
+    {
+        printErrorMessage("Failed to compile the compiled model library.");
+        return false;
+    }
+
+    printMessage("Finished.");
+    return true;
+}
+
+
+//! @brief Returns the type names registered by the default component library
+//! @details The default library registers each component with the same type name as its class name
+QSet<QString> HopsanCompiledModelGenerator::getDefaultLibraryTypeNames() const
+{
+    QSet<QString> typeNames;
+    QStringList cciFiles;
+    findAllFilesInFolderAndSubFolders(mHopsanRootPath+"/componentLibraries/defaultLibrary", "cci", cciFiles);
+    QRegExp registerRx("registerCreatorFunction\\(\\s*\"(\\w+)\"");
+    for (const QString &cciFile : cciFiles)
+    {
+        QFile file(cciFile);
+        if (!file.open(QIODevice::ReadOnly | QIODevice::Text))
+        {
+            continue;
+        }
+        const QString contents = QTextStream(&file).readAll();
+        for (int pos = registerRx.indexIn(contents); pos >= 0; pos = registerRx.indexIn(contents, pos+registerRx.matchedLength()))
+        {
+            typeNames.insert(registerRx.cap(1));
+        }
+    }
+    return typeNames;
+}
+
+
+//! @brief Writes the source code of a compiled model
+//! @param[in] filePath The source file to write
+//! @param[in] modelName The name of the model
+//! @param[in] schedule The signal, C and Q components of the model in execution order
+//! @returns true if the file could be written, else false
+bool HopsanCompiledModelGenerator::generateCompiledModelSourceFile(const QString &filePath, const QString &modelName, const std::vector<Component*> (&schedule)[3]) const
+{
+    const QSet<QString> defaultTypeNames = getDefaultLibraryTypeNames();
+    const char* vectorNames[3] = {"rSignalComponents", "rCComponents", "rQComponents"};
+
+    QString members, bindCode, simulateCode;
+    QTextStream membersStream(&members), bindStream(&bindCode), simulateStream(&simulateCode);
+    size_t numTyped=0, numGeneric=0;
+    bindStream << "        if (";
+    for (int v=0; v<3; ++v)
+    {
+        bindStream << (v>0 ? " || " : "") << vectorNames[v] << ".size() != " << schedule[v].size();
+    }
+    bindStream << ")\n        {\n            return false;\n        }\n";
+
+    for (int v=0; v<3; ++v)
+    {
+        for (size_t i=0; i<schedule[v].size(); ++i)
+        {
+            const Component *pComponent = schedule[v][i];
+            const QString typeName = pComponent->getTypeName().c_str();
+            QString path = getCompiledModelComponentPath(pComponent).c_str();
+            path.replace("\\", "\\\\").replace("\"", "\\\"");
+            const QString member = QString("mp%1%2").arg(QString("SCQ").at(v)).arg(i);
+            const QString element = QString("%1[%2]").arg(vectorNames[v]).arg(i);
+            bindStream << "        if (!isCompiledModelComponent(" << element << ", \"" << path << "\", \"" << typeName << "\"))\n";
+            bindStream << "        {\n            return false;\n        }\n";
+
+            if (defaultTypeNames.contains(typeName) && !pComponent->isComponentSystem())
+            {
+                membersStream << "    " << typeName << " *" << member << ";\n";
+                bindStream << "        " << member << " = static_cast<" << typeName << "*>(" << element << ");\n";
+                simulateStream << "        simulateCompiledComponent(" << member << ");\n";
+                ++numTyped;
+            }
+            else
+            {
+                membersStream << "    Component *" << member << ";\n";
+                bindStream << "        " << member << " = " << element << ";\n";
+                simulateStream << "        " << member << "->simulate(time);\n";
+                ++numGeneric;
+            }
+        }
+    }
+    membersStream.flush();
+    bindStream.flush();
+    simulateStream.flush();
+    printMessage(QString("Compiled schedule: %1 components with known type, %2 components called through the Component interface").arg(numTyped).arg(numGeneric));
+
+    QFile file(filePath);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Text))
+    {
+        printErrorMessage("Failed to open "+filePath+" for writing.");
+        return false;
+    }
+    QString escapedModelName = modelName;
+    escapedModelName.replace("\\", "\\\\").replace("\"", "\\\"");
+
+    QTextStream stream(&file);
+    stream << "// Compiled simulation schedule for model: " << modelName << "\n";
+    stream << "// Generated by HopsanGenerator, do not edit\n\n";
+    stream << "#include \"ComponentEssentials.h\"\n";
+    stream << "#include \"CoreUtilities/CompiledModel.h\"\n";
+    stream << "#include \"Components.h\"\n\n";
+    stream << "using namespace hopsan;\n\n";
+    stream << "namespace {\n\n";
+    stream << "class GeneratedCompiledModel : public CompiledModel\n{\n";
+    stream << "public:\n";
+    stream << "    const char *getModelName() const\n    {\n        return \"" << escapedModelName << "\";\n    }\n\n";
+    stream << "    bool bind(const std::vector<Component*> &rSignalComponents, const std::vector<Component*> &rCComponents,\n";
+    stream << "              const std::vector<Component*> &rQComponents)\n    {\n";
+    stream << bindCode;
+    stream << "        return true;\n    }\n\n";
+    stream << "    void simulateOneTimestep(const double time)\n    {\n";
+    stream << "        (void)time;\n";
+    stream << simulateCode;
+    stream << "    }\n\n";
+    stream << "private:\n";
+    stream << members;
+    stream << "};\n\n";
+    stream << "}\n\n";
+    stream << "extern \"C\" DLLEXPORT CompiledModel *create_compiled_model()\n{\n    return new GeneratedCompiledModel();\n}\n\n";
+    stream << "extern \"C\" DLLEXPORT void get_hopsan_info(HopsanExternalLibInfoT *pHopsanExternalLibInfo)\n{\n";
+    stream << "    pHopsanExternalLibInfo->libName = (char*)\"" << escapedModelName << "_compiled\";\n";
+    stream << "    pHopsanExternalLibInfo->hopsanCoreVersion = (char*)HOPSANCOREVERSION;\n";
+    stream << "    pHopsanExternalLibInfo->libCompiledDebugRelease = (char*)HOPSAN_BUILD_TYPE_STR;\n";
+    stream << "}\n";
+    file.close();
+    return true;
+}
+
+
+//! @brief Compiles the generated source code of a compiled model with optimization and link time optimization
+//! @param[in] buildPath The directory with the source file, the library is created here
+//! @param[in] sourceFile The source file name
+//! @param[in] modelName The model name used in the library file name
+//! @returns true if compilation succeeded, else false
+bool HopsanCompiledModelGenerator::compileCompiledModel(const QString &buildPath, const QString &sourceFile, const QString &modelName) const
+{
+    using Compiler = CompilerHandler::Compiler;
+
+    CompilerHandler ch(CompilerHandler::Language::Cpp);
+    for (const QString &includePath : getHopsanCoreIncludePaths())
+    {
+        ch.addIncludePath(mHopsanRootPath+"/"+includePath);
+    }
+    ch.addCompilerFlag("-fPIC -w -O3 -flto", {Compiler::GCC, Compiler::Clang});
+    ch.addLinkerFlag("-O3 -flto", {Compiler::GCC, Compiler::Clang});
+
+    ch.addLibraryPath(getHopsanBinPath());
+    ch.addLibraryPath(getHopsanLibPath());
+    CompilerHandler::BuildType buildType = CompilerHandler::BuildType::Release;
+#if defined(HOPSAN_BUILD_TYPE_DEBUG)
+    buildType = CompilerHandler::BuildType::Debug;
+    ch.addDefinition("HOPSAN_BUILD_TYPE_DEBUG");
+    ch.addLinkLibrary("hopsancore_d");
+#else
+    ch.addDefinition("HOPSAN_BUILD_TYPE_RELEASE");
+    ch.addLinkLibrary("hopsancore");
+#endif
+#ifdef _WIN32
+    ch.addDefinition("HOPSANCORE_DLLIMPORT", "");
+#endif
+    ch.addLinkLibrary("c++", {Compiler::Clang});
+
+    ch.setSourceFiles(QStringList() << sourceFile);
+    ch.setSharedLibraryOutputFile(LIBPREFIX+modelName+"_compiled", buildType);
+
+    printMessage("Output file:    "+ch.outputFile());
+    printMessage("Compiler flags: "+ch.compilerFlags(mCompilerSelection.compiler).join(" "));
+    printMessage("Linker flags:   "+ch.linkerFlags(mCompilerSelection.compiler).join(" "));
+    printMessage("Compiling please wait!");
+    QString output;
+    const bool success = compile(buildPath, mCompilerSelection.path, ch, mCompilerSelection.compiler, output);
+    printMessage(output);
+    return success;
+}
@@ -37,6 +37,14 @@ class hopsan:
     def setParameter(self, name, value):
         self.hdll.setParameter(name.encode(), value.encode())
 
+    def getParameterHandle(self, name):
+        return self.hdll.getParameterHandle(name.encode())
+
+    def setParameterByHandle(self, handle, value):
+        import ctypes
+        self.hdll.setParameterByHandle.argtypes = [ctypes.c_int, ctypes.c_double]
+        self.hdll.setParameterByHandle(handle, value)
+
     def setStartTime(self, value):
         import ctypes
         self.hdll.setStartTime.argtypes = [ctypes.c_double]
@@ -0,0 +1,33 @@
+#-------------------------------------------------
+#
+# Micro-benchmarks for core hot-path primitives
+#
+#-------------------------------------------------
+QT       += testlib
+QT       -= gui
+
+#Determine debug extension
+include( ../../../Common.prf )
+
+TARGET = tst_microbenchmarks$${DEBUG_EXT}
+CONFIG   += console
+CONFIG   -= app_bundle
+DESTDIR = $${PWD}/../../../bin
+
+TEMPLATE = app
+
+INCLUDEPATH += $${PWD}/../../../HopsanCore/include/
+LIBS += -L$${PWD}/../../../bin -lhopsancore$${DEBUG_EXT}
+DEFINES *= HOPSANCORE_DLLIMPORT
+
+# Enable C++14
+CONFIG += c++14
+
+unix{
+QMAKE_LFLAGS *= -Wl,-rpath,\'\$$ORIGIN/./\'
+
+}
+
+SOURCES += \
+    tst_microbenchmarks.cpp
+DEFINES += SRCDIR=\\\"$$PWD/\\\"
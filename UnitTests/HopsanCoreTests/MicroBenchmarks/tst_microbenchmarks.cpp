@@ -0,0 +1,946 @@
+/*-----------------------------------------------------------------------------
+
+ Copyright 2017 Hopsan Group
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+
+
+ The full license is available in the file LICENSE.
+ For details about the 'Hopsan Group' or information about Authors and
+ Contributors see the HOPSANGROUP and AUTHORS files that are located in
+ the Hopsan source code root directory.
+
+-----------------------------------------------------------------------------*/
+
+//!
+//! @file   tst_microbenchmarks.cpp
+//! @brief  Micro-benchmarks for the core primitives used in the simulation hot path, and for model level operations
+//!
+//! Each benchmark is timed as a number of samples, every sample runs enough operations to take at least
+//! a couple of milliseconds. The min, median, mean and standard deviation of the time per operation are
+//! printed, and the median is reported to QtTest as the benchmark result (so -csv, -xml etc. work).
+//! Set HOPSAN_MICROBENCHMARK_SAMPLES to change the number of samples (default 21).
+//!
+
+#include <QtTest>
+
+#include "HopsanEssentials.h"
+#include "HopsanCoreVersion.h"
+#include "ComponentSystem.h"
+#include "Nodes.h"
+#include "CoreUtilities/BinaryModelFile.h"
+#include "CoreUtilities/ClassFactory.hpp"
+#include "ComponentUtilities/Delay.hpp"
+#include "ComponentUtilities/LookupTable.h"
+#include "ComponentUtilities/Integrator.h"
+#include "ComponentUtilities/FirstOrderTransferFunction.h"
+#include "ComponentUtilities/TurbulentFlowFunction.h"
+#include "ComponentUtilities/num2string.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <vector>
+
+#ifndef DEFAULT_LIBRARY_ROOT
+#define DEFAULT_LIBRARY_ROOT "../componentLibraries/defaultLibrary"
+#endif
+
+// The model level benchmarks use the model from the simulation test
+#ifndef TEST_DATA_ROOT
+#define TEST_DATA_ROOT "../UnitTests/HopsanCoreTests/SimulationTest/"
+#endif
+
+#ifndef HOPSAN_INTERNALDEFAULTCOMPONENTS
+#define DEFAULTLIBFILE SHAREDLIB_PREFIX "defaultcomponentlibrary" HOPSAN_DEBUG_POSTFIX "." SHAREDLIB_SUFFIX
+const std::string defaultLibraryFilePath = DEFAULT_LIBRARY_ROOT "/" DEFAULTLIBFILE;
+#else
+const std::string defaultLibraryFilePath = "";
+#endif
+
+using namespace hopsan;
+
+Q_DECLARE_METATYPE(HString)
+
+//! @brief Timing statistics for one benchmark, all times are in nanoseconds per operation
+class BenchmarkStatistics
+{
+public:
+    double min = 0;
+    double median = 0;
+    double mean = 0;
+    double stddev = 0;
+    size_t numSamples = 0;
+    size_t numOperationsPerSample = 0;
+};
+
+//! @brief Times a benchmark function and computes statistics over a number of samples
+//! @param [in] func Function taking the number of operations to run, it returns a value that depends on the work done
+//! @param [out] rSink Receives the (accumulated) return values of func, so that the work can not be optimized away
+//! @returns The statistics of the time per operation
+template<typename BenchmarkFunctionT>
+BenchmarkStatistics measure(BenchmarkFunctionT func, double &rSink)
+{
+    typedef std::chrono::steady_clock ClockT;
+    const double minSampleTime = 2e-3;
+
+    size_t numSamples = 21;
+    const char* pSamplesEnv = std::getenv("HOPSAN_MICROBENCHMARK_SAMPLES");
+    if (pSamplesEnv && std::atoi(pSamplesEnv) > 0)
+    {
+        numSamples = size_t(std::atoi(pSamplesEnv));
+    }
+
+    auto runSample = [&](const size_t numOperations) -> double
+    {
+        const ClockT::time_point start = ClockT::now();
+        rSink += func(numOperations);
+        return std::chrono::duration<double>(ClockT::now()-start).count();
+    };
+
+    // Calibrate the number of operations per sample, this also warms up caches and branch predictors
+    size_t numOperations = 1;
+    while (runSample(numOperations) < minSampleTime && numOperations < (size_t(1) << 30))
+    {
+        numOperations *= 2;
+    }
+
+    std::vector<double> timesPerOperation(numSamples);
+    for (double &rTime : timesPerOperation)
+    {
+        rTime = runSample(numOperations)*1e9/double(numOperations);
+    }
+    std::sort(timesPerOperation.begin(), timesPerOperation.end());
+
+    BenchmarkStatistics stats;
+    stats.numSamples = numSamples;
+    stats.numOperationsPerSample = numOperations;
+    stats.min = timesPerOperation.front();
+    stats.median = (numSamples % 2) ? timesPerOperation[numSamples/2] : 0.5*(timesPerOperation[numSamples/2-1]+timesPerOperation[numSamples/2]);
+    for (const double time : timesPerOperation)
+    {
+        stats.mean += time;
+    }
+    stats.mean /= double(numSamples);
+    for (const double time : timesPerOperation)
+    {
+        stats.stddev += (time-stats.mean)*(time-stats.mean);
+    }
+    stats.stddev = (numSamples > 1) ? std::sqrt(stats.stddev/double(numSamples-1)) : 0;
+    return stats;
+}
+
+//! @brief Prints the statistics for the current test function and data row and reports the median to QtTest
+void report(const BenchmarkStatistics &rStats)
+{
+    QString name = QTest::currentTestFunction();
+    if (QTest::currentDataTag() && *QTest::currentDataTag())
+    {
+        name += QString(":") + QTest::currentDataTag();
+    }
+    qDebug("%-44s min %10.3f  median %10.3f  mean %10.3f  stddev %8.3f ns/op  (%d x %d ops)", qPrintable(name),
+           rStats.min, rStats.median, rStats.mean, rStats.stddev, int(rStats.numSamples), int(rStats.numOperationsPerSample));
+    QTest::setBenchmarkResult(rStats.median, QTest::WalltimeNanoseconds);
+}
+
+//! @brief Fills a lookup table with an index vector of the given size in each dimension and the sum of the indices as values
+void fillLookupTable(LookupTableNDBase &rTable, const size_t numDims, const size_t numIndexValues)
+{
+    size_t numValues = 1;
+    for (size_t d=0; d<numDims; ++d)
+    {
+        std::vector<double> &rIndex = rTable.getIndexDataRef(d);
+        rIndex.resize(numIndexValues);
+        for (size_t i=0; i<numIndexValues; ++i)
+        {
+            rIndex[i] = double(i)*double(i)/double(numIndexValues);
+        }
+        numValues *= numIndexValues;
+    }
+    std::vector<double> &rValues = rTable.getValueDataRef();
+    rValues.resize(numValues);
+    for (size_t v=0; v<numValues; ++v)
+    {
+        size_t rest = v;
+        rValues[v] = 0;
+        for (size_t d=numDims; d>0; --d)
+        {
+            rValues[v] += rTable.getIndexDataRef(d-1)[rest % numIndexValues];
+            rest /= numIndexValues;
+        }
+    }
+}
+
+//! @brief Base class for the ClassFactory benchmark
+class FactoryBase
+{
+public:
+    virtual ~FactoryBase() {}
+    virtual double value() const = 0;
+};
+
+//! @brief Class created by the ClassFactory benchmark
+class FactoryProduct : public FactoryBase
+{
+public:
+    static FactoryBase* creatorFunction() {return new FactoryProduct();}
+    double value() const {return 1.0;}
+};
+
+
+class MicroBenchmarks : public QObject
+{
+    Q_OBJECT
+
+public:
+    MicroBenchmarks()
+    {
+        mSink = 0;
+    }
+
+private:
+    HopsanEssentials mHopsanCore;
+    double mSink;
+
+    //! @brief Creates a system with one constant connected to a sum component and a gain, and numSumInputs constants connected to the sum
+    ComponentSystem* createSignalSystem(const size_t numSumInputs)
+    {
+        ComponentSystem *pSystem = mHopsanCore.createComponentSystem();
+        pSystem->setName("MicroBenchmarkSystem");
+        pSystem->setDesiredTimestep(0.001);
+        pSystem->setNumLogSamples(1000);
+        Component *pGain = mHopsanCore.createComponent("SignalGain");
+        Component *pSum = mHopsanCore.createComponent("SignalSum");
+        pGain->setName("Gain");
+        pSum->setName("Sum");
+        pSystem->addComponent(pGain);
+        pSystem->addComponent(pSum);
+        bool ok = true;
+        for (size_t i=0; i<numSumInputs; ++i)
+        {
+            Component *pConstant = mHopsanCore.createComponent("SignalConstant");
+            pSystem->addComponent(pConstant);
+            ok = ok && pSystem->connect(pConstant->getPort("y"), pSum->getPort("in"));
+        }
+        ok = ok && pSystem->connect(pSum->getPort("out"), pGain->getPort("in"));
+        if (!ok || !pSystem->checkModelBeforeSimulation() || !pSystem->initialize(0, 1))
+        {
+            mHopsanCore.removeComponent(pSystem);
+            return nullptr;
+        }
+        return pSystem;
+    }
+
+    //! @brief Creates a system where a signal chain and a hydraulic line are split over nested subsystems
+    //! @details Sine wave -> one gain per signal subsystem level -> pressure source -> orifice and volumes around the next level in each hydraulic
+    //! subsystem level -> orifice -> tank. No signal passes the border of a hydraulic subsystem.
+    ComponentSystem* createNestedSystem(const size_t numLevels)
+    {
+        ComponentSystem *pSystem = mHopsanCore.createComponentSystem();
+        pSystem->setName("NestedSystem");
+        pSystem->setDesiredTimestep(0.001);
+        pSystem->setNumLogSamples(101);
+        Component *pSine = mHopsanCore.createComponent("SignalSineWave");
+        Component *pSource = mHopsanCore.createComponent("HydraulicPressureSourceC");
+        Component *pTank = mHopsanCore.createComponent("HydraulicTankC");
+        pSystem->addComponent(pSine);
+        pSystem->addComponent(pSource);
+        pSystem->addComponent(pTank);
+        bool ok = pSine->setParameterValue("y_A#Value", "1e6");
+
+        // Each signal level gets the signal from its parent, passes it through a gain and returns it to its parent
+        ComponentSystem *pParent = pSystem;
+        Port *pFrom = pSine->getPort("out");
+        Port *pTo = pSource->getPort("p");
+        for (size_t i=0; i<numLevels; ++i)
+        {
+            ComponentSystem *pLevel = mHopsanCore.createComponentSystem();
+            pLevel->setName(HString("SignalLevel")+to_hstring(i));
+            pParent->addComponent(pLevel);
+            Port *pIn = pLevel->addSystemPort("in");
+            Port *pOut = pLevel->addSystemPort("out");
+            Component *pGain = mHopsanCore.createComponent("SignalGain");
+            pLevel->addComponent(pGain);
+            ok = ok && pParent->connect(pFrom, pIn) && pParent->connect(pOut, pTo) && pLevel->connect(pIn, pGain->getPort("in"));
+            pParent = pLevel;
+            pFrom = pGain->getPort("out");
+            pTo = pOut;
+        }
+        ok = ok && pParent->connect(pFrom, pTo);
+
+        // Each hydraulic level has an orifice at each border, with a volume between each orifice and the next level
+        pParent = pSystem;
+        pFrom = pSource->getPort("P1");
+        pTo = pTank->getPort("P1");
+        for (size_t i=0; i<numLevels; ++i)
+        {
+            ComponentSystem *pLevel = mHopsanCore.createComponentSystem();
+            pLevel->setName(HString("HydraulicLevel")+to_hstring(i));
+            pParent->addComponent(pLevel);
+            Port *pP1 = pLevel->addSystemPort("P1");
+            Port *pP2 = pLevel->addSystemPort("P2");
+            Component *pOrifice1 = mHopsanCore.createComponent("HydraulicLaminarOrifice");
+            Component *pVolume1 = mHopsanCore.createComponent("HydraulicVolume");
+            Component *pVolume2 = mHopsanCore.createComponent("HydraulicVolume");
+            Component *pOrifice2 = mHopsanCore.createComponent("HydraulicLaminarOrifice");
+            pOrifice1->setName("Orifice1");
+            pVolume1->setName("Volume1");
+            pVolume2->setName("Volume2");
+            pOrifice2->setName("Orifice2");
+            Component *components[] = {pOrifice1, pVolume1, pVolume2, pOrifice2};
+            for (Component *pComponent : components)
+            {
+                pLevel->addComponent(pComponent);
+            }
+            ok = ok && pParent->connect(pFrom, pP1) && pParent->connect(pP2, pTo) &&
+                 pLevel->connect(pP1, pOrifice1->getPort("P1")) && pLevel->connect(pOrifice1->getPort("P2"), pVolume1->getPort("P1")) &&
+                 pLevel->connect(pVolume2->getPort("P2"), pOrifice2->getPort("P1")) && pLevel->connect(pOrifice2->getPort("P2"), pP2);
+            pParent = pLevel;
+            pFrom = pVolume1->getPort("P2");
+            pTo = pVolume2->getPort("P1");
+        }
+        Component *pOrifice = mHopsanCore.createComponent("HydraulicLaminarOrifice");
+        pParent->addComponent(pOrifice);
+        ok = ok && pParent->connect(pFrom, pOrifice->getPort("P1")) && pParent->connect(pOrifice->getPort("P2"), pTo);
+
+        if (!ok)
+        {
+            mHopsanCore.removeComponent(pSystem);
+            return nullptr;
+        }
+        return pSystem;
+    }
+
+    //! @brief Loads the model used by the simulation test
+    ComponentSystem* loadTestModel()
+    {
+        double startT, stopT;
+        return mHopsanCore.loadHMFModelFile(TEST_DATA_ROOT "unittestmodel.hmf", startT, stopT);
+    }
+
+private Q_SLOTS:
+    void initTestCase()
+    {
+        bool did_load = mHopsanCore.loadExternalComponentLib(defaultLibraryFilePath.c_str());
+        QVERIFY2(did_load, qPrintable(QString("Could not load default component library: ")+QString::fromStdString(defaultLibraryFilePath)));
+    }
+
+    void cleanupTestCase()
+    {
+        // Print the sink so that the compiler can not remove any of the benchmarked work
+        qDebug("Checksum: %g", mSink);
+    }
+
+    void Port_ReadWriteNode()
+    {
+        QFETCH(bool, virtualAccess);
+
+        ComponentSystem *pSystem = createSignalSystem(1);
+        QVERIFY2(pSystem, "Could not create benchmark system");
+        Port *pIn = pSystem->getSubComponent("Gain")->getPort("in");
+        Port *pOut = pSystem->getSubComponent("Gain")->getPort("out");
+
+        BenchmarkStatistics stats;
+        if (virtualAccess)
+        {
+            stats = measure([&](const size_t n) {
+                for (size_t i=0; i<n; ++i)
+                {
+                    pOut->writeNode(NodeSignal::Value, pIn->readNode(NodeSignal::Value, 0)+1.0, 0);
+                }
+                return pOut->readNode(NodeSignal::Value, 0);
+            }, mSink);
+        }
+        else
+        {
+            stats = measure([&](const size_t n) {
+                for (size_t i=0; i<n; ++i)
+                {
+                    pOut->writeNode(NodeSignal::Value, pIn->readNode(NodeSignal::Value)+1.0);
+                }
+                return pOut->readNode(NodeSignal::Value);
+            }, mSink);
+        }
+        report(stats);
+
+        pSystem->finalize();
+        mHopsanCore.removeComponent(pSystem);
+    }
+
+    void Port_ReadWriteNode_data()
+    {
+        QTest::addColumn<bool>("virtualAccess");
+        QTest::newRow("direct") << false;
+        QTest::newRow("subport_index") << true;
+    }
+
+    void MultiPort_SubPortAccess()
+    {
+        QFETCH(int, numSubPorts);
+
+        ComponentSystem *pSystem = createSignalSystem(size_t(numSubPorts));
+        QVERIFY2(pSystem, "Could not create benchmark system");
+        Port *pMultiPort = pSystem->getSubComponent("Sum")->getPort("in");
+        QVERIFY(pMultiPort->isMultiPort());
+        QCOMPARE(pMultiPort->getNumPorts(), size_t(numSubPorts));
+
+        // One operation is a read of all sub ports, the same way a component reads a multiport in simulateOneTimestep
+        const BenchmarkStatistics stats = measure([&](const size_t n) {
+            double sum = 0;
+            for (size_t i=0; i<n; ++i)
+            {
+                const size_t numPorts = pMultiPort->getNumPorts();
+                for (size_t p=0; p<numPorts; ++p)
+                {
+                    sum += pMultiPort->readNode(NodeSignal::Value, p);
+                }
+            }
+            return sum;
+        }, mSink);
+        report(stats);
+
+        pSystem->finalize();
+        mHopsanCore.removeComponent(pSystem);
+    }
+
+    void MultiPort_SubPortAccess_data()
+    {
+        QTest::addColumn<int>("numSubPorts");
+        QTest::newRow("2") << 2;
+        QTest::newRow("8") << 8;
+        QTest::newRow("32") << 32;
+    }
+
+    void Delay_Update()
+    {
+        QFETCH(int, delaySteps);
+
+        Delay delay;
+        delay.initialize(delaySteps, 0.0);
+        const BenchmarkStatistics stats = measure([&](const size_t n) {
+            double sum = 0;
+            for (size_t i=0; i<n; ++i)
+            {
+                sum += delay.update(double(i));
+            }
+            return sum;
+        }, mSink);
+        report(stats);
+    }
+
+    void Delay_Update_data()
+    {
+        QTest::addColumn<int>("delaySteps");
+        QTest::newRow("1") << 1;
+        QTest::newRow("16") << 16;
+        QTest::newRow("1024") << 1024;
+    }
+
+    void LookupTable_Interpolate()
+    {
+        QFETCH(int, numDims);
+        QFETCH(int, numIndexValues);
+
+        LookupTable1D table1D;
+        LookupTable2D table2D;
+        LookupTable3D table3D;
+        LookupTableNDBase *pTable = (numDims == 1) ? static_cast<LookupTableNDBase*>(&table1D) :
+                                    (numDims == 2) ? static_cast<LookupTableNDBase*>(&table2D) : static_cast<LookupTableNDBase*>(&table3D);
+        fillLookupTable(*pTable, size_t(numDims), size_t(numIndexValues));
+        QVERIFY(pTable->isDataOK());
+
+        // Scattered lookup points (including some outside the index range) so that the index search is exercised
+        const size_t numPoints = 1024;
+        const double maxIndex = pTable->getIndexDataRef(0).back();
+        std::vector<double> points(numPoints);
+        for (size_t i=0; i<numPoints; ++i)
+        {
+            points[i] = maxIndex*(double((i*617) % numPoints)/double(numPoints-1)*1.1 - 0.05);
+        }
+
+        BenchmarkStatistics stats;
+        if (numDims == 1)
+        {
+            stats = measure([&](const size_t n) {
+                double sum = 0;
+                for (size_t i=0; i<n; ++i)
+                {
+                    sum += table1D.interpolate(points[i % numPoints]);
+                }
+                return sum;
+            }, mSink);
+        }
+        else if (numDims == 2)
+        {
+            stats = measure([&](const size_t n) {
+                double sum = 0;
+                for (size_t i=0; i<n; ++i)
+                {
+                    sum += table2D.interpolate(points[i % numPoints], points[(i+1) % numPoints]);
+                }
+                return sum;
+            }, mSink);
+        }
+        else
+        {
+            stats = measure([&](const size_t n) {
+                double sum = 0;
+                for (size_t i=0; i<n; ++i)
+                {
+                    sum += table3D.interpolate(points[i % numPoints], points[(i+1) % numPoints], points[(i+2) % numPoints]);
+                }
+                return sum;
+            }, mSink);
+        }
+        report(stats);
+    }
+
+    void LookupTable_Interpolate_data()
+    {
+        QTest::addColumn<int>("numDims");
+        QTest::addColumn<int>("numIndexValues");
+        QTest::newRow("1D_16") << 1 << 16;
+        QTest::newRow("1D_4096") << 1 << 4096;
+        QTest::newRow("2D_16") << 2 << 16;
+        QTest::newRow("2D_256") << 2 << 256;
+        QTest::newRow("3D_16") << 3 << 16;
+    }
+
+    void Integrator_Update()
+    {
+        Integrator integrator;
+        integrator.initialize(0.001, 0.0, 0.0);
+        const BenchmarkStatistics stats = measure([&](const size_t n) {
+            for (size_t i=0; i<n; ++i)
+            {
+                integrator.update(double(i & 0xff));
+            }
+            return integrator.value();
+        }, mSink);
+        report(stats);
+    }
+
+    void FirstOrderTransferFunction_Update()
+    {
+        QFETCH(bool, saturated);
+
+        double num[2] = {1.0, 0.0};
+        double den[2] = {1.0, 0.01};
+        FirstOrderTransferFunction tf;
+        if (saturated)
+        {
+            tf.initialize(0.001, num, den, 0.0, 0.0, -10.0, 10.0);
+        }
+        else
+        {
+            tf.initialize(0.001, num, den);
+        }
+        const BenchmarkStatistics stats = measure([&](const size_t n) {
+            double sum = 0;
+            for (size_t i=0; i<n; ++i)
+            {
+                sum += tf.update((i & 0x100) ? 100.0 : -100.0);
+            }
+            return sum;
+        }, mSink);
+        report(stats);
+    }
+
+    void FirstOrderTransferFunction_Update_data()
+    {
+        QTest::addColumn<bool>("saturated");
+        QTest::newRow("unlimited") << false;
+        QTest::newRow("limited") << true;
+    }
+
+    void Node_LogData()
+    {
+        ComponentSystem *pSystem = createSignalSystem(1);
+        QVERIFY2(pSystem, "Could not create benchmark system");
+        Node *pNode = pSystem->getSubComponent("Gain")->getPort("out")->getNodePtr();
+        // The number of log slots can be lower than the requested number of log samples, use the actual column length
+        const size_t numLogSlots = pNode->getLogDataColumn(NodeSignal::Value).size();
+        QVERIFY(numLogSlots > 0);
+
+        const BenchmarkStatistics stats = measure([&](const size_t n) {
+            for (size_t i=0; i<n; ++i)
+            {
+                pNode->logData(i % numLogSlots);
+            }
+            return double(n);
+        }, mSink);
+        report(stats);
+        QVERIFY(pNode->haveLogData());
+
+        pSystem->finalize();
+        mHopsanCore.removeComponent(pSystem);
+    }
+
+    void HString_Concatenate()
+    {
+        QFETCH(int, length);
+
+        const HString part(std::string(size_t(length), 'x').c_str());
+        const BenchmarkStatistics stats = measure([&](const size_t n) {
+            size_t totalSize = 0;
+            for (size_t i=0; i<n; ++i)
+            {
+                HString result = part + "." + part;
+                result += '#';
+                totalSize += result.size();
+            }
+            return double(totalSize);
+        }, mSink);
+        report(stats);
+    }
+
+    void HString_Concatenate_data()
+    {
+        QTest::addColumn<int>("length");
+        QTest::newRow("8") << 8;
+        QTest::newRow("64") << 64;
+    }
+
+    void HString_Compare()
+    {
+        QFETCH(HString, string1);
+        QFETCH(HString, string2);
+
+        const BenchmarkStatistics stats = measure([&](const size_t n) {
+            size_t numEqual = 0;
+            for (size_t i=0; i<n; ++i)
+            {
+                numEqual += (string1 == string2) ? 1 : 0;
+                numEqual += (string1 < string2) ? 1 : 0;
+            }
+            return double(numEqual);
+        }, mSink);
+        report(stats);
+    }
+
+    void HString_Compare_data()
+    {
+        QTest::addColumn<HString>("string1");
+        QTest::addColumn<HString>("string2");
+        QTest::newRow("equal") << HString("HydraulicVolumeMultiPort") << HString("HydraulicVolumeMultiPort");
+        QTest::newRow("differ_at_end") << HString("HydraulicVolumeMultiPort") << HString("HydraulicVolumeMultiPorT");
+        QTest::newRow("differ_in_length") << HString("HydraulicVolume") << HString("HydraulicVolumeMultiPort");
+    }
+
+    void ClassFactory_CreateInstance()
+    {
+        QFETCH(int, numKeys);
+
+        ClassFactory<HString, FactoryBase> factory;
+        for (int i=0; i<numKeys; ++i)
+        {
+            factory.registerCreatorFunction(HString("FactoryProduct")+to_hstring(i), &FactoryProduct::creatorFunction);
+        }
+        const HString key = HString("FactoryProduct")+to_hstring(numKeys/2);
+        QVERIFY(factory.hasKey(key));
+
+        const BenchmarkStatistics stats = measure([&](const size_t n) {
+            double sum = 0;
+            for (size_t i=0; i<n; ++i)
+            {
+                FactoryBase *pInstance = factory.createInstance(key);
+                sum += pInstance->value();
+                delete pInstance;
+            }
+            return sum;
+        }, mSink);
+        report(stats);
+    }
+
+    void ClassFactory_CreateInstance_data()
+    {
+        QTest::addColumn<int>("numKeys");
+        QTest::newRow("16") << 16;
+        QTest::newRow("512") << 512;
+    }
+
+    void Component_Create()
+    {
+        // Creation through the HopsanEssentials component factory, including construction and configuration of the component
+        const BenchmarkStatistics stats = measure([&](const size_t n) {
+            double numPorts = 0;
+            for (size_t i=0; i<n; ++i)
+            {
+                Component *pComponent = mHopsanCore.createComponent("SignalGain");
+                numPorts += double(pComponent->getPortNames().size());
+                mHopsanCore.removeComponent(pComponent);
+            }
+            return numPorts;
+        }, mSink);
+        report(stats);
+    }
+
+    void TurbulentFlowFunction_GetFlow()
+    {
+        TurbulentFlowFunction qTurb;
+        qTurb.setFlowCoefficient(1e-6);
+
+        // Alternate the flow direction, both branches of getFlow are taken
+        const size_t numPressures = 256;
+        std::vector<double> pressures(numPressures);
+        for (size_t i=0; i<numPressures; ++i)
+        {
+            pressures[i] = 1e5 + 1e7*double((i*97) % numPressures)/double(numPressures);
+        }
+        const BenchmarkStatistics stats = measure([&](const size_t n) {
+            double sum = 0;
+            for (size_t i=0; i<n; ++i)
+            {
+                sum += qTurb.getFlow(pressures[i % numPressures], pressures[(i+1) % numPressures], 1e9, 2e9);
+            }
+            return sum;
+        }, mSink);
+        report(stats);
+    }
+
+    void System_Clone()
+    {
+        QFETCH(int, numCopies);
+        QFETCH(bool, clone);
+
+        ComponentSystem *pOriginal = loadTestModel();
+        QVERIFY2(pOriginal, "Could not load system from " TEST_DATA_ROOT "unittestmodel.hmf");
+
+        // One operation creates all copies and then removes them, so that the copies exist at the same time
+        std::vector<ComponentSystem*> copies(size_t(numCopies), nullptr);
+        size_t numFailed = 0;
+        const BenchmarkStatistics stats = measure([&](const size_t n) {
+            for (size_t i=0; i<n; ++i)
+            {
+                for (ComponentSystem *&rpCopy : copies)
+                {
+                    rpCopy = clone ? mHopsanCore.cloneComponentSystem(pOriginal) : loadTestModel();
+                }
+                for (ComponentSystem *pCopy : copies)
+                {
+                    if (pCopy)
+                    {
+                        mHopsanCore.removeComponent(pCopy);
+                    }
+                    else
+                    {
+                        ++numFailed;
+                    }
+                }
+            }
+            return double(n);
+        }, mSink);
+        report(stats);
+        QVERIFY2(numFailed == 0, "Could not copy the system");
+
+        mHopsanCore.removeComponent(pOriginal);
+    }
+
+    void System_Clone_data()
+    {
+        QTest::addColumn<int>("numCopies");
+        QTest::addColumn<bool>("clone");
+        QTest::newRow("reload_16") << 16 << false;
+        QTest::newRow("clone_16") << 16 << true;
+        QTest::newRow("reload_64") << 64 << false;
+        QTest::newRow("clone_64") << 64 << true;
+    }
+
+    void System_Reinitialize()
+    {
+        QFETCH(bool, warm);
+
+        // A chain of 333 orifice and volume pairs and 333 signal gains, about 1000 components in total
+        // The chain is connected to a pressure source in one end and through an orifice to a tank in the other end
+        const size_t nSegments = 333;
+        ComponentSystem *pSystem = mHopsanCore.createComponentSystem();
+        pSystem->setDesiredTimestep(0.0001);
+        pSystem->setOrAddSystemParameter("Kc", "1e-11", "double");
+        Component *pSource = mHopsanCore.createComponent("HydraulicPressureSourceC");
+        Component *pSine = mHopsanCore.createComponent("SignalSineWave");
+        Component *pLastOrifice = mHopsanCore.createComponent("HydraulicLaminarOrifice");
+        Component *pTank = mHopsanCore.createComponent("HydraulicTankC");
+        pSystem->addComponent(pSource);
+        pSystem->addComponent(pSine);
+        pSystem->addComponent(pLastOrifice);
+        pSystem->addComponent(pTank);
+        Port *pPreviousHydraulic = pSource->getPort("P1");
+        Port *pPreviousSignal = pSine->getPort("out");
+        for (size_t i=0; i<nSegments; ++i)
+        {
+            Component *pOrifice = mHopsanCore.createComponent("HydraulicLaminarOrifice");
+            Component *pVolume = mHopsanCore.createComponent("HydraulicVolume");
+            Component *pGain = mHopsanCore.createComponent("SignalGain");
+            pSystem->addComponent(pOrifice);
+            pSystem->addComponent(pVolume);
+            pSystem->addComponent(pGain);
+            QVERIFY(pOrifice->setParameterValue("Kc#Value", "Kc"));
+            QVERIFY(pSystem->connect(pPreviousHydraulic, pOrifice->getPort("P1")));
+            QVERIFY(pSystem->connect(pOrifice->getPort("P2"), pVolume->getPort("P1")));
+            QVERIFY(pSystem->connect(pPreviousSignal, pGain->getPort("in")));
+            pPreviousHydraulic = pVolume->getPort("P2");
+            pPreviousSignal = pGain->getPort("out");
+        }
+        // Sweep the volume of the last segment
+        ParameterHandle handle = pSystem->getParameterHandle(pPreviousHydraulic->getComponentName(), "V");
+        QVERIFY(pSystem->connect(pPreviousHydraulic, pLastOrifice->getPort("P1")));
+        QVERIFY(pSystem->connect(pLastOrifice->getPort("P2"), pTank->getPort("P1")));
+        pSystem->setNumLogSamples(1024);
+
+        QVERIFY(handle.isValid());
+        QVERIFY(pSystem->checkModelBeforeSimulation());
+        QVERIFY(pSystem->initialize(0, 0.01));
+        pSystem->finalize();
+
+        // One operation is one point in a parameter sweep, the volume is changed before each simulation
+        size_t numFailed = 0;
+        const BenchmarkStatistics stats = measure([&](const size_t n) {
+            for (size_t i=0; i<n; ++i)
+            {
+                pSystem->setParameterValue(handle, 0.001*double(1+i%10));
+                const bool ok = warm ? pSystem->reinitialize(0, 0.01) : (pSystem->checkModelBeforeSimulation() && pSystem->initialize(0, 0.01));
+                numFailed += ok ? 0 : 1;
+                pSystem->simulate(0.01);
+                pSystem->finalize();
+            }
+            return double(n);
+        }, mSink);
+        report(stats);
+        QVERIFY2(numFailed == 0, "Could not initialize the system");
+
+        mHopsanCore.removeComponent(pSystem);
+    }
+
+    void System_Reinitialize_data()
+    {
+        QTest::addColumn<bool>("warm");
+        QTest::newRow("initialize") << false;
+        QTest::newRow("reinitialize") << true;
+    }
+
+    void System_Fork()
+    {
+        QFETCH(int, numForks);
+
+        ComponentSystem *pSystem = loadTestModel();
+        QVERIFY2(pSystem, "Could not load system from " TEST_DATA_ROOT "unittestmodel.hmf");
+        QVERIFY(pSystem->checkModelBeforeSimulation());
+        QVERIFY(pSystem->initialize(0, 10.0));
+        pSystem->simulate(5.0);
+
+        // One operation forks the paused simulation into all branches and then removes them
+        size_t numFailed = 0;
+        const BenchmarkStatistics stats = measure([&](const size_t n) {
+            for (size_t i=0; i<n; ++i)
+            {
+                std::vector<ComponentSystem*> forks = pSystem->fork(size_t(numForks));
+                numFailed += (forks.size() == size_t(numForks)) ? 0 : 1;
+                for (ComponentSystem *pFork : forks)
+                {
+                    mHopsanCore.removeComponent(pFork);
+                }
+            }
+            return double(n);
+        }, mSink);
+        report(stats);
+        QVERIFY2(numFailed == 0, "Could not fork the simulation");
+
+        pSystem->finalize();
+        mHopsanCore.removeComponent(pSystem);
+    }
+
+    void System_Fork_data()
+    {
+        QTest::addColumn<int>("numForks");
+        QTest::newRow("16") << 16;
+        QTest::newRow("64") << 64;
+    }
+
+    void System_Load_BinaryModelFile()
+    {
+        QFETCH(bool, binary);
+
+        ComponentSystem *pSystem = loadTestModel();
+        QVERIFY2(pSystem, "Could not load system from " TEST_DATA_ROOT "unittestmodel.hmf");
+        const QString hmfbFileName = QDir::temp().filePath("hopsan_microbenchmark_binarymodel.hmfb");
+        QVERIFY(saveBinaryModelFile(hmfbFileName.toStdString().c_str(), pSystem, TEST_DATA_ROOT "unittestmodel.hmf", 0, 10));
+        mHopsanCore.removeComponent(pSystem);
+
+        // One operation loads the model and removes it again
+        const std::string fileName = binary ? hmfbFileName.toStdString() : std::string(TEST_DATA_ROOT "unittestmodel.hmf");
+        size_t numFailed = 0;
+        const BenchmarkStatistics stats = measure([&](const size_t n) {
+            for (size_t i=0; i<n; ++i)
+            {
+                double startT, stopT;
+                ComponentSystem *pLoaded = mHopsanCore.loadHMFModelFile(fileName.c_str(), startT, stopT);
+                if (pLoaded)
+                {
+                    mHopsanCore.removeComponent(pLoaded);
+                }
+                else
+                {
+                    ++numFailed;
+                }
+            }
+            return double(n);
+        }, mSink);
+        report(stats);
+        QFile::remove(hmfbFileName);
+        QVERIFY2(numFailed == 0, "Could not load the model file");
+    }
+
+    void System_Load_BinaryModelFile_data()
+    {
+        QTest::addColumn<bool>("binary");
+        QTest::newRow("hmf") << false;
+        QTest::newRow("hmfb") << true;
+    }
+
+    void System_Simulate_FlattenedHierarchy()
+    {
+        QFETCH(bool, flatten);
+
+        ComponentSystem *pSystem = createNestedSystem(50);
+        QVERIFY2(pSystem, "Could not create nested system");
+        pSystem->setUseHierarchyFlattening(flatten);
+
+        // One operation is a complete simulation, including initialization where the hierarchy is flattened
+        size_t numFailed = 0;
+        const BenchmarkStatistics stats = measure([&](const size_t n) {
+            for (size_t i=0; i<n; ++i)
+            {
+                numFailed += pSystem->initialize(0, 10.0) ? 0 : 1;
+                pSystem->simulate(10.0);
+                pSystem->finalize();
+            }
+            return double(n);
+        }, mSink);
+        report(stats);
+        QVERIFY2(numFailed == 0, "Could not initialize the system");
+
+        mHopsanCore.removeComponent(pSystem);
+    }
+
+    void System_Simulate_FlattenedHierarchy_data()
+    {
+        QTest::addColumn<bool>("flatten");
+        QTest::newRow("hierarchical") << false;
+        QTest::newRow("flattened") << true;
+    }
+};
+
+QTEST_APPLESS_MAIN(MicroBenchmarks)
+
+#include "tst_microbenchmarks.moc"
@@ -28,9 +28,23 @@
 #include "HopsanCoreVersion.h"
 #include "CoreUtilities/HopsanCoreMessageHandler.h"
 #include "CoreUtilities/HmfLoader.h"
+#include "CoreUtilities/LogStreaming.h"
+#include "CoreUtilities/MultiThreadingUtilities.h"
+#include "CoreUtilities/EnsembleSimulation.h"
+#include "CoreUtilities/SaveRestoreSimulationPoint.h"
+#include "CoreUtilities/BinaryModelFile.h"
+#include "CoreUtilities/CompiledModel.h"
+#include "CoreUtilities/SimulationProfiler.h"
+#include "CoreUtilities/HardwareCounters.h"
+#include "CoreUtilities/RealtimeExecutor.h"
+#include "ComponentUtilities/Delay.hpp"
+#include "ComponentUtilities/FirstOrderTransferFunction.h"
+#include "ComponentUtilities/num2string.hpp"
 
 #include <assert.h>
 #include <algorithm>
+#include <thread>
+#include <limits>
 
 #ifndef DEFAULT_LIBRARY_ROOT
 #define DEFAULT_LIBRARY_ROOT "../componentLibraries/defaultLibrary"
@@ -55,6 +69,76 @@ Q_DECLARE_METATYPE(Component*)
 Q_DECLARE_METATYPE(Port*)
 Q_DECLARE_METATYPE(Node*)
 
+//! @brief Log sink that keeps all streamed samples in memory, used to test log streaming
+class MemoryLogSink : public LogSink
+{
+public:
+    MemoryLogSink() : mIsClosed(false) {}
+    bool open(const std::vector<LogStreamVariable> &rVariables) {
+        mVariables = rVariables;
+        mSamples.clear();
+        mIsClosed = false;
+        return true;
+    }
+    bool write(const double *pSamples, const size_t nSamples) {
+        mSamples.insert(mSamples.end(), pSamples, pSamples+nSamples*mVariables.size());
+        return true;
+    }
+    void close() {
+        mIsClosed = true;
+    }
+
+    std::vector<LogStreamVariable> mVariables;
+    std::vector<double> mSamples;
+    bool mIsClosed;
+};
+
+//! @brief Compiled model that simulates the schedule of an initialized system through the Component interface, used to test compiled models
+class InterfaceCompiledModel : public CompiledModel
+{
+public:
+    InterfaceCompiledModel(ComponentSystem *pSystem) : mNumSteps(0) {
+        std::vector<Component*> schedule[3];
+        pSystem->getSimulationSchedule(schedule[0], schedule[1], schedule[2]);
+        for (size_t v=0; v<3; ++v) {
+            for (const Component *pComponent : schedule[v]) {
+                mPaths[v].push_back(getCompiledModelComponentPath(pComponent));
+                mTypeNames[v].push_back(pComponent->getTypeName());
+            }
+        }
+    }
+    const char *getModelName() const {
+        return "InterfaceCompiledModel";
+    }
+    bool bind(const std::vector<Component*> &rSignalComponents, const std::vector<Component*> &rCComponents,
+              const std::vector<Component*> &rQComponents) {
+        const std::vector<Component*> *pVectors[3] = {&rSignalComponents, &rCComponents, &rQComponents};
+        mComponents.clear();
+        for (size_t v=0; v<3; ++v) {
+            if (pVectors[v]->size() != mPaths[v].size()) {
+                return false;
+            }
+            for (size_t i=0; i<mPaths[v].size(); ++i) {
+                if (!isCompiledModelComponent(pVectors[v]->at(i), mPaths[v][i].c_str(), mTypeNames[v][i].c_str())) {
+                    return false;
+                }
+                mComponents.push_back(pVectors[v]->at(i));
+            }
+        }
+        return true;
+    }
+    void simulateOneTimestep(const double time) {
+        for (Component *pComponent : mComponents) {
+            pComponent->simulate(time);
+        }
+        ++mNumSteps;
+    }
+
+    std::vector<HString> mPaths[3];
+    std::vector<HString> mTypeNames[3];
+    std::vector<Component*> mComponents;
+    size_t mNumSteps;
+};
 
 class SimulationTests : public QObject
 {
@@ -102,6 +186,208 @@ private:
         *ppPort = pPort;
     }
 
+    std::vector< std::vector<double> > getLogDataColumns(const Port* pPort) {
+        std::vector< std::vector<double> > columns(pPort->getNumDataVariables());
+        for (size_t i=0; i<columns.size(); ++i) {
+            const LogDataColumnView column = pPort->getLogDataColumn(i);
+            columns[i].resize(column.size());
+            column.copyTo(columns[i].data(), column.size());
+        }
+        return columns;
+    }
+
+    bool isSameSystem(ComponentSystem* pSystem, ComponentSystem* pOther, const bool compareLogData) {
+        if (pSystem->getName() != pOther->getName() || pSystem->getTypeName() != pOther->getTypeName() ||
+            pSystem->getSubComponentNames() != pOther->getSubComponentNames() ||
+            pSystem->getAliasHandler().getAliases() != pOther->getAliasHandler().getAliases()) {
+            return false;
+        }
+        std::vector<Component*> components = pSystem->getSubComponents();
+        components.push_back(pSystem);
+        for (Component* pComponent : components) {
+            Component* pOtherComponent = (pComponent == pSystem) ? pOther : pOther->getSubComponent(pComponent->getName());
+            if (!pOtherComponent || pComponent->getTypeName() != pOtherComponent->getTypeName()) {
+                return false;
+            }
+            if (pComponent != pSystem && pComponent->isComponentSystem()) {
+                if (!isSameSystem(static_cast<ComponentSystem*>(pComponent), static_cast<ComponentSystem*>(pOtherComponent), compareLogData)) {
+                    return false;
+                }
+                continue;
+            }
+            const std::vector<ParameterEvaluator*>* pParameters = pComponent->getParametersVectorPtr();
+            const std::vector<ParameterEvaluator*>* pOtherParameters = pOtherComponent->getParametersVectorPtr();
+            if (pParameters->size() != pOtherParameters->size()) {
+                return false;
+            }
+            for (size_t i=0; i<pParameters->size(); ++i) {
+                if (pParameters->at(i)->getName() != pOtherParameters->at(i)->getName() ||
+                    pParameters->at(i)->getValue() != pOtherParameters->at(i)->getValue()) {
+                    return false;
+                }
+            }
+            for (Port* pPort : pComponent->getPortPtrVector()) {
+                Port* pOtherPort = pOtherComponent->getPort(pPort->getName());
+                if (!pOtherPort || pPort->getNumConnectedPorts() != pOtherPort->getNumConnectedPorts()) {
+                    return false;
+                }
+                if (compareLogData && pComponent != pSystem && !pPort->isMultiPort() &&
+                    getLogDataColumns(pPort) != getLogDataColumns(pOtherPort)) {
+                    return false;
+                }
+            }
+        }
+        return true;
+    }
+
+    //! @brief Creates a system where the results depend on internal component states
+    //! @details Noise -> filter -> pressure source -> orifice -> TLM line -> orifice -> tank
+    //! The results depend on the state of the noise generator, the filter and the delays in the TLM line
+    ComponentSystem* createNoiseLineSystem() {
+        ComponentSystem *pSystem = mHopsanCore.createComponentSystem();
+        pSystem->setName("NoiseLineSystem");
+        pSystem->setDesiredTimestep(0.001);
+        Component *pNoise = mHopsanCore.createComponent("SignalNoiseGenerator");
+        Component *pFilter = mHopsanCore.createComponent("SignalFirstOrderTransferFunction");
+        Component *pSource = mHopsanCore.createComponent("HydraulicPressureSourceC");
+        Component *pOrifice1 = mHopsanCore.createComponent("HydraulicLaminarOrifice");
+        Component *pLine = mHopsanCore.createComponent("HydraulicTLMlossless");
+        Component *pOrifice2 = mHopsanCore.createComponent("HydraulicLaminarOrifice");
+        Component *pTank = mHopsanCore.createComponent("HydraulicTankC");
+        pOrifice1->setName("Orifice1");
+        pOrifice2->setName("Orifice2");
+        Component *components[] = {pNoise, pFilter, pSource, pOrifice1, pLine, pOrifice2, pTank};
+        for (Component *pComponent : components) {
+            pSystem->addComponent(pComponent);
+        }
+        if (!pSystem->connect(pNoise->getPort("out"), pFilter->getPort("in")) ||
+            !pSystem->connect(pFilter->getPort("out"), pSource->getPort("p")) ||
+            !pSystem->connect(pSource->getPort("P1"), pOrifice1->getPort("P1")) ||
+            !pSystem->connect(pOrifice1->getPort("P2"), pLine->getPort("P1")) ||
+            !pSystem->connect(pLine->getPort("P2"), pOrifice2->getPort("P1")) ||
+            !pSystem->connect(pOrifice2->getPort("P2"), pTank->getPort("P1")) ||
+            !pNoise->setParameterValue("std_dev#Value", "1e6") ||
+            !pFilter->setParameterValue("b_1", "0.01") ||
+            !pLine->setParameterValue("deltat", "0.01")) {
+            mHopsanCore.removeComponent(pSystem);
+            return nullptr;
+        }
+        pSystem->setNumLogSamples(101);
+        return pSystem;
+    }
+
+    //! @brief Creates a system with a constant connected to a chain of gains
+    //! @details The components are added in the reverse signal flow order, so that they must be sorted before simulation
+    ComponentSystem* createSignalChainSystem(const size_t numGains) {
+        ComponentSystem *pSystem = mHopsanCore.createComponentSystem();
+        pSystem->setName("SignalChainSystem");
+        pSystem->setDesiredTimestep(0.001);
+        pSystem->setNumLogSamples(10);
+        std::vector<Component*> gains(numGains);
+        for (size_t i=numGains; i>0; --i) {
+            gains[i-1] = mHopsanCore.createComponent("SignalGain");
+            gains[i-1]->setName(HString("Gain")+to_hstring(i-1));
+            pSystem->addComponent(gains[i-1]);
+        }
+        Component *pConstant = mHopsanCore.createComponent("SignalConstant");
+        pSystem->addComponent(pConstant);
+        Port *pPrevious = pConstant->getPort("y");
+        for (Component *pGain : gains) {
+            if (!pSystem->connect(pPrevious, pGain->getPort("in"))) {
+                mHopsanCore.removeComponent(pSystem);
+                return nullptr;
+            }
+            pPrevious = pGain->getPort("out");
+        }
+        return pSystem;
+    }
+
+    //! @brief Creates a system where a signal chain and a hydraulic line are split over nested subsystems
+    //! @details Sine wave -> one gain per signal subsystem level -> pressure source -> orifice and volumes around the next level in each hydraulic
+    //! subsystem level -> orifice -> tank. No signal passes the border of a hydraulic subsystem.
+    ComponentSystem* createNestedSystem(const size_t numLevels) {
+        ComponentSystem *pSystem = mHopsanCore.createComponentSystem();
+        pSystem->setName("NestedSystem");
+        pSystem->setDesiredTimestep(0.001);
+        pSystem->setNumLogSamples(101);
+        Component *pSine = mHopsanCore.createComponent("SignalSineWave");
+        Component *pSource = mHopsanCore.createComponent("HydraulicPressureSourceC");
+        Component *pTank = mHopsanCore.createComponent("HydraulicTankC");
+        pSystem->addComponent(pSine);
+        pSystem->addComponent(pSource);
+        pSystem->addComponent(pTank);
+        bool ok = pSine->setParameterValue("y_A#Value", "1e6");
+
+        // Each signal level gets the signal from its parent, passes it through a gain and returns it to its parent
+        ComponentSystem *pParent = pSystem;
+        Port *pFrom = pSine->getPort("out");
+        Port *pTo = pSource->getPort("p");
+        for (size_t i=0; i<numLevels; ++i) {
+            ComponentSystem *pLevel = mHopsanCore.createComponentSystem();
+            pLevel->setName(HString("SignalLevel")+to_hstring(i));
+            pParent->addComponent(pLevel);
+            Port *pIn = pLevel->addSystemPort("in");
+            Port *pOut = pLevel->addSystemPort("out");
+            Component *pGain = mHopsanCore.createComponent("SignalGain");
+            pLevel->addComponent(pGain);
+            ok = ok && pParent->connect(pFrom, pIn) && pParent->connect(pOut, pTo) && pLevel->connect(pIn, pGain->getPort("in"));
+            pParent = pLevel;
+            pFrom = pGain->getPort("out");
+            pTo = pOut;
+        }
+        ok = ok && pParent->connect(pFrom, pTo);
+
+        // Each hydraulic level has an orifice at each border, with a volume between each orifice and the next level
+        pParent = pSystem;
+        pFrom = pSource->getPort("P1");
+        pTo = pTank->getPort("P1");
+        for (size_t i=0; i<numLevels; ++i) {
+            ComponentSystem *pLevel = mHopsanCore.createComponentSystem();
+            pLevel->setName(HString("HydraulicLevel")+to_hstring(i));
+            pParent->addComponent(pLevel);
+            Port *pP1 = pLevel->addSystemPort("P1");
+            Port *pP2 = pLevel->addSystemPort("P2");
+            Component *pOrifice1 = mHopsanCore.createComponent("HydraulicLaminarOrifice");
+            Component *pVolume1 = mHopsanCore.createComponent("HydraulicVolume");
+            Component *pVolume2 = mHopsanCore.createComponent("HydraulicVolume");
+            Component *pOrifice2 = mHopsanCore.createComponent("HydraulicLaminarOrifice");
+            pOrifice1->setName("Orifice1");
+            pVolume1->setName("Volume1");
+            pVolume2->setName("Volume2");
+            pOrifice2->setName("Orifice2");
+            Component *components[] = {pOrifice1, pVolume1, pVolume2, pOrifice2};
+            for (Component *pComponent : components) {
+                pLevel->addComponent(pComponent);
+            }
+            ok = ok && pParent->connect(pFrom, pP1) && pParent->connect(pP2, pTo) &&
+                 pLevel->connect(pP1, pOrifice1->getPort("P1")) && pLevel->connect(pOrifice1->getPort("P2"), pVolume1->getPort("P1")) &&
+                 pLevel->connect(pVolume2->getPort("P2"), pOrifice2->getPort("P1")) && pLevel->connect(pOrifice2->getPort("P2"), pP2);
+            pParent = pLevel;
+            pFrom = pVolume1->getPort("P2");
+            pTo = pVolume2->getPort("P1");
+        }
+        Component *pOrifice = mHopsanCore.createComponent("HydraulicLaminarOrifice");
+        pParent->addComponent(pOrifice);
+        ok = ok && pParent->connect(pFrom, pOrifice->getPort("P1")) && pParent->connect(pOrifice->getPort("P2"), pTo);
+
+        if (!ok) {
+            mHopsanCore.removeComponent(pSystem);
+            return nullptr;
+        }
+        return pSystem;
+    }
+
+    bool hasSameNodeData(ComponentSystem* pSystem, ComponentSystem* pOther) {
+        for (Component* pComponent : pSystem->getSubComponents()) {
+            for (Port* pPort : pComponent->getPortPtrVector()) {
+                if (pPort->getNodeDataVector() != pOther->getSubComponent(pComponent->getName())->getPort(pPort->getName())->getNodeDataVector()) {
+                    return false;
+                }
+            }
+        }
+        return true;
+    }
+
 
     HopsanEssentials mHopsanCore;
 
@@ -955,6 +1241,108 @@ private slots:
         QTest::newRow("13") << evalSystem << script << expectEvalOK << expectedValue;
     }
 
+    void System_ParameterHandle()
+    {
+        Component* pStep = mpSystemFromFile->getSubComponent("TestStep");
+        Component* pVolume = mpSystemFromFile->getSubComponent("TestVolume");
+        HString value;
+
+        // System parameter, used by name in TestStep
+        ParameterHandle apaHandle = mpSystemFromFile->getParameterHandle("", "apa");
+        QVERIFY2(apaHandle.isValid(), "Could not get handle for system parameter apa");
+        QVERIFY(mpSystemFromFile->setParameterValue(apaHandle, 3.5));
+        mpSystemFromFile->getParameterValue("apa", value);
+        QVERIFY2(value == "3.5", "Parameter value text was not updated when set by handle");
+        QVERIFY(pStep->evaluateParameter("t_step#Value", value, "double"));
+        QVERIFY2(value == "3.5", "Parameter depending on system parameter set by handle was not re-evaluated");
+
+        // Component parameter with a bound data variable, used in an expression in the same component
+        ParameterHandle volumeHandle = mpSystemFromFile->getParameterHandle("TestVolume", "V");
+        QVERIFY2(volumeHandle.isValid(), "Could not get handle for TestVolume.V");
+        QVERIFY(mpSystemFromFile->setParameterValue(volumeHandle, 0.002));
+        QVERIFY2(*static_cast<double*>(pVolume->getParameterDataPtr("V")) == 0.002, "Data variable was not set by handle");
+        QVERIFY(mpSystemFromFile->initialize(0, 1.0));
+        mpSystemFromFile->finalize();
+        QVERIFY(pVolume->evaluateParameter("alpha#Value", value, "double"));
+        bool isOK;
+        QVERIFY2(fabs(value.toDouble(&isOK)-0.2) < 1e-12, "Expression depending on parameter set by handle was not re-evaluated");
+
+        // Setting the value as text must override the numeric value
+        QVERIFY(mpSystemFromFile->setParameterValue("apa", "7"));
+        QVERIFY(pStep->evaluateParameter("t_step#Value", value, "double"));
+        QVERIFY(value == "7");
+
+        // Invalid handles and non-numeric parameters
+        QVERIFY(!mpSystemFromFile->getParameterHandle("NoSuchComponent", "V").isValid());
+        QVERIFY(!mpSystemFromFile->getParameterHandle("TestVolume", "NoSuchParameter").isValid());
+        QVERIFY(!mpSystemFromFile->setParameterValue(ParameterHandle(), 1.0));
+        ParameterHandle stringHandle = mpSystemFromFile->getParameterHandle("", "main_string_a");
+        QVERIFY(stringHandle.isValid());
+        QVERIFY(!mpSystemFromFile->setParameterValue(stringHandle, 1.0));
+
+        // Handles are invalidated when parameters, ports or components are removed, since the parameter may have been deleted
+        ComponentSystem *pSystem = mHopsanCore.createComponentSystem();
+        Component *pNewVolume = mHopsanCore.createComponent("HydraulicVolume");
+        pSystem->addComponent(pNewVolume);
+        pSystem->addSystemPort("in");
+        ParameterHandle betaHandle = pSystem->getParameterHandle(pNewVolume->getName(), "Beta_e");
+        QVERIFY(betaHandle.isValid());
+        pNewVolume->unRegisterParameter("P_high");
+        QVERIFY2(!betaHandle.isValid(), "Parameter handle was not invalidated when a parameter was removed");
+        QVERIFY(!pSystem->setParameterValue(betaHandle, 2e9));
+        betaHandle = pSystem->getParameterHandle(pNewVolume->getName(), "Beta_e");
+        QVERIFY(pSystem->setParameterValue(betaHandle, 2e9));
+        pSystem->deleteSystemPort("in");
+        QVERIFY2(!betaHandle.isValid(), "Parameter handle was not invalidated when a port was removed");
+        betaHandle = pSystem->getParameterHandle(pNewVolume->getName(), "Beta_e");
+        QVERIFY(betaHandle.isValid());
+        pSystem->removeSubComponent(pNewVolume, true);
+        QVERIFY2(!betaHandle.isValid(), "Parameter handle was not invalidated when the component was removed");
+        mHopsanCore.removeComponent(pSystem);
+    }
+
+    void System_Reinitialize()
+    {
+        double startT, stopT;
+        ComponentSystem* pReloaded = mHopsanCore.loadHMFModelFile(TEST_DATA_ROOT "unittestmodel.hmf", startT, stopT);
+        QVERIFY(pReloaded);
+
+        // The first reinitialize must do a full initialization
+        QVERIFY(mpSystemFromFile->reinitialize(0, 10.0));
+        mpSystemFromFile->simulate(10.0);
+        mpSystemFromFile->finalize();
+
+        // Change a system parameter used by TestStep and a component parameter used in an expression in TestVolume
+        QVERIFY(mpSystemFromFile->setParameterValue("apa", "3"));
+        QVERIFY(mpSystemFromFile->setParameterValue(mpSystemFromFile->getParameterHandle("TestVolume", "V"), 0.002));
+        QVERIFY(mpSystemFromFile->reinitialize(0, 10.0));
+        mpSystemFromFile->simulate(10.0);
+        mpSystemFromFile->finalize();
+
+        QVERIFY(pReloaded->setParameterValue("apa", "3"));
+        QVERIFY(pReloaded->getSubComponent("TestVolume")->setParameterValue("V", "0.002"));
+        QVERIFY(pReloaded->checkModelBeforeSimulation());
+        QVERIFY(pReloaded->initialize(0, 10.0));
+        pReloaded->simulate(10.0);
+        pReloaded->finalize();
+        QVERIFY2(isSameSystem(pReloaded, mpSystemFromFile, true), "Reinitialized system gave different results than a fully initialized system!");
+
+        // After changing the connections, reinitialize must do a full initialization again
+        QVERIFY(mpSystemFromFile->disconnect("TestStep", "out", "TestGain", "in"));
+        QVERIFY(mpSystemFromFile->reinitialize(0, 10.0));
+        mpSystemFromFile->simulate(10.0);
+        mpSystemFromFile->finalize();
+
+        QVERIFY(pReloaded->disconnect("TestStep", "out", "TestGain", "in"));
+        QVERIFY(pReloaded->checkModelBeforeSimulation());
+        QVERIFY(pReloaded->initialize(0, 10.0));
+        pReloaded->simulate(10.0);
+        pReloaded->finalize();
+        QVERIFY2(isSameSystem(pReloaded, mpSystemFromFile, true), "Reinitialized system gave different results after a connection was changed!");
+
+        mHopsanCore.removeComponent(pReloaded);
+    }
+
     void System_Add_And_Remove_Component()
     {
         Component *pComp = mHopsanCore.createComponent("SignalSink");
@@ -1012,6 +1400,57 @@ private slots:
         QTest::newRow("0") << "TestStep.out" << "TestGain.in";
     }
 
+    void System_Sort_Signal_Components()
+    {
+        // With the components in reverse order, the end of the chain only gets the constant value if the components were sorted
+        const size_t numGains = 100;
+        ComponentSystem *pSystem = createSignalChainSystem(numGains);
+        QVERIFY(pSystem);
+        QVERIFY(pSystem->getSubComponent("SignalConstant")->setParameterValue("y#Value", "3"));
+        QVERIFY(pSystem->checkModelBeforeSimulation());
+        QVERIFY(pSystem->initialize(0, 0.01));
+        pSystem->simulate(0.01);
+        pSystem->finalize();
+        Port *pLastOut = pSystem->getSubComponent(HString("Gain")+to_hstring(numGains-1))->getPort("out");
+        QVERIFY2(pLastOut->getLogDataColumn(0).size() > 0 && pLastOut->getLogDataColumn(0)[0] == 3.0, "Signal components were not sorted in signal flow order!");
+
+        // Close an algebraic loop through an adder, initialization must fail and the loop must be reported
+        Component *pAdd = mHopsanCore.createComponent("SignalAdd");
+        pSystem->addComponent(pAdd);
+        QVERIFY(pSystem->disconnect("SignalConstant", "y", "Gain0", "in"));
+        QVERIFY(pSystem->connect("SignalConstant", "y", "SignalAdd", "in1"));
+        QVERIFY(pSystem->connect("SignalAdd", "out", "Gain0", "in"));
+        QVERIFY(pSystem->connect("Gain2", "out", "SignalAdd", "in2"));
+        while (mHopsanCore.checkMessage() > 0) {
+            HString message, type, tag;
+            mHopsanCore.getMessage(message, type, tag);
+        }
+        QVERIFY(pSystem->checkModelBeforeSimulation());
+        QVERIFY2(!pSystem->initialize(0, 0.01), "Initialization succeeded with an algebraic loop!");
+        bool loopReported = false;
+        while (mHopsanCore.checkMessage() > 0) {
+            HString message, type, tag;
+            mHopsanCore.getMessage(message, type, tag);
+            loopReported = loopReported || message.containes("Algebraic loop: Gain0 -> Gain1 -> Gain2 -> SignalAdd -> Gain0");
+        }
+        QVERIFY2(loopReported, "The algebraic loop was not reported!");
+        pSystem->finalize();
+        mHopsanCore.removeComponent(pSystem);
+    }
+
+    void System_Sort_Signal_Components_Benchmark()
+    {
+        ComponentSystem *pSystem = createSignalChainSystem(10000);
+        QVERIFY(pSystem);
+        QVERIFY(pSystem->checkModelBeforeSimulation());
+        QBENCHMARK
+        {
+            pSystem->initialize(0, 0.01);
+            pSystem->finalize();
+        }
+        mHopsanCore.removeComponent(pSystem);
+    }
+
     void System_Get_Set_Timestep()
     {
         QFETCH(double, timestep);
@@ -1078,18 +1517,1027 @@ private slots:
         QVERIFY2(mpSystemFromFile->getLogTimeVector()->size() == 2048, "Failed to simulate system!");
         QVERIFY2(mpSystemFromFile->getNumActuallyLoggedSamples() == 2048, "Failed to simulate system!");
 
-        std::vector<double> multiResults1 = mpSystemFromFile->getSubComponent("TestStep")->getPort("out")->getLogDataVectorPtr()->at(0);
-        std::vector<double> multiResults2 = mpSystemFromFile->getSubComponent("TestStep")->getPort("out")->getLogDataVectorPtr()->at(511);
-        std::vector<double> multiResults3 = mpSystemFromFile->getSubComponent("TestStep")->getPort("out")->getLogDataVectorPtr()->at(1023);
+        LogDataColumnView column = mpSystemFromFile->getSubComponent("TestStep")->getPort("out")->getLogDataColumn(0);
+        QVERIFY2(column.size() == 2048, "Failed to log step output!");
+        double multiResults1 = column[0];
+        double multiResults2 = column[511];
+        double multiResults3 = column[1023];
         mpSystemFromFile->simulate(10.0);
-        std::vector<double> singleResults1 = mpSystemFromFile->getSubComponent("TestStep")->getPort("out")->getLogDataVectorPtr()->at(0);
-        std::vector<double> singleResults2 = mpSystemFromFile->getSubComponent("TestStep")->getPort("out")->getLogDataVectorPtr()->at(511);
-        std::vector<double> singleResults3 = mpSystemFromFile->getSubComponent("TestStep")->getPort("out")->getLogDataVectorPtr()->at(1023);
+        column = mpSystemFromFile->getSubComponent("TestStep")->getPort("out")->getLogDataColumn(0);
+        double singleResults1 = column[0];
+        double singleResults2 = column[511];
+        double singleResults3 = column[1023];
         QVERIFY2(multiResults1 == singleResults1, "Single-threaded and multi-threaded simulation gave different results!");
         QVERIFY2(multiResults2 == singleResults2, "Single-threaded and multi-threaded simulation gave different results!");
         QVERIFY2(multiResults3 == singleResults3, "Single-threaded and multi-threaded simulation gave different results!");
     }
 
+    void System_Simulate_Multicore_BarrierPolicy()
+    {
+        QFETCH(int, policy);
+        QFETCH(int, algorithm);
+        Port* pStepOut = mpSystemFromFile->getSubComponent("TestStep")->getPort("out");
+
+        QVERIFY(mpSystemFromFile->initialize(0, 10.0));
+        mpSystemFromFile->simulate(10.0);
+        mpSystemFromFile->finalize();
+        std::vector< std::vector<double> > singleResults = getLogDataColumns(pStepOut);
+
+        QVERIFY(mpSystemFromFile->initialize(0, 10.0));
+        mpSystemFromFile->simulateMultiThreaded(0, 10.0, 0, false, ParallelAlgorithmT(algorithm), BarrierPolicyT(policy));
+        mpSystemFromFile->finalize();
+        QVERIFY2(mpSystemFromFile->getNumActuallyLoggedSamples() == 2048, "Failed to simulate system!");
+        QVERIFY2(getLogDataColumns(pStepOut) == singleResults, "Single-threaded and multi-threaded simulation gave different results!");
+    }
+
+    void System_Simulate_Multicore_BarrierPolicy_data()
+    {
+        QTest::addColumn<int>("policy");
+        QTest::addColumn<int>("algorithm");
+        QTest::newRow("0") << int(SpinBarrierPolicy) << int(OfflineSchedulingAlgorithm);
+        QTest::newRow("1") << int(SpinThenBlockBarrierPolicy) << int(OfflineSchedulingAlgorithm);
+        QTest::newRow("2") << int(BackoffBarrierPolicy) << int(OfflineSchedulingAlgorithm);
+        QTest::newRow("3") << int(SpinThenBlockBarrierPolicy) << int(TaskPoolAlgorithm);
+        QTest::newRow("4") << int(BackoffBarrierPolicy) << int(TaskStealingAlgorithm);
+        QTest::newRow("5") << int(SpinBarrierPolicy) << int(GraphPartitioningAlgorithm);
+    }
+
+    void System_Simulate_Multicore_ThreadPlacement()
+    {
+        QFETCH(int, placement);
+        Port* pStepOut = mpSystemFromFile->getSubComponent("TestStep")->getPort("out");
+        const std::vector<int> allowedCpus = getAllowedCpus();
+
+        QVERIFY(mpSystemFromFile->initialize(0, 10.0));
+        mpSystemFromFile->simulate(10.0);
+        mpSystemFromFile->finalize();
+        std::vector< std::vector<double> > singleResults = getLogDataColumns(pStepOut);
+
+        std::vector<int> cpus;
+        if (!allowedCpus.empty())
+        {
+            cpus.push_back(allowedCpus.back());
+            cpus.push_back(allowedCpus.front());
+        }
+        mpSystemFromFile->setThreadPlacement(ThreadPlacementT(placement), cpus);
+        QVERIFY(mpSystemFromFile->initialize(0, 10.0));
+        mpSystemFromFile->simulateMultiThreaded(0, 10.0, 2, false, OfflineSchedulingAlgorithm, SpinThenBlockBarrierPolicy);
+        mpSystemFromFile->finalize();
+        mpSystemFromFile->setThreadPlacement(AutomaticThreadPlacement);
+        QVERIFY2(mpSystemFromFile->getNumActuallyLoggedSamples() == 2048, "Failed to simulate system!");
+        QVERIFY2(getLogDataColumns(pStepOut) == singleResults, "Single-threaded and multi-threaded simulation gave different results!");
+        QVERIFY2(getAllowedCpus() == allowedCpus, "The affinity of the calling thread was not restored!");
+    }
+
+    void System_Simulate_Multicore_ThreadPlacement_data()
+    {
+        QTest::addColumn<int>("placement");
+        QTest::newRow("0") << int(CompactThreadPlacement);
+        QTest::newRow("1") << int(ScatterThreadPlacement);
+        QTest::newRow("2") << int(ExplicitThreadPlacement);
+        QTest::newRow("3") << int(NoThreadPlacement);
+    }
+
+    void System_Simulate_Multicore_Repeated()
+    {
+        Port* pStepOut = mpSystemFromFile->getSubComponent("TestStep")->getPort("out");
+        SimulationThreadPool *pThreadPool = mHopsanCore.getSimulationHandler()->getThreadPool();
+        QVERIFY(pThreadPool);
+
+        QVERIFY(mpSystemFromFile->initialize(0, 10.0));
+        mpSystemFromFile->simulateMultiThreaded(0, 10.0);
+        mpSystemFromFile->finalize();
+        std::vector< std::vector<double> > firstResults = getLogDataColumns(pStepOut);
+        const size_t numWorkers = pThreadPool->getNumWorkers();
+
+        // Later simulations should reuse both the worker threads and the schedule
+        for (int i=0; i<3; ++i) {
+            QVERIFY(mpSystemFromFile->initialize(0, 10.0));
+            mpSystemFromFile->simulateMultiThreaded(0, 10.0);
+            mpSystemFromFile->finalize();
+            QVERIFY2(getLogDataColumns(pStepOut) == firstResults, "Repeated multi-threaded simulation gave different results!");
+        }
+        QVERIFY2(pThreadPool->getNumWorkers() == numWorkers, "Worker threads were not reused!");
+    }
+
+    void System_Simulate_Multicore_Rebalancing()
+    {
+        QVERIFY(mpSystemFromFile->initialize(0, 10.0));
+
+        // Put all components in the first of two threads, the rebalancer should move some of them to the second thread
+        std::vector< std::vector<Component*> > splitS(2), splitC(2), splitQ(2);
+        splitC[0] = mpSystemFromFile->getSubComponents();
+        const size_t nComponents = splitC[0].size();
+        const size_t nSamples = 256;
+        LoadRebalancer rebalancer(splitS, splitC, splitQ, 1, nSamples, 1.15);
+        double time = 0;
+        for (size_t i=0; i<nSamples; ++i)
+        {
+            time += mpSystemFromFile->getTimestep();
+            QVERIFY(rebalancer.isSampleStep(i));
+            rebalancer.simulateAndMeasure(0, LoadRebalancer::CPhase, splitC[0], time);
+            rebalancer.simulateAndMeasure(1, LoadRebalancer::CPhase, splitC[1], time);
+            rebalancer.endSampleStep();
+        }
+        mpSystemFromFile->finalize();
+
+        QVERIFY2(rebalancer.getNumRebalances() == 1, "Unbalanced load was not rebalanced!");
+        QVERIFY2(rebalancer.getFirstImbalance(LoadRebalancer::CPhase) > 1.9, "Wrong imbalance measured!");
+        QVERIFY2(!splitC[1].empty(), "No components were moved!");
+        QVERIFY2(splitC[0].size()+splitC[1].size() == nComponents, "Components were lost when rebalancing!");
+        QVERIFY2(rebalancer.getNumMovedComponents() == splitC[1].size(), "Wrong number of moved components!");
+    }
+
+    void System_Simulate_Multicore_SignalLevels()
+    {
+        // A sine wave feeding 16 parallel chains of 3 signal components, so there are 4 levels where all but the first have 16 components
+        const size_t nChains = 16, chainLength = 3;
+        ComponentSystem *pSystem = mHopsanCore.createComponentSystem();
+        pSystem->setDesiredTimestep(0.001);
+        Component *pSine = mHopsanCore.createComponent("SignalSineWave");
+        pSystem->addComponent(pSine);
+        std::vector<Port*> outPorts;
+        for (size_t c=0; c<nChains; ++c)
+        {
+            Port *pPrevious = pSine->getPort("out");
+            for (size_t i=0; i<chainLength; ++i)
+            {
+                Component *pComp = mHopsanCore.createComponent((i == 1) ? "SignalFirstOrderTransferFunction" : "SignalGain");
+                pSystem->addComponent(pComp);
+                QVERIFY(pSystem->connect(pPrevious, pComp->getPort("in")));
+                pPrevious = pComp->getPort("out");
+            }
+            outPorts.push_back(pPrevious);
+        }
+        pSystem->setNumLogSamples(100);
+
+        QVERIFY(pSystem->checkModelBeforeSimulation());
+        QVERIFY(pSystem->initialize(0, 1.0));
+        pSystem->simulate(1.0);
+        pSystem->finalize();
+        std::vector< std::vector< std::vector<double> > > singleResults;
+        for (size_t c=0; c<nChains; ++c)
+        {
+            singleResults.push_back(getLogDataColumns(outPorts[c]));
+        }
+
+        // Check that the schedule keeps every component and the dependency order within each thread
+        std::vector<Component*> components = pSystem->getSubComponents();
+        std::vector< std::vector<size_t> > dependencies;
+        std::vector<Component*> sortedComponents;
+        for (size_t l=0; l<=chainLength; ++l)
+        {
+            for (size_t i=0; i<components.size(); ++i)
+            {
+                // Find the level of each component by following its input back to the sine wave
+                size_t level = 0;
+                Component *pComp = components[i];
+                while (pComp != pSine)
+                {
+                    pComp = pComp->getPort("in")->getNodePtr()->getWritePortComponentPtr();
+                    ++level;
+                }
+                if (level == l)
+                {
+                    sortedComponents.push_back(components[i]);
+                }
+            }
+        }
+        pSystem->getSignalComponentDependencies(sortedComponents, dependencies);
+        SignalComponentSchedule schedule(sortedComponents, dependencies, 4);
+        QVERIFY(schedule.isValid());
+        QVERIFY(schedule.getNumLevels() == chainLength+1);
+        QVERIFY(schedule.getMaxLevelWidth() == nChains);
+        std::vector< std::vector<Component*> > splitVector;
+        schedule.getSplitVector(splitVector);
+        QVERIFY(splitVector.size() == 4);
+        std::vector<Component*> scheduledComponents;
+        for (size_t t=0; t<splitVector.size(); ++t)
+        {
+            for (size_t i=0; i<splitVector[t].size(); ++i)
+            {
+                const size_t c = std::find(sortedComponents.begin(), sortedComponents.end(), splitVector[t][i]) - sortedComponents.begin();
+                for (size_t d=0; d<dependencies[c].size(); ++d)
+                {
+                    Component *pRequired = sortedComponents[dependencies[c][d]];
+                    const std::vector<Component*>::iterator it = std::find(splitVector[t].begin(), splitVector[t].end(), pRequired);
+                    QVERIFY2((it == splitVector[t].end()) || (it-splitVector[t].begin() < int(i)), "Signal components are not scheduled in dependency order!");
+                }
+                scheduledComponents.push_back(splitVector[t][i]);
+            }
+        }
+        std::sort(scheduledComponents.begin(), scheduledComponents.end());
+        std::sort(components.begin(), components.end());
+        QVERIFY2(scheduledComponents == components, "Signal components were lost or duplicated by the schedule!");
+
+        // Simulating with level scheduling must give the same results
+        for (int useLevels=0; useLevels<2; ++useLevels)
+        {
+            pSystem->setUseSignalLevelScheduling(useLevels == 1);
+            QVERIFY(pSystem->initialize(0, 1.0));
+            pSystem->simulateMultiThreaded(0, 1.0, 4, false, OfflineSchedulingAlgorithm, SpinThenBlockBarrierPolicy);
+            pSystem->finalize();
+            for (size_t c=0; c<nChains; ++c)
+            {
+                QVERIFY2(getLogDataColumns(outPorts[c]) == singleResults[c], "Single-threaded and multi-threaded simulation gave different results!");
+            }
+        }
+        mHopsanCore.removeComponent(pSystem);
+    }
+
+    void Work_Stealing_Deque()
+    {
+        const size_t nItems = 10000;
+        std::vector<Component*> items;
+        for (size_t i=0; i<nItems; ++i)
+        {
+            items.push_back(reinterpret_cast<Component*>(sizeof(void*)*(i+1)));
+        }
+
+        // The owner takes from the bottom and thieves from the top
+        WorkStealingDeque deque(std::vector<Component*>(items.begin(), items.begin()+3), nItems);
+        QVERIFY(deque.steal() == items[0]);
+        QVERIFY(deque.pop() == items[2]);
+        QVERIFY(deque.pop() == items[1]);
+        QVERIFY(deque.isEmpty());
+        QVERIFY(deque.pop() == 0);
+        QVERIFY(deque.steal() == 0);
+
+        // Let the owner pop while other threads steal, each item must be taken exactly once
+        WorkStealingDeque sharedDeque(items, nItems);
+        std::vector< std::vector<Component*> > taken(4);
+        std::vector<std::thread> thieves;
+        for (size_t t=1; t<taken.size(); ++t)
+        {
+            thieves.push_back(std::thread([&sharedDeque, &taken, t]()
+            {
+                while (!sharedDeque.isEmpty())
+                {
+                    Component *pComp = sharedDeque.steal();
+                    if (pComp)
+                    {
+                        taken[t].push_back(pComp);
+                    }
+                }
+            }));
+        }
+        Component *pComp = sharedDeque.pop();
+        while (pComp)
+        {
+            taken[0].push_back(pComp);
+            pComp = sharedDeque.pop();
+        }
+        for (size_t t=0; t<thieves.size(); ++t)
+        {
+            thieves[t].join();
+        }
+
+        std::vector<Component*> allTaken;
+        for (size_t t=0; t<taken.size(); ++t)
+        {
+            allTaken.insert(allTaken.end(), taken[t].begin(), taken[t].end());
+        }
+        std::sort(allTaken.begin(), allTaken.end());
+        QVERIFY2(allTaken == items, "Items were lost or taken more than once from the work-stealing deque!");
+    }
+
+    void Work_Stealing_Deque_Benchmark()
+    {
+        QFETCH(bool, lockFree);
+
+        // Measure the owner thread moving all components between its two vectors, as in one phase of a task-stealing simulation step
+        std::vector<Component*> components(1000, reinterpret_cast<Component*>(sizeof(void*)));
+        if (lockFree)
+        {
+            WorkStealingDeque *pUnFinished = new WorkStealingDeque(components, components.size());
+            WorkStealingDeque *pFinished = new WorkStealingDeque(std::vector<Component*>(), components.size());
+            QBENCHMARK
+            {
+                Component *pComp = pUnFinished->pop();
+                while (pComp)
+                {
+                    pFinished->push(pComp);
+                    pComp = pUnFinished->pop();
+                }
+                std::swap(pUnFinished, pFinished);
+            }
+            QVERIFY(pFinished->isEmpty() && !pUnFinished->isEmpty());
+            delete pUnFinished;
+            delete pFinished;
+        }
+        else
+        {
+            ThreadSafeVector *pUnFinished = new ThreadSafeVector(components, components.size());
+            ThreadSafeVector *pFinished = new ThreadSafeVector(std::vector<Component*>(), components.size());
+            QBENCHMARK
+            {
+                Component *pComp = pUnFinished->tryAndTakeFirst();
+                while (pComp)
+                {
+                    pFinished->insertFirst(pComp);
+                    pComp = pUnFinished->tryAndTakeFirst();
+                }
+                std::swap(pUnFinished, pFinished);
+            }
+            delete pUnFinished;
+            delete pFinished;
+        }
+    }
+
+    void Work_Stealing_Deque_Benchmark_data()
+    {
+        QTest::addColumn<bool>("lockFree");
+        QTest::newRow("ThreadSafeVector") << false;
+        QTest::newRow("WorkStealingDeque") << true;
+    }
+
+    void System_Simulate_Multicore_Benchmark()
+    {
+        QFETCH(int, algorithm);
+        Port* pStepOut = mpSystemFromFile->getSubComponent("TestStep")->getPort("out");
+
+        QVERIFY(mpSystemFromFile->initialize(0, 10.0));
+        mpSystemFromFile->simulate(10.0);
+        mpSystemFromFile->finalize();
+        std::vector< std::vector<double> > singleResults = getLogDataColumns(pStepOut);
+
+        QBENCHMARK
+        {
+            mpSystemFromFile->initialize(0, 10.0);
+            mpSystemFromFile->simulateMultiThreaded(0, 10.0, 0, false, ParallelAlgorithmT(algorithm), SpinThenBlockBarrierPolicy);
+            mpSystemFromFile->finalize();
+        }
+        QVERIFY2(getLogDataColumns(pStepOut) == singleResults, "Single-threaded and multi-threaded simulation gave different results!");
+    }
+
+    void System_Simulate_Multicore_Benchmark_data()
+    {
+        QTest::addColumn<int>("algorithm");
+        QTest::newRow("TaskPool") << int(TaskPoolAlgorithm);
+        QTest::newRow("TaskStealing") << int(TaskStealingAlgorithm);
+    }
+
+    void System_Simulate_NodeDataArena()
+    {
+        Port* pStepOut = mpSystemFromFile->getSubComponent("TestStep")->getPort("out");
+        Port* pVolumeP1 = mpSystemFromFile->getSubComponent("TestVolume")->getPort("P1");
+
+        QVERIFY(mpSystemFromFile->initialize(0, 10.0));
+        mpSystemFromFile->simulate(10.0);
+        mpSystemFromFile->finalize();
+        std::vector< std::vector<double> > defaultStepResults = getLogDataColumns(pStepOut);
+        std::vector< std::vector<double> > defaultVolumeResults = getLogDataColumns(pVolumeP1);
+        std::vector<double> defaultVolumeFinalValues = pVolumeP1->getNodeDataVector();
+
+        mpSystemFromFile->setUseNodeDataArena(true);
+        QVERIFY(mpSystemFromFile->usesNodeDataArena());
+        QVERIFY(mpSystemFromFile->initialize(0, 10.0));
+        mpSystemFromFile->simulate(10.0);
+        mpSystemFromFile->finalize();
+        QVERIFY2(getLogDataColumns(pStepOut) == defaultStepResults, "Simulation with node data arena gave different results!");
+        QVERIFY2(getLogDataColumns(pVolumeP1) == defaultVolumeResults, "Simulation with node data arena gave different results!");
+        // After finalize the node data vector must be up to date again
+        QVERIFY2(pVolumeP1->getNodeDataVector() == defaultVolumeFinalValues, "Node data was not moved back from the node data arena!");
+    }
+
+    void System_Simulate_FlattenedHierarchy()
+    {
+        ComponentSystem *pHierarchical = createNestedSystem(4);
+        ComponentSystem *pFlattened = createNestedSystem(4);
+        QVERIFY2(pHierarchical && pFlattened, "Could not create nested system!");
+        pFlattened->setUseHierarchyFlattening(true);
+        QVERIFY(pFlattened->usesHierarchyFlattening());
+
+        QVERIFY(pHierarchical->initialize(0, 1.0));
+        pHierarchical->simulate(1.0);
+        pHierarchical->finalize();
+        QVERIFY(pFlattened->initialize(0, 1.0));
+        pFlattened->simulate(1.0);
+        pFlattened->finalize();
+        // The results are logged in the subsystems as usual
+        QVERIFY2(isSameSystem(pHierarchical, pFlattened, true), "Simulation with flattened hierarchy gave different results!");
+
+        QVERIFY(pFlattened->initialize(0, 1.0));
+        pFlattened->simulateMultiThreaded(0, 1.0, 2);
+        pFlattened->finalize();
+        QVERIFY2(isSameSystem(pHierarchical, pFlattened, true), "Multi-threaded simulation with flattened hierarchy gave different results!");
+
+        mHopsanCore.removeComponent(pHierarchical);
+        mHopsanCore.removeComponent(pFlattened);
+    }
+
+    void System_Simulate_FlattenedHierarchy_QTypeSubsystem()
+    {
+        // A Q-type subsystem with an orifice, and a signal gain passing a signal from the top-level system back to it
+        ComponentSystem *systems[2];
+        for (ComponentSystem *&pSystem : systems) {
+            pSystem = mHopsanCore.createComponentSystem();
+            pSystem->setDesiredTimestep(0.001);
+            pSystem->setNumLogSamples(101);
+            Component *pSine = mHopsanCore.createComponent("SignalSineWave");
+            Component *pTopGain = mHopsanCore.createComponent("SignalGain");
+            Component *pSource = mHopsanCore.createComponent("HydraulicPressureSourceC");
+            Component *pTank = mHopsanCore.createComponent("HydraulicTankC");
+            ComponentSystem *pSubsystem = mHopsanCore.createComponentSystem();
+            pSubsystem->setName("Subsystem");
+            Component *pComponents[] = {pSine, pTopGain, pSource, pTank, pSubsystem};
+            for (Component *pComponent : pComponents) {
+                pSystem->addComponent(pComponent);
+            }
+            Component *pOrifice = mHopsanCore.createComponent("HydraulicLaminarOrifice");
+            Component *pGain = mHopsanCore.createComponent("SignalGain");
+            pSubsystem->addComponent(pOrifice);
+            pSubsystem->addComponent(pGain);
+            Port *pP1 = pSubsystem->addSystemPort("P1");
+            Port *pP2 = pSubsystem->addSystemPort("P2");
+            Port *pIn = pSubsystem->addSystemPort("in");
+            Port *pOut = pSubsystem->addSystemPort("out");
+            bool ok = pSine->setParameterValue("y_A#Value", "1e6") &&
+                      pSystem->connect(pSource->getPort("P1"), pP1) && pSystem->connect(pP2, pTank->getPort("P1")) &&
+                      pSystem->connect(pSine->getPort("out"), pIn) && pSystem->connect(pOut, pTopGain->getPort("in")) &&
+                      pSystem->connect(pTopGain->getPort("out"), pSource->getPort("p")) &&
+                      pSubsystem->connect(pP1, pOrifice->getPort("P1")) && pSubsystem->connect(pOrifice->getPort("P2"), pP2) &&
+                      pSubsystem->connect(pIn, pGain->getPort("in")) && pSubsystem->connect(pGain->getPort("out"), pOut);
+            QVERIFY2(ok, "Could not create system with a Q-type subsystem!");
+            QVERIFY(pSubsystem->getTypeCQS() == Component::QType);
+        }
+        ComponentSystem *pHierarchical = systems[0];
+        ComponentSystem *pFlattened = systems[1];
+        pFlattened->setUseHierarchyFlattening(true);
+
+        QVERIFY(pHierarchical->initialize(0, 1.0));
+        pHierarchical->simulate(1.0);
+        pHierarchical->finalize();
+        QVERIFY(pFlattened->initialize(0, 1.0));
+        pFlattened->simulate(1.0);
+        pFlattened->finalize();
+        // The signal passes the border of the subsystem, so it must be delayed the same way with flattening
+        QVERIFY2(isSameSystem(pHierarchical, pFlattened, true), "Simulation with flattened Q-type subsystem gave different results!");
+
+        mHopsanCore.removeComponent(pHierarchical);
+        mHopsanCore.removeComponent(pFlattened);
+    }
+
+    void System_Simulate_CompiledModel()
+    {
+        ComponentSystem *pInterpreted = createNestedSystem(4);
+        ComponentSystem *pCompiled = createNestedSystem(4);
+        QVERIFY2(pInterpreted && pCompiled, "Could not create nested system!");
+        pInterpreted->setUseHierarchyFlattening(true);
+
+        // The schedule is taken from an initialized system with flattened hierarchy, just as when a compiled model is generated
+        pCompiled->setUseHierarchyFlattening(true);
+        QVERIFY(pCompiled->initialize(0, 1.0));
+        InterfaceCompiledModel *pCompiledModel = new InterfaceCompiledModel(pCompiled);
+        InterfaceCompiledModel *pOtherCompiledModel = new InterfaceCompiledModel(pCompiled);
+        pCompiled->finalize();
+        pCompiled->setUseHierarchyFlattening(false);
+        pCompiled->setCompiledModel(pCompiledModel);
+        QVERIFY(pCompiled->getCompiledModel() == pCompiledModel);
+
+        QVERIFY(pInterpreted->initialize(0, 1.0));
+        pInterpreted->simulate(1.0);
+        pInterpreted->finalize();
+        QVERIFY(pCompiled->initialize(0, 1.0));
+        QVERIFY2(pCompiled->usesCompiledModel(), "The compiled model was not bound to the system!");
+        pCompiled->simulate(1.0);
+        pCompiled->finalize();
+        QVERIFY(!pCompiled->usesCompiledModel());
+        QVERIFY(pCompiledModel->mNumSteps == 1000);
+        QVERIFY2(isSameSystem(pInterpreted, pCompiled, true), "Simulation with compiled model gave different results!");
+
+        // A compiled model generated for another model must not be used
+        ComponentSystem *pOther = createNestedSystem(3);
+        pOther->setCompiledModel(pOtherCompiledModel);
+        QVERIFY(pOther->initialize(0, 1.0));
+        QVERIFY2(!pOther->usesCompiledModel(), "A compiled model for another model was bound to the system!");
+        pOther->simulate(1.0);
+        pOther->finalize();
+        QVERIFY(pOtherCompiledModel->mNumSteps == 0);
+
+        mHopsanCore.removeComponent(pInterpreted);
+        mHopsanCore.removeComponent(pCompiled);
+        mHopsanCore.removeComponent(pOther);
+    }
+
+    void System_Simulate_Profiler()
+    {
+        // Profile a copy, so that a failed test does not leave the profiler in the shared system
+        ComponentSystem *pSystem = mHopsanCore.cloneComponentSystem(mpSystemFromFile);
+        QVERIFY2(pSystem, "Could not clone system!");
+        Port* pVolumeP1 = pSystem->getSubComponent("TestVolume")->getPort("P1");
+        QVERIFY(pSystem->initialize(0, 10.0));
+        pSystem->simulate(10.0);
+        pSystem->finalize();
+        std::vector< std::vector<double> > defaultResults = getLogDataColumns(pVolumeP1);
+
+        SimulationProfiler profiler(10);
+        pSystem->setProfiler(&profiler);
+        QVERIFY(pSystem->initialize(0, 10.0));
+        pSystem->simulate(10.0);
+        pSystem->finalize();
+        QVERIFY2(getLogDataColumns(pVolumeP1) == defaultResults, "Profiled simulation gave different results!");
+
+        const size_t numSteps = profiler.getNumSteps();
+        QVERIFY2(numSteps > 0 && profiler.getNumThreads() == 1, "Wrong number of profiled steps or threads!");
+        const std::vector<HString> names = profiler.getComponentNamesByTotalTime();
+        QVERIFY2(names.size() == pSystem->getSubComponents().size(), "Not all components were profiled!");
+        const DurationStatistics *pVolumeStats = profiler.getComponentStatistics("TestVolume");
+        QVERIFY2(pVolumeStats && pVolumeStats->getCount() == numSteps, "Wrong number of samples for component!");
+        QVERIFY(pVolumeStats->getMin() <= pVolumeStats->getPercentile(0.5) && pVolumeStats->getPercentile(0.5) <= pVolumeStats->getMax());
+        QVERIFY(profiler.getPhaseStatistics(0, SimulationProfiler::QPhase)->getCount() == numSteps);
+        QVERIFY2(profiler.getNumTraceEvents() > 0 && profiler.getNumTraceEvents() <= 10*(names.size()+SimulationProfiler::NumPhases), "Trace events were not limited to the first steps!");
+
+        // Barrier waits are only measured in multi-threaded simulations, results are accumulated over simulations until cleared
+        profiler.clear();
+        QVERIFY(pSystem->initialize(0, 10.0));
+        pSystem->simulateMultiThreaded(0, 10.0, 2);
+        pSystem->finalize();
+        pSystem->setProfiler(0);
+        QVERIFY2(getLogDataColumns(pVolumeP1) == defaultResults, "Profiled multi-threaded simulation gave different results!");
+        const size_t nThreads = determineActualNumberOfThreads(2);
+        QVERIFY(profiler.getNumThreads() == nThreads);
+        QVERIFY(profiler.getComponentStatistics("TestVolume")->getCount() == numSteps);
+        QVERIFY2(profiler.getWaitStatistics(nThreads-1, SimulationProfiler::CPhase)->getCount() == numSteps, "Barrier waits were not profiled!");
+
+        const QString traceFileName = QDir::temp().filePath("hopsan_unittest_profile.json");
+        const QString csvFileName = QDir::temp().filePath("hopsan_unittest_profile.csv");
+        QVERIFY(profiler.writeChromeTrace(traceFileName.toStdString().c_str()));
+        QVERIFY(profiler.writeSummaryCSV(csvFileName.toStdString().c_str()));
+        QVERIFY(QFileInfo(traceFileName).size() > 0 && QFileInfo(csvFileName).size() > 0);
+        QFile::remove(traceFileName);
+        QFile::remove(csvFileName);
+        mHopsanCore.removeComponent(pSystem);
+    }
+
+    void System_Simulate_Profiler_HardwareCounters()
+    {
+        ComponentSystem *pSystem = mHopsanCore.cloneComponentSystem(mpSystemFromFile);
+        QVERIFY2(pSystem, "Could not clone system!");
+        SimulationProfiler profiler;
+        profiler.setUseHardwareCounters(true);
+        pSystem->setProfiler(&profiler);
+        QVERIFY(pSystem->initialize(0, 10.0));
+        pSystem->simulate(10.0);
+        pSystem->finalize();
+        pSystem->setProfiler(0);
+
+        // The counters may not be available on this machine, then the profiling must work as without them
+        HardwareCounters counters;
+        QVERIFY2(counters.open() || !counters.getErrorMessage().empty(), "No reason was given for unavailable hardware counters!");
+        QVERIFY(counters.isAvailable(HardwareCounters::Instructions) == profiler.isHardwareCounterAvailable(HardwareCounters::Instructions));
+        QVERIFY(profiler.isHardwareCounterAvailable(HardwareCounters::Instructions) || !profiler.getHardwareCounterError().empty());
+
+        const std::vector<HString> typeNames = profiler.getComponentTypeNamesByTotalTime();
+        QVERIFY(!typeNames.empty());
+        QVERIFY(profiler.getNumComponentsOfType("HydraulicVolume") == 1);
+        const HardwareCounterStatistics *pVolumeCounters = profiler.getComponentTypeCounters("HydraulicVolume");
+        QVERIFY2(pVolumeCounters, "Component type was not profiled!");
+        if (profiler.isHardwareCounterAvailable(HardwareCounters::Instructions))
+        {
+            QVERIFY2(pVolumeCounters->getCount() == profiler.getNumSteps(), "Wrong number of hardware counter samples!");
+            QVERIFY2(pVolumeCounters->getMean(HardwareCounters::Instructions) > 10, "Instructions were not counted!");
+        }
+        else
+        {
+            QVERIFY(pVolumeCounters->getCount() == 0);
+        }
+
+        const QString csvFileName = QDir::temp().filePath("hopsan_unittest_counters.csv");
+        QVERIFY(profiler.writeHardwareCounterCSV(csvFileName.toStdString().c_str()));
+        QFile::remove(csvFileName);
+        mHopsanCore.removeComponent(pSystem);
+    }
+
+    void System_Simulate_Realtime()
+    {
+        ComponentSystem *pSystem = mHopsanCore.cloneComponentSystem(mpSystemFromFile);
+        QVERIFY2(pSystem, "Could not clone system!");
+        Port* pVolumeP1 = pSystem->getSubComponent("TestVolume")->getPort("P1");
+        QVERIFY(pSystem->initialize(0, 10.0));
+        pSystem->simulate(10.0);
+        pSystem->finalize();
+        std::vector< std::vector<double> > defaultResults = getLogDataColumns(pVolumeP1);
+        const size_t numSteps = size_t(10.0/pSystem->getTimestep()+0.5);
+
+        // With the catch-up policy every step is simulated, so a real-time simulation to the stop time gives the same results
+        RealtimeOptions options;
+        options.realTimeFactor = 1000;
+        options.stopTime = 10.0;
+        QVERIFY(pSystem->initialize(0, 10.0));
+        QVERIFY(pSystem->startRealtimeSimulation(options));
+        for (int i=0; i<1000 && pSystem->isRealtimeSimulationRunning(); ++i)
+        {
+            QTest::qSleep(10);
+        }
+        QVERIFY2(!pSystem->isRealtimeSimulationRunning(), "Real-time simulation did not stop at the stop time!");
+        RealtimeStatistics statistics = pSystem->getRealtimeStatistics();
+        pSystem->finalize();
+        QVERIFY2(statistics.numSteps == numSteps && statistics.jitter.getCount() == numSteps && statistics.executionTime.getCount() == numSteps,
+                 "Wrong number of real-time steps!");
+        QVERIFY(statistics.overrun.getCount() == statistics.numOverruns && statistics.numSkippedPeriods == 0);
+        QVERIFY2(getLogDataColumns(pVolumeP1) == defaultResults, "Real-time simulation gave different results!");
+
+        // Without stop time it runs until it is stopped, the statistics can be read while it runs
+        options.realTimeFactor = 1;
+        options.stopTime = std::numeric_limits<double>::infinity();
+        QVERIFY(pSystem->initialize(0, 10.0));
+        QVERIFY(pSystem->startRealtimeSimulation(options));
+        QTest::qSleep(50);
+        QVERIFY(pSystem->isRealtimeSimulationRunning());
+        statistics = pSystem->getRealtimeStatistics();
+        pSystem->stopRealtimeSimulation();
+        QVERIFY(!pSystem->isRealtimeSimulationRunning() && !pSystem->wasSimulationAborted());
+        QVERIFY(pSystem->getRealtimeStatistics().numSteps >= statistics.numSteps);
+        statistics = pSystem->getRealtimeStatistics();
+        QVERIFY2(statistics.numSteps > 0 && fabs(pSystem->getTime()-double(statistics.numSteps)*pSystem->getTimestep()) < 1e-9, "Wrong time after stopped real-time simulation!");
+        pSystem->finalize();
+
+        // No step can be simulated in one ns, so the abort policy stops the simulation after the first step
+        options.realTimeFactor = 1e9;
+        options.overrunPolicy = AbortOverrunPolicy;
+        QVERIFY(pSystem->initialize(0, 10.0));
+        QVERIFY(pSystem->startRealtimeSimulation(options));
+        for (int i=0; i<1000 && pSystem->isRealtimeSimulationRunning(); ++i)
+        {
+            QTest::qSleep(10);
+        }
+        statistics = pSystem->getRealtimeStatistics();
+        pSystem->finalize();
+        QVERIFY2(pSystem->wasSimulationAborted() && statistics.numSteps == 1 && statistics.numOverruns == 1, "Real-time simulation was not aborted at the first overrun!");
+        mHopsanCore.removeComponent(pSystem);
+    }
+
+    void System_Simulate_Ensemble()
+    {
+        // Pressure source -> orifice -> volume -> orifice -> tank, with a sensor, gain and filter on the volume pressure.
+        // Five lanes in groups of two gives partial blocks for any lane width, the filter has no ensemble implementation
+        const size_t nLanes = 5;
+        std::vector<ComponentSystem*> lanes;
+        std::vector<Port*> volumePorts, filterPorts;
+        for (size_t l=0; l<nLanes; ++l)
+        {
+            ComponentSystem *pSystem = mHopsanCore.createComponentSystem();
+            pSystem->setDesiredTimestep(0.001);
+            Component *pSource = mHopsanCore.createComponent("HydraulicPressureSourceC");
+            Component *pOrifice1 = mHopsanCore.createComponent("HydraulicLaminarOrifice");
+            Component *pVolume = mHopsanCore.createComponent("HydraulicVolume");
+            Component *pOrifice2 = mHopsanCore.createComponent("HydraulicLaminarOrifice");
+            Component *pTank = mHopsanCore.createComponent("HydraulicTankC");
+            Component *pSensor = mHopsanCore.createComponent("HydraulicPressureSensor");
+            Component *pGain = mHopsanCore.createComponent("SignalGain");
+            Component *pFilter = mHopsanCore.createComponent("SignalFirstOrderTransferFunction");
+            pOrifice1->setName("Orifice1");
+            pOrifice2->setName("Orifice2");
+            Component *components[] = {pSource, pOrifice1, pVolume, pOrifice2, pTank, pSensor, pGain, pFilter};
+            for (size_t c=0; c<8; ++c)
+            {
+                pSystem->addComponent(components[c]);
+            }
+            QVERIFY(pSystem->connect(pSource->getPort("P1"), pOrifice1->getPort("P1")));
+            QVERIFY(pSystem->connect(pOrifice1->getPort("P2"), pVolume->getPort("P1")));
+            QVERIFY(pSystem->connect(pVolume->getPort("P2"), pOrifice2->getPort("P1")));
+            QVERIFY(pSystem->connect(pOrifice2->getPort("P2"), pTank->getPort("P1")));
+            QVERIFY(pSystem->connect(pVolume->getPort("P1"), pSensor->getPort("P1")));
+            QVERIFY(pSystem->connect(pSensor->getPort("out"), pGain->getPort("in")));
+            QVERIFY(pSystem->connect(pGain->getPort("out"), pFilter->getPort("in")));
+            pSource->setParameterValue("p#Value", QString::number(1.0e6*(l+1)).toStdString().c_str());
+            pOrifice1->setParameterValue("Kc#Value", QString::number(1.0e-11*(l+1)).toStdString().c_str());
+            pGain->setParameterValue("k#Value", QString::number(1.0e-5*(l+1)).toStdString().c_str());
+            pSystem->setNumLogSamples(100);
+            lanes.push_back(pSystem);
+            volumePorts.push_back(pVolume->getPort("P1"));
+            filterPorts.push_back(pFilter->getPort("out"));
+        }
+
+        // Reference results, each lane simulated on its own
+        std::vector< std::vector< std::vector<double> > > volumeResults, filterResults;
+        for (size_t l=0; l<nLanes; ++l)
+        {
+            QVERIFY(lanes[l]->checkModelBeforeSimulation());
+            QVERIFY(lanes[l]->initialize(0, 1.0));
+            lanes[l]->simulate(1.0);
+            lanes[l]->finalize();
+            volumeResults.push_back(getLogDataColumns(volumePorts[l]));
+            filterResults.push_back(getLogDataColumns(filterPorts[l]));
+        }
+        QVERIFY2(volumeResults[0] != volumeResults[1], "The lanes should give different results!");
+
+        // Simulate in two parts, to make sure the ensemble can continue from where it stopped
+        EnsembleSimulation ensemble(lanes);
+        ensemble.setLaneGroupSize(2);
+        QVERIFY(ensemble.initialize(0, 1.0));
+        QVERIFY(ensemble.getNumLanes() == nLanes);
+        QVERIFY(ensemble.getNumEnsembleComponents() == 7);
+        QVERIFY(ensemble.getNumFallbackComponents() == 1);
+        QVERIFY(ensemble.simulate(0.5));
+        QVERIFY(ensemble.simulate(1.0));
+        ensemble.finalize();
+        for (size_t l=0; l<nLanes; ++l)
+        {
+            std::vector< std::vector<double> > columns[2] = {getLogDataColumns(volumePorts[l]), getLogDataColumns(filterPorts[l])};
+            std::vector< std::vector<double> > *pReferences[2] = {&volumeResults[l], &filterResults[l]};
+            for (size_t r=0; r<2; ++r)
+            {
+                QVERIFY(columns[r].size() == pReferences[r]->size());
+                for (size_t v=0; v<columns[r].size(); ++v)
+                {
+                    QVERIFY(columns[r][v].size() == pReferences[r]->at(v).size());
+                    for (size_t i=0; i<columns[r][v].size(); ++i)
+                    {
+                        // Allow for different rounding if the compiler contracts the vectorised expressions differently
+                        const double reference = pReferences[r]->at(v)[i];
+                        QVERIFY2(fabs(columns[r][v][i]-reference) <= 1e-12*(1.0+fabs(reference)), "Ensemble simulation gave different results than simulating each lane!");
+                    }
+                }
+            }
+        }
+
+        // Lanes that differ can not be simulated together, a disabled component is only found when the initialized components are matched
+        Component *pLastFilter = lanes[nLanes-1]->getSubComponent("SignalFirstOrderTransferFunction");
+        pLastFilter->setDisabled(true);
+        EnsembleSimulation disabledEnsemble(lanes);
+        QVERIFY(!disabledEnsemble.initialize(0, 1.0));
+        QVERIFY2(!disabledEnsemble.simulate(1.0), "An ensemble that failed to initialize could be simulated!");
+        disabledEnsemble.finalize();
+        pLastFilter->setDisabled(false);
+
+        lanes[nLanes-1]->removeSubComponent(lanes[nLanes-1]->getSubComponent("SignalFirstOrderTransferFunction"), true);
+        EnsembleSimulation badEnsemble(lanes);
+        QVERIFY(!badEnsemble.initialize(0, 1.0));
+        badEnsemble.finalize();
+
+        for (size_t l=0; l<nLanes; ++l)
+        {
+            mHopsanCore.removeComponent(lanes[l]);
+        }
+    }
+
+    void System_Clone()
+    {
+        ComponentSystem* pClone = mHopsanCore.cloneComponentSystem(mpSystemFromFile);
+        QVERIFY2(pClone, "Could not clone system!");
+        QVERIFY2(isSameSystem(mpSystemFromFile, pClone, false), "Cloned system differs from the original!");
+
+        // The clone must be independent of the original
+        pClone->setParameterValue("apa", "8");
+        HString value;
+        mpSystemFromFile->getParameterValue("apa", value);
+        QVERIFY2(value == "7", "Changing a parameter in the clone changed the original!");
+        pClone->setParameterValue("apa", "7");
+
+        // A clone must simulate exactly like the same model loaded from file
+        double startT, stopT;
+        ComponentSystem* pReloaded = mHopsanCore.loadHMFModelFile(TEST_DATA_ROOT "unittestmodel.hmf", startT, stopT);
+        QVERIFY(pReloaded);
+        QVERIFY(pClone->initialize(0, 10.0));
+        pClone->simulate(10.0);
+        pClone->finalize();
+        QVERIFY(pReloaded->initialize(0, 10.0));
+        pReloaded->simulate(10.0);
+        pReloaded->finalize();
+        QVERIFY2(isSameSystem(pReloaded, pClone, true), "Cloned system gave different results than the system loaded from file!");
+
+        mHopsanCore.removeComponent(pReloaded);
+        mHopsanCore.removeComponent(pClone);
+    }
+
+    void System_BinaryModelFile()
+    {
+        // Compile a copy of the model file, so that the source file can be changed later
+        const QString hmfFileName = QDir::temp().filePath("hopsan_unittest_binarymodel.hmf");
+        const QString hmfbFileName = QDir::temp().filePath("hopsan_unittest_binarymodel.hmfb");
+        QFile::remove(hmfFileName);
+        QVERIFY(QFile::copy(TEST_DATA_ROOT "unittestmodel.hmf", hmfFileName));
+        double startT, stopT;
+        ComponentSystem* pSystem = mHopsanCore.loadHMFModelFile(hmfFileName.toStdString().c_str(), startT, stopT);
+        QVERIFY(pSystem);
+        QVERIFY2(saveBinaryModelFile(hmfbFileName.toStdString().c_str(), pSystem, hmfFileName.toStdString().c_str(), startT, stopT), "Could not compile the model!");
+
+        // The binary model must be identical to the model loaded from file, and simulate identically
+        double binaryStartT, binaryStopT;
+        ComponentSystem* pBinary = mHopsanCore.loadHMFModelFile(hmfbFileName.toStdString().c_str(), binaryStartT, binaryStopT);
+        QVERIFY2(pBinary, "Could not load the binary model file!");
+        QVERIFY2(binaryStartT == startT && binaryStopT == stopT, "Wrong simulation time in the binary model file!");
+        QVERIFY2(isSameSystem(pSystem, pBinary, false), "Binary model file differs from the model file!");
+        QVERIFY(pSystem->initialize(0, 10.0));
+        pSystem->simulate(10.0);
+        pSystem->finalize();
+        QVERIFY(pBinary->initialize(0, 10.0));
+        pBinary->simulate(10.0);
+        pBinary->finalize();
+        QVERIFY2(isSameSystem(pSystem, pBinary, true), "Binary model file gave different results than the model file!");
+        mHopsanCore.removeComponent(pBinary);
+        mHopsanCore.removeComponent(pSystem);
+
+        // When the source file has changed, the binary file is out of date and the source file must be loaded instead
+        QFile hmfFile(hmfFileName);
+        QVERIFY(hmfFile.open(QIODevice::Append));
+        hmfFile.write("\n");
+        hmfFile.close();
+        while (mHopsanCore.checkMessage() > 0) {
+            HString message, type, tag;
+            mHopsanCore.getMessage(message, type, tag);
+        }
+        pBinary = mHopsanCore.loadHMFModelFile(hmfbFileName.toStdString().c_str(), binaryStartT, binaryStopT);
+        QVERIFY2(pBinary, "Could not load the out of date binary model file!");
+        bool loadedSourceFile = false;
+        while (mHopsanCore.checkMessage() > 0) {
+            HString message, type, tag;
+            mHopsanCore.getMessage(message, type, tag);
+            loadedSourceFile = loadedSourceFile || message.containes("is out of date");
+        }
+        QVERIFY2(loadedSourceFile, "The source file was not loaded for an out of date binary model file!");
+        mHopsanCore.removeComponent(pBinary);
+        QFile::remove(hmfFileName);
+        QFile::remove(hmfbFileName);
+    }
+
+    void System_Simulate_VariableLogging()
+    {
+        Port* pVolumeP1 = mpSystemFromFile->getSubComponent("TestVolume")->getPort("P1");
+        const int pressureId = pVolumeP1->getNodeDataIdFromName("Pressure");
+        const int flowId = pVolumeP1->getNodeDataIdFromName("Flow");
+        QVERIFY(pressureId >= 0 && flowId >= 0);
+
+        QVERIFY(mpSystemFromFile->initialize(0, 10.0));
+        mpSystemFromFile->simulate(10.0);
+        mpSystemFromFile->finalize();
+        std::vector< std::vector<double> > allResults = getLogDataColumns(pVolumeP1);
+        QVERIFY2(allResults[pressureId].size() == 2048, "Pressure was not logged!");
+
+        // Disable logging of all but the pressure variable, in every port connected to the node
+        std::vector<Port*> connectedPorts = pVolumeP1->getConnectedPorts();
+        connectedPorts.push_back(pVolumeP1);
+        for (size_t p=0; p<connectedPorts.size(); ++p) {
+            for (size_t v=0; v<connectedPorts[p]->getNumDataVariables(); ++v) {
+                connectedPorts[p]->setEnableVariableLogging(v, (int(v) == pressureId));
+            }
+        }
+        QVERIFY(pVolumeP1->isVariableLoggingEnabled(pressureId));
+        QVERIFY(!pVolumeP1->isVariableLoggingEnabled(flowId));
+
+        QVERIFY(mpSystemFromFile->initialize(0, 10.0));
+        mpSystemFromFile->simulate(10.0);
+        mpSystemFromFile->finalize();
+        std::vector< std::vector<double> > pressureOnlyResults = getLogDataColumns(pVolumeP1);
+        QVERIFY2(pressureOnlyResults[pressureId] == allResults[pressureId], "Per-variable logging gave different results!");
+        QVERIFY2(pressureOnlyResults[flowId].empty(), "Variable was logged even though logging was disabled!");
+    }
+
+    void System_Simulate_LogStream()
+    {
+        Port* pStepOut = mpSystemFromFile->getSubComponent("TestStep")->getPort("out");
+
+        QVERIFY(mpSystemFromFile->initialize(0, 10.0));
+        mpSystemFromFile->simulate(10.0);
+        mpSystemFromFile->finalize();
+        std::vector<double> storedTime = *mpSystemFromFile->getLogTimeVector();
+        std::vector<double> storedStep = getLogDataColumns(pStepOut)[0];
+
+        // Use a small ring buffer so that it wraps around many times during the simulation
+        MemoryLogSink sink;
+        mpSystemFromFile->setLogSink(&sink, 7);
+        QVERIFY(mpSystemFromFile->initialize(0, 10.0));
+        mpSystemFromFile->simulate(10.0);
+        mpSystemFromFile->finalize();
+        mpSystemFromFile->setLogSink(0);
+
+        QVERIFY2(sink.mIsClosed, "Log sink was not closed!");
+        QVERIFY2(mpSystemFromFile->getNumStreamedLogSamples() == 2048, "Wrong number of streamed samples!");
+        QVERIFY2(sink.mSamples.size() == 2048*sink.mVariables.size(), "Wrong number of samples in log sink!");
+        QVERIFY2(mpSystemFromFile->getLogTimeVector()->empty(), "Log data was stored in memory while streaming!");
+
+        size_t stepColumn = sink.mVariables.size();
+        for (size_t i=0; i<sink.mVariables.size(); ++i) {
+            // The node is named after the first port that logs it, that could be either end of the connection
+            const HString &name = sink.mVariables[i].name;
+            if (name == "TestStep#out#Value" || name == "TestGain#in#Value") {
+                stepColumn = i;
+            }
+        }
+        QVERIFY2(stepColumn < sink.mVariables.size(), "Step output was not streamed!");
+        for (size_t s=0; s<2048; ++s) {
+            QVERIFY2(sink.mSamples[s*sink.mVariables.size()] == storedTime[s], "Streamed time differs from stored log data!");
+            QVERIFY2(sink.mSamples[s*sink.mVariables.size()+stepColumn] == storedStep[s], "Streamed data differs from stored log data!");
+        }
+    }
+
+    void System_SaveRestore_SimulationPoint()
+    {
+        ComponentSystem *pSystems[2] = {createNoiseLineSystem(), createNoiseLineSystem()};
+        QVERIFY(pSystems[0] && pSystems[1]);
+        QVERIFY(pSystems[0]->checkModelBeforeSimulation());
+        QVERIFY(pSystems[1]->checkModelBeforeSimulation());
+
+        // Simulate the first half, save a simulation point and then simulate the second half
+        const QString fileName = QDir::temp().filePath("hopsan_unittest_simulationpoint.hspt");
+        QVERIFY(pSystems[0]->initialize(0, 1.0));
+        pSystems[0]->simulate(0.5);
+        saveSimulationPoint(fileName.toStdString().c_str(), pSystems[0]);
+        pSystems[0]->simulate(1.0);
+        pSystems[0]->finalize();
+
+        // Restore the simulation point in the other system and simulate the second half, the result must be identical
+        double timeOffset = 0;
+        restoreSimulationPoint(fileName.toStdString().c_str(), pSystems[1], timeOffset);
+        QFile::remove(fileName);
+        QVERIFY2(timeOffset == pSystems[0]->getLogTimeVector()->at(50), "Wrong simulation point time!");
+        QVERIFY(pSystems[1]->initialize(timeOffset, 1.0));
+        pSystems[1]->simulate(1.0);
+        pSystems[1]->finalize();
+        QVERIFY2(hasSameNodeData(pSystems[0], pSystems[1]), "Restored simulation gave different results!");
+
+        for (Component *pComponent : pSystems[0]->getSubComponents())
+        {
+            for (Port *pPort : pComponent->getPortPtrVector())
+            {
+                std::vector< std::vector<double> > columns = getLogDataColumns(pPort);
+                std::vector< std::vector<double> > restoredColumns = getLogDataColumns(pSystems[1]->getSubComponent(pComponent->getName())->getPort(pPort->getName()));
+                for (size_t i=0; i<columns.size(); ++i)
+                {
+                    // Unconnected ports are not logged
+                    if (!columns[i].empty())
+                    {
+                        QVERIFY2(restoredColumns[i].front() == columns[i][50], "Restored start values were not logged!");
+                    }
+                }
+            }
+        }
+
+        mHopsanCore.removeComponent(pSystems[0]);
+        mHopsanCore.removeComponent(pSystems[1]);
+    }
+
+    void System_Fork()
+    {
+        ComponentSystem *pSystem = createNoiseLineSystem();
+        QVERIFY(pSystem);
+        QVERIFY(pSystem->checkModelBeforeSimulation());
+        QVERIFY(pSystem->initialize(0, 1.0));
+        pSystem->simulate(0.5);
+        const double forkTime = pSystem->getTime();
+        std::vector<ComponentSystem*> forks = pSystem->fork(3);
+        QVERIFY2(forks.size() == 3, "Could not fork system!");
+        pSystem->simulate(1.0);
+        pSystem->finalize();
+
+        // Simulate the forks in parallel, with a changed filter parameter in the last one
+        QVERIFY(forks[2]->getSubComponent("SignalFirstOrderTransferFunction")->setParameterValue("b_1", "0.02"));
+        SimulationHandler *pHandler = mHopsanCore.getSimulationHandler();
+        QVERIFY(pHandler->initializeSystem(forkTime, 1.0, forks));
+        QVERIFY(pHandler->simulateSystem(forkTime, 1.0, 3, forks));
+        pHandler->finalizeSystem(forks);
+        QVERIFY2(hasSameNodeData(pSystem, forks[0]), "Forked simulation gave different results!");
+        QVERIFY2(hasSameNodeData(pSystem, forks[1]), "Forked simulation gave different results!");
+        QVERIFY2(!hasSameNodeData(pSystem, forks[2]), "Changing a parameter in a fork had no effect!");
+
+        for (ComponentSystem *pFork : forks) {
+            mHopsanCore.removeComponent(pFork);
+        }
+        mHopsanCore.removeComponent(pSystem);
+    }
+
+    void Component_Utility_StateArchive()
+    {
+        Delay delay;
+        delay.initialize(5, 0.0);
+        FirstOrderTransferFunction filter;
+        double num[2] = {1.0, 0.0};
+        double den[2] = {1.0, 0.1};
+        filter.initialize(0.001, num, den);
+        for (int i=0; i<12; ++i)
+        {
+            delay.update(double(i));
+            filter.update(double(i));
+        }
+
+        StateArchive saveArchive;
+        delay.serializeState(saveArchive);
+        filter.serializeState(saveArchive);
+
+        // Restore into objects with a different delay length and filter state
+        Delay restoredDelay;
+        restoredDelay.initialize(2, -1.0);
+        FirstOrderTransferFunction restoredFilter;
+        restoredFilter.initialize(0.001, num, den, -1.0, -1.0);
+        StateArchive restoreArchive(saveArchive.getData().data(), saveArchive.getData().size());
+        QVERIFY(restoreArchive.isRestoring());
+        restoredDelay.serializeState(restoreArchive);
+        restoredFilter.serializeState(restoreArchive);
+        QVERIFY(restoreArchive.isOK());
+        QVERIFY(restoredDelay.getSize() == delay.getSize());
+        QVERIFY(restoredDelay.update(100.0) == delay.update(100.0));
+        QVERIFY(restoredDelay.getOldest() == delay.getOldest());
+        QVERIFY(restoredFilter.update(100.0) == filter.update(100.0));
+
+        // An archive with too little data must be reported
+        StateArchive truncatedArchive(saveArchive.getData().data(), saveArchive.getData().size()-1);
+        restoredDelay.serializeState(truncatedArchive);
+        restoredFilter.serializeState(truncatedArchive);
+        QVERIFY(!truncatedArchive.isOK());
+    }
+
     void Component_Set_Parameter()
     {
         QFETCH(QString, compName);
@@ -29,6 +29,7 @@
 #include "CoreUtilities/HopsanCoreMessageHandler.h"
 #include "CoreUtilities/StringUtilities.h"
 #include "CoreUtilities/MultiThreadingUtilities.h"
+#include "CoreUtilities/GraphPartitioner.h"
 
 using namespace hopsan;
 
@@ -222,6 +223,115 @@ private Q_SLOTS:
         QTest::newRow("7") << 8;
         QTest::newRow("8") << 9;
     }
+
+    void Parse_Thread_Placement()
+    {
+        QFETCH(QString, placementString);
+        QFETCH(bool, ok);
+        QFETCH(int, placement);
+        QFETCH(QString, cpus);
+
+        ThreadPlacementT parsedPlacement;
+        std::vector<int> parsedCpus;
+        QVERIFY2(parseThreadPlacement(placementString.toStdString(), parsedPlacement, parsedCpus) == ok, "parseThreadPlacement() returned wrong value!");
+        if (ok)
+        {
+            QStringList parsedCpuStrings;
+            for (size_t i=0; i<parsedCpus.size(); ++i)
+            {
+                parsedCpuStrings.append(QString::number(parsedCpus[i]));
+            }
+            QVERIFY2(parsedPlacement == ThreadPlacementT(placement), "parseThreadPlacement() returned wrong placement!");
+            QVERIFY2(parsedCpuStrings.join(",") == cpus, "parseThreadPlacement() returned wrong processors!");
+        }
+    }
+
+    void Parse_Thread_Placement_data()
+    {
+        QTest::addColumn<QString>("placementString");
+        QTest::addColumn<bool>("ok");
+        QTest::addColumn<int>("placement");
+        QTest::addColumn<QString>("cpus");
+
+        QTest::newRow("0") << "auto" << true << int(AutomaticThreadPlacement) << "";
+        QTest::newRow("1") << "none" << true << int(NoThreadPlacement) << "";
+        QTest::newRow("2") << "compact" << true << int(CompactThreadPlacement) << "";
+        QTest::newRow("3") << "scatter" << true << int(ScatterThreadPlacement) << "";
+        QTest::newRow("4") << "3" << true << int(ExplicitThreadPlacement) << "3";
+        QTest::newRow("5") << "0-3,8,10-11" << true << int(ExplicitThreadPlacement) << "0,1,2,3,8,10,11";
+        QTest::newRow("6") << "" << false << 0 << "";
+        QTest::newRow("7") << "3-1" << false << 0 << "";
+        QTest::newRow("8") << "1,,2" << false << 0 << "";
+        QTest::newRow("9") << "1-2x" << false << 0 << "";
+        QTest::newRow("10") << "spread" << false << 0 << "";
+    }
+
+    void Determine_Thread_Cpus()
+    {
+        const std::vector<int> allowedCpus = getAllowedCpus();
+        if (allowedCpus.empty())
+        {
+            QSKIP("Thread placement is not supported on this system");
+        }
+        const size_t nThreads = allowedCpus.size()+1;
+
+        QVERIFY2(determineThreadCpus(nThreads, AutomaticThreadPlacement).empty(), "Automatic thread placement should use the default placement!");
+        QVERIFY2(determineThreadCpus(nThreads, NoThreadPlacement) == std::vector<int>(nThreads, -1), "Threads should not be pinned without thread placement!");
+
+        // Compact and scatter placement should use every allowed processor once before reusing them
+        const ThreadPlacementT placements[2] = {CompactThreadPlacement, ScatterThreadPlacement};
+        for (size_t p=0; p<2; ++p)
+        {
+            std::vector<int> threadCpus = determineThreadCpus(nThreads, placements[p]);
+            QVERIFY2(threadCpus.size() == nThreads, "determineThreadCpus() returned wrong number of processors!");
+            QVERIFY2(threadCpus.back() == threadCpus.front(), "determineThreadCpus() did not reuse the processors in order!");
+            threadCpus.pop_back();
+            std::sort(threadCpus.begin(), threadCpus.end());
+            QVERIFY2(threadCpus == allowedCpus, "determineThreadCpus() did not use each allowed processor once!");
+        }
+
+        // Processors that are not allowed should be ignored
+        std::vector<int> cpus;
+        cpus.push_back(allowedCpus.back());
+        cpus.push_back(1<<20);
+        const std::vector<int> threadCpus = determineThreadCpus(2, ExplicitThreadPlacement, cpus);
+        QVERIFY2(threadCpus == std::vector<int>(2, allowedCpus.back()), "determineThreadCpus() did not ignore a processor that is not allowed!");
+    }
+
+    void Graph_Partitioner()
+    {
+        QFETCH(int, nParts);
+
+        // A square grid graph, where the optimal cut is known to be small
+        const size_t w = 40;
+        GraphPartitioner partitioner(w*w);
+        for(size_t y=0; y<w; ++y)
+        {
+            for(size_t x=0; x<w; ++x)
+            {
+                if(x+1 < w)
+                    partitioner.addEdge(y*w+x, y*w+x+1);
+                if(y+1 < w)
+                    partitioner.addEdge(y*w+x, (y+1)*w+x);
+            }
+        }
+
+        std::vector<size_t> parts;
+        partitioner.partition(size_t(nParts), parts);
+        QVERIFY2(parts.size() == w*w, "Wrong number of partitioned vertices!");
+        QVERIFY2(partitioner.getImbalance(parts, size_t(nParts)) <= 1.05, "Partitioning is not balanced!");
+        QVERIFY2(partitioner.getCutWeight(parts) <= double(2*nParts*w), "Partitioning cuts too many edges!");
+    }
+
+    void Graph_Partitioner_data()
+    {
+        QTest::addColumn<int>("nParts");
+
+        QTest::newRow("0") << 2;
+        QTest::newRow("1") << 3;
+        QTest::newRow("2") << 4;
+        QTest::newRow("3") << 8;
+    }
 };
 QTEST_APPLESS_MAIN(UtilitiesTestTest)
 
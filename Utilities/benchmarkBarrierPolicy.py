@@ -0,0 +1,68 @@
+#!/usr/bin/python
+# Script to benchmark the barrier policies of multi-threaded simulation through the CLI when the processor is oversubscribed
+# Several CLI processes are started at the same time, each one using one thread per processor core
+# Usage: benchmarkBarrierPolicy.py HopsanRootDir [numConcurrentSimulations] [model.hmf]
+# If no model is given, the largest Multicore-test model in "Models/Benchmark Models" is used
+# $Id$
+
+import sys
+import os
+import glob
+import time
+import subprocess
+
+
+def parsesimtime(output):
+    for line in output.splitlines():
+        fields = line.split(':')
+        if len(fields) > 1 and line.startswith('SimulationTime'):
+            return float(fields[1].split()[0])
+    return None
+
+
+def runconcurrent(clipath, model, policy, numconcurrent):
+    cmd = [clipath, '-m', model, '-s', 'hmf', '-l', '0', '-p', '0:'+policy]
+    starttime = time.time()
+    procs = [subprocess.Popen(cmd, stdout=subprocess.PIPE, stderr=subprocess.STDOUT, universal_newlines=True)
+             for i in range(numconcurrent)]
+    simtimes = list()
+    for proc in procs:
+        output = proc.communicate()[0]
+        st = parsesimtime(output)
+        if st is None:
+            print('Error: Could not parse simulation time when running: '+' '.join(cmd))
+            print(output)
+            return None, None
+        simtimes.append(st)
+    return time.time()-starttime, max(simtimes)
+
+
+if __name__ == "__main__":
+
+    if len(sys.argv) < 2:
+        print('Error: You must give at least one argument, the Hopsan root dir')
+        exit()
+    else:
+        rootdir = sys.argv[1]
+
+    clipath = os.path.join(rootdir, 'bin/hopsancli')
+    if not os.path.isfile(clipath):
+        print('Can not find the HopsanCLI program')
+        exit()
+
+    numconcurrent = int(sys.argv[2]) if len(sys.argv) > 2 else 4
+    if len(sys.argv) > 3:
+        model = sys.argv[3]
+    else:
+        models = sorted(glob.glob(os.path.join(rootdir, 'Models/Benchmark Models/Multicore-test-*.hmf')),
+                        key=lambda m: int(m.split('-')[-1].split('.')[0]))
+        model = models[-1]
+
+    print('Model: '+os.path.basename(model)+', concurrent simulations: '+str(numconcurrent))
+    print('%-10s %14s %18s' % ('Policy', 'Wall time [s]', 'Slowest sim [s]'))
+    for policy in ['spin', 'block', 'backoff']:
+        walltime, slowest = runconcurrent(clipath, model, policy, numconcurrent)
+        if walltime is not None:
+            print('%-10s %14.4f %18.4f' % (policy, walltime, slowest))
+
+    print('Done!')
@@ -0,0 +1,93 @@
+#!/usr/bin/python
+# Script to compare the load time of models from .hmf files and from precompiled binary model files (.hmfb) through the CLI
+# Usage: benchmarkBinaryModelFile.py HopsanRootDir [model.hmf ...]
+# If no models are given, Multicore-test.hmf in "Models/Benchmark Models" and some of the example models are used
+# $Id$
+
+import sys
+import os
+import subprocess
+import tempfile
+
+# The numbered Multicore-test models are saved with an old version that the model loader rejects, they must be resaved first
+defaultmodels = ['Benchmark Models/Multicore-test.hmf',
+                 'Example Models/Position Servo.hmf',
+                 'Example Models/Hydrostatic Transmission.hmf',
+                 'Example Models/Load Sensing System.hmf',
+                 'Example Models/ElectricVehicle.hmf']
+
+
+def parseloadtime(output):
+    for line in output.splitlines():
+        fields = line.split(':')
+        if len(fields) > 1 and line.startswith('LoadTime'):
+            return float(fields[1].split()[0])
+    return None
+
+
+def runcli(clipath, model, extraargs):
+    cmd = [clipath, '-m', model] + extraargs
+    proc = subprocess.Popen(cmd, stdout=subprocess.PIPE, stderr=subprocess.STDOUT, universal_newlines=True)
+    output = proc.communicate()[0]
+    if 'errors while loading the model' in output:
+        print('Skipping '+os.path.basename(model)+', it could not be loaded')
+        return None
+    return output
+
+
+def median(values):
+    values = sorted(values)
+    n = len(values)
+    return values[n//2] if n % 2 else 0.5*(values[n//2-1]+values[n//2])
+
+
+def runtest(clipath, model, numtestitterations):
+    loadtimes = list()
+    for ctr in range(numtestitterations):
+        output = runcli(clipath, model, [])
+        if output is None:
+            return None
+        lt = parseloadtime(output)
+        if lt is None:
+            print('Error: Could not parse load time when loading: '+model)
+            print(output)
+            return None
+        loadtimes.append(lt)
+    return median(loadtimes)
+
+
+if __name__ == "__main__":
+
+    if len(sys.argv) < 2:
+        print('Error: You must give at least one argument, the Hopsan root dir')
+        exit()
+    else:
+        rootdir = sys.argv[1]
+
+    clipath = os.path.join(rootdir, 'bin/hopsancli')
+    if not os.path.isfile(clipath):
+        print('Can not find the HopsanCLI program')
+        exit()
+
+    models = sys.argv[2:]
+    if not models:
+        models = [os.path.join(rootdir, 'Models', m) for m in defaultmodels]
+
+    # Setup variables
+    numtestitterations = 11
+    tempdir = tempfile.mkdtemp()
+
+    print('%-36s %12s %12s %8s %10s %10s' % ('Model', 'HMF [ms]', 'HMFB [ms]', 'Speedup', 'HMF [kB]', 'HMFB [kB]'))
+    for model in models:
+        binarymodel = os.path.join(tempdir, os.path.splitext(os.path.basename(model))[0]+'.hmfb')
+        if runcli(clipath, model, ['--compileModel', binarymodel]) is None or not os.path.isfile(binarymodel):
+            continue
+        th = runtest(clipath, model, numtestitterations)
+        tb = runtest(clipath, binarymodel, numtestitterations)
+        if th and tb:
+            print('%-36s %12.2f %12.2f %8.2f %10d %10d' % (os.path.basename(model), th*1000, tb*1000, th/tb,
+                                                          os.path.getsize(model)//1024, os.path.getsize(binarymodel)//1024))
+        os.remove(binarymodel)
+    os.rmdir(tempdir)
+
+    print('Done!')
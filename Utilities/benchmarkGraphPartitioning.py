@@ -0,0 +1,79 @@
+#!/usr/bin/python
+# Script to compare the scaling of the offline and the graph partitioning scheduling algorithms through the CLI
+# Each model is simulated single-threaded and then with an increasing number of threads using both algorithms
+# Usage: benchmarkGraphPartitioning.py HopsanRootDir [maxNumThreads] [model.hmf ...]
+# If no models are given, Multicore-test.hmf in "Models/Benchmark Models" and some of the example models are used
+# $Id$
+
+import sys
+import os
+import subprocess
+import multiprocessing
+
+# The numbered Multicore-test models are saved with an old version that the model loader rejects, they must be resaved first
+defaultmodels = ['Benchmark Models/Multicore-test.hmf',
+                 'Example Models/Position Servo.hmf',
+                 'Example Models/Hydrostatic Transmission.hmf',
+                 'Example Models/Load Sensing System.hmf',
+                 'Example Models/ElectricVehicle.hmf']
+
+def parsesimtime(output):
+    for line in output.splitlines():
+        fields = line.split(':')
+        if len(fields) > 1 and line.startswith('SimulationTime'):
+            return float(fields[1].split()[0])
+    return None
+
+
+def simulate(clipath, model, parallelarg):
+    cmd = [clipath, '-m', model, '-s', 'hmf', '-l', '0']
+    if parallelarg is not None:
+        cmd += ['-p', parallelarg]
+    output = subprocess.Popen(cmd, stdout=subprocess.PIPE, stderr=subprocess.STDOUT, universal_newlines=True).communicate()[0]
+    if 'errors while loading the model' in output:
+        print('Skipping '+os.path.basename(model)+', it could not be loaded')
+        return None
+    st = parsesimtime(output)
+    if st is None:
+        print('Error: Could not parse simulation time when running: '+' '.join(cmd))
+        print(output)
+    return st
+
+
+if __name__ == "__main__":
+
+    if len(sys.argv) < 2:
+        print('Error: You must give at least one argument, the Hopsan root dir')
+        exit()
+    else:
+        rootdir = sys.argv[1]
+
+    clipath = os.path.join(rootdir, 'bin/hopsancli')
+    if not os.path.isfile(clipath):
+        print('Can not find the HopsanCLI program')
+        exit()
+
+    maxthreads = int(sys.argv[2]) if len(sys.argv) > 2 else multiprocessing.cpu_count()
+    if len(sys.argv) > 3:
+        models = sys.argv[3:]
+    else:
+        models = [os.path.join(rootdir, 'Models', m) for m in defaultmodels]
+
+    threadcounts = [2]
+    while threadcounts[-1]*2 <= maxthreads:
+        threadcounts.append(threadcounts[-1]*2)
+
+    print('%-28s %8s %14s %14s %14s' % ('Model', 'Threads', 'Offline [s]', 'Partition [s]', 'Speedup'))
+    for model in models:
+        serialtime = simulate(clipath, model, None)
+        if serialtime is None:
+            continue
+        print('%-28s %8d %14.4f %14.4f %14s' % (os.path.basename(model), 1, serialtime, serialtime, '1.00 / 1.00'))
+        for nthreads in threadcounts:
+            offlinetime = simulate(clipath, model, str(nthreads)+':spin:offline')
+            partitiontime = simulate(clipath, model, str(nthreads)+':spin:partition')
+            if offlinetime is not None and partitiontime is not None:
+                speedups = '%.2f / %.2f' % (serialtime/offlinetime, serialtime/partitiontime)
+                print('%-28s %8d %14.4f %14.4f %14s' % (os.path.basename(model), nthreads, offlinetime, partitiontime, speedups))
+
+    print('Done!')
@@ -0,0 +1,82 @@
+#!/usr/bin/python
+# Script to benchmark Hopsan Core simulation through the CLI with and without the contiguous node data arena
+# Usage: benchmarkNodeDataArena.py HopsanRootDir [model.hmf ...]
+# If no models are given, Multicore-test.hmf in "Models/Benchmark Models" and some of the example models are used
+# $Id$
+
+import sys
+import os
+import subprocess
+
+# The numbered Multicore-test models are saved with an old version that the model loader rejects, they must be resaved first
+defaultmodels = ['Benchmark Models/Multicore-test.hmf',
+                 'Example Models/Position Servo.hmf',
+                 'Example Models/Hydrostatic Transmission.hmf',
+                 'Example Models/Load Sensing System.hmf',
+                 'Example Models/ElectricVehicle.hmf']
+
+
+def parsetimes(output):
+    it = None
+    st = None
+    for line in output.splitlines():
+        fields = line.split(':')
+        if len(fields) > 1:
+            if line.startswith('InitializeTime'):
+                it = float(fields[1].split()[0])
+            elif line.startswith('SimulationTime'):
+                st = float(fields[1].split()[0])
+    return it, st
+
+
+def runtest(clipath, model, extraargs, numtestitterations):
+    simtimes = list()
+    for ctr in range(numtestitterations):
+        cmd = [clipath, '-m', model, '-s', 'hmf', '-l', '0'] + extraargs
+        proc = subprocess.Popen(cmd, stdout=subprocess.PIPE, stderr=subprocess.STDOUT, universal_newlines=True)
+        output = proc.communicate()[0]
+        if 'errors while loading the model' in output:
+            print('Skipping '+os.path.basename(model)+', it could not be loaded')
+            return None
+        it, st = parsetimes(output)
+        if st is None:
+            print('Error: Could not parse simulation time when running: '+' '.join(cmd))
+            print(output)
+            return None
+        simtimes.append(st)
+    return simtimes
+
+
+if __name__ == "__main__":
+
+    if len(sys.argv) < 2:
+        print('Error: You must give at least one argument, the Hopsan root dir')
+        exit()
+    else:
+        rootdir = sys.argv[1]
+
+    clipath = os.path.join(rootdir, 'bin/hopsancli')
+    if not os.path.isfile(clipath):
+        print('Can not find the HopsanCLI program')
+        exit()
+
+    models = sys.argv[2:]
+    if not models:
+        models = [os.path.join(rootdir, 'Models', m) for m in defaultmodels]
+
+    # Setup variables
+    numtestitterations = 5
+
+    print('%-30s %12s %12s %8s' % ('Model', 'Default [s]', 'Arena [s]', 'Speedup'))
+    for model in models:
+        before = runtest(clipath, model, [], numtestitterations)
+        if not before:
+            continue
+        after = runtest(clipath, model, ['--nodeDataArena'], numtestitterations)
+        if before and after:
+            # Use the best time to reduce the influence of other processes
+            tb = min(before)
+            ta = min(after)
+            print('%-30s %12.4f %12.4f %8.2f' % (os.path.basename(model), tb, ta, tb/ta))
+
+    print('Done!')
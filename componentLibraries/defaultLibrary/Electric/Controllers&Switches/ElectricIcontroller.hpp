@@ -311,5 +311,12 @@ uel2,umin,umax));
     {
         delete mpSolver;
     }
+
+     void serializeState(StateArchive &rArchive)
+     {
+         mDelayedPart10.serializeState(rArchive);
+         mDelayedPart11.serializeState(rArchive);
+         mDelayedPart20.serializeState(rArchive);
+     }
 };
 #endif // ELECTRICICONTROLLER_HPP_INCLUDED
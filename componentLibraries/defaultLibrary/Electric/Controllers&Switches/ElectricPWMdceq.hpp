@@ -309,5 +309,12 @@ limit(uel2,umin,umax)/limit(uel10,umin,umax);
     {
         delete mpSolver;
     }
+
+     void serializeState(StateArchive &rArchive)
+     {
+         mDelayedPart10.serializeState(rArchive);
+         mDelayedPart20.serializeState(rArchive);
+         mDelayedPart30.serializeState(rArchive);
+     }
 };
 #endif // ELECTRICPWMDCEQ_HPP_INCLUDED
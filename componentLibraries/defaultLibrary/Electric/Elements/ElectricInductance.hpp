@@ -258,5 +258,11 @@ mTimestep*uel2)/(2.*Induct);
     {
         delete mpSolver;
     }
+
+     void serializeState(StateArchive &rArchive)
+     {
+         mDelayedPart10.serializeState(rArchive);
+         mDelayedPart11.serializeState(rArchive);
+     }
 };
 #endif // ELECTRICINDUCTANCE_HPP_INCLUDED
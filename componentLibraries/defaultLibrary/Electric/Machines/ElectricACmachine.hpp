@@ -499,5 +499,14 @@ Bm*Power(freq,2)*Power(gmax,2)*mTimestep + 2*freq*gmax*iel2*Ke*mTimestep*Np - \
     {
         delete mpSolver;
     }
+
+     void serializeState(StateArchive &rArchive)
+     {
+         mDelayedPart10.serializeState(rArchive);
+         mDelayedPart11.serializeState(rArchive);
+         mDelayedPart20.serializeState(rArchive);
+         mDelayedPart21.serializeState(rArchive);
+         mDelayedPart30.serializeState(rArchive);
+     }
 };
 #endif // ELECTRICACMACHINE_HPP_INCLUDED
@@ -399,5 +399,14 @@ Bm*mTimestep);
     {
         delete mpSolver;
     }
+
+     void serializeState(StateArchive &rArchive)
+     {
+         mDelayedPart10.serializeState(rArchive);
+         mDelayedPart11.serializeState(rArchive);
+         mDelayedPart20.serializeState(rArchive);
+         mDelayedPart21.serializeState(rArchive);
+         mDelayedPart30.serializeState(rArchive);
+     }
 };
 #endif // ELECTRICMOTOR_HPP_INCLUDED
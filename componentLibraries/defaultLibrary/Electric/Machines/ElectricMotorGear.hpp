@@ -437,5 +437,14 @@ mTimestep*myfric*Abs(tormr1)*limit(wmr1/wc,-1.,1.))/(2*JL + \
     {
         delete mpSolver;
     }
+
+     void serializeState(StateArchive &rArchive)
+     {
+         mDelayedPart10.serializeState(rArchive);
+         mDelayedPart11.serializeState(rArchive);
+         mDelayedPart20.serializeState(rArchive);
+         mDelayedPart21.serializeState(rArchive);
+         mDelayedPart30.serializeState(rArchive);
+     }
 };
 #endif // ELECTRICMOTORGEAR_HPP_INCLUDED
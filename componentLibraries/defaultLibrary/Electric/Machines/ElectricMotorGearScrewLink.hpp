@@ -588,5 +588,15 @@ Bm*Power(gearRatio,2)*mTimestep*Power(pitch,2));
     {
         delete mpSolver;
     }
+
+     void serializeState(StateArchive &rArchive)
+     {
+         mDelayedPart10.serializeState(rArchive);
+         mDelayedPart11.serializeState(rArchive);
+         mDelayedPart12.serializeState(rArchive);
+         mDelayedPart20.serializeState(rArchive);
+         mDelayedPart21.serializeState(rArchive);
+         mDelayedPart30.serializeState(rArchive);
+     }
 };
 #endif // ELECTRICMOTORGEARSCREWLINK_HPP_INCLUDED
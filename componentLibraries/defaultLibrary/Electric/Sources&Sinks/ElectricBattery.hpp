@@ -282,5 +282,13 @@ kappa)*Power(e,(10*soc)/kappa)*unom*Power(asin(limit(soc,1.e-9,0.9999)),kappa\
     {
         delete mpSolver;
     }
+
+     void serializeState(StateArchive &rArchive)
+     {
+         mDelayedPart10.serializeState(rArchive);
+         mDelayedPart11.serializeState(rArchive);
+         mDelayedPart20.serializeState(rArchive);
+         mDelayedPart30.serializeState(rArchive);
+     }
 };
 #endif // ELECTRICBATTERY_HPP_INCLUDED
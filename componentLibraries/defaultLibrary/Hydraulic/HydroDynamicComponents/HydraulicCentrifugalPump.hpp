@@ -373,5 +373,11 @@ onPositive(p1),0,1))/(b*kl);
     {
         delete mpSolver;
     }
+
+     void serializeState(StateArchive &rArchive)
+     {
+         mDelayedPart10.serializeState(rArchive);
+         mDelayedPart20.serializeState(rArchive);
+     }
 };
 #endif // HYDRAULICCENTRIFUGALPUMP_HPP_INCLUDED
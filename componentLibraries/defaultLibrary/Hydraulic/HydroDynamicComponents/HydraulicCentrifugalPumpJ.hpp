@@ -471,5 +471,12 @@ onPositive(p1),0,1))/(kl*rho);
     {
         delete mpSolver;
     }
+
+     void serializeState(StateArchive &rArchive)
+     {
+         mDelayedPart10.serializeState(rArchive);
+         mDelayedPart20.serializeState(rArchive);
+         mDelayedPart21.serializeState(rArchive);
+     }
 };
 #endif // HYDRAULICCENTRIFUGALPUMPJ_HPP_INCLUDED
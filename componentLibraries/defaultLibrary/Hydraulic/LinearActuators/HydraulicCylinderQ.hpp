@@ -255,6 +255,12 @@ namespace hopsan {
             (*mpP3_x) = x3;
             (*mpP3_v) = v3;
         }
+
+        void serializeState(StateArchive &rArchive)
+        {
+            mPositionTF.serializeState(rArchive);
+            mVelocityTF.serializeState(rArchive);
+        }
     };
 }
 
@@ -368,6 +368,11 @@ namespace hopsan {
 
             return ret;
         }
+
+        void serializeState(StateArchive &rArchive)
+        {
+            mIntegrator.serializeState(rArchive);
+        }
     };
 }
 
@@ -224,6 +224,12 @@ namespace hopsan {
             (*mpND_a2) = a2;
             (*mpND_w2) = w2;
         }
+
+        void serializeState(StateArchive &rArchive)
+        {
+            mFilterX.serializeState(rArchive);
+            mFilterV.serializeState(rArchive);
+        }
     };
 }
 
@@ -161,6 +161,11 @@ namespace hopsan {
                 (*mvpND_v1[i]) = v1[i];
             }
         }
+
+        void serializeState(StateArchive &rArchive)
+        {
+            mIntegrator.serializeState(rArchive);
+        }
     };
 }
 
@@ -272,6 +272,16 @@ namespace hopsan {
             (*mpND_c3) = c3;
             (*mpND_Zx3) = Zx3;
         }
+
+        void serializeState(StateArchive &rArchive)
+        {
+            mDelayedC1.serializeState(rArchive);
+            mDelayedC2.serializeState(rArchive);
+            mDelayedCp1.serializeState(rArchive);
+            mDelayedCp2.serializeState(rArchive);
+            mDelayedCp1e.serializeState(rArchive);
+            mDelayedCp2e.serializeState(rArchive);
+        }
     };
 }
 
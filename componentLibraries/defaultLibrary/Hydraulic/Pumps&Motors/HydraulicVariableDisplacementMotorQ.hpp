@@ -205,6 +205,11 @@ namespace hopsan {
             (*mpND_a3) = a3;
             (*mpND_w3) = w3;
         }
+
+        void serializeState(StateArchive &rArchive)
+        {
+            mIntegrator.serializeState(rArchive);
+        }
     };
 }
 
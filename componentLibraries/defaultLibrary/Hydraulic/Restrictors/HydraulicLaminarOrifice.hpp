@@ -29,6 +29,7 @@
 
 #include <iostream>
 #include "ComponentEssentials.h"
+#include "ComponentUtilities/EnsembleBlock.h"
 
 namespace hopsan {
 
@@ -117,6 +118,56 @@ namespace hopsan {
             (*mpP2_p) = p2;
             (*mpP2_q) = q2;
         }
+
+        bool hasEnsembleSimulation() const
+        {
+            return true;
+        }
+
+        void simulateOneTimestepEnsemble(Component *const *ppLanes, const size_t nLanes)
+        {
+            typedef HydraulicLaminarOrifice ThisT;
+            double p1[HOPSAN_ENSEMBLE_LANE_WIDTH], q1[HOPSAN_ENSEMBLE_LANE_WIDTH], c1[HOPSAN_ENSEMBLE_LANE_WIDTH], Zc1[HOPSAN_ENSEMBLE_LANE_WIDTH], p2[HOPSAN_ENSEMBLE_LANE_WIDTH], q2[HOPSAN_ENSEMBLE_LANE_WIDTH], c2[HOPSAN_ENSEMBLE_LANE_WIDTH], Zc2[HOPSAN_ENSEMBLE_LANE_WIDTH], Kc[HOPSAN_ENSEMBLE_LANE_WIDTH];
+            for (EnsembleBlock<ThisT> block(ppLanes, nLanes); block.isValid(); block.next())
+            {
+                //Get variable values from nodes
+                block.load(&ThisT::mpP1_c, c1);
+                block.load(&ThisT::mpP1_Zc, Zc1);
+                block.load(&ThisT::mpP2_c, c2);
+                block.load(&ThisT::mpP2_Zc, Zc2);
+                block.load(&ThisT::mpKc, Kc);
+
+                //Orifice equations, same as in simulateOneTimestep() but with the cavitation check written without branches
+                //Recalculating without cavitation gives the same result, so all lanes can do it
+                for (size_t i=0; i<HOPSAN_ENSEMBLE_LANE_WIDTH; ++i)
+                {
+                    Kc[i] = fabs(Kc[i]);
+                    q2[i] = Kc[i]*(c1[i]-c2[i])/(1.0+Kc[i]*(Zc1[i]+Zc2[i]));
+                    q1[i] = -q2[i];
+                    p1[i] = c1[i] + q1[i]*Zc1[i];
+                    p2[i] = c2[i] + q2[i]*Zc2[i];
+
+                    //Cavitation check
+                    c1[i] = (p1[i] < 0.0) ? 0.0 : c1[i];
+                    Zc1[i] = (p1[i] < 0.0) ? 0.0 : Zc1[i];
+                    c2[i] = (p2[i] < 0.0) ? 0.0 : c2[i];
+                    Zc2[i] = (p2[i] < 0.0) ? 0.0 : Zc2[i];
+
+                    q2[i] = Kc[i]*(c1[i]-c2[i])/(1.0+Kc[i]*(Zc1[i]+Zc2[i]));
+                    q1[i] = -q2[i];
+                    p1[i] = c1[i] + q1[i]*Zc1[i];
+                    p2[i] = c2[i] + q2[i]*Zc2[i];
+                    p1[i] = (p1[i] < 0.0) ? 0.0 : p1[i];
+                    p2[i] = (p2[i] < 0.0) ? 0.0 : p2[i];
+                }
+
+                //Write new variables to nodes
+                block.store(&ThisT::mpP1_p, p1);
+                block.store(&ThisT::mpP1_q, q1);
+                block.store(&ThisT::mpP2_p, p2);
+                block.store(&ThisT::mpP2_q, q2);
+            }
+        }
     };
 }
 
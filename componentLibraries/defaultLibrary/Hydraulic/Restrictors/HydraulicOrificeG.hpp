@@ -353,5 +353,10 @@ p2))/(Power(Ao,2)*Power(Cdt,2)*Power(del,4)*Power(dh,4)),1.5));
     {
         delete mpSolver;
     }
+
+     void serializeState(StateArchive &rArchive)
+     {
+         mDelayedPart10.serializeState(rArchive);
+     }
 };
 #endif // HYDRAULICORIFICEG_HPP_INCLUDED
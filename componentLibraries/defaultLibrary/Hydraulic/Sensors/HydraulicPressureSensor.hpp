@@ -36,6 +36,7 @@
 
 #include <iostream>
 #include "ComponentEssentials.h"
+#include "ComponentUtilities/EnsembleBlock.h"
 
 namespace hopsan {
 
@@ -74,6 +75,21 @@ namespace hopsan {
         {
             (*mpOut) = (*mpND_p);
         }
+
+        bool hasEnsembleSimulation() const
+        {
+            return true;
+        }
+
+        void simulateOneTimestepEnsemble(Component *const *ppLanes, const size_t nLanes)
+        {
+            double p[HOPSAN_ENSEMBLE_LANE_WIDTH];
+            for (EnsembleBlock<HydraulicPressureSensor> block(ppLanes, nLanes); block.isValid(); block.next())
+            {
+                block.load(&HydraulicPressureSensor::mpND_p, p);
+                block.store(&HydraulicPressureSensor::mpOut, p);
+            }
+        }
     };
 }
 
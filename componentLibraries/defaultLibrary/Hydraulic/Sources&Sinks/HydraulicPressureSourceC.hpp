@@ -35,6 +35,7 @@
 #define HYDRAULICPRESSURESOURCEC_HPP_INCLUDED
 
 #include "ComponentEssentials.h"
+#include "ComponentUtilities/EnsembleBlock.h"
 
 namespace hopsan {
 
@@ -82,6 +83,26 @@ namespace hopsan {
             *mpP1_c = *mpP;
             *mpP1_Zc = 0.0;
         }
+
+        bool hasEnsembleSimulation() const
+        {
+            return true;
+        }
+
+        void simulateOneTimestepEnsemble(Component *const *ppLanes, const size_t nLanes)
+        {
+            double p[HOPSAN_ENSEMBLE_LANE_WIDTH], Zc[HOPSAN_ENSEMBLE_LANE_WIDTH];
+            for (size_t i=0; i<HOPSAN_ENSEMBLE_LANE_WIDTH; ++i)
+            {
+                Zc[i] = 0.0;
+            }
+            for (EnsembleBlock<HydraulicPressureSourceC> block(ppLanes, nLanes); block.isValid(); block.next())
+            {
+                block.load(&HydraulicPressureSourceC::mpP, p);
+                block.store(&HydraulicPressureSourceC::mpP1_c, p);
+                block.store(&HydraulicPressureSourceC::mpP1_Zc, Zc);
+            }
+        }
     };
 }
 
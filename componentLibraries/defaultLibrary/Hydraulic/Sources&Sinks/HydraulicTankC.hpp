@@ -35,6 +35,7 @@
 #define HYDRAULICTANKC_HPP_INCLUDED
 
 #include "ComponentEssentials.h"
+#include "ComponentUtilities/EnsembleBlock.h"
 
 namespace hopsan {
 
@@ -86,6 +87,16 @@ namespace hopsan {
             //Nothing will change
         }
 
+        bool hasEnsembleSimulation() const
+        {
+            return true;
+        }
+
+        void simulateOneTimestepEnsemble(Component *const * /*ppLanes*/, const size_t /*nLanes*/)
+        {
+            //Nothing will change in any lane
+        }
+
         void finalize()
         {
 
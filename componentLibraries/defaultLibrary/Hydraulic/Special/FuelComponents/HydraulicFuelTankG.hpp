@@ -256,5 +256,11 @@ delayedPart[1][1],0.,0.0001 + massfuel0);
     {
         delete mpSolver;
     }
+
+     void serializeState(StateArchive &rArchive)
+     {
+         mDelayedPart10.serializeState(rArchive);
+         mDelayedPart11.serializeState(rArchive);
+     }
 };
 #endif // HYDRAULICFUELTANKG_HPP_INCLUDED
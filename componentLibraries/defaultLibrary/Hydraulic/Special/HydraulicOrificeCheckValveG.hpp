@@ -354,5 +354,10 @@ pp))/(Power(Cdt,2)*Power(del,4)*Power(dh,4)),1.5));
     {
         delete mpSolver;
     }
+
+     void serializeState(StateArchive &rArchive)
+     {
+         mDelayedPart10.serializeState(rArchive);
+     }
 };
 #endif // HYDRAULICORIFICECHECKVALVEG_HPP_INCLUDED
@@ -523,5 +523,16 @@ bp*mTimestep);
     {
         delete mpSolver;
     }
+
+     void serializeState(StateArchive &rArchive)
+     {
+         mDelayedPart10.serializeState(rArchive);
+         mDelayedPart11.serializeState(rArchive);
+         mDelayedPart12.serializeState(rArchive);
+         mDelayedPart20.serializeState(rArchive);
+         mDelayedPart21.serializeState(rArchive);
+         mDelayedPart30.serializeState(rArchive);
+         mDelayedPart40.serializeState(rArchive);
+     }
 };
 #endif // HYDRAULICPISTONMKLOAD_HPP_INCLUDED
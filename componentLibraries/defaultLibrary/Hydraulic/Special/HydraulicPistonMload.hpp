@@ -478,5 +478,16 @@ bL*mTimestep + bp*mTimestep + mTimestep*Zcmp);
     {
         delete mpSolver;
     }
+
+     void serializeState(StateArchive &rArchive)
+     {
+         mDelayedPart10.serializeState(rArchive);
+         mDelayedPart11.serializeState(rArchive);
+         mDelayedPart12.serializeState(rArchive);
+         mDelayedPart20.serializeState(rArchive);
+         mDelayedPart21.serializeState(rArchive);
+         mDelayedPart30.serializeState(rArchive);
+         mDelayedPart40.serializeState(rArchive);
+     }
 };
 #endif // HYDRAULICPISTONMLOAD_HPP_INCLUDED
@@ -408,5 +408,12 @@ p2)*Cos(phi))/(2*Bv + ks*mTimestep + 2*Cq*mTimestep*w*Abs(p1 - p2)*Cos(phi));
     {
         delete mpSolver;
     }
+
+     void serializeState(StateArchive &rArchive)
+     {
+         mDelayedPart10.serializeState(rArchive);
+         mDelayedPart11.serializeState(rArchive);
+         mDelayedPart20.serializeState(rArchive);
+     }
 };
 #endif // HYDRAULICPRESSURECOMPENSATINGVALVEG_HPP_INCLUDED
@@ -447,5 +447,12 @@ p2)*Cos(phi))/(2*Bv + ks*mTimestep + 2*Cq*mTimestep*w*Abs(p1 - p2)*Cos(phi));
     {
         delete mpSolver;
     }
+
+     void serializeState(StateArchive &rArchive)
+     {
+         mDelayedPart10.serializeState(rArchive);
+         mDelayedPart11.serializeState(rArchive);
+         mDelayedPart20.serializeState(rArchive);
+     }
 };
 #endif // HYDRAULICPRESSURECONTROLVALVEG_HPP_INCLUDED
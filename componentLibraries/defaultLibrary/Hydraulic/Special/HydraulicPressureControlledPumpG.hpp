@@ -500,5 +500,15 @@ Power(mTimestep,2)*Rpe*wp1e + 4*Lpe*tauv*wp1e + 2*mTimestep*Rpe*tauv*wp1e);
     {
         delete mpSolver;
     }
+
+     void serializeState(StateArchive &rArchive)
+     {
+         mDelayedPart10.serializeState(rArchive);
+         mDelayedPart11.serializeState(rArchive);
+         mDelayedPart12.serializeState(rArchive);
+         mDelayedPart20.serializeState(rArchive);
+         mDelayedPart21.serializeState(rArchive);
+         mDelayedPart30.serializeState(rArchive);
+     }
 };
 #endif // HYDRAULICPRESSURECONTROLLEDPUMPG_HPP_INCLUDED
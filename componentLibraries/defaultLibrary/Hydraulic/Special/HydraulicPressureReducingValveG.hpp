@@ -368,5 +368,12 @@ ks*mTimestep*xv + 2*Cq*mTimestep*p1*w*xv*Cos(phi) - \
     {
         delete mpSolver;
     }
+
+     void serializeState(StateArchive &rArchive)
+     {
+         mDelayedPart10.serializeState(rArchive);
+         mDelayedPart11.serializeState(rArchive);
+         mDelayedPart20.serializeState(rArchive);
+     }
 };
 #endif // HYDRAULICPRESSUREREDUCINGVALVEG_HPP_INCLUDED
@@ -423,5 +423,15 @@ Av*mTimestep*p2 + Av*mTimestep*pref + ke*mTimestep*xv)/(Bv*mTimestep + 2*Mv);
     {
         delete mpSolver;
     }
+
+     void serializeState(StateArchive &rArchive)
+     {
+         mDelayedPart10.serializeState(rArchive);
+         mDelayedPart11.serializeState(rArchive);
+         mDelayedPart12.serializeState(rArchive);
+         mDelayedPart20.serializeState(rArchive);
+         mDelayedPart21.serializeState(rArchive);
+         mDelayedPart30.serializeState(rArchive);
+     }
 };
 #endif // HYDRAULICPRESSURERELIEF2VALVEG_HPP_INCLUDED
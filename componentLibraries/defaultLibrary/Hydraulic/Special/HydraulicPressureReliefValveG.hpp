@@ -362,5 +362,12 @@ Av*mTimestep*pref - 2*Bv*xv + ke*mTimestep*xv)/(2*Bv + ke*mTimestep);
     {
         delete mpSolver;
     }
+
+     void serializeState(StateArchive &rArchive)
+     {
+         mDelayedPart10.serializeState(rArchive);
+         mDelayedPart11.serializeState(rArchive);
+         mDelayedPart20.serializeState(rArchive);
+     }
 };
 #endif // HYDRAULICPRESSURERELIEFVALVEG_HPP_INCLUDED
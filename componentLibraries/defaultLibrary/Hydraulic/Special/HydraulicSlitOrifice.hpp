@@ -373,5 +373,10 @@ q2*Zc2*onPositive(p2),0)*onPositive(p2));
     {
         delete mpSolver;
     }
+
+     void serializeState(StateArchive &rArchive)
+     {
+         mDelayedPart10.serializeState(rArchive);
+     }
 };
 #endif // HYDRAULICSLITORIFICE_HPP_INCLUDED
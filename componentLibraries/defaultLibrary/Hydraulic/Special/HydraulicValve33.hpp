@@ -407,5 +407,12 @@ qa*Zca*onPositive(pa),0)*onPositive(pa));
     {
         delete mpSolver;
     }
+
+     void serializeState(StateArchive &rArchive)
+     {
+         mDelayedPart10.serializeState(rArchive);
+         mDelayedPart20.serializeState(rArchive);
+         mDelayedPart30.serializeState(rArchive);
+     }
 };
 #endif // HYDRAULICVALVE33_HPP_INCLUDED
@@ -582,5 +582,13 @@ xv,0.,Xbt0 + Xvmax);
     {
         delete mpSolver;
     }
+
+     void serializeState(StateArchive &rArchive)
+     {
+         mDelayedPart10.serializeState(rArchive);
+         mDelayedPart20.serializeState(rArchive);
+         mDelayedPart30.serializeState(rArchive);
+         mDelayedPart40.serializeState(rArchive);
+     }
 };
 #endif // HYDRAULICVALVE43_HPP_INCLUDED
@@ -641,5 +641,14 @@ qls*Zcls*onPositive(pls),0)*onPositive(pls));
     {
         delete mpSolver;
     }
+
+     void serializeState(StateArchive &rArchive)
+     {
+         mDelayedPart10.serializeState(rArchive);
+         mDelayedPart20.serializeState(rArchive);
+         mDelayedPart30.serializeState(rArchive);
+         mDelayedPart40.serializeState(rArchive);
+         mDelayedPart50.serializeState(rArchive);
+     }
 };
 #endif // HYDRAULICVALVE43LS_HPP_INCLUDED
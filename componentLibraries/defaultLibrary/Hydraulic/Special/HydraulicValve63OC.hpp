@@ -688,5 +688,14 @@ qoct*Zcoct*onPositive(poct),0)*onPositive(poct));
     {
         delete mpSolver;
     }
+
+     void serializeState(StateArchive &rArchive)
+     {
+         mDelayedPart10.serializeState(rArchive);
+         mDelayedPart20.serializeState(rArchive);
+         mDelayedPart30.serializeState(rArchive);
+         mDelayedPart40.serializeState(rArchive);
+         mDelayedPart50.serializeState(rArchive);
+     }
 };
 #endif // HYDRAULICVALVE63OC_HPP_INCLUDED
@@ -202,6 +202,11 @@ namespace hopsan {
             (*mpP2_p) = P2_p;
             (*mpOut) = outnom;
         }
+
+        void serializeState(StateArchive &rArchive)
+        {
+            mValveSpoolPosFilter.serializeState(rArchive);
+        }
     };
 }
 
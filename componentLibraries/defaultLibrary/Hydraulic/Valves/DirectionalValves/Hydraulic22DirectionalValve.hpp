@@ -188,6 +188,11 @@ namespace hopsan {
             (*mpP2_q) = q2;
             (*mpOut_xv) = xnom;
         }
+
+        void serializeState(StateArchive &rArchive)
+        {
+            mValveSpoolPosFilter.serializeState(rArchive);
+        }
     };
 }
 
@@ -216,6 +216,11 @@ namespace hopsan {
             (*mpPT_q) = qt;
             (*mpXv) = xv;
         }
+
+        void serializeState(StateArchive &rArchive)
+        {
+            mSpoolPosTF.serializeState(rArchive);
+        }
     };
 }
 
@@ -246,6 +246,11 @@ namespace hopsan {
             (*mpPB_q) = qb;
             (*mpXv) = xv;
         }
+
+        void serializeState(StateArchive &rArchive)
+        {
+            mSpoolPosTF.serializeState(rArchive);
+        }
     };
 }
 
@@ -186,6 +186,11 @@ namespace hopsan {
             (*mpPA_q) = qa;
             (*mpOut_xv) = xv;
         }
+
+        void serializeState(StateArchive &rArchive)
+        {
+            filter.serializeState(rArchive);
+        }
     };
 }
 
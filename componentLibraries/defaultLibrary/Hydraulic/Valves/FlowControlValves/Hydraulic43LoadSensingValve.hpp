@@ -279,6 +279,11 @@ namespace hopsan {
             }
             (*mpXv) = xv;
         }
+
+        void serializeState(StateArchive &rArchive)
+        {
+            mSpoolPosTF.serializeState(rArchive);
+        }
     };
 }
 
@@ -248,6 +248,11 @@ namespace hopsan {
             (*mpPB_q) = qb;
             (*mpXv) = xv;
         }
+
+        void serializeState(StateArchive &rArchive)
+        {
+            mSpoolPosTF.serializeState(rArchive);
+        }
     };
 }
 
@@ -299,6 +299,11 @@ namespace hopsan {
             (*mpPC2_q) = qc2;
             (*mpXv) = xv;
         }
+
+        void serializeState(StateArchive &rArchive)
+        {
+            mSpoolPosTF.serializeState(rArchive);
+        }
     };
 }
 
@@ -209,6 +209,11 @@ namespace hopsan {
             (*mpAC_q) = qAC;
             (*mpXvout) = xIntegrator.value();
         }
+
+        void serializeState(StateArchive &rArchive)
+        {
+            xIntegrator.serializeState(rArchive);
+        }
     };
 }
 
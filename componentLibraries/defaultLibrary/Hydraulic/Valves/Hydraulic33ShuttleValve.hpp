@@ -215,6 +215,11 @@ namespace hopsan {
             (*mpPT_q) = qt;
             (*mpXvout) = xv;
         }
+
+        void serializeState(StateArchive &rArchive)
+        {
+            xIntegrator.serializeState(rArchive);
+        }
     };
 }
 
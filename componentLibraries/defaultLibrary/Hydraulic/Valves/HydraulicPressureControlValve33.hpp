@@ -558,5 +558,14 @@ p3)*Cos(phi)*onPositive(limit(Xap0 + xv,0.,Xap0 + Xvmax)));
     {
         delete mpSolver;
     }
+
+     void serializeState(StateArchive &rArchive)
+     {
+         mDelayedPart10.serializeState(rArchive);
+         mDelayedPart11.serializeState(rArchive);
+         mDelayedPart20.serializeState(rArchive);
+         mDelayedPart30.serializeState(rArchive);
+         mDelayedPart40.serializeState(rArchive);
+     }
 };
 #endif // HYDRAULICPRESSURECONTROLVALVE33_HPP_INCLUDED
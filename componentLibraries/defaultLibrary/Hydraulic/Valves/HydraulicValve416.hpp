@@ -532,5 +532,13 @@ qb*Zcb*onPositive(pb),0)*onPositive(pb));
     {
         delete mpSolver;
     }
+
+     void serializeState(StateArchive &rArchive)
+     {
+         mDelayedPart10.serializeState(rArchive);
+         mDelayedPart20.serializeState(rArchive);
+         mDelayedPart30.serializeState(rArchive);
+         mDelayedPart40.serializeState(rArchive);
+     }
 };
 #endif // HYDRAULICVALVE416_HPP_INCLUDED
@@ -184,6 +184,11 @@ namespace hopsan {
             (*mpPControl_p) = p_control;
             (*mpXv) = x0;
         }
+
+        void serializeState(StateArchive &rArchive)
+        {
+            mFilterLP.serializeState(rArchive);
+        }
     };
 }
 
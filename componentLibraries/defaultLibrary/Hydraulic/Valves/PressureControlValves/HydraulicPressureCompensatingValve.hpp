@@ -192,6 +192,11 @@ namespace hopsan {
             (*mpPClose_p) = p_close;
             (*mpXv) = x0;
         }
+
+        void serializeState(StateArchive &rArchive)
+        {
+            mFilterLP.serializeState(rArchive);
+        }
     };
 }
 
@@ -193,6 +193,11 @@ namespace hopsan {
 
             (*mpX0) = x0;
         }
+
+        void serializeState(StateArchive &rArchive)
+        {
+            mFilterLP.serializeState(rArchive);
+        }
     };
 }
 
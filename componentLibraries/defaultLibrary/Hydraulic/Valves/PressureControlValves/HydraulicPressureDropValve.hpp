@@ -234,6 +234,11 @@ namespace hopsan {
             (*mpP2_q) = q2;
             (*mpXv) = x0;
         }
+
+        void serializeState(StateArchive &rArchive)
+        {
+            mFilterLP.serializeState(rArchive);
+        }
     };
 }
 
@@ -235,6 +235,11 @@ namespace hopsan {
 
             (*mpXv) = x0;
         }
+
+        void serializeState(StateArchive &rArchive)
+        {
+            mFilterLP.serializeState(rArchive);
+        }
     };
 }
 
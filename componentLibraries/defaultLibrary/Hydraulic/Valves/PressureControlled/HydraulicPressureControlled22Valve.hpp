@@ -210,6 +210,11 @@ namespace hopsan {
             (*mpPC_q) = qc;
             (*mpX_v) = xv;
         }
+
+        void serializeState(StateArchive &rArchive)
+        {
+            mSpoolPosTF.serializeState(rArchive);
+        }
     };
 }
 
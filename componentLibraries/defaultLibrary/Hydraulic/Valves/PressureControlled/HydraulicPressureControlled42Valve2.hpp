@@ -258,6 +258,11 @@ namespace hopsan {
             (*mpPC_q) = qc;
             (*mpX_v) = xv;
         }
+
+        void serializeState(StateArchive &rArchive)
+        {
+            mSpoolPosTF.serializeState(rArchive);
+        }
     };
 }
 
@@ -344,6 +344,14 @@ namespace hopsan {
 
             return RQ;
         }
+
+        void serializeState(StateArchive &rArchive)
+        {
+            FilterC1F.serializeState(rArchive);
+            FilterC2F.serializeState(rArchive);
+            FilterC1F1.serializeState(rArchive);
+            FilterC2F1.serializeState(rArchive);
+        }
     };
 }
 
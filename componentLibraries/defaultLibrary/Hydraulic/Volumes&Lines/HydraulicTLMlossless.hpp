@@ -146,6 +146,12 @@ namespace hopsan {
             (*mpP2_Zc) = Zc;
 
         }
+
+        void serializeState(StateArchive &rArchive)
+        {
+            mDelayedC1.serializeState(rArchive);
+            mDelayedC2.serializeState(rArchive);
+        }
     };
 }
 
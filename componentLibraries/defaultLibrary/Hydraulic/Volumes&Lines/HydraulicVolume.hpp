@@ -35,6 +35,7 @@
 #define HYDRAULICVOLUME_HPP_INCLUDED
 
 #include "ComponentEssentials.h"
+#include "ComponentUtilities/EnsembleBlock.h"
 
 namespace hopsan {
 
@@ -134,6 +135,42 @@ namespace hopsan {
             (*mpP2_Zc) = mZc;
         }
 
+        bool hasEnsembleSimulation() const
+        {
+            return true;
+        }
+
+        void simulateOneTimestepEnsemble(Component *const *ppLanes, const size_t nLanes)
+        {
+            double q1[HOPSAN_ENSEMBLE_LANE_WIDTH], c1[HOPSAN_ENSEMBLE_LANE_WIDTH], q2[HOPSAN_ENSEMBLE_LANE_WIDTH], c2[HOPSAN_ENSEMBLE_LANE_WIDTH], c10, c20, alpha[HOPSAN_ENSEMBLE_LANE_WIDTH], Zc[HOPSAN_ENSEMBLE_LANE_WIDTH];
+            for (EnsembleBlock<HydraulicVolume> block(ppLanes, nLanes); block.isValid(); block.next())
+            {
+                //Get variable values from nodes
+                block.load(&HydraulicVolume::mpP1_q, q1);
+                block.load(&HydraulicVolume::mpP2_q, q2);
+                block.load(&HydraulicVolume::mpP1_c, c1);
+                block.load(&HydraulicVolume::mpP2_c, c2);
+                block.load(&HydraulicVolume::mpAlpha, alpha);
+                block.loadMember(&HydraulicVolume::mZc, Zc);
+
+                //Volume equations
+                for (size_t i=0; i<HOPSAN_ENSEMBLE_LANE_WIDTH; ++i)
+                {
+                    c10 = c2[i] + 2.0*Zc[i] * q2[i];
+                    c20 = c1[i] + 2.0*Zc[i] * q1[i];
+
+                    c1[i] = alpha[i]*c1[i] + (1.0-alpha[i])*c10;
+                    c2[i] = alpha[i]*c2[i] + (1.0-alpha[i])*c20;
+                }
+
+                //Write new values to nodes
+                block.store(&HydraulicVolume::mpP1_c, c1);
+                block.store(&HydraulicVolume::mpP1_Zc, Zc);
+                block.store(&HydraulicVolume::mpP2_c, c2);
+                block.store(&HydraulicVolume::mpP2_Zc, Zc);
+            }
+        }
+
         void finalize()
         {
 
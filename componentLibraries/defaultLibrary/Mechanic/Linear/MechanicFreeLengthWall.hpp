@@ -140,6 +140,12 @@ public:
         (*mpP1_x) = x1;
         (*mpP1_v) = v1;
     }
+
+    void serializeState(StateArchive &rArchive)
+    {
+        mFilterX.serializeState(rArchive);
+        mFilterV.serializeState(rArchive);
+    }
 };
 }
 
@@ -580,5 +580,20 @@ m2)*mTimestep),-fc,fc))/(4.*m1*m2);
     {
         delete mpSolver;
     }
+
+     void serializeState(StateArchive &rArchive)
+     {
+         mDelayedPart10.serializeState(rArchive);
+         mDelayedPart20.serializeState(rArchive);
+         mDelayedPart30.serializeState(rArchive);
+         mDelayedPart31.serializeState(rArchive);
+         mDelayedPart40.serializeState(rArchive);
+         mDelayedPart41.serializeState(rArchive);
+         mDelayedPart42.serializeState(rArchive);
+         mDelayedPart50.serializeState(rArchive);
+         mDelayedPart51.serializeState(rArchive);
+         mDelayedPart60.serializeState(rArchive);
+         mDelayedPart61.serializeState(rArchive);
+     }
 };
 #endif // MECHANICM2LOAD1D_HPP_INCLUDED
@@ -402,5 +402,14 @@ mTimestep*limit((bfc*mL*vm2)/mTimestep,-fc,fc))/(2*mL + bL*mTimestep);
     {
         delete mpSolver;
     }
+
+     void serializeState(StateArchive &rArchive)
+     {
+         mDelayedPart10.serializeState(rArchive);
+         mDelayedPart11.serializeState(rArchive);
+         mDelayedPart12.serializeState(rArchive);
+         mDelayedPart20.serializeState(rArchive);
+         mDelayedPart21.serializeState(rArchive);
+     }
 };
 #endif // MECHANICMKCLOAD1D_HPP_INCLUDED
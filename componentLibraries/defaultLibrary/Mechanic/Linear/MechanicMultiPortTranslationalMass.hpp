@@ -233,6 +233,11 @@ namespace hopsan {
                 (*mvpP2_me[i]) = m;
             }
         }
+
+        void serializeState(StateArchive &rArchive)
+        {
+            mIntegrator.serializeState(rArchive);
+        }
     };
 }
 
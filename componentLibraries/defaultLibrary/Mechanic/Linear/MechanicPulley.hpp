@@ -153,6 +153,12 @@ namespace hopsan {
             (*mpND_x2) = x2;
             (*mpND_v2) = v2;
         }
+
+        void serializeState(StateArchive &rArchive)
+        {
+            mFilterTheta.serializeState(rArchive);
+            mFilterOmega.serializeState(rArchive);
+        }
     };
 }
 
@@ -128,6 +128,11 @@ namespace hopsan {
             (*mpP2_x) = x2;
             (*mpP2_v) = v2;
         }
+
+        void serializeState(StateArchive &rArchive)
+        {
+            mInt.serializeState(rArchive);
+        }
     };
 }
 
@@ -189,6 +189,12 @@ namespace hopsan {
             (*mpP1_me) = mMass;
             (*mpP2_me) = mMass;
         }
+
+        void serializeState(StateArchive &rArchive)
+        {
+            mFilterX.serializeState(rArchive);
+            mFilterV.serializeState(rArchive);
+        }
     };
 }
 
@@ -175,6 +175,11 @@ namespace hopsan {
             (*mpP2_x) = x2;
             (*mpP2_v) = v2;
         }
+
+        void serializeState(StateArchive &rArchive)
+        {
+            mIntegrator.serializeState(rArchive);
+        }
     };
 }
 
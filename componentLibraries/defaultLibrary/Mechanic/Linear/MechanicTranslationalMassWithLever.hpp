@@ -155,6 +155,11 @@ namespace hopsan {
             (*mpND_v2) = v2;
             (*mpND_me2) = m;
         }
+
+        void serializeState(StateArchive &rArchive)
+        {
+            mIntegrator.serializeState(rArchive);
+        }
     };
 }
 
@@ -119,6 +119,11 @@ namespace hopsan {
             (*mpPm1_x) = x;
             (*mpPm1_v) = v;
         }
+
+        void serializeState(StateArchive &rArchive)
+        {
+            mInt.serializeState(rArchive);
+        }
     };
 }
 
@@ -94,6 +94,11 @@ namespace hopsan {
             (*mpOut_a) = a;
             (*mpOut_w) = w;
         }
+
+        void serializeState(StateArchive &rArchive)
+        {
+            mInt.serializeState(rArchive);
+        }
     };
 }
 
@@ -379,5 +379,15 @@ gearRatio*wmr2*Zcmr1,-tmax,tmax);
     {
         delete mpSolver;
     }
+
+     void serializeState(StateArchive &rArchive)
+     {
+         mDelayedPart10.serializeState(rArchive);
+         mDelayedPart11.serializeState(rArchive);
+         mDelayedPart20.serializeState(rArchive);
+         mDelayedPart21.serializeState(rArchive);
+         mDelayedPart30.serializeState(rArchive);
+         mDelayedPart31.serializeState(rArchive);
+     }
 };
 #endif // MECHANICGEARCLUTCH_HPP_INCLUDED
@@ -455,5 +455,14 @@ fm1*link*Power(mTimestep,2)*Cos(thetamr2))/(4.*JL);
     {
         delete mpSolver;
     }
+
+     void serializeState(StateArchive &rArchive)
+     {
+         mDelayedPart10.serializeState(rArchive);
+         mDelayedPart11.serializeState(rArchive);
+         mDelayedPart20.serializeState(rArchive);
+         mDelayedPart21.serializeState(rArchive);
+         mDelayedPart22.serializeState(rArchive);
+     }
 };
 #endif // MECHANICJLINK2_HPP_INCLUDED
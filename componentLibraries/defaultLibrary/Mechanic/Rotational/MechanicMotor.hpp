@@ -123,6 +123,12 @@ namespace hopsan {
             (*mpND_c1) = c1;
             (*mpND_Zc1) = Zc1;
         }
+
+        void serializeState(StateArchive &rArchive)
+        {
+            mIntegrator.serializeState(rArchive);
+            mDerivator.serializeState(rArchive);
+        }
     };
 }
 
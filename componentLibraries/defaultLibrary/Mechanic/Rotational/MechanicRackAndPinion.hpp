@@ -148,6 +148,12 @@ namespace hopsan {
             (*mpND_a2) = a2;
             (*mpND_w2) = w2;
         }
+
+        void serializeState(StateArchive &rArchive)
+        {
+            mFilter.serializeState(rArchive);
+            mInt.serializeState(rArchive);
+        }
     };
 }
 
@@ -271,6 +271,11 @@ namespace hopsan {
                 (*mvpN_me2[i]) = J;
             }
         }
+
+        void serializeState(StateArchive &rArchive)
+        {
+            mIntegrator.serializeState(rArchive);
+        }
     };
 }
 
@@ -147,6 +147,11 @@ namespace hopsan {
             (*mpP2_a) = a2;
             (*mpP2_w) = w2;
         }
+
+        void serializeState(StateArchive &rArchive)
+        {
+            mIntegrator.serializeState(rArchive);
+        }
     };
 }
 
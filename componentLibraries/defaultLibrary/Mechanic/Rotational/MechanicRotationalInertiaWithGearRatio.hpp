@@ -156,6 +156,12 @@ namespace hopsan {
             (*mpP2_a) = a2;
             (*mpP2_w) = w2;
         }
+
+        void serializeState(StateArchive &rArchive)
+        {
+            mThetaFilter.serializeState(rArchive);
+            mOmegaFilter.serializeState(rArchive);
+        }
     };
 }
 
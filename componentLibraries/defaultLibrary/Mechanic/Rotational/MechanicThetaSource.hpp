@@ -139,5 +139,10 @@ public:
         (*mpPmr1_theta)=theta_out;
         (*mpPmr1_w)=w_in;
      }
+
+     void serializeState(StateArchive &rArchive)
+     {
+         mInt.serializeState(rArchive);
+     }
 };
 #endif // MECHANICTHETASOURCE_HPP_INCLUDED
@@ -144,6 +144,12 @@ namespace hopsan {
             (*mpP2_a) = a2;
             (*mpP2_w) = w2;
         }
+
+        void serializeState(StateArchive &rArchive)
+        {
+            mFilterTheta.serializeState(rArchive);
+            mFilterOmega.serializeState(rArchive);
+        }
     };
 }
 
@@ -483,5 +483,17 @@ Bm*mTimestep*wmr1)/(2.*Jm + Bm*mTimestep);
     {
         delete mpSolver;
     }
+
+     void serializeState(StateArchive &rArchive)
+     {
+         mDelayedPart10.serializeState(rArchive);
+         mDelayedPart11.serializeState(rArchive);
+         mDelayedPart12.serializeState(rArchive);
+         mDelayedPart20.serializeState(rArchive);
+         mDelayedPart21.serializeState(rArchive);
+         mDelayedPart30.serializeState(rArchive);
+         mDelayedPart40.serializeState(rArchive);
+         mDelayedPart50.serializeState(rArchive);
+     }
 };
 #endif // PNEUMATICMACHINE_HPP_INCLUDED
@@ -448,5 +448,14 @@ Tp1*onPositive(qmp2)));
     {
         delete mpSolver;
     }
+
+     void serializeState(StateArchive &rArchive)
+     {
+         mDelayedPart10.serializeState(rArchive);
+         mDelayedPart20.serializeState(rArchive);
+         mDelayedPart30.serializeState(rArchive);
+         mDelayedPart40.serializeState(rArchive);
+         mDelayedPart50.serializeState(rArchive);
+     }
 };
 #endif // PNEUMATICORIFICE_HPP_INCLUDED
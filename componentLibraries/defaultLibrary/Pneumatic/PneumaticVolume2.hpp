@@ -316,5 +316,11 @@ delayedPart[1][1];
     {
         delete mpSolver;
     }
+
+     void serializeState(StateArchive &rArchive)
+     {
+         mDelayedPart10.serializeState(rArchive);
+         mDelayedPart11.serializeState(rArchive);
+     }
 };
 #endif // PNEUMATICVOLUME2_HPP_INCLUDED
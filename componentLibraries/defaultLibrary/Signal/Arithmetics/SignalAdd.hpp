@@ -35,6 +35,7 @@
 #define SIGNALADD_HPP_INCLUDED
 
 #include "ComponentEssentials.h"
+#include "ComponentUtilities/EnsembleBlock.h"
 
 namespace hopsan {
 
@@ -72,6 +73,26 @@ namespace hopsan {
         {
             (*mpND_out) = (*mpND_in1) + (*mpND_in2);
         }
+
+        bool hasEnsembleSimulation() const
+        {
+            return true;
+        }
+
+        void simulateOneTimestepEnsemble(Component *const *ppLanes, const size_t nLanes)
+        {
+            double in1[HOPSAN_ENSEMBLE_LANE_WIDTH], in2[HOPSAN_ENSEMBLE_LANE_WIDTH], out[HOPSAN_ENSEMBLE_LANE_WIDTH];
+            for (EnsembleBlock<SignalAdd> block(ppLanes, nLanes); block.isValid(); block.next())
+            {
+                block.load(&SignalAdd::mpND_in1, in1);
+                block.load(&SignalAdd::mpND_in2, in2);
+                for (size_t i=0; i<HOPSAN_ENSEMBLE_LANE_WIDTH; ++i)
+                {
+                    out[i] = in1[i] + in2[i];
+                }
+                block.store(&SignalAdd::mpND_out, out);
+            }
+        }
     };
 }
 #endif // SIGNALADD_HPP_INCLUDED
@@ -74,6 +74,26 @@ namespace hopsan {
         {
             (*mpND_out) = (*mpND_gain) * (*mpND_in);
         }
+
+        bool hasEnsembleSimulation() const
+        {
+            return true;
+        }
+
+        void simulateOneTimestepEnsemble(Component *const *ppLanes, const size_t nLanes)
+        {
+            double in[HOPSAN_ENSEMBLE_LANE_WIDTH], gain[HOPSAN_ENSEMBLE_LANE_WIDTH], out[HOPSAN_ENSEMBLE_LANE_WIDTH];
+            for (EnsembleBlock<SignalGain> block(ppLanes, nLanes); block.isValid(); block.next())
+            {
+                block.load(&SignalGain::mpND_in, in);
+                block.load(&SignalGain::mpND_gain, gain);
+                for (size_t i=0; i<HOPSAN_ENSEMBLE_LANE_WIDTH; ++i)
+                {
+                    out[i] = gain[i] * in[i];
+                }
+                block.store(&SignalGain::mpND_out, out);
+            }
+        }
     };
 }
 
@@ -35,6 +35,7 @@
 #define SIGNALSUBTRACT_HPP_INCLUDED
 
 #include "ComponentEssentials.h"
+#include "ComponentUtilities/EnsembleBlock.h"
 
 namespace hopsan {
 
@@ -73,6 +74,28 @@ namespace hopsan {
             //Subtract equations
             (*mpND_out) = (*mpND_in1) - (*mpND_in2);
         }
+
+        bool hasEnsembleSimulation() const
+        {
+            return true;
+        }
+
+        void simulateOneTimestepEnsemble(Component *const *ppLanes, const size_t nLanes)
+        {
+            double in1[HOPSAN_ENSEMBLE_LANE_WIDTH], in2[HOPSAN_ENSEMBLE_LANE_WIDTH], out[HOPSAN_ENSEMBLE_LANE_WIDTH];
+            for (EnsembleBlock<SignalSubtract> block(ppLanes, nLanes); block.isValid(); block.next())
+            {
+                block.load(&SignalSubtract::mpND_in1, in1);
+                block.load(&SignalSubtract::mpND_in2, in2);
+
+                //Subtract equations
+                for (size_t i=0; i<HOPSAN_ENSEMBLE_LANE_WIDTH; ++i)
+                {
+                    out[i] = in1[i] - in2[i];
+                }
+                block.store(&SignalSubtract::mpND_out, out);
+            }
+        }
     };
 }
 
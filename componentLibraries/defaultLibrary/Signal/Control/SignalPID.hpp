@@ -250,5 +250,13 @@ yref),umin,umax);
     {
         delete mpSolver;
     }
+
+     void serializeState(StateArchive &rArchive)
+     {
+         mDelayedPart10.serializeState(rArchive);
+         mDelayedPart20.serializeState(rArchive);
+         mDelayedPart30.serializeState(rArchive);
+         mDelayedPart31.serializeState(rArchive);
+     }
 };
 #endif // SIGNALPID_HPP_INCLUDED
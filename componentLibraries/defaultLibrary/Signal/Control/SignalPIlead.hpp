@@ -288,5 +288,15 @@ mTimestep*w21*w22);
     {
         delete mpSolver;
     }
+
+     void serializeState(StateArchive &rArchive)
+     {
+         mDelayedPart10.serializeState(rArchive);
+         mDelayedPart11.serializeState(rArchive);
+         mDelayedPart20.serializeState(rArchive);
+         mDelayedPart30.serializeState(rArchive);
+         mDelayedPart40.serializeState(rArchive);
+         mDelayedPart41.serializeState(rArchive);
+     }
 };
 #endif // SIGNALPILEAD_HPP_INCLUDED
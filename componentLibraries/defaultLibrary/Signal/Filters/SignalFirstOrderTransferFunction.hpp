@@ -84,6 +84,11 @@ namespace hopsan {
         {
             (*mpOut) = mTF.update(*mpIn);
         }
+
+        void serializeState(StateArchive &rArchive)
+        {
+            mTF.serializeState(rArchive);
+        }
     };
 }
 
@@ -88,6 +88,11 @@ namespace hopsan {
         {
             (*mpOut) = mTF.update((*mpIn));
         }
+
+        void serializeState(StateArchive &rArchive)
+        {
+            mTF.serializeState(rArchive);
+        }
     };
 }
 
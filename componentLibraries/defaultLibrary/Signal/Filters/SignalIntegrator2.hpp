@@ -76,6 +76,11 @@ namespace hopsan {
             //Filter equation
            (*mpOut) = mIntegrator.update((*mpIn));
         }
+
+        void serializeState(StateArchive &rArchive)
+        {
+            mIntegrator.serializeState(rArchive);
+        }
     };
 }
 
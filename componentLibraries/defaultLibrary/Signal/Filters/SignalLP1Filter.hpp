@@ -89,6 +89,11 @@ namespace hopsan {
             //Write new values to nodes
             (*mpOut) = mTF.update((*mpIn));
         }
+
+        void serializeState(StateArchive &rArchive)
+        {
+            mTF.serializeState(rArchive);
+        }
     };
 }
 
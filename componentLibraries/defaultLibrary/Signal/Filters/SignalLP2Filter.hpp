@@ -92,6 +92,11 @@ namespace hopsan {
             //Write new values to nodes
             (*mpOut) = mTF2.update((*mpIn));
         }
+
+        void serializeState(StateArchive &rArchive)
+        {
+            mTF2.serializeState(rArchive);
+        }
     };
 }
 
@@ -95,6 +95,11 @@ namespace hopsan {
         {
             (*mpOut) = mTF2.update(*mpIn);
         }
+
+        void serializeState(StateArchive &rArchive)
+        {
+            mTF2.serializeState(rArchive);
+        }
     };
 }
 
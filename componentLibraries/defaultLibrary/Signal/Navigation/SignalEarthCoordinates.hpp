@@ -257,5 +257,15 @@ e))/R;
     {
         delete mpSolver;
     }
+
+     void serializeState(StateArchive &rArchive)
+     {
+         mDelayedPart10.serializeState(rArchive);
+         mDelayedPart11.serializeState(rArchive);
+         mDelayedPart20.serializeState(rArchive);
+         mDelayedPart21.serializeState(rArchive);
+         mDelayedPart30.serializeState(rArchive);
+         mDelayedPart31.serializeState(rArchive);
+     }
 };
 #endif // SIGNALEARTHCOORDINATES_HPP_INCLUDED
@@ -74,7 +74,12 @@ namespace hopsan {
 
         void simulateOneTimestep()
         {
-             (*mpND_out) = (*mpND_in) + (*mpND_stdDev)*noise.getValue();
+             (*mpND_out) = (*mpND_in) + (*mpND_stdDev)*noise.getNextValue();
+        }
+
+        void serializeState(StateArchive &rArchive)
+        {
+            noise.serializeState(rArchive);
         }
     };
 }
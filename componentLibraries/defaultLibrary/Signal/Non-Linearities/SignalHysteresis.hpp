@@ -80,6 +80,11 @@ namespace hopsan {
             (*mpND_out) = mHyst.getValue((*mpND_in), (*mpHysteresisWidth), mDelayedInput.getOldest());
             mDelayedInput.update((*mpND_out));
         }
+
+        void serializeState(StateArchive &rArchive)
+        {
+            mDelayedInput.serializeState(rArchive);
+        }
     };
 }
 
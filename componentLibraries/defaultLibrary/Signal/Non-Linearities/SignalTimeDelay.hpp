@@ -78,6 +78,11 @@ namespace hopsan {
         {
             (*mpND_out) =  mDelay.update(*mpND_in);
         }
+
+        void serializeState(StateArchive &rArchive)
+        {
+            mDelay.serializeState(rArchive);
+        }
     };
 }
 
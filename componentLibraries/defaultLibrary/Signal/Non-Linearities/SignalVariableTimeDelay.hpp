@@ -168,6 +168,14 @@ namespace hopsan {
                 mpDelay = 0;
             }
         }
+
+        void serializeState(StateArchive &rArchive)
+        {
+            if (mpDelay)
+            {
+                mpDelay->serializeState(rArchive);
+            }
+        }
     };
 }
 
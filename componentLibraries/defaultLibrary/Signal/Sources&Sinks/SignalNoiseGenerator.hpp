@@ -71,7 +71,12 @@ namespace hopsan {
 
         void simulateOneTimestep()
         {
-             (*mpOut) = (*mpStdDev)*noise.getValue();
+             (*mpOut) = (*mpStdDev)*noise.getNextValue();
+        }
+
+        void serializeState(StateArchive &rArchive)
+        {
+            noise.serializeState(rArchive);
         }
     };
 }
@@ -1816,5 +1816,35 @@ mTimestep*Power(q3,2)*Wb - 2*zcg)/2.;
     {
         delete mpSolver;
     }
+
+     void serializeState(StateArchive &rArchive)
+     {
+         mDelayedPart10.serializeState(rArchive);
+         mDelayedPart11.serializeState(rArchive);
+         mDelayedPart20.serializeState(rArchive);
+         mDelayedPart21.serializeState(rArchive);
+         mDelayedPart30.serializeState(rArchive);
+         mDelayedPart31.serializeState(rArchive);
+         mDelayedPart40.serializeState(rArchive);
+         mDelayedPart41.serializeState(rArchive);
+         mDelayedPart50.serializeState(rArchive);
+         mDelayedPart51.serializeState(rArchive);
+         mDelayedPart60.serializeState(rArchive);
+         mDelayedPart61.serializeState(rArchive);
+         mDelayedPart70.serializeState(rArchive);
+         mDelayedPart71.serializeState(rArchive);
+         mDelayedPart80.serializeState(rArchive);
+         mDelayedPart81.serializeState(rArchive);
+         mDelayedPart90.serializeState(rArchive);
+         mDelayedPart91.serializeState(rArchive);
+         mDelayedPart100.serializeState(rArchive);
+         mDelayedPart101.serializeState(rArchive);
+         mDelayedPart110.serializeState(rArchive);
+         mDelayedPart111.serializeState(rArchive);
+         mDelayedPart120.serializeState(rArchive);
+         mDelayedPart121.serializeState(rArchive);
+         mDelayedPart130.serializeState(rArchive);
+         mDelayedPart131.serializeState(rArchive);
+     }
 };
 #endif // AEROAIRCRAFT6DOFS_HPP_INCLUDED
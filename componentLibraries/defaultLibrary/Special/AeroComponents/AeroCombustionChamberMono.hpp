@@ -381,5 +381,13 @@ gam)/(2.*(-1 + gam)))*Med);
     {
         delete mpSolver;
     }
+
+     void serializeState(StateArchive &rArchive)
+     {
+         mDelayedPart10.serializeState(rArchive);
+         mDelayedPart11.serializeState(rArchive);
+         mDelayedPart20.serializeState(rArchive);
+         mDelayedPart30.serializeState(rArchive);
+     }
 };
 #endif // AEROCOMBUSTIONCHAMBERMONO_HPP_INCLUDED
@@ -197,5 +197,11 @@ delayedPart[1][1],0,massfuel0);
     {
         delete mpSolver;
     }
+
+     void serializeState(StateArchive &rArchive)
+     {
+         mDelayedPart10.serializeState(rArchive);
+         mDelayedPart11.serializeState(rArchive);
+     }
 };
 #endif // AEROFUELTANK_HPP_INCLUDED
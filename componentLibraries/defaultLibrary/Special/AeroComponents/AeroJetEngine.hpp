@@ -281,5 +281,11 @@ flow","kg/s",1.,&mpqmfuel);
     {
         delete mpSolver;
     }
+
+     void serializeState(StateArchive &rArchive)
+     {
+         mDelayedPart10.serializeState(rArchive);
+         mDelayedPart11.serializeState(rArchive);
+     }
 };
 #endif // AEROJETENGINE_HPP_INCLUDED
@@ -330,5 +330,11 @@ Power(Abs(g1 - (g2*Up)/(dp*(0.00001 + 0.159155*wmr1))),-k)),1/k))/Abs(g1 - \
     {
         delete mpSolver;
     }
+
+     void serializeState(StateArchive &rArchive)
+     {
+         mDelayedPart10.serializeState(rArchive);
+         mDelayedPart20.serializeState(rArchive);
+     }
 };
 #endif // AEROPROPELLER_HPP_INCLUDED
@@ -312,5 +312,17 @@ V),1.5) + dw*Power(mTimestep,2)*Power(Abs(1 + V),2))/(16.*Power(Lw,2) + \
     {
         delete mpSolver;
     }
+
+     void serializeState(StateArchive &rArchive)
+     {
+         mDelayedPart10.serializeState(rArchive);
+         mDelayedPart11.serializeState(rArchive);
+         mDelayedPart20.serializeState(rArchive);
+         mDelayedPart21.serializeState(rArchive);
+         mDelayedPart22.serializeState(rArchive);
+         mDelayedPart30.serializeState(rArchive);
+         mDelayedPart31.serializeState(rArchive);
+         mDelayedPart32.serializeState(rArchive);
+     }
 };
 #endif // AEROTURBFILTER_HPP_INCLUDED
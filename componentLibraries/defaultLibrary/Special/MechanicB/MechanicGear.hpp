@@ -361,5 +361,15 @@ gearRatio*wmr2)/wc,-1.,1.))/(2*Jg + Bg*mTimestep);
     {
         delete mpSolver;
     }
+
+     void serializeState(StateArchive &rArchive)
+     {
+         mDelayedPart10.serializeState(rArchive);
+         mDelayedPart11.serializeState(rArchive);
+         mDelayedPart20.serializeState(rArchive);
+         mDelayedPart21.serializeState(rArchive);
+         mDelayedPart30.serializeState(rArchive);
+         mDelayedPart31.serializeState(rArchive);
+     }
 };
 #endif // MECHANICGEAR_HPP_INCLUDED
@@ -393,5 +393,15 @@ mTimestep*tormr1 - mTimestep*tormr2 - 2*Mc*rwheel*vc)/(2.*Mc*rwheel);
     {
         delete mpSolver;
     }
+
+     void serializeState(StateArchive &rArchive)
+     {
+         mDelayedPart10.serializeState(rArchive);
+         mDelayedPart11.serializeState(rArchive);
+         mDelayedPart20.serializeState(rArchive);
+         mDelayedPart21.serializeState(rArchive);
+         mDelayedPart30.serializeState(rArchive);
+         mDelayedPart31.serializeState(rArchive);
+     }
 };
 #endif // MECHANICVEHICLE1D_HPP_INCLUDED
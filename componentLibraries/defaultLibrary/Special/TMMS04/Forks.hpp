@@ -284,6 +284,14 @@ namespace hopsan {
         {
             //WRITE YOUR DECONFIGURATION CODE HERE (OPTIONAL)
         }
+
+        void serializeState(StateArchive &rArchive)
+        {
+            mFilterX.serializeState(rArchive);
+            mFilterV.serializeState(rArchive);
+            mFilterA.serializeState(rArchive);
+            mFilterW.serializeState(rArchive);
+        }
     };
 }
 
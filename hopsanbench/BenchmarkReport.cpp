@@ -0,0 +1,453 @@
+/*-----------------------------------------------------------------------------
+
+ Copyright 2017 Hopsan Group
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+
+
+ The full license is available in the file LICENSE.
+ For details about the 'Hopsan Group' or information about Authors and
+ Contributors see the HOPSANGROUP and AUTHORS files that are located in
+ the Hopsan source code root directory.
+
+-----------------------------------------------------------------------------*/
+
+#include "BenchmarkReport.h"
+
+#include <cctype>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <map>
+#include <sstream>
+
+using namespace std;
+
+namespace {
+
+//! @brief A value in a JSON document, only what is needed to read benchmark reports
+class JsonValue
+{
+public:
+    enum TypeT {Null, Bool, Number, String, Array, Object};
+
+    JsonValue() : mType(Null), mNumber(0) {}
+
+    const JsonValue *member(const string &rName) const
+    {
+        for (size_t i=0; i<mMembers.size(); ++i)
+        {
+            if (mMembers[i].first == rName)
+            {
+                return &mMembers[i].second;
+            }
+        }
+        return nullptr;
+    }
+
+    double number(const string &rName) const
+    {
+        const JsonValue *pValue = member(rName);
+        return (pValue && pValue->mType == Number) ? pValue->mNumber : 0;
+    }
+
+    string str(const string &rName) const
+    {
+        const JsonValue *pValue = member(rName);
+        return (pValue && pValue->mType == String) ? pValue->mString : string();
+    }
+
+    TypeT mType;
+    double mNumber;
+    string mString;
+    vector<JsonValue> mItems;
+    vector< pair<string, JsonValue> > mMembers;
+};
+
+//! @brief Recursive descent parser for JSON documents
+class JsonParser
+{
+public:
+    JsonParser(const string &rText) : mText(rText), mPos(0) {}
+
+    bool parse(JsonValue &rValue)
+    {
+        if (!parseValue(rValue))
+        {
+            return false;
+        }
+        skipSpace();
+        return (mPos == mText.size()) || fail("Unexpected text after the end of the document");
+    }
+
+    string mError;
+
+private:
+    bool fail(const string &rMessage)
+    {
+        if (mError.empty())
+        {
+            stringstream ss;
+            ss << rMessage << " at offset " << mPos;
+            mError = ss.str();
+        }
+        return false;
+    }
+
+    void skipSpace()
+    {
+        while (mPos < mText.size() && isspace(static_cast<unsigned char>(mText[mPos])))
+        {
+            ++mPos;
+        }
+    }
+
+    bool consume(const char c)
+    {
+        skipSpace();
+        if (mPos < mText.size() && mText[mPos] == c)
+        {
+            ++mPos;
+            return true;
+        }
+        return false;
+    }
+
+    bool parseValue(JsonValue &rValue)
+    {
+        skipSpace();
+        if (mPos >= mText.size())
+        {
+            return fail("Unexpected end of document");
+        }
+        const char c = mText[mPos];
+        if (c == '{')
+        {
+            rValue.mType = JsonValue::Object;
+            ++mPos;
+            if (consume('}'))
+            {
+                return true;
+            }
+            do
+            {
+                pair<string, JsonValue> member;
+                skipSpace();
+                if (!parseString(member.first) || !consume(':') || !parseValue(member.second))
+                {
+                    return fail("Invalid object member");
+                }
+                rValue.mMembers.push_back(member);
+            } while (consume(','));
+            return consume('}') || fail("Expected '}'");
+        }
+        else if (c == '[')
+        {
+            rValue.mType = JsonValue::Array;
+            ++mPos;
+            if (consume(']'))
+            {
+                return true;
+            }
+            do
+            {
+                rValue.mItems.push_back(JsonValue());
+                if (!parseValue(rValue.mItems.back()))
+                {
+                    return false;
+                }
+            } while (consume(','));
+            return consume(']') || fail("Expected ']'");
+        }
+        else if (c == '"')
+        {
+            rValue.mType = JsonValue::String;
+            return parseString(rValue.mString);
+        }
+        else if (mText.compare(mPos, 4, "true") == 0 || mText.compare(mPos, 5, "false") == 0)
+        {
+            rValue.mType = JsonValue::Bool;
+            rValue.mNumber = (c == 't') ? 1 : 0;
+            mPos += (c == 't') ? 4 : 5;
+            return true;
+        }
+        else if (mText.compare(mPos, 4, "null") == 0)
+        {
+            rValue.mType = JsonValue::Null;
+            mPos += 4;
+            return true;
+        }
+        else
+        {
+            const char *pStart = mText.c_str()+mPos;
+            char *pEnd;
+            rValue.mType = JsonValue::Number;
+            rValue.mNumber = strtod(pStart, &pEnd);
+            if (pEnd == pStart)
+            {
+                return fail("Invalid value");
+            }
+            mPos += pEnd-pStart;
+            return true;
+        }
+    }
+
+    bool parseString(string &rString)
+    {
+        if (mPos >= mText.size() || mText[mPos] != '"')
+        {
+            return fail("Expected string");
+        }
+        ++mPos;
+        while (mPos < mText.size() && mText[mPos] != '"')
+        {
+            char c = mText[mPos++];
+            if (c == '\\' && mPos < mText.size())
+            {
+                c = mText[mPos++];
+                if (c == 'n')
+                {
+                    c = '\n';
+                }
+                else if (c == 't')
+                {
+                    c = '\t';
+                }
+                else if (c == 'u')
+                {
+                    // Non-ASCII characters are not needed in reports
+                    mPos += 4;
+                    c = '?';
+                }
+            }
+            rString.push_back(c);
+        }
+        if (mPos >= mText.size())
+        {
+            return fail("Unterminated string");
+        }
+        ++mPos;
+        return true;
+    }
+
+    const string &mText;
+    size_t mPos;
+};
+
+void writeJsonString(ostream &rStream, const string &rString)
+{
+    rStream << '"';
+    for (size_t i=0; i<rString.size(); ++i)
+    {
+        const char c = rString[i];
+        if (c == '"' || c == '\\')
+        {
+            rStream << '\\' << c;
+        }
+        else if (c == '\n')
+        {
+            rStream << "\\n";
+        }
+        else if (c == '\t')
+        {
+            rStream << "\\t";
+        }
+        else
+        {
+            rStream << c;
+        }
+    }
+    rStream << '"';
+}
+
+}
+
+
+BenchmarkResult::BenchmarkResult()
+{
+    mThreads = 0;
+    mNumSteps = 0;
+    mLoadTime = 0;
+    mInitTime = 0;
+    mSimulationTime = 0;
+    mMinSimulationTime = 0;
+    mStepsPerSecond = 0;
+    mSpeedup = 0;
+    mEfficiency = 0;
+    mLogDataMemory = 0;
+}
+
+//! @brief Returns a string that identifies the model, algorithm and number of threads of the result
+string BenchmarkResult::key() const
+{
+    stringstream ss;
+    ss << mModel << " " << mAlgorithm << " " << mThreads;
+    return ss.str();
+}
+
+
+BenchmarkReport::BenchmarkReport()
+{
+    mHardwareThreads = 0;
+    mWarmups = 0;
+    mRepeats = 0;
+}
+
+
+//! @brief Write a benchmark report as JSON
+//! @param[in] rReport The report to write
+//! @param[in] rStream The stream to write to
+void writeBenchmarkReport(const BenchmarkReport &rReport, ostream &rStream)
+{
+    rStream << "{\n  \"hopsanVersion\": ";
+    writeJsonString(rStream, rReport.mHopsanVersion);
+    rStream << ",\n  \"date\": ";
+    writeJsonString(rStream, rReport.mDate);
+    rStream << ",\n  \"hardwareThreads\": " << rReport.mHardwareThreads
+            << ",\n  \"warmups\": " << rReport.mWarmups
+            << ",\n  \"repeats\": " << rReport.mRepeats
+            << ",\n  \"results\": [";
+    rStream << setprecision(9);
+    for (size_t i=0; i<rReport.mResults.size(); ++i)
+    {
+        const BenchmarkResult &rResult = rReport.mResults[i];
+        rStream << ((i > 0) ? ",\n" : "\n") << "    {\"model\": ";
+        writeJsonString(rStream, rResult.mModel);
+        rStream << ", \"algorithm\": ";
+        writeJsonString(rStream, rResult.mAlgorithm);
+        rStream << ", \"threads\": " << rResult.mThreads
+                << ", \"numSteps\": " << rResult.mNumSteps
+                << ", \"loadTime\": " << rResult.mLoadTime
+                << ", \"initTime\": " << rResult.mInitTime
+                << ", \"simulationTime\": " << rResult.mSimulationTime
+                << ", \"minSimulationTime\": " << rResult.mMinSimulationTime
+                << ", \"stepsPerSecond\": " << rResult.mStepsPerSecond
+                << ", \"speedup\": " << rResult.mSpeedup
+                << ", \"efficiency\": " << rResult.mEfficiency
+                << ", \"logDataMemory\": " << rResult.mLogDataMemory << "}";
+    }
+    rStream << "\n  ]\n}\n";
+}
+
+//! @brief Read a benchmark report written by writeBenchmarkReport()
+//! @param[in] rFilePath The JSON file to read
+//! @param[out] rReport The read report
+//! @param[out] rError The reason that the file could not be read
+//! @returns True if the report could be read
+bool readBenchmarkReport(const string &rFilePath, BenchmarkReport &rReport, string &rError)
+{
+    ifstream file(rFilePath.c_str());
+    if (!file.is_open())
+    {
+        rError = "Could not open file: "+rFilePath;
+        return false;
+    }
+    stringstream ss;
+    ss << file.rdbuf();
+    const string text = ss.str();
+
+    JsonParser parser(text);
+    JsonValue document;
+    if (!parser.parse(document))
+    {
+        rError = "Could not parse "+rFilePath+": "+parser.mError;
+        return false;
+    }
+    const JsonValue *pResults = document.member("results");
+    if (document.mType != JsonValue::Object || !pResults || pResults->mType != JsonValue::Array)
+    {
+        rError = "No benchmark results in file: "+rFilePath;
+        return false;
+    }
+
+    rReport = BenchmarkReport();
+    rReport.mHopsanVersion = document.str("hopsanVersion");
+    rReport.mDate = document.str("date");
+    rReport.mHardwareThreads = size_t(document.number("hardwareThreads"));
+    rReport.mWarmups = size_t(document.number("warmups"));
+    rReport.mRepeats = size_t(document.number("repeats"));
+    for (size_t i=0; i<pResults->mItems.size(); ++i)
+    {
+        const JsonValue &rItem = pResults->mItems[i];
+        BenchmarkResult result;
+        result.mModel = rItem.str("model");
+        result.mAlgorithm = rItem.str("algorithm");
+        result.mThreads = size_t(rItem.number("threads"));
+        result.mNumSteps = size_t(rItem.number("numSteps"));
+        result.mLoadTime = rItem.number("loadTime");
+        result.mInitTime = rItem.number("initTime");
+        result.mSimulationTime = rItem.number("simulationTime");
+        result.mMinSimulationTime = rItem.number("minSimulationTime");
+        result.mStepsPerSecond = rItem.number("stepsPerSecond");
+        result.mSpeedup = rItem.number("speedup");
+        result.mEfficiency = rItem.number("efficiency");
+        result.mLogDataMemory = size_t(rItem.number("logDataMemory"));
+        rReport.mResults.push_back(result);
+    }
+    return true;
+}
+
+//! @brief Compare benchmark results with baseline results
+//! @details A result is a regression if it simulates fewer steps per second, takes longer to initialize (by at least 1 ms)
+//! or uses more log data memory than the baseline, by more than the tolerance
+//! @param[in] rBaseline The baseline results
+//! @param[in] rCurrent The results to check
+//! @param[in] tolerance The relative change that is accepted, for example 0.1 for 10 %
+//! @param[out] rMissing The keys of baseline results that are not in the current results
+//! @returns The regressions, one for each result and quantity
+vector<BenchmarkRegression> findRegressions(const BenchmarkReport &rBaseline, const BenchmarkReport &rCurrent, const double tolerance,
+                                            vector<string> &rMissing)
+{
+    map<string, const BenchmarkResult*> current;
+    for (size_t i=0; i<rCurrent.mResults.size(); ++i)
+    {
+        current[rCurrent.mResults[i].key()] = &rCurrent.mResults[i];
+    }
+
+    vector<BenchmarkRegression> regressions;
+    rMissing.clear();
+    for (size_t i=0; i<rBaseline.mResults.size(); ++i)
+    {
+        const BenchmarkResult &rBase = rBaseline.mResults[i];
+        map<string, const BenchmarkResult*>::const_iterator it = current.find(rBase.key());
+        if (it == current.end())
+        {
+            rMissing.push_back(rBase.key());
+            continue;
+        }
+        const BenchmarkResult &rCur = *it->second;
+
+        BenchmarkRegression regression;
+        regression.mBaseline = rBase;
+        regression.mCurrent = rCur;
+        if (rBase.mStepsPerSecond > 0 && rCur.mStepsPerSecond < rBase.mStepsPerSecond*(1.0-tolerance))
+        {
+            regression.mQuantity = "stepsPerSecond";
+            regression.mChange = 1.0-rCur.mStepsPerSecond/rBase.mStepsPerSecond;
+            regressions.push_back(regression);
+        }
+        if (rBase.mInitTime > 0 && rCur.mInitTime > rBase.mInitTime*(1.0+tolerance) && rCur.mInitTime-rBase.mInitTime > 1e-3)
+        {
+            regression.mQuantity = "initTime";
+            regression.mChange = rCur.mInitTime/rBase.mInitTime-1.0;
+            regressions.push_back(regression);
+        }
+        if (rBase.mLogDataMemory > 0 && double(rCur.mLogDataMemory) > double(rBase.mLogDataMemory)*(1.0+tolerance))
+        {
+            regression.mQuantity = "logDataMemory";
+            regression.mChange = double(rCur.mLogDataMemory)/double(rBase.mLogDataMemory)-1.0;
+            regressions.push_back(regression);
+        }
+    }
+    return regressions;
+}
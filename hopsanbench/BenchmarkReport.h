@@ -0,0 +1,82 @@
+/*-----------------------------------------------------------------------------
+
+ Copyright 2017 Hopsan Group
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+
+
+ The full license is available in the file LICENSE.
+ For details about the 'Hopsan Group' or information about Authors and
+ Contributors see the HOPSANGROUP and AUTHORS files that are located in
+ the Hopsan source code root directory.
+
+-----------------------------------------------------------------------------*/
+
+#ifndef BENCHMARKREPORT_H
+#define BENCHMARKREPORT_H
+
+#include <string>
+#include <vector>
+#include <ostream>
+
+//! @brief The measured performance of one model, scheduling algorithm and number of threads
+class BenchmarkResult
+{
+public:
+    BenchmarkResult();
+    std::string key() const;
+
+    std::string mModel;
+    std::string mAlgorithm;
+    size_t mThreads;
+    size_t mNumSteps;
+    double mLoadTime;           //!< Time to load the model [s]
+    double mInitTime;           //!< Median time to initialize [s]
+    double mSimulationTime;     //!< Median time to simulate [s]
+    double mMinSimulationTime;  //!< Shortest time to simulate [s]
+    double mStepsPerSecond;     //!< Simulated time steps per second, based on the median time
+    double mSpeedup;            //!< Single-threaded median time divided by this median time
+    double mEfficiency;         //!< Speedup divided by the number of threads
+    size_t mLogDataMemory;      //!< Memory used for logged time and node data [bytes]
+};
+
+//! @brief The results of a benchmark run together with information about the run
+class BenchmarkReport
+{
+public:
+    BenchmarkReport();
+
+    std::string mHopsanVersion;
+    std::string mDate;
+    size_t mHardwareThreads;
+    size_t mWarmups;
+    size_t mRepeats;
+    std::vector<BenchmarkResult> mResults;
+};
+
+//! @brief A result that is slower than the baseline
+class BenchmarkRegression
+{
+public:
+    BenchmarkResult mBaseline;
+    BenchmarkResult mCurrent;
+    std::string mQuantity;
+    double mChange;             //!< Relative change in the direction of worse performance
+};
+
+void writeBenchmarkReport(const BenchmarkReport &rReport, std::ostream &rStream);
+bool readBenchmarkReport(const std::string &rFilePath, BenchmarkReport &rReport, std::string &rError);
+std::vector<BenchmarkRegression> findRegressions(const BenchmarkReport &rBaseline, const BenchmarkReport &rCurrent, const double tolerance,
+                                                 std::vector<std::string> &rMissing);
+
+#endif // BENCHMARKREPORT_H
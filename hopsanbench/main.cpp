@@ -0,0 +1,468 @@
+/*-----------------------------------------------------------------------------
+
+ Copyright 2017 Hopsan Group
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+
+
+ The full license is available in the file LICENSE.
+ For details about the 'Hopsan Group' or information about Authors and
+ Contributors see the HOPSANGROUP and AUTHORS files that are located in
+ the Hopsan source code root directory.
+
+-----------------------------------------------------------------------------*/
+
+// hopsan-bench: Measures how the simulation of the benchmark models scales with the number of threads for each scheduling
+// algorithm, writes the results as JSON and optionally flags regressions against stored baseline results
+
+#include <algorithm>
+#include <chrono>
+#include <ctime>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <set>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <tclap/CmdLine.h>
+
+#include "HopsanEssentials.h"
+#include "HopsanCoreVersion.h"
+#include "ComponentSystem.h"
+#include "CoreUtilities/SimulationHandler.h"
+#include "BenchmarkReport.h"
+
+#ifndef HOPSANBENCH_DEFAULT_LIBRARY
+#define HOPSANBENCH_DEFAULT_LIBRARY ""
+#endif
+#ifndef HOPSANBENCH_MODELS_ROOT
+#define HOPSANBENCH_MODELS_ROOT "Models"
+#endif
+
+using namespace std;
+using namespace hopsan;
+
+namespace {
+
+class AlgorithmInfo
+{
+public:
+    const char *mName;
+    ParallelAlgorithmT mAlgorithm;
+};
+
+const AlgorithmInfo algorithms[] = {{"offline", OfflineSchedulingAlgorithm},
+                                    {"taskpool", TaskPoolAlgorithm},
+                                    {"taskstealing", TaskStealingAlgorithm},
+                                    {"parallelfor", ParallelForAlgorithm},
+                                    {"groupedparallelfor", GroupedParallelForAlgorithm},
+                                    {"partition", GraphPartitioningAlgorithm}};
+const size_t numAlgorithms = sizeof(algorithms)/sizeof(algorithms[0]);
+
+// The single-threaded simulation, that the speedup is calculated from
+const char *serialAlgorithmName = "serial";
+
+const int multicoreTestSizes[] = {16, 25, 50, 100, 200, 300, 400, 500, 750, 1000, 1500};
+
+// Models that can be loaded by the current model loader, the benchmark models above are saved with an old version and must be resaved
+const char *exampleModels[] = {"Position Servo.hmf", "Hydrostatic Transmission.hmf", "Load Sensing System.hmf"};
+
+double secondsSince(const chrono::steady_clock::time_point &rStart)
+{
+    return chrono::duration<double>(chrono::steady_clock::now()-rStart).count();
+}
+
+double median(vector<double> values)
+{
+    if (values.empty())
+    {
+        return 0;
+    }
+    sort(values.begin(), values.end());
+    const size_t n = values.size();
+    return (n % 2 == 1) ? values[n/2] : 0.5*(values[n/2-1]+values[n/2]);
+}
+
+string fileName(const string &rPath)
+{
+    const size_t pos = rPath.find_last_of("/\\");
+    return (pos == string::npos) ? rPath : rPath.substr(pos+1);
+}
+
+string utcDateTime()
+{
+    const time_t now = time(nullptr);
+    char buffer[32];
+    strftime(buffer, sizeof(buffer), "%Y-%m-%dT%H:%M:%SZ", gmtime(&now));
+    return buffer;
+}
+
+//! @brief Print and remove the error messages from the core
+void printCoreErrors(HopsanEssentials &rHopsanCore)
+{
+    HString message, type, tag;
+    while (rHopsanCore.checkMessage() > 0)
+    {
+        rHopsanCore.getMessage(message, type, tag);
+        if (type == "error" || type == "fatal")
+        {
+            cerr << message.c_str() << endl;
+        }
+    }
+}
+
+//! @brief Returns the number of bytes used by the logged time and node data in a system and its subsystems
+//! @param[in] pSystem The system
+//! @param[in,out] rCountedNodes Nodes that have already been counted, since nodes are shared by the connected ports
+size_t calcLogDataMemory(ComponentSystem *pSystem, set<const Node*> &rCountedNodes)
+{
+    size_t bytes = pSystem->getLogTimeVector()->size()*sizeof(double);
+    const vector<Component*> components = pSystem->getSubComponents();
+    for (size_t c=0; c<components.size(); ++c)
+    {
+        if (components[c]->isComponentSystem())
+        {
+            bytes += calcLogDataMemory(static_cast<ComponentSystem*>(components[c]), rCountedNodes);
+            continue;
+        }
+        const vector<Port*> ports = components[c]->getPortPtrVector();
+        for (size_t p=0; p<ports.size(); ++p)
+        {
+            // The nodes of multiports are counted from the ports that they are connected to
+            const Node *pNode = ports[p]->isMultiPort() ? nullptr : ports[p]->getNodePtr();
+            if (!pNode || !rCountedNodes.insert(pNode).second)
+            {
+                continue;
+            }
+            for (size_t d=0; d<ports[p]->getNumDataVariables(); ++d)
+            {
+                bytes += ports[p]->getLogDataColumn(d).size()*sizeof(double);
+            }
+        }
+    }
+    return bytes;
+}
+
+//! @brief Simulate a model repeatedly with one algorithm and number of threads and measure the times
+//! @param[in] pSystem The model
+//! @param[in] startT Start time
+//! @param[in] stopT Stop time
+//! @param[in] pAlgorithm The scheduling algorithm, or nullptr for single-threaded simulation
+//! @param[in] nThreads The number of threads
+//! @param[in] warmups The number of simulations before the measured simulations
+//! @param[in] repeats The number of measured simulations
+//! @param[in,out] rResult The result, the times and log data memory are set
+//! @returns False if the model could not be initialized or the simulation was aborted
+bool benchmarkConfiguration(ComponentSystem *pSystem, const double startT, const double stopT, const AlgorithmInfo *pAlgorithm,
+                            const size_t nThreads, const size_t warmups, const size_t repeats, BenchmarkResult &rResult)
+{
+    vector<double> initTimes, simulationTimes;
+    for (size_t r=0; r<warmups+repeats; ++r)
+    {
+        chrono::steady_clock::time_point start = chrono::steady_clock::now();
+        if (!pSystem->initialize(startT, stopT))
+        {
+            pSystem->finalize();
+            return false;
+        }
+        const double initTime = secondsSince(start);
+
+        start = chrono::steady_clock::now();
+        if (pAlgorithm)
+        {
+            pSystem->simulateMultiThreaded(startT, stopT, nThreads, false, pAlgorithm->mAlgorithm);
+        }
+        else
+        {
+            pSystem->simulate(stopT);
+        }
+        const double simulationTime = secondsSince(start);
+
+        if (r+1 == warmups+repeats)
+        {
+            set<const Node*> countedNodes;
+            rResult.mLogDataMemory = calcLogDataMemory(pSystem, countedNodes);
+        }
+        const bool aborted = pSystem->wasSimulationAborted();
+        pSystem->finalize();
+        if (aborted)
+        {
+            return false;
+        }
+        if (r >= warmups)
+        {
+            initTimes.push_back(initTime);
+            simulationTimes.push_back(simulationTime);
+        }
+    }
+
+    rResult.mInitTime = median(initTimes);
+    rResult.mSimulationTime = median(simulationTimes);
+    rResult.mMinSimulationTime = *min_element(simulationTimes.begin(), simulationTimes.end());
+    rResult.mStepsPerSecond = (rResult.mSimulationTime > 0) ? double(rResult.mNumSteps)/rResult.mSimulationTime : 0;
+    return true;
+}
+
+void printResult(const BenchmarkResult &rResult)
+{
+    cout << "  " << setw(20) << left << rResult.mAlgorithm << right << setw(4) << rResult.mThreads << " threads: "
+         << fixed << setprecision(4) << setw(9) << rResult.mSimulationTime << " s, " << setprecision(0) << setw(10) << rResult.mStepsPerSecond << " steps/s, speedup "
+         << setprecision(2) << rResult.mSpeedup << ", efficiency " << rResult.mEfficiency << ", init " << setprecision(4) << rResult.mInitTime << " s, log "
+         << setprecision(1) << double(rResult.mLogDataMemory)/(1024.0*1024.0) << " MiB" << endl;
+    cout.unsetf(ios::floatfield);
+}
+
+//! @brief Compare results with baseline results and print the regressions
+//! @returns The number of regressions
+size_t compareWithBaseline(const BenchmarkReport &rBaseline, const BenchmarkReport &rCurrent, const double tolerance)
+{
+    vector<string> missing;
+    const vector<BenchmarkRegression> regressions = findRegressions(rBaseline, rCurrent, tolerance, missing);
+    cout << "Comparing with baseline from " << rBaseline.mDate << " (Hopsan " << rBaseline.mHopsanVersion << "), tolerance "
+         << tolerance*100 << " %" << endl;
+    for (size_t i=0; i<missing.size(); ++i)
+    {
+        cout << "  Not benchmarked: " << missing[i] << endl;
+    }
+    for (size_t i=0; i<regressions.size(); ++i)
+    {
+        const BenchmarkRegression &rRegression = regressions[i];
+        cout << "  REGRESSION " << rRegression.mCurrent.key() << ": " << rRegression.mQuantity << " is " << fixed << setprecision(1)
+             << rRegression.mChange*100 << " % worse" << endl;
+        cout.unsetf(ios::floatfield);
+    }
+    cout << regressions.size() << " regressions found" << endl;
+    return regressions.size();
+}
+
+}
+
+
+int main(int argc, char *argv[])
+{
+    try
+    {
+        TCLAP::CmdLine cmd("hopsan-bench, measures the multi-threaded simulation performance of Hopsan models", ' ', HOPSANCOREVERSION);
+
+        TCLAP::ValueArg<std::string> outputOption("o", "output", "Write the results as JSON to this file", false, "hopsan-bench.json", "Path to file", cmd);
+        TCLAP::ValueArg<std::string> baselineOption("b", "baseline", "Compare the results with these stored results, the exit code is 1 if there are regressions", false, "", "Path to file", cmd);
+        TCLAP::ValueArg<std::string> compareOption("c", "compare", "Compare these stored results with the baseline given by option -b instead of running the benchmarks", false, "", "Path to file", cmd);
+        TCLAP::ValueArg<double> toleranceOption("", "tolerance", "The relative change from the baseline that is not a regression (default: 0.1)", false, 0.1, "number", cmd);
+        TCLAP::ValueArg<int> threadsOption("t", "threads", "The largest number of threads, 1, 2, 4 ... up to this number are used (default: number of hardware threads)", false, 0, "integer", cmd);
+        TCLAP::ValueArg<int> repeatsOption("r", "repeats", "The number of measured simulations of each configuration, the median is reported (default: 3)", false, 3, "integer", cmd);
+        TCLAP::ValueArg<int> warmupsOption("w", "warmups", "The number of simulations before the measured ones (default: 1)", false, 1, "integer", cmd);
+        TCLAP::ValueArg<std::string> algorithmsOption("a", "algorithms", "Comma separated scheduling algorithms: offline, taskpool, taskstealing, parallelfor, groupedparallelfor, partition (default: all)", false, "", "string", cmd);
+        TCLAP::ValueArg<double> stopTimeOption("", "stopTime", "Simulate to this time instead of the stop time in the models", false, -1, "number", cmd);
+        TCLAP::ValueArg<std::string> modelsRootOption("", "modelsRoot", "The Models directory containing the default models", false, HOPSANBENCH_MODELS_ROOT, "Path to directory", cmd);
+        TCLAP::ValueArg<std::string> defaultLibraryOption("", "defaultLibrary", "The default component library", false, HOPSANBENCH_DEFAULT_LIBRARY, "Path to file", cmd);
+        TCLAP::MultiArg<std::string> extLibOption("e", "externalLib", "Path to a .dll/.so/.dylib externalComponentLib. Can be given multiple times", false, "Path to file", cmd);
+        TCLAP::UnlabeledMultiArg<std::string> modelsOption("models", "The models to benchmark (default: Multicore-test-16 ... 1500 in Models/Benchmark Models, Models/heavy.hmf and three example models)", false, "Paths to files", cmd);
+
+        cmd.parse(argc, argv);
+
+        const double tolerance = toleranceOption.getValue();
+
+        // Only compare stored results
+        if (compareOption.isSet())
+        {
+            BenchmarkReport baseline, current;
+            string error;
+            if (!baselineOption.isSet())
+            {
+                cerr << "Error: A baseline must be given with option -b to compare with" << endl;
+                return 2;
+            }
+            if (!readBenchmarkReport(baselineOption.getValue(), baseline, error) || !readBenchmarkReport(compareOption.getValue(), current, error))
+            {
+                cerr << "Error: " << error << endl;
+                return 2;
+            }
+            return (compareWithBaseline(baseline, current, tolerance) > 0) ? 1 : 0;
+        }
+
+        // Read the baseline before spending time on the benchmarks
+        BenchmarkReport baseline;
+        if (baselineOption.isSet())
+        {
+            string error;
+            if (!readBenchmarkReport(baselineOption.getValue(), baseline, error))
+            {
+                cerr << "Error: " << error << endl;
+                return 2;
+            }
+        }
+
+        vector<const AlgorithmInfo*> selectedAlgorithms;
+        stringstream algorithmNames(algorithmsOption.getValue());
+        string name;
+        while (getline(algorithmNames, name, ','))
+        {
+            const AlgorithmInfo *pFound = nullptr;
+            for (size_t a=0; a<numAlgorithms; ++a)
+            {
+                if (name == algorithms[a].mName)
+                {
+                    pFound = &algorithms[a];
+                }
+            }
+            if (!pFound)
+            {
+                cerr << "Error: Unknown scheduling algorithm: " << name << endl;
+                return 2;
+            }
+            selectedAlgorithms.push_back(pFound);
+        }
+        if (selectedAlgorithms.empty())
+        {
+            for (size_t a=0; a<numAlgorithms; ++a)
+            {
+                selectedAlgorithms.push_back(&algorithms[a]);
+            }
+        }
+
+        vector<string> models = modelsOption.getValue();
+        if (models.empty())
+        {
+            for (size_t i=0; i<sizeof(multicoreTestSizes)/sizeof(multicoreTestSizes[0]); ++i)
+            {
+                stringstream ss;
+                ss << modelsRootOption.getValue() << "/Benchmark Models/Multicore-test-" << multicoreTestSizes[i] << ".hmf";
+                models.push_back(ss.str());
+            }
+            models.push_back(modelsRootOption.getValue()+"/heavy.hmf");
+            for (size_t i=0; i<sizeof(exampleModels)/sizeof(exampleModels[0]); ++i)
+            {
+                models.push_back(modelsRootOption.getValue()+"/Example Models/"+exampleModels[i]);
+            }
+        }
+
+        BenchmarkReport report;
+        report.mHopsanVersion = HOPSANCOREVERSION;
+        report.mDate = utcDateTime();
+        report.mHardwareThreads = max(size_t(thread::hardware_concurrency()), size_t(1));
+        report.mWarmups = size_t(max(warmupsOption.getValue(), 0));
+        report.mRepeats = size_t(max(repeatsOption.getValue(), 1));
+
+        const size_t maxThreads = (threadsOption.getValue() > 0) ? size_t(threadsOption.getValue()) : report.mHardwareThreads;
+        vector<size_t> threadCounts;
+        for (size_t n=1; n<maxThreads; n*=2)
+        {
+            threadCounts.push_back(n);
+        }
+        threadCounts.push_back(maxThreads);
+
+        HopsanEssentials hopsanCore;
+        if (!defaultLibraryOption.getValue().empty())
+        {
+            hopsanCore.loadExternalComponentLib(defaultLibraryOption.getValue().c_str());
+        }
+        for (size_t i=0; i<extLibOption.getValue().size(); ++i)
+        {
+            hopsanCore.loadExternalComponentLib(extLibOption.getValue()[i].c_str());
+        }
+        printCoreErrors(hopsanCore);
+
+        bool allSucceeded = true;
+        for (size_t m=0; m<models.size(); ++m)
+        {
+            double startT, stopT;
+            const chrono::steady_clock::time_point loadStart = chrono::steady_clock::now();
+            ComponentSystem *pSystem = hopsanCore.loadHMFModelFile(models[m].c_str(), startT, stopT);
+            const double loadTime = secondsSince(loadStart);
+            if (!pSystem || !pSystem->checkModelBeforeSimulation())
+            {
+                // Continue with the other models, results that are missing compared to the baseline are listed when comparing
+                printCoreErrors(hopsanCore);
+                cerr << "Warning: Skipping model that could not be loaded: " << models[m] << endl;
+                if (pSystem)
+                {
+                    hopsanCore.removeComponent(pSystem);
+                }
+                continue;
+            }
+            if (stopTimeOption.getValue() > startT)
+            {
+                stopT = stopTimeOption.getValue();
+            }
+
+            BenchmarkResult common;
+            common.mModel = fileName(models[m]);
+            common.mLoadTime = loadTime;
+            common.mNumSteps = size_t((stopT-startT)/pSystem->getDesiredTimeStep()+0.5);
+            cout << common.mModel << ": " << pSystem->getSubComponents().size() << " components, " << common.mNumSteps << " steps, loaded in "
+                 << loadTime << " s" << endl;
+
+            BenchmarkResult serial = common;
+            serial.mAlgorithm = serialAlgorithmName;
+            serial.mThreads = 1;
+            if (!benchmarkConfiguration(pSystem, startT, stopT, nullptr, 1, report.mWarmups, report.mRepeats, serial))
+            {
+                printCoreErrors(hopsanCore);
+                cerr << "Error: Could not simulate model: " << models[m] << endl;
+                allSucceeded = false;
+                hopsanCore.removeComponent(pSystem);
+                continue;
+            }
+            serial.mSpeedup = 1;
+            serial.mEfficiency = 1;
+            report.mResults.push_back(serial);
+            printResult(serial);
+
+            for (size_t a=0; a<selectedAlgorithms.size(); ++a)
+            {
+                for (size_t t=0; t<threadCounts.size(); ++t)
+                {
+                    BenchmarkResult result = common;
+                    result.mAlgorithm = selectedAlgorithms[a]->mName;
+                    result.mThreads = threadCounts[t];
+                    if (!benchmarkConfiguration(pSystem, startT, stopT, selectedAlgorithms[a], threadCounts[t], report.mWarmups, report.mRepeats, result))
+                    {
+                        printCoreErrors(hopsanCore);
+                        cerr << "Error: Could not simulate model: " << models[m] << " with " << result.mAlgorithm << " and " << result.mThreads << " threads" << endl;
+                        allSucceeded = false;
+                        continue;
+                    }
+                    result.mSpeedup = (result.mSimulationTime > 0) ? serial.mSimulationTime/result.mSimulationTime : 0;
+                    result.mEfficiency = result.mSpeedup/double(result.mThreads);
+                    report.mResults.push_back(result);
+                    printResult(result);
+                }
+            }
+            printCoreErrors(hopsanCore);
+            hopsanCore.removeComponent(pSystem);
+        }
+
+        ofstream file(outputOption.getValue().c_str());
+        writeBenchmarkReport(report, file);
+        if (!file.good())
+        {
+            cerr << "Error: Could not write results to: " << outputOption.getValue() << endl;
+            return 2;
+        }
+        cout << "Wrote results to: " << outputOption.getValue() << endl;
+
+        if (baselineOption.isSet() && compareWithBaseline(baseline, report, tolerance) > 0)
+        {
+            return 1;
+        }
+        return allSucceeded ? 0 : 2;
+    }
+    catch (TCLAP::ArgException &e)
+    {
+        cerr << "Error: " << e.error() << " for arg " << e.argId() << endl;
+        return 2;
+    }
+}
@@ -25,6 +25,8 @@ extern "C" {
     HOPSANC_DLLAPI int getMessage(char* buf, size_t bufSize);
     HOPSANC_DLLAPI int loadModel(const char* path);
     HOPSANC_DLLAPI int setParameter(const char* name, const char *value);
+    HOPSANC_DLLAPI int getParameterHandle(const char* name);
+    HOPSANC_DLLAPI int setParameterByHandle(int handle, double value);
     HOPSANC_DLLAPI int setStartTime(double value);
     HOPSANC_DLLAPI int setTimeStep(double value);
     HOPSANC_DLLAPI int setStopTime(double value);
@@ -2,6 +2,7 @@
 #include <iostream>
 #include <string.h>
 #include <vector>
+#include <algorithm>
 
 #include "HopsanCore.h"
 #include "HopsanEssentials.h"
@@ -13,6 +14,9 @@ static hopsan::HopsanEssentials gHopsanCore;
 
 static double startTime, stopTime;
 
+static std::vector<hopsan::ParameterHandle> sParameterHandles;
+static std::vector<hopsan::HString> sParameterHandleNames;
+
 std::vector<hopsan::HString> msgVec;
 
 //! @brief Puts specified message in message queue and prints it to cout
@@ -70,6 +74,8 @@ int loadModel(const char* path) {
     if(spCoreComponentSystem) {
         delete spCoreComponentSystem;
     }
+    sParameterHandles.clear();
+    sParameterHandleNames.clear();
     spCoreComponentSystem = gHopsanCore.loadHMFModelFile(path, startTime, stopTime);
     if(!spCoreComponentSystem) {
         printMessage("Failed to instantiate model!");
@@ -118,10 +124,8 @@ int getDataVector(const char* variable, double *data)
         pSystem->getAliasHandler().getVariableFromAlias(splitVar[0], compName, portName, varId);
         hopsan::Component *pComp = pSystem->getSubComponent(compName);
         hopsan::Port *pPort = pComp->getPort(portName);
-        std::vector< std::vector<double> > *pLogData = pPort->getLogDataVectorPtr();
-        for (size_t t=0; t<pSystem->getNumActuallyLoggedSamples(); ++t) {
-            data[t] = (*pLogData)[t][size_t(varId)];
-        }
+        const hopsan::LogDataColumnView logData = pPort->getLogDataColumn(size_t(varId));
+        logData.copyTo(data, std::min(pSystem->getNumActuallyLoggedSamples(), logData.size()));
         return 0;   //Found alias variable!
     }
     else if(splitVar.size() < 3) {
@@ -161,10 +165,8 @@ int getDataVector(const char* variable, double *data)
         return -1;
     }
 
-    std::vector< std::vector<double> > *pLogData = pPort->getLogDataVectorPtr();
-    for (size_t t=0; t<spCoreComponentSystem->getNumActuallyLoggedSamples(); ++t) {
-        data[t] = (*pLogData)[t][size_t(varId)];
-    }
+    const hopsan::LogDataColumnView logData = pPort->getLogDataColumn(size_t(varId));
+    logData.copyTo(data, std::min(spCoreComponentSystem->getNumActuallyLoggedSamples(), logData.size()));
     return 0;
 }
 
@@ -273,11 +275,13 @@ int getTimeVector(double *data)
 }
 
 
-//! @brief Sets a parameter value
+//! @brief Splits a parameter name and finds the system it belongs to
 //! @param [in] name Name of parameter (with all qualifiers)
-//! @param [in] value New value for parameter (will be converted from string to correct type)
+//! @param [out] ppSystem The system that contains the parameter
+//! @param [out] rCompName The component name, empty for system parameters
+//! @param [out] rParName The parameter name in the component or system
 //! @returns Status (0 = success)
-int setParameter(const char *name, const char *value)
+static int resolveParameterName(const char *name, hopsan::ComponentSystem **ppSystem, hopsan::HString &rCompName, hopsan::HString &rParName)
 {
     if(!spCoreComponentSystem) {
         printMessage("Error: No model is loaded.");
@@ -291,18 +295,17 @@ int setParameter(const char *name, const char *value)
     sysVec.resize(sysVec.size()-1);
 
     //Generate component name and parameter name
-    hopsan::HString compName, parName;
     if(nameVec.size() == 1) {   //System parameter
-        compName = "";
-        parName = nameVec[0];
+        rCompName = "";
+        rParName = nameVec[0];
     }
     else if(nameVec.size() == 2) { //Constant
-        compName = nameVec[0];
-        parName = nameVec[1];
+        rCompName = nameVec[0];
+        rParName = nameVec[1];
     }
     else if(nameVec.size() == 3) { //Input variable
-        compName = nameVec[0];
-        parName = nameVec[1]+"#"+nameVec[2];
+        rCompName = nameVec[0];
+        rParName = nameVec[1]+"#"+nameVec[2];
     }
     else {
         printMessage("Error: Parameter name not specified.");
@@ -318,6 +321,22 @@ int setParameter(const char *name, const char *value)
             return -1;
         }
     }
+    *ppSystem = pSystem;
+    return 0;
+}
+
+
+//! @brief Sets a parameter value
+//! @param [in] name Name of parameter (with all qualifiers)
+//! @param [in] value New value for parameter (will be converted from string to correct type)
+//! @returns Status (0 = success)
+int setParameter(const char *name, const char *value)
+{
+    hopsan::ComponentSystem *pSystem;
+    hopsan::HString compName, parName;
+    if(resolveParameterName(name, &pSystem, compName, parName) != 0) {
+        return -1;
+    }
 
     if(compName.empty()) {   //Set system parameter
         if(pSystem->setParameterValue(parName, hopsan::HString(value))) {
@@ -328,7 +347,7 @@ int setParameter(const char *name, const char *value)
             return -1;
         }
     }
-    else if(nameVec.size() == 2 || nameVec.size() == 3) { //Set constant or input variable
+    else { //Set constant or input variable
         hopsan::Component *pComp = pSystem->getSubComponent(compName);
         if(!pComp) {
             printMessage("Error: No such component: "+compName);
@@ -342,9 +361,68 @@ int setParameter(const char *name, const char *value)
             return -1;
         }
     }
+}
 
-    printMessage("Error: Wrong number of arguments.");
-    return -1;
+
+//! @brief Resolves a parameter name to a core parameter handle
+//! @param [in] name Name of parameter (with all qualifiers, same as for setParameter())
+//! @returns The handle, check isValid() to see if the parameter was found
+static hopsan::ParameterHandle resolveParameterHandle(const char *name)
+{
+    hopsan::ComponentSystem *pSystem;
+    hopsan::HString compName, parName;
+    if(resolveParameterName(name, &pSystem, compName, parName) != 0) {
+        return hopsan::ParameterHandle();
+    }
+
+    hopsan::ParameterHandle handle = pSystem->getParameterHandle(compName, parName);
+    if(!handle.isValid()) {
+        printWaitingMessages(gHopsanCore, false, false);
+        printMessage("Error: No such parameter: "+hopsan::HString(name));
+    }
+    return handle;
+}
+
+
+//! @brief Resolves a numeric parameter once, for fast repeated updates with setParameterByHandle()
+//! Handles are valid until another model is loaded, they are resolved again if the model has been reconfigured
+//! @param [in] name Name of parameter (with all qualifiers, same as for setParameter())
+//! @returns Handle (>= 0), or -1 if the parameter was not found
+int getParameterHandle(const char *name)
+{
+    hopsan::ParameterHandle handle = resolveParameterHandle(name);
+    if(!handle.isValid()) {
+        return -1;
+    }
+    sParameterHandles.push_back(handle);
+    sParameterHandleNames.push_back(name);
+    return int(sParameterHandles.size()-1);
+}
+
+
+//! @brief Sets a numeric parameter value, without string conversion
+//! @param [in] handle Parameter handle from getParameterHandle()
+//! @param [in] value New value for parameter
+//! @returns Status (0 = success)
+int setParameterByHandle(int handle, double value)
+{
+    if(!spCoreComponentSystem) {
+        printMessage("Error: No model is loaded.");
+        return -1;
+    }
+    if(handle < 0 || size_t(handle) >= sParameterHandles.size()) {
+        printMessage("Error: Invalid parameter handle: "+to_hstring(handle));
+        return -1;
+    }
+    // Parameters may have been removed since the handle was resolved, e.g. by a reconfiguration, then it must be resolved again
+    if(!sParameterHandles[size_t(handle)].isValid()) {
+        sParameterHandles[size_t(handle)] = resolveParameterHandle(sParameterHandleNames[size_t(handle)].c_str());
+    }
+    if(!spCoreComponentSystem->setParameterValue(sParameterHandles[size_t(handle)], value)) {
+        printWaitingMessages(gHopsanCore, false, false);
+        return -1;
+    }
+    return 0;
 }
 
 
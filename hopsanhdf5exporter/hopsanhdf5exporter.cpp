@@ -3,6 +3,7 @@
 
 #include <ctime>
 #include <set>
+#include <algorithm>
 
 using namespace hopsan;
 
@@ -180,3 +181,102 @@ const hopsan::HString &HopsanHDF5Exporter::getLastError()
 }
 
 
+class HopsanHDF5LogSinkPrivates
+{
+public:
+    H5::H5File mFile;
+    H5::DataSet mDataSet;
+    hsize_t mnRows = 0;
+    hsize_t mnColumns = 0;
+};
+
+//! @brief Help function to create a one-dimensional dataset with strings
+static void createH5StringDataSet(H5::H5File &rFile, const H5std_string &name, const std::vector<const char*> &rStrings)
+{
+    hsize_t dims[1] = {rStrings.size()};
+    H5::DataSpace dataspace(1, dims);
+    H5::StrType strtype(H5::PredType::C_S1, H5T_VARIABLE);
+    H5::DataSet dataset = rFile.createDataSet(name, strtype, dataspace);
+    dataset.write(rStrings.data(), strtype);
+}
+
+HopsanHDF5LogSink::HopsanHDF5LogSink(const hopsan::HString &rFilePath, const hopsan::HString &rModelFileName, const hopsan::HString &rToolName) :
+    mFilePath(rFilePath),
+    mModelFileName(rModelFileName),
+    mToolName(rToolName),
+    mpPrivates(new HopsanHDF5LogSinkPrivates) {}
+
+HopsanHDF5LogSink::~HopsanHDF5LogSink()
+{
+    delete mpPrivates;
+}
+
+bool HopsanHDF5LogSink::open(const std::vector<LogStreamVariable> &rVariables)
+{
+    try {
+        H5::Exception::dontPrint();
+        mpPrivates->mFile = H5::H5File(mFilePath.c_str(), H5F_ACC_TRUNC);
+        mpPrivates->mnRows = 0;
+        mpPrivates->mnColumns = rVariables.size();
+
+        H5::Group root = mpPrivates->mFile.openGroup("/");
+        appendH5Attribute(root, "model", mModelFileName.c_str());
+        appendH5Attribute(root, "tool", mToolName.c_str());
+
+        // The column names and units are stored in separate string datasets
+        mpPrivates->mFile.createGroup("/stream");
+        std::vector<const char*> names, units;
+        for (const auto &variable : rVariables) {
+            names.push_back(variable.name.c_str());
+            units.push_back(variable.unit.c_str());
+        }
+        createH5StringDataSet(mpPrivates->mFile, "/stream/names", names);
+        createH5StringDataSet(mpPrivates->mFile, "/stream/units", units);
+
+        // Create an extendable dataset with one row per sample, it grows as chunks are written
+        hsize_t dims[2] = {0, mpPrivates->mnColumns};
+        hsize_t maxdims[2] = {H5S_UNLIMITED, mpPrivates->mnColumns};
+        hsize_t chunkdims[2] = {std::max(hsize_t(1), hsize_t(65536)/std::max(hsize_t(1), mpPrivates->mnColumns)), mpPrivates->mnColumns};
+        H5::DataSpace dataspace(2, dims, maxdims);
+        H5::DSetCreatPropList properties;
+        properties.setChunk(2, chunkdims);
+        mpPrivates->mDataSet = mpPrivates->mFile.createDataSet("/stream/data", H5::PredType::NATIVE_DOUBLE, dataspace, properties);
+    }
+    catch(H5::Exception &e) {
+        mLastError = HString(e.getCDetailMsg())+" in "+HString(e.getCFuncName());
+        return false;
+    }
+    return true;
+}
+
+bool HopsanHDF5LogSink::write(const double *pSamples, const size_t nSamples)
+{
+    try {
+        hsize_t newdims[2] = {mpPrivates->mnRows+nSamples, mpPrivates->mnColumns};
+        mpPrivates->mDataSet.extend(newdims);
+
+        hsize_t offset[2] = {mpPrivates->mnRows, 0};
+        hsize_t count[2] = {nSamples, mpPrivates->mnColumns};
+        H5::DataSpace filespace = mpPrivates->mDataSet.getSpace();
+        filespace.selectHyperslab(H5S_SELECT_SET, count, offset);
+        H5::DataSpace memspace(2, count);
+        mpPrivates->mDataSet.write(pSamples, H5::PredType::NATIVE_DOUBLE, memspace, filespace);
+        mpPrivates->mnRows += nSamples;
+    }
+    catch(H5::Exception &e) {
+        mLastError = HString(e.getCDetailMsg())+" in "+HString(e.getCFuncName());
+        return false;
+    }
+    return true;
+}
+
+void HopsanHDF5LogSink::close()
+{
+    try {
+        mpPrivates->mDataSet.close();
+        mpPrivates->mFile.close();
+    }
+    catch(H5::Exception &e) {
+        mLastError = HString(e.getCDetailMsg())+" in "+HString(e.getCFuncName());
+    }
+}
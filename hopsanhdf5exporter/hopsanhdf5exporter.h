@@ -2,6 +2,7 @@
 #define HOPSANHDF5EXPORTER_H
 
 #include "HopsanEssentials.h"
+#include "CoreUtilities/LogStreaming.h"
 
 class HopsanHDF5Exporter
 {
@@ -19,4 +20,20 @@ private:
     hopsan::HVector<hopsan::HVector<double> > mDataVectors;
 };
 
+class HopsanHDF5LogSinkPrivates;
+
+//! @brief Log sink that streams samples to an extendable two-dimensional dataset, one row per sample, written in chunks
+class HopsanHDF5LogSink : public hopsan::LogSink
+{
+public:
+    HopsanHDF5LogSink(const hopsan::HString &rFilePath, const hopsan::HString &rModelFileName, const hopsan::HString &rToolName);
+    ~HopsanHDF5LogSink();
+    bool open(const std::vector<hopsan::LogStreamVariable> &rVariables);
+    bool write(const double *pSamples, const size_t nSamples);
+    void close();
+private:
+    hopsan::HString mFilePath, mModelFileName, mToolName;
+    HopsanHDF5LogSinkPrivates *mpPrivates;
+};
+
 #endif // HOPSANHDF5EXPORTER_H
@@ -91,6 +91,7 @@ public:
     string mDescription;
     string mExternalIP;
     string mAddressServerIPandPort;
+    string mThreadPlacement = "auto";
     double mAddressReportAge = 60*10;
 };
 
@@ -288,6 +289,7 @@ int main(int argc, char* argv[])
 
     TCLAP::ValueArg<std::string> argDescription("", "description", "Label for this server", false, "", "", cmd);
     TCLAP::ValueArg<std::string> argAddressServerIP("", "addresserver", "IP:port to address server", false, "", "", cmd);
+    TCLAP::ValueArg<std::string> argThreadPlacement("", "threadplacement", "Pin the simulation threads of the workers to processors: auto, none, compact, scatter or a list of processors such as 0-3,8. Each worker is given the processors of its own slots (Linux only)", false, "auto", "string", cmd);
 
     // Parse the argv array.
     cmd.parse( argc, argv );
@@ -298,6 +300,7 @@ int main(int argc, char* argv[])
     gServerConfig.mDescription = argDescription.getValue();
     gServerConfig.mExternalIP = argExternalIP.getValue();
     gServerConfig.mAddressServerIPandPort = argAddressServerIP.getValue();
+    gServerConfig.mThreadPlacement = argThreadPlacement.getValue();
     gServerConfig.mAddressReportAge = argAddressReportAge.getValue()*60;
 
     steady_clock::time_point lastStatusRequestTime;
@@ -368,9 +371,10 @@ int main(int argc, char* argv[])
                         string swport = to_string(workerPort);
                         string nthreads = to_string(requestNumThreads);
                         string uidstr = to_string(uid);
+                        string firstslot = to_string(gNumTakenSlots);
 
                         std::string appName("hopsanserverworker.exe");
-                        std::string cmdLine("hopsanserverworker "+uidstr+" "+scport+" "+swport+" "+nthreads);
+                        std::string cmdLine("hopsanserverworker "+uidstr+" "+scport+" "+swport+" "+nthreads+" "+gServerConfig.mThreadPlacement+" "+firstslot);
                         TCHAR* pTCharCmdLineBuff = new TCHAR[cmdLine.size()+1];
                         strcpy_s(pTCharCmdLineBuff, cmdLine.size()+1, cmdLine.c_str());
 
@@ -392,7 +396,7 @@ int main(int argc, char* argv[])
                         delete pTCharCmdLineBuff;
 
 #else
-                        char name_buff[64], sport_buff[64], wport_buff[64], thread_buff[64], uid_buff[64];
+                        char name_buff[64], sport_buff[64], wport_buff[64], thread_buff[64], uid_buff[64], placement_buff[256], slot_buff[64];
                         // Write name
                         sprintf(name_buff, "%s", "hopsanserverworker");
                         // Write port as char in buffer
@@ -402,8 +406,11 @@ int main(int argc, char* argv[])
                         sprintf(thread_buff, "%d", requestNumThreads);
                         // Write id as char in buffer
                         sprintf(uid_buff, "%d", uid);
+                        // Write thread placement and the first slot of the worker as char in buffer
+                        snprintf(placement_buff, sizeof(placement_buff), "%s", gServerConfig.mThreadPlacement.c_str());
+                        sprintf(slot_buff, "%d", gNumTakenSlots);
 
-                        char *argv[] = {name_buff, uid_buff, sport_buff, wport_buff, thread_buff, nullptr};
+                        char *argv[] = {name_buff, uid_buff, sport_buff, wport_buff, thread_buff, placement_buff, slot_buff, nullptr};
 
                         pid_t pid;
                         int status = posix_spawn(&pid,"./hopsanserverworker",nullptr,nullptr,argv,environ);
@@ -34,6 +34,8 @@
 #include <thread>
 #include <atomic>
 #include <array>
+#include <algorithm>
+#include <map>
 
 #include "zmq.hpp"
 
@@ -44,6 +46,7 @@
 
 #include "HopsanEssentials.h"
 #include "CoreUtilities/HopsanCoreMessageHandler.h"
+#include "CoreUtilities/MultiThreadingUtilities.h"
 #include "TicToc.hpp"
 
 #ifdef _WIN32
@@ -68,7 +71,7 @@ bool gHaveLoadedComponentLibraries=false;
 typedef struct
 {
     string fullName;
-    vector< vector<double> > *pData = 0;
+    LogDataColumnView data;
     vector< double > *pTimeData = 0;
     size_t dataLength = 0;
     size_t dataId = 0;
@@ -128,17 +131,14 @@ void collectAllModelVariables(ComponentSystem *pSys, vector<ModelVariableInfo_t>
                 }
 
                 //! @todo what about time vector
-                vector< vector<double> > *pLogData = pPort->getLogDataVectorPtr();
-
                 const vector<NodeDataDescription> *pVars = pPort->getNodeDataDescriptions();
                 if (pVars)
                 {
                     for (size_t v=0; v<pVars->size(); ++v)
                     {
-                        // Only write something if data has been logged (skip ports that are not logged)
-                        // We assume that the data vector has been cleared
-                        //! @todo check if log on
-                        if (pLogData->size() > 0)
+                        // Only write something if data has been logged (skip variables that are not logged)
+                        const LogDataColumnView logData = pPort->getLogDataColumn(v);
+                        if (!logData.empty())
                         {
                             const NodeDataDescription *pVarDesc = &(*pVars)[v];
                             ModelVariableInfo_t mvi;
@@ -146,9 +146,9 @@ void collectAllModelVariables(ComponentSystem *pSys, vector<ModelVariableInfo_t>
                             mvi.alias = pPort->getVariableAlias(pVarDesc->id).c_str();
                             mvi.quantity = pVarDesc->quantity.c_str();
                             mvi.unit = pVarDesc->unit.c_str();
-                            mvi.pData = pLogData;
+                            mvi.data = logData;
                             mvi.dataId = pVarDesc->id;
-                            mvi.dataLength = pSys->getNumActuallyLoggedSamples();
+                            mvi.dataLength = std::min(pSys->getNumActuallyLoggedSamples(), logData.size());
                             rvMVI.push_back(mvi);
                         }
                     }
@@ -265,6 +265,36 @@ string getParameter(ComponentSystem *pSystem, HString &fullname)
     return "";
 }
 
+ParameterHandle getParameterHandle(ComponentSystem *pSystem, HString &fullname)
+{
+    if (pSystem)
+    {
+        size_t d = fullname.find_first_of('$');
+        if (d != HString::npos)
+        {
+            HString sysname = fullname.substr(0, d);
+            fullname.erase(0, d+1);
+            ComponentSystem *pSubsys = pSystem->getSubComponentSystem(sysname);
+            return getParameterHandle(pSubsys, fullname);
+        }
+        else
+        {
+            vector<string> cpv;
+            splitStringOnDelimiter(fullname.c_str(), '#', cpv);
+            if (cpv.size() == 2)
+            {
+                return pSystem->getParameterHandle(cpv[0].c_str(), cpv[1].c_str());
+            }
+            else if (cpv.size() == 3)
+            {
+                // Restore the (start value) name
+                return pSystem->getParameterHandle(cpv[0].c_str(), (cpv[1]+"#"+cpv[2]).c_str());
+            }
+        }
+    }
+    return ParameterHandle();
+}
+
 // ------------------------------
 // Model utilities END
 // ------------------------------
@@ -273,6 +303,8 @@ string getParameter(ComponentSystem *pSystem, HString &fullname)
 ComponentSystem *gpRootSystem=nullptr;
 double gSimStartTime, gSimStopTime;
 size_t gNumThreads = 1;
+ThreadPlacementT gThreadPlacement = AutomaticThreadPlacement;
+std::vector<int> gThreadPlacementCpus;
 SimulationHandler gSimulator;
 FileReceiver gModelAssets;
 std::atomic_bool gIsSimulating(false);
@@ -280,6 +312,7 @@ std::atomic_bool gShellIsExecuting(false);
 bool gClientConnected = true; //Need to start this as true, to avoid instant quit if client is slow to connect
 bool gIsModelLoaded = false;
 bool gWasSimulationOK = false;
+std::map<std::string, ParameterHandle> gParameterHandles; // Resolved numeric parameters, for fast repeated SetParameter
 bool gSimulationFinnished = false;
 bool gShellExecExitOK = false;
 double gInitTime;
@@ -418,6 +451,7 @@ bool loadModel(string &rModel)
         gpRootSystem=nullptr;
         gIsModelLoaded = false;
     }
+    gParameterHandles.clear();
 
     //! @todo loadHMFModel will hang (sometimes) if hmf empty
     if (!rModel.empty())
@@ -429,6 +463,7 @@ bool loadModel(string &rModel)
     if (gpRootSystem && (gHopsanCore.getNumErrorMessages()+gHopsanCore.getNumFatalMessages() <= numLibErrors) )
     {
         cout << PRINTWORKER << nowDateTime() << " Model was loaded sucessfully" << endl;
+        gpRootSystem->setThreadPlacement(gThreadPlacement, gThreadPlacementCpus);
         gIsModelLoaded = true;
         return true;
     }
@@ -471,11 +506,35 @@ int main(int argc, char* argv[])
     string workerCtrlPort = argv[3];
 
     // Read num threads argument
-    if (argc == 5)
+    if (argc >= 5)
     {
         gNumThreads = size_t(atoi(argv[4]));
     }
 
+    // Read thread placement and first slot arguments
+    if (argc >= 6)
+    {
+        std::vector<int> cpus;
+        if (!parseThreadPlacement(argv[5], gThreadPlacement, cpus))
+        {
+            cout << PRINTWORKER << nowDateTime() << " Error: Unknown thread placement: " << argv[5] << endl;
+            return 1;
+        }
+        gThreadPlacementCpus = cpus;
+
+        // Use the processors of the slots given to this worker, so that workers on the same server do not share processors
+        const size_t firstSlot = (argc >= 7) ? size_t(atoi(argv[6])) : 0;
+        if ((gThreadPlacement != AutomaticThreadPlacement) && (gThreadPlacement != NoThreadPlacement))
+        {
+            std::vector<int> slotCpus = determineThreadCpus(firstSlot+gNumThreads, gThreadPlacement, cpus);
+            if (slotCpus.size() == firstSlot+gNumThreads)
+            {
+                gThreadPlacement = ExplicitThreadPlacement;
+                gThreadPlacementCpus.assign(slotCpus.begin()+firstSlot, slotCpus.end());
+            }
+        }
+    }
+
     cout << PRINTWORKER << nowDateTime() << " Listening on port: " << workerCtrlPort << " Using: " << gNumThreads << " threads" << endl;
     cout << PRINTWORKER << nowDateTime() << " Server control port is: " << serverCtrlPort << endl;
 
@@ -565,9 +624,42 @@ int main(int argc, char* argv[])
                         CmdmsgSetParameter msg = unpackMessage<CmdmsgSetParameter>(request, offset, parseOK);
                         cout << PRINTWORKER << nowDateTime() << " Client want to set parameter " << msg.name << " " << msg.value << endl;
 
-                        // Set parameter
-                        HString fullName = msg.name.c_str();
-                        bool rc = setParameter(gpRootSystem, fullName, msg.value.c_str());
+                        // Set parameter, numeric values are set directly through a parameter handle that is resolved once per name
+                        bool rc = false;
+                        bool isNumeric = false;
+                        const double numericValue = HString(msg.value.c_str()).toDouble(&isNumeric);
+                        if (isNumeric && gpRootSystem)
+                        {
+                            // A handle is no longer valid if parameters have been removed since it was resolved, then it is resolved again
+                            auto it = gParameterHandles.find(msg.name);
+                            if (it == gParameterHandles.end())
+                            {
+                                it = gParameterHandles.insert(make_pair(msg.name, ParameterHandle())).first;
+                            }
+                            if (!it->second.isValid())
+                            {
+                                HString fullName = msg.name.c_str();
+                                it->second = getParameterHandle(gpRootSystem, fullName);
+                            }
+                            const ParameterHandle &rHandle = it->second;
+                            if (rHandle.isValid() && (rHandle.getParameter()->getType() == "double" || rHandle.getParameter()->getType() == "integer"))
+                            {
+                                // A parameter that triggers reconfiguration may add or remove parameters, so forget all resolved handles
+                                const bool reconfigures = rHandle.getParameter()->triggersReconfiguration();
+                                rc = gpRootSystem->setParameterValue(rHandle, numericValue);
+                                if (reconfigures)
+                                {
+                                    gParameterHandles.clear();
+                                }
+                            }
+                        }
+                        if (!rc)
+                        {
+                            HString fullName = msg.name.c_str();
+                            rc = setParameter(gpRootSystem, fullName, msg.value.c_str());
+                            // The new value may have triggered a reconfiguration
+                            gParameterHandles.clear();
+                        }
                         // Send ack or nack
                         if (rc)
                         {
@@ -908,12 +1000,10 @@ int main(int argc, char* argv[])
                             vars.back().unit = rMvi.unit.c_str();
                             vars.back().data.reserve(rMvi.dataLength);
                             // Copy if a data variable
-                            if (rMvi.pData)
+                            if (!rMvi.data.empty())
                             {
-                                for (size_t t=0; t<rMvi.dataLength; ++t)
-                                {
-                                    vars.back().data.push_back((*rMvi.pData)[t][rMvi.dataId]);
-                                }
+                                vars.back().data.resize(rMvi.dataLength);
+                                rMvi.data.copyTo(vars.back().data.data(), rMvi.dataLength);
                             }
                             // Copy if a time data variable
                             else if (rMvi.pTimeData)